@@ -0,0 +1,18 @@
+#ifndef SORBET_AST_ARENA_H
+#define SORBET_AST_ARENA_H
+
+#include "common/Arena.h"
+
+namespace sorbet::ast {
+
+class Expression;
+
+// The bump allocator for Expression nodes; see common/Arena.h for the mechanics. While one is
+// installed (see Arena::Guard), Expression::operator new carves nodes out of large contiguous
+// chunks, and the memory is returned in one shot when the Arena dies, which a ParsedFile arranges
+// by keeping its file's Arena alive exactly as long as its tree.
+using Arena = sorbet::Arena<Expression>;
+
+} // namespace sorbet::ast
+
+#endif // SORBET_AST_ARENA_H
@@ -219,19 +219,19 @@ public:
     }
 
     static std::unique_ptr<Expression> Int(core::Loc loc, int64_t val) {
-        return std::make_unique<ast::Literal>(loc, core::make_type<core::LiteralType>(val));
+        return std::make_unique<ast::Literal>(loc, core::LiteralType::make_shared(val));
     }
 
     static std::unique_ptr<Expression> Float(core::Loc loc, double val) {
-        return std::make_unique<ast::Literal>(loc, core::make_type<core::LiteralType>(val));
+        return std::make_unique<ast::Literal>(loc, core::LiteralType::make_shared(val));
     }
 
     static std::unique_ptr<Expression> Symbol(core::Loc loc, core::NameRef name) {
-        return std::make_unique<ast::Literal>(loc, core::make_type<core::LiteralType>(core::Symbols::Symbol(), name));
+        return std::make_unique<ast::Literal>(loc, core::LiteralType::make_shared(core::Symbols::Symbol(), name));
     }
 
     static std::unique_ptr<Expression> String(core::Loc loc, core::NameRef value) {
-        return std::make_unique<ast::Literal>(loc, core::make_type<core::LiteralType>(core::Symbols::String(), value));
+        return std::make_unique<ast::Literal>(loc, core::LiteralType::make_shared(core::Symbols::String(), value));
     }
 
     static std::unique_ptr<MethodDef> Method(core::Loc loc, core::Loc declLoc, core::NameRef name,
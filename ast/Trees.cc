@@ -1,4 +1,5 @@
 #include "ast/Trees.h"
+#include "ast/Arena.h"
 #include "common/typecase.h"
 #include "core/Symbols.h"
 #include <sstream>
@@ -78,6 +79,38 @@ void printTabs(stringstream &to, int count) {
 
 Expression::Expression(core::Loc loc) : loc(loc) {}
 
+namespace {
+// Every node carries a one-word header recording whether it came from an arena, padded to keep the
+// node itself maximally aligned.
+constexpr size_t allocHeaderSize = alignof(std::max_align_t);
+} // namespace
+
+void *Expression::operator new(std::size_t size) {
+    auto *arena = Arena::current();
+    char *mem;
+    if (arena != nullptr) {
+        mem = static_cast<char *>(arena->allocate(size + allocHeaderSize));
+    } else {
+        mem = static_cast<char *>(std::malloc(size + allocHeaderSize));
+        if (mem == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    *reinterpret_cast<uintptr_t *>(mem) = arena != nullptr ? 1 : 0;
+    return mem + allocHeaderSize;
+}
+
+void Expression::operator delete(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto *mem = static_cast<char *>(ptr) - allocHeaderSize;
+    if (*reinterpret_cast<uintptr_t *>(mem) == 0) {
+        std::free(mem);
+    }
+    // Arena-backed nodes are reclaimed when the owning Arena dies.
+}
+
 Reference::Reference(core::Loc loc) : Expression(loc) {}
 
 ClassDef::ClassDef(core::Loc loc, core::Loc declLoc, core::SymbolRef symbol, unique_ptr<Expression> name,
@@ -87,7 +120,7 @@ ClassDef::ClassDef(core::Loc loc, core::Loc declLoc, core::SymbolRef symbol, uni
     categoryCounterInc("trees", "classdef");
     histogramInc("trees.classdef.kind", (int)kind);
     histogramInc("trees.classdef.ancestors", this->ancestors.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 MethodDef::MethodDef(core::Loc loc, core::Loc declLoc, core::SymbolRef symbol, core::NameRef name, ARGS_store args,
@@ -95,7 +128,7 @@ MethodDef::MethodDef(core::Loc loc, core::Loc declLoc, core::SymbolRef symbol, c
     : Declaration(loc, declLoc, symbol), rhs(std::move(rhs)), args(std::move(args)), name(name), flags(flags) {
     categoryCounterInc("trees", "methoddef");
     histogramInc("trees.methodDef.args", this->args.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Declaration::Declaration(core::Loc loc, core::Loc declLoc, core::SymbolRef symbol)
@@ -104,33 +137,33 @@ Declaration::Declaration(core::Loc loc, core::Loc declLoc, core::SymbolRef symbo
 If::If(core::Loc loc, unique_ptr<Expression> cond, unique_ptr<Expression> thenp, unique_ptr<Expression> elsep)
     : Expression(loc), cond(std::move(cond)), thenp(std::move(thenp)), elsep(std::move(elsep)) {
     categoryCounterInc("trees", "if");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 While::While(core::Loc loc, unique_ptr<Expression> cond, unique_ptr<Expression> body)
     : Expression(loc), cond(std::move(cond)), body(std::move(body)) {
     categoryCounterInc("trees", "while");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Break::Break(core::Loc loc, unique_ptr<Expression> expr) : Expression(loc), expr(std::move(expr)) {
     categoryCounterInc("trees", "break");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Retry::Retry(core::Loc loc) : Expression(loc) {
     categoryCounterInc("trees", "retry");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Next::Next(core::Loc loc, unique_ptr<Expression> expr) : Expression(loc), expr(std::move(expr)) {
     categoryCounterInc("trees", "next");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Return::Return(core::Loc loc, unique_ptr<Expression> expr) : Expression(loc), expr(std::move(expr)) {
     categoryCounterInc("trees", "return");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 RescueCase::RescueCase(core::Loc loc, EXCEPTION_store exceptions, unique_ptr<Expression> var,
@@ -138,7 +171,7 @@ RescueCase::RescueCase(core::Loc loc, EXCEPTION_store exceptions, unique_ptr<Exp
     : Expression(loc), exceptions(std::move(exceptions)), var(std::move(var)), body(std::move(body)) {
     categoryCounterInc("trees", "rescuecase");
     histogramInc("trees.rescueCase.exceptions", this->exceptions.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Rescue::Rescue(core::Loc loc, unique_ptr<Expression> body, RESCUE_CASE_store rescueCases, unique_ptr<Expression> else_,
@@ -147,30 +180,30 @@ Rescue::Rescue(core::Loc loc, unique_ptr<Expression> body, RESCUE_CASE_store res
       ensure(std::move(ensure)) {
     categoryCounterInc("trees", "rescue");
     histogramInc("trees.rescue.rescuecases", this->rescueCases.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Field::Field(core::Loc loc, core::SymbolRef symbol) : Reference(loc), symbol(symbol) {
     categoryCounterInc("trees", "field");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Local::Local(core::Loc loc, core::LocalVariable localVariable1) : Reference(loc), localVariable(localVariable1) {
     categoryCounterInc("trees", "local");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 UnresolvedIdent::UnresolvedIdent(core::Loc loc, VarKind kind, core::NameRef name)
     : Reference(loc), name(name), kind(kind) {
     categoryCounterInc("trees", "unresolvedident");
-    _sanityCheck();
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Assign::Assign(core::Loc loc, unique_ptr<Expression> lhs, unique_ptr<Expression> rhs)
     : Expression(loc), lhs(std::move(lhs)), rhs(std::move(rhs)) {
     categoryCounterInc("trees", "assign");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Send::Send(core::Loc loc, unique_ptr<Expression> recv, core::NameRef fun, Send::ARGS_store args,
@@ -181,61 +214,61 @@ Send::Send(core::Loc loc, unique_ptr<Expression> recv, core::NameRef fun, Send::
         counterInc("trees.send.with_block");
     }
     histogramInc("trees.send.args", this->args.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Cast::Cast(core::Loc loc, core::TypePtr ty, unique_ptr<Expression> arg, core::NameRef cast)
     : Expression(loc), cast(cast), type(std::move(ty)), arg(std::move(arg)) {
     categoryCounterInc("trees", "cast");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 ZSuperArgs::ZSuperArgs(core::Loc loc) : Expression(loc) {
     categoryCounterInc("trees", "zsuper");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 RestArg::RestArg(core::Loc loc, unique_ptr<Reference> arg) : Reference(loc), expr(std::move(arg)) {
     categoryCounterInc("trees", "restarg");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 KeywordArg::KeywordArg(core::Loc loc, unique_ptr<Reference> expr) : Reference(loc), expr(std::move(expr)) {
     categoryCounterInc("trees", "keywordarg");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 OptionalArg::OptionalArg(core::Loc loc, unique_ptr<Reference> expr, unique_ptr<Expression> default_)
     : Reference(loc), expr(std::move(expr)), default_(std::move(default_)) {
     categoryCounterInc("trees", "optionalarg");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 ShadowArg::ShadowArg(core::Loc loc, unique_ptr<Reference> expr) : Reference(loc), expr(std::move(expr)) {
     categoryCounterInc("trees", "shadowarg");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 BlockArg::BlockArg(core::Loc loc, unique_ptr<Reference> expr) : Reference(loc), expr(std::move(expr)) {
     categoryCounterInc("trees", "blockarg");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Literal::Literal(core::Loc loc, const core::TypePtr &value) : Expression(loc), value(std::move(value)) {
     categoryCounterInc("trees", "literal");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 UnresolvedConstantLit::UnresolvedConstantLit(core::Loc loc, unique_ptr<Expression> scope, core::NameRef cnst)
     : Expression(loc), cnst(cnst), scope(std::move(scope)) {
     categoryCounterInc("trees", "constantlit");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 ConstantLit::ConstantLit(core::Loc loc, core::SymbolRef symbol, unique_ptr<UnresolvedConstantLit> original)
     : Expression(loc), symbol(symbol), original(std::move(original)) {
     categoryCounterInc("trees", "resolvedconstantlit");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 optional<pair<core::SymbolRef, vector<core::NameRef>>>
@@ -261,32 +294,32 @@ ConstantLit::fullUnresolvedPath(const core::GlobalState &gs) const {
 Block::Block(core::Loc loc, MethodDef::ARGS_store args, unique_ptr<Expression> body)
     : Expression(loc), args(std::move(args)), body(std::move(body)) {
     categoryCounterInc("trees", "block");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 };
 
 Hash::Hash(core::Loc loc, ENTRY_store keys, ENTRY_store values)
     : Expression(loc), keys(std::move(keys)), values(std::move(values)) {
     categoryCounterInc("trees", "hash");
     histogramInc("trees.hash.entries", this->keys.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 Array::Array(core::Loc loc, ENTRY_store elems) : Expression(loc), elems(std::move(elems)) {
     categoryCounterInc("trees", "array");
     histogramInc("trees.array.elems", this->elems.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 InsSeq::InsSeq(core::Loc loc, STATS_store stats, unique_ptr<Expression> expr)
     : Expression(loc), stats(std::move(stats)), expr(std::move(expr)) {
     categoryCounterInc("trees", "insseq");
     histogramInc("trees.insseq.stats", this->stats.size());
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 EmptyTree::EmptyTree() : Expression(core::Loc::none()) {
     categoryCounterInc("trees", "emptytree");
-    _sanityCheck();
+    SLOW_DEBUG_ONLY(_sanityCheck());
 }
 
 template <class T> void printElems(const core::GlobalState &gs, stringstream &buf, T &args, int tabs) {
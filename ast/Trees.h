@@ -28,10 +28,18 @@
 
 namespace sorbet::ast {
 
+class Arena;
+
 class Expression {
 public:
     Expression(core::Loc loc);
     virtual ~Expression() = default;
+
+    // Nodes bump-allocate out of the thread's current ast::Arena when one is installed (the index
+    // phase installs one per file); otherwise they fall back to the heap. Arena-backed nodes are
+    // reclaimed wholesale when the owning Arena dies, so operator delete is a no-op for them.
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
     virtual std::string toStringWithTabs(const core::GlobalState &gs, int tabs = 0) const = 0;
     std::string toString(const core::GlobalState &gs) const {
         return toStringWithTabs(gs);
@@ -52,8 +60,15 @@ public:
 // CheckSize(Expression, 16, 8);
 
 struct ParsedFile {
+    // Declared before `tree` so that the nodes are destroyed before the memory backing them.
+    std::shared_ptr<Arena> arena;
     std::unique_ptr<ast::Expression> tree;
     core::FileRef file;
+
+    ParsedFile() = default;
+    ParsedFile(std::unique_ptr<ast::Expression> tree, core::FileRef file) : tree(std::move(tree)), file(file) {}
+    ParsedFile(std::shared_ptr<Arena> arena, std::unique_ptr<ast::Expression> tree, core::FileRef file)
+        : arena(std::move(arena)), tree(std::move(tree)), file(file) {}
 };
 
 /**
@@ -451,7 +451,7 @@ unique_ptr<Expression> node2TreeImpl(DesugarContext dctx, unique_ptr<parser::Nod
                     auto array = make_unique<parser::Array>(loc, std::move(argnodes));
                     auto args = node2TreeImpl(dctx, std::move(array));
                     auto method =
-                        MK::Literal(loc, core::make_type<core::LiteralType>(core::Symbols::Symbol(), send->method));
+                        MK::Literal(loc, core::LiteralType::make_shared(core::Symbols::Symbol(), send->method));
 
                     Send::ARGS_store sendargs;
                     sendargs.emplace_back(std::move(rec));
@@ -492,7 +492,7 @@ unique_ptr<Expression> node2TreeImpl(DesugarContext dctx, unique_ptr<parser::Nod
                         res = MK::Send(loc, std::move(rec), send->method, std::move(args), flags);
                     } else {
                         auto method =
-                            MK::Literal(loc, core::make_type<core::LiteralType>(core::Symbols::Symbol(), send->method));
+                            MK::Literal(loc, core::LiteralType::make_shared(core::Symbols::Symbol(), send->method));
                         auto convertedBlock = node2TreeImpl(dctx, std::move(block));
                         Literal *lit;
                         if ((lit = cast_tree<Literal>(convertedBlock.get())) && lit->isSymbol(dctx.ctx)) {
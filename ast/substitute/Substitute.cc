@@ -1,5 +1,4 @@
 #include "ast/substitute/substitute.h"
-#include "ast/Helpers.h"
 #include "ast/treemap/treemap.h"
 #include "common/typecase.h"
 #include "core/GlobalSubstitution.h"
@@ -19,10 +18,9 @@ private:
             return TreeMap::apply(ctx, *this, move(node));
         }
 
-        auto scope = substClassName(ctx, move(constLit->scope));
-        auto cnst = subst.substitute(constLit->cnst);
-
-        return make_unique<UnresolvedConstantLit>(constLit->loc, move(scope), cnst);
+        constLit->scope = substClassName(ctx, move(constLit->scope));
+        constLit->cnst = subst.substitute(constLit->cnst);
+        return node;
     }
 
     unique_ptr<Expression> substArg(core::MutableContext ctx, unique_ptr<Expression> argp) {
@@ -90,10 +88,10 @@ public:
             // because the newly created nameRef reuses our current GlobalState id
             bool allowSameFromTo = true;
             auto newName = subst.substitute(nameRef, allowSameFromTo);
-            if (newName == nameRef) {
-                return original;
+            if (newName != nameRef) {
+                original->value = core::LiteralType::make_shared(core::Symbols::String(), newName);
             }
-            return MK::String(original->loc, newName);
+            return original;
         }
         if (original->isSymbol(ctx)) {
             auto nameRef = original->asSymbol(ctx);
@@ -101,10 +99,10 @@ public:
             // because the newly created nameRef reuses our current GlobalState id
             bool allowSameFromTo = true;
             auto newName = subst.substitute(nameRef, allowSameFromTo);
-            if (newName == nameRef) {
-                return original;
+            if (newName != nameRef) {
+                original->value = core::LiteralType::make_shared(core::Symbols::Symbol(), newName);
             }
-            return MK::Symbol(original->loc, newName);
+            return original;
         }
         return original;
     }
@@ -248,15 +248,29 @@ struct ReportedRubyException {
     core::Loc onLoc;
 };
 
+// How far down a tree a TreeMapper descends. Shallow walks skip method bodies (and argument
+// default values) entirely, visiting only the definition structure of a tree. Note that skipping
+// any other node kind would be unsound in general: almost every node kind can appear transitively
+// under almost every other one, so "this pass has no Send handler" does not license skipping a
+// Send's children. Method bodies are the one subtree with a usable guarantee — after
+// flatten::runOne every nested definition has been hoisted into its enclosing class body — which
+// is why the depth is a property of the walk, chosen by the caller, and not inferred from FUNC's
+// handler set.
+enum class TreeMapDepth {
+    Full,
+    Shallow,
+};
+
 /**
  * Given a tree transformer FUNC transform a tree.
  * Tree is guaranteed to be visited in the definition order.
  * FUNC may maintain internal state.
  * @tparam tree transformer, see FUNC_EXAMPLE
  */
-template <class FUNC, class CTX> class TreeMapper {
+template <class FUNC, class CTX, TreeMapDepth depth> class TreeMapper {
 private:
     friend class TreeMap;
+    friend class ShallowMap;
 
     FUNC &func;
 
@@ -294,13 +308,15 @@ private:
                 ctx, move(v), func);
         }
 
-        for (auto &arg : v->args) {
-            // Only OptionalArgs have subexpressions within them.
-            if (auto *optArg = cast_tree<OptionalArg>(arg.get())) {
-                optArg->default_ = mapIt(move(optArg->default_), ctx.withOwner(v->symbol));
+        if constexpr (depth == TreeMapDepth::Full) {
+            for (auto &arg : v->args) {
+                // Only OptionalArgs have subexpressions within them.
+                if (auto *optArg = cast_tree<OptionalArg>(arg.get())) {
+                    optArg->default_ = mapIt(move(optArg->default_), ctx.withOwner(v->symbol));
+                }
             }
+            v->rhs = mapIt(move(v->rhs), ctx.withOwner(v->symbol));
         }
-        v->rhs = mapIt(move(v->rhs), ctx.withOwner(v->symbol));
 
         if constexpr (HAS_MEMBER_postTransformMethodDef<FUNC>::value) {
             return PostPonePostTransform_MethodDef<FUNC, CTX, HAS_MEMBER_postTransformMethodDef<FUNC>::value>::call(
@@ -638,59 +654,62 @@ private:
         auto loc = what->loc;
 
         try {
-            // TODO: reorder by frequency
             if constexpr (HAS_MEMBER_preTransformExpression<FUNC>::value) {
                 what = PostPonePreTransform_Expression<FUNC, CTX, HAS_MEMBER_preTransformExpression<FUNC>::value>::call(
                     ctx, move(what), func);
             }
 
-            if (isa_tree<EmptyTree>(what.get()) || isa_tree<ZSuperArgs>(what.get())) {
-                return what;
-            }
+            // Every concrete node class is final, so dispatch on the exact dynamic type: fetch the
+            // type_info once and compare, instead of letting each isa_tree in a chain reload it.
+            // The chain is ordered by node frequency in typical Ruby code. (Computed after the
+            // pre-transform above, which may have replaced the node with one of a different kind.)
+            const std::type_info &ty = typeid(*what);
 
-            if (isa_tree<UnresolvedConstantLit>(what.get())) {
+            if (ty == typeid(Send)) {
+                return mapSend(std::unique_ptr<Send>(static_cast<Send *>(what.release())), ctx);
+            } else if (ty == typeid(Literal)) {
+                return mapLiteral(std::unique_ptr<Literal>(static_cast<Literal *>(what.release())), ctx);
+            } else if (ty == typeid(Local)) {
+                return mapLocal(std::unique_ptr<Local>(static_cast<Local *>(what.release())), ctx);
+            } else if (ty == typeid(UnresolvedConstantLit)) {
                 return mapUnresolvedConstantLit(
                     std::unique_ptr<UnresolvedConstantLit>(static_cast<UnresolvedConstantLit *>(what.release())), ctx);
-            } else if (isa_tree<ConstantLit>(what.get())) {
+            } else if (ty == typeid(ConstantLit)) {
                 return mapConstantLit(std::unique_ptr<ConstantLit>(static_cast<ConstantLit *>(what.release())), ctx);
-            } else if (isa_tree<Send>(what.get())) {
-                return mapSend(std::unique_ptr<Send>(static_cast<Send *>(what.release())), ctx);
-            } else if (isa_tree<Literal>(what.get())) {
-                return mapLiteral(std::unique_ptr<Literal>(static_cast<Literal *>(what.release())), ctx);
-            } else if (UnresolvedIdent *u = cast_tree<UnresolvedIdent>(what.get())) {
+            } else if (ty == typeid(UnresolvedIdent)) {
                 return mapUnresolvedIdent(
                     std::unique_ptr<UnresolvedIdent>(static_cast<UnresolvedIdent *>(what.release())), ctx);
-            } else if (isa_tree<Local>(what.get())) {
-                return mapLocal(std::unique_ptr<Local>(static_cast<Local *>(what.release())), ctx);
-            } else if (isa_tree<MethodDef>(what.get())) {
+            } else if (ty == typeid(EmptyTree) || ty == typeid(ZSuperArgs)) {
+                return what;
+            } else if (ty == typeid(MethodDef)) {
                 return mapMethodDef(std::unique_ptr<MethodDef>(static_cast<MethodDef *>(what.release())), ctx);
-            } else if (isa_tree<InsSeq>(what.get())) {
+            } else if (ty == typeid(InsSeq)) {
                 return mapInsSeq(std::unique_ptr<InsSeq>(static_cast<InsSeq *>(what.release())), ctx);
-            } else if (isa_tree<Hash>(what.get())) {
+            } else if (ty == typeid(Hash)) {
                 return mapHash(std::unique_ptr<Hash>(static_cast<Hash *>(what.release())), ctx);
-            } else if (isa_tree<ClassDef>(what.get())) {
+            } else if (ty == typeid(ClassDef)) {
                 return mapClassDef(std::unique_ptr<ClassDef>(static_cast<ClassDef *>(what.release())), ctx);
-            } else if (isa_tree<If>(what.get())) {
+            } else if (ty == typeid(If)) {
                 return mapIf(std::unique_ptr<If>(static_cast<If *>(what.release())), ctx);
-            } else if (isa_tree<While>(what.get())) {
+            } else if (ty == typeid(While)) {
                 return mapWhile(std::unique_ptr<While>(static_cast<While *>(what.release())), ctx);
-            } else if (isa_tree<Break>(what.get())) {
+            } else if (ty == typeid(Break)) {
                 return mapBreak(std::unique_ptr<Break>(static_cast<Break *>(what.release())), ctx);
-            } else if (isa_tree<Retry>(what.get())) {
+            } else if (ty == typeid(Retry)) {
                 return mapRetry(std::unique_ptr<Retry>(static_cast<Retry *>(what.release())), ctx);
-            } else if (isa_tree<Next>(what.get())) {
+            } else if (ty == typeid(Next)) {
                 return mapNext(std::unique_ptr<Next>(static_cast<Next *>(what.release())), ctx);
-            } else if (isa_tree<Return>(what.get())) {
+            } else if (ty == typeid(Return)) {
                 return mapReturn(std::unique_ptr<Return>(static_cast<Return *>(what.release())), ctx);
-            } else if (isa_tree<Rescue>(what.get())) {
+            } else if (ty == typeid(Rescue)) {
                 return mapRescue(std::unique_ptr<Rescue>(static_cast<Rescue *>(what.release())), ctx);
-            } else if (isa_tree<Field>(what.get())) {
+            } else if (ty == typeid(Field)) {
                 return mapField(std::unique_ptr<Field>(static_cast<Field *>(what.release())), ctx);
-            } else if (isa_tree<Assign>(what.get())) {
+            } else if (ty == typeid(Assign)) {
                 return mapAssign(std::unique_ptr<Assign>(static_cast<Assign *>(what.release())), ctx);
-            } else if (isa_tree<Array>(what.get())) {
+            } else if (ty == typeid(Array)) {
                 return mapArray(std::unique_ptr<Array>(static_cast<Array *>(what.release())), ctx);
-            } else if (isa_tree<Cast>(what.get())) {
+            } else if (ty == typeid(Cast)) {
                 return mapCast(std::unique_ptr<Cast>(static_cast<Cast *>(what.release())), ctx);
             } else {
                 Exception::raise("should never happen. Forgot to add new tree kind? {}", what->nodeName());
@@ -707,7 +726,28 @@ class TreeMap {
 public:
     template <typename CTX, typename FUNC>
     static unique_ptr<Expression> apply(CTX ctx, FUNC &func, unique_ptr<Expression> to) {
-        TreeMapper<FUNC, CTX> walker(func);
+        TreeMapper<FUNC, CTX, TreeMapDepth::Full> walker(func);
+        try {
+            return walker.mapIt(move(to), ctx);
+        } catch (ReportedRubyException &exception) {
+            Exception::failInFuzzer();
+            if (auto e = ctx.state.beginError(exception.onLoc, core::errors::Internal::InternalError)) {
+                e.setHeader("Failed to process tree (backtrace is above)");
+            }
+            throw exception.reported;
+        }
+    }
+};
+
+// A TreeMap that does not descend into method bodies. Only valid on trees that have been through
+// flatten::runOne (see the comment on TreeMapDepth), and only useful for transformers whose
+// handlers are all on definition-level nodes; a handler for e.g. Send would silently miss every
+// send inside a method body.
+class ShallowMap {
+public:
+    template <typename CTX, typename FUNC>
+    static unique_ptr<Expression> apply(CTX ctx, FUNC &func, unique_ptr<Expression> to) {
+        TreeMapper<FUNC, CTX, TreeMapDepth::Shallow> walker(func);
         try {
             return walker.mapIt(move(to), ctx);
         } catch (ReportedRubyException &exception) {
@@ -23,7 +23,7 @@ public:
 };
 
 unique_ptr<Expression> Verifier::run(core::Context ctx, unique_ptr<Expression> node) {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return node;
     }
     VerifierWalker vw;
@@ -0,0 +1,38 @@
+#include "cfg/Arena.h"
+#include <new>
+
+using namespace std;
+
+namespace sorbet::cfg {
+
+namespace {
+thread_local Arena *currentArena = nullptr;
+} // namespace
+
+Arena *&Arena::current() {
+    return currentArena;
+}
+
+void Arena::grow(size_t atLeast) {
+    auto chunkSize = max(CHUNK_SIZE, atLeast);
+    auto *mem = static_cast<char *>(std::malloc(chunkSize));
+    if (mem == nullptr) {
+        throw bad_alloc();
+    }
+    chunks.emplace_back(mem);
+    pos = mem;
+    end = mem + chunkSize;
+}
+
+void *Arena::allocate(size_t size) {
+    constexpr size_t alignment = alignof(max_align_t);
+    size = (size + alignment - 1) & ~(alignment - 1);
+    if (size > static_cast<size_t>(end - pos)) {
+        grow(size);
+    }
+    auto *ret = pos;
+    pos += size;
+    return ret;
+}
+
+} // namespace sorbet::cfg
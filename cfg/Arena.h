@@ -0,0 +1,60 @@
+#ifndef SORBET_CFG_ARENA_H
+#define SORBET_CFG_ARENA_H
+
+#include "common/common.h"
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace sorbet::cfg {
+
+// A bump allocator for CFG storage.
+//
+// A method's CFG is built once, walked by inference, and thrown away; its BasicBlocks and
+// Instructions all share that lifetime, so there is nothing for per-node malloc/free to buy except
+// scattered placement. While an Arena is installed (see Arena::Guard), BasicBlock's and
+// Instruction's operator new carve out of contiguous chunks in construction order — which is close
+// to the order inference visits them — and deletes of arena-backed objects are no-ops; the memory
+// is released all at once when the CFG drops its arena.
+class Arena final {
+    static constexpr std::size_t CHUNK_SIZE = 32768;
+    struct FreeDeleter {
+        void operator()(char *ptr) const {
+            std::free(ptr);
+        }
+    };
+    std::vector<std::unique_ptr<char[], FreeDeleter>> chunks;
+    char *pos = nullptr;
+    char *end = nullptr;
+
+    void grow(std::size_t atLeast);
+
+public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(std::size_t size);
+
+    // The arena (if any) that CFG allocations on this thread bump out of.
+    static Arena *&current();
+
+    // Installs an arena as this thread's current arena for the guard's lifetime.
+    class Guard final {
+        Arena *prev;
+
+    public:
+        Guard(Arena *arena) : prev(current()) {
+            current() = arena;
+        }
+        ~Guard() {
+            current() = prev;
+        }
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+    };
+};
+
+} // namespace sorbet::cfg
+
+#endif // SORBET_CFG_ARENA_H
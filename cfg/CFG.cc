@@ -3,6 +3,8 @@
 #include "absl/strings/str_split.h"
 #include "common/Timer.h"
 #include "common/formatting.h"
+#include <cstdlib>
+#include <new>
 
 // helps debugging
 template class std::unique_ptr<sorbet::cfg::CFG>;
@@ -13,6 +15,35 @@ using namespace std;
 
 namespace sorbet::cfg {
 
+namespace {
+constexpr size_t allocHeaderSize = alignof(std::max_align_t);
+} // namespace
+
+void *BasicBlock::operator new(std::size_t size) {
+    auto *arena = Arena::current();
+    char *mem;
+    if (arena != nullptr) {
+        mem = static_cast<char *>(arena->allocate(size + allocHeaderSize));
+    } else {
+        mem = static_cast<char *>(std::malloc(size + allocHeaderSize));
+        if (mem == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    *reinterpret_cast<uintptr_t *>(mem) = arena != nullptr ? 1 : 0;
+    return mem + allocHeaderSize;
+}
+
+void BasicBlock::operator delete(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto *mem = static_cast<char *>(ptr) - allocHeaderSize;
+    if (*reinterpret_cast<uintptr_t *>(mem) == 0) {
+        std::free(mem);
+    }
+}
+
 BasicBlock *CFG::freshBlock(int outerLoops, int rubyBlockId) {
     int id = this->maxBasicBlockId++;
     auto &r = this->basicBlocks.emplace_back(make_unique<BasicBlock>());
@@ -30,13 +61,23 @@ CFG::CFG() {
     deadBlock()->bexit.cond.variable = core::LocalVariable::noVariable();
 }
 
-CFG::ReadsAndWrites CFG::findAllReadsAndWrites(core::Context ctx) {
+void CFGScratch::resetSets(vector<UnorderedSet<core::LocalVariable>> &sets, int size) {
+    if (sets.size() < static_cast<size_t>(size)) {
+        sets.resize(size);
+    }
+    for (int i = 0; i < size; i++) {
+        sets[i].clear();
+    }
+}
+
+const CFG::ReadsAndWrites &CFG::findAllReadsAndWrites(core::Context ctx, CFGScratch &scratch) {
     Timer timeit(ctx.state.tracer(), "findAllReadsAndWrites");
-    CFG::ReadsAndWrites target;
-    target.reads.resize(maxBasicBlockId);
-    target.writes.resize(maxBasicBlockId);
-    target.dead.resize(maxBasicBlockId);
-    vector<UnorderedSet<core::LocalVariable>> readsAndWrites(maxBasicBlockId);
+    CFG::ReadsAndWrites &target = scratch.readsAndWrites;
+    CFGScratch::resetSets(target.reads, maxBasicBlockId);
+    CFGScratch::resetSets(target.writes, maxBasicBlockId);
+    CFGScratch::resetSets(target.dead, maxBasicBlockId);
+    CFGScratch::resetSets(scratch.readsAndWritesUnion, maxBasicBlockId);
+    vector<UnorderedSet<core::LocalVariable>> &readsAndWrites = scratch.readsAndWritesUnion;
 
     for (unique_ptr<BasicBlock> &bb : this->basicBlocks) {
         auto &blockWrites = target.writes[bb->id];
@@ -95,7 +136,8 @@ CFG::ReadsAndWrites CFG::findAllReadsAndWrites(core::Context ctx) {
             blockReadsAndWrites.insert(bb->bexit.cond.variable);
         }
     }
-    UnorderedMap<core::LocalVariable, pair<int, int>> usageCounts;
+    auto &usageCounts = scratch.usageCounts;
+    usageCounts.clear();
 
     {
         Timer timeit(ctx.state.tracer(), "privates1");
@@ -119,7 +161,7 @@ CFG::ReadsAndWrites CFG::findAllReadsAndWrites(core::Context ctx) {
 }
 
 void CFG::sanityCheck(core::Context ctx) {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return;
     }
 
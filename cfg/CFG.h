@@ -7,6 +7,7 @@
 #include <climits>
 #include <memory>
 
+#include "cfg/Arena.h"
 #include "cfg/Instructions.h"
 
 //
@@ -21,6 +22,7 @@
 namespace sorbet::cfg {
 
 class BasicBlock;
+struct CFGScratch;
 
 class BlockExit final {
 public:
@@ -65,6 +67,11 @@ public:
         counterInc("basicblocks");
     };
 
+    // Like Instruction, BasicBlocks bump-allocate out of the thread's current cfg::Arena when one
+    // is installed; see cfg/Arena.h.
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
+
     std::string toString(core::Context ctx) const;
     std::string showRaw(core::Context ctx) const;
 };
@@ -73,11 +80,15 @@ class CFGContext;
 
 class CFG final {
     friend class CFGBuilder;
+    friend class CFGSerializer;
     /**
      * CFG owns all the BasicBlocks, and then they have raw unmanaged pointers to and between each other,
      * because they all have lifetime identical with each other and the CFG.
      */
 public:
+    // Backs all of this CFG's BasicBlocks and Instructions. Declared first so it is destroyed
+    // last, after every unique_ptr into it has run its (no-op) delete.
+    std::shared_ptr<Arena> arena;
     core::SymbolRef symbol;
     int maxBasicBlockId = 0;
     int maxRubyBlockId = 0;
@@ -126,7 +137,8 @@ public:
         // inference.
         std::vector<UnorderedSet<core::LocalVariable>> dead;
     };
-    ReadsAndWrites findAllReadsAndWrites(core::Context ctx);
+    // The returned reference points into `scratch` and stays valid until the next CFG reuses it.
+    const ReadsAndWrites &findAllReadsAndWrites(core::Context ctx, CFGScratch &scratch);
 
     // Should this CFG be exported?
     bool shouldExport(const core::GlobalState &gs) const;
@@ -136,6 +148,29 @@ private:
     BasicBlock *freshBlock(int outerLoops, int rubyBlockid);
 };
 
+// Scratch space for CFG construction, reused across CFGBuilder::buildFor invocations on one
+// thread. The builder's working sets below grow to fit the largest method seen so far and are only
+// emptied between methods — the vectors keep their capacity outright and absl's clear() keeps the
+// backing array for small tables — so the dominant small method allocates next to nothing here.
+// Not thread-safe: give each typechecking worker its own instance.
+struct CFGScratch {
+    UnorderedMap<core::SymbolRef, core::LocalVariable> aliases;
+    UnorderedMap<core::NameRef, core::LocalVariable> discoveredUndeclaredFields;
+
+    // findAllReadsAndWrites' result sets, its per-block union of reads and writes, and its
+    // per-variable usage counts.
+    CFG::ReadsAndWrites readsAndWrites;
+    std::vector<UnorderedSet<core::LocalVariable>> readsAndWritesUnion;
+    UnorderedMap<core::LocalVariable, std::pair<int, int>> usageCounts;
+
+    // fillInBlockArguments' two per-block upper bounds.
+    std::vector<UnorderedSet<core::LocalVariable>> upperBounds1;
+    std::vector<UnorderedSet<core::LocalVariable>> upperBounds2;
+
+    // Grows `sets` to at least `size` entries and empties the ones the previous method used.
+    static void resetSets(std::vector<UnorderedSet<core::LocalVariable>> &sets, int size);
+};
+
 } // namespace sorbet::cfg
 
 #endif // SORBET_CFG_H
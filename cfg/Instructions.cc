@@ -1,9 +1,12 @@
 #include "Instructions.h"
 
+#include "cfg/Arena.h"
 #include "common/formatting.h"
 #include "common/typecase.h"
 #include "core/Names.h"
 #include "core/TypeConstraint.h"
+#include <cstdlib>
+#include <new>
 #include <utility>
 // helps debugging
 template class std::unique_ptr<sorbet::cfg::Instruction>;
@@ -20,9 +23,38 @@ string spacesForTabLevel(int tabs) {
     }
     return to_string(ss);
 }
+// Every allocation carries a one-word header recording whether it came from an arena, padded to
+// keep the object itself maximally aligned.
+constexpr size_t allocHeaderSize = alignof(std::max_align_t);
 } // namespace
 
-Return::Return(core::LocalVariable what) : what(what) {
+void *Instruction::operator new(std::size_t size) {
+    auto *arena = Arena::current();
+    char *mem;
+    if (arena != nullptr) {
+        mem = static_cast<char *>(arena->allocate(size + allocHeaderSize));
+    } else {
+        mem = static_cast<char *>(std::malloc(size + allocHeaderSize));
+        if (mem == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    *reinterpret_cast<uintptr_t *>(mem) = arena != nullptr ? 1 : 0;
+    return mem + allocHeaderSize;
+}
+
+void Instruction::operator delete(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto *mem = static_cast<char *>(ptr) - allocHeaderSize;
+    if (*reinterpret_cast<uintptr_t *>(mem) == 0) {
+        std::free(mem);
+    }
+    // Arena-backed instructions are reclaimed when the owning arena dies.
+}
+
+Return::Return(core::LocalVariable what) : Instruction(Tag::Return), what(what) {
     categoryCounterInc("cfg", "return");
 }
 
@@ -44,7 +76,7 @@ string Return::showRaw(core::Context ctx, int tabs) const {
 }
 
 BlockReturn::BlockReturn(shared_ptr<core::SendAndBlockLink> link, core::LocalVariable what)
-    : link(std::move(link)), what(what) {
+    : Instruction(Tag::BlockReturn), link(std::move(link)), what(what) {
     categoryCounterInc("cfg", "blockreturn");
 }
 
@@ -58,7 +90,7 @@ string BlockReturn::showRaw(core::Context ctx, int tabs) const {
 }
 
 LoadSelf::LoadSelf(shared_ptr<core::SendAndBlockLink> link, core::LocalVariable fallback)
-    : link(std::move(link)), fallback(fallback) {
+    : Instruction(Tag::LoadSelf), link(std::move(link)), fallback(fallback) {
     categoryCounterInc("cfg", "loadself");
 }
 
@@ -73,8 +105,8 @@ string LoadSelf::showRaw(core::Context ctx, int tabs) const {
 Send::Send(core::LocalVariable recv, core::NameRef fun, core::Loc receiverLoc,
            const InlinedVector<core::LocalVariable, 2> &args, InlinedVector<core::Loc, 2> argLocs, bool isPrivateOk,
            const shared_ptr<core::SendAndBlockLink> &link)
-    : recv(recv), fun(fun), receiverLoc(receiverLoc), argLocs(std::move(argLocs)), isPrivateOk(isPrivateOk),
-      link(move(link)) {
+    : Instruction(Tag::Send), recv(recv), fun(fun), receiverLoc(receiverLoc), argLocs(std::move(argLocs)),
+      isPrivateOk(isPrivateOk), link(move(link)) {
     this->args.resize(args.size());
     int i = 0;
     for (const auto &e : args) {
@@ -85,7 +117,7 @@ Send::Send(core::LocalVariable recv, core::NameRef fun, core::Loc receiverLoc,
     histogramInc("cfg.send.args", this->args.size());
 }
 
-Literal::Literal(const core::TypePtr &value) : value(move(value)) {
+Literal::Literal(const core::TypePtr &value) : Instruction(Tag::Literal), value(move(value)) {
     categoryCounterInc("cfg", "literal");
 }
 
@@ -112,11 +144,11 @@ string Literal::showRaw(core::Context ctx, int tabs) const {
     return fmt::format("Literal {{ value = {} }}", this->value->show(ctx));
 }
 
-Ident::Ident(core::LocalVariable what) : what(what) {
+Ident::Ident(core::LocalVariable what) : Instruction(Tag::Ident), what(what) {
     categoryCounterInc("cfg", "ident");
 }
 
-Alias::Alias(core::SymbolRef what) : what(what) {
+Alias::Alias(core::SymbolRef what) : Instruction(Tag::Alias), what(what) {
     categoryCounterInc("cfg", "alias");
 }
 
@@ -1,6 +1,7 @@
 #ifndef SORBET_INSTRUCTIONS_H
 #define SORBET_INSTRUCTIONS_H
 
+#include "common/typecase.h"
 #include "core/Context.h"
 #include "core/GlobalState.h"
 #include "core/LocalVariable.h"
@@ -32,18 +33,62 @@ public:
 // When adding a new subtype, see if you need to add it to fillInBlockArguments
 class Instruction {
 public:
+    // Identifies the concrete subclass. Each subclass passes its tag up at construction, and
+    // cast_instruction dispatches on it with one integer compare instead of a typeid lookup or
+    // dynamic_cast, so a typecase over instructions costs a short run of predictable compares no
+    // matter where in the handler list the matching type sits.
+    enum class Tag : u1 {
+        Ident = 1,
+        Alias,
+        SolveConstraint,
+        Send,
+        Return,
+        BlockReturn,
+        LoadSelf,
+        Literal,
+        Unanalyzable,
+        NotSupported,
+        LoadArg,
+        LoadYieldParams,
+        Cast,
+        TAbsurd,
+    };
+    const Tag tag;
+
     virtual ~Instruction() = default;
     virtual std::string toString(core::Context ctx) const = 0;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const = 0;
-    Instruction() = default;
     bool isSynthetic = false;
+
+protected:
+    Instruction(Tag tag) : tag(tag) {}
+
+public:
+    // Instructions bump-allocate out of the thread's current cfg::Arena when one is installed
+    // (CFGBuilder::buildFor installs one per method); otherwise they fall back to the heap.
+    // Arena-backed instructions are reclaimed wholesale when the owning CFG's arena dies.
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
 };
 
+// Maps each concrete subclass to its tag; specialized for every subclass below.
+template <class To> struct InstructionTag;
+
 template <class To> To *cast_instruction(Instruction *what) {
     static_assert(!std::is_pointer<To>::value, "To has to be a pointer");
     static_assert(std::is_assignable<Instruction *&, To *>::value,
                   "Ill Formed To, has to be a subclass of Instruction");
-    return fast_cast<Instruction, To>(what);
+    if constexpr (std::is_same<To, Instruction>::value) {
+        return what;
+    } else {
+        if (what == nullptr) {
+            return nullptr;
+        }
+        To *result = what->tag == InstructionTag<To>::value ? static_cast<To *>(what) : nullptr;
+        // The tag and the dynamic type must agree; catches a subclass wired up with the wrong tag.
+        ENFORCE(result == (fast_cast<Instruction, To>(what)));
+        return result;
+    }
 }
 
 template <class To> bool isa_instruction(Instruction *what) {
@@ -76,7 +121,7 @@ public:
     std::shared_ptr<core::SendAndBlockLink> link;
     core::LocalVariable send;
     SolveConstraint(const std::shared_ptr<core::SendAndBlockLink> &link, core::LocalVariable send)
-        : link(link), send(send){};
+        : Instruction(Tag::SolveConstraint), link(link), send(send){};
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
 };
@@ -99,7 +144,7 @@ public:
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
 };
-CheckSize(Send, 160, 8);
+CheckSize(Send, 136, 8);
 
 class Return final : public Instruction {
 public:
@@ -109,7 +154,7 @@ public:
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
 };
-CheckSize(Return, 40, 8);
+CheckSize(Return, 32, 8);
 
 class BlockReturn final : public Instruction {
 public:
@@ -120,7 +165,7 @@ public:
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
 };
-CheckSize(BlockReturn, 56, 8);
+CheckSize(BlockReturn, 48, 8);
 
 class LoadSelf final : public Instruction {
 public:
@@ -140,15 +185,21 @@ public:
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
 };
-CheckSize(Literal, 32, 8);
+CheckSize(Literal, 24, 8);
 
 class Unanalyzable : public Instruction {
 public:
-    Unanalyzable() {
+    Unanalyzable() : Instruction(Tag::Unanalyzable) {
         categoryCounterInc("cfg", "unanalyzable");
     };
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
+
+protected:
+    // For subclasses, which carry their own tag.
+    Unanalyzable(Tag tag) : Instruction(tag) {
+        categoryCounterInc("cfg", "unanalyzable");
+    }
 };
 CheckSize(Unanalyzable, 16, 8);
 
@@ -156,7 +207,7 @@ class NotSupported final : public Unanalyzable {
 public:
     std::string why;
 
-    NotSupported(std::string_view why) : why(why) {
+    NotSupported(std::string_view why) : Unanalyzable(Tag::NotSupported), why(why) {
         categoryCounterInc("cfg", "notsupported");
     };
     virtual std::string toString(core::Context ctx) const;
@@ -169,7 +220,7 @@ public:
     core::SymbolRef method;
     u2 argId;
 
-    LoadArg(core::SymbolRef method, int argId) : method(method), argId(argId) {
+    LoadArg(core::SymbolRef method, int argId) : Instruction(Tag::LoadArg), method(method), argId(argId) {
         categoryCounterInc("cfg", "loadarg");
     };
 
@@ -183,7 +234,8 @@ class LoadYieldParams final : public Instruction {
 public:
     std::shared_ptr<core::SendAndBlockLink> link;
 
-    LoadYieldParams(const std::shared_ptr<core::SendAndBlockLink> &link) : link(link) {
+    LoadYieldParams(const std::shared_ptr<core::SendAndBlockLink> &link)
+        : Instruction(Tag::LoadYieldParams), link(link) {
         categoryCounterInc("cfg", "loadarg");
     };
     virtual std::string toString(core::Context ctx) const;
@@ -198,26 +250,74 @@ public:
     core::NameRef cast;
 
     Cast(core::LocalVariable value, const core::TypePtr &type, core::NameRef cast)
-        : value(value), type(type), cast(cast) {}
+        : Instruction(Tag::Cast), value(value), type(type), cast(cast) {}
 
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
 };
-CheckSize(Cast, 64, 8);
+CheckSize(Cast, 48, 8);
 
 class TAbsurd final : public Instruction {
 public:
     VariableUseSite what;
 
-    TAbsurd(core::LocalVariable what) : what(what) {
+    TAbsurd(core::LocalVariable what) : Instruction(Tag::TAbsurd), what(what) {
         categoryCounterInc("cfg", "tabsurd");
     }
 
     virtual std::string toString(core::Context ctx) const;
     virtual std::string showRaw(core::Context ctx, int tabs = 0) const;
 };
-CheckSize(TAbsurd, 40, 8);
+CheckSize(TAbsurd, 32, 8);
+
+template <> struct InstructionTag<Ident> { static constexpr Instruction::Tag value = Instruction::Tag::Ident; };
+template <> struct InstructionTag<Alias> { static constexpr Instruction::Tag value = Instruction::Tag::Alias; };
+template <> struct InstructionTag<SolveConstraint> {
+    static constexpr Instruction::Tag value = Instruction::Tag::SolveConstraint;
+};
+template <> struct InstructionTag<Send> { static constexpr Instruction::Tag value = Instruction::Tag::Send; };
+template <> struct InstructionTag<Return> { static constexpr Instruction::Tag value = Instruction::Tag::Return; };
+template <> struct InstructionTag<BlockReturn> {
+    static constexpr Instruction::Tag value = Instruction::Tag::BlockReturn;
+};
+template <> struct InstructionTag<LoadSelf> { static constexpr Instruction::Tag value = Instruction::Tag::LoadSelf; };
+template <> struct InstructionTag<Literal> { static constexpr Instruction::Tag value = Instruction::Tag::Literal; };
+template <> struct InstructionTag<Unanalyzable> {
+    static constexpr Instruction::Tag value = Instruction::Tag::Unanalyzable;
+};
+template <> struct InstructionTag<NotSupported> {
+    static constexpr Instruction::Tag value = Instruction::Tag::NotSupported;
+};
+template <> struct InstructionTag<LoadArg> { static constexpr Instruction::Tag value = Instruction::Tag::LoadArg; };
+template <> struct InstructionTag<LoadYieldParams> {
+    static constexpr Instruction::Tag value = Instruction::Tag::LoadYieldParams;
+};
+template <> struct InstructionTag<Cast> { static constexpr Instruction::Tag value = Instruction::Tag::Cast; };
+template <> struct InstructionTag<TAbsurd> { static constexpr Instruction::Tag value = Instruction::Tag::TAbsurd; };
+
+// Unanalyzable is the one Instruction subclass that is itself subclassed (NotSupported derives from
+// it; serialize relies on that), so casting to it has to accept either tag.
+template <> inline Unanalyzable *cast_instruction<Unanalyzable>(Instruction *what) {
+    if (what == nullptr) {
+        return nullptr;
+    }
+    Unanalyzable *result =
+        what->tag == Instruction::Tag::Unanalyzable || what->tag == Instruction::Tag::NotSupported
+            ? static_cast<Unanalyzable *>(what)
+            : nullptr;
+    ENFORCE(result == (fast_cast<Instruction, Unanalyzable>(what)));
+    return result;
+}
 
 } // namespace sorbet::cfg
 
+namespace sorbet {
+// Route typecase over instructions through the tag compare instead of the generic typeid path.
+template <typename To> struct TypecaseCast<cfg::Instruction, To> {
+    static To *cast(cfg::Instruction *what) {
+        return cfg::cast_instruction<To>(what);
+    }
+};
+} // namespace sorbet
+
 #endif // SORBET_CFG_H
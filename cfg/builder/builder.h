@@ -7,15 +7,18 @@
 namespace sorbet::cfg {
 class CFGBuilder final {
 public:
-    static std::unique_ptr<CFG> buildFor(core::Context ctx, ast::MethodDef &md);
+    // `scratch` holds the builder's reusable working sets; callers that build many CFGs (one per
+    // method) should keep one instance per thread and pass it to every call.
+    static std::unique_ptr<CFG> buildFor(core::Context ctx, ast::MethodDef &md, CFGScratch &scratch);
 
 private:
     static BasicBlock *walk(CFGContext cctx, ast::Expression *what, BasicBlock *current);
     static void fillInTopoSorts(core::Context ctx, CFG &cfg);
     static void dealias(core::Context ctx, CFG &cfg);
     static void simplify(core::Context ctx, CFG &cfg);
+    static void pruneDeadConditionBranches(core::Context ctx, CFG &cfg);
     static void sanityCheck(core::Context ctx, CFG &cfg);
-    static void fillInBlockArguments(core::Context ctx, const CFG::ReadsAndWrites &RnW, CFG &cfg);
+    static void fillInBlockArguments(core::Context ctx, const CFG::ReadsAndWrites &RnW, CFG &cfg, CFGScratch &scratch);
     static void computeMinMaxLoops(core::Context ctx, const CFG::ReadsAndWrites &RnW, CFG &cfg);
     static void removeDeadAssigns(core::Context ctx, const CFG::ReadsAndWrites &RnW, CFG &cfg);
     static void markLoopHeaders(core::Context ctx, CFG &cfg);
@@ -51,7 +54,7 @@ public:
     core::LocalVariable newTemporary(core::NameRef name);
 
 private:
-    friend std::unique_ptr<CFG> CFGBuilder::buildFor(core::Context ctx, ast::MethodDef &md);
+    friend std::unique_ptr<CFG> CFGBuilder::buildFor(core::Context ctx, ast::MethodDef &md, CFGScratch &scratch);
     CFGContext(core::Context ctx, CFG &inWhat, core::LocalVariable target, int loops, int rubyBlockId,
                BasicBlock *nextScope, BasicBlock *breakScope, BasicBlock *rescueScope,
                UnorderedMap<core::SymbolRef, core::LocalVariable> &aliases,
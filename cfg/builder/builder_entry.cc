@@ -9,18 +9,25 @@ namespace sorbet::cfg {
 
 void jumpToDead(BasicBlock *from, CFG &inWhat, core::Loc loc);
 
-unique_ptr<CFG> CFGBuilder::buildFor(core::Context ctx, ast::MethodDef &md) {
+unique_ptr<CFG> CFGBuilder::buildFor(core::Context ctx, ast::MethodDef &md, CFGScratch &scratch) {
     ENFORCE(md.symbol.exists());
     ENFORCE(!md.symbol.data(ctx)->isOverloaded());
+    auto arena = make_shared<Arena>();
+    // The guard covers the whole build, so every BasicBlock and Instruction created below (and in
+    // the walk/finalize passes this calls into) lands in the CFG's arena.
+    Arena::Guard arenaGuard(arena.get());
     unique_ptr<CFG> res(new CFG); // private constructor
+    res->arena = move(arena);
     res->symbol = md.symbol.data(ctx)->dealiasMethod(ctx);
     if (res->symbol.data(ctx)->isAbstract()) {
         res->basicBlocks.clear();
         return res;
     }
     u4 temporaryCounter = 1;
-    UnorderedMap<core::SymbolRef, core::LocalVariable> aliases;
-    UnorderedMap<core::NameRef, core::LocalVariable> discoveredUndeclaredFields;
+    auto &aliases = scratch.aliases;
+    auto &discoveredUndeclaredFields = scratch.discoveredUndeclaredFields;
+    aliases.clear();
+    discoveredUndeclaredFields.clear();
     CFGContext cctx(ctx, *res.get(), core::LocalVariable(), 0, 0, nullptr, nullptr, nullptr, aliases,
                     discoveredUndeclaredFields, temporaryCounter);
 
@@ -78,9 +85,10 @@ unique_ptr<CFG> CFGBuilder::buildFor(core::Context ctx, ast::MethodDef &md) {
     sanityCheck(ctx, *res);
     fillInTopoSorts(ctx, *res);
     dealias(ctx, *res);
-    CFG::ReadsAndWrites RnW = res->findAllReadsAndWrites(ctx);
+    pruneDeadConditionBranches(ctx, *res);
+    const CFG::ReadsAndWrites &RnW = res->findAllReadsAndWrites(ctx, scratch);
     computeMinMaxLoops(ctx, RnW, *res);
-    fillInBlockArguments(ctx, RnW, *res);
+    fillInBlockArguments(ctx, RnW, *res, scratch);
     removeDeadAssigns(ctx, RnW, *res); // requires block arguments to be filled
     simplify(ctx, *res);
     histogramInc("cfgbuilder.basicBlocksSimplified", basicBlockCreated - res->basicBlocks.size());
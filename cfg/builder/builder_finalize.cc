@@ -107,8 +107,77 @@ void CFGBuilder::simplify(core::Context ctx, CFG &cfg) {
     }
 }
 
+void CFGBuilder::pruneDeadConditionBranches(core::Context ctx, CFG &cfg) {
+    if (!ctx.state.pruneDeadCfgBranches) {
+        return;
+    }
+    // Queries want responses from dead regions too; same reasoning as in simplify.
+    if (!ctx.state.lspQuery.isEmpty()) {
+        return;
+    }
+
+    bool redirected = false;
+    for (auto &bb : cfg.basicBlocks) {
+        if (bb->bexit.thenb == bb->bexit.elseb || !bb->bexit.isCondSet() ||
+            bb->bexit.cond.variable == core::LocalVariable::blockCall()) {
+            continue;
+        }
+        // The branch is decidable when the last write to the condition in this block is a literal.
+        // A write in another block means the value is not a compile-time constant on this edge, so
+        // only same-block bindings are consulted; a later non-literal write clears the verdict.
+        core::TypePtr condType;
+        for (auto &binding : bb->exprs) {
+            if (binding.bind.variable == bb->bexit.cond.variable) {
+                auto *lit = cast_instruction<Literal>(binding.value.get());
+                condType = lit != nullptr ? lit->value : nullptr;
+            }
+        }
+        if (condType == nullptr) {
+            continue;
+        }
+        // Literals are exact values, so truthiness is just "neither false nor nil".
+        bool truthy = !condType->derivesFrom(ctx, core::Symbols::FalseClass()) &&
+                      !condType->derivesFrom(ctx, core::Symbols::NilClass());
+        auto *dead = truthy ? bb->bexit.elseb : bb->bexit.thenb;
+        auto *live = truthy ? bb->bexit.thenb : bb->bexit.elseb;
+        dead->backEdges.erase(remove(dead->backEdges.begin(), dead->backEdges.end(), bb.get()), dead->backEdges.end());
+        bb->bexit.thenb = live;
+        bb->bexit.elseb = live;
+        counterInc("cfgbuilder.prunedConditionBranches");
+        redirected = true;
+    }
+    if (!redirected) {
+        return;
+    }
+
+    // Measure what inference no longer sees: instructions in blocks that just became unreachable,
+    // against the totals of the methods where pruning fired. simplify below deletes the blocks.
+    int totalInstructions = 0;
+    int prunedInstructions = 0;
+    UnorderedSet<BasicBlock *> reachable;
+    vector<BasicBlock *> frontier = {cfg.entry()};
+    while (!frontier.empty()) {
+        auto *bb = frontier.back();
+        frontier.pop_back();
+        if (!reachable.insert(bb).second) {
+            continue;
+        }
+        frontier.emplace_back(bb->bexit.thenb);
+        frontier.emplace_back(bb->bexit.elseb);
+    }
+    for (auto &bb : cfg.basicBlocks) {
+        totalInstructions += bb->exprs.size();
+        if (!reachable.contains(bb.get())) {
+            prunedInstructions += bb->exprs.size();
+        }
+    }
+    prodCounterAdd("cfgbuilder.instructions.total", totalInstructions);
+    prodCounterAdd("cfgbuilder.instructions.pruned", prunedInstructions);
+    sanityCheck(ctx, cfg);
+}
+
 void CFGBuilder::sanityCheck(core::Context ctx, CFG &cfg) {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return;
     }
     for (auto &bb : cfg.basicBlocks) {
@@ -311,7 +380,8 @@ void CFGBuilder::computeMinMaxLoops(core::Context ctx, const CFG::ReadsAndWrites
     }
 }
 
-void CFGBuilder::fillInBlockArguments(core::Context ctx, const CFG::ReadsAndWrites &RnW, CFG &cfg) {
+void CFGBuilder::fillInBlockArguments(core::Context ctx, const CFG::ReadsAndWrites &RnW, CFG &cfg,
+                                      CFGScratch &scratch) {
     // Dmitry's algorithm for adding basic block arguments
     // I don't remember this version being described in any book.
     //
@@ -329,7 +399,8 @@ void CFGBuilder::fillInBlockArguments(core::Context ctx, const CFG::ReadsAndWrit
     const vector<UnorderedSet<core::LocalVariable>> &deadByBlock = RnW.dead;
 
     // iterate ver basic blocks in reverse and found upper bounds on what could a block need.
-    vector<UnorderedSet<core::LocalVariable>> upperBounds1(cfg.maxBasicBlockId);
+    auto &upperBounds1 = scratch.upperBounds1;
+    CFGScratch::resetSets(upperBounds1, cfg.maxBasicBlockId);
     bool changed = true;
     {
         Timer timeit(ctx.state.tracer(), "upperBounds1");
@@ -367,7 +438,8 @@ void CFGBuilder::fillInBlockArguments(core::Context ctx, const CFG::ReadsAndWrit
         }
     }
 
-    vector<UnorderedSet<core::LocalVariable>> upperBounds2(cfg.maxBasicBlockId);
+    auto &upperBounds2 = scratch.upperBounds2;
+    CFGScratch::resetSets(upperBounds2, cfg.maxBasicBlockId);
 
     changed = true;
     {
@@ -169,6 +169,19 @@ BasicBlock *CFGBuilder::walk(CFGContext cctx, ast::Expression *what, BasicBlock
                  */
             },
             [&](ast::Return *a) {
+                // `return x` (and `return self`) needs no temporary: reading a local has no side
+                // effects, so the Return can name it directly. Skipped while an LSP query is
+                // active, because queries match on the Ident the generic path emits for `x`.
+                if (ast::isa_tree<ast::Local>(a->expr.get()) && cctx.ctx.state.lspQuery.isEmpty()) {
+                    auto *local = ast::cast_tree<ast::Local>(a->expr.get());
+                    categoryCounterInc("cfg.builder.fastpath", "return_local");
+                    current->exprs.emplace_back(cctx.target, a->loc,
+                                                make_unique<Return>(local->localVariable)); // dead assign.
+                    jumpToDead(current, cctx.inWhat, a->loc);
+                    ret = cctx.inWhat.deadBlock();
+                    return;
+                }
+                categoryCounterInc("cfg.builder.fastpath", "return_generic");
                 core::LocalVariable retSym = cctx.newTemporary(core::Names::returnTemp());
                 auto cont = walk(cctx.withTarget(retSym), a->expr.get(), current);
                 cont->exprs.emplace_back(cctx.target, a->loc, make_unique<Return>(retSym)); // dead assign.
@@ -295,6 +308,40 @@ BasicBlock *CFGBuilder::walk(CFGContext cctx, ast::Expression *what, BasicBlock
                     }
                 }
 
+                // When the receiver and every argument are already locals (which includes `self`,
+                // so every trivial delegation like `def foo(x); bar(x); end` qualifies), the
+                // generic temp-per-operand sequence below collapses to the Send alone: locals
+                // have no side effects, so there is no evaluation order to preserve with
+                // temporaries. Skipped while an LSP query is active, because hover and friends
+                // match on the Ident instructions the generic path emits for these operands (the
+                // builder already builds a richer CFG under a query; see CFGBuilder::simplify).
+                if (s->block == nullptr && cctx.ctx.state.lspQuery.isEmpty() &&
+                    ast::isa_tree<ast::Local>(s->recv.get())) {
+                    bool allArgsLocal = true;
+                    for (auto &exp : s->args) {
+                        if (!ast::isa_tree<ast::Local>(exp.get())) {
+                            allArgsLocal = false;
+                            break;
+                        }
+                    }
+                    if (allArgsLocal) {
+                        categoryCounterInc("cfg.builder.fastpath", "send_local");
+                        InlinedVector<core::LocalVariable, 2> args;
+                        InlinedVector<core::Loc, 2> argLocs;
+                        for (auto &exp : s->args) {
+                            args.emplace_back(ast::cast_tree<ast::Local>(exp.get())->localVariable);
+                            argLocs.emplace_back(exp->loc);
+                        }
+                        auto recvLocal = ast::cast_tree<ast::Local>(s->recv.get())->localVariable;
+                        current->exprs.emplace_back(
+                            cctx.target, s->loc,
+                            make_unique<Send>(recvLocal, s->fun, s->recv->loc, args, argLocs, s->isPrivateOk()));
+                        ret = current;
+                        return;
+                    }
+                }
+                categoryCounterInc("cfg.builder.fastpath", "send_generic");
+
                 recv = cctx.newTemporary(core::Names::statTemp());
                 current = walk(cctx.withTarget(recv), s->recv.get(), current);
 
@@ -363,7 +410,7 @@ BasicBlock *CFGBuilder::walk(CFGContext cctx, ast::Expression *what, BasicBlock
                         core::Loc zeroLengthLoc = arg.loc.copyWithZeroLength();
                         bodyBlock->exprs.emplace_back(
                             idxTmp, zeroLengthLoc,
-                            make_unique<Literal>(core::make_type<core::LiteralType>(int64_t(i))));
+                            make_unique<Literal>(core::LiteralType::make_shared(int64_t(i))));
                         InlinedVector<core::LocalVariable, 2> idxVec{idxTmp};
                         InlinedVector<core::Loc, 2> locs{zeroLengthLoc};
                         auto isPrivateOk = false;
@@ -575,7 +622,7 @@ BasicBlock *CFGBuilder::walk(CFGContext cctx, ast::Expression *what, BasicBlock
                 // since in Ruby the exception would propagate up the statck.
                 auto gotoDeadTemp = cctx.newTemporary(core::Names::gotoDeadTemp());
                 synthesizeExpr(rescueHandlersBlock, gotoDeadTemp, a->loc,
-                               make_unique<Literal>(core::make_type<core::LiteralType>(true)));
+                               make_unique<Literal>(core::LiteralType::make_shared(true)));
                 unconditionalJump(rescueHandlersBlock, ensureBody, cctx.inWhat, a->loc);
 
                 auto throwAway = cctx.newTemporary(core::Names::throwAwayTemp());
@@ -0,0 +1,456 @@
+#include "cfg/serialize/serialize.h"
+#include "core/serialize/serialize.h"
+
+using namespace std;
+
+namespace sorbet::cfg {
+
+namespace {
+
+using core::serialize::Pickler;
+using core::serialize::Serializer;
+using core::serialize::UnPickler;
+
+// Instruction tags. Append-only: renumbering invalidates every cached CFG, and the pipeline's
+// cache version must be bumped whenever the format changes shape.
+enum class InsnTag : u1 {
+    Ident = 1,
+    Alias = 2,
+    SolveConstraint = 3,
+    Send = 4,
+    Return = 5,
+    BlockReturn = 6,
+    LoadSelf = 7,
+    Literal = 8,
+    Unanalyzable = 9,
+    NotSupported = 10,
+    LoadArg = 11,
+    LoadYieldParams = 12,
+    Cast = 13,
+    TAbsurd = 14,
+};
+
+void pickleLocal(Pickler &p, core::LocalVariable var) {
+    // The name id is signed so that the default-constructed "no variable" state (-1) round-trips;
+    // NameRef(gs, id) would reject it.
+    p.putS8(var._name.id());
+    p.putU4(var.unique);
+}
+
+core::LocalVariable unpickleLocal(UnPickler &p, const core::GlobalState &gs) {
+    auto rawName = p.getS8();
+    auto unique = p.getU4();
+    if (rawName < 0) {
+        return core::LocalVariable();
+    }
+    return core::LocalVariable(core::NameRef(gs, static_cast<u4>(rawName)), unique);
+}
+
+void pickleVariableUseSite(Pickler &p, const VariableUseSite &vus) {
+    pickleLocal(p, vus.variable);
+    Serializer::pickleType(p, vus.type);
+}
+
+VariableUseSite unpickleVariableUseSite(UnPickler &p, const core::GlobalState &gs) {
+    VariableUseSite vus(unpickleLocal(p, gs));
+    vus.type = Serializer::unpickleType(p, gs);
+    return vus;
+}
+
+// Returns the block link slot of instructions that carry one, or nullptr.
+const shared_ptr<core::SendAndBlockLink> *instructionLink(Instruction *insn) {
+    if (auto *send = cast_instruction<Send>(insn)) {
+        return &send->link;
+    }
+    if (auto *solve = cast_instruction<SolveConstraint>(insn)) {
+        return &solve->link;
+    }
+    if (auto *ret = cast_instruction<BlockReturn>(insn)) {
+        return &ret->link;
+    }
+    if (auto *self = cast_instruction<LoadSelf>(insn)) {
+        return &self->link;
+    }
+    if (auto *params = cast_instruction<LoadYieldParams>(insn)) {
+        return &params->link;
+    }
+    return nullptr;
+}
+
+void pickleInstruction(Pickler &p, const UnorderedMap<const core::SendAndBlockLink *, u4> &linkIndex,
+                       Instruction *insn) {
+    auto putLink = [&](const shared_ptr<core::SendAndBlockLink> &link) {
+        p.putU4(link == nullptr ? 0 : linkIndex.at(link.get()) + 1);
+    };
+    auto putTag = [&](InsnTag tag) { p.putU1(static_cast<u1>(tag)); };
+
+    p.putU1(insn->isSynthetic);
+    if (auto *i = cast_instruction<Ident>(insn)) {
+        putTag(InsnTag::Ident);
+        pickleLocal(p, i->what);
+    } else if (auto *i = cast_instruction<Alias>(insn)) {
+        putTag(InsnTag::Alias);
+        p.putU4(i->what._id);
+    } else if (auto *i = cast_instruction<SolveConstraint>(insn)) {
+        putTag(InsnTag::SolveConstraint);
+        putLink(i->link);
+        pickleLocal(p, i->send);
+    } else if (auto *i = cast_instruction<Send>(insn)) {
+        putTag(InsnTag::Send);
+        pickleVariableUseSite(p, i->recv);
+        p.putU4(i->fun.id());
+        Serializer::pickleLoc(p, i->receiverLoc);
+        p.putU1(i->isPrivateOk);
+        putLink(i->link);
+        p.putU4(i->args.size());
+        for (auto &arg : i->args) {
+            pickleVariableUseSite(p, arg);
+        }
+        p.putU4(i->argLocs.size());
+        for (auto loc : i->argLocs) {
+            Serializer::pickleLoc(p, loc);
+        }
+    } else if (auto *i = cast_instruction<Return>(insn)) {
+        putTag(InsnTag::Return);
+        pickleVariableUseSite(p, i->what);
+    } else if (auto *i = cast_instruction<BlockReturn>(insn)) {
+        putTag(InsnTag::BlockReturn);
+        putLink(i->link);
+        pickleVariableUseSite(p, i->what);
+    } else if (auto *i = cast_instruction<LoadSelf>(insn)) {
+        putTag(InsnTag::LoadSelf);
+        putLink(i->link);
+        pickleLocal(p, i->fallback);
+    } else if (auto *i = cast_instruction<Literal>(insn)) {
+        putTag(InsnTag::Literal);
+        Serializer::pickleType(p, i->value);
+    } else if (auto *i = cast_instruction<NotSupported>(insn)) {
+        // Before Unanalyzable: NotSupported is its subclass.
+        putTag(InsnTag::NotSupported);
+        p.putStr(i->why);
+    } else if (isa_instruction<Unanalyzable>(insn)) {
+        putTag(InsnTag::Unanalyzable);
+    } else if (auto *i = cast_instruction<LoadArg>(insn)) {
+        putTag(InsnTag::LoadArg);
+        p.putU4(i->method._id);
+        p.putU4(i->argId);
+    } else if (auto *i = cast_instruction<LoadYieldParams>(insn)) {
+        putTag(InsnTag::LoadYieldParams);
+        putLink(i->link);
+    } else if (auto *i = cast_instruction<Cast>(insn)) {
+        putTag(InsnTag::Cast);
+        pickleVariableUseSite(p, i->value);
+        Serializer::pickleType(p, i->type);
+        p.putU4(i->cast.id());
+    } else if (auto *i = cast_instruction<TAbsurd>(insn)) {
+        putTag(InsnTag::TAbsurd);
+        pickleVariableUseSite(p, i->what);
+    } else {
+        Exception::raise("Unknown instruction kind in CFG pickle");
+    }
+}
+
+unique_ptr<Instruction> unpickleInstruction(UnPickler &p, const core::GlobalState &gs, core::FileRef file,
+                                            const vector<shared_ptr<core::SendAndBlockLink>> &links) {
+    auto getLink = [&](void) -> shared_ptr<core::SendAndBlockLink> {
+        auto idx = p.getU4();
+        return idx == 0 ? nullptr : links[idx - 1];
+    };
+
+    bool isSynthetic = p.getU1();
+    unique_ptr<Instruction> insn;
+    switch (static_cast<InsnTag>(p.getU1())) {
+        case InsnTag::Ident:
+            insn = make_unique<Ident>(unpickleLocal(p, gs));
+            break;
+        case InsnTag::Alias:
+            insn = make_unique<Alias>(core::SymbolRef(gs, p.getU4()));
+            break;
+        case InsnTag::SolveConstraint: {
+            auto link = getLink();
+            insn = make_unique<SolveConstraint>(link, unpickleLocal(p, gs));
+            break;
+        }
+        case InsnTag::Send: {
+            auto recv = unpickleVariableUseSite(p, gs);
+            auto fun = core::NameRef(gs, p.getU4());
+            auto receiverLoc = Serializer::unpickleLoc(p, file);
+            bool isPrivateOk = p.getU1();
+            auto link = getLink();
+            auto argCount = p.getU4();
+            InlinedVector<core::LocalVariable, 2> argVars;
+            vector<core::TypePtr> argTypes;
+            argVars.reserve(argCount);
+            argTypes.reserve(argCount);
+            for (u4 i = 0; i < argCount; i++) {
+                auto arg = unpickleVariableUseSite(p, gs);
+                argVars.emplace_back(arg.variable);
+                argTypes.emplace_back(move(arg.type));
+            }
+            auto argLocCount = p.getU4();
+            InlinedVector<core::Loc, 2> argLocs;
+            argLocs.reserve(argLocCount);
+            for (u4 i = 0; i < argLocCount; i++) {
+                argLocs.emplace_back(Serializer::unpickleLoc(p, file));
+            }
+            auto send = make_unique<Send>(recv.variable, fun, receiverLoc, argVars, move(argLocs), isPrivateOk, link);
+            send->recv.type = move(recv.type);
+            for (u4 i = 0; i < argCount; i++) {
+                send->args[i].type = move(argTypes[i]);
+            }
+            insn = move(send);
+            break;
+        }
+        case InsnTag::Return: {
+            auto what = unpickleVariableUseSite(p, gs);
+            auto ret = make_unique<Return>(what.variable);
+            ret->what.type = move(what.type);
+            insn = move(ret);
+            break;
+        }
+        case InsnTag::BlockReturn: {
+            auto link = getLink();
+            auto what = unpickleVariableUseSite(p, gs);
+            auto ret = make_unique<BlockReturn>(link, what.variable);
+            ret->what.type = move(what.type);
+            insn = move(ret);
+            break;
+        }
+        case InsnTag::LoadSelf: {
+            auto link = getLink();
+            insn = make_unique<LoadSelf>(link, unpickleLocal(p, gs));
+            break;
+        }
+        case InsnTag::Literal:
+            insn = make_unique<Literal>(Serializer::unpickleType(p, gs));
+            break;
+        case InsnTag::NotSupported:
+            insn = make_unique<NotSupported>(p.getStr());
+            break;
+        case InsnTag::Unanalyzable:
+            insn = make_unique<Unanalyzable>();
+            break;
+        case InsnTag::LoadArg: {
+            auto method = core::SymbolRef(gs, p.getU4());
+            insn = make_unique<LoadArg>(method, p.getU4());
+            break;
+        }
+        case InsnTag::LoadYieldParams:
+            insn = make_unique<LoadYieldParams>(getLink());
+            break;
+        case InsnTag::Cast: {
+            auto value = unpickleVariableUseSite(p, gs);
+            auto type = Serializer::unpickleType(p, gs);
+            auto cast = make_unique<Cast>(value.variable, type, core::NameRef(gs, p.getU4()));
+            cast->value.type = move(value.type);
+            insn = move(cast);
+            break;
+        }
+        case InsnTag::TAbsurd: {
+            auto what = unpickleVariableUseSite(p, gs);
+            auto absurd = make_unique<TAbsurd>(what.variable);
+            absurd->what.type = move(what.type);
+            insn = move(absurd);
+            break;
+        }
+        default:
+            Exception::raise("Unknown instruction tag in CFG pickle");
+    }
+    insn->isSynthetic = isSynthetic;
+    return insn;
+}
+
+} // namespace
+
+void CFGSerializer::pickle(Pickler &p, const core::GlobalState &gs, const CFG &cfg) {
+    ENFORCE(cfg.symbol.exists());
+    p.putU4(cfg.symbol._id);
+    p.putU4(cfg.maxBasicBlockId);
+    p.putU4(cfg.maxRubyBlockId);
+
+    // Edges are encoded as indices into basicBlocks; entry() and deadBlock() are positional, so
+    // preserving vector order preserves them.
+    UnorderedMap<const BasicBlock *, u4> blockIndex;
+    blockIndex.reserve(cfg.basicBlocks.size());
+    u4 nextBlockIndex = 0;
+    for (auto &bb : cfg.basicBlocks) {
+        blockIndex[bb.get()] = nextBlockIndex++;
+    }
+
+    // Block links are shared between the instructions of one send, so they are pickled once into a
+    // table and referenced by index. A link's dispatch result is only filled in by inference, which
+    // is why this format is restricted to pre-inference CFGs.
+    vector<const core::SendAndBlockLink *> links;
+    UnorderedMap<const core::SendAndBlockLink *, u4> linkIndex;
+    for (auto &bb : cfg.basicBlocks) {
+        for (auto &bind : bb->exprs) {
+            auto *link = instructionLink(bind.value.get());
+            if (link != nullptr && *link != nullptr && !linkIndex.contains(link->get())) {
+                linkIndex[link->get()] = links.size();
+                links.emplace_back(link->get());
+            }
+        }
+    }
+    p.putU4(links.size());
+    for (auto *link : links) {
+        ENFORCE(link->result == nullptr, "CFGs must be pickled before inference runs");
+        p.putU4(link->fun.id());
+        p.putU4(link->rubyBlockId);
+        p.putU4(link->argFlags.size());
+        for (auto &flags : link->argFlags) {
+            u1 bits = (flags.isKeyword << 0) | (flags.isRepeated << 1) | (flags.isDefault << 2) |
+                      (flags.isShadow << 3) | (flags.isBlock << 4);
+            p.putU1(bits);
+        }
+    }
+
+    p.putU4(cfg.basicBlocks.size());
+    for (auto &bb : cfg.basicBlocks) {
+        p.putU4(bb->id);
+        p.putU4(bb->flags);
+        p.putU4(bb->outerLoops);
+        p.putU4(bb->rubyBlockId);
+        p.putS8(bb->fwdId);
+        p.putS8(bb->bwdId);
+        p.putS8(bb->firstDeadInstructionIdx);
+        p.putU4(bb->args.size());
+        for (auto &arg : bb->args) {
+            pickleVariableUseSite(p, arg);
+        }
+        p.putU4(bb->exprs.size());
+        for (auto &bind : bb->exprs) {
+            pickleVariableUseSite(p, bind.bind);
+            Serializer::pickleLoc(p, bind.loc);
+            pickleInstruction(p, linkIndex, bind.value.get());
+        }
+        pickleVariableUseSite(p, bb->bexit.cond);
+        Serializer::pickleLoc(p, bb->bexit.loc);
+        p.putU4(bb->bexit.thenb == nullptr ? 0 : blockIndex.at(bb->bexit.thenb) + 1);
+        p.putU4(bb->bexit.elseb == nullptr ? 0 : blockIndex.at(bb->bexit.elseb) + 1);
+        p.putU4(bb->backEdges.size());
+        for (auto *edge : bb->backEdges) {
+            p.putU4(blockIndex.at(edge));
+        }
+    }
+
+    p.putU4(cfg.forwardsTopoSort.size());
+    for (auto *bb : cfg.forwardsTopoSort) {
+        p.putU4(blockIndex.at(bb));
+    }
+
+    p.putU4(cfg.minLoops.size());
+    for (auto &[var, minLoop] : cfg.minLoops) {
+        pickleLocal(p, var);
+        p.putS8(minLoop);
+    }
+    p.putU4(cfg.maxLoopWrite.size());
+    for (auto &[var, maxWrite] : cfg.maxLoopWrite) {
+        pickleLocal(p, var);
+        p.putS8(maxWrite);
+    }
+}
+
+unique_ptr<CFG> CFGSerializer::unpickle(UnPickler &p, const core::GlobalState &gs, core::FileRef file) {
+    auto arena = make_shared<Arena>();
+    // Everything allocated below — the blocks the CFG constructor makes, the ones we replace them
+    // with, and every instruction — lands in the CFG's own arena, matching buildFor.
+    Arena::Guard arenaGuard(arena.get());
+    unique_ptr<CFG> res(new CFG); // private constructor
+    res->arena = move(arena);
+    // The constructor synthesizes entry and dead blocks; we rebuild the block list wholesale.
+    res->basicBlocks.clear();
+    res->symbol = core::SymbolRef(gs, p.getU4());
+    res->maxBasicBlockId = p.getU4();
+    res->maxRubyBlockId = p.getU4();
+
+    auto linkCount = p.getU4();
+    vector<shared_ptr<core::SendAndBlockLink>> links;
+    links.reserve(linkCount);
+    for (u4 i = 0; i < linkCount; i++) {
+        auto fun = core::NameRef(gs, p.getU4());
+        int rubyBlockId = p.getU4();
+        auto flagCount = p.getU4();
+        vector<core::ArgInfo::ArgFlags> argFlags(flagCount);
+        for (auto &flags : argFlags) {
+            u1 bits = p.getU1();
+            flags.isKeyword = bits & (1 << 0);
+            flags.isRepeated = bits & (1 << 1);
+            flags.isDefault = bits & (1 << 2);
+            flags.isShadow = bits & (1 << 3);
+            flags.isBlock = bits & (1 << 4);
+        }
+        links.emplace_back(make_shared<core::SendAndBlockLink>(fun, move(argFlags), rubyBlockId));
+    }
+
+    auto blockCount = p.getU4();
+    res->basicBlocks.reserve(blockCount);
+    // Edge targets may be blocks we have not created yet, so record their indices and patch the
+    // pointers once every block exists.
+    vector<pair<u4, u4>> exits(blockCount);
+    vector<vector<u4>> backEdges(blockCount);
+    for (u4 i = 0; i < blockCount; i++) {
+        auto &bb = res->basicBlocks.emplace_back(make_unique<BasicBlock>());
+        bb->id = p.getU4();
+        bb->flags = p.getU4();
+        bb->outerLoops = p.getU4();
+        bb->rubyBlockId = p.getU4();
+        bb->fwdId = p.getS8();
+        bb->bwdId = p.getS8();
+        bb->firstDeadInstructionIdx = p.getS8();
+        auto argCount = p.getU4();
+        bb->args.reserve(argCount);
+        for (u4 j = 0; j < argCount; j++) {
+            bb->args.emplace_back(unpickleVariableUseSite(p, gs));
+        }
+        auto exprCount = p.getU4();
+        bb->exprs.reserve(exprCount);
+        for (u4 j = 0; j < exprCount; j++) {
+            auto bind = unpickleVariableUseSite(p, gs);
+            auto loc = Serializer::unpickleLoc(p, file);
+            auto insn = unpickleInstruction(p, gs, file, links);
+            auto &expr = bb->exprs.emplace_back(bind.variable, loc, move(insn));
+            expr.bind.type = move(bind.type);
+        }
+        bb->bexit.cond = unpickleVariableUseSite(p, gs);
+        bb->bexit.loc = Serializer::unpickleLoc(p, file);
+        exits[i].first = p.getU4();
+        exits[i].second = p.getU4();
+        auto backEdgeCount = p.getU4();
+        backEdges[i].reserve(backEdgeCount);
+        for (u4 j = 0; j < backEdgeCount; j++) {
+            backEdges[i].emplace_back(p.getU4());
+        }
+    }
+    for (u4 i = 0; i < blockCount; i++) {
+        auto &bb = res->basicBlocks[i];
+        bb->bexit.thenb = exits[i].first == 0 ? nullptr : res->basicBlocks[exits[i].first - 1].get();
+        bb->bexit.elseb = exits[i].second == 0 ? nullptr : res->basicBlocks[exits[i].second - 1].get();
+        bb->backEdges.reserve(backEdges[i].size());
+        for (auto edge : backEdges[i]) {
+            bb->backEdges.emplace_back(res->basicBlocks[edge].get());
+        }
+    }
+
+    auto topoCount = p.getU4();
+    res->forwardsTopoSort.reserve(topoCount);
+    for (u4 i = 0; i < topoCount; i++) {
+        res->forwardsTopoSort.emplace_back(res->basicBlocks[p.getU4()].get());
+    }
+
+    auto minLoopCount = p.getU4();
+    res->minLoops.reserve(minLoopCount);
+    for (u4 i = 0; i < minLoopCount; i++) {
+        auto var = unpickleLocal(p, gs);
+        res->minLoops[var] = p.getS8();
+    }
+    auto maxLoopWriteCount = p.getU4();
+    res->maxLoopWrite.reserve(maxLoopWriteCount);
+    for (u4 i = 0; i < maxLoopWriteCount; i++) {
+        auto var = unpickleLocal(p, gs);
+        res->maxLoopWrite[var] = p.getS8();
+    }
+
+    return res;
+}
+
+} // namespace sorbet::cfg
@@ -0,0 +1,32 @@
+#ifndef SORBET_CFG_SERIALIZE_H
+#define SORBET_CFG_SERIALIZE_H
+
+#include "cfg/CFG.h"
+#include "core/serialize/pickler.h"
+
+namespace sorbet::cfg {
+
+// Compact binary serialization for pre-inference CFGs, built on the same Pickler as the
+// GlobalState/tree caches.
+//
+// The format stores NameRefs, SymbolRefs and FileRefs by id, so a pickled CFG is only meaningful
+// against a GlobalState with identical name/symbol tables — in practice, a warm run whose
+// post-namer state was restored from the kvstore under the same input manifest (see
+// main/pipeline). CFGs must be pickled before inference runs: inference fills in types and
+// dispatch results that this format deliberately does not represent.
+class CFGSerializer final {
+public:
+    CFGSerializer() = delete;
+
+    static void pickle(core::serialize::Pickler &p, const core::GlobalState &gs, const CFG &cfg);
+
+    // Reconstructs a CFG pickled by `pickle`. `file` supplies the file for every Loc in the CFG
+    // (a method's CFG never spans files). The result owns a fresh Arena, exactly as if
+    // CFGBuilder::buildFor had produced it.
+    static std::unique_ptr<CFG> unpickle(core::serialize::UnPickler &p, const core::GlobalState &gs,
+                                         core::FileRef file);
+};
+
+} // namespace sorbet::cfg
+
+#endif // SORBET_CFG_SERIALIZE_H
@@ -81,15 +81,29 @@ void histogramInc(ConstExprStr histogram, int key);
 void histogramAdd(ConstExprStr histogram, int key, unsigned long value);
 void prodHistogramInc(ConstExprStr histogram, int key);
 void prodHistogramAdd(ConstExprStr histogram, int key, unsigned long value);
+// Interns a dynamically built name (e.g. the file path attached to a per-file timer) into a
+// thread-local table, returning a pointer that stays valid for the thread's lifetime. The first
+// use of a name copies it once; every later use is a hash lookup with no allocation, which is what
+// makes per-file instrumentation cheap enough to leave enabled in long-lived processes.
+const char *internDynamicName(std::string_view name);
 /* Does not aggregate over measures, instead, reports them separately.
  * Use with care, as it can make us report a LOT of data. */
 struct FlowId {
     int id;
 };
 
+// Arg values must outlive the process's counter state: string literals or pointers returned by
+// internDynamicName both qualify.
 void timingAdd(ConstExprStr measure, std::chrono::time_point<std::chrono::steady_clock> start,
                std::chrono::time_point<std::chrono::steady_clock> end,
-               std::vector<std::pair<ConstExprStr, std::string>> args, FlowId self, FlowId previous);
+               std::vector<std::pair<ConstExprStr, const char *>> args, FlowId self, FlowId previous,
+               char const *parent, int64_t selfUs);
+
+// When enabled, every timing recorded by timingAdd is additionally copied into a bounded global
+// ring buffer, so that a long-lived process (the LSP server) can reconstruct recent activity after
+// the fact. Disabled — and free — by default; once enabled it stays enabled for the lifetime of the
+// process. Rendered by web_tracer_framework::Tracing::dumpRecentTraces.
+void enableTimingRingBuffer();
 
 UnorderedMap<long, long> getAndClearHistogram(ConstExprStr histogram);
 std::string getCounterStatistics(std::vector<std::string> names);
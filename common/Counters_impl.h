@@ -37,16 +37,34 @@ struct CounterImpl {
         char const *measure;
         std::chrono::time_point<std::chrono::steady_clock> start, end;
         int threadId;
-        std::vector<std::pair<char const *, std::string>> args;
+        // Values are string literals or thread-lifetime interned names (see internDynamicName),
+        // so copying a Timing (into the ring buffer, across counterConsume) copies pointers, not
+        // strings.
+        std::vector<std::pair<char const *, char const *>> args;
         FlowId self;
         FlowId prev;
+        // Name of the timer this one nested inside on the same thread, or nullptr at top level.
+        char const *parent;
+        // Inclusive duration minus the inclusive durations of direct child timers: the time this
+        // phase spent itself rather than in named sub-phases.
+        int64_t selfUs;
     };
     void timingAdd(Timing timing);
+    void timingHistogramAdd(const char *measure, int bucketUs, CounterType value);
     UnorderedMap<const char *, UnorderedMap<int, CounterType>> histograms;
+    // Per-measure latency histograms, recorded automatically for every completed Timer. Keys are
+    // HDR-style logarithmic bucket upper bounds in microseconds (see latencyBucketUs in
+    // Counters.cc), so merging thread-local states is bucket-wise addition and quantiles can be
+    // recovered at export time without keeping individual samples.
+    UnorderedMap<const char *, UnorderedMap<int, CounterType>> timingHistograms;
     UnorderedMap<const char *, CounterType> counters;
     std::vector<Timing> timings;
     UnorderedMap<const char *, UnorderedMap<const char *, CounterType>> countersByCategory;
 };
+
+// Snapshot of the global timing ring buffer (see enableTimingRingBuffer in Counters.h), oldest
+// event first. Empty unless the ring buffer has been enabled.
+std::vector<CounterImpl::Timing> getTimingRingBufferSnapshot();
 } // namespace sorbet
 
 #endif
@@ -1,12 +1,47 @@
 #ifndef SORBET_COMMON_FILEOPS_HPP
 #define SORBET_COMMON_FILEOPS_HPP
 #include "common/common.h"
+#include <array>
 #include <string>
 #include <string_view>
 #include <vector>
 
 namespace sorbet {
 
+/**
+ * Ignore-pattern lists compiled once into a single-pass matcher (an Aho-Corasick automaton over
+ * every pattern), so repeatedly filtering many paths costs one scan per path instead of one
+ * substring search per pattern. Compile where the pattern lists are long-lived (options, the LSP
+ * configuration, a directory walk) and reuse for every path.
+ *
+ * Matching semantics are identical to FileOps::isFileIgnored's naive loop: absolute patterns are
+ * anchored at the start of the workspace-relative path, relative patterns (stored with their
+ * leading '/') may occur anywhere, and either must end at a path-component boundary.
+ */
+class PathPatternMatcher final {
+public:
+    PathPatternMatcher() = default;
+    PathPatternMatcher(const std::vector<std::string> &absoluteIgnorePatterns,
+                       const std::vector<std::string> &relativeIgnorePatterns);
+    PathPatternMatcher(PathPatternMatcher &&) = default;
+    PathPatternMatcher &operator=(PathPatternMatcher &&) = default;
+
+    /** `relativePath` is the path with the workspace prefix stripped, including its leading '/'. */
+    bool matches(std::string_view relativePath) const;
+
+private:
+    struct Output {
+        int length;
+        bool anchored;
+    };
+    // Dense goto table: gotoTable[state][byte] -> state. Patterns number in the dozens, so the
+    // automaton stays small and the 256-wide rows buy branch-free transitions.
+    std::vector<std::array<int32_t, 256>> gotoTable;
+    // Patterns ending at each state (merged through suffix links during construction).
+    std::vector<std::vector<Output>> outputs;
+    bool empty = true;
+};
+
 class FileOps final {
 public:
     static bool exists(std::string_view filename);
@@ -35,6 +70,10 @@ public:
     static bool isFileIgnored(std::string_view basePath, std::string_view filePath,
                               const std::vector<std::string> &absoluteIgnorePatterns,
                               const std::vector<std::string> &relativeIgnorePatterns);
+    /** Like the above, but with the pattern lists pre-compiled; preferred wherever many paths are
+     * checked against the same lists. */
+    static bool isFileIgnored(std::string_view basePath, std::string_view filePath,
+                              const PathPatternMatcher &patterns);
     static std::string_view getFileName(std::string_view path);
     static std::string_view getExtension(std::string_view path);
     /**
@@ -8,7 +8,7 @@ int sorbet::Levenstein::distance(string_view s1, string_view s2, int bound) noex
     if (s1.data() == s2.data() && s1.size() == s2.size()) {
         return 0;
     }
-    // A mildly tweaked version from
+    // A banded version of the column-at-a-time algorithm from
     // https://en.wikibooks.org/wiki/Algorithm_Implementation/Strings/Levenshtein_distance#C++
     int s1len = s1.size();
     int s2len = s2.size();
@@ -20,20 +20,39 @@ int sorbet::Levenstein::distance(string_view s1, string_view s2, int bound) noex
     if (s2len - s1len > bound) {
         return INT_MAX;
     }
+    // The distance can't exceed the longer length; keeping the bound there makes overBound safe
+    // from overflow for callers that pass a huge bound.
+    bound = min(bound, s2len);
 
+    // Any cell (x, y) has distance at least |x - y|, so cells outside the diagonal band of
+    // half-width `bound` can never lead to a result within the bound. Only the band is computed;
+    // cells outside it hold (a value capped at) `overBound`, which also keeps the stale
+    // out-of-band entries of `column` harmless as the band slides upward.
+    const int overBound = bound + 1;
     vector<int> column(s1len + 1);
-    absl::c_iota(column, 0);
+    for (int y = 0; y <= s1len; y++) {
+        column[y] = min(y, overBound);
+    }
 
     for (int x = 1; x <= s2len; x++) {
-        column[0] = x;
-        int lastDiagonal = x - 1;
-        for (auto y = 1; y <= s1len; y++) {
+        const int yLo = max(1, x - bound);
+        const int yHi = min(s1len, x + bound);
+        int lastDiagonal = column[yLo - 1];
+        // D(x, 0) = x when the bottom row is still inside the band; below the band, overBound.
+        column[yLo - 1] = yLo == 1 ? min(x, overBound) : overBound;
+        int columnMin = column[yLo - 1];
+        for (int y = yLo; y <= yHi; y++) {
             int oldDiagonal = column[y];
             auto possibilities = {column[y] + 1, column[y - 1] + 1, lastDiagonal + (s1[y - 1] == s2[x - 1] ? 0 : 1)};
-            column[y] = min(possibilities);
+            column[y] = min(min(possibilities), overBound);
+            columnMin = min(columnMin, column[y]);
             lastDiagonal = oldDiagonal;
         }
+        // Once every cell in the band exceeds the bound, no later column can come back under it.
+        if (columnMin > bound) {
+            return INT_MAX;
+        }
     }
     int result = column[s1len];
-    return result;
+    return result > bound ? INT_MAX : result;
 }
@@ -0,0 +1,142 @@
+#include "common/Profiler.h"
+#include "absl/debugging/stacktrace.h"
+#include "absl/debugging/symbolize.h"
+#include "common/common.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <sys/time.h>
+
+using namespace std;
+
+namespace sorbet {
+
+namespace {
+
+constexpr int MAX_FRAMES = 64;
+// 64k samples at the default 1ms interval covers over a minute of CPU time; once the buffer is
+// full, further samples are dropped rather than resized (the handler cannot allocate).
+constexpr int MAX_SAMPLES = 1 << 16;
+
+struct Sample {
+    const char *phase;
+    int fileId;
+    int depth;
+    void *frames[MAX_FRAMES];
+};
+
+Sample *samples = nullptr;
+atomic<int> nextSample{0};
+atomic<bool> running{false};
+
+thread_local const char *currentPhase = nullptr;
+thread_local int currentFileId = 0;
+
+void handleSigprof(int) {
+    if (!running.load(memory_order_relaxed)) {
+        return;
+    }
+    auto idx = nextSample.fetch_add(1, memory_order_relaxed);
+    if (idx >= MAX_SAMPLES) {
+        // Saturate instead of wrapping; sampleCount() clamps.
+        nextSample.store(MAX_SAMPLES, memory_order_relaxed);
+        return;
+    }
+    auto &sample = samples[idx];
+    sample.phase = currentPhase;
+    sample.fileId = currentFileId;
+    // Skip this handler and the kernel signal trampoline.
+    sample.depth = absl::GetStackTrace(sample.frames, MAX_FRAMES, 2);
+}
+
+} // namespace
+
+void Profiler::start(int intervalUsec) {
+    if (emscripten_build) {
+        // No signals or timers under emscripten.
+        return;
+    }
+    if (running.load(memory_order_relaxed)) {
+        return;
+    }
+    if (samples == nullptr) {
+        samples = new Sample[MAX_SAMPLES];
+    }
+    nextSample.store(0, memory_order_relaxed);
+    running.store(true, memory_order_relaxed);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleSigprof;
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGPROF, &action, nullptr);
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = intervalUsec / 1'000'000;
+    timer.it_interval.tv_usec = intervalUsec % 1'000'000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+void Profiler::stop() {
+    if (!running.load(memory_order_relaxed)) {
+        return;
+    }
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    running.store(false, memory_order_relaxed);
+    signal(SIGPROF, SIG_IGN);
+}
+
+bool Profiler::isRunning() {
+    return running.load(memory_order_relaxed);
+}
+
+int Profiler::sampleCount() {
+    return min(nextSample.load(memory_order_relaxed), MAX_SAMPLES);
+}
+
+string Profiler::collapsed() {
+    auto count = sampleCount();
+    UnorderedMap<string, int> aggregated;
+    string line;
+    char symbolized[1024];
+    for (int i = 0; i < count; i++) {
+        auto &sample = samples[i];
+        line.clear();
+        line += sample.phase != nullptr ? sample.phase : "untagged";
+        if (sample.fileId > 0) {
+            fmt::format_to(back_inserter(line), ";file-{}", sample.fileId);
+        }
+        // GetStackTrace records innermost-first; collapsed format wants root-first.
+        for (int frame = sample.depth - 1; frame >= 0; frame--) {
+            if (absl::Symbolize(sample.frames[frame], symbolized, sizeof(symbolized))) {
+                line += ";";
+                line += symbolized;
+            } else {
+                fmt::format_to(back_inserter(line), ";{}", sample.frames[frame]);
+            }
+        }
+        aggregated[line]++;
+    }
+    fmt::memory_buffer result;
+    for (auto &[stack, stackCount] : aggregated) {
+        fmt::format_to(result, "{} {}\n", stack, stackCount);
+    }
+    return to_string(result);
+}
+
+ProfilerTag::ProfilerTag(const char *phase, int fileId) : savedPhase(currentPhase), savedFileId(currentFileId) {
+    currentPhase = phase;
+    currentFileId = fileId;
+}
+
+ProfilerTag::~ProfilerTag() {
+    currentPhase = savedPhase;
+    currentFileId = savedFileId;
+}
+
+} // namespace sorbet
@@ -0,0 +1,57 @@
+#ifndef SORBET_PROFILER_H
+#define SORBET_PROFILER_H
+
+#include <string>
+
+namespace sorbet {
+
+/**
+ * Opt-in signal-based sampling profiler. Unlike the scoped Timers, which only cover
+ * pre-instrumented regions, this captures full stacks wherever the CPU happens to be, tagged with
+ * the pipeline phase and file set via ProfilerTag. Samples aggregate into collapsed-stack format
+ * ("tag;outer_frame;...;inner_frame count" per line), which flamegraph.pl and speedscope consume
+ * directly, so a slow run can be diagnosed without attaching perf.
+ *
+ * Sampling uses SIGPROF with a preallocated lock-free sample buffer; the handler only calls
+ * async-signal-safe code (absl::GetStackTrace and atomics). Symbolization happens at export time.
+ */
+class Profiler {
+public:
+    // Starts sampling every `intervalUsec` of CPU time. No-op if already running.
+    static void start(int intervalUsec);
+
+    // Stops sampling. Captured samples remain available to collapsed().
+    static void stop();
+
+    static bool isRunning();
+
+    // The number of samples captured so far.
+    static int sampleCount();
+
+    // Symbolizes and aggregates the captured samples into collapsed-stack format.
+    static std::string collapsed();
+
+    Profiler() = delete;
+};
+
+/**
+ * Tags samples captured on this thread with a pipeline phase and (optionally) the id of the file
+ * being processed, until destruction. `phase` must point to storage that outlives the profiling
+ * session (in practice, a string literal): the signal handler records the pointer itself.
+ * Construction is two thread-local writes, so tagging is cheap enough to leave on unconditionally.
+ */
+class ProfilerTag {
+    const char *savedPhase;
+    int savedFileId;
+
+public:
+    ProfilerTag(const char *phase, int fileId = 0);
+    ~ProfilerTag();
+
+    ProfilerTag(const ProfilerTag &) = delete;
+    ProfilerTag(ProfilerTag &&) = delete;
+};
+
+} // namespace sorbet
+
+#endif // SORBET_PROFILER_H
@@ -2,18 +2,26 @@
 using namespace std;
 namespace sorbet {
 
-Timer::Timer(spdlog::logger &log, ConstExprStr name, FlowId prev, initializer_list<pair<ConstExprStr, string>> args)
-    : log(log), name(name), prev(prev), self{0}, args(args), start(chrono::steady_clock::now()){};
+namespace {
+// Top of the stack of live timers on this thread; see Timer::parentTimer.
+thread_local Timer *timerStackTop = nullptr;
+} // namespace
 
-Timer::Timer(spdlog::logger &log, ConstExprStr name, initializer_list<pair<ConstExprStr, string>> args)
+Timer::Timer(spdlog::logger &log, ConstExprStr name, FlowId prev, initializer_list<pair<ConstExprStr, const char *>> args)
+    : log(log), name(name), prev(prev), self{0}, args(args), start(chrono::steady_clock::now()),
+      parentTimer(timerStackTop) {
+    timerStackTop = this;
+};
+
+Timer::Timer(spdlog::logger &log, ConstExprStr name, initializer_list<pair<ConstExprStr, const char *>> args)
     : Timer(log, name, FlowId{0}, args){};
 
 Timer::Timer(const shared_ptr<spdlog::logger> &log, ConstExprStr name, FlowId prev,
-             initializer_list<pair<ConstExprStr, string>> args)
+             initializer_list<pair<ConstExprStr, const char *>> args)
     : Timer(*log, name, prev, args){};
 
 Timer::Timer(const shared_ptr<spdlog::logger> &log, ConstExprStr name,
-             initializer_list<pair<ConstExprStr, string>> args)
+             initializer_list<pair<ConstExprStr, const char *>> args)
     : Timer(*log, name, args){};
 
 Timer::Timer(const shared_ptr<spdlog::logger> &log, ConstExprStr name) : Timer(*log, name, {}){};
@@ -41,11 +49,24 @@ void Timer::cancel() {
 Timer::~Timer() {
     auto clock = chrono::steady_clock::now();
     auto dur = clock - start;
-    if (!canceled && dur > std::chrono::milliseconds(1)) {
+    timerStackTop = parentTimer;
+    if (canceled) {
+        // Canceled timers report nothing, and their duration stays charged to the parent's self
+        // time rather than appearing as a named child.
+        return;
+    }
+    auto durationUs = chrono::duration_cast<chrono::microseconds>(dur).count();
+    if (parentTimer != nullptr) {
+        // Attribute even when this timer is too short to report on its own: many short children
+        // still add up, and the parent's self time should not absorb them.
+        parentTimer->childDurationUs += durationUs;
+    }
+    if (dur > std::chrono::milliseconds(1)) {
         // the trick ^^^ is to skip double comparison in the common case and use the most efficient representation.
         auto dur = std::chrono::duration<double, std::milli>(clock - start);
         log.debug("{}: {}ms", this->name.str, dur.count());
-        sorbet::timingAdd(this->name, start, clock, move(args), self, prev);
+        sorbet::timingAdd(this->name, start, clock, move(args), self, prev,
+                          parentTimer != nullptr ? parentTimer->name.str : nullptr, durationUs - childDurationUs);
     }
 }
 
@@ -11,15 +11,18 @@ class Timer {
 public:
     Timer(spdlog::logger &log, ConstExprStr name);
     Timer(spdlog::logger &log, ConstExprStr name, FlowId prev);
-    Timer(spdlog::logger &log, ConstExprStr name, std::initializer_list<std::pair<ConstExprStr, std::string>> args);
+    // Arg values must outlive the counter state: pass a string literal, or run dynamically built
+    // names (file paths, method names) through internDynamicName so each unique name is allocated
+    // once per thread instead of once per timer.
+    Timer(spdlog::logger &log, ConstExprStr name, std::initializer_list<std::pair<ConstExprStr, const char *>> args);
     Timer(spdlog::logger &log, ConstExprStr name, FlowId prev,
-          std::initializer_list<std::pair<ConstExprStr, std::string>> args);
+          std::initializer_list<std::pair<ConstExprStr, const char *>> args);
     Timer(const std::shared_ptr<spdlog::logger> &log, ConstExprStr name, FlowId prev);
     Timer(const std::shared_ptr<spdlog::logger> &log, ConstExprStr name);
     Timer(const std::shared_ptr<spdlog::logger> &log, ConstExprStr name, FlowId prev,
-          std::initializer_list<std::pair<ConstExprStr, std::string>> args);
+          std::initializer_list<std::pair<ConstExprStr, const char *>> args);
     Timer(const std::shared_ptr<spdlog::logger> &log, ConstExprStr name,
-          std::initializer_list<std::pair<ConstExprStr, std::string>> args);
+          std::initializer_list<std::pair<ConstExprStr, const char *>> args);
     ~Timer();
     FlowId getFlowEdge();
 
@@ -40,9 +43,15 @@ private:
     ConstExprStr name;
     FlowId prev;
     FlowId self;
-    std::vector<std::pair<ConstExprStr, std::string>> args;
+    std::vector<std::pair<ConstExprStr, const char *>> args;
     const std::chrono::time_point<std::chrono::steady_clock> start;
     bool canceled = false;
+    // Timers are strictly scoped (no copy or move), so live timers on one thread form a stack.
+    // Each timer remembers the one it nested inside; children report their inclusive duration up
+    // through this pointer at destruction, which lets the parent attribute self time (inclusive
+    // minus children) without any post-processing.
+    Timer *const parentTimer;
+    long childDurationUs = 0;
 };
 } // namespace sorbet
 
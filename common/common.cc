@@ -1,4 +1,5 @@
 #include "common/common.h"
+#include "absl/synchronization/mutex.h"
 #include "common/Exception.h"
 #include "common/FileOps.h"
 #include "common/sort.h"
@@ -9,9 +10,11 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cxxabi.h>
+#include <deque>
 #include <dirent.h>
 #include <exception>
 #include <memory>
+#include <thread>
 #include <vector>
 
 using namespace std;
@@ -27,6 +30,45 @@ shared_ptr<spdlog::logger> makeFatalLogger() {
 } // namespace
 shared_ptr<spdlog::logger> sorbet::fatalLogger = makeFatalLogger();
 
+namespace {
+struct CallsiteRegistry {
+    absl::Mutex mtx;
+    vector<sorbet::enforce_counters::Callsite *> sites;
+};
+
+CallsiteRegistry &callsiteRegistry() {
+    // Leaked so that Callsites constructed during static initialization and ones in other
+    // translation units can register in any order.
+    static CallsiteRegistry *registry = new CallsiteRegistry();
+    return *registry;
+}
+} // namespace
+
+sorbet::enforce_counters::Callsite::Callsite(const char *file, int line) : file(file), line(line) {
+    auto &registry = callsiteRegistry();
+    absl::MutexLock lock(&registry.mtx);
+    registry.sites.emplace_back(this);
+}
+
+void sorbet::enforce_counters::dumpAll(spdlog::logger &log) {
+    vector<pair<uint64_t, const Callsite *>> snapshot;
+    {
+        auto &registry = callsiteRegistry();
+        absl::MutexLock lock(&registry.mtx);
+        snapshot.reserve(registry.sites.size());
+        for (auto *site : registry.sites) {
+            auto hits = site->hits.load(memory_order_relaxed);
+            if (hits > 0) {
+                snapshot.emplace_back(hits, site);
+            }
+        }
+    }
+    fast_sort(snapshot, [](const auto &lhs, const auto &rhs) -> bool { return lhs.first > rhs.first; });
+    for (const auto &[hits, site] : snapshot) {
+        log.debug("enforce hits: {}:{} {}", site->file, site->line, hits);
+    }
+}
+
 bool sorbet::FileOps::exists(string_view filename) {
     struct stat buffer;
     return (stat((string(filename)).c_str(), &buffer) == 0);
@@ -199,6 +241,97 @@ bool sorbet::FileOps::isFolder(string_view path, string_view ignorePattern, cons
     return path.at(endPos) == '/';
 }
 
+sorbet::PathPatternMatcher::PathPatternMatcher(const vector<string> &absoluteIgnorePatterns,
+                                               const vector<string> &relativeIgnorePatterns) {
+    // Trie construction uses sparse edges; the dense goto table is filled in afterwards so the
+    // matcher itself never chases hash lookups or failure links.
+    vector<sorbet::UnorderedMap<unsigned char, int32_t>> edges(1);
+    vector<vector<Output>> trieOutputs(1);
+
+    auto addPattern = [&](const string &pattern, bool anchored) {
+        if (pattern.empty()) {
+            return;
+        }
+        int32_t state = 0;
+        for (unsigned char c : pattern) {
+            auto found = edges[state].find(c);
+            if (found == edges[state].end()) {
+                int32_t next = edges.size();
+                edges[state][c] = next;
+                edges.emplace_back();
+                trieOutputs.emplace_back();
+                state = next;
+            } else {
+                state = found->second;
+            }
+        }
+        trieOutputs[state].emplace_back(Output{static_cast<int>(pattern.length()), anchored});
+        empty = false;
+    };
+    for (auto &p : absoluteIgnorePatterns) {
+        addPattern(p, true);
+    }
+    for (auto &p : relativeIgnorePatterns) {
+        addPattern(p, false);
+    }
+
+    gotoTable.resize(edges.size());
+    outputs = move(trieOutputs);
+    vector<int32_t> fail(edges.size(), 0);
+    std::deque<int32_t> queue;
+    for (int c = 0; c < 256; c++) {
+        auto it = edges[0].find(static_cast<unsigned char>(c));
+        gotoTable[0][c] = it == edges[0].end() ? 0 : it->second;
+        if (gotoTable[0][c] != 0) {
+            queue.emplace_back(gotoTable[0][c]);
+        }
+    }
+    while (!queue.empty()) {
+        auto state = queue.front();
+        queue.pop_front();
+        // A state also matches every pattern its longest proper suffix matches.
+        outputs[state].insert(outputs[state].end(), outputs[fail[state]].begin(), outputs[fail[state]].end());
+        for (int c = 0; c < 256; c++) {
+            auto it = edges[state].find(static_cast<unsigned char>(c));
+            if (it == edges[state].end()) {
+                gotoTable[state][c] = gotoTable[fail[state]][c];
+            } else {
+                gotoTable[state][c] = it->second;
+                fail[it->second] = gotoTable[fail[state]][c];
+                queue.emplace_back(it->second);
+            }
+        }
+    }
+}
+
+bool sorbet::PathPatternMatcher::matches(string_view relativePath) const {
+    if (empty) {
+        return false;
+    }
+    int32_t state = 0;
+    for (size_t i = 0; i < relativePath.length(); i++) {
+        state = gotoTable[state][static_cast<unsigned char>(relativePath[i])];
+        for (auto &out : outputs[state]) {
+            auto startPos = i + 1 - out.length;
+            if (out.anchored && startPos != 0) {
+                continue;
+            }
+            // The pattern must end at a path-component boundary: the end of the path (a file) or a
+            // '/' (a folder), exactly like isFile/isFolder in the naive loop below.
+            if (i + 1 == relativePath.length() || relativePath[i + 1] == '/') {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool sorbet::FileOps::isFileIgnored(string_view basePath, string_view filePath, const PathPatternMatcher &patterns) {
+    ENFORCE(filePath.substr(0, basePath.length()) == basePath);
+    // Note: relative_path always includes a leading /
+    return patterns.matches(filePath.substr(basePath.length()));
+}
+
 // Simple, naive implementation of regexp-free ignore rules.
 bool sorbet::FileOps::isFileIgnored(string_view basePath, string_view filePath,
                                     const vector<string> &absoluteIgnorePatterns,
@@ -228,53 +361,124 @@ bool sorbet::FileOps::isFileIgnored(string_view basePath, string_view filePath,
     return false;
 }
 
-void appendFilesInDir(string_view basePath, string_view path, const sorbet::UnorderedSet<string> &extensions,
-                      bool recursive, vector<string> &result, const std::vector<std::string> &absoluteIgnorePatterns,
-                      const std::vector<std::string> &relativeIgnorePatterns) {
-    DIR *dir;
-    struct dirent *entry;
-
-    if ((dir = opendir(string(path).c_str())) == nullptr) {
-        switch (errno) {
-            case ENOTDIR:
-                throw sorbet::FileNotDirException();
-            default:
-                // Mirrors other FileOps functions: Assume other errors are from FileNotFound.
-                throw sorbet::FileNotFoundException();
+namespace {
+// State shared by the directory-walking threads in FileOps::listFilesInDir.
+struct FileListingState {
+    absl::Mutex mtx;
+    std::deque<std::string> pendingDirs;
+    // Directories queued or currently being walked; the walk is complete once this drops to zero.
+    int outstandingDirs = 0;
+    std::exception_ptr firstError;
+    std::vector<std::string> result;
+};
+
+void walkFilesInDirs(FileListingState &state, string_view basePath, const sorbet::UnorderedSet<string> &extensions,
+                     bool recursive, const sorbet::PathPatternMatcher &ignorePatterns) {
+    vector<string> localResult;
+    while (true) {
+        string path;
+        {
+            absl::MutexLock lk(&state.mtx);
+            state.mtx.Await(absl::Condition(
+                +[](FileListingState *state) -> bool {
+                    return !state->pendingDirs.empty() || state->outstandingDirs == 0 ||
+                           state->firstError != nullptr;
+                },
+                &state));
+            if (state.pendingDirs.empty() || state.firstError != nullptr) {
+                break;
+            }
+            path = move(state.pendingDirs.front());
+            state.pendingDirs.pop_front();
         }
-    }
 
-    while ((entry = readdir(dir)) != nullptr) {
-        auto fullPath = fmt::format("{}/{}", path, entry->d_name);
-        if (sorbet::FileOps::isFileIgnored(basePath, fullPath, absoluteIgnorePatterns, relativeIgnorePatterns)) {
+        DIR *dir;
+        struct dirent *entry;
+        if ((dir = opendir(path.c_str())) == nullptr) {
+            absl::MutexLock lk(&state.mtx);
+            if (state.firstError == nullptr) {
+                switch (errno) {
+                    case ENOTDIR:
+                        state.firstError = make_exception_ptr(sorbet::FileNotDirException());
+                        break;
+                    default:
+                        // Mirrors other FileOps functions: Assume other errors are from FileNotFound.
+                        state.firstError = make_exception_ptr(sorbet::FileNotFoundException());
+                }
+            }
+            state.outstandingDirs--;
             continue;
-        } else if (entry->d_type == DT_DIR) {
-            if (!recursive || strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+        }
+
+        vector<string> localDirs;
+        while ((entry = readdir(dir)) != nullptr) {
+            auto fullPath = fmt::format("{}/{}", path, entry->d_name);
+            if (sorbet::FileOps::isFileIgnored(basePath, fullPath, ignorePatterns)) {
                 continue;
-            }
-            appendFilesInDir(basePath, fullPath, extensions, recursive, result, absoluteIgnorePatterns,
-                             relativeIgnorePatterns);
-        } else {
-            auto dotLocation = fullPath.rfind('.');
-            // Note: Can't call substr with an index > string length, so explicitly check if a dot isn't found.
-            if (dotLocation != string::npos) {
-                auto ext = fullPath.substr(dotLocation);
-                if (extensions.find(ext) != extensions.end()) {
-                    result.emplace_back(fullPath);
+            } else if (entry->d_type == DT_DIR) {
+                if (!recursive || strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                    continue;
                 }
+                localDirs.emplace_back(move(fullPath));
+            } else {
+                auto dotLocation = fullPath.rfind('.');
+                // Note: Can't call substr with an index > string length, so explicitly check if a dot isn't found.
+                if (dotLocation != string::npos) {
+                    auto ext = fullPath.substr(dotLocation);
+                    if (extensions.find(ext) != extensions.end()) {
+                        localResult.emplace_back(move(fullPath));
+                    }
+                }
+            }
+        }
+        closedir(dir);
+
+        {
+            absl::MutexLock lk(&state.mtx);
+            for (auto &d : localDirs) {
+                state.pendingDirs.emplace_back(move(d));
             }
+            state.outstandingDirs += static_cast<int>(localDirs.size()) - 1;
         }
     }
-    closedir(dir);
+
+    absl::MutexLock lk(&state.mtx);
+    state.result.insert(state.result.end(), make_move_iterator(localResult.begin()),
+                        make_move_iterator(localResult.end()));
 }
+} // namespace
 
 vector<string> sorbet::FileOps::listFilesInDir(string_view path, const UnorderedSet<string> &extensions, bool recursive,
                                                const std::vector<std::string> &absoluteIgnorePatterns,
                                                const std::vector<std::string> &relativeIgnorePatterns) {
-    vector<string> result;
-    appendFilesInDir(path, path, extensions, recursive, result, absoluteIgnorePatterns, relativeIgnorePatterns);
-    fast_sort(result);
-    return result;
+    FileListingState state;
+    state.pendingDirs.emplace_back(path);
+    state.outstandingDirs = 1;
+    // Compiled once per walk; every worker thread then filters each path in a single pass.
+    PathPatternMatcher ignorePatterns(absoluteIgnorePatterns, relativeIgnorePatterns);
+
+    // Deep trees fan out into many independent readdir loops that overlap well, especially on
+    // network filesystems, so split the walk across a few helper threads. The calling thread
+    // participates too, which also covers the non-recursive single-directory case without spawning
+    // anything.
+    vector<unique_ptr<Joinable>> helpers;
+    if (recursive) {
+        const auto helperCount = min(8u, max(2u, thread::hardware_concurrency())) - 1;
+        for (auto i = 0u; i < helperCount; i++) {
+            helpers.emplace_back(runInAThread("fileListWorker", [&state, path, &extensions, recursive,
+                                                                 &ignorePatterns] {
+                walkFilesInDirs(state, path, extensions, recursive, ignorePatterns);
+            }));
+        }
+    }
+    walkFilesInDirs(state, path, extensions, recursive, ignorePatterns);
+    helpers.clear();
+
+    if (state.firstError != nullptr) {
+        rethrow_exception(state.firstError);
+    }
+    fast_sort(state.result);
+    return move(state.result);
 }
 
 class SetTerminateHandler {
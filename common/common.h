@@ -12,6 +12,7 @@ static_assert(false, "Need c++14 to compile this codebase");
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "spdlog/spdlog.h"
+#include <atomic>
 #include <stdint.h>
 #include <string>
 #include <string_view>
@@ -39,6 +40,16 @@ constexpr bool debug_mode = false;
 constexpr bool debug_mode = true;
 #endif
 
+// The expensive tier of debug assertions: whole-tree and whole-symbol-table sanity checks that are
+// worth their cost in CI but double runtime in long-lived debug-assertion deployments. Builds that
+// want cheap assertions only (pointer/flag checks) pass -DNO_SLOW_ENFORCE on top of a debug build;
+// see `--config=forcedebug-cheap` in .bazelrc.
+#if defined(DEBUG_MODE) && !defined(NO_SLOW_ENFORCE)
+constexpr bool slow_debug_mode = true;
+#else
+constexpr bool slow_debug_mode = false;
+#endif
+
 #if !defined(EMSCRIPTEN)
 constexpr bool emscripten_build = false;
 #else
@@ -53,25 +64,69 @@ constexpr bool fuzz_mode = true;
 
 #define _MAYBE_ADD_COMMA(...) , ##__VA_ARGS__
 
+// Per-callsite hit counters for ENFORCE, compiled in with -DENFORCE_HIT_COUNTERS (see
+// `--config=forcedebug-cheap` in .bazelrc). Each counting ENFORCE registers a static Callsite on
+// first execution; enforce_counters::dumpAll reports the hottest ones so we know which assertions
+// dominate the overhead of a debug-assertion deployment.
+namespace enforce_counters {
+struct Callsite {
+    const char *const file;
+    const int line;
+    std::atomic<uint64_t> hits{0};
+    Callsite(const char *file, int line);
+};
+void dumpAll(spdlog::logger &log);
+} // namespace enforce_counters
+
+#ifdef ENFORCE_HIT_COUNTERS
+constexpr bool enforce_hit_counters = true;
+#define _ENFORCE_COUNT_HIT()                                                         \
+    ({                                                                               \
+        static ::sorbet::enforce_counters::Callsite _enforce_cs(__FILE__, __LINE__); \
+        _enforce_cs.hits.fetch_add(1, ::std::memory_order_relaxed);                  \
+        (void)0;                                                                     \
+    })
+#else
+constexpr bool enforce_hit_counters = false;
+#define _ENFORCE_COUNT_HIT() ((void)0)
+#endif
+
 // Used for cases like https://xkcd.com/2200/
 // where there is some assumption that you believe should always hold.
 // Please use this to explicitly write down what assumptions was the code written under.
 // One day they might be violated and you'll help the next person debug the issue.
 #define ENFORCE(x, ...)                                                                             \
-    ((::sorbet::debug_mode && !(x)) ? ({                                                            \
+    (_ENFORCE_COUNT_HIT(), ((::sorbet::debug_mode && !(x)) ? ({                                     \
+        ::sorbet::Exception::failInFuzzer();                                                        \
+        if (stopInDebugger()) {                                                                     \
+            (void)!(x);                                                                             \
+        }                                                                                           \
+        ::sorbet::Exception::enforce_handler(#x, __FILE__, __LINE__ _MAYBE_ADD_COMMA(__VA_ARGS__)); \
+    })                                                                                              \
+                                                            : false))
+
+// ENFORCE for checks expensive enough to dominate a debug build's runtime (whole-tree walks,
+// subtype queries in loops). Compiled out when slow_debug_mode is off; see that constant above.
+#define SLOW_ENFORCE(x, ...)                                                                        \
+    (_ENFORCE_COUNT_HIT(), ((::sorbet::slow_debug_mode && !(x)) ? ({                                \
         ::sorbet::Exception::failInFuzzer();                                                        \
         if (stopInDebugger()) {                                                                     \
             (void)!(x);                                                                             \
         }                                                                                           \
         ::sorbet::Exception::enforce_handler(#x, __FILE__, __LINE__ _MAYBE_ADD_COMMA(__VA_ARGS__)); \
     })                                                                                              \
-                                    : false)
+                                                                 : false))
 
 #define DEBUG_ONLY(X) \
     if (debug_mode) { \
         X;            \
     }
 
+#define SLOW_DEBUG_ONLY(X) \
+    if (slow_debug_mode) { \
+        X;                 \
+    }
+
 constexpr bool skip_check_memory_layout = debug_mode || emscripten_build;
 
 template <typename ToCheck, std::size_t ExpectedSize, std::size_t RealSize = sizeof(ToCheck)> struct check_size {
@@ -14,6 +14,10 @@ public:
     typedef std::function<void()> Task;
     static std::unique_ptr<WorkerPool> create(int size, spd::logger &logger);
     virtual void multiplexJob(std::string_view taskName, Task t) = 0;
+    // Like multiplexJob, but hands the job to at most `maxConcurrency` workers. Phases whose
+    // scaling flattens below the pool size use this to leave the surplus workers parked in their
+    // queue waits instead of contending for work (and cache lines) they cannot speed up.
+    virtual void multiplexJobBounded(std::string_view taskName, int maxConcurrency, Task t) = 0;
     virtual ~WorkerPool() = 0;
     WorkerPool() = default;
     WorkerPool(WorkerPool &) = delete;
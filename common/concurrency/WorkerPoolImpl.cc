@@ -18,26 +18,37 @@ WorkerPoolImpl::WorkerPoolImpl(int size, spd::logger &logger) : size(size), logg
         ENFORCE(size == 0);
         this->size = 0;
     } else {
-        bool pinThreads = (size > 0) && (size == thread::hardware_concurrency());
+        bool pinThreads = (size > 0) && (size <= static_cast<int>(thread::hardware_concurrency()));
+        // Workers fill one physical package before spilling onto the next, so runs using fewer
+        // threads than cores stay socket-local and the shared frozen tables mostly hit local cache.
+        vector<int> pinOrder;
+        if (pinThreads) {
+            pinOrder = coresGroupedByPackage();
+        }
         threadQueues.reserve(size);
+        // All queues must exist before any worker starts: workers steal from sibling queues.
+        for (int i = 0; i < size; i++) {
+            threadQueues.emplace_back(make_unique<Queue>());
+        }
         for (int i = 0; i < size; i++) {
-            auto &last = threadQueues.emplace_back(make_unique<Queue>());
-            auto *ptr = last.get();
+            auto *ptr = threadQueues[i].get();
             auto threadIdleName = absl::StrCat("idle", i + 1);
             optional<int> pinToCore;
-            if (pinThreads) {
-                pinToCore = i;
+            if (pinThreads && i < static_cast<int>(pinOrder.size())) {
+                pinToCore = pinOrder[i];
             }
             threads.emplace_back(runInAThread(
                 threadIdleName,
-                [ptr, &logger, threadIdleName]() {
+                [this, ptr, i, &logger, threadIdleName]() {
                     bool repeat = true;
                     while (repeat) {
                         Task_ task;
                         setCurrentThreadName(threadIdleName);
-                        ptr->wait_dequeue(task);
+                        if (!ptr->wait_dequeue_timed(task, WorkerPool::BLOCK_INTERVAL()) && !trySteal(i, task)) {
+                            continue;
+                        }
                         logger.debug("Worker got task");
-                        repeat = task();
+                        repeat = task.fun();
                     }
                 },
                 pinToCore));
@@ -48,29 +59,56 @@ WorkerPoolImpl::WorkerPoolImpl(int size, spd::logger &logger) : size(size), logg
 
 WorkerPoolImpl::~WorkerPoolImpl() {
     auto &logger = this->logger;
-    multiplexJob_([&logger]() {
-        logger.debug("Killing worker thread");
-        return false;
-    });
+    multiplexJob_({[&logger]() {
+                       logger.debug("Killing worker thread");
+                       return false;
+                   },
+                   /* stealable */ false},
+                  size);
     // join will be called when destructing joinable;
 }
 
 void WorkerPoolImpl::multiplexJob(string_view taskName, WorkerPool::Task t) {
+    multiplexJobBounded(taskName, size, move(t));
+}
+
+void WorkerPoolImpl::multiplexJobBounded(string_view taskName, int maxConcurrency, WorkerPool::Task t) {
     if (size > 0) {
-        multiplexJob_([t{move(t)}, taskName] {
-            setCurrentThreadName(taskName);
-            t();
-            return true;
-        });
+        ENFORCE(maxConcurrency > 0);
+        auto runners = min(maxConcurrency, size);
+        multiplexJob_({[t{move(t)}, taskName] {
+                           setCurrentThreadName(taskName);
+                           t();
+                           return true;
+                       },
+                       /* stealable */ true, runners},
+                      runners);
     } else {
         // main thread is the worker.
         t();
     }
 }
 
-void WorkerPoolImpl::multiplexJob_(WorkerPoolImpl::Task_ t) {
-    logger.debug("Multiplexing job");
-    for (int i = 0; i < size; i++) {
+bool WorkerPoolImpl::trySteal(int thief, Task_ &task) {
+    for (int offset = 1; offset < size; offset++) {
+        auto victim = (thief + offset) % size;
+        if (!threadQueues[victim]->try_dequeue(task)) {
+            continue;
+        }
+        if (task.stealable && thief < task.maxRunnerId) {
+            logger.debug("Worker stole task");
+            return true;
+        }
+        // Not ours to run (the victim's shutdown task, or a bounded job this worker is past the
+        // cap for); hand it back.
+        threadQueues[victim]->enqueue(move(task));
+    }
+    return false;
+}
+
+void WorkerPoolImpl::multiplexJob_(WorkerPoolImpl::Task_ t, int queueCount) {
+    logger.debug("Multiplexing job to {} of {} workers", queueCount, size);
+    for (int i = 0; i < queueCount; i++) {
         threadQueues[i]->enqueue(t);
     }
 }
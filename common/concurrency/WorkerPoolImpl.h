@@ -5,6 +5,7 @@
 #include "common/concurrency/WorkerPool.h"
 #include "common/os/os.h"
 #include "spdlog/spdlog.h"
+#include <climits>
 #include <memory>
 #include <vector>
 namespace spd = spdlog;
@@ -76,20 +77,30 @@ class WorkerPoolImpl : public WorkerPool {
             return std::free(ptr);
         }
     };
-    typedef std::function<bool()> Task_; // return value indicates if the worker should continie gathering jobs
+    struct Task_ {
+        std::function<bool()> fun; // return value indicates if the worker should continie gathering jobs
+        // Multiplexed jobs are idempotent copies that drain a shared queue, so an idle worker may run a
+        // copy that was enqueued for a busy sibling. The shutdown task is not: each worker must see its own.
+        bool stealable = true;
+        // Bounded jobs (see multiplexJobBounded) are only enqueued to, and may only be stolen by,
+        // workers below this index, so the cap holds even through work stealing.
+        int maxRunnerId = INT_MAX;
+    };
     typedef moodycamel::BlockingConcurrentQueue<Task_, ConcurrentQueueCustomTraits> Queue;
     // ORDER IS IMPORTANT. threads must be killed before Queues.
     std::vector<std::unique_ptr<Queue>> threadQueues;
     std::vector<std::unique_ptr<Joinable>> threads;
     spd::logger &logger;
 
-    void multiplexJob_(Task_ t);
+    void multiplexJob_(Task_ t, int queueCount);
+    bool trySteal(int thief, Task_ &task);
 
 public:
     WorkerPoolImpl(int size, spd::logger &logger);
     ~WorkerPoolImpl();
 
     void multiplexJob(std::string_view taskName, Task t) override;
+    void multiplexJobBounded(std::string_view taskName, int maxConcurrency, Task t) override;
 };
 };     // namespace sorbet
 #endif // SORBET_WORKERPOOL_IMPL_H
@@ -1,11 +1,35 @@
 #include "common/kvstore/KeyValueStore.h"
 
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "common/Counters.h"
+#include "common/FileOps.h"
+#include "common/crypto_hashing/crypto_hashing.h"
+
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
 #include <utility>
 
 using namespace std;
 namespace sorbet {
+static atomic<u8> storeIdCounter{1};
 constexpr string_view OLD_VERSION_KEY = "VERSION"sv;
 constexpr string_view VERSION_KEY = "DB_FORMAT_VERSION"sv;
+constexpr string_view SESSION_EPOCH_KEY = "SESSION_EPOCH"sv;
+
+// Per-thread buffer of keys whose access epoch needs refreshing, flushed into the store's shared
+// set in batches: `read` is called from every worker at once on a warm cache, and taking a
+// process-wide lock per lookup would reintroduce the contention the cached reader transaction in
+// `read` exists to remove. A thread's final partial batch is dropped with the thread; at worst an
+// entry's age refresh lands a session late, which the multi-session eviction threshold absorbs.
+struct PendingAccessBuffer {
+    u8 storeId = 0;
+    vector<string> keys;
+};
+static thread_local PendingAccessBuffer pendingAccesses;
+constexpr size_t ACCESS_FLUSH_BATCH = 32;
 constexpr size_t MAX_DB_SIZE_BYTES =
     1L * 1024 * 1024 * 1024; // 1G. This is both maximum fs db size and max virtual memory usage.
 
@@ -14,8 +38,10 @@ static void throw_mdb_error(string_view what, int err) {
     throw invalid_argument(string(what));
 }
 
-KeyValueStore::KeyValueStore(string version, string path, string flavor)
-    : path(move(path)), flavor(move(flavor)), writerId(this_thread::get_id()) {
+KeyValueStore::KeyValueStore(string version, string path, string flavor, string remotePath)
+    : path(move(path)), flavor(move(flavor)), remotePath(move(remotePath)),
+      remoteKeyPrefix(absl::StrCat(version, "//", this->flavor, "//")), writerId(this_thread::get_id()),
+      storeId(storeIdCounter.fetch_add(1)) {
     int rc;
     rc = mdb_env_create(&env);
     if (rc != 0) {
@@ -43,6 +69,15 @@ KeyValueStore::KeyValueStore(string version, string path, string flavor)
             clear();
             writeString(VERSION_KEY, version);
         }
+        // Bump the session epoch. Entry ages for sweepStale are measured in sessions rather than
+        // wall time, so a cache untouched over a vacation is not wiped on return.
+        u8 lastEpoch = 0;
+        auto lastEpochStr = readString(SESSION_EPOCH_KEY);
+        if (!lastEpochStr.empty() && !absl::SimpleAtoi(lastEpochStr, &lastEpoch)) {
+            lastEpoch = 0;
+        }
+        sessionEpoch = lastEpoch + 1;
+        writeString(SESSION_EPOCH_KEY, to_string(sessionEpoch));
         return;
     }
 fail:
@@ -74,28 +109,63 @@ void KeyValueStore::write(string_view key, const vector<u1> &value) {
     if (rc != 0) {
         throw invalid_argument("failed write into database");
     }
+    recordAccess(key);
+    writeRemote(key, value);
+
+    // Commit in batches as writes stream in (the same commit-and-reopen dance as `clear`), so the
+    // final commit at the end of the run has little left to flush. This matters on slow
+    // filesystems, where a single transaction holding every cached tree can take seconds to sync.
+    bytesSinceCommit += key.size() + value.size();
+    if (bytesSinceCommit >= AUTO_COMMIT_THRESHOLD_BYTES) {
+        flush();
+    }
+}
+
+void KeyValueStore::flush() {
+    if (writerId != this_thread::get_id()) {
+        throw invalid_argument("KeyValueStore can only flush from thread that created it");
+    }
+    auto rc = mdb_txn_commit(txn);
+    if (rc != 0) {
+        throw_mdb_error("failed to commit write batch"sv, rc);
+    }
+    refreshMainTransaction();
+    bytesSinceCommit = 0;
 }
 
 u1 *KeyValueStore::read(string_view key) {
+    // Each thread's transaction is remembered here after its first lookup, so warm reads skip
+    // readers_mtx entirely: with many workers hammering a warm cache, the lock acquisition itself
+    // was the bottleneck, not the map behind it. Keyed by storeId so an entry left over from an
+    // earlier store is never reused against this one.
+    static thread_local struct {
+        u8 storeId = 0;
+        MDB_txn *txn = nullptr;
+    } cachedReader;
+
     MDB_txn *txn = nullptr;
     int rc = 0;
-    {
-        absl::ReaderMutexLock lk(&readers_mtx);
-        auto fnd = readers.find(this_thread::get_id());
-        if (fnd != readers.end()) {
-            txn = fnd->second;
-            ENFORCE(txn != nullptr);
+    if (this_thread::get_id() == writerId) {
+        // The writer reads through the main transaction, which flush commits and replaces; take it
+        // fresh every time instead of caching it.
+        txn = this->txn;
+    } else if (cachedReader.storeId == storeId) {
+        txn = cachedReader.txn;
+        ENFORCE(txn != nullptr);
+    } else {
+        {
+            absl::WriterMutexLock lk(&readers_mtx);
+            auto &txn_store = readers[this_thread::get_id()];
+            if (txn_store == nullptr) {
+                rc = mdb_txn_begin(env, nullptr, MDB_RDONLY, &txn_store);
+            }
+            txn = txn_store;
         }
-    }
-    if (txn == nullptr) {
-        absl::WriterMutexLock lk(&readers_mtx);
-        auto &txn_store = readers[this_thread::get_id()];
-        ENFORCE(txn_store == nullptr);
-        rc = mdb_txn_begin(env, nullptr, MDB_RDONLY, &txn_store);
-        txn = txn_store;
-    }
-    if (rc != 0) {
-        throw_mdb_error("failed to create read transaction"sv, rc);
+        if (rc != 0) {
+            throw_mdb_error("failed to create read transaction"sv, rc);
+        }
+        cachedReader.storeId = storeId;
+        cachedReader.txn = txn;
     }
 
     MDB_val kv;
@@ -105,13 +175,302 @@ u1 *KeyValueStore::read(string_view key) {
     rc = mdb_get(txn, dbi, &kv, &data);
     if (rc != 0) {
         if (rc == MDB_NOTFOUND) {
-            return nullptr;
+            return readRemote(key);
         }
         throw_mdb_error("failed read from the database"sv, rc);
     }
+    recordAccess(key);
     return (u1 *)data.mv_data;
 }
 
+void KeyValueStore::recordAccess(string_view key) {
+    auto &pending = pendingAccesses;
+    if (pending.storeId != storeId) {
+        pending.storeId = storeId;
+        pending.keys.clear();
+    }
+    pending.keys.emplace_back(key);
+    if (pending.keys.size() >= ACCESS_FLUSH_BATCH) {
+        flushAccessBuffer();
+    }
+}
+
+void KeyValueStore::flushAccessBuffer() {
+    auto &pending = pendingAccesses;
+    if (pending.storeId != storeId || pending.keys.empty()) {
+        return;
+    }
+    absl::MutexLock lk(&touchedKeys_mtx);
+    for (auto &key : pending.keys) {
+        touchedKeys.insert(move(key));
+    }
+    pending.keys.clear();
+}
+
+size_t KeyValueStore::writeTouchedEpochs() {
+    UnorderedSet<string> drained;
+    flushAccessBuffer();
+    {
+        absl::MutexLock lk(&touchedKeys_mtx);
+        drained.swap(touchedKeys);
+    }
+    for (auto &key : drained) {
+        MDB_val kv;
+        MDB_val dv;
+        kv.mv_size = key.size();
+        kv.mv_data = (void *)key.data();
+        dv.mv_size = sizeof(u8);
+        dv.mv_data = (void *)&sessionEpoch;
+        auto rc = mdb_put(txn, epochDbi, &kv, &dv, 0);
+        if (rc != 0) {
+            throw_mdb_error("failed to record entry epochs"sv, rc);
+        }
+    }
+    return drained.size();
+}
+
+size_t KeyValueStore::sweepStale(u8 maxAgeSessions, size_t budgetEntries) {
+    if (writerId != this_thread::get_id()) {
+        throw invalid_argument("KeyValueStore can only sweep from thread that created it");
+    }
+    if (sweepDone) {
+        return 0;
+    }
+    auto epochsWritten = writeTouchedEpochs();
+
+    MDB_cursor *cursor = nullptr;
+    int rc = mdb_cursor_open(txn, dbi, &cursor);
+    if (rc != 0) {
+        throw_mdb_error("failed to open sweep cursor"sv, rc);
+    }
+    MDB_val k;
+    MDB_val v;
+    if (sweepResumeKey.empty()) {
+        rc = mdb_cursor_get(cursor, &k, &v, MDB_FIRST);
+    } else {
+        k.mv_size = sweepResumeKey.size();
+        k.mv_data = (void *)sweepResumeKey.data();
+        rc = mdb_cursor_get(cursor, &k, &v, MDB_SET_RANGE);
+    }
+    size_t scanned = 0;
+    size_t deleted = 0;
+    size_t grandfathered = 0;
+    while (rc == 0 && scanned < budgetEntries) {
+        string_view key((const char *)k.mv_data, k.mv_size);
+        scanned++;
+        if (key != VERSION_KEY && key != OLD_VERSION_KEY && key != SESSION_EPOCH_KEY) {
+            MDB_val epochVal;
+            u8 entryEpoch = 0;
+            bool hasEpoch = mdb_get(txn, epochDbi, &k, &epochVal) == 0 && epochVal.mv_size == sizeof(u8);
+            if (hasEpoch) {
+                memcpy(&entryEpoch, epochVal.mv_data, sizeof(u8));
+            }
+            if (!hasEpoch) {
+                // The entry predates epoch tracking or was overlaid by importDatabase; stamp it
+                // with the current epoch rather than evict a possibly warm entry.
+                MDB_val stamp;
+                stamp.mv_size = sizeof(u8);
+                stamp.mv_data = (void *)&sessionEpoch;
+                rc = mdb_put(txn, epochDbi, &k, &stamp, 0);
+                if (rc != 0) {
+                    break;
+                }
+                grandfathered++;
+            } else if (entryEpoch + maxAgeSessions < sessionEpoch) {
+                // Delete the epoch record first: mdb_cursor_del repositions the cursor and `k` may
+                // no longer point at this entry's key afterwards.
+                mdb_del(txn, epochDbi, &k, nullptr);
+                rc = mdb_cursor_del(cursor, 0);
+                if (rc != 0) {
+                    break;
+                }
+                deleted++;
+            }
+        }
+        rc = mdb_cursor_get(cursor, &k, &v, MDB_NEXT);
+    }
+    if (rc == MDB_NOTFOUND) {
+        sweepDone = true;
+        sweepResumeKey.clear();
+    } else if (rc == 0) {
+        // Budget exhausted; the next slice resumes at the first unexamined key.
+        sweepResumeKey.assign((const char *)k.mv_data, k.mv_size);
+    }
+    mdb_cursor_close(cursor);
+    if (rc != 0 && rc != MDB_NOTFOUND) {
+        throw_mdb_error("failed to sweep database"sv, rc);
+    }
+    prodCounterAdd("cache.gc.scanned", scanned);
+    prodCounterAdd("cache.gc.deleted", deleted);
+    prodCounterAdd("cache.gc.grandfathered", grandfathered);
+    if (sweepDone) {
+        MDB_stat stat;
+        if (mdb_stat(txn, dbi, &stat) == 0) {
+            // Steady-state size after the pass, for dashboards tracking whether eviction is
+            // keeping up with growth.
+            prodCounterAdd("cache.gc.entries_after_sweep", stat.ms_entries);
+        }
+    }
+    if (deleted > 0 || grandfathered > 0 || epochsWritten > 0) {
+        flush();
+    }
+    return deleted;
+}
+
+string KeyValueStore::remoteEntryPath(string_view key) const {
+    auto hashBytes = crypto_hashing::hash64(absl::StrCat(remoteKeyPrefix, key));
+    return absl::StrCat(remotePath, "/",
+                        absl::BytesToHexString(string_view((char *)hashBytes.data(), size(hashBytes))));
+}
+
+u1 *KeyValueStore::readRemote(string_view key) {
+    if (remotePath.empty()) {
+        return nullptr;
+    }
+    {
+        absl::ReaderMutexLock lk(&remoteBlobs_mtx);
+        auto fnd = remoteBlobs.find(key);
+        if (fnd != remoteBlobs.end()) {
+            return fnd->second->data();
+        }
+    }
+    string bytes;
+    try {
+        bytes = FileOps::read(remoteEntryPath(key));
+    } catch (FileNotFoundException e) {
+        prodCounterInc("cache.remote.miss");
+        return nullptr;
+    }
+    prodCounterInc("cache.remote.hit");
+    auto blob = make_unique<vector<u1>>(bytes.begin(), bytes.end());
+    absl::WriterMutexLock lk(&remoteBlobs_mtx);
+    auto &slot = remoteBlobs[string(key)];
+    if (slot == nullptr) {
+        slot = move(blob);
+    }
+    return slot->data();
+}
+
+void KeyValueStore::writeRemote(string_view key, const vector<u1> &value) {
+    if (remotePath.empty()) {
+        return;
+    }
+    auto finalPath = remoteEntryPath(key);
+    if (FileOps::exists(finalPath)) {
+        // Content-addressed: a fleet-mate already published this entry.
+        return;
+    }
+    // Write a private temp file and rename it into place so concurrent readers never observe a
+    // half-written entry.
+    auto tmpPath = absl::StrCat(finalPath, ".", getpid(), ".tmp");
+    FileOps::write(tmpPath, value);
+    if (::rename(tmpPath.c_str(), finalPath.c_str()) != 0) {
+        FileOps::removeFile(tmpPath);
+    }
+}
+
+size_t KeyValueStore::importDatabase(const string &otherPath) {
+    if (writerId != this_thread::get_id()) {
+        throw invalid_argument("KeyValueStore can only import from thread that created it");
+    }
+    MDB_env *otherEnv = nullptr;
+    MDB_txn *otherTxn = nullptr;
+    MDB_dbi otherDbi;
+    int rc = mdb_env_create(&otherEnv);
+    if (rc == 0) {
+        rc = mdb_env_set_mapsize(otherEnv, MAX_DB_SIZE_BYTES);
+    }
+    if (rc == 0) {
+        rc = mdb_env_set_maxdbs(otherEnv, 3);
+    }
+    if (rc == 0) {
+        rc = mdb_env_open(otherEnv, otherPath.c_str(), MDB_RDONLY, 0664);
+    }
+    if (rc == 0) {
+        rc = mdb_txn_begin(otherEnv, nullptr, MDB_RDONLY, &otherTxn);
+    }
+    if (rc != 0) {
+        if (otherEnv != nullptr) {
+            mdb_env_close(otherEnv);
+        }
+        throw_mdb_error("failed to open import database"sv, rc);
+    }
+    auto cleanup = [&]() {
+        mdb_txn_abort(otherTxn);
+        mdb_env_close(otherEnv);
+    };
+
+    rc = mdb_dbi_open(otherTxn, flavor.c_str(), 0, &otherDbi);
+    if (rc == MDB_NOTFOUND) {
+        // The artifact holds no entries for this flavor; nothing to overlay.
+        prodCounterInc("cache.import.flavor_mismatch");
+        cleanup();
+        return 0;
+    }
+    if (rc != 0) {
+        cleanup();
+        throw_mdb_error("failed to open import database"sv, rc);
+    }
+
+    // Entries are only meaningful between identical binary versions; compare the artifact's stored
+    // version against ours and ignore it wholesale on mismatch.
+    MDB_val verKey;
+    verKey.mv_size = VERSION_KEY.size();
+    verKey.mv_data = (void *)VERSION_KEY.data();
+    MDB_val theirRawVersion;
+    string_view theirVersion;
+    if (mdb_get(otherTxn, otherDbi, &verKey, &theirRawVersion) == 0 && theirRawVersion.mv_size >= sizeof(size_t)) {
+        size_t sz;
+        memcpy(&sz, theirRawVersion.mv_data, sizeof(sz));
+        theirVersion = string_view(((const char *)theirRawVersion.mv_data) + sizeof(sz), sz);
+    }
+    auto ourVersion = readString(VERSION_KEY);
+    if (ourVersion.empty() || theirVersion != ourVersion) {
+        prodCounterInc("cache.import.version_mismatch");
+        cleanup();
+        return 0;
+    }
+
+    MDB_cursor *cursor = nullptr;
+    rc = mdb_cursor_open(otherTxn, otherDbi, &cursor);
+    if (rc != 0) {
+        cleanup();
+        throw_mdb_error("failed to open import database"sv, rc);
+    }
+    size_t imported = 0;
+    MDB_val k;
+    MDB_val v;
+    while ((rc = mdb_cursor_get(cursor, &k, &v, MDB_NEXT)) == 0) {
+        string_view key((const char *)k.mv_data, k.mv_size);
+        if (key == VERSION_KEY || key == OLD_VERSION_KEY) {
+            continue;
+        }
+        // NOOVERWRITE: anything already cached locally is at least as fresh as the artifact.
+        // Imported entries go only into the local database, not the remote tier: the artifact
+        // typically came from there (or from an equivalent publisher) in the first place.
+        rc = mdb_put(txn, dbi, &k, &v, MDB_NOOVERWRITE);
+        if (rc == MDB_KEYEXIST) {
+            continue;
+        }
+        if (rc != 0) {
+            break;
+        }
+        imported++;
+        bytesSinceCommit += k.mv_size + v.mv_size;
+        if (bytesSinceCommit >= AUTO_COMMIT_THRESHOLD_BYTES) {
+            flush();
+        }
+    }
+    mdb_cursor_close(cursor);
+    if (rc != MDB_NOTFOUND && rc != 0) {
+        cleanup();
+        throw_mdb_error("failed to import database"sv, rc);
+    }
+    cleanup();
+    prodCounterAdd("cache.import.entries", imported);
+    return imported;
+}
+
 void KeyValueStore::clear() {
     if (writerId != this_thread::get_id()) {
         throw invalid_argument("KeyValueStore can only write from thread that created it");
@@ -120,6 +479,10 @@ void KeyValueStore::clear() {
     if (rc != 0) {
         goto fail;
     }
+    rc = mdb_drop(txn, epochDbi, 0);
+    if (rc != 0) {
+        goto fail;
+    }
     rc = mdb_txn_commit(txn);
     if (rc != 0) {
         goto fail;
@@ -157,29 +520,41 @@ void KeyValueStore::refreshMainTransaction() {
     if (rc != 0) {
         goto fail;
     }
-    rc = mdb_dbi_open(txn, flavor.c_str(), MDB_CREATE, &dbi);
-    if (rc != 0) {
-        goto fail;
-    }
-    // Per the docs for mdb_dbi_open:
-    //
-    // The database handle will be private to the current transaction
-    // until the transaction is successfully committed. If the
-    // transaction is aborted the handle will be closed
-    // automatically. After a successful commit the handle will reside
-    // in the shared environment, and may be used by other
-    // transactions.
-    //
-    // So we commit immediately to force the dbi into the shared space
-    // so that readers can use it, and then re-open the transaction
-    // for future writes.
-    rc = mdb_txn_commit(txn);
-    if (rc != 0) {
-        goto fail;
-    }
-    rc = mdb_txn_begin(env, nullptr, 0, &txn);
-    if (rc != 0) {
-        goto fail;
+    if (!dbiOpened) {
+        rc = mdb_dbi_open(txn, flavor.c_str(), MDB_CREATE, &dbi);
+        if (rc != 0) {
+            goto fail;
+        }
+        {
+            auto epochDbName = absl::StrCat(flavor, "-epochs");
+            rc = mdb_dbi_open(txn, epochDbName.c_str(), MDB_CREATE, &epochDbi);
+        }
+        if (rc != 0) {
+            goto fail;
+        }
+        // Per the docs for mdb_dbi_open:
+        //
+        // The database handle will be private to the current transaction
+        // until the transaction is successfully committed. If the
+        // transaction is aborted the handle will be closed
+        // automatically. After a successful commit the handle will reside
+        // in the shared environment, and may be used by other
+        // transactions.
+        //
+        // So we commit immediately to force the dbi into the shared space
+        // so that readers can use it, and then re-open the transaction
+        // for future writes. Once the handle lives in the shared space it stays valid, so later
+        // refreshes (flush runs one after every write batch) skip this commit-and-reopen round
+        // trip.
+        rc = mdb_txn_commit(txn);
+        if (rc != 0) {
+            goto fail;
+        }
+        rc = mdb_txn_begin(env, nullptr, 0, &txn);
+        if (rc != 0) {
+            goto fail;
+        }
+        dbiOpened = true;
     }
     {
         absl::WriterMutexLock lk(&readers_mtx);
@@ -192,6 +567,16 @@ fail:
 
 bool KeyValueStore::commit(unique_ptr<KeyValueStore> k) {
     int rc;
+    // Entries served from the remote tier this run become local entries for the next one.
+    {
+        absl::ReaderMutexLock lk(&k->remoteBlobs_mtx);
+        for (auto &entry : k->remoteBlobs) {
+            k->write(entry.first, *entry.second);
+        }
+    }
+    // Persist this run's access epochs so batch runs (which never sweep) still refresh the age of
+    // the entries they used.
+    k->writeTouchedEpochs();
     k->commited = true;
     rc = mdb_txn_commit(k->txn);
 
@@ -14,16 +14,61 @@ namespace sorbet {
 class KeyValueStore {
     MDB_env *env;
     MDB_dbi dbi;
+    // Sibling database mapping each entry's key to the session epoch it was last read or written,
+    // so sweepStale can evict entries that no recent session referenced. Kept out of the main
+    // database so epoch refreshes never dirty the pages holding entry payloads.
+    MDB_dbi epochDbi;
     MDB_txn *txn;
     const std::string path;
     const std::string flavor;
+    // See the constructor docs. `remoteKeyPrefix` is mixed into the hash naming remote entries so
+    // different versions and flavors coexist in one shared directory.
+    const std::string remotePath;
+    const std::string remoteKeyPrefix;
     const std::thread::id writerId;
+    // Process-globally unique id of this store instance. `read` caches each thread's transaction
+    // in a thread_local keyed by this id, so the pool below is only consulted (under its mutex) on
+    // a thread's first read against a given store.
+    const u8 storeId;
     UnorderedMap<std::thread::id, MDB_txn *> readers;
     absl::Mutex readers_mtx;
     bool commited = false;
+    // True once the dbi handle has been committed into the shared environment; later
+    // refreshMainTransaction calls reuse it instead of re-opening and re-committing it.
+    bool dbiOpened = false;
+
+    // Writes accumulated in the main transaction since it was last committed. Once this crosses
+    // AUTO_COMMIT_THRESHOLD_BYTES, `write` commits and reopens the transaction, so durability is
+    // spread across the run instead of one giant flush in `commit` at exit.
+    size_t bytesSinceCommit = 0;
+    static constexpr size_t AUTO_COMMIT_THRESHOLD_BYTES = 64L * 1024 * 1024;
+
+    // Entries served from the remote tier this run. The map owns the bytes backing pointers handed
+    // out by `read`; `commit` writes them back into the local database for the next run.
+    UnorderedMap<std::string, std::unique_ptr<std::vector<u1>>> remoteBlobs;
+    absl::Mutex remoteBlobs_mtx;
+
+    // Monotonic count of sessions (store openings) against this database, bumped in the
+    // constructor. Entry ages for eviction are measured in these rather than wall time, so a cache
+    // untouched over a vacation is not wiped on return.
+    u8 sessionEpoch = 0;
+    // Keys read or written this session whose epoch refresh has not yet been written into
+    // `epochDbi`. Populated from any thread (in per-thread batches; see recordAccess), drained on
+    // the writer thread by sweepStale.
+    UnorderedSet<std::string> touchedKeys;
+    absl::Mutex touchedKeys_mtx;
+    // Where the next sweepStale slice resumes scanning; empty means the front of the database.
+    std::string sweepResumeKey;
+    bool sweepDone = false;
 
     void clear();
     void refreshMainTransaction();
+    void recordAccess(std::string_view key);
+    void flushAccessBuffer();
+    size_t writeTouchedEpochs();
+    std::string remoteEntryPath(std::string_view key) const;
+    u1 *readRemote(std::string_view key);
+    void writeRemote(std::string_view key, const std::vector<u1> &value);
 
 public:
     /**
@@ -42,14 +87,50 @@ public:
      * other options that may affect the cached data. Two
      * `KeyValueStore`s opened with different `flavor`s will not share
      * any entries, but each will see their own set of values.
+     *
+     * `remotePath`, when nonempty, names a shared directory (typically
+     * a LAN mount) used as a second cache tier: reads that miss the
+     * local database fall through to it, and local writes are mirrored
+     * into it, so a fleet of machines warms each other's caches.
+     * Entries are content-addressed by a hash of `version`, `flavor`
+     * and the key, so concurrent writers of the same entry are
+     * harmless and different configurations coexist in one directory.
      */
-    KeyValueStore(std::string version, std::string path, std::string flavor);
+    KeyValueStore(std::string version, std::string path, std::string flavor, std::string remotePath = "");
     /** returns nullptr if not found*/
     u1 *read(std::string_view key);
     std::string_view readString(std::string_view key);
     void writeString(std::string_view key, std::string_view value);
     /** can only be called from main thread */
     void write(std::string_view key, const std::vector<u1> &value);
+    /**
+     * Commits pending writes and reopens the write transaction. Long-lived processes (the LSP
+     * server) call this after writing entries they need durable, since they never reach the final
+     * `commit` at process exit. Can only be called from the thread that created the store.
+     */
+    void flush();
+    /**
+     * Overlays every entry of another cache database (an unpacked artifact published by a warm-up
+     * run, typically addressed by the commit it was built at) into this one. Existing local
+     * entries win, and imported entries are not mirrored to the remote tier. Entries from a
+     * different `version` or `flavor` are ignored wholesale. Returns the number of entries
+     * imported. Can only be called from the thread that created the store.
+     */
+    size_t importDatabase(const std::string &otherPath);
+    /**
+     * Scans up to `budgetEntries` entries, deleting those whose last recorded access is more than
+     * `maxAgeSessions` sessions old, and refreshes the access epochs of this session's reads and
+     * writes. Entries written before epoch tracking existed are stamped with the current epoch on
+     * first encounter instead of evicted. Successive calls resume where the previous slice
+     * stopped; once a full pass over the database completes, further calls this session are
+     * no-ops (see sweepComplete). Returns the number of entries deleted. Can only be called from
+     * the thread that created the store.
+     */
+    size_t sweepStale(u8 maxAgeSessions, size_t budgetEntries);
+    /** True once sweepStale has completed a full pass this session. */
+    bool sweepComplete() const {
+        return sweepDone;
+    }
     ~KeyValueStore() noexcept(false);
     static bool commit(std::unique_ptr<KeyValueStore>);
 };
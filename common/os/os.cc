@@ -1,7 +1,9 @@
 #include "os.h"
 #include "common/common.h"
 #include <climits>
+#include <fstream>
 #include <pthread.h>
+#include <thread>
 #if __has_feature(address_sanitizer)
 #include <sanitizer/lsan_interface.h>
 #endif
@@ -77,6 +79,28 @@ unique_ptr<Joinable> runInAThread(string_view threadName, function<void()> funct
     return res;
 }
 
+vector<int> coresGroupedByPackage() {
+    auto coreCount = static_cast<int>(thread::hardware_concurrency());
+    vector<int> cores(coreCount);
+    for (int i = 0; i < coreCount; i++) {
+        cores[i] = i;
+    }
+#ifdef __linux__
+    // Kernels number logical cpus in arbitrary socket order on some machines; sort them by
+    // physical package so consecutive workers land on the same socket. Stable so the in-package
+    // order (and thus hyperthread pairing) is preserved.
+    vector<int> packageOf(coreCount, 0);
+    for (int i = 0; i < coreCount; i++) {
+        ifstream in("/sys/devices/system/cpu/cpu" + to_string(i) + "/topology/physical_package_id");
+        if (!(in >> packageOf[i])) {
+            packageOf[i] = 0;
+        }
+    }
+    stable_sort(cores.begin(), cores.end(), [&packageOf](int a, int b) { return packageOf[a] < packageOf[b]; });
+#endif
+    return cores;
+}
+
 void intentionallyLeakMemory(void *ptr) {
 #if __has_feature(address_sanitizer)
     __lsan_ignore_object(ptr);
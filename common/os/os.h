@@ -5,6 +5,7 @@
 #include <optional>
 #include <pthread.h>
 #include <string>
+#include <vector>
 
 std::string addr2line(std::string_view programName, void const *const *addr, int count);
 
@@ -37,6 +38,11 @@ std::unique_ptr<Joinable> runInAThread(std::string_view threadName, std::functio
                                        std::optional<int> bindToCore = std::nullopt);
 bool setCurrentThreadName(std::string_view name);
 bool bindThreadToCore(pthread_t handle, int coreId);
+// Core ids ordered so that all cores of one physical package (socket) come before the next one's.
+// Pinning worker i to the i'th entry fills a socket before spilling onto its sibling, keeping runs
+// that use fewer threads than cores socket-local. Identity order when the topology is unavailable
+// (non-Linux, or sysfs missing).
+std::vector<int> coresGroupedByPackage();
 
 /** The should trigger debugger breakpoint if the debugger is attached, if no debugger is attach, it should do nothing
  *  This allows to:
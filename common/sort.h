@@ -3,6 +3,10 @@
 
 #include "pdqsort.h"
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 template <class Container, class Compare> inline void fast_sort(Container &container, Compare &&comp) {
     pdqsort(container.begin(), container.end(), std::forward<Compare>(comp));
 };
@@ -11,4 +15,72 @@ template <class Container> inline void fast_sort(Container &container) {
     pdqsort(container.begin(), container.end());
 };
 
+// Stable LSB radix sort for containers whose sort key is an unsigned 32-bit id extracted by
+// `getKey` (FileRef/NameRef/SymbolRef ids, hash values, ...). A comparison sort pays an
+// unpredictable branch per comparison; this makes four branch-free counting passes over the key
+// bytes — and skips the passes where every key shares a digit, which for dense id spaces is most of
+// the high bytes. Small inputs fall back to pdqsort, where the radix setup cost doesn't pay off.
+// The container must offer random access, and elements are moved, not copied.
+template <class Container, class GetKey> inline void fast_sort_u4_keys(Container &container, GetKey &&getKey) {
+    using Elem = typename Container::value_type;
+    const size_t n = container.size();
+    constexpr size_t RADIX_SORT_MIN_SIZE = 1024;
+    if (n < RADIX_SORT_MIN_SIZE) {
+        pdqsort(container.begin(), container.end(),
+                [&getKey](const auto &a, const auto &b) { return getKey(a) < getKey(b); });
+        return;
+    }
+
+    std::vector<Elem> elemsScratch(n);
+    std::vector<uint32_t> keys(n);
+    std::vector<uint32_t> keysScratch(n);
+    {
+        size_t i = 0;
+        for (const auto &e : container) {
+            keys[i++] = getKey(e);
+        }
+    }
+
+    bool inScratch = false;
+    for (int shift = 0; shift < 32; shift += 8) {
+        auto &srcKeys = inScratch ? keysScratch : keys;
+        auto &dstKeys = inScratch ? keys : keysScratch;
+
+        std::array<size_t, 256> counts{};
+        for (size_t j = 0; j < n; j++) {
+            counts[(srcKeys[j] >> shift) & 0xff]++;
+        }
+        if (counts[(srcKeys[0] >> shift) & 0xff] == n) {
+            // Every key shares this digit; the pass would be the identity permutation.
+            continue;
+        }
+        size_t total = 0;
+        for (size_t b = 0; b < 256; b++) {
+            auto c = counts[b];
+            counts[b] = total;
+            total += c;
+        }
+
+        auto scatter = [&](auto &srcElems, auto &dstElems) {
+            for (size_t j = 0; j < n; j++) {
+                auto dst = counts[(srcKeys[j] >> shift) & 0xff]++;
+                dstKeys[dst] = srcKeys[j];
+                dstElems[dst] = std::move(srcElems[j]);
+            }
+        };
+        if (inScratch) {
+            scatter(elemsScratch, container);
+        } else {
+            scatter(container, elemsScratch);
+        }
+        inScratch = !inScratch;
+    }
+
+    if (inScratch) {
+        for (size_t j = 0; j < n; j++) {
+            container[j] = std::move(elemsScratch[j]);
+        }
+    }
+};
+
 #endif
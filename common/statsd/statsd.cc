@@ -8,6 +8,9 @@ extern "C" {
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 
+#include "common/sort.h"
+
+#include <cmath>
 #include <string>
 #include <sys/resource.h> // getrusage
 
@@ -15,13 +18,44 @@ using namespace std;
 
 namespace sorbet {
 
+namespace {
+// Recovers an approximate quantile from a latency histogram: the upper bound of the first bucket at
+// which the cumulative count reaches the requested fraction of the total. Accuracy is bounded by
+// the bucket width (see latencyBucketUs in common/Counters.cc).
+int histogramQuantile(const vector<pair<int, CounterImpl::CounterType>> &sortedBuckets,
+                      CounterImpl::CounterType total, double quantile) {
+    auto rank = static_cast<CounterImpl::CounterType>(ceil(quantile * total));
+    CounterImpl::CounterType seen = 0;
+    for (auto &bucket : sortedBuckets) {
+        seen += bucket.second;
+        if (seen >= rank) {
+            return bucket.first;
+        }
+    }
+    return sortedBuckets.empty() ? 0 : sortedBuckets.back().first;
+}
+} // namespace
+
 class StatsdClientWrapper {
-    constexpr static int PKT_LEN = 512; // conservative bound for MTU
+    // Multi-metric datagram size. 1432 is the statsd-recommended bound for a 1500-byte MTU after
+    // IP/UDP headers; the previous 512 forced roughly three times as many packets per export.
+    constexpr static int PKT_LEN = 1432;
     statsd_link *link;
     string packet;
 
-    string cleanMetricName(string_view name) {
-        return absl::StrReplaceAll(name, {{":", "_"}, {"|", "_"}, {"@", "_"}});
+    const string &cleanMetricName(string_view name) {
+        // Metric names repeat across exports (the LSP server flushes every few minutes for the
+        // lifetime of the process), so intern the cleaned form instead of re-running the
+        // replacement on every emission. Exports run on a single thread; thread_local keeps this
+        // safe if that ever stops being true.
+        static thread_local UnorderedMap<string, string> cleaned;
+        auto it = cleaned.find(name);
+        if (it == cleaned.end()) {
+            it = cleaned
+                     .emplace(string(name), absl::StrReplaceAll(name, {{":", "_"}, {"|", "_"}, {"@", "_"}}))
+                     .first;
+        }
+        return it->second;
     }
 
     void addMetric(string_view name, size_t value, string_view type) {
@@ -52,12 +86,29 @@ public:
     }
 
     void gauge(string_view name, size_t value) { // type : g
+        // Gauges persist on the collector until overwritten, so re-sending a value identical to
+        // the previous export is pure traffic. Keyed on the namespaced name so the same metric
+        // under different prefixes doesn't collide.
+        static thread_local UnorderedMap<string, size_t> lastExported;
+        auto [it, inserted] = lastExported.try_emplace(absl::StrCat(link->ns ? link->ns : "", name), value);
+        if (!inserted) {
+            if (it->second == value) {
+                return;
+            }
+            it->second = value;
+        }
         addMetric(name, value, "g");
     }
     void timing(const CounterImpl::Timing &tim) { // type: ms
         auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(tim.end - tim.start).count();
         addMetric(absl::StrCat(tim.measure, ".duration_ns"), nanoseconds,
                   "ms"); // format suggested by #observability (@sjung and @an)
+        // Self time (inclusive minus named children) only differs from the inclusive duration for
+        // timers that had children, so skip the extra metric for the leaves that dominate volume.
+        auto inclusiveUs = std::chrono::duration_cast<std::chrono::microseconds>(tim.end - tim.start).count();
+        if (tim.selfUs != inclusiveUs) {
+            addMetric(absl::StrCat(tim.measure, ".self_duration_ns"), tim.selfUs * 1000, "ms");
+        }
     }
 };
 
@@ -85,6 +136,22 @@ bool StatsD::submitCounters(const CounterState &counters, string_view host, int
         statsd.gauge(absl::StrCat(hist.first, ".total"), sum);
     }
 
+    for (auto &hist : counters.counters->timingHistograms) {
+        vector<pair<int, CounterImpl::CounterType>> sortedBuckets(hist.second.begin(), hist.second.end());
+        fast_sort(sortedBuckets, [](const auto &e1, const auto &e2) -> bool { return e1.first < e2.first; });
+        CounterImpl::CounterType total = 0;
+        for (auto &bucket : sortedBuckets) {
+            total += bucket.second;
+        }
+        if (total == 0) {
+            continue;
+        }
+        statsd.gauge(absl::StrCat(hist.first, ".latency_us.count"), total);
+        statsd.gauge(absl::StrCat(hist.first, ".latency_us.p50"), histogramQuantile(sortedBuckets, total, 0.5));
+        statsd.gauge(absl::StrCat(hist.first, ".latency_us.p90"), histogramQuantile(sortedBuckets, total, 0.9));
+        statsd.gauge(absl::StrCat(hist.first, ".latency_us.p99"), histogramQuantile(sortedBuckets, total, 0.99));
+    }
+
     for (auto &e : counters.counters->counters) {
         statsd.gauge(e.first, e.second);
     }
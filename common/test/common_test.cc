@@ -10,6 +10,10 @@ TEST(CommonTest, Levenstein) { // NOLINT
     EXPECT_EQ(5, Levenstein::distance("Ruby", "Scala", 10));
     EXPECT_EQ(3, Levenstein::distance("Java", "Scala", 10));
     EXPECT_EQ(INT_MAX, Levenstein::distance("Java", "S", 1));
+    // Same length, but over the bound: the banded kernel reports only "over bound", not the exact
+    // distance.
+    EXPECT_EQ(INT_MAX, Levenstein::distance("Ruby", "Perl", 2));
+    EXPECT_EQ(1, Levenstein::distance("Constant", "Constants", 1));
 }
 
 } // namespace sorbet::common
@@ -39,10 +39,19 @@ struct argtype_extractor<ReturnType (ClassType::*)(ArgType *) const>
     using arg_type = ArgType;
 };
 
+// Customization point: a base class whose subclasses carry a kind tag can specialize this to
+// replace the typeid-based fast_cast with a tag compare (see cfg::Instruction), so each handler
+// test in a typecase chain costs one integer comparison instead of a typeid lookup.
+template <typename Base, typename To> struct TypecaseCast {
+    static To *cast(Base *base) {
+        return fast_cast<Base, To>(base);
+    }
+};
+
 template <typename Base, typename FUNC> bool typecaseHelper(Base *base, FUNC &&func) {
     typedef argtype_extractor<std::function<get_signature<FUNC>>> traits;
     typedef typename traits::arg_type ArgType;
-    if (ArgType *first = fast_cast<Base, ArgType>(base)) {
+    if (ArgType *first = TypecaseCast<Base, ArgType>::cast(base)) {
         func(first);
         return true;
     } else {
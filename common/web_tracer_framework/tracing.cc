@@ -9,10 +9,94 @@
 #include "common/web_tracer_framework/tracing.h"
 #include "version/version.h"
 #include <chrono>
+#include <cstring>
+#include <fcntl.h>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 using namespace std;
 namespace sorbet::web_tracer_framework {
+namespace {
+void formatTiming(fmt::memory_buffer &result, const CounterImpl::Timing &e, pid_t pid) {
+    // Always carry self time (inclusive minus named children) and, when nested, the parent timer,
+    // so a regression in a phase is attributable without diffing whole traces.
+    string argList = fmt::format("\"self_ms\":{:.3f}", e.selfUs / 1000.0);
+    if (e.parent != nullptr) {
+        argList = fmt::format("{},\"parent\":\"{}\"", argList, JSON::escape(e.parent));
+    }
+    if (!e.args.empty()) {
+        argList = fmt::format("{},{}", argList, fmt::map_join(e.args, ",", [](const auto &nameValue) -> string {
+                                  return fmt::format("\"{}\":\"{}\"", JSON::escape(nameValue.first),
+                                                     JSON::escape(nameValue.second));
+                              }));
+    }
+    string maybeArgs = fmt::format(",\"args\":{{{}}}", argList);
+
+    string maybeFlow;
+    if (e.self.id != 0) {
+        ENFORCE(e.prev.id == 0);
+        maybeFlow = fmt::format(",\"bind_id\":{},\"flow_out\":true", e.self.id);
+    } else if (e.prev.id != 0) {
+        maybeFlow = fmt::format(",\"bind_id\":{},\"flow_in\":true", e.prev.id);
+    }
+
+    fmt::format_to(result, "{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{}{}{}}}",
+                   e.measure, (std::chrono::duration<double, std::micro>(e.start.time_since_epoch())).count(),
+                   (std::chrono::duration<double, std::micro>(e.end - e.start)).count(), pid, e.threadId, maybeArgs,
+                   maybeFlow);
+}
+
+// On-disk format for the binary trace sink: a 16-byte header written when the file is created,
+// then fixed-size TraceRecords appended verbatim. Records are memcpy'd off the in-memory events —
+// no serialization — and read back by binaryTracesToJson on the same machine, so integers are
+// host-endian and there is no cross-architecture portability guarantee (none is needed: the
+// converter runs where the trace was taken).
+struct TraceFileHeader {
+    static constexpr u4 MAGIC = 0x52544253; // "SBTR"
+    static constexpr u4 VERSION = 1;
+
+    u4 magic;
+    u4 version;
+    u4 recordSize;
+    u4 reserved;
+};
+
+struct TraceRecord {
+    enum class Kind : u1 {
+        Timing = 1,
+        Counter = 2,
+    };
+
+    Kind kind = Kind::Timing;
+    u1 flowKind = 0; // 0 = none, 1 = flow_out, 2 = flow_in
+    u2 reserved = 0;
+    u4 pid = 0;
+    int threadId = 0;
+    u4 flowId = 0;
+    int64_t startUs = 0; // Timing: event start on the steady clock. Counter: time of the flush.
+    int64_t durUs = 0;
+    int64_t selfUs = 0;
+    int64_t value = 0; // Counter only.
+    // NUL-terminated and truncated to fit. Timer args are dropped: records are fixed-size by
+    // design, and the converted JSON keeps the load-bearing self_ms/parent/flow fields.
+    char name[80] = {};
+    char parent[48] = {};
+};
+
+template <size_t N> void copyTruncated(char (&dst)[N], const char *src) {
+    if (src == nullptr) {
+        return;
+    }
+    strncpy(dst, src, N - 1);
+    dst[N - 1] = '\0';
+}
+
+int64_t toUs(chrono::time_point<chrono::steady_clock> tp) {
+    return chrono::duration_cast<chrono::microseconds>(tp.time_since_epoch()).count();
+}
+} // namespace
+
 bool Tracing::storeTraces(const CounterState &counters, string_view fileName) {
     fmt::memory_buffer result;
 
@@ -51,31 +135,186 @@ bool Tracing::storeTraces(const CounterState &counters, string_view fileName) {
     // }
 
     for (const auto &e : counters.counters->timings) {
-        string maybeArgs;
-        if (!e.args.empty()) {
-            maybeArgs = fmt::format(",\"args\":{{{}}}", fmt::map_join(e.args, ",", [](const auto &nameValue) -> string {
-                                        return fmt::format("\"{}\":\"{}\"", JSON::escape(nameValue.first),
-                                                           JSON::escape(nameValue.second));
-                                    }));
-        }
+        formatTiming(result, e, pid);
+        fmt::format_to(result, ",\n");
+    }
+
+    fmt::format_to(result, "\n");
+    FileOps::append(fileName, to_string(result));
+    return true;
+}
 
-        string maybeFlow;
+bool Tracing::storeTracesBinary(const CounterState &counters, string_view fileName) {
+    counters.counters->canonicalize();
+    auto pid = getpid();
+    auto nowUs = toUs(chrono::steady_clock::now());
+
+    vector<TraceRecord> records;
+    for (auto &cat : counters.counters->countersByCategory) {
+        for (auto &e : cat.second) {
+            auto &rec = records.emplace_back();
+            rec.kind = TraceRecord::Kind::Counter;
+            rec.pid = pid;
+            rec.startUs = nowUs;
+            rec.value = e.second;
+            copyTruncated(rec.name, absl::StrCat(cat.first, ".", e.first).c_str());
+        }
+    }
+    for (auto &e : counters.counters->counters) {
+        auto &rec = records.emplace_back();
+        rec.kind = TraceRecord::Kind::Counter;
+        rec.pid = pid;
+        rec.startUs = nowUs;
+        rec.value = e.second;
+        copyTruncated(rec.name, e.first);
+    }
+    for (const auto &e : counters.counters->timings) {
+        auto &rec = records.emplace_back();
+        rec.kind = TraceRecord::Kind::Timing;
+        rec.pid = pid;
+        rec.threadId = e.threadId;
+        rec.startUs = toUs(e.start);
+        rec.durUs = toUs(e.end) - rec.startUs;
+        rec.selfUs = e.selfUs;
         if (e.self.id != 0) {
             ENFORCE(e.prev.id == 0);
-            maybeFlow = fmt::format(",\"bind_id\":{},\"flow_out\":true", e.self.id);
+            rec.flowKind = 1;
+            rec.flowId = e.self.id;
         } else if (e.prev.id != 0) {
-            maybeFlow = fmt::format(",\"bind_id\":{},\"flow_in\":true", e.prev.id);
+            rec.flowKind = 2;
+            rec.flowId = e.prev.id;
         }
-
-        fmt::format_to(result,
-                       "{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{}{}{}}},\n",
-                       e.measure, (std::chrono::duration<double, std::micro>(e.start.time_since_epoch())).count(),
-                       (std::chrono::duration<double, std::micro>(e.end - e.start)).count(), pid, e.threadId, maybeArgs,
-                       maybeFlow);
+        copyTruncated(rec.name, e.measure);
+        copyTruncated(rec.parent, e.parent);
+    }
+    if (records.empty()) {
+        return true;
     }
 
-    fmt::format_to(result, "\n");
-    FileOps::append(fileName, to_string(result));
+    // Append via mmap: grow the file once, map it, and memcpy the records in. Like storeTraces,
+    // repeated flushes (and multiple phases of one run) append to the same file.
+    int fd = ::open(string(fileName).c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t oldSize = st.st_size;
+    bool fresh = oldSize == 0;
+    if (!fresh && (oldSize < sizeof(TraceFileHeader) ||
+                   (oldSize - sizeof(TraceFileHeader)) % sizeof(TraceRecord) != 0)) {
+        close(fd);
+        return false;
+    }
+    size_t offset = fresh ? sizeof(TraceFileHeader) : oldSize;
+    size_t newSize = offset + records.size() * sizeof(TraceRecord);
+    if (ftruncate(fd, newSize) != 0) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    auto *base = static_cast<char *>(map);
+    if (fresh) {
+        TraceFileHeader header{TraceFileHeader::MAGIC, TraceFileHeader::VERSION, sizeof(TraceRecord), 0};
+        memcpy(base, &header, sizeof(header));
+    } else {
+        TraceFileHeader header;
+        memcpy(&header, base, sizeof(header));
+        if (header.magic != TraceFileHeader::MAGIC || header.version != TraceFileHeader::VERSION ||
+            header.recordSize != sizeof(TraceRecord)) {
+            munmap(map, newSize);
+            close(fd);
+            return false;
+        }
+    }
+    memcpy(base + offset, records.data(), records.size() * sizeof(TraceRecord));
+    munmap(map, newSize);
+    close(fd);
     return true;
 }
+
+string Tracing::binaryTracesToJson(string_view data) {
+    if (data.size() < sizeof(TraceFileHeader)) {
+        Exception::raise("binary trace file too small to hold a header");
+    }
+    TraceFileHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != TraceFileHeader::MAGIC) {
+        Exception::raise("not a binary trace file (bad magic)");
+    }
+    if (header.version != TraceFileHeader::VERSION || header.recordSize != sizeof(TraceRecord)) {
+        Exception::raise("binary trace file was written by an incompatible version");
+    }
+    if ((data.size() - sizeof(TraceFileHeader)) % sizeof(TraceRecord) != 0) {
+        Exception::raise("binary trace file is truncated");
+    }
+    auto numRecords = (data.size() - sizeof(TraceFileHeader)) / sizeof(TraceRecord);
+
+    fmt::memory_buffer result;
+    fmt::format_to(result, "[\n");
+    fmt::format_to(result, "{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},\"args\":{{\"name\":\"Sorbet v{}\"}}}}",
+                   getpid(), Version::full_version_string);
+    for (size_t i = 0; i < numRecords; i++) {
+        TraceRecord rec;
+        memcpy(&rec, data.data() + sizeof(TraceFileHeader) + i * sizeof(TraceRecord), sizeof(rec));
+        // Defensive: name/parent are NUL-terminated by the writer, but don't trust the file.
+        rec.name[sizeof(rec.name) - 1] = '\0';
+        rec.parent[sizeof(rec.parent) - 1] = '\0';
+        fmt::format_to(result, ",\n");
+        switch (rec.kind) {
+            case TraceRecord::Kind::Counter:
+                fmt::format_to(result,
+                               "{{\"name\":\"{}\",\"ph\":\"C\",\"ts\":{},\"pid\":{},\"args\":{{\"value\":{}}}}}",
+                               JSON::escape(rec.name), rec.startUs, rec.pid, rec.value);
+                break;
+            case TraceRecord::Kind::Timing: {
+                string argList = fmt::format("\"self_ms\":{:.3f}", rec.selfUs / 1000.0);
+                if (rec.parent[0] != '\0') {
+                    argList = fmt::format("{},\"parent\":\"{}\"", argList, JSON::escape(rec.parent));
+                }
+                string maybeFlow;
+                if (rec.flowKind == 1) {
+                    maybeFlow = fmt::format(",\"bind_id\":{},\"flow_out\":true", rec.flowId);
+                } else if (rec.flowKind == 2) {
+                    maybeFlow = fmt::format(",\"bind_id\":{},\"flow_in\":true", rec.flowId);
+                }
+                fmt::format_to(
+                    result, "{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{},\"dur\":{},\"pid\":{},\"tid\":{},\"args\":{{{}}}{}}}",
+                    JSON::escape(rec.name), rec.startUs, rec.durUs, rec.pid, rec.threadId, argList, maybeFlow);
+                break;
+            }
+            default:
+                Exception::raise("binary trace file contains a record of unknown kind {}",
+                                 static_cast<int>(rec.kind));
+        }
+    }
+    fmt::format_to(result, "\n]\n");
+    return to_string(result);
+}
+
+string Tracing::dumpRecentTraces(double lastSeconds) {
+    auto cutoff = chrono::steady_clock::now() - chrono::duration<double>(lastSeconds);
+    auto pid = getpid();
+    fmt::memory_buffer result;
+    fmt::format_to(result, "[\n");
+    fmt::format_to(result,
+                   "{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},\"args\":{{\"name\":\"Sorbet v{}\"}}}}", pid,
+                   Version::full_version_string);
+    for (const auto &e : getTimingRingBufferSnapshot()) {
+        if (e.end < cutoff) {
+            continue;
+        }
+        fmt::format_to(result, ",\n");
+        formatTiming(result, e, pid);
+    }
+    fmt::format_to(result, "\n]\n");
+    return to_string(result);
+}
 } // namespace sorbet::web_tracer_framework
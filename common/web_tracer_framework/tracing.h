@@ -9,6 +9,21 @@ public:
     Tracing() = delete;
 
     static bool storeTraces(const CounterState &counters, std::string_view fileName);
+
+    // Like storeTraces, but appends fixed-size binary records to an mmap'd file instead of
+    // rendering JSON: flushing a big trace is a bulk memcpy, so always-on tracing stays cheap.
+    // See TraceFileHeader/TraceRecord in tracing.cc for the format; convert the file offline with
+    // binaryTracesToJson (--web-trace-convert).
+    static bool storeTracesBinary(const CounterState &counters, std::string_view fileName);
+
+    // Offline converter for files written by storeTracesBinary: renders the records as a complete
+    // Chrome trace JSON document. Raises on a file that was not written by this build's format.
+    static std::string binaryTracesToJson(std::string_view data);
+
+    // Renders every event in the global timing ring buffer (see enableTimingRingBuffer in
+    // common/Counters.h) that ended within the last `lastSeconds` seconds as a complete Chrome
+    // trace JSON document, suitable for chrome://tracing.
+    static std::string dumpRecentTraces(double lastSeconds);
 };
 } // namespace sorbet::web_tracer_framework
 
@@ -30,7 +30,7 @@ bool Context::permitOverloadDefinitions(FileRef sigLoc) const {
     if (!owner.exists()) {
         return false;
     }
-    for (auto loc : owner.data(*this)->locs()) {
+    for (auto loc : owner.data(*this)->locs(*this)) {
         auto &file = loc.file().data(*this);
         constexpr string_view whitelistedTest = "overloads_test.rb"sv;
         if (((file.isPayload() || file.isStdlib()) && owner != Symbols::root() &&
@@ -66,7 +66,7 @@ GlobalSubstitution::GlobalSubstitution(const GlobalState &from, GlobalState &to,
     : toGlobalStateId(to.globalStateId) {
     Timer timeit(to.tracer(), "GlobalSubstitution.new", from.creation);
     ENFORCE(toGlobalStateId != 0, "toGlobalStateId is only used for sanity checks, but should always be set.");
-    ENFORCE(from.symbols.size() == to.symbols.size(), "Can't substitute symbols yet");
+    ENFORCE(from.symbols().size() == to.symbols().size(), "Can't substitute symbols yet");
 
     const_cast<GlobalState &>(from).sanityCheck();
     {
@@ -86,12 +86,33 @@ GlobalSubstitution::GlobalSubstitution(const GlobalState &from, GlobalState &to,
     }
 
     fastPath = false;
+    // Names below this id are known to have the same id in `from` and `to`, so they substitute to
+    // themselves without consulting `to`'s name table.
+    u4 sharedPrefix = 0;
     if (optionalCommonParent != nullptr) {
         if (from.namesUsed() == optionalCommonParent->namesUsed() &&
             from.symbolsUsed() == optionalCommonParent->symbolsUsed()) {
             ENFORCE(to.namesUsed() >= from.namesUsed());
             ENFORCE(to.symbolsUsed() >= from.symbolsUsed());
             fastPath = true;
+        } else {
+            // Both states descend from the common parent via deepCopy, which preserves name ids and
+            // never edits entries in place, so the parent's names form a shared read-only intern
+            // table: any name either side inherited has the same id in both. deepCloneHistory
+            // records how much of the parent each side saw when it was cloned; the smaller of the
+            // two bounds is safe even if the parent kept growing between the clones.
+            auto boundFor = [&](const GlobalState &gs) -> u4 {
+                if (gs.globalStateId == optionalCommonParent->globalStateId) {
+                    return optionalCommonParent->namesUsed();
+                }
+                for (const auto &entry : gs.deepCloneHistory) {
+                    if (entry.globalStateId == optionalCommonParent->globalStateId) {
+                        return entry.lastNameKnownByParentGlobalState;
+                    }
+                }
+                return 0;
+            };
+            sharedPrefix = std::min(boundFor(from), boundFor(to));
         }
     }
 
@@ -99,12 +120,18 @@ GlobalSubstitution::GlobalSubstitution(const GlobalState &from, GlobalState &to,
         bool seenEmpty = false;
         {
             UnfreezeNameTable unfreezeNames(to);
-            nameSubstitution.reserve(from.names.size());
+            nameSubstitution.reserve(from.nameTable().names.size());
             int i = -1;
-            for (const Name &nm : from.names) {
+            for (const Name &nm : from.nameTable().names) {
                 i++;
                 ENFORCE(nameSubstitution.size() == i, "Name substitution has wrong size");
                 if (seenEmpty) {
+                    if (static_cast<u4>(i) < sharedPrefix && !debug_mode) {
+                        // Inherited from the common parent: identity, no hash lookup needed. In
+                        // debug builds we take the slow path below and ENFORCE it agrees.
+                        nameSubstitution.emplace_back(to, i);
+                        continue;
+                    }
                     switch (nm.kind) {
                         case NameKind::UNIQUE:
                             nameSubstitution.emplace_back(to.freshNameUnique(
@@ -124,13 +151,15 @@ GlobalSubstitution::GlobalSubstitution(const GlobalState &from, GlobalState &to,
                     seenEmpty = true;
                 }
                 ENFORCE(!fastPath || nameSubstitution.back()._id == i);
+                ENFORCE(static_cast<u4>(i) >= sharedPrefix || nameSubstitution.back()._id == i,
+                        "name inherited from common parent changed id");
             }
         }
 
         // Enforce that the symbol tables are the same
-        for (int i = 0; i < from.symbols.size(); ++i) {
-            ENFORCE(substitute(from.symbols[i].name) == from.symbols[i].name);
-            ENFORCE(from.symbols[i].name == to.symbols[i].name);
+        for (int i = 0; i < from.symbols().size(); ++i) {
+            ENFORCE(substitute(from.symbols()[i].name) == from.symbols()[i].name);
+            ENFORCE(from.symbols()[i].name == to.symbols()[i].name);
         }
     }
 
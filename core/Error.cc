@@ -44,65 +44,113 @@ bool Error::isCritical() const {
     return this->what.minLevel == StrictLevel::Internal;
 }
 
-string restoreColors(string_view formatted, rang::fg color) {
+template <typename T> string streamToString(T code) {
     stringstream buf;
-    buf << color;
-    return _replaceAll(formatted, REVERT_COLOR_SIGIL, buf.str());
+    buf << code;
+    return buf.str();
 }
 
-string ErrorLine::toString(const GlobalState &gs, bool color) const {
-    stringstream buf;
-    string indent = "  ";
-    buf << indent << FILE_POS_STYLE << loc.filePosToString(gs) << RESET_STYLE << ":";
+// The escape sequences rang emits for the constants above, captured once per control-mode switch:
+// message assembly appends into a single fmt buffer, which cannot stream rang manipulators
+// directly (and a stringstream per colored fragment is exactly the allocation churn this avoids).
+struct ColorCodes {
+    string errorColor;
+    string lowNoiseColor;
+    string detailColor;
+    string resetColor;
+    string filePosStyle;
+    string resetStyle;
+};
+
+ColorCodes makeColorCodes() {
+    return ColorCodes{streamToString(ERROR_COLOR), streamToString(LOW_NOISE_COLOR), streamToString(DETAIL_COLOR),
+                      streamToString(RESET_COLOR), streamToString(FILE_POS_STYLE),  streamToString(RESET_STYLE)};
+}
+
+ColorCodes colorCodes = makeColorCodes();
+
+// Appends `formatted` with any REVERT_COLOR_SIGIL occurrences replaced by `color`. The sigil is
+// only ever present when colors are on, so the common uncolored path appends without copying.
+void appendRestoringColors(fmt::memory_buffer &buf, string_view formatted, string_view color) {
+    if (formatted.find(REVERT_COLOR_SIGIL) == string_view::npos) {
+        fmt::format_to(buf, "{}", formatted);
+        return;
+    }
+    fmt::format_to(buf, "{}", _replaceAll(formatted, REVERT_COLOR_SIGIL, color));
+}
+
+void ErrorLine::toString(fmt::memory_buffer &buf, const GlobalState &gs, bool color) const {
+    string_view indent = "  "sv;
+    fmt::format_to(buf, "{}{}{}{}:", indent, colorCodes.filePosStyle, loc.filePosToString(gs), colorCodes.resetStyle);
     if (!formattedMessage.empty()) {
-        buf << " ";
+        fmt::format_to(buf, " ");
         if (color) {
-            buf << DETAIL_COLOR << restoreColors(formattedMessage, DETAIL_COLOR) << RESET_COLOR;
+            fmt::format_to(buf, "{}", colorCodes.detailColor);
+            appendRestoringColors(buf, formattedMessage, colorCodes.detailColor);
+            fmt::format_to(buf, "{}", colorCodes.resetColor);
         } else {
-            buf << restoreColors(formattedMessage, RESET_COLOR);
+            appendRestoringColors(buf, formattedMessage, colorCodes.resetColor);
         }
     }
 
     if (loc.exists()) {
-        buf << '\n' << loc.toStringWithTabs(gs, 2);
+        fmt::format_to(buf, "\n{}", loc.toStringWithTabs(gs, 2));
     }
-    return buf.str();
 }
 
-string ErrorSection::toString(const GlobalState &gs) const {
-    stringstream buf;
-    string indent = "  ";
+string ErrorLine::toString(const GlobalState &gs, bool color) const {
+    fmt::memory_buffer buf;
+    toString(buf, gs, color);
+    return to_string(buf);
+}
+
+void ErrorSection::toString(fmt::memory_buffer &buf, const GlobalState &gs) const {
+    string_view indent = "  "sv;
     bool coloredLineHeaders = true;
     bool skipEOL = false;
     if (!this->header.empty()) {
         coloredLineHeaders = false;
-        buf << indent << DETAIL_COLOR << restoreColors(this->header, DETAIL_COLOR) << RESET_COLOR;
+        fmt::format_to(buf, "{}{}", indent, colorCodes.detailColor);
+        appendRestoringColors(buf, this->header, colorCodes.detailColor);
+        fmt::format_to(buf, "{}", colorCodes.resetColor);
     } else {
         skipEOL = true;
     }
     for (auto &line : this->messages) {
         if (!skipEOL) {
-            buf << '\n';
+            fmt::format_to(buf, "\n");
         }
         skipEOL = false;
-        buf << indent << line.toString(gs, coloredLineHeaders);
+        fmt::format_to(buf, "{}", indent);
+        line.toString(buf, gs, coloredLineHeaders);
     }
-    return buf.str();
+}
+
+string ErrorSection::toString(const GlobalState &gs) const {
+    fmt::memory_buffer buf;
+    toString(buf, gs);
+    return to_string(buf);
 }
 
 string Error::toString(const GlobalState &gs) const {
-    stringstream buf;
-    buf << RESET_STYLE << FILE_POS_STYLE << loc.filePosToString(gs) << RESET_STYLE << ": " << ERROR_COLOR
-        << restoreColors(header, ERROR_COLOR) << RESET_COLOR << LOW_NOISE_COLOR << " " << gs.errorUrlBase << what.code
-        << RESET_COLOR;
+    // Per-thread assembly buffer: sections and lines append in place and the returned message is
+    // one exact-size copy. The buffer's grown capacity is retained across errors on the thread.
+    static thread_local fmt::memory_buffer buf;
+    buf.clear();
+    fmt::format_to(buf, "{}{}{}{}: {}", colorCodes.resetStyle, colorCodes.filePosStyle, loc.filePosToString(gs),
+                   colorCodes.resetStyle, colorCodes.errorColor);
+    appendRestoringColors(buf, header, colorCodes.errorColor);
+    fmt::format_to(buf, "{}{} {}{}{}", colorCodes.resetColor, colorCodes.lowNoiseColor, gs.errorUrlBase, what.code,
+                   colorCodes.resetColor);
     if (loc.exists()) {
-        buf << '\n' << loc.toStringWithTabs(gs, 2);
+        fmt::format_to(buf, "\n{}", loc.toStringWithTabs(gs, 2));
     }
 
     for (auto &section : this->sections) {
-        buf << '\n' << section.toString(gs);
+        fmt::format_to(buf, "\n");
+        section.toString(buf, gs);
     }
-    return buf.str();
+    return to_string(buf);
 }
 
 ErrorRegion::~ErrorRegion() {
@@ -152,6 +200,14 @@ ErrorBuilder::~ErrorBuilder() {
     if (state == State::DidBuild) {
         return;
     }
+    if (state == State::Unreported) {
+        // A suppressed error still lowers the file's minimum error level (suggest-typed consults
+        // it), but nothing downstream looks at the Error itself, so don't allocate one or push it
+        // through the error queue.
+        state = State::DidBuild;
+        this->gs._recordErrorLevel(this->loc, this->what);
+        return;
+    }
     this->gs._error(build());
 }
 
@@ -169,6 +225,7 @@ string ErrorColors::coloredPatternReplace = (string)coloredPatternSigil;
 
 void ErrorColors::enableColors() {
     rang::setControlMode(rang::control::Force);
+    colorCodes = makeColorCodes();
     stringstream buf;
     buf << INTERPOLATION_COLOR << "{}" << REVERT_COLOR_SIGIL;
     coloredPatternReplace = buf.str();
@@ -176,6 +233,7 @@ void ErrorColors::enableColors() {
 void ErrorColors::disableColors() {
     coloredPatternReplace = coloredPatternSigil;
     rang::setControlMode(rang::control::Off);
+    colorCodes = makeColorCodes();
 }
 
 } // namespace sorbet::core
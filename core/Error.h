@@ -35,6 +35,11 @@ class ErrorColors {
 public:
     ErrorColors() = delete;
     template <typename... Args> static std::string format(std::string_view msg, const Args &... args) {
+        if (coloredPatternReplace == coloredPatternSigil) {
+            // Colors are off: the pattern substitution is the identity, so skip allocating a
+            // rewritten format string.
+            return fmt::format(msg, args...);
+        }
         return fmt::format(replaceAll(msg, coloredPatternSigil, coloredPatternReplace), args...);
     }
     static void enableColors();
@@ -51,6 +56,9 @@ struct ErrorLine {
         return ErrorLine(loc, move(formatted));
     }
     std::string toString(const GlobalState &gs, bool color = true) const;
+    /** Appends to `buf` instead of returning a fresh string; Error::toString assembles the whole
+     * message into one buffer this way. */
+    void toString(fmt::memory_buffer &buf, const GlobalState &gs, bool color) const;
 };
 
 struct ErrorSection {
@@ -64,6 +72,7 @@ struct ErrorSection {
     ErrorSection(const std::initializer_list<ErrorLine> &messages) : ErrorSection("", messages) {}
     ErrorSection(const std::vector<ErrorLine> &messages) : ErrorSection("", messages) {}
     std::string toString(const GlobalState &gs) const;
+    void toString(fmt::memory_buffer &buf, const GlobalState &gs) const;
 };
 
 class Error {
@@ -1,31 +1,36 @@
 #include "core/ErrorFlusher.h"
 #include "common/FileSystem.h"
 #include "core/lsp/QueryResponse.h"
+#include <cstdio>
 
 using namespace std;
 
 namespace sorbet::core {
 
-void ErrorFlusher::flushErrors(spdlog::logger &logger, vector<unique_ptr<ErrorQueueMessage>> errors) {
+void ErrorFlusher::flushErrors(spdlog::logger &logger, vector<ErrorQueueMessage> errors) {
     fmt::memory_buffer critical, nonCritical;
     for (auto &error : errors) {
-        if (error->kind == ErrorQueueMessage::Kind::Error) {
-            if (error->error->isSilenced) {
+        if (error.kind == ErrorQueueMessage::Kind::Error) {
+            if (error.error->isSilenced) {
                 continue;
             }
 
-            prodHistogramAdd("error", error->error->what.code, 1);
+            prodHistogramAdd("error", error.error->what.code, 1);
 
-            auto &out = error->error->isCritical() ? critical : nonCritical;
-            if (out.size() != 0) {
-                fmt::format_to(out, "\n\n");
+            for (auto &autocorrect : error.error->autocorrects) {
+                autocorrects.emplace_back(move(autocorrect));
             }
-            ENFORCE(error->text.has_value());
-            fmt::format_to(out, "{}", error->text.value_or(""));
 
-            for (auto &autocorrect : error->error->autocorrects) {
-                autocorrects.emplace_back(move(autocorrect));
+            if (error.deduplicated) {
+                continue;
             }
+
+            auto &out = error.error->isCritical() ? critical : nonCritical;
+            if (out.size() != 0) {
+                fmt::format_to(out, "\n\n");
+            }
+            ENFORCE(error.text.has_value());
+            fmt::format_to(out, "{}", error.text.value_or(""));
         }
     }
 
@@ -47,6 +52,49 @@ void ErrorFlusher::flushErrors(spdlog::logger &logger, vector<unique_ptr<ErrorQu
     }
 }
 
+void ErrorFlusher::flushBinaryErrors(vector<ErrorQueueMessage> errors) {
+    auto wroteAny = false;
+    for (auto &error : errors) {
+        if (error.kind != ErrorQueueMessage::Kind::Error || error.error->isSilenced) {
+            continue;
+        }
+
+        prodHistogramAdd("error", error.error->what.code, 1);
+
+        for (auto &autocorrect : error.error->autocorrects) {
+            autocorrects.emplace_back(move(autocorrect));
+        }
+
+        ENFORCE(error.text.has_value());
+        if (error.text.has_value()) {
+            fwrite(error.text->data(), 1, error.text->size(), stdout);
+            wroteAny = true;
+        }
+    }
+    if (wroteAny) {
+        fflush(stdout);
+    }
+}
+
+void ErrorFlusher::flushDedupedErrorGroups(spdlog::logger &logger, vector<DedupedErrorGroup> groups) {
+    fmt::memory_buffer out;
+    for (auto &group : groups) {
+        if (out.size() != 0) {
+            fmt::format_to(out, "\n");
+        }
+        fmt::format_to(out, "{} (code {}): reported {} times; the first occurrence is shown above, others include {}",
+                       group.header, group.code, group.count, fmt::join(group.sampleLocs, ", "));
+    }
+    if (out.size() != 0) {
+        if (!printedAtLeastOneError) {
+            logger.log(spdlog::level::err, "{}", to_string(out));
+            printedAtLeastOneError = true;
+        } else {
+            logger.log(spdlog::level::err, "\n{}", to_string(out));
+        }
+    }
+}
+
 void ErrorFlusher::flushErrorCount(spdlog::logger &logger, int count) {
     if (count == 0) {
         logger.log(spdlog::level::err, "No errors! Great job.", count);
@@ -9,6 +9,15 @@ namespace sorbet {
 class FileSystem;
 namespace core {
 
+/** One group of identical errors collapsed by --dedup-errors: same code and same header. The first
+ * occurrence is printed in full as usual; the group records how often it recurred and where. */
+struct DedupedErrorGroup {
+    int code = 0;
+    std::string header;
+    int count = 0;
+    std::vector<std::string> sampleLocs;
+};
+
 class ErrorFlusher {
 private:
     std::vector<AutocorrectSuggestion> autocorrects;
@@ -16,7 +25,11 @@ private:
 
 public:
     ErrorFlusher() = default;
-    void flushErrors(spdlog::logger &logger, std::vector<std::unique_ptr<ErrorQueueMessage>> error);
+    void flushErrors(spdlog::logger &logger, std::vector<ErrorQueueMessage> error);
+    /** Writes pre-encoded binary records (see core/ErrorRecord.h) to stdout, bypassing the logger
+     * so the stream stays uncorrupted by log formatting. */
+    void flushBinaryErrors(std::vector<ErrorQueueMessage> errors);
+    void flushDedupedErrorGroups(spdlog::logger &logger, std::vector<DedupedErrorGroup> groups);
     void flushErrorCount(spdlog::logger &logger, int count);
     void flushAutocorrects(const GlobalState &gs, FileSystem &fs);
 };
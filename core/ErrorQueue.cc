@@ -1,7 +1,10 @@
 #include "core/ErrorQueue.h"
+#include "absl/strings/str_cat.h"
 #include "common/FileSystem.h"
 #include "common/Timer.h"
+#include "common/sort.h"
 #include "core/Error.h"
+#include "core/ErrorRecord.h"
 
 namespace sorbet::core {
 
@@ -20,11 +23,11 @@ ErrorQueue::drainWithQueryResponses() {
 
     out.reserve(collected.size());
     for (auto &msg : collected) {
-        if (msg->kind == ErrorQueueMessage::Kind::QueryResponse) {
-            outResponses.emplace_back(move(msg->queryResponse));
+        if (msg.kind == ErrorQueueMessage::Kind::QueryResponse) {
+            outResponses.emplace_back(move(msg.queryResponse));
         }
-        if (msg->kind == ErrorQueueMessage::Kind::Error) {
-            out.emplace_back(move(msg->error));
+        if (msg.kind == ErrorQueueMessage::Kind::Error) {
+            out.emplace_back(move(msg.error));
         }
     }
 
@@ -58,13 +61,51 @@ void ErrorQueue::flushErrors(bool all) {
     }
 
     Timer timeit(tracer, "ErrorQueue::flushErrors");
-    vector<unique_ptr<ErrorQueueMessage>> errors;
+    vector<ErrorQueueMessage> errors;
     if (all) {
         errors = drainAll();
     } else {
         errors = drainFlushed();
     }
+    if (retainFlushedErrors) {
+        // Copy rather than steal: the flusher below still needs each message's Error for
+        // autocorrect collection and histogram accounting.
+        for (auto &msg : errors) {
+            if (msg.kind == ErrorQueueMessage::Kind::Error && !msg.error->isSilenced) {
+                retainedErrors[msg.whatFile].emplace_back(make_unique<Error>(*msg.error));
+            }
+        }
+    }
+    if (binaryErrors) {
+        errorFlusher.flushBinaryErrors(move(errors));
+        return;
+    }
     errorFlusher.flushErrors(logger, move(errors));
+
+    if (all && dedupErrors) {
+        // The final drain: print one summary line per group that actually recurred, most frequent
+        // first, then start fresh in case another full run reuses this queue.
+        vector<DedupedErrorGroup> groups;
+        {
+            absl::MutexLock lk(&dedupMtx);
+            for (auto &entry : dedupIndex) {
+                if (entry.second.count > 1) {
+                    groups.emplace_back(move(entry.second));
+                }
+            }
+            dedupIndex.clear();
+        }
+        fast_sort(groups,
+                  [](const DedupedErrorGroup &l, const DedupedErrorGroup &r) -> bool { return l.count > r.count; });
+        errorFlusher.flushDedupedErrorGroups(logger, move(groups));
+    }
+}
+
+UnorderedMap<core::FileRef, vector<unique_ptr<core::Error>>> ErrorQueue::stealRetainedErrors() {
+    checkOwned();
+    auto out = move(retainedErrors);
+    retainedErrors.clear();
+    return out;
 }
 
 void ErrorQueue::flushErrorCount() {
@@ -81,28 +122,52 @@ void ErrorQueue::pushError(const core::GlobalState &gs, unique_ptr<core::Error>
     msg.whatFile = error->loc.file();
     if (!error->isSilenced) {
         this->nonSilencedErrorCount.fetch_add(1);
-        // Serializing errors is expensive, so we only serialize them if the error isn't silenced.
-        msg.text = error->toString(gs);
+        // Serializing errors is expensive, so we only serialize them if the error isn't silenced,
+        // and never when flushes are ignored (LSP): the drain on that path discards the text and
+        // renders diagnostics from the Error itself.
+        if (!ignoreFlushes) {
+            if (binaryErrors) {
+                // Binary consumers want every record; the encoding is cheap enough that
+                // deduplication would only lose information.
+                msg.text = ErrorRecord::serialize(gs, *error);
+            } else if (dedupErrors && !error->isCritical()) {
+                absl::MutexLock lk(&dedupMtx);
+                auto &group = dedupIndex[absl::StrCat(error->what.code, "//", error->header)];
+                group.count++;
+                if (group.count == 1) {
+                    group.code = error->what.code;
+                    group.header = error->header;
+                } else {
+                    msg.deduplicated = true;
+                    if (group.sampleLocs.size() < DEDUP_SAMPLE_LOCS) {
+                        group.sampleLocs.emplace_back(error->loc.filePosToString(gs));
+                    }
+                }
+            }
+            if (!binaryErrors && !msg.deduplicated) {
+                msg.text = error->toString(gs);
+            }
+        }
     }
     msg.error = move(error);
     this->queue.push(move(msg), 1);
 }
 
-void ErrorQueue::collectForFile(core::FileRef whatFile, vector<unique_ptr<core::ErrorQueueMessage>> &out) {
+void ErrorQueue::collectForFile(core::FileRef whatFile, vector<core::ErrorQueueMessage> &out) {
     auto it = collected.find(whatFile);
     if (it == collected.end()) {
         return;
     }
     for (auto &error : it->second) {
-        out.emplace_back(make_unique<core::ErrorQueueMessage>(move(error)));
+        out.emplace_back(move(error));
     }
     collected[whatFile].clear();
 };
 
-vector<unique_ptr<core::ErrorQueueMessage>> ErrorQueue::drainFlushed() {
+vector<core::ErrorQueueMessage> ErrorQueue::drainFlushed() {
     checkOwned();
 
-    vector<unique_ptr<core::ErrorQueueMessage>> ret;
+    vector<core::ErrorQueueMessage> ret;
 
     core::ErrorQueueMessage msg;
     for (auto result = queue.try_pop(msg); result.gotItem(); result = queue.try_pop(msg)) {
@@ -139,13 +204,13 @@ bool ErrorQueue::isEmpty() {
     checkOwned();
     return collected.empty();
 }
-vector<unique_ptr<core::ErrorQueueMessage>> ErrorQueue::drainAll() {
+vector<core::ErrorQueueMessage> ErrorQueue::drainAll() {
     checkOwned();
     auto out = drainFlushed();
 
     for (auto &part : collected) {
         for (auto &error : part.second) {
-            out.emplace_back(make_unique<core::ErrorQueueMessage>(move(error)));
+            out.emplace_back(move(error));
         }
     }
     collected.clear();
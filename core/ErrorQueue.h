@@ -1,6 +1,7 @@
 #ifndef SORBET_ERROR_QUEUE_H
 #define SORBET_ERROR_QUEUE_H
 
+#include "absl/synchronization/mutex.h"
 #include "common/concurrency/ConcurrentQueue.h"
 #include "core/ErrorFlusher.h"
 #include "core/ErrorQueueMessage.h"
@@ -14,13 +15,21 @@ namespace core {
 class ErrorQueue {
 private:
     void checkOwned();
-    std::vector<std::unique_ptr<ErrorQueueMessage>> drainAll();
-    std::vector<std::unique_ptr<ErrorQueueMessage>> drainFlushed();
-    void collectForFile(core::FileRef whatFile, std::vector<std::unique_ptr<core::ErrorQueueMessage>> &out);
+    std::vector<ErrorQueueMessage> drainAll();
+    std::vector<ErrorQueueMessage> drainFlushed();
+    void collectForFile(core::FileRef whatFile, std::vector<core::ErrorQueueMessage> &out);
     ErrorFlusher errorFlusher;
     const std::thread::id owner;
     UnorderedMap<core::FileRef, std::vector<core::ErrorQueueMessage>> collected;
     ConcurrentUnBoundedQueue<core::ErrorQueueMessage> queue;
+    /** Groups identical errors under --dedup-errors, keyed by "<code>//<header>". Written from
+     * whichever thread reports the error, so access is guarded; the real saving is that repeat
+     * members of a group skip Error::toString entirely. */
+    absl::Mutex dedupMtx;
+    UnorderedMap<std::string, DedupedErrorGroup> dedupIndex;
+    static constexpr size_t DEDUP_SAMPLE_LOCS = 3;
+    /** Only touched on the owner thread, inside flushErrors and stealRetainedErrors. */
+    UnorderedMap<core::FileRef, std::vector<std::unique_ptr<Error>>> retainedErrors;
 
 public:
     spdlog::logger &logger;
@@ -28,6 +37,22 @@ public:
     std::atomic<bool> hadCritical{false};
     std::atomic<int> nonSilencedErrorCount{0};
     bool ignoreFlushes{false};
+    /** When set (--dedup-errors), only the first error of each (code, header) group is formatted
+     * and printed; the final flush prints one summary line per group with a count and sample
+     * locations. Criticals are never deduplicated. */
+    bool dedupErrors{false};
+    /** When set (--error-output-format=binary), errors are encoded as length-delimited binary
+     * records on stdout (see core/ErrorRecord.h) instead of being formatted with Error::toString.
+     * Every occurrence is emitted, so --dedup-errors is ignored in this mode. */
+    bool binaryErrors{false};
+    /** When set, flushErrors additionally keeps a structural copy of every non-silenced error it
+     * flushes, grouped by file, until a caller steals them with stealRetainedErrors. The
+     * pipeline's diagnostics cache uses this to persist each file's errors next to its
+     * typechecked result. */
+    bool retainFlushedErrors{false};
+
+    /** Hands over (and resets) the errors retained under retainFlushedErrors. */
+    UnorderedMap<core::FileRef, std::vector<std::unique_ptr<Error>>> stealRetainedErrors();
 
     ErrorQueue(spdlog::logger &logger, spdlog::logger &tracer);
 
@@ -13,6 +13,9 @@ struct ErrorQueueMessage {
     core::FileRef whatFile;
     // The text of the error. Is a `nullopt` if the error is silenced.
     std::optional<std::string> text;
+    // True for repeat members of a --dedup-errors group: the error counts toward totals and its
+    // autocorrects apply, but it was never formatted and must not be printed.
+    bool deduplicated = false;
     std::unique_ptr<Error> error;
     std::unique_ptr<lsp::QueryResponse> queryResponse;
 };
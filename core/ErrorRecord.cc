@@ -0,0 +1,104 @@
+#include "core/ErrorRecord.h"
+#include "core/Error.h"
+#include "core/GlobalState.h"
+
+using namespace std;
+
+namespace sorbet::core {
+
+namespace {
+void appendU4(string &out, u4 value) {
+    out.push_back(static_cast<char>(value & 0xff));
+    out.push_back(static_cast<char>((value >> 8) & 0xff));
+    out.push_back(static_cast<char>((value >> 16) & 0xff));
+    out.push_back(static_cast<char>((value >> 24) & 0xff));
+}
+
+void appendString(string &out, string_view value) {
+    appendU4(out, value.size());
+    out.append(value);
+}
+
+u4 readU4(string_view buffer, size_t offset) {
+    return static_cast<u4>(static_cast<u1>(buffer[offset])) |
+           static_cast<u4>(static_cast<u1>(buffer[offset + 1])) << 8 |
+           static_cast<u4>(static_cast<u1>(buffer[offset + 2])) << 16 |
+           static_cast<u4>(static_cast<u1>(buffer[offset + 3])) << 24;
+}
+} // namespace
+
+string ErrorRecord::serialize(const GlobalState &gs, const Error &error) {
+    string_view path;
+    u4 beginPos = NO_POS;
+    u4 endPos = NO_POS;
+    if (error.loc.exists()) {
+        path = error.loc.file().data(gs).path();
+        beginPos = error.loc.beginPos();
+        endPos = error.loc.endPos();
+    }
+
+    string payload;
+    payload.reserve(4 * 5 + 1 + path.size() + error.header.size());
+    appendU4(payload, static_cast<u4>(error.what.code));
+    appendU4(payload, beginPos);
+    appendU4(payload, endPos);
+    u1 flags = 0;
+    if (!error.autocorrects.empty()) {
+        flags |= 1;
+    }
+    if (error.isCritical()) {
+        flags |= 2;
+    }
+    payload.push_back(static_cast<char>(flags));
+    appendString(payload, path);
+    appendString(payload, error.header);
+
+    string out;
+    out.reserve(4 + payload.size());
+    appendU4(out, payload.size());
+    out.append(payload);
+    return out;
+}
+
+optional<ErrorRecord> ErrorRecord::consume(string_view &buffer) {
+    if (buffer.size() < 4) {
+        return nullopt;
+    }
+    auto payloadSize = readU4(buffer, 0);
+    if (buffer.size() - 4 < payloadSize) {
+        return nullopt;
+    }
+    auto payload = buffer.substr(4, payloadSize);
+    // code + beginPos + endPos + flags + two empty length-prefixed strings
+    if (payload.size() < 4 * 5 + 1) {
+        return nullopt;
+    }
+
+    ErrorRecord record;
+    record.code = static_cast<int>(readU4(payload, 0));
+    record.beginPos = readU4(payload, 4);
+    record.endPos = readU4(payload, 8);
+    auto flags = static_cast<u1>(payload[12]);
+    record.hasAutocorrects = (flags & 1) != 0;
+    record.isCritical = (flags & 2) != 0;
+
+    size_t offset = 13;
+    auto pathSize = readU4(payload, offset);
+    offset += 4;
+    if (payload.size() - offset < pathSize + 4) {
+        return nullopt;
+    }
+    record.path = string(payload.substr(offset, pathSize));
+    offset += pathSize;
+    auto headerSize = readU4(payload, offset);
+    offset += 4;
+    if (payload.size() - offset < headerSize) {
+        return nullopt;
+    }
+    record.header = string(payload.substr(offset, headerSize));
+
+    buffer.remove_prefix(4 + payloadSize);
+    return record;
+}
+
+} // namespace sorbet::core
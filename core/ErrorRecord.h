@@ -0,0 +1,51 @@
+#ifndef SORBET_ERROR_RECORD_H
+#define SORBET_ERROR_RECORD_H
+
+#include "common/common.h"
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sorbet::core {
+class GlobalState;
+class Error;
+
+/** Length-delimited binary encoding of diagnostics, used by --error-output-format=binary.
+ *
+ * The stream is a sequence of records; each record is a `u4 payloadSize` followed by `payloadSize`
+ * bytes laid out as:
+ *
+ *     u4  code
+ *     u4  beginPos            byte offset into the file; NO_POS when the error has no location
+ *     u4  endPos
+ *     u1  flags               bit 0: has autocorrects, bit 1: critical
+ *     u4  pathSize,   followed by pathSize bytes     (empty when the error has no location)
+ *     u4  headerSize, followed by headerSize bytes   (the one-line message, never formatted)
+ *
+ * All integers are little-endian regardless of host. Records are produced on the reporting thread
+ * in ErrorQueue::pushError in place of Error::toString, so error-heavy runs never pay for source
+ * excerpting or color formatting; `consume` is the matching reader for downstream tools.
+ */
+class ErrorRecord final {
+public:
+    static constexpr u4 NO_POS = 0xffffffffu;
+
+    int code = 0;
+    u4 beginPos = NO_POS;
+    u4 endPos = NO_POS;
+    bool hasAutocorrects = false;
+    bool isCritical = false;
+    std::string path;
+    std::string header;
+
+    static std::string serialize(const GlobalState &gs, const Error &error);
+
+    /** Decodes one record off the front of `buffer` and advances `buffer` past the consumed bytes.
+     * Returns nullopt at end of input or on a truncated record (in which case `buffer` is left
+     * untouched, so callers streaming from a pipe can retry once more bytes arrive). */
+    static std::optional<ErrorRecord> consume(std::string_view &buffer);
+};
+
+} // namespace sorbet::core
+
+#endif
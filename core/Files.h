@@ -89,6 +89,10 @@ public:
     File(const File &other) = delete;
     File() = delete;
     std::unique_ptr<File> deepCopy(GlobalState &) const;
+    // Returns a copy of this file with its source text released: the copy reverts to NotYetRead (so
+    // the pipeline re-reads it on demand) but keeps the path, strictness, and line-break table, and
+    // records a hash of the dropped text so the re-read can verify the on-disk contents.
+    std::unique_ptr<File> evictSource() const;
     std::vector<int> &lineBreaks() const;
     int lineCount() const;
     StrictLevel minErrorLevel() const;
@@ -105,6 +109,8 @@ private:
 public:
     const StrictLevel originalSigil;
     StrictLevel strictLevel;
+    // Hash of the source text dropped by evictSource; 0 unless this entry was evicted.
+    u4 evictedSourceHash = 0;
 };
 
 template <typename H> H AbslHashValue(H h, const FileRef &m) {
@@ -1,6 +1,7 @@
 #include "GlobalState.h"
 
 #include "common/Timer.h"
+#include "common/sort.h"
 #include "core/Error.h"
 #include "core/Hashing.h"
 #include "core/NameHash.h"
@@ -16,6 +17,16 @@
 #include "core/ErrorQueue.h"
 #include "core/errors/infer.h"
 #include "main/pipeline/semantic_extension/SemanticExtension.h"
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 template class std::vector<std::pair<unsigned int, unsigned int>>;
 template class std::shared_ptr<sorbet::core::GlobalState>;
@@ -28,8 +39,9 @@ namespace sorbet::core {
 SymbolRef GlobalState::synthesizeClass(NameRef nameId, u4 superclass, bool isModule) {
     // This can't use enterClass since there is a chicken and egg problem.
     // These will be added to Symbols::root().members later.
-    SymbolRef symRef = SymbolRef(this, symbols.size());
-    symbols.emplace_back();
+    auto &symbolTable = mutableSymbols();
+    SymbolRef symRef = SymbolRef(this, symbolTable.size());
+    symbolTable.emplace_back();
     SymbolData data = symRef.dataAllowingNone(*this); // allowing noSymbol is needed because this enters noSymbol.
     data->name = nameId;
     data->owner = Symbols::root();
@@ -47,6 +59,20 @@ SymbolRef GlobalState::synthesizeClass(NameRef nameId, u4 superclass, bool isMod
 atomic<int> globalStateIdCounter(1);
 const int Symbols::MAX_PROC_ARITY;
 
+// The name hash table uses a SwissTable-style group-probing layout: slots are inspected in aligned
+// groups of NAME_GROUP_WIDTH, guided by one control byte per slot that holds either NAME_SLOT_EMPTY
+// or the top seven bits of the slot's hash. A probe compares a whole group of control bytes against
+// the sought hash's tag at once (one SSE2 instruction where available) and dereferences the
+// eight-byte slots only on a tag match, so long probe chains at high load factors stay within one
+// or two cache lines instead of striding across the table. The table never deletes, so the first
+// empty slot in probe order terminates a search and is exactly where an absent name belongs.
+constexpr unsigned int NAME_GROUP_WIDTH = 16;
+constexpr u1 NAME_SLOT_EMPTY = 0x80;
+
+u1 nameSlotTag(unsigned int hs) {
+    return hs >> 25;
+}
+
 GlobalState::GlobalState(shared_ptr<ErrorQueue> errorQueue, shared_ptr<absl::Mutex> epochMutex,
                          shared_ptr<atomic<u4>> currentlyProcessingLSPEpoch, shared_ptr<atomic<u4>> lspEpochInvalidator,
                          shared_ptr<atomic<u4>> lastCommittedLSPEpoch)
@@ -59,10 +85,12 @@ GlobalState::GlobalState(shared_ptr<ErrorQueue> errorQueue, shared_ptr<absl::Mut
     unsigned int maxNameCount = 8192;
     unsigned int maxSymbolCount = 16384;
 
-    names.reserve(maxNameCount);
-    symbols.reserve(maxSymbolCount);
+    nameTable_->names.reserve(maxNameCount);
+    symbols_->reserve(maxSymbolCount);
+    symbolLocs_->reserve(maxSymbolCount);
     int namesByHashSize = 2 * maxNameCount;
-    namesByHash.resize(namesByHashSize);
+    nameTable_->namesByHash.resize(namesByHashSize);
+    nameTable_->namesByHashTags.resize(namesByHashSize, NAME_SLOT_EMPTY);
     ENFORCE((namesByHashSize & (namesByHashSize - 1)) == 0, "namesByHashSize is not a power of 2");
 }
 
@@ -70,6 +98,7 @@ void GlobalState::initEmpty() {
     UnfreezeFileTable fileTableAccess(*this);
     UnfreezeNameTable nameTableAccess(*this);
     UnfreezeSymbolTable symTableAccess(*this);
+    auto &names = mutableNameTable().names;
     names.emplace_back(); // first name is used in hashes to indicate empty cell
     names[0].kind = NameKind::UTF8;
     names[0].raw.utf8 = string_view();
@@ -484,7 +513,7 @@ void GlobalState::initEmpty() {
     // Does it in two passes since the singletonClass will go in the Symbols::root() members which will invalidate the
     // iterator
     vector<SymbolRef> needSingletons;
-    for (auto &sym : symbols) {
+    for (auto &sym : symbols()) {
         auto ref = sym.ref(*this);
         if (ref.exists() && sym.isClassOrModule()) {
             needSingletons.emplace_back(ref);
@@ -495,8 +524,8 @@ void GlobalState::initEmpty() {
     }
 
     // This fills in all the way up to MAX_SYNTHETIC_SYMBOLS
-    ENFORCE(symbols.size() < Symbols::Proc0()._id);
-    while (symbols.size() < Symbols::Proc0()._id) {
+    ENFORCE(symbols().size() < Symbols::Proc0()._id);
+    while (symbols().size() < Symbols::Proc0()._id) {
         string name = absl::StrCat("<RESERVED_", reservedCount, ">");
         synthesizeClass(enterNameConstant(name));
         reservedCount++;
@@ -510,8 +539,9 @@ void GlobalState::initEmpty() {
         id.data(*this)->singletonClass(*this);
     }
 
-    ENFORCE(symbols.size() == Symbols::last_synthetic_sym()._id + 1,
-            "Too many synthetic symbols? have: {} expected: {}", symbols.size(), Symbols::last_synthetic_sym()._id + 1);
+    ENFORCE(symbols().size() == Symbols::last_synthetic_sym()._id + 1,
+            "Too many synthetic symbols? have: {} expected: {}", symbols().size(),
+            Symbols::last_synthetic_sym()._id + 1);
 
     installIntrinsics();
 
@@ -549,6 +579,11 @@ void GlobalState::installIntrinsics() {
         }
         auto countBefore = symbolsUsed();
         SymbolRef method = enterMethodSymbol(Loc::none(), symbol, entry.method);
+        // Dispatch resolves intrinsics through this pointer alone, so two table entries claiming
+        // the same (symbol, method) would silently shadow each other here. (Re-running over an
+        // unpickled state re-installs the same impl, which is fine.)
+        ENFORCE(method.data(*this)->intrinsic == nullptr || method.data(*this)->intrinsic == entry.impl,
+                "duplicate intrinsic registered for {}", method.data(*this)->show(*this));
         method.data(*this)->intrinsic = entry.impl;
         if (countBefore != symbolsUsed()) {
             auto &blkArg = enterMethodArgumentSymbol(Loc::none(), method, Names::blkArg());
@@ -570,25 +605,97 @@ u4 nextPowerOfTwo(u4 v) {
 }
 
 void GlobalState::reserveMemory(u4 kb) {
-    u8 allocated = (sizeof(Name) + sizeof(decltype(namesByHash)::value_type)) * names.capacity() +
-                   sizeof(Symbol) * symbols.capacity();
+    u8 allocated =
+        (sizeof(Name) + sizeof(decltype(NameTable::namesByHash)::value_type)) * nameTable().names.capacity() +
+        sizeof(Symbol) * symbols().capacity();
     u8 want = 1024 * kb;
     if (allocated > want) {
         return;
     }
     u4 scale = nextPowerOfTwo(want / allocated);
-    symbols.reserve(symbols.capacity() * scale);
+    mutableSymbols().reserve(symbols().capacity() * scale);
     expandNames(scale);
     sanityCheck();
 
-    allocated = (sizeof(Name) + sizeof(decltype(namesByHash)::value_type)) * names.capacity() +
-                sizeof(Symbol) * symbols.capacity();
+    allocated = (sizeof(Name) + sizeof(decltype(NameTable::namesByHash)::value_type)) * nameTable().names.capacity() +
+                sizeof(Symbol) * symbols().capacity();
 
-    trace(absl::StrCat("Reserved ", allocated / 1024, "KiB of memory. symbols=", symbols.capacity(),
-                       " names=", names.capacity()));
+    trace(absl::StrCat("Reserved ", allocated / 1024, "KiB of memory. symbols=", symbols().capacity(),
+                       " names=", nameTable().names.capacity()));
+}
+
+void GlobalState::preallocateTables(u4 symbolCount, u4 nameCount) {
+    if (symbols().capacity() < symbolCount) {
+        mutableSymbols().reserve(nextPowerOfTwo(symbolCount));
+    }
+    if (nameTable().names.capacity() < nameCount) {
+        expandNames(nextPowerOfTwo(nameCount / nameTable().names.capacity() + 1));
+    }
+    sanityCheck();
+
+    trace(absl::StrCat("Preallocated tables. symbols=", symbols().capacity(),
+                       " names=", nameTable().names.capacity()));
+}
+
+#ifdef __linux__
+namespace {
+#ifndef MADV_POPULATE_WRITE
+// Linux 5.14. Older kernels reject the value with EINVAL, which adviseLargePageRange tolerates.
+#define MADV_POPULATE_WRITE 23
+#endif
+
+// madvise only accepts page-aligned ranges, so round inward; the few KiB shaved off the edges are
+// irrelevant at the multi-MiB sizes where huge pages pay off. Returns the number of bytes advised.
+size_t adviseLargePageRange(const void *start, size_t bytes, bool prefault) {
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    constexpr size_t largePageSize = 2 * 1024 * 1024;
+    auto addr = reinterpret_cast<uintptr_t>(start);
+    auto alignedStart = (addr + pageSize - 1) & ~(pageSize - 1);
+    auto alignedEnd = (addr + bytes) & ~(pageSize - 1);
+    if (alignedEnd < alignedStart + largePageSize) {
+        // Not even one huge page worth of memory: nothing for the kernel to collapse.
+        return 0;
+    }
+    auto *alignedPtr = reinterpret_cast<void *>(alignedStart);
+    size_t len = alignedEnd - alignedStart;
+    if (madvise(alignedPtr, len, MADV_HUGEPAGE) != 0) {
+        // EINVAL when the kernel was built without transparent huge page support.
+        prodCounterInc("types.memory.large_pages.advise_failed");
+        return 0;
+    }
+    if (prefault) {
+        // Write-fault the whole range up front so namer does not: write semantics matter, since
+        // read faults would only map the shared zero page and leave the real fault for the first
+        // store. EINVAL on pre-5.14 kernels; the huge page advice above still stands.
+        if (madvise(alignedPtr, len, MADV_POPULATE_WRITE) != 0) {
+            prodCounterInc("types.memory.large_pages.prefault_failed");
+        }
+    }
+    return len;
+}
+} // namespace
+#endif
+
+void GlobalState::adviseLargePages(bool prefault) const {
+#ifdef __linux__
+    Timer timeit(tracer(), "GlobalState::adviseLargePages");
+    // The string table is left alone: it is paged in STRINGS_PAGE_SIZE chunks, each far below one
+    // huge page. madvise does not modify memory, so reading through the const accessors is fine.
+    size_t advised = 0;
+    advised += adviseLargePageRange(symbols().data(), symbols().capacity() * sizeof(Symbol), prefault);
+    const auto &table = nameTable();
+    advised += adviseLargePageRange(table.names.data(), table.names.capacity() * sizeof(Name), prefault);
+    advised += adviseLargePageRange(table.namesByHash.data(),
+                                    table.namesByHash.capacity() *
+                                        sizeof(decltype(table.namesByHash)::value_type),
+                                    prefault);
+    advised += adviseLargePageRange(table.namesByHashTags.data(), table.namesByHashTags.capacity(), prefault);
+    prodCounterAdd("types.memory.large_pages.bytes_advised", advised);
+#endif
 }
 
 constexpr decltype(GlobalState::STRINGS_PAGE_SIZE) GlobalState::STRINGS_PAGE_SIZE;
+constexpr decltype(GlobalState::STRINGS_PAGE_MAX_SIZE) GlobalState::STRINGS_PAGE_MAX_SIZE;
 
 SymbolRef GlobalState::lookupMethodSymbolWithHash(SymbolRef owner, NameRef name, vector<u4> methodHash) const {
     ENFORCE(owner.exists(), "looking up symbol from non-existing owner");
@@ -689,6 +796,9 @@ SymbolRef GlobalState::findRenamedSymbol(SymbolRef owner, SymbolRef sym) const {
 SymbolRef GlobalState::enterSymbol(Loc loc, SymbolRef owner, NameRef name, u4 flags) {
     ENFORCE(owner.exists(), "entering symbol in to non-existing owner");
     ENFORCE(name.exists(), "entering symbol with non-existing name");
+    // May write into `owner`'s members table and appends to the symbol table; break any sharing
+    // with snapshots before taking out references into the table.
+    ensureOwnedSymbolTable();
     SymbolData ownerScope = owner.dataAllowingNone(*this);
     histogramInc("symbol_enter_by_name", ownerScope->members().size());
 
@@ -701,9 +811,9 @@ SymbolRef GlobalState::enterSymbol(Loc loc, SymbolRef owner, NameRef name, u4 fl
 
     ENFORCE(!symbolTableFrozen);
 
-    SymbolRef ret = SymbolRef(this, symbols.size());
+    SymbolRef ret = SymbolRef(this, symbols().size());
     store = ret; // DO NOT MOVE this assignment down. emplace_back on symbol invalidates `store`
-    symbols.emplace_back();
+    mutableSymbols().emplace_back();
     SymbolData data = ret.dataAllowingNone(*this);
     data->name = name;
     data->flags = flags;
@@ -851,7 +961,7 @@ string_view GlobalState::enterString(string_view nm) {
         }
     });
     char *from = nullptr;
-    if (nm.size() > GlobalState::STRINGS_PAGE_SIZE) {
+    if (nm.size() > GlobalState::STRINGS_PAGE_MAX_SIZE) {
         auto &inserted = strings.emplace_back(make_unique<vector<char>>(nm.size()));
         from = inserted->data();
         if (strings.size() > 1) {
@@ -859,9 +969,13 @@ string_view GlobalState::enterString(string_view nm) {
             swap(*(strings.end() - 1), *(strings.end() - 2));
         }
     } else {
-        if (stringsLastPageUsed + nm.size() > GlobalState::STRINGS_PAGE_SIZE) {
-            strings.emplace_back(make_unique<vector<char>>(GlobalState::STRINGS_PAGE_SIZE));
-            // printf("Wasted %i space\n", STRINGS_PAGE_SIZE - stringsLastPageUsed);
+        if (strings.empty() || stringsLastPageUsed + nm.size() > strings.back()->size()) {
+            // Double the page size (up to a cap) so that big name tables land in a few large
+            // contiguous blocks instead of thousands of small pages.
+            auto nextPageSize = strings.empty() ? GlobalState::STRINGS_PAGE_SIZE
+                                                : min(strings.back()->size() * 2, GlobalState::STRINGS_PAGE_MAX_SIZE);
+            nextPageSize = max(nextPageSize, nm.size());
+            strings.emplace_back(make_unique<vector<char>>(nextPageSize));
             stringsLastPageUsed = 0;
         }
         from = strings.back()->data() + stringsLastPageUsed;
@@ -873,79 +987,117 @@ string_view GlobalState::enterString(string_view nm) {
     return string_view(from, nm.size());
 }
 
-NameRef GlobalState::lookupNameUTF8(string_view nm) const {
-    const auto hs = _hash(nm);
-    unsigned int hashTableSize = namesByHash.size();
-    unsigned int mask = hashTableSize - 1;
-    auto bucketId = hs & mask;
+// Walks the probe sequence for `hs` — the home group from the hash's low bits, subsequent groups by
+// triangular probing so every group is eventually visited — and calls `isMatch(nameId)` for each
+// occupied slot whose full stored hash matches. Returns the index of the matching slot, or of the
+// first empty slot in probe order when no slot matches.
+template <typename F>
+unsigned int probeNameHash(const vector<pair<unsigned int, unsigned int>> &namesByHash, const vector<u1> &tags,
+                           const unsigned int hs, F isMatch) {
+    ENFORCE(namesByHash.size() == tags.size());
+    const unsigned int numGroups = namesByHash.size() / NAME_GROUP_WIDTH;
+    const unsigned int groupMask = numGroups - 1;
+    const u1 tag = nameSlotTag(hs);
+    unsigned int groupId = hs & groupMask;
     unsigned int probeCount = 1;
 
-    while (namesByHash[bucketId].second != 0u) {
-        auto &bucket = namesByHash[bucketId];
-        if (bucket.first == hs) {
-            auto nameId = bucket.second;
-            auto &nm2 = names[nameId];
-            if (nm2.kind == NameKind::UTF8 && nm2.raw.utf8 == nm) {
-                counterInc("names.utf8.hit");
-                return nm2.ref(*this);
-            } else {
-                counterInc("names.hash_collision.utf8");
+    while (true) {
+        const u1 *group = tags.data() + groupId * NAME_GROUP_WIDTH;
+#ifdef __SSE2__
+        auto ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+        unsigned int tagMatches =
+            _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(tag))));
+        while (tagMatches != 0) {
+            unsigned int offset = __builtin_ctz(tagMatches);
+            tagMatches &= tagMatches - 1;
+            auto bucketId = groupId * NAME_GROUP_WIDTH + offset;
+            if (namesByHash[bucketId].first == hs && isMatch(namesByHash[bucketId].second)) {
+                return bucketId;
             }
         }
-        bucketId = (bucketId + probeCount) & mask;
+        unsigned int empties =
+            _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(NAME_SLOT_EMPTY))));
+        if (empties != 0) {
+            return groupId * NAME_GROUP_WIDTH + __builtin_ctz(empties);
+        }
+#else
+        int firstEmpty = -1;
+        for (unsigned int offset = 0; offset < NAME_GROUP_WIDTH; offset++) {
+            if (group[offset] == tag) {
+                auto bucketId = groupId * NAME_GROUP_WIDTH + offset;
+                if (namesByHash[bucketId].first == hs && isMatch(namesByHash[bucketId].second)) {
+                    return bucketId;
+                }
+            } else if (firstEmpty < 0 && group[offset] == NAME_SLOT_EMPTY) {
+                firstEmpty = offset;
+            }
+        }
+        if (firstEmpty >= 0) {
+            return groupId * NAME_GROUP_WIDTH + firstEmpty;
+        }
+#endif
+        if (probeCount > numGroups) {
+            Exception::raise("Full table?");
+        }
+        groupId = (groupId + probeCount) & groupMask;
         probeCount++;
     }
+}
+
+NameRef GlobalState::lookupNameUTF8(string_view nm) const {
+    const auto &table = nameTable();
+    const auto hs = _hash(nm);
+    auto bucketId = probeNameHash(table.namesByHash, table.namesByHashTags, hs, [&](unsigned int nameId) {
+        auto &nm2 = table.names[nameId];
+        if (nm2.kind == NameKind::UTF8 && nm2.raw.utf8 == nm) {
+            counterInc("names.utf8.hit");
+            return true;
+        }
+        counterInc("names.hash_collision.utf8");
+        return false;
+    });
+    if (table.namesByHash[bucketId].second != 0u) {
+        return table.names[table.namesByHash[bucketId].second].ref(*this);
+    }
 
     return core::NameRef::noName();
 }
 
 NameRef GlobalState::enterNameUTF8(string_view nm) {
     const auto hs = _hash(nm);
-    unsigned int hashTableSize = namesByHash.size();
-    unsigned int mask = hashTableSize - 1;
-    auto bucketId = hs & mask;
-    unsigned int probeCount = 1;
-
-    while (namesByHash[bucketId].second != 0u) {
-        auto &bucket = namesByHash[bucketId];
-        if (bucket.first == hs) {
-            auto nameId = bucket.second;
-            auto &nm2 = names[nameId];
-            if (nm2.kind == NameKind::UTF8 && nm2.raw.utf8 == nm) {
-                counterInc("names.utf8.hit");
-                return nm2.ref(*this);
-            } else {
-                counterInc("names.hash_collision.utf8");
-            }
+    auto bucketId = probeNameHash(nameTable().namesByHash, nameTable().namesByHashTags, hs, [&](unsigned int nameId) {
+        auto &nm2 = nameTable().names[nameId];
+        if (nm2.kind == NameKind::UTF8 && nm2.raw.utf8 == nm) {
+            counterInc("names.utf8.hit");
+            return true;
         }
-        bucketId = (bucketId + probeCount) & mask;
-        probeCount++;
+        counterInc("names.hash_collision.utf8");
+        return false;
+    });
+    if (nameTable().namesByHash[bucketId].second != 0u) {
+        return nameTable().names[nameTable().namesByHash[bucketId].second].ref(*this);
     }
     ENFORCE(!nameTableFrozen);
 
-    ENFORCE(probeCount != hashTableSize, "Full table?");
-
-    if (names.size() == names.capacity()) {
+    // Only an actual insertion pays for copy-on-write; the probe above ran against the (possibly
+    // shared) table, and bucketId stays valid because the owned copy preserves layout.
+    auto &table = mutableNameTable();
+    if (table.names.size() == table.names.capacity()) {
         expandNames();
-        hashTableSize = namesByHash.size();
-        mask = hashTableSize - 1;
-        bucketId = hs & mask; // look for place in the new size
-        probeCount = 1;
-        while (namesByHash[bucketId].second != 0) {
-            bucketId = (bucketId + probeCount) & mask;
-            probeCount++;
-        }
+        // look for place in the new size
+        bucketId = probeNameHash(table.namesByHash, table.namesByHashTags, hs, [](unsigned int) { return false; });
     }
 
-    auto idx = names.size();
-    auto &bucket = namesByHash[bucketId];
+    auto idx = table.names.size();
+    auto &bucket = table.namesByHash[bucketId];
     bucket.first = hs;
     bucket.second = idx;
-    names.emplace_back();
+    table.namesByHashTags[bucketId] = nameSlotTag(hs);
+    table.names.emplace_back();
 
-    names[idx].kind = NameKind::UTF8;
-    names[idx].raw.utf8 = enterString(nm);
-    ENFORCE(names[idx].hash(*this) == hs);
+    table.names[idx].kind = NameKind::UTF8;
+    table.names[idx].raw.utf8 = enterString(nm);
+    ENFORCE(table.names[idx].hash(*this) == hs);
     categoryCounterInc("names", "utf8");
 
     wasModified_ = true;
@@ -961,53 +1113,38 @@ NameRef GlobalState::enterNameConstant(NameRef original) {
             "making a constant name over wrong name kind");
 
     const auto hs = _hash_mix_constant(NameKind::CONSTANT, original.id());
-    unsigned int hashTableSize = namesByHash.size();
-    unsigned int mask = hashTableSize - 1;
-    auto bucketId = hs & mask;
-    unsigned int probeCount = 1;
-
-    while (namesByHash[bucketId].second != 0 && probeCount < hashTableSize) {
-        auto &bucket = namesByHash[bucketId];
-        if (bucket.first == hs) {
-            auto &nm2 = names[bucket.second];
-            if (nm2.kind == NameKind::CONSTANT && nm2.cnst.original == original) {
-                counterInc("names.constant.hit");
-                return nm2.ref(*this);
-            } else {
-                counterInc("names.hash_collision.constant");
-            }
+    auto bucketId = probeNameHash(nameTable().namesByHash, nameTable().namesByHashTags, hs, [&](unsigned int nameId) {
+        auto &nm2 = nameTable().names[nameId];
+        if (nm2.kind == NameKind::CONSTANT && nm2.cnst.original == original) {
+            counterInc("names.constant.hit");
+            return true;
         }
-        bucketId = (bucketId + probeCount) & mask;
-        probeCount++;
-    }
-    if (probeCount == hashTableSize) {
-        Exception::raise("Full table?");
+        counterInc("names.hash_collision.constant");
+        return false;
+    });
+    if (nameTable().namesByHash[bucketId].second != 0u) {
+        return nameTable().names[nameTable().namesByHash[bucketId].second].ref(*this);
     }
     ENFORCE(!nameTableFrozen);
 
-    if (names.size() == names.capacity()) {
+    auto &table = mutableNameTable();
+    if (table.names.size() == table.names.capacity()) {
         expandNames();
-        hashTableSize = namesByHash.size();
-        mask = hashTableSize - 1;
-
-        bucketId = hs & mask; // look for place in the new size
-        probeCount = 1;
-        while (namesByHash[bucketId].second != 0) {
-            bucketId = (bucketId + probeCount) & mask;
-            probeCount++;
-        }
+        // look for place in the new size
+        bucketId = probeNameHash(table.namesByHash, table.namesByHashTags, hs, [](unsigned int) { return false; });
     }
 
-    auto &bucket = namesByHash[bucketId];
+    auto &bucket = table.namesByHash[bucketId];
     bucket.first = hs;
-    bucket.second = names.size();
+    bucket.second = table.names.size();
+    table.namesByHashTags[bucketId] = nameSlotTag(hs);
 
-    auto idx = names.size();
-    names.emplace_back();
+    auto idx = table.names.size();
+    table.names.emplace_back();
 
-    names[idx].kind = NameKind::CONSTANT;
-    names[idx].cnst.original = original;
-    ENFORCE(names[idx].hash(*this) == hs);
+    table.names[idx].kind = NameKind::CONSTANT;
+    table.names[idx].cnst.original = original;
+    ENFORCE(table.names[idx].hash(*this) == hs);
     wasModified_ = true;
     categoryCounterInc("names", "constant");
     return NameRef(*this, idx);
@@ -1017,22 +1154,17 @@ NameRef GlobalState::enterNameConstant(string_view original) {
     return enterNameConstant(enterNameUTF8(original));
 }
 
-void moveNames(pair<unsigned int, unsigned int> *from, pair<unsigned int, unsigned int> *to, unsigned int szFrom,
-               unsigned int szTo) {
-    // printf("\nResizing name hash table from %u to %u\n", szFrom, szTo);
-    ENFORCE((szTo & (szTo - 1)) == 0, "name hash table size corruption");
+void moveNames(const pair<unsigned int, unsigned int> *from, unsigned int szFrom,
+               vector<pair<unsigned int, unsigned int>> &to, vector<u1> &toTags) {
+    // printf("\nResizing name hash table from %u to %zu\n", szFrom, to.size());
+    ENFORCE((to.size() & (to.size() - 1)) == 0, "name hash table size corruption");
     ENFORCE((szFrom & (szFrom - 1)) == 0, "name hash table size corruption");
-    unsigned int mask = szTo - 1;
     for (unsigned int orig = 0; orig < szFrom; orig++) {
         if (from[orig].second != 0u) {
             auto hs = from[orig].first;
-            unsigned int probe = 1;
-            auto bucketId = hs & mask;
-            while (to[bucketId].second != 0) {
-                bucketId = (bucketId + probe) & mask;
-                probe++;
-            }
+            auto bucketId = probeNameHash(to, toTags, hs, [](unsigned int) { return false; });
             to[bucketId] = from[orig];
+            toTags[bucketId] = nameSlotTag(hs);
         }
     }
 }
@@ -1040,34 +1172,41 @@ void moveNames(pair<unsigned int, unsigned int> *from, pair<unsigned int, unsign
 void GlobalState::expandNames(int growBy) {
     sanityCheck();
 
-    names.reserve(names.capacity() * growBy);
-    vector<pair<unsigned int, unsigned int>> new_namesByHash(namesByHash.capacity() * growBy);
-    moveNames(namesByHash.data(), new_namesByHash.data(), namesByHash.size(), new_namesByHash.capacity());
-    namesByHash.swap(new_namesByHash);
+    auto &table = mutableNameTable();
+    table.names.reserve(table.names.capacity() * growBy);
+    vector<pair<unsigned int, unsigned int>> new_namesByHash(table.namesByHash.capacity() * growBy);
+    vector<u1> new_namesByHashTags(new_namesByHash.size(), NAME_SLOT_EMPTY);
+    moveNames(table.namesByHash.data(), table.namesByHash.size(), new_namesByHash, new_namesByHashTags);
+    table.namesByHash.swap(new_namesByHash);
+    table.namesByHashTags.swap(new_namesByHashTags);
+}
+
+void GlobalState::rebuildNamesByHashTags() {
+    auto &table = mutableNameTable();
+    table.namesByHashTags.assign(table.namesByHash.size(), NAME_SLOT_EMPTY);
+    for (unsigned int bucketId = 0; bucketId < table.namesByHash.size(); bucketId++) {
+        if (table.namesByHash[bucketId].second != 0u) {
+            table.namesByHashTags[bucketId] = nameSlotTag(table.namesByHash[bucketId].first);
+        }
+    }
 }
 
 NameRef GlobalState::lookupNameUnique(UniqueNameKind uniqueNameKind, NameRef original, u2 num) const {
     ENFORCE(num > 0, "num == 0, name overflow");
+    const auto &table = nameTable();
     const auto hs = _hash_mix_unique((u2)uniqueNameKind, NameKind::UNIQUE, num, original.id());
-    unsigned int hashTableSize = namesByHash.size();
-    unsigned int mask = hashTableSize - 1;
-    auto bucketId = hs & mask;
-    unsigned int probeCount = 1;
-
-    while (namesByHash[bucketId].second != 0 && probeCount < hashTableSize) {
-        auto &bucket = namesByHash[bucketId];
-        if (bucket.first == hs) {
-            auto &nm2 = names[bucket.second];
-            if (nm2.kind == NameKind::UNIQUE && nm2.unique.uniqueNameKind == uniqueNameKind && nm2.unique.num == num &&
-                nm2.unique.original == original) {
-                counterInc("names.unique.hit");
-                return nm2.ref(*this);
-            } else {
-                counterInc("names.hash_collision.unique");
-            }
+    auto bucketId = probeNameHash(table.namesByHash, table.namesByHashTags, hs, [&](unsigned int nameId) {
+        auto &nm2 = table.names[nameId];
+        if (nm2.kind == NameKind::UNIQUE && nm2.unique.uniqueNameKind == uniqueNameKind && nm2.unique.num == num &&
+            nm2.unique.original == original) {
+            counterInc("names.unique.hit");
+            return true;
         }
-        bucketId = (bucketId + probeCount) & mask;
-        probeCount++;
+        counterInc("names.hash_collision.unique");
+        return false;
+    });
+    if (table.namesByHash[bucketId].second != 0u) {
+        return table.names[table.namesByHash[bucketId].second].ref(*this);
     }
     return core::NameRef::noName();
 }
@@ -1075,56 +1214,41 @@ NameRef GlobalState::lookupNameUnique(UniqueNameKind uniqueNameKind, NameRef ori
 NameRef GlobalState::freshNameUnique(UniqueNameKind uniqueNameKind, NameRef original, u2 num) {
     ENFORCE(num > 0, "num == 0, name overflow");
     const auto hs = _hash_mix_unique((u2)uniqueNameKind, NameKind::UNIQUE, num, original.id());
-    unsigned int hashTableSize = namesByHash.size();
-    unsigned int mask = hashTableSize - 1;
-    auto bucketId = hs & mask;
-    unsigned int probeCount = 1;
-
-    while (namesByHash[bucketId].second != 0 && probeCount < hashTableSize) {
-        auto &bucket = namesByHash[bucketId];
-        if (bucket.first == hs) {
-            auto &nm2 = names[bucket.second];
-            if (nm2.kind == NameKind::UNIQUE && nm2.unique.uniqueNameKind == uniqueNameKind && nm2.unique.num == num &&
-                nm2.unique.original == original) {
-                counterInc("names.unique.hit");
-                return nm2.ref(*this);
-            } else {
-                counterInc("names.hash_collision.unique");
-            }
+    auto bucketId = probeNameHash(nameTable().namesByHash, nameTable().namesByHashTags, hs, [&](unsigned int nameId) {
+        auto &nm2 = nameTable().names[nameId];
+        if (nm2.kind == NameKind::UNIQUE && nm2.unique.uniqueNameKind == uniqueNameKind && nm2.unique.num == num &&
+            nm2.unique.original == original) {
+            counterInc("names.unique.hit");
+            return true;
         }
-        bucketId = (bucketId + probeCount) & mask;
-        probeCount++;
-    }
-    if (probeCount == hashTableSize) {
-        Exception::raise("Full table?");
+        counterInc("names.hash_collision.unique");
+        return false;
+    });
+    if (nameTable().namesByHash[bucketId].second != 0u) {
+        return nameTable().names[nameTable().namesByHash[bucketId].second].ref(*this);
     }
     ENFORCE(!nameTableFrozen);
 
-    if (names.size() == names.capacity()) {
+    auto &table = mutableNameTable();
+    if (table.names.size() == table.names.capacity()) {
         expandNames();
-        hashTableSize = namesByHash.size();
-        mask = hashTableSize - 1;
-
-        bucketId = hs & mask; // look for place in the new size
-        probeCount = 1;
-        while (namesByHash[bucketId].second != 0) {
-            bucketId = (bucketId + probeCount) & mask;
-            probeCount++;
-        }
+        // look for place in the new size
+        bucketId = probeNameHash(table.namesByHash, table.namesByHashTags, hs, [](unsigned int) { return false; });
     }
 
-    auto &bucket = namesByHash[bucketId];
+    auto &bucket = table.namesByHash[bucketId];
     bucket.first = hs;
-    bucket.second = names.size();
+    bucket.second = table.names.size();
+    table.namesByHashTags[bucketId] = nameSlotTag(hs);
 
-    auto idx = names.size();
-    names.emplace_back();
+    auto idx = table.names.size();
+    table.names.emplace_back();
 
-    names[idx].kind = NameKind::UNIQUE;
-    names[idx].unique.num = num;
-    names[idx].unique.uniqueNameKind = uniqueNameKind;
-    names[idx].unique.original = original;
-    ENFORCE(names[idx].hash(*this) == hs);
+    table.names[idx].kind = NameKind::UNIQUE;
+    table.names[idx].unique.num = num;
+    table.names[idx].unique.uniqueNameKind = uniqueNameKind;
+    table.names[idx].unique.original = original;
+    ENFORCE(table.names[idx].hash(*this) == hs);
     wasModified_ = true;
     categoryCounterInc("names", "unique");
     return NameRef(*this, idx);
@@ -1170,6 +1294,8 @@ FileRef GlobalState::reserveFileRef(string path) {
 }
 
 void GlobalState::mangleRenameSymbol(SymbolRef what, NameRef origName) {
+    // Mutates `what` and its owner in place.
+    ensureOwnedSymbolTable();
     auto whatData = what.data(*this);
     auto owner = whatData->owner;
     auto ownerData = owner.data(*this);
@@ -1195,7 +1321,7 @@ void GlobalState::mangleRenameSymbol(SymbolRef what, NameRef origName) {
 }
 
 unsigned int GlobalState::symbolsUsed() const {
-    return symbols.size();
+    return symbols().size();
 }
 
 unsigned int GlobalState::filesUsed() const {
@@ -1203,7 +1329,7 @@ unsigned int GlobalState::filesUsed() const {
 }
 
 unsigned int GlobalState::namesUsed() const {
-    return names.size();
+    return nameTable().names.size();
 }
 
 string GlobalState::toStringWithOptions(bool showFull, bool showRaw) const {
@@ -1211,7 +1337,7 @@ string GlobalState::toStringWithOptions(bool showFull, bool showRaw) const {
 }
 
 void GlobalState::sanityCheck() const {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return;
     }
     if (fuzz_mode) {
@@ -1220,6 +1346,9 @@ void GlobalState::sanityCheck() const {
     }
 
     Timer timeit(tracer(), "GlobalState::sanityCheck");
+    const auto &names = nameTable().names;
+    const auto &namesByHash = nameTable().namesByHash;
+    const auto &namesByHashTags = nameTable().namesByHashTags;
     ENFORCE(!names.empty(), "empty name table size");
     ENFORCE(!strings.empty(), "empty string table size");
     ENFORCE(!namesByHash.empty(), "empty name hash table size");
@@ -1237,16 +1366,21 @@ void GlobalState::sanityCheck() const {
     }
 
     i = -1;
-    for (auto &sym : symbols) {
+    for (auto &sym : symbols()) {
         i++;
         if (i != 0) {
             sym.sanityCheck(*this);
         }
     }
+    ENFORCE(namesByHashTags.size() == namesByHash.size(), "name hash tag table out of sync");
+    int bucketId = -1;
     for (auto &ent : namesByHash) {
+        bucketId++;
         if (ent.second == 0) {
+            ENFORCE(namesByHashTags[bucketId] == NAME_SLOT_EMPTY, "name hash tag table corruption");
             continue;
         }
+        ENFORCE(namesByHashTags[bucketId] == nameSlotTag(ent.first), "name hash tag table corruption");
         const Name &nm = names[ent.second];
         ENFORCE(ent.first == nm.hash(*this), "name hash table corruption");
     }
@@ -1270,24 +1404,245 @@ bool GlobalState::freezeSymbolTable() {
     return old;
 }
 
+namespace {
+// Starts at 2: every GlobalState begins with all generations at 1, so the first unfreeze of any
+// table anywhere moves to a generation no other state has seen. One shared counter serves all
+// three tables; only uniqueness matters, not contiguity.
+atomic<unsigned int> tableGenerationCounter{2};
+} // namespace
+
 bool GlobalState::unfreezeNameTable() {
+    // Unfreezing declares an intent to mutate names; break any sharing with snapshots now, on the
+    // mutating thread, rather than mid-phase.
+    ensureOwnedNameTable();
     bool old = this->nameTableFrozen;
     this->nameTableFrozen = false;
+    this->nameTableGeneration = tableGenerationCounter.fetch_add(1);
     return old;
 }
 
 bool GlobalState::unfreezeFileTable() {
     bool old = this->fileTableFrozen;
     this->fileTableFrozen = false;
+    this->fileTableGeneration = tableGenerationCounter.fetch_add(1);
     return old;
 }
 
+void GlobalState::bumpSymbolTableGeneration() {
+    this->symbolTableGeneration = tableGenerationCounter.fetch_add(1);
+}
+
+namespace {
+// Two independent probe positions in a MEMBER_FILTER_WORDS-word filter, derived from one
+// splitmix64-style finalizer over the name id so the filter carries no stored hash state.
+pair<u4, u4> memberFilterProbes(u4 nameId) {
+    u8 h = nameId;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    constexpr u4 mask = GlobalState::AncestryTable::MEMBER_FILTER_WORDS * 64 - 1;
+    return {static_cast<u4>(h) & mask, static_cast<u4>(h >> 32) & mask};
+}
+
+void setMemberFilterBit(u8 *filter, u4 bit) {
+    filter[bit >> 6] |= u8(1) << (bit & 63);
+}
+
+bool testMemberFilterBit(const u8 *filter, u4 bit) {
+    return (filter[bit >> 6] >> (bit & 63)) & 1;
+}
+} // namespace
+
+bool GlobalState::AncestryTable::mayHaveMemberTransitive(u4 selfClassId, u4 nameId) const {
+    auto probes = memberFilterProbes(nameId);
+    const u8 *filter = memberFilters.data() + static_cast<size_t>(selfClassId) * MEMBER_FILTER_WORDS;
+    return testMemberFilterBit(filter, probes.first) && testMemberFilterBit(filter, probes.second);
+}
+
+bool GlobalState::AncestryTable::derivesFrom(u4 selfClassId, u4 ancestorClassId, u4 ancestorSymbolId) const {
+    // Superclass-chain ancestry is preorder-interval containment; the strict `<` on dfsIn excludes
+    // the class itself, matching the walk in Symbol::derivesFrom.
+    if (dfsIn[ancestorClassId] < dfsIn[selfClassId] && dfsIn[selfClassId] < dfsOut[ancestorClassId]) {
+        return true;
+    }
+    auto begin = mixinAncestors.begin() + mixinsBegin[selfClassId];
+    auto end = mixinAncestors.begin() + mixinsEnd[selfClassId];
+    return std::binary_search(begin, end, ancestorSymbolId);
+}
+
+void GlobalState::computeAncestryTable() {
+    Timer timeit(tracer(), "GlobalState::computeAncestryTable");
+    auto table = make_shared<AncestryTable>();
+    table->builtAtGeneration = this->symbolTableGeneration;
+
+    const auto &symbolTable = symbols();
+    u4 numSymbols = static_cast<u4>(symbolTable.size());
+    table->denseClassIds.assign(numSymbols, AncestryTable::NO_CLASS);
+    u4 numClasses = 0;
+    for (u4 i = 1; i < numSymbols; i++) {
+        if (symbolTable[i].isClassOrModule()) {
+            table->denseClassIds[i] = numClasses++;
+        }
+    }
+
+    // The superclass forest, in dense-id space. Modules and classes without a resolved superclass
+    // are roots of their own trees.
+    vector<u4> parent(numClasses, AncestryTable::NO_CLASS);
+    vector<u4> symbolIdOfClass(numClasses);
+    vector<vector<u4>> children(numClasses);
+    vector<u4> roots;
+    for (u4 i = 1; i < numSymbols; i++) {
+        u4 classId = table->denseClassIds[i];
+        if (classId == AncestryTable::NO_CLASS) {
+            continue;
+        }
+        symbolIdOfClass[classId] = i;
+        auto superClass = symbolTable[i].superClass();
+        if (superClass.exists()) {
+            u4 superClassId = table->denseClassIds[superClass._id];
+            ENFORCE(superClassId != AncestryTable::NO_CLASS);
+            parent[classId] = superClassId;
+            children[superClassId].emplace_back(classId);
+        } else {
+            roots.emplace_back(classId);
+        }
+    }
+
+    table->dfsIn.assign(numClasses, 0);
+    table->dfsOut.assign(numClasses, 0);
+    table->mixinsBegin.assign(numClasses, 0);
+    table->mixinsEnd.assign(numClasses, 0);
+    // Allocated in full up front so slices never move while the DFS reads a parent's filter.
+    table->memberFilters.assign(static_cast<size_t>(numClasses) * AncestryTable::MEMBER_FILTER_WORDS, 0);
+    u4 counter = 0;
+    vector<u4> ownMixins;
+    // (classId, childrenPushed): each class is visited twice, assigning dfsIn and its mixin slice
+    // on the way down and dfsOut on the way back up.
+    vector<pair<u4, bool>> stack;
+    for (auto root : roots) {
+        stack.emplace_back(root, false);
+    }
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        u4 classId = top.first;
+        if (top.second) {
+            table->dfsOut[classId] = ++counter;
+            stack.pop_back();
+            continue;
+        }
+        // Pushing children below may reallocate the stack; take classId by value and do not touch
+        // `top` again after the first push.
+        top.second = true;
+        table->dfsIn[classId] = ++counter;
+
+        // This class's mixin slice is the parent's slice merged with its own (already flattened)
+        // mixins, so a lookup never has to walk the chain.
+        ownMixins.clear();
+        for (auto mixin : symbolTable[symbolIdOfClass[classId]].mixins()) {
+            ownMixins.emplace_back(mixin._id);
+        }
+        fast_sort(ownMixins);
+        ownMixins.erase(std::unique(ownMixins.begin(), ownMixins.end()), ownMixins.end());
+        auto &pool = table->mixinAncestors;
+        table->mixinsBegin[classId] = static_cast<u4>(pool.size());
+        if (parent[classId] != AncestryTable::NO_CLASS) {
+            u4 parentBegin = table->mixinsBegin[parent[classId]];
+            u4 parentEnd = table->mixinsEnd[parent[classId]];
+            // Reserve up front so set_union's back_inserter cannot reallocate the pool out from
+            // under the parent-slice iterators.
+            pool.reserve(pool.size() + (parentEnd - parentBegin) + ownMixins.size());
+            std::set_union(pool.begin() + parentBegin, pool.begin() + parentEnd, ownMixins.begin(), ownMixins.end(),
+                           std::back_inserter(pool));
+        } else {
+            pool.insert(pool.end(), ownMixins.begin(), ownMixins.end());
+        }
+        table->mixinsEnd[classId] = static_cast<u4>(pool.size());
+
+        // The member filter is the parent's filter plus this class's own member names and those of
+        // its flattened mixins; the preorder walk guarantees the parent's is complete by now.
+        u8 *filter = table->memberFilters.data() + static_cast<size_t>(classId) * AncestryTable::MEMBER_FILTER_WORDS;
+        if (parent[classId] != AncestryTable::NO_CLASS) {
+            const u8 *parentFilter = table->memberFilters.data() +
+                                     static_cast<size_t>(parent[classId]) * AncestryTable::MEMBER_FILTER_WORDS;
+            std::copy(parentFilter, parentFilter + AncestryTable::MEMBER_FILTER_WORDS, filter);
+        }
+        auto insertMemberNames = [&filter](const Symbol &sym) {
+            for (const auto &member : sym.members()) {
+                auto probes = memberFilterProbes(static_cast<u4>(member.first.id()));
+                setMemberFilterBit(filter, probes.first);
+                setMemberFilterBit(filter, probes.second);
+            }
+        };
+        insertMemberNames(symbolTable[symbolIdOfClass[classId]]);
+        for (auto mixin : symbolTable[symbolIdOfClass[classId]].mixins()) {
+            insertMemberNames(symbolTable[mixin._id]);
+        }
+
+        for (auto child : children[classId]) {
+            stack.emplace_back(child, false);
+        }
+    }
+
+    // A superclass cycle (malformed input) leaves its classes unreached; drop them from the table
+    // so lookups take the fallback walk instead of trusting empty intervals.
+    for (u4 classId = 0; classId < numClasses; classId++) {
+        if (table->dfsIn[classId] == 0) {
+            table->denseClassIds[symbolIdOfClass[classId]] = AncestryTable::NO_CLASS;
+        }
+    }
+
+    histogramInc("ancestry_table.classes", numClasses);
+    this->ancestryTable_ = move(table);
+}
+
 bool GlobalState::unfreezeSymbolTable() {
+    // Unfreezing declares an intent to mutate symbols; break any sharing with snapshots now, on the
+    // mutating thread, rather than mid-phase.
+    ensureOwnedSymbolTable();
     bool old = this->symbolTableFrozen;
     this->symbolTableFrozen = false;
+    bumpSymbolTableGeneration();
     return old;
 }
 
+void GlobalState::ensureOwnedSymbolTable() {
+    if (symbols_.use_count() == 1) {
+        return;
+    }
+    Timer timeit(tracer(), "GlobalState::ensureOwnedSymbolTable");
+    auto owned = make_shared<vector<Symbol>>();
+    owned->reserve(symbols_->capacity());
+    for (auto &sym : *symbols_) {
+        // Symbol's copy constructor is deleted; deepCopy with keepGsId copies members verbatim.
+        owned->emplace_back(sym.deepCopy(*this, true));
+    }
+    symbols_ = move(owned);
+    // The Loc slices copied above index into the pool, so it changes ownership together with the
+    // table.
+    symbolLocs_ = make_shared<vector<Loc>>(*symbolLocs_);
+    counterInc("symbol_table.copy_on_write");
+}
+
+void GlobalState::ensureOwnedNameTable() {
+    if (nameTable_.use_count() == 1) {
+        return;
+    }
+    Timer timeit(tracer(), "GlobalState::ensureOwnedNameTable");
+    auto owned = make_shared<NameTable>();
+    owned->names.reserve(nameTable_->names.capacity());
+    for (auto &nm : nameTable_->names) {
+        // Name's copy constructor is deleted; deepCopy against the same GlobalState copies members
+        // verbatim.
+        owned->names.emplace_back(nm.deepCopy(*this));
+    }
+    // Reserve before assigning so the hash table keeps capacity == size, which sanityCheck asserts.
+    owned->namesByHash.reserve(nameTable_->namesByHash.size());
+    owned->namesByHash = nameTable_->namesByHash;
+    owned->namesByHashTags = nameTable_->namesByHashTags;
+    nameTable_ = move(owned);
+    counterInc("name_table.copy_on_write");
+}
+
 unique_ptr<GlobalState> GlobalState::deepCopy(bool keepId) const {
     Timer timeit(tracer(), "GlobalState::deepCopy", this->creation);
     this->sanityCheck();
@@ -1297,19 +1652,32 @@ unique_ptr<GlobalState> GlobalState::deepCopy(bool keepId) const {
     result->silenceErrors = this->silenceErrors;
     result->autocorrect = this->autocorrect;
     result->suggestRuntimeProfiledType = this->suggestRuntimeProfiledType;
+    result->sigSuggestionBudgetMs = this->sigSuggestionBudgetMs;
     result->ensureCleanStrings = this->ensureCleanStrings;
     result->runningUnderAutogen = this->runningUnderAutogen;
     result->censorForSnapshotTests = this->censorForSnapshotTests;
     result->sleepInSlowPath = this->sleepInSlowPath;
+    result->lubUnionWidenThreshold = this->lubUnionWidenThreshold;
 
     if (keepId) {
         result->globalStateId = this->globalStateId;
     }
+    result->symbolTableGeneration = this->symbolTableGeneration;
+    result->nameTableGeneration = this->nameTableGeneration;
+    result->fileTableGeneration = this->fileTableGeneration;
     result->deepCloneHistory = this->deepCloneHistory;
-    result->deepCloneHistory.emplace_back(DeepCloneHistoryEntry{this->globalStateId, namesUsed()});
+    // A clone of a GlobalState that entered no names since its own creation adds no interval: any
+    // ref it could have created for an existing name already resolves to an older entry. This is
+    // what keeps the lineage short — fast-path clones during an LSP session rarely enter names.
+    if (deepCloneHistory.empty() || namesUsed() > deepCloneHistory.back().lastNameKnownByParentGlobalState) {
+        result->deepCloneHistory.emplace_back(DeepCloneHistoryEntry{this->globalStateId, namesUsed()});
+    }
 
     result->strings = this->strings;
-    result->stringsLastPageUsed = STRINGS_PAGE_SIZE;
+    result->retainedPayloads = this->retainedPayloads;
+    // Seal the shared last page so the copy's first enterString starts a fresh page instead of
+    // writing into storage the parent is still appending to.
+    result->stringsLastPageUsed = result->strings.empty() ? 0 : result->strings.back()->size();
     result->files = this->files;
     result->fileRefByPath = this->fileRefByPath;
     result->lspQuery = this->lspQuery;
@@ -1319,23 +1687,34 @@ unique_ptr<GlobalState> GlobalState::deepCopy(bool keepId) const {
     result->onlyErrorClasses = this->onlyErrorClasses;
     result->dslPlugins = this->dslPlugins;
     result->dslRubyExtraArgs = this->dslRubyExtraArgs;
-    result->names.reserve(this->names.capacity());
+    result->dslPluginsPersistent = this->dslPluginsPersistent;
     if (keepId) {
-        result->names.resize(this->names.size());
-        ::memcpy(result->names.data(), this->names.data(), this->names.size() * sizeof(Name));
+        // NameRef ids carry over, the string pages the Names point into are shared and sealed
+        // above, and Names hold no owning pointers, so the whole table (names, hash index, control
+        // bytes) can be shared in O(1); ensureOwnedNameTable() breaks the sharing before either
+        // side's first mutation.
+        result->nameTable_ = this->nameTable_;
     } else {
-        for (auto &nm : this->names) {
-            result->names.emplace_back(nm.deepCopy(*result));
+        auto &table = *result->nameTable_;
+        table.names.reserve(this->nameTable().names.capacity());
+        for (auto &nm : this->nameTable().names) {
+            table.names.emplace_back(nm.deepCopy(*result));
         }
-    }
-
-    result->namesByHash.reserve(this->namesByHash.size());
-    result->namesByHash = this->namesByHash;
-
-    result->symbols.reserve(this->symbols.size());
-    for (auto &sym : this->symbols) {
-        result->symbols.emplace_back(sym.deepCopy(*result, keepId));
-    }
+        table.namesByHash.reserve(this->nameTable().namesByHash.size());
+        table.namesByHash = this->nameTable().namesByHash;
+        table.namesByHashTags = this->nameTable().namesByHashTags;
+    }
+
+    // Share the symbol table instead of duplicating it: the copy is O(1), and the Symbols (the
+    // dominant cost of a deepCopy, since each owns its members and argument lists) stay physically
+    // shared until one side calls ensureOwnedSymbolTable(). NameRefs inside shared Symbols keep the
+    // identity of the GlobalState that entered them, which deepCloneHistory accounts for, just as
+    // with the keepId name copy above.
+    result->symbols_ = this->symbols_;
+    result->symbolLocs_ = this->symbolLocs_;
+    // The ancestry table is immutable and keyed to symbolTableGeneration (copied above), so the
+    // snapshot can keep answering derivesFrom from it until either side unfreezes.
+    result->ancestryTable_ = this->ancestryTable_;
     result->pathPrefix = this->pathPrefix;
     for (auto &semanticExtension : this->semanticExtensions) {
         result->semanticExtensions.emplace_back(semanticExtension->deepCopy(*this, *result));
@@ -1360,15 +1739,19 @@ int GlobalState::totalErrors() const {
     return errorQueue->nonSilencedErrorCount.load();
 }
 
+void GlobalState::_recordErrorLevel(Loc loc, ErrorClass what) const {
+    if (loc.file().exists() && what != errors::Infer::SuggestTyped &&
+        what != core::errors::Resolver::SigInFileWithoutSigil) {
+        auto &file = loc.file().data(*this);
+        file.minErrorLevel_ = min(file.minErrorLevel_, what.minLevel);
+    }
+}
+
 void GlobalState::_error(unique_ptr<Error> error) const {
     if (error->isCritical()) {
         errorQueue->hadCritical = true;
     }
-    auto loc = error->loc;
-    if (loc.file().exists() && error->what != errors::Infer::SuggestTyped &&
-        error->what != core::errors::Resolver::SigInFileWithoutSigil) {
-        loc.file().data(*this).minErrorLevel_ = min(loc.file().data(*this).minErrorLevel_, error->what.minLevel);
-    }
+    _recordErrorLevel(error->loc, error->what);
 
     errorQueue->pushError(*this, move(error));
 }
@@ -1423,16 +1806,19 @@ bool GlobalState::shouldReportErrorOn(Loc loc, ErrorClass what) const {
     if (this->silenceErrors) {
         return false;
     }
-    StrictLevel level = StrictLevel::Strong;
-    if (loc.file().exists()) {
-        level = loc.file().data(*this).strictLevel;
-    }
-    if (suppressedErrorClasses.count(what.code) != 0) {
+    // The class filters are almost always empty, so test that before paying for a hash lookup,
+    // and check them ahead of the file-table access: this runs for every error a typed: false
+    // file would have reported, so the suppressed path should touch as little as possible.
+    if (!suppressedErrorClasses.empty() && suppressedErrorClasses.count(what.code) != 0) {
         return false;
     }
     if (!onlyErrorClasses.empty() && onlyErrorClasses.count(what.code) == 0) {
         return false;
     }
+    StrictLevel level = StrictLevel::Strong;
+    if (loc.file().exists()) {
+        level = loc.file().data(*this).strictLevel;
+    }
 
     if (level >= StrictLevel::Max) {
         // Custom rules
@@ -1565,6 +1951,16 @@ FileRef GlobalState::findFileByPath(string_view path) const {
     return FileRef();
 }
 
+void GlobalState::evictSourceText(FileRef fref) {
+    ENFORCE(fref.id() < filesUsed());
+    auto &file = files[fref.id()];
+    if (!file || file->sourceType != File::Type::Normal) {
+        return;
+    }
+    counterAdd("files.evicted_source_bytes", file->source().size());
+    files[fref.id()] = file->evictSource();
+}
+
 unique_ptr<GlobalState> GlobalState::markFileAsTombStone(unique_ptr<GlobalState> what, FileRef fref) {
     ENFORCE(fref.id() < what->filesUsed());
     what->files[fref.id()]->sourceType = File::Type::TombStone;
@@ -1584,15 +1980,19 @@ unique_ptr<GlobalStateHash> GlobalState::hash() const {
     constexpr bool DEBUG_HASHING_TAIL = false;
     u4 hierarchyHash = 0;
     UnorderedMap<NameHash, u4> methodHashes;
+    UnorderedMap<NameHash, u4> constantHashes;
     int counter = 0;
-    for (const auto &sym : this->symbols) {
+    for (const auto &sym : this->symbols()) {
         if (!sym.ignoreInHashing(*this)) {
             if (sym.isMethod()) {
                 auto &target = methodHashes[NameHash(*this, sym.name.data(*this))];
                 target = mix(target, sym.hash(*this));
                 hierarchyHash = mix(hierarchyHash, sym.methodShapeHash(*this));
             } else {
-                hierarchyHash = mix(hierarchyHash, sym.hash(*this));
+                auto symHash = sym.hash(*this);
+                hierarchyHash = mix(hierarchyHash, symHash);
+                auto &target = constantHashes[NameHash(*this, sym.name.data(*this))];
+                target = mix(target, symHash);
             }
         }
         counter++;
@@ -1604,6 +2004,9 @@ unique_ptr<GlobalStateHash> GlobalState::hash() const {
     for (const auto &e : methodHashes) {
         result->methodHashes[e.first] = patchHash(e.second);
     }
+    for (const auto &e : constantHashes) {
+        result->constantHashes[e.first] = patchHash(e.second);
+    }
     result->hierarchyHash = patchHash(hierarchyHash);
     return result;
 }
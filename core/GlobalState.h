@@ -43,6 +43,8 @@ class GlobalState final {
     friend class UnfreezeSymbolTable;
     friend class UnfreezeFileTable;
     friend struct NameRefDebugCheck;
+    friend struct NameDataDebugCheck;
+    friend struct SymbolDataDebugCheck;
 
 public:
     GlobalState(std::shared_ptr<ErrorQueue> errorQueue,
@@ -58,6 +60,16 @@ public:
     // operation to avoid table resizes.
     void reserveMemory(u4 kb);
 
+    // Expand the symbol and name tables to hold at least the given entry counts. Used prior to
+    // operation when the previous run's final counts are known, so that namer does not rehash.
+    void preallocateTables(u4 symbolCount, u4 nameCount);
+
+    // Ask the kernel to back the symbol and name tables with 2MiB pages, so that namer's and
+    // resolver's random accesses into them walk fewer TLB entries. Optionally prefaults the tables
+    // so those phases do not take page faults either. Advisory and Linux-only; a no-op elsewhere.
+    // Call after the tables reach their final capacity (growth reallocates into unadvised memory).
+    void adviseLargePages(bool prefault) const;
+
     GlobalState(const GlobalState &) = delete;
     GlobalState(GlobalState &&) = delete;
 
@@ -113,6 +125,12 @@ public:
     static std::unique_ptr<GlobalState> replaceFile(std::unique_ptr<GlobalState> inWhat, FileRef whatFile,
                                                     const std::shared_ptr<File> &withWhat);
     static std::unique_ptr<GlobalState> markFileAsTombStone(std::unique_ptr<GlobalState>, FileRef fref);
+    // Releases `fref`'s source text to trim resident memory: the entry reverts to NotYetRead and is
+    // re-read through the driver's FileSystem (verified against the hash recorded at eviction) the
+    // next time a pass needs its contents. Since the file table shares entries across GlobalState
+    // copies, other copies still referencing the old entry keep its text alive until the last of
+    // them drops it. Callers must guarantee a reload happens before anything touches the source.
+    void evictSourceText(FileRef fref);
     FileRef findFileByPath(std::string_view path) const;
 
     void mangleRenameSymbol(SymbolRef what, NameRef origName);
@@ -152,14 +170,90 @@ public:
 
     ErrorBuilder beginError(Loc loc, ErrorClass what) const;
     void _error(std::unique_ptr<Error> error) const;
+    // Records the side effects of an error on its file (the minimum error level) without building
+    // an Error. ErrorBuilder uses this for suppressed errors, which nothing else observes.
+    void _recordErrorLevel(Loc loc, ErrorClass what) const;
 
     int totalErrors() const;
     bool wasModified() const;
 
     int globalStateId;
+    // Process-globally unique epoch of this state's symbol table; bumped whenever the symbol table
+    // is unfrozen for mutation. Caches whose answers depend on the symbol table (e.g. the subtyping
+    // memo in core/types/subtyping.cc) use it for invalidation.
+    unsigned int symbolTableGeneration = 1;
+    // Epochs for the other two tables, with the same contract: unfreezing one for mutation bumps
+    // its generation to a process-globally unique value. Together with symbolTableGeneration these
+    // are the invalidation scheme for every derived cache: record the generation(s) of the
+    // table(s) the cache reads at build time, compare before use, rebuild lazily on mismatch (see
+    // AncestryTable below, the subtyping memo, and the indexes in main/lsp). All three draw from
+    // one shared counter; only uniqueness matters, not contiguity.
+    unsigned int nameTableGeneration = 1;
+    unsigned int fileTableGeneration = 1;
+    void bumpSymbolTableGeneration();
+
+    // Precomputed ancestry of every class and module, built by computeAncestryTable() once the
+    // resolver has linearized the whole hierarchy. Symbol::derivesFrom answers from it with an
+    // interval test plus a binary search instead of walking mixin lists and superclass chains,
+    // and Symbol::findMemberTransitive consults its per-class member-name filters to fail
+    // definite misses without walking at all.
+    // Validity is keyed to symbolTableGeneration: any unfreeze invalidates the table, and
+    // derivesFrom falls back to the walk until the next resolver finalize rebuilds it.
+    struct AncestryTable {
+        static constexpr u4 NO_CLASS = 0xffffffffu;
+        // Width of each class's member-name bloom filter, in 64-bit words. Must be a power of two
+        // so probe positions reduce with a mask. 2048 bits keeps the false-positive rate around
+        // 10% for a class inheriting the usual few hundred stdlib members at 256 bytes per class.
+        static constexpr u4 MEMBER_FILTER_WORDS = 32;
+        unsigned int builtAtGeneration = 0;
+        // Symbol id -> dense class id; NO_CLASS for non-class symbols. Symbols entered after the
+        // build fall past the end of the vector and take the fallback walk.
+        std::vector<u4> denseClassIds;
+        // Dense id -> preorder interval of the class in a DFS over the superclass forest: B sits
+        // on A's superclass chain iff dfsIn[B] < dfsIn[A] < dfsOut[B].
+        std::vector<u4> dfsIn;
+        std::vector<u4> dfsOut;
+        // Dense id -> slice [mixinsBegin, mixinsEnd) of mixinAncestors: the sorted symbol ids of
+        // every mixin of the class or of any class on its superclass chain.
+        std::vector<u4> mixinsBegin;
+        std::vector<u4> mixinsEnd;
+        std::vector<u4> mixinAncestors;
+        // MEMBER_FILTER_WORDS-word slices, indexed by dense id: a bloom filter over the name ids
+        // of every member transitively available on the class (its own, its flattened mixins',
+        // and its whole superclass chain's). A clear filter bit proves absence, so negative
+        // findMemberTransitive lookups — the typo and missing-method probes that otherwise walk
+        // the full ancestor chain per error site — short-circuit in two bit tests. A set bit
+        // proves nothing; lookups fall back to the walk.
+        std::vector<u8> memberFilters;
+
+        // Dense id for sym, or NO_CLASS when this table cannot answer for it.
+        u4 denseClassId(SymbolRef sym) const {
+            if (sym._id >= denseClassIds.size()) {
+                return NO_CLASS;
+            }
+            return denseClassIds[sym._id];
+        }
+        bool derivesFrom(u4 selfClassId, u4 ancestorClassId, u4 ancestorSymbolId) const;
+        // False only when no class or module reachable from selfClassId has a member named nameId.
+        bool mayHaveMemberTransitive(u4 selfClassId, u4 nameId) const;
+    };
+    // The current table when it still matches the live symbol table, nullptr otherwise.
+    const AncestryTable *ancestryTableIfValid() const {
+        auto *table = ancestryTable_.get();
+        return table != nullptr && table->builtAtGeneration == symbolTableGeneration ? table : nullptr;
+    }
+    // Rebuilds the ancestry table from the current, fully linearized symbol table.
+    void computeAncestryTable();
     bool silenceErrors = false;
     bool autocorrect = false;
     bool suggestRuntimeProfiledType = false;
+    // Per-file wall-clock budget for computing suggested sigs (--sig-suggestion-budget-ms); 0 means
+    // unlimited. The LSP zeroes it temporarily when it reruns budget-deferred files while idle.
+    int sigSuggestionBudgetMs = 0;
+    // When set (--prune-dead-cfg-branches), the CFG builder statically resolves conditional jumps
+    // on literal conditions and drops the untaken region before inference sees it. Unreachable-code
+    // diagnostics inside pruned regions are suppressed, so it is opt-in.
+    bool pruneDeadCfgBranches = false;
 
     // We have a lot of internal names of form `<something>` that's chosen with `<` and `>` as you can't make
     // this into a valid ruby identifier without suffering.
@@ -177,7 +271,20 @@ public:
 
     bool sleepInSlowPath = false;
 
+    // When nonzero, unions that grow beyond this many arms are collapsed to a coarser upper bound
+    // during lub (see Types::any), trading precision for bounded inference time. Zero disables it.
+    u4 lubUnionWidenThreshold = 0;
+
     std::unique_ptr<GlobalState> deepCopy(bool keepId = false) const;
+    // If the symbol table is shared with another GlobalState (see deepCopy), replaces it with a copy
+    // owned by this state alone. Must run before any Symbol is mutated in place; the mutation
+    // funnels (enterSymbol, synthesizeClass, mangleRenameSymbol, unfreezeSymbolTable) already call
+    // it, so phases that funnel through them need no extra calls.
+    void ensureOwnedSymbolTable();
+    // Same contract for the name table (see NameTable below): replaces a table shared with another
+    // GlobalState by an owned copy. The mutation funnels (the enterName* insertions and
+    // unfreezeNameTable) already call it via mutableNameTable().
+    void ensureOwnedNameTable();
     mutable std::shared_ptr<ErrorQueue> errorQueue;
 
     // Contains a path prefix that should be stripped from all printed paths.
@@ -189,6 +296,15 @@ public:
     // See ErrorQueue#queryResponse
     lsp::Query lspQuery;
 
+    // In LSP mode: installed together on the GlobalState being typechecked for the duration of a
+    // cancelable slow path, and unset everywhere else. `lspPreemptionWaiting` returns true while
+    // interactive work is queued to run against the previously committed GlobalState; typechecking
+    // workers poll it at the same file boundaries as wasTypecheckingCanceled() so they can park
+    // until the work has run. `lspRunPreemptionTasks` runs the queued work, and may only be invoked
+    // from the thread driving the typecheck (see pipeline::typecheck).
+    std::function<bool()> lspPreemptionWaiting;
+    std::function<void()> lspRunPreemptionTasks;
+
     FlowId creation; // used to track flow of global states
 
     // Indicates the number of times LSP has run the type checker with this global state.
@@ -222,6 +338,9 @@ public:
     void onlyShowErrorClass(int code);
 
     std::vector<std::string> dslRubyExtraArgs;
+    // When true, DSL plugin commands are long-lived worker processes speaking the persistent
+    // protocol (see plugin/PluginWorkerPool.h) instead of one subprocess per invocation.
+    bool dslPluginsPersistent = false;
     void addDslPlugin(std::string_view method, std::string_view command);
     std::optional<std::string_view> findDslPlugin(NameRef method) const;
     bool hasAnyDslPlugin() const;
@@ -234,16 +353,70 @@ private:
         int globalStateId;
         unsigned int lastNameKnownByParentGlobalState;
     };
-    std::vector<DeepCloneHistoryEntry> deepCloneHistory;
-
-    static constexpr int STRINGS_PAGE_SIZE = 4096;
+    // Clone lineage as name-count intervals: entry i says that names with ids below
+    // `lastNameKnownByParentGlobalState` (and at or above entry i-1's bound) were entered by the
+    // ancestor `globalStateId` at depth i. Bounds are strictly increasing because deepCopy reuses
+    // the previous entry for a clone that entered no names of its own (the common case for LSP
+    // fast-path clones), so the lineage stays a few entries long over a whole session and sits in
+    // the inline storage. NameRefDebugCheck resolves a ref's owning interval by binary search at
+    // creation and revalidates it with a single indexed compare; see Names.cc.
+    InlinedVector<DeepCloneHistoryEntry, 2> deepCloneHistory;
+
+    // UTF8 name bytes live in an append-only arena of pages that double in size from
+    // STRINGS_PAGE_SIZE up to STRINGS_PAGE_MAX_SIZE, so a large name table occupies a handful of
+    // big contiguous blocks rather than thousands of 4KiB pages. Names hold string_views into the
+    // pages; pages are never freed or resized, so the views stay valid for the GlobalState's
+    // lifetime (and across deepCopy, which shares the pages and seals the last one).
+    static constexpr size_t STRINGS_PAGE_SIZE = 4096;
+    static constexpr size_t STRINGS_PAGE_MAX_SIZE = 4194304;
     std::vector<std::shared_ptr<std::vector<char>>> strings;
+    // Decompressed payload buffers kept alive because UTF8 name contents point directly into them
+    // instead of being copied through enterString (see SerializerImpl::unpickleGS).
+    std::vector<std::shared_ptr<const std::vector<u1>>> retainedPayloads;
     std::string_view enterString(std::string_view nm);
-    u2 stringsLastPageUsed = STRINGS_PAGE_SIZE + 1;
-    std::vector<Name> names;
+    size_t stringsLastPageUsed = 0;
     UnorderedMap<std::string, FileRef> fileRefByPath;
-    std::vector<Symbol> symbols;
-    std::vector<std::pair<unsigned int, unsigned int>> namesByHash;
+    // The symbol table. Held behind a shared_ptr so that deepCopy can hand its copy a reference in
+    // O(1) instead of duplicating every Symbol: LSP snapshots a GlobalState per slow path, and the
+    // tables stay physically shared until one side mutates. ensureOwnedSymbolTable() breaks the
+    // sharing; reads go through symbols().
+    std::shared_ptr<std::vector<Symbol>> symbols_ = std::make_shared<std::vector<Symbol>>();
+    // Backing storage for every Symbol's Locs: symbols hold (offset, count) slices of this pool
+    // instead of per-symbol vectors (see the locsBegin_ comment in Symbols.h). Shared with
+    // deepCopy snapshots and cloned by ensureOwnedSymbolTable(), in lockstep with symbols_ — a
+    // slice index is only meaningful against the pool it was entered into.
+    std::shared_ptr<std::vector<Loc>> symbolLocs_ = std::make_shared<std::vector<Loc>>();
+    // See AncestryTable above. Shared so deepCopy hands snapshots the table in O(1), like symbols_;
+    // the table is immutable once built, so sharing needs no copy-on-write.
+    std::shared_ptr<const AncestryTable> ancestryTable_;
+    const std::vector<Symbol> &symbols() const {
+        return *symbols_;
+    }
+    std::vector<Symbol> &mutableSymbols() {
+        ensureOwnedSymbolTable();
+        return *symbols_;
+    }
+    // The name table together with its hash index. Bundled so that deepCopy can share all three
+    // vectors behind one shared_ptr in O(1), the same arrangement as symbols_: Names hold no owning
+    // pointers (their bytes live in the shared string pages above), so a snapshot can read the
+    // parent's table in place. ensureOwnedNameTable() breaks the sharing before the first mutation;
+    // reads go through nameTable().
+    struct NameTable {
+        std::vector<Name> names;
+        std::vector<std::pair<unsigned int, unsigned int>> namesByHash;
+        // One control byte per namesByHash slot: 0x80 for an empty slot, otherwise the top seven
+        // bits of the slot's hash. Lookups scan these a group at a time (SIMD where available) and
+        // touch the eight-byte slots only on a tag match; see the probing helpers in GlobalState.cc.
+        std::vector<u1> namesByHashTags;
+    };
+    std::shared_ptr<NameTable> nameTable_ = std::make_shared<NameTable>();
+    const NameTable &nameTable() const {
+        return *nameTable_;
+    }
+    NameTable &mutableNameTable() {
+        ensureOwnedNameTable();
+        return *nameTable_;
+    }
     std::vector<std::shared_ptr<File>> files;
     UnorderedSet<int> suppressedErrorClasses;
     UnorderedSet<int> onlyErrorClasses;
@@ -276,6 +449,9 @@ private:
     bool fileTableFrozen = true;
 
     void expandNames(int growBy = 2);
+    // Recomputes namesByHashTags from namesByHash; used by the serializer after it has installed a
+    // raw slot array.
+    void rebuildNamesByHashTags();
 
     SymbolRef synthesizeClass(NameRef nameID, u4 superclass = Symbols::todo()._id, bool isModule = false);
     SymbolRef enterSymbol(Loc loc, SymbolRef owner, NameRef name, u4 flags);
@@ -23,20 +23,60 @@ Loc Loc::join(Loc other) const {
     return Loc(this->file(), min(this->beginPos(), other.beginPos()), max(this->endPos(), other.endPos()));
 }
 
+namespace {
+
+// Diagnostics are rendered in bursts that walk a file in roughly ascending position order, so the
+// line found by one conversion is almost always the line (or a close successor) of the next one.
+// Each thread remembers where its previous conversion landed and resumes the search there,
+// falling back to the binary search for backward jumps and far forward jumps. The hint is just an
+// index: it is re-validated against the current line table before use, so a stale one (the
+// previous file was freed and another now lives at the same address) can only cost the fallback
+// search, never produce a wrong answer.
+constexpr int OFFSET2POS_FORWARD_SCAN_LIMIT = 64;
+thread_local const int *cachedLineBreaksData = nullptr;
+thread_local size_t cachedLowerBound = 0;
+
+} // namespace
+
 Loc::Detail Loc::offset2Pos(const File &file, u4 off) {
     Loc::Detail pos;
 
     ENFORCE(off <= file.source().size(), "file offset out of bounds in file: {} @ {} <= {}", string(file.path()),
             to_string(off), to_string(file.source().size()));
-    auto it = absl::c_lower_bound(file.lineBreaks(), off);
-    if (it == file.lineBreaks().begin()) {
+    auto &lineBreaks = file.lineBreaks();
+    auto target = static_cast<int64_t>(off);
+    auto numBreaks = lineBreaks.size();
+
+    // Index of the first line break >= off, mirroring the lower_bound below.
+    size_t idx = 0;
+    bool resolved = false;
+    if (cachedLineBreaksData == lineBreaks.data() && cachedLowerBound < numBreaks) {
+        idx = cachedLowerBound;
+        if (idx == 0 || lineBreaks[idx - 1] < target) {
+            resolved = true;
+            int steps = 0;
+            while (idx < numBreaks && lineBreaks[idx] < target) {
+                idx++;
+                if (++steps > OFFSET2POS_FORWARD_SCAN_LIMIT) {
+                    resolved = false;
+                    break;
+                }
+            }
+        }
+    }
+    if (!resolved) {
+        idx = absl::c_lower_bound(lineBreaks, off) - lineBreaks.begin();
+    }
+    cachedLineBreaksData = lineBreaks.data();
+    cachedLowerBound = idx;
+
+    if (idx == 0) {
         pos.line = 1;
         pos.column = off + 1;
         return pos;
     }
-    --it;
-    pos.line = (it - file.lineBreaks().begin()) + 1;
-    pos.column = off - *it;
+    pos.line = idx;
+    pos.column = off - lineBreaks[idx - 1];
     return pos;
 }
 
@@ -13,7 +13,7 @@ NameHash::NameHash(const GlobalState &gs, const NameData &nm) : _hashValue(incZe
 NameHash::NameHash(const GlobalState &gs, const Name &nm) : _hashValue(incZero(_hash(nm.shortName(gs)))){};
 
 void NameHash::sortAndDedupe(std::vector<core::NameHash> &hashes) {
-    fast_sort(hashes);
+    fast_sort_u4_keys(hashes, [](const NameHash &h) { return h._hashValue; });
     hashes.resize(std::distance(hashes.begin(), std::unique(hashes.begin(), hashes.end())));
 }
 
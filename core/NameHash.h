@@ -45,6 +45,11 @@ struct GlobalStateHash {
     static constexpr int HASH_STATE_INVALID_COLLISION_AVOID = 3;
     u4 hierarchyHash = HASH_STATE_NOT_COMPUTED;
     UnorderedMap<NameHash, u4> methodHashes;
+    // Content hashes of the non-method symbols (classes, static fields, type members) defined,
+    // keyed by name. LSP's scoped slow path diffs these across an edit to find the definitions
+    // that actually changed, then matches those names against other files' recorded usages to
+    // find the dependents of the edit.
+    UnorderedMap<NameHash, u4> constantHashes;
 };
 
 struct UsageHash {
@@ -53,6 +58,12 @@ struct UsageHash {
 };
 
 struct FileHash {
+    // Cheap structural digest of the file's outline: everything except method-body code that
+    // cannot introduce a definition. Two versions of a file with equal outline hashes have equal
+    // `definitions` by construction, so computing `definitions` — which costs a resolver run and a
+    // full symbol-table walk — can be skipped for the common body-only edit; see
+    // pipeline::computeFileHash. Zero means "not computed".
+    u4 outlineHash = 0;
     GlobalStateHash definitions;
     UsageHash usages;
 };
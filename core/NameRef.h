@@ -9,7 +9,12 @@ class Name;
 
 struct NameDataDebugCheck {
     const GlobalState &gs;
-    const unsigned int nameCountAtCreation;
+    // See SymbolDataDebugCheck: a frozen name table cannot invalidate the reference, so check()
+    // skips the recount for NameDatas created while the table is frozen and instead verifies that
+    // no unfreeze happened in between.
+    const bool nameTableFrozenAtCreation;
+    // nameTableGeneration at creation when frozen, name count at creation when not.
+    const unsigned int nameTableStateAtCreation;
 
     NameDataDebugCheck(const GlobalState &gs);
     void check() const;
@@ -30,8 +35,12 @@ CheckSize(NameData, sizeof__Name, alignof__Name);
 
 struct NameRefDebugCheck {
     int globalStateId;
+    // Index of the owning GlobalState's interval in a descendant's deepCloneHistory. An ancestor
+    // occupies the same index in every descendant's lineage, so check() is one indexed compare
+    // instead of a history walk.
+    unsigned int depth;
 
-    constexpr NameRefDebugCheck() : globalStateId(-1) {}
+    constexpr NameRefDebugCheck() : globalStateId(-1), depth(0) {}
 
     NameRefDebugCheck(const GlobalState &gs, int id);
 
@@ -147,7 +147,7 @@ string_view Name::shortName(const GlobalState &gs) const {
 }
 
 void Name::sanityCheck(const GlobalState &gs) const {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return;
     }
     NameRef current = this->ref(gs);
@@ -173,7 +173,7 @@ void Name::sanityCheck(const GlobalState &gs) const {
 }
 
 NameRef Name::ref(const GlobalState &gs) const {
-    auto distance = this - gs.names.data();
+    auto distance = this - gs.nameTable().names.data();
     return NameRef(gs, distance);
 }
 
@@ -197,15 +197,29 @@ bool Name::isClassName(const GlobalState &gs) const {
 }
 
 NameRefDebugCheck::NameRefDebugCheck(const GlobalState &gs, int _id) {
-    // store the globalStateId of the creating global state to allow sharing refs between siblings
-    // when the ref refers to a name in the common ancestor
-    globalStateId = gs.globalStateId;
-    for (const auto &deepCloneInfo : gs.deepCloneHistory) {
-        if (_id < deepCloneInfo.lastNameKnownByParentGlobalState) {
-            globalStateId = deepCloneInfo.globalStateId;
-            break;
+    // Attribute the ref to the earliest global state in the clone lineage that already knew the
+    // name, to allow sharing refs between siblings when the ref refers to a name in the common
+    // ancestor. The lineage's name-count bounds are strictly increasing, so the owning interval is
+    // found by binary search; its index doubles as the ref's depth, because an ancestor occupies
+    // the same index in every descendant's lineage.
+    const auto &history = gs.deepCloneHistory;
+    size_t lo = 0;
+    size_t hi = history.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (_id < history[mid].lastNameKnownByParentGlobalState) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
         }
     }
+    if (lo < history.size()) {
+        globalStateId = history[lo].globalStateId;
+        depth = lo;
+    } else {
+        globalStateId = gs.globalStateId;
+        depth = history.size();
+    }
 }
 
 void NameRefDebugCheck::check(const GlobalState &gs, int _id) const {
@@ -218,7 +232,12 @@ void NameRefDebugCheck::check(const GlobalState &gs, int _id) const {
     if (globalStateId == gs.globalStateId) {
         return;
     }
-    for (const auto &deepCloneInfo : gs.deepCloneHistory) {
+    // The owner either sits at the recorded depth of `gs`'s lineage with the name inside its
+    // interval, or this ref does not belong to `gs`'s lineage at all. The bound must be rechecked
+    // even when the ids match: a sibling cloned earlier than this ref's creating state may not
+    // have copied the name.
+    if (depth < gs.deepCloneHistory.size()) {
+        const auto &deepCloneInfo = gs.deepCloneHistory[depth];
         if (globalStateId == deepCloneInfo.globalStateId && _id < deepCloneInfo.lastNameKnownByParentGlobalState) {
             return;
         }
@@ -239,17 +258,20 @@ void NameRef::sanityCheckSubstitution(const GlobalSubstitution &subst) const {
 }
 
 NameData NameRef::data(GlobalState &gs) const {
-    ENFORCE(_id < gs.names.size(), "name id out of bounds");
+    ENFORCE(_id < gs.nameTable().names.size(), "name id out of bounds");
     ENFORCE(exists(), "non existing name");
     enforceCorrectGlobalState(gs);
-    return NameData(gs.names[_id], gs);
+    // Does not go through mutableNameTable(): NameData hands out a mutable reference, but Names are
+    // never edited in place after entry, so reads off a shared table are safe and must not trigger
+    // a copy-on-write.
+    return NameData(const_cast<Name &>(gs.nameTable().names[_id]), gs);
 }
 
 const NameData NameRef::data(const GlobalState &gs) const {
-    ENFORCE(_id < gs.names.size(), "name id out of bounds");
+    ENFORCE(_id < gs.nameTable().names.size(), "name id out of bounds");
     ENFORCE(exists(), "non existing name");
     enforceCorrectGlobalState(gs);
-    return NameData(const_cast<Name &>(gs.names[_id]), gs);
+    return NameData(const_cast<Name &>(gs.nameTable().names[_id]), gs);
 }
 string NameRef::showRaw(const GlobalState &gs) const {
     return data(gs)->showRaw(gs);
@@ -314,10 +336,16 @@ Name Name::deepCopy(const GlobalState &to) const {
 
 NameData::NameData(Name &ref, const GlobalState &gs) : DebugOnlyCheck(gs), name(ref) {}
 
-NameDataDebugCheck::NameDataDebugCheck(const GlobalState &gs) : gs(gs), nameCountAtCreation(gs.namesUsed()) {}
+NameDataDebugCheck::NameDataDebugCheck(const GlobalState &gs)
+    : gs(gs), nameTableFrozenAtCreation(gs.nameTableFrozen),
+      nameTableStateAtCreation(nameTableFrozenAtCreation ? gs.nameTableGeneration : gs.namesUsed()) {}
 
 void NameDataDebugCheck::check() const {
-    ENFORCE(nameCountAtCreation == gs.namesUsed());
+    if (nameTableFrozenAtCreation) {
+        ENFORCE(gs.nameTableFrozen && nameTableStateAtCreation == gs.nameTableGeneration);
+        return;
+    }
+    ENFORCE(nameTableStateAtCreation == gs.namesUsed());
 }
 
 Name *NameData::operator->() {
@@ -0,0 +1,153 @@
+#ifndef RUBY_TYPER_SYMBOLMEMBERS_H
+#define RUBY_TYPER_SYMBOLMEMBERS_H
+
+#include "common/common.h"
+#include "core/NameRef.h"
+#include "core/SymbolRef.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace sorbet::core {
+
+/**
+ * The name-to-symbol map behind `Symbol::members()`. Most symbols own only a handful of members, so
+ * a hash table per symbol wastes memory and scatters lookups across the heap; instead entries live
+ * in a flat vector of (NameRef, SymbolRef) pairs kept sorted by name id, making `find` a binary
+ * search over contiguous memory. The few scopes that outgrow SPILL_THRESHOLD (`<root>`, `Object`)
+ * additionally build a hash index from name to vector slot: from then on lookups and inserts are a
+ * single probe, new entries are appended unsorted, and the index is authoritative.
+ *
+ * Exposes the subset of the map API the rest of the codebase uses; iteration walks the vector, so
+ * iterators are plain vector iterators in both regimes.
+ */
+class SymbolMembers final {
+public:
+    using value_type = std::pair<NameRef, SymbolRef>;
+    using iterator = std::vector<value_type>::iterator;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    static constexpr size_t SPILL_THRESHOLD = 48;
+
+private:
+    std::vector<value_type> entries_;
+    std::unique_ptr<UnorderedMap<NameRef, u4>> index_;
+
+    static bool idLess(const value_type &entry, NameRef name) {
+        return entry.first.id() < name.id();
+    }
+
+    iterator findSorted(NameRef name) {
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), name, idLess);
+        if (it != entries_.end() && it->first == name) {
+            return it;
+        }
+        return entries_.end();
+    }
+
+    void buildIndex() {
+        index_ = std::make_unique<UnorderedMap<NameRef, u4>>();
+        index_->reserve(entries_.size());
+        u4 slot = 0;
+        for (auto &entry : entries_) {
+            (*index_)[entry.first] = slot++;
+        }
+    }
+
+public:
+    SymbolMembers() = default;
+    SymbolMembers(SymbolMembers &&) noexcept = default;
+    SymbolMembers &operator=(SymbolMembers &&) noexcept = default;
+    SymbolMembers(const SymbolMembers &other) : entries_(other.entries_) {
+        if (other.index_ != nullptr) {
+            index_ = std::make_unique<UnorderedMap<NameRef, u4>>(*other.index_);
+        }
+    }
+    SymbolMembers &operator=(const SymbolMembers &other) {
+        if (this != &other) {
+            entries_ = other.entries_;
+            index_ = other.index_ != nullptr ? std::make_unique<UnorderedMap<NameRef, u4>>(*other.index_) : nullptr;
+        }
+        return *this;
+    }
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    bool empty() const {
+        return entries_.empty();
+    }
+
+    void reserve(size_t n) {
+        entries_.reserve(n);
+    }
+
+    iterator begin() {
+        return entries_.begin();
+    }
+    iterator end() {
+        return entries_.end();
+    }
+    const_iterator begin() const {
+        return entries_.begin();
+    }
+    const_iterator end() const {
+        return entries_.end();
+    }
+
+    iterator find(NameRef name) {
+        if (index_ != nullptr) {
+            auto it = index_->find(name);
+            return it != index_->end() ? entries_.begin() + it->second : entries_.end();
+        }
+        return findSorted(name);
+    }
+
+    const_iterator find(NameRef name) const {
+        return const_cast<SymbolMembers *>(this)->find(name);
+    }
+
+    const SymbolRef &at(NameRef name) const {
+        auto it = find(name);
+        if (it == entries_.end()) {
+            Exception::raise("SymbolMembers::at: name not found");
+        }
+        return it->second;
+    }
+
+    SymbolRef &operator[](NameRef name) {
+        if (index_ == nullptr) {
+            auto it = std::lower_bound(entries_.begin(), entries_.end(), name, idLess);
+            if (it != entries_.end() && it->first == name) {
+                return it->second;
+            }
+            if (entries_.size() < SPILL_THRESHOLD) {
+                return entries_.insert(it, value_type(name, SymbolRef()))->second;
+            }
+            buildIndex();
+        }
+        auto [it, inserted] = index_->try_emplace(name, entries_.size());
+        if (inserted) {
+            entries_.emplace_back(name, SymbolRef());
+        }
+        return entries_[it->second].second;
+    }
+
+    iterator erase(iterator pos) {
+        if (index_ != nullptr) {
+            u4 removed = pos - entries_.begin();
+            index_->erase(pos->first);
+            for (auto &entry : *index_) {
+                if (entry.second > removed) {
+                    entry.second--;
+                }
+            }
+        }
+        return entries_.erase(pos);
+    }
+};
+
+} // namespace sorbet::core
+
+#endif // RUBY_TYPER_SYMBOLMEMBERS_H
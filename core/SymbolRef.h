@@ -9,7 +9,14 @@ class Symbol;
 class GlobalState;
 struct SymbolDataDebugCheck {
     const GlobalState &gs;
-    const unsigned int symbolCountAtCreation;
+    // True when the symbol table was frozen at construction. A frozen table cannot grow, so the
+    // reference cannot be invalidated and check() need not recount symbols on every dereference;
+    // it only verifies the table was not unfrozen in between, which is inline member reads. This
+    // matters because typecheck, the dominant phase, runs entirely against frozen tables.
+    const bool symbolTableFrozenAtCreation;
+    // symbolTableGeneration at creation when frozen, symbol count at creation when not; check()
+    // compares against whichever can still change.
+    const unsigned int symbolTableStateAtCreation;
 
     SymbolDataDebugCheck(const GlobalState &gs);
     void check() const;
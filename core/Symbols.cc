@@ -1,5 +1,6 @@
 #include "core/Symbols.h"
 #include "absl/strings/match.h"
+#include "common/Counters.h"
 #include "common/JSON.h"
 #include "common/Levenstein.h"
 #include "common/formatting.h"
@@ -10,6 +11,7 @@
 #include "core/Names.h"
 #include "core/Types.h"
 #include "core/errors/internal.h"
+#include <limits>
 #include <string>
 
 template class std::vector<sorbet::core::TypeAndOrigins>;
@@ -103,8 +105,7 @@ TypePtr Symbol::externalType(const GlobalState &gs) const {
             // this method is supposed to be idempotent. The lines below implement "safe publication" of a value that is
             // safe to be used in presence of multiple threads running this tion concurrently
             auto mutableThis = const_cast<Symbol *>(this);
-            shared_ptr<core::Type> current(nullptr);
-            atomic_compare_exchange_weak(&mutableThis->resultType.store, &current, newResultType.store);
+            mutableThis->resultType.atomicInitializeFromNull(move(newResultType));
         }
         return externalType(gs);
     }
@@ -113,6 +114,18 @@ TypePtr Symbol::externalType(const GlobalState &gs) const {
 
 bool Symbol::derivesFrom(const GlobalState &gs, SymbolRef sym) const {
     if (isClassOrModuleLinearizationComputed()) {
+        // Fast path: resolver finalize precomputed every linearized class's ancestry (see
+        // GlobalState::computeAncestryTable), so ancestry is an interval test plus a binary search
+        // rather than a walk up the superclass chain. Classes entered since the table was built —
+        // or after any symbol-table unfreeze — miss it and take the walk below.
+        if (const auto *table = gs.ancestryTableIfValid()) {
+            u4 selfClassId = table->denseClassId(this->ref(gs));
+            u4 ancestorClassId = table->denseClassId(sym);
+            if (selfClassId != GlobalState::AncestryTable::NO_CLASS &&
+                ancestorClassId != GlobalState::AncestryTable::NO_CLASS) {
+                return table->derivesFrom(selfClassId, ancestorClassId, sym._id);
+            }
+        }
         for (SymbolRef a : mixins()) {
             if (a == sym) {
                 return true;
@@ -132,7 +145,7 @@ bool Symbol::derivesFrom(const GlobalState &gs, SymbolRef sym) const {
 }
 
 SymbolRef Symbol::ref(const GlobalState &gs) const {
-    auto distance = this - gs.symbols.data();
+    auto distance = this - gs.symbols().data();
     return SymbolRef(gs, distance);
 }
 
@@ -142,8 +155,10 @@ SymbolData SymbolRef::data(GlobalState &gs) const {
 }
 
 SymbolData SymbolRef::dataAllowingNone(GlobalState &gs) const {
-    ENFORCE(_id < gs.symbols.size());
-    return SymbolData(gs.symbols[this->_id], gs);
+    ENFORCE(_id < gs.symbols().size());
+    // Writing through the returned SymbolData requires an owned symbol table; the mutation funnels
+    // on GlobalState call ensureOwnedSymbolTable() before any phase that does so.
+    return SymbolData(const_cast<Symbol &>(gs.symbols()[this->_id]), gs);
 }
 
 const SymbolData SymbolRef::data(const GlobalState &gs) const {
@@ -152,8 +167,8 @@ const SymbolData SymbolRef::data(const GlobalState &gs) const {
 }
 
 const SymbolData SymbolRef::dataAllowingNone(const GlobalState &gs) const {
-    ENFORCE(_id < gs.symbols.size());
-    return SymbolData(const_cast<Symbol &>(gs.symbols[this->_id]), gs);
+    ENFORCE(_id < gs.symbols().size());
+    return SymbolData(const_cast<Symbol &>(gs.symbols()[this->_id]), gs);
 }
 
 bool SymbolRef::isSynthetic() const {
@@ -221,10 +236,32 @@ SymbolRef Symbol::findMemberNoDealias(const GlobalState &gs, NameRef name) const
 }
 
 SymbolRef Symbol::findMemberTransitive(const GlobalState &gs, NameRef name) const {
+    // Negative lookups — typo probes and missing-method checks — are the expensive case: they
+    // walk the whole ancestor chain before failing. The ancestry table carries a bloom filter
+    // over each class's transitively available member names, so a definite miss costs two bit
+    // tests. A filter hit proves nothing and takes the walk below.
+    if (const auto *table = gs.ancestryTableIfValid()) {
+        u4 classId = table->denseClassId(this->ref(gs));
+        if (classId != GlobalState::AncestryTable::NO_CLASS &&
+            !table->mayHaveMemberTransitive(classId, name.id())) {
+            categoryCounterInc("ancestry_table.member_filter", "definite_miss");
+            return Symbols::noSymbol();
+        }
+    }
     return findMemberTransitiveInternal(gs, name, Flags::NONE, Flags::NONE, 100);
 }
 
 SymbolRef Symbol::findConcreteMethodTransitive(const GlobalState &gs, NameRef name) const {
+    // Same definite-miss filter as findMemberTransitive: a name absent from every ancestor is
+    // absent no matter which flags the caller is filtering on.
+    if (const auto *table = gs.ancestryTableIfValid()) {
+        u4 classId = table->denseClassId(this->ref(gs));
+        if (classId != GlobalState::AncestryTable::NO_CLASS &&
+            !table->mayHaveMemberTransitive(classId, name.id())) {
+            categoryCounterInc("ancestry_table.member_filter", "definite_miss");
+            return Symbols::noSymbol();
+        }
+    }
     return findMemberTransitiveInternal(gs, name, Flags::METHOD | Flags::METHOD_ABSTRACT, Flags::METHOD, 100);
 }
 
@@ -380,8 +417,13 @@ vector<Symbol::FuzzySearchResult> Symbol::findMemberFuzzyMatchConstant(const Glo
                     if (member.first.data(gs)->kind == NameKind::CONSTANT &&
                         member.first.data(gs)->cnst.original.data(gs)->kind == NameKind::UTF8 &&
                         member.second.exists()) {
-                        auto thisDistance = Levenstein::distance(
-                            currentName, member.first.data(gs)->cnst.original.data(gs)->raw.utf8, best.distance);
+                        auto candidate = member.first.data(gs)->cnst.original.data(gs)->raw.utf8;
+                        // Pre-filter: when the length gap alone exceeds the bound, skip the kernel.
+                        if (abs(static_cast<int>(candidate.size()) - static_cast<int>(currentName.size())) >
+                            best.distance) {
+                            continue;
+                        }
+                        auto thisDistance = Levenstein::distance(currentName, candidate, best.distance);
                         if (thisDistance <= best.distance) {
                             best.distance = thisDistance;
                             best.symbol = member.second;
@@ -419,8 +461,12 @@ vector<Symbol::FuzzySearchResult> Symbol::findMemberFuzzyMatchConstant(const Glo
                         member.second.data(gs)->derivesFrom(gs, core::Symbols::StubModule())) {
                         continue;
                     }
-                    auto thisDistance = Levenstein::distance(
-                        currentName, member.first.data(gs)->cnst.original.data(gs)->raw.utf8, best.distance);
+                    auto candidate = member.first.data(gs)->cnst.original.data(gs)->raw.utf8;
+                    if (abs(static_cast<int>(candidate.size()) - static_cast<int>(currentName.size())) >
+                        best.distance) {
+                        continue;
+                    }
+                    auto thisDistance = Levenstein::distance(currentName, candidate, best.distance);
                     if (thisDistance <= globalBestDistance) {
                         if (thisDistance < globalBestDistance) {
                             globalBest.clear();
@@ -463,6 +509,9 @@ Symbol::FuzzySearchResult Symbol::findMemberFuzzyMatchUTF8(const GlobalState &gs
             continue;
         }
         auto utf8 = thisName.data(gs)->raw.utf8;
+        if (abs(static_cast<int>(utf8.size()) - static_cast<int>(currentName.size())) > result.distance) {
+            continue;
+        }
         int thisDistance = Levenstein::distance(currentName, utf8, result.distance);
         if (thisDistance < result.distance ||
             (thisDistance == result.distance && result.symbol._id > pair.second._id)) {
@@ -514,10 +563,11 @@ bool Symbol::isHiddenFromPrinting(const GlobalState &gs) const {
     if (ref(gs).isSynthetic()) {
         return true;
     }
-    if (locs_.empty()) {
+    auto locs = this->locs(gs);
+    if (locs.empty()) {
         return true;
     }
-    for (auto loc : locs_) {
+    for (auto loc : locs) {
         if (loc.file().data(gs).sourceType == File::Payload) {
             return true;
         }
@@ -610,12 +660,13 @@ string Symbol::toStringWithOptions(const GlobalState &gs, int tabs, bool showFul
         fmt::format_to(buf, " -> {}",
                        showRaw ? this->resultType->toStringWithTabs(gs, tabs) : this->resultType->show(gs));
     }
-    if (!locs_.empty()) {
+    auto symbolLocs = this->locs(gs);
+    if (!symbolLocs.empty()) {
         fmt::format_to(buf, " @ ");
-        if (locs_.size() > 1) {
+        if (symbolLocs.size() > 1) {
             if (ref(gs) == core::Symbols::root() && gs.censorForSnapshotTests) {
                 const auto payloadPathPrefix = "https://github.com/sorbet/sorbet/tree/master/rbi/";
-                bool hasPayloadLoc = absl::c_any_of(locs_, [&](const auto loc) {
+                bool hasPayloadLoc = absl::c_any_of(symbolLocs, [&](const auto loc) {
                     return absl::StartsWith(loc.file().data(gs).path(), payloadPathPrefix);
                 });
 
@@ -626,8 +677,8 @@ string Symbol::toStringWithOptions(const GlobalState &gs, int tabs, bool showFul
 
                 bool first = true;
                 vector<Loc> sortedLocs;
-                sortedLocs.reserve(locs_.size());
-                for (const auto loc : locs_) {
+                sortedLocs.reserve(symbolLocs.size());
+                for (const auto loc : symbolLocs) {
                     sortedLocs.emplace_back(loc);
                 }
                 fast_sort(sortedLocs,
@@ -649,12 +700,12 @@ string Symbol::toStringWithOptions(const GlobalState &gs, int tabs, bool showFul
                 }
                 fmt::format_to(buf, ")");
             } else {
-                fmt::format_to(buf, "({})", fmt::map_join(locs_, ", ", [&](auto loc) {
+                fmt::format_to(buf, "({})", fmt::map_join(symbolLocs, ", ", [&](auto loc) {
                                    return showRaw ? loc.showRaw(gs) : loc.filePosToString(gs);
                                }));
             }
         } else {
-            fmt::format_to(buf, "{}", showRaw ? locs_[0].showRaw(gs) : locs_[0].filePosToString(gs));
+            fmt::format_to(buf, "{}", showRaw ? symbolLocs[0].showRaw(gs) : symbolLocs[0].filePosToString(gs));
         }
     }
 
@@ -913,10 +964,10 @@ void Symbol::recordSealedSubclass(MutableContext ctx, SymbolRef subclass) {
     }
 }
 
-const InlinedVector<Loc, 2> &Symbol::sealedLocs(const GlobalState &gs) const {
+absl::Span<const Loc> Symbol::sealedLocs(const GlobalState &gs) const {
     ENFORCE(this->isClassOrModuleSealed(), "Class is not marked sealed: {}", this->show(gs));
     auto sealedSubclasses = this->lookupSingletonClass(gs).data(gs)->findMember(gs, core::Names::sealedSubclasses());
-    auto &result = sealedSubclasses.data(gs)->locs();
+    auto result = sealedSubclasses.data(gs)->locs(gs);
     ENFORCE(result.size() > 0);
     return result;
 }
@@ -1021,7 +1072,10 @@ Symbol Symbol::deepCopy(const GlobalState &to, bool keepGsId) const {
     result.mixins_ = this->mixins_;
     result.resultType = this->resultType;
     result.name = NameRef(to, this->name.id());
-    result.locs_ = this->locs_;
+    result.defLoc_ = this->defLoc_;
+    result.locsBegin_ = this->locsBegin_;
+    result.locsCount_ = this->locsCount_;
+    result.locsCapacity_ = this->locsCapacity_;
     result.typeParams = this->typeParams;
     if (keepGsId) {
         result.members_ = this->members_;
@@ -1054,7 +1108,7 @@ int Symbol::typeArity(const GlobalState &gs) const {
 }
 
 void Symbol::sanityCheck(const GlobalState &gs) const {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return;
     }
     SymbolRef current = this->ref(gs);
@@ -1178,32 +1232,65 @@ bool Symbol::ignoreInHashing(const GlobalState &gs) const {
     return false;
 }
 Loc Symbol::loc() const {
-    if (!locs_.empty()) {
-        return locs_[0];
+    if (locsCount_ != 0) {
+        return defLoc_;
     }
     return Loc::none();
 }
 
-const InlinedVector<Loc, 2> &Symbol::locs() const {
-    return locs_;
+absl::Span<const Loc> Symbol::locs(const GlobalState &gs) const {
+    return absl::Span<const Loc>(gs.symbolLocs_->data() + locsBegin_, locsCount_);
 }
 
 void Symbol::addLoc(const core::GlobalState &gs, core::Loc loc) {
     if (!loc.file().exists()) {
         return;
     }
-    for (auto &existing : locs_) {
+    // The const_cast is safe for the same reason SymbolData's is: addLoc runs only while the
+    // symbol table is unfrozen, and unfreezeSymbolTable() broke any sharing of the table and the
+    // pool before handing out mutable symbols.
+    auto &pool = *const_cast<GlobalState &>(gs).symbolLocs_;
+    for (u4 i = 0; i < locsCount_; i++) {
+        auto &existing = pool[locsBegin_ + i];
         if (existing.file() == loc.file()) {
             existing = loc;
+            if (i == 0) {
+                defLoc_ = loc;
+            }
             return;
         }
     }
 
+    if (locsCount_ == locsCapacity_) {
+        // The slice is full: relocate it to the end of the pool with doubled capacity, amortizing
+        // relocations for symbols re-opened in many files. The abandoned slots become garbage, but
+        // the serializer writes slices rather than the raw pool, so they never reach a payload.
+        constexpr u4 maxLocs = std::numeric_limits<u2>::max();
+        ENFORCE(locsCount_ < maxLocs, "symbol has too many locs");
+        u4 newCapacity = locsCapacity_ == 0 ? 2 : min<u4>(locsCapacity_ * 2, maxLocs);
+        u4 newBegin = pool.size();
+        pool.resize(pool.size() + newCapacity);
+        for (u4 i = 0; i < locsCount_; i++) {
+            pool[newBegin + i] = pool[locsBegin_ + i];
+        }
+        locsBegin_ = newBegin;
+        locsCapacity_ = newCapacity;
+    }
+
     if (loc.file().data(gs).sourceType == core::File::Type::Normal && !loc.file().data(gs).isRBI()) {
-        locs_.insert(locs_.begin(), loc);
+        // Normal-source locs go to the front: loc() prefers them over payload and RBI locs.
+        for (u4 i = locsCount_; i > 0; i--) {
+            pool[locsBegin_ + i] = pool[locsBegin_ + i - 1];
+        }
+        pool[locsBegin_] = loc;
+        defLoc_ = loc;
     } else {
-        locs_.emplace_back(loc);
+        pool[locsBegin_ + locsCount_] = loc;
+        if (locsCount_ == 0) {
+            defLoc_ = loc;
+        }
     }
+    locsCount_++;
 }
 
 vector<std::pair<NameRef, SymbolRef>> Symbol::membersStableOrderSlow(const GlobalState &gs) const {
@@ -1239,10 +1326,19 @@ vector<std::pair<NameRef, SymbolRef>> Symbol::membersStableOrderSlow(const Globa
 
 SymbolData::SymbolData(Symbol &ref, const GlobalState &gs) : DebugOnlyCheck(gs), symbol(ref) {}
 
-SymbolDataDebugCheck::SymbolDataDebugCheck(const GlobalState &gs) : gs(gs), symbolCountAtCreation(gs.symbolsUsed()) {}
+SymbolDataDebugCheck::SymbolDataDebugCheck(const GlobalState &gs)
+    : gs(gs), symbolTableFrozenAtCreation(gs.symbolTableFrozen),
+      symbolTableStateAtCreation(symbolTableFrozenAtCreation ? gs.symbolTableGeneration : gs.symbolsUsed()) {}
 
 void SymbolDataDebugCheck::check() const {
-    ENFORCE(symbolCountAtCreation == gs.symbolsUsed());
+    if (symbolTableFrozenAtCreation) {
+        // A frozen table cannot grow. The only way this reference could dangle is a SymbolData
+        // held across an UnfreezeSymbolTable scope, which the generation comparison catches: every
+        // unfreeze bumps symbolTableGeneration, even if no symbol ends up entered.
+        ENFORCE(gs.symbolTableFrozen && symbolTableStateAtCreation == gs.symbolTableGeneration);
+        return;
+    }
+    ENFORCE(symbolTableStateAtCreation == gs.symbolsUsed());
 }
 
 Symbol *SymbolData::operator->() {
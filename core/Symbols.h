@@ -1,9 +1,11 @@
 #ifndef SORBET_SYMBOLS_H
 #define SORBET_SYMBOLS_H
 
+#include "absl/types/span.h"
 #include "common/common.h"
 #include "core/Loc.h"
 #include "core/Names.h"
+#include "core/SymbolMembers.h"
 #include "core/SymbolRef.h"
 #include "core/Types.h"
 #include <memory>
@@ -102,7 +104,7 @@ public:
     };
 
     Loc loc() const;
-    const InlinedVector<Loc, 2> &locs() const;
+    absl::Span<const Loc> locs(const GlobalState &gs) const;
     void addLoc(const core::GlobalState &gs, core::Loc loc);
 
     u4 hash(const GlobalState &gs) const;
@@ -534,7 +536,7 @@ public:
     SymbolRef topAttachedClass(const GlobalState &gs) const;
 
     void recordSealedSubclass(MutableContext ctx, SymbolRef subclass);
-    const InlinedVector<Loc, 2> &sealedLocs(const GlobalState &gs) const;
+    absl::Span<const Loc> sealedLocs(const GlobalState &gs) const;
     TypePtr sealedSubclassesToUnion(const Context ctx) const;
 
     // if dealiasing fails here, then we return Untyped instead
@@ -550,6 +552,11 @@ public:
 
     bool ignoreInHashing(const GlobalState &gs) const;
 
+    // Field order matters: the scalars that whole-table scans (Resolver::finalizeAncestors,
+    // GlobalState::hash, the serializer) inspect on every row — owner, superClassOrRebind, flags,
+    // name — sit at the front of the struct, ahead of the pointer-heavy cold storage (resultType,
+    // members_, arguments_), so a scan that only filters on them touches one cache line per
+    // symbol.
     SymbolRef owner;
     SymbolRef superClassOrRebind; // method arugments store rebind here
 
@@ -574,8 +581,8 @@ public:
     }
 
     u4 flags = Flags::NONE;
+    NameRef name; // todo: move out? it should not matter but it's important for name resolution
     u4 uniqueCounter = 1; // used as a counter inside the namer
-    NameRef name;         // todo: move out? it should not matter but it's important for name resolution
     TypePtr resultType;
 
     bool hasSig() const {
@@ -583,13 +590,13 @@ public:
         return resultType != nullptr;
     }
 
-    UnorderedMap<NameRef, SymbolRef> members_;
+    SymbolMembers members_;
     std::vector<ArgInfo> arguments_;
 
-    UnorderedMap<NameRef, SymbolRef> &members() {
+    SymbolMembers &members() {
         return members_;
     };
-    const UnorderedMap<NameRef, SymbolRef> &members() const {
+    const SymbolMembers &members() const {
         return members_;
     };
 
@@ -639,7 +646,19 @@ private:
      * for method - ordered type generic type arguments of the class
      */
     InlinedVector<SymbolRef, 4> typeParams;
-    InlinedVector<Loc, 2> locs_;
+
+    // Canonical definition Loc, mirroring the front of the symbol's Loc slice (see below), cached
+    // here so loc() needs no GlobalState.
+    Loc defLoc_;
+    // This symbol's Locs live in GlobalState::symbolLocs_, a pool shared by every symbol: the
+    // slice [locsBegin_, locsBegin_ + locsCount_) holds them, with locsCapacity_ slots reserved.
+    // Symbols re-opened in many files used to spill big per-symbol vectors that the serializer
+    // pickled and every copy-on-write of the symbol table duplicated allocation by allocation;
+    // slices copy as three scalars and let deepCopy share the pool wholesale. addLoc grows a full
+    // slice by relocating it to the end of the pool with doubled capacity.
+    u4 locsBegin_ = 0;
+    u2 locsCount_ = 0;
+    u2 locsCapacity_ = 0;
 
     SymbolRef findMemberTransitiveInternal(const GlobalState &gs, NameRef name, u4 mask, u4 flags,
                                            int maxDepth = 100) const;
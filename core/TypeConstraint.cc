@@ -4,6 +4,48 @@
 using namespace std;
 namespace sorbet::core {
 
+namespace {
+// A small per-thread LIFO of recycled TypeConstraint allocations. Inference creates one
+// constraint per generic or block-taking send, and the overwhelming majority are freed before
+// the next one is needed, so the list stays tiny and hot in cache. Constraints that outlive
+// their method (e.g. ones captured by LSP query responses) simply get recycled on whichever
+// thread destroys them.
+struct ConstraintFreeList {
+    static constexpr size_t MAX_ENTRIES = 64;
+    vector<void *> entries;
+    ~ConstraintFreeList() {
+        for (auto *entry : entries) {
+            ::operator delete(entry);
+        }
+    }
+};
+thread_local ConstraintFreeList constraintFreeList;
+} // namespace
+
+void *TypeConstraint::operator new(std::size_t size) {
+    auto &freeList = constraintFreeList;
+    if (size == sizeof(TypeConstraint) && !freeList.entries.empty()) {
+        auto *mem = freeList.entries.back();
+        freeList.entries.pop_back();
+        categoryCounterInc("types.constraint_freelist", "hit");
+        return mem;
+    }
+    categoryCounterInc("types.constraint_freelist", "miss");
+    return ::operator new(size);
+}
+
+void TypeConstraint::operator delete(void *ptr, std::size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto &freeList = constraintFreeList;
+    if (size == sizeof(TypeConstraint) && freeList.entries.size() < ConstraintFreeList::MAX_ENTRIES) {
+        freeList.entries.emplace_back(ptr);
+        return;
+    }
+    ::operator delete(ptr);
+}
+
 bool TypeConstraint::isEmpty() const {
     return upperBounds.empty() && lowerBounds.empty();
 }
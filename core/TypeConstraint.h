@@ -8,9 +8,11 @@ namespace sorbet::core {
 
 class TypeConstraint {
     static TypeConstraint makeEmptyFrozenConstraint();
-    std::vector<std::pair<SymbolRef, TypePtr>> upperBounds;
-    std::vector<std::pair<SymbolRef, TypePtr>> lowerBounds;
-    std::vector<std::pair<SymbolRef, TypePtr>> solution;
+    // Almost every generic method has one or two type parameters, so the bounds live inline and
+    // a fresh constraint performs no heap allocation at all.
+    InlinedVector<std::pair<SymbolRef, TypePtr>, 2> upperBounds;
+    InlinedVector<std::pair<SymbolRef, TypePtr>, 2> lowerBounds;
+    InlinedVector<std::pair<SymbolRef, TypePtr>, 2> solution;
     bool wasSolved = false;
     bool cantSolve = false;
     TypePtr &findUpperBound(SymbolRef forWhat);
@@ -21,6 +23,13 @@ public:
     TypeConstraint() = default;
     TypeConstraint(const TypeConstraint &) = delete;
     TypeConstraint(TypeConstraint &&) = default;
+
+    // Inference allocates a constraint for every send with a block or a generic target, and most
+    // of them die before the next send. Recycle the storage through a thread-local free list
+    // instead of hitting the allocator each time.
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size);
+
     void defineDomain(Context ctx, const InlinedVector<SymbolRef, 4> &typeParams);
     bool hasUpperBound(SymbolRef forWhat) const;
     bool hasLowerBound(SymbolRef forWhat) const;
@@ -6,23 +6,74 @@
 namespace sorbet::core {
 // using TypePtr = std::shared_ptr<Type>;
 class Type;
+// An intrusive refcounted pointer to `Type`. A single machine word instead of `shared_ptr`'s two;
+// the count lives in the pointee, so copies touch no separate control block, and types marked
+// immortal (the process-lifetime singletons behind `Types::top()` & co) skip the count entirely.
+// The count manipulation is defined in types.cc because `Type` is incomplete here.
 class TypePtr {
-    std::shared_ptr<Type> store;
-    TypePtr(std::shared_ptr<Type> &&store);
+    Type *store = nullptr;
+
+    static void incRef(Type *ptr) noexcept;
+    static void decRef(Type *ptr) noexcept;
+
+    /**
+     * If this TypePtr is null, atomically installs `desired` into it, consuming the reference;
+     * otherwise drops `desired`. Safe to race with other callers on the same TypePtr; used for the
+     * one-time publication of `Symbol::resultType`.
+     */
+    void atomicInitializeFromNull(TypePtr desired);
 
 public:
     TypePtr() = default;
-    TypePtr(TypePtr &&other) = default;
-    TypePtr(const TypePtr &other) = default;
-    TypePtr &operator=(TypePtr &&other) = default;
-    TypePtr &operator=(const TypePtr &other) = default;
-    explicit TypePtr(Type *ptr) : store(ptr) {}
+    TypePtr(TypePtr &&other) noexcept : store(other.store) {
+        other.store = nullptr;
+    }
+    TypePtr(const TypePtr &other) noexcept : store(other.store) {
+        if (store != nullptr) {
+            incRef(store);
+        }
+    }
+    ~TypePtr() {
+        if (store != nullptr) {
+            decRef(store);
+        }
+    }
+    TypePtr &operator=(TypePtr &&other) noexcept {
+        if (this != &other) {
+            auto *old = store;
+            store = other.store;
+            other.store = nullptr;
+            if (old != nullptr) {
+                decRef(old);
+            }
+        }
+        return *this;
+    }
+    TypePtr &operator=(const TypePtr &other) noexcept {
+        if (store != other.store) {
+            auto *old = store;
+            store = other.store;
+            if (store != nullptr) {
+                incRef(store);
+            }
+            if (old != nullptr) {
+                decRef(old);
+            }
+        }
+        return *this;
+    }
+    /** Takes ownership of a freshly constructed type. */
+    explicit TypePtr(Type *ptr) : store(ptr) {
+        if (store != nullptr) {
+            incRef(store);
+        }
+    }
     TypePtr(std::nullptr_t n) : store(nullptr) {}
     operator bool() const {
-        return (bool)store;
+        return store != nullptr;
     }
     Type *get() const {
-        return store.get();
+        return store;
     }
     Type *operator->() const {
         return get();
@@ -42,11 +93,19 @@ public:
     bool operator==(std::nullptr_t n) const {
         return store == nullptr;
     }
+
+    /**
+     * Marks the pointee as immortal: it is never freed and copies skip the refcount, so hot shared
+     * singletons cause no atomic cache-line traffic. Must be called before the pointer is shared
+     * between threads.
+     */
+    void markImmortal() const;
+
     friend class Symbol;
 
     template <class T, class... Args> friend TypePtr make_type(Args &&... args);
 };
-CheckSize(TypePtr, 16, 8);
+CheckSize(TypePtr, 8, 8);
 } // namespace sorbet::core
 
 #endif
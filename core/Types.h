@@ -6,6 +6,7 @@
 #include "core/Error.h"
 #include "core/SymbolRef.h"
 #include "core/TypeConstraint.h"
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <string>
@@ -24,6 +25,11 @@ class TypeVar;
 class SendAndBlockLink;
 class TypeAndOrigins;
 
+// Element storage for shapes and tuples. The overwhelming majority of both are small — prop
+// hashes, pairs, argument tuples — so a little inline capacity removes the per-instance heap
+// allocation in the common case.
+using TypeElems = InlinedVector<TypePtr, 4>;
+
 class ArgInfo {
 public:
     struct ArgFlags {
@@ -61,10 +67,10 @@ public:
     ArgInfo &operator=(ArgInfo &&) noexcept = default;
     ArgInfo deepCopy() const;
 };
-CheckSize(ArgInfo, 40, 8);
+CheckSize(ArgInfo, 32, 8);
 
 template <class T, class... Args> TypePtr make_type(Args &&... args) {
-    return TypePtr(std::make_shared<T>(std::forward<Args>(args)...));
+    return TypePtr(new T(std::forward<Args>(args)...));
 }
 
 enum class UntypedMode {
@@ -152,7 +158,7 @@ public:
     /** Internal implementation. You should probably use any(). */
     static TypePtr lub(Context ctx, const TypePtr &t1, const TypePtr &t2);
 
-    static TypePtr lubAll(Context ctx, std::vector<TypePtr> &elements);
+    static TypePtr lubAll(Context ctx, const TypeElems &elements);
     static TypePtr arrayOf(Context ctx, const TypePtr &elem);
     static TypePtr hashOf(Context ctx, const TypePtr &elem);
 
@@ -220,8 +226,16 @@ public:
     virtual int kind() = 0;
     virtual TypePtr _approximate(Context ctx, const TypeConstraint &tc);
     unsigned int hash(const GlobalState &gs) const;
+
+private:
+    friend class TypePtr;
+    /** Pins an object for the process lifetime; TypePtr copies of immortal types skip the count entirely. */
+    static constexpr u4 IMMORTAL_REFCOUNT = 0xffffffffu;
+    /** Number of TypePtrs referencing this object. Atomic because types reachable from the symbol table are
+     * copied concurrently by typechecking threads. */
+    mutable std::atomic<u4> refcount{0};
 };
-CheckSize(Type, 8, 8);
+CheckSize(Type, 16, 8);
 
 template <class To> To *cast_type(Type *what) {
     static_assert(!std::is_pointer<To>::value, "To has to be a pointer");
@@ -253,7 +267,7 @@ public:
 
     void _sanityCheck(Context ctx) override;
 };
-CheckSize(ProxyType, 8, 8);
+CheckSize(ProxyType, 16, 8);
 
 class ClassType : public GroundType {
 public:
@@ -305,7 +319,7 @@ public:
                                  const std::vector<TypePtr> &targs) override;
     virtual int kind() final;
 };
-CheckSize(LambdaParam, 48, 8);
+CheckSize(LambdaParam, 32, 8);
 
 class SelfTypeParam final : public Type {
 public:
@@ -372,7 +386,7 @@ public:
     virtual TypePtr getCallArguments(Context ctx, NameRef name) final;
     virtual bool derivesFrom(const GlobalState &gs, SymbolRef klass) const final;
 };
-CheckSize(SelfType, 8, 8);
+CheckSize(SelfType, 16, 8);
 
 class LiteralType final : public ProxyType {
 public:
@@ -387,6 +401,16 @@ public:
     LiteralType(double val);
     LiteralType(SymbolRef klass, NameRef val);
     LiteralType(bool val);
+
+    // Factories returning canonical instances where one exists: booleans and small non-negative
+    // integers come from fixed immortal pools, and symbol/string literals are interned per-thread
+    // like Or/And composites (see types.cc). Literal types are immutable, so a pooled instance is
+    // indistinguishable from a fresh one; prefer these over constructing directly.
+    static TypePtr make_shared(int64_t val);
+    static TypePtr make_shared(double val);
+    static TypePtr make_shared(SymbolRef klass, NameRef val);
+    static TypePtr make_shared(bool val);
+
     virtual TypePtr underlying() const override;
 
     virtual std::string toStringWithTabs(const GlobalState &gs, int tabs = 0) const final;
@@ -401,7 +425,7 @@ public:
                                  const std::vector<TypePtr> &targs) override;
     virtual int kind() final;
 };
-CheckSize(LiteralType, 24, 8);
+CheckSize(LiteralType, 32, 8);
 
 /*
  * TypeVars are the used for the type parameters of generic methods.
@@ -475,7 +499,7 @@ private:
 
     static TypePtr make_shared(const TypePtr &left, const TypePtr &right);
 };
-CheckSize(OrType, 40, 8);
+CheckSize(OrType, 32, 8);
 
 class AndType final : public GroundType {
 public:
@@ -517,15 +541,20 @@ private:
 
     static TypePtr make_shared(const TypePtr &left, const TypePtr &right);
 };
-CheckSize(AndType, 40, 8);
+CheckSize(AndType, 32, 8);
 
 class ShapeType final : public ProxyType {
 public:
-    std::vector<TypePtr> keys; // TODO: store sorted by whatever
-    std::vector<TypePtr> values;
+    TypeElems keys;
+    TypeElems values;
     const TypePtr underlying_;
     ShapeType();
-    ShapeType(TypePtr underlying, std::vector<TypePtr> keys, std::vector<TypePtr> values);
+    ShapeType(TypePtr underlying, TypeElems keys, TypeElems values);
+
+    // Position of `lit` in `keys`, or -1 if the shape has no such key. Large shapes answer this
+    // with a binary search over a side table built at construction; small ones scan, which is
+    // faster than chasing the table for a handful of entries.
+    int indexForKey(const LiteralType &lit) const;
 
     virtual std::string toStringWithTabs(const GlobalState &gs, int tabs = 0) const final;
     virtual std::string show(const GlobalState &gs) const final;
@@ -541,19 +570,24 @@ public:
     virtual TypePtr _approximate(Context ctx, const TypeConstraint &tc) override;
     virtual TypePtr _instantiate(Context ctx, const TypeConstraint &tc) override;
     virtual TypePtr underlying() const override;
+
+private:
+    // Key positions ordered by literal identity, enabling the binary search in indexForKey.
+    // nullptr for shapes below the lookup threshold; length is keys.size() otherwise.
+    std::unique_ptr<const u4[]> sortedKeyOrder_;
 };
-CheckSize(ShapeType, 72, 8);
+CheckSize(ShapeType, 112, 8);
 
 class TupleType final : public ProxyType {
 private:
     TupleType() = delete;
 
 public:
-    std::vector<TypePtr> elems;
+    TypeElems elems;
     const TypePtr underlying_;
 
-    TupleType(TypePtr underlying, std::vector<TypePtr> elements);
-    static TypePtr build(Context ctx, std::vector<TypePtr> elements);
+    TupleType(TypePtr underlying, TypeElems elements);
+    static TypePtr build(Context ctx, TypeElems elements);
 
     virtual std::string toStringWithTabs(const GlobalState &gs, int tabs = 0) const final;
     virtual std::string show(const GlobalState &gs) const final;
@@ -574,7 +608,7 @@ public:
     TypePtr elementType() const;
     virtual TypePtr underlying() const override;
 };
-CheckSize(TupleType, 48, 8);
+CheckSize(TupleType, 64, 8);
 
 class AppliedType final : public Type {
 public:
@@ -661,7 +695,7 @@ public:
     TypeAndOrigins &operator=(const TypeAndOrigins &) = default;
     TypeAndOrigins &operator=(TypeAndOrigins &&) = default;
 };
-CheckSize(TypeAndOrigins, 40, 8);
+CheckSize(TypeAndOrigins, 32, 8);
 
 struct CallLocs final {
     Loc call;
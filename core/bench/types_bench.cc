@@ -0,0 +1,118 @@
+// Micro-benchmarks for the core type algebra. lub/glb/isSubType regressions used to surface only
+// as end-to-end CI time; this binary exercises them on synthetic workloads shaped like the
+// patterns that dominate real codebases — deep unions, generic applications, and prop-heavy shape
+// types — and prints one tab-separated `name<TAB>ns_per_iter` line per workload, so a wrapper can
+// diff a PR's numbers against a stored baseline.
+//
+// Run via `bazel run -c opt //core:types_bench`. Numbers from fastbuild or dbg builds are
+// meaningless; so are numbers compared across machines.
+#include "core/Error.h"
+#include "core/ErrorQueue.h"
+#include "core/Unfreeze.h"
+#include "core/core.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+#include "spdlog/spdlog.h"
+#include <chrono>
+
+namespace spd = spdlog;
+using namespace std;
+
+namespace sorbet::core {
+
+namespace {
+
+// Folded into every benchmark's result and printed at the end so the compiler cannot discard the
+// measured calls.
+size_t sink = 0;
+
+template <typename Fn> void bench(string_view name, int iters, Fn fn) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        fn(i);
+    }
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    fmt::print("{}\t{:.1f}\n", name, static_cast<double>(ns) / iters);
+}
+
+// A union of `width` distinct integer literal types, built the way inference builds unions: by
+// repeated lub.
+TypePtr deepUnion(Context ctx, int width, int offset = 0) {
+    TypePtr acc = make_type<LiteralType>(static_cast<int64_t>(offset));
+    for (int i = 1; i < width; i++) {
+        acc = Types::lub(ctx, acc, make_type<LiteralType>(static_cast<int64_t>(offset + i)));
+    }
+    return acc;
+}
+
+// A shape with `props` symbol keys, mirroring the serialized form of a prop-heavy model class.
+TypePtr propShape(GlobalState &gs, Context ctx, int props, const TypePtr &valueType) {
+    TypeElems keys;
+    TypeElems values;
+    keys.reserve(props);
+    values.reserve(props);
+    for (int i = 0; i < props; i++) {
+        auto name = gs.enterNameUTF8(fmt::format("prop_{}", i));
+        keys.emplace_back(make_type<LiteralType>(Symbols::Symbol(), name));
+        values.emplace_back(valueType);
+    }
+    return make_type<ShapeType>(Types::hashOfUntyped(), move(keys), move(values));
+}
+
+void run(GlobalState &gs) {
+    Context ctx(gs, Symbols::root());
+
+    // Workload inputs are built once, outside the timed loops: the benchmarks measure the
+    // algebra, not the construction of its inputs.
+    auto union32a = deepUnion(ctx, 32);
+    auto union32b = deepUnion(ctx, 32, 16); // overlaps half of union32a
+    auto arrayOfInt = Types::arrayOf(ctx, Types::Integer());
+    auto arrayOfUnion = Types::arrayOf(ctx, Types::any(ctx, Types::Integer(), Types::String()));
+    TypePtr shape30a;
+    TypePtr shape30b;
+    {
+        UnfreezeNameTable nameTableAccess(gs);
+        shape30a = propShape(gs, ctx, 30, Types::Integer());
+        shape30b = propShape(gs, ctx, 30, Types::any(ctx, Types::Integer(), Types::String()));
+    }
+
+    bench("lub_fold_union_32", 10000, [&](int i) {
+        sink += deepUnion(ctx, 32, i)->kind(); //
+    });
+    bench("lub_union_32_union_32", 100000, [&](int i) {
+        sink += Types::lub(ctx, union32a, union32b)->kind(); //
+    });
+    bench("glb_union_32_union_32", 100000, [&](int i) {
+        sink += Types::glb(ctx, union32a, union32b)->kind(); //
+    });
+    bench("isSubType_union_32_self", 100000, [&](int i) {
+        sink += Types::isSubType(ctx, union32a, union32a); //
+    });
+    bench("isSubType_union_32_disjoint", 100000, [&](int i) {
+        sink += Types::isSubType(ctx, union32a, union32b); //
+    });
+    bench("isSubType_applied_generic", 100000, [&](int i) {
+        sink += Types::isSubType(ctx, arrayOfInt, arrayOfUnion); //
+    });
+    bench("lub_applied_generic", 100000, [&](int i) {
+        sink += Types::lub(ctx, arrayOfInt, arrayOfUnion)->kind(); //
+    });
+    bench("isSubType_shape_30_props", 100000, [&](int i) {
+        sink += Types::isSubType(ctx, shape30a, shape30b); //
+    });
+    bench("lub_shape_30_props", 100000, [&](int i) {
+        sink += Types::lub(ctx, shape30a, shape30b)->kind(); //
+    });
+}
+
+} // namespace
+} // namespace sorbet::core
+
+int main(int argc, char **argv) {
+    auto logger = spd::stderr_color_mt("types_bench");
+    auto errorQueue = make_shared<sorbet::core::ErrorQueue>(*logger, *logger);
+    sorbet::core::GlobalState gs(errorQueue);
+    gs.initEmpty();
+    sorbet::core::run(gs);
+    fmt::print("# sink={}\n", sorbet::core::sink);
+    return 0;
+}
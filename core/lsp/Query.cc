@@ -16,6 +16,11 @@ Query Query::createLocQuery(core::Loc loc) {
     return Query(Query::Kind::LOC, loc, core::Symbols::noSymbol(), core::LocalVariable());
 }
 
+Query Query::createFileQuery(core::FileRef file) {
+    ENFORCE(file.exists());
+    return Query(Query::Kind::FILE, core::Loc(file, 0, 0), core::Symbols::noSymbol(), core::LocalVariable());
+}
+
 Query Query::createSymbolQuery(core::SymbolRef symbol) {
     ENFORCE(symbol.exists());
     return Query(Query::Kind::SYMBOL, core::Loc::none(), symbol, core::LocalVariable());
@@ -35,7 +40,17 @@ bool Query::matchesLoc(const core::Loc &loc) const {
     // N.B.: Sorbet inserts zero-length Locs for items that are implicitly inserted during parsing.
     // Example: `foo` may be translated into `self.foo`, where `self.` has a 0-length loc.
     // We disregard these in LSP matches, as they don't correspond to source text that the user is pointing at.
-    return kind == Query::Kind::LOC && (loc.endPos() - loc.beginPos()) > 0 && loc.contains(this->loc);
+    if ((loc.endPos() - loc.beginPos()) == 0) {
+        return false;
+    }
+    switch (kind) {
+        case Query::Kind::LOC:
+            return loc.contains(this->loc);
+        case Query::Kind::FILE:
+            return loc.file() == this->loc.file();
+        default:
+            return false;
+    }
 }
 
 bool Query::matchesVar(const core::SymbolRef &owner, const core::LocalVariable &var) const {
@@ -3,6 +3,8 @@
 
 #include "core/Loc.h"
 #include "core/LocalVariable.h"
+#include <atomic>
+#include <memory>
 
 namespace sorbet::core::lsp {
 /**
@@ -16,6 +18,9 @@ public:
         NONE,
         // Looking for the item at a specific location.
         LOC,
+        // Looking for every item in a single file. Used to build per-file query indexes that can
+        // answer many LOC queries without re-running inference.
+        FILE,
         // Looking for all references to the given symbol.
         SYMBOL,
         // Looking for all references to the given variable.
@@ -28,9 +33,18 @@ public:
     // If Kind == VAR, this is the owner of the variable.
     core::SymbolRef symbol;
     core::LocalVariable variable;
+    // Cooperative cancellation flag of the LSP request this query serves, if any. Inference polls
+    // it at basic-block boundaries, so a query superseded by a newer request aborts mid-file
+    // instead of finishing a re-infer whose result nobody will read.
+    std::shared_ptr<const std::atomic<bool>> canceled;
+
+    bool isCanceled() const {
+        return canceled != nullptr && canceled->load(std::memory_order_relaxed);
+    }
 
     static Query noQuery();
     static Query createLocQuery(core::Loc loc);
+    static Query createFileQuery(core::FileRef file);
     static Query createSymbolQuery(core::SymbolRef symbol);
     static Query createVarQuery(core::SymbolRef owner, core::LocalVariable variable);
 
@@ -80,7 +80,36 @@ com::stripe::rubytyper::Symbol::ArgumentInfo Proto::toProto(const GlobalState &g
 
     return argProto;
 }
-com::stripe::rubytyper::Symbol Proto::toProto(const GlobalState &gs, SymbolRef sym, bool showFull) {
+namespace {
+// Mirrors the filtering toProto applies when recursing into members.
+bool skipMemberForPrinting(const GlobalState &gs, NameRef name, SymbolRef member, bool showFull) {
+    if (name == Names::singleton() || name == Names::attached() || name == Names::classMethods() ||
+        name == Names::Constants::AttachedClass()) {
+        return true;
+    }
+
+    if (!member.exists()) {
+        return true;
+    }
+
+    if (!showFull && member.data(gs)->isHiddenFromPrinting(gs)) {
+        bool hadPrintableChild = false;
+        for (auto childPair : member.data(gs)->members()) {
+            if (!childPair.second.data(gs)->isHiddenFromPrinting(gs)) {
+                hadPrintableChild = true;
+                break;
+            }
+        }
+        if (!hadPrintableChild) {
+            return true;
+        }
+    }
+
+    return false;
+}
+} // namespace
+
+com::stripe::rubytyper::Symbol Proto::toProtoNoChildren(const GlobalState &gs, SymbolRef sym) {
     com::stripe::rubytyper::Symbol symbolProto;
     const auto data = sym.data(gs);
 
@@ -123,27 +152,15 @@ com::stripe::rubytyper::Symbol Proto::toProto(const GlobalState &gs, SymbolRef s
         }
     }
 
-    for (auto pair : data->membersStableOrderSlow(gs)) {
-        if (pair.first == Names::singleton() || pair.first == Names::attached() ||
-            pair.first == Names::classMethods() || pair.first == Names::Constants::AttachedClass()) {
-            continue;
-        }
+    return symbolProto;
+}
 
-        if (!pair.second.exists()) {
-            continue;
-        }
+com::stripe::rubytyper::Symbol Proto::toProto(const GlobalState &gs, SymbolRef sym, bool showFull) {
+    auto symbolProto = toProtoNoChildren(gs, sym);
 
-        if (!showFull && pair.second.data(gs)->isHiddenFromPrinting(gs)) {
-            bool hadPrintableChild = false;
-            for (auto childPair : pair.second.data(gs)->members()) {
-                if (!childPair.second.data(gs)->isHiddenFromPrinting(gs)) {
-                    hadPrintableChild = true;
-                    break;
-                }
-            }
-            if (!hadPrintableChild) {
-                continue;
-            }
+    for (auto pair : sym.data(gs)->membersStableOrderSlow(gs)) {
+        if (skipMemberForPrinting(gs, pair.first, pair.second, showFull)) {
+            continue;
         }
 
         *symbolProto.add_children() = toProto(gs, pair.second, showFull);
@@ -152,6 +169,32 @@ com::stripe::rubytyper::Symbol Proto::toProto(const GlobalState &gs, SymbolRef s
     return symbolProto;
 }
 
+void Proto::streamSymbolTableProto(const GlobalState &gs, bool showFull, ostream &out) {
+    // Depth-first in the same stable order toProto nests children, but each symbol is serialized
+    // and written before its subtree is visited, so peak memory is one symbol's proto instead of
+    // the whole table.
+    vector<pair<SymbolRef, SymbolRef>> work;
+    work.emplace_back(Symbols::root(), Symbols::noSymbol());
+    while (!work.empty()) {
+        auto [sym, owner] = work.back();
+        work.pop_back();
+
+        com::stripe::rubytyper::MultiSymbol record;
+        auto &symbolProto = *record.add_symbol();
+        symbolProto = toProtoNoChildren(gs, sym);
+        symbolProto.set_owner(owner._id);
+        record.SerializeToOstream(&out);
+
+        auto members = sym.data(gs)->membersStableOrderSlow(gs);
+        for (auto it = members.rbegin(); it != members.rend(); ++it) {
+            if (skipMemberForPrinting(gs, it->first, it->second, showFull)) {
+                continue;
+            }
+            work.emplace_back(it->second, sym);
+        }
+    }
+}
+
 com::stripe::rubytyper::Type::Literal Proto::toProto(const GlobalState &gs, const LiteralType &lit) {
     com::stripe::rubytyper::Type::Literal proto;
 
@@ -21,6 +21,12 @@ public:
 
     static com::stripe::rubytyper::Symbol::ArgumentInfo toProto(const GlobalState &gs, const ArgInfo &arg);
     static com::stripe::rubytyper::Symbol toProto(const GlobalState &gs, SymbolRef sym, bool showFull);
+    // Like toProto, but leaves `children` empty; used by the streaming symbol table writer.
+    static com::stripe::rubytyper::Symbol toProtoNoChildren(const GlobalState &gs, SymbolRef sym);
+    // Writes the symbol table reachable from root as concatenated single-symbol MultiSymbol
+    // records, holding only one symbol's proto in memory at a time. Children carry their parent in
+    // `owner` instead of being nested, and appear in the same stable order toProto would visit.
+    static void streamSymbolTableProto(const GlobalState &gs, bool showFull, std::ostream &out);
 
     static com::stripe::rubytyper::Type::Literal toProto(const GlobalState &gs, const LiteralType &lit);
     static com::stripe::rubytyper::Type toProto(const GlobalState &gs, TypePtr typ);
@@ -8,26 +8,67 @@ class Pickler {
     std::vector<u1> data;
     u1 zeroCounter = 0;
 
+    // Terminates any pending zero run so that raw bytes can be appended to `data` directly.
+    void flushZeros() {
+        if (zeroCounter != 0) {
+            data.emplace_back(zeroCounter);
+            zeroCounter = 0;
+        }
+    }
+
 public:
     void putU4(u4 u);
     void putU1(const u1 u);
     void putS8(const int64_t i);
     void putStr(std::string_view s);
+    // Appends a fixed-width little-endian u4, bypassing the varint and zero-run encodings, and
+    // returns its byte offset so the value can be patched later via patchRawU4. Used for section
+    // offset headers, which are written before the sections they describe.
+    size_t putRawU4(u4 u);
+    void patchRawU4(size_t offset, u4 u);
+    // The current byte position. Flushes any pending zero run so the position is stable.
+    size_t tell();
     std::vector<u1> result(int compressionDegree);
     Pickler() = default;
+
+    // beginPos of the previously written expression-tree Loc. Tree Locs are delta-encoded against
+    // it because tree traversal order is roughly source order; see SerializerImpl::pickleTreeLoc.
+    u4 lastTreeLocBegin = 0;
 };
 
 class UnPickler {
     int pos;
     u1 zeroCounter = 0;
-    std::vector<u1> data;
+    // Shared rather than owned so that section readers created by atOffset (and name contents
+    // retained past the UnPickler; see releaseData) can outlive this reader without copying the
+    // decompressed buffer.
+    std::shared_ptr<const std::vector<u1>> data;
+
+    UnPickler(std::shared_ptr<const std::vector<u1>> data, int pos) : pos(pos), data(std::move(data)) {}
 
 public:
     u4 getU4();
     u1 getU1();
     int64_t getS8();
     std::string_view getStr();
+    // Reads a fixed-width u4 written by Pickler::putRawU4.
+    u4 getRawU4();
     explicit UnPickler(const u1 *const compressed, spdlog::logger &tracer);
+
+    // Creates a reader over the same decompressed buffer positioned at `offset`. Readers are
+    // independent, so sections with known offsets can be decoded concurrently.
+    UnPickler atOffset(u4 offset) const {
+        return UnPickler(data, offset);
+    }
+
+    // Shares ownership of the decompressed buffer so a caller can keep memory referenced by
+    // string_views handed out by getStr (e.g. UTF8 name contents) alive past the UnPickler itself.
+    std::shared_ptr<const std::vector<u1>> releaseData() {
+        return data;
+    }
+
+    // Mirror of Pickler::lastTreeLocBegin; see SerializerImpl::unpickleTreeLoc.
+    u4 lastTreeLocBegin = 0;
 };
 
 } // namespace sorbet::core::serialize
@@ -3,6 +3,7 @@
 #include "absl/types/span.h"
 #include "ast/Helpers.h"
 #include "common/Timer.h"
+#include "common/os/os.h"
 #include "common/sort.h"
 #include "common/typecase.h"
 #include "core/Error.h"
@@ -20,6 +21,7 @@ namespace sorbet::core::serialize {
 const u4 Serializer::VERSION;
 const u1 Serializer::GLOBAL_STATE_COMPRESSION_DEGREE;
 const u1 Serializer::FILE_COMPRESSION_DEGREE;
+const u1 Serializer::CACHED_TREE_COMPRESSION_DEGREE;
 
 // These helper methods are declared in a class inside of an anonymous namespace
 // or inline so that `GlobalState` can forward-declare and `friend` the entire
@@ -31,9 +33,10 @@ public:
     static void pickle(Pickler &p, const Name &what);
     static void pickle(Pickler &p, Type *what);
     static void pickle(Pickler &p, const ArgInfo &a);
-    static void pickle(Pickler &p, const Symbol &what);
+    static void pickle(Pickler &p, const GlobalState &gs, const Symbol &what);
     static void pickle(Pickler &p, FileRef file, const unique_ptr<ast::Expression> &what);
     static void pickle(Pickler &p, core::Loc loc);
+    static void pickleTreeLoc(Pickler &p, core::Loc loc);
 
     template <class T> static void pickleTree(Pickler &p, FileRef file, unique_ptr<T> &t);
 
@@ -44,6 +47,7 @@ public:
     static Symbol unpickleSymbol(UnPickler &p, GlobalState *gs);
     static void unpickleGS(UnPickler &p, GlobalState &result);
     static Loc unpickleLoc(UnPickler &p, FileRef file);
+    static Loc unpickleTreeLoc(UnPickler &p, FileRef file);
     static unique_ptr<ast::Expression> unpickleExpr(UnPickler &p, GlobalState &, FileRef file);
     static NameRef unpickleNameRef(UnPickler &p, GlobalState &);
 
@@ -56,18 +60,17 @@ private:
 void Pickler::putStr(string_view s) {
     putU4(s.size());
 
-    for (char c : s) {
-        putU1(absl::bit_cast<u1>(c));
-    }
+    // Bulk-copy the contents rather than looping through putU1: strings (file sources and UTF8 name
+    // contents) dominate the pickle by volume, and the per-byte zero-run bookkeeping is pure
+    // overhead for them. Produces byte-identical output to the old loop.
+    flushZeros();
+    data.insert(data.end(), s.begin(), s.end());
 }
 
 constexpr size_t SIZE_BYTES = sizeof(int) / sizeof(u1);
 
 vector<u1> Pickler::result(int compressionDegree) {
-    if (zeroCounter != 0) {
-        data.emplace_back(zeroCounter);
-        zeroCounter = 0;
-    }
+    flushZeros();
     const size_t maxDstSize = Lizard_compressBound(data.size());
     vector<u1> compressedData;
     compressedData.resize(2048 + maxDstSize); // give extra room for compression
@@ -98,34 +101,59 @@ UnPickler::UnPickler(const u1 *const compressed, spdlog::logger &tracer) : pos(0
     int uncompressedSize;
     memcpy(&uncompressedSize, compressed + SIZE_BYTES, SIZE_BYTES);
 
-    data.resize(uncompressedSize);
+    auto buf = make_shared<vector<u1>>();
+    buf->resize(uncompressedSize);
 
-    int resultCode = Lizard_decompress_safe((const char *)(compressed + 2 * SIZE_BYTES), (char *)this->data.data(),
+    int resultCode = Lizard_decompress_safe((const char *)(compressed + 2 * SIZE_BYTES), (char *)buf->data(),
                                             compressedSize, uncompressedSize);
     if (resultCode != uncompressedSize) {
         Exception::raise("incomplete decompression");
     }
+    data = std::move(buf);
 }
 
 string_view UnPickler::getStr() {
     int sz = getU4();
-    string_view result((char *)&data[pos], sz);
+    string_view result((const char *)&(*data)[pos], sz);
     pos += sz;
 
     return result;
 }
 
 void Pickler::putU1(u1 u) {
-    if (zeroCounter != 0) {
-        data.emplace_back(zeroCounter);
-        zeroCounter = 0;
-    }
+    flushZeros();
     data.emplace_back(u);
 }
 
 u1 UnPickler::getU1() {
     ENFORCE(zeroCounter == 0);
-    auto res = data[pos++];
+    auto res = (*data)[pos++];
+    return res;
+}
+
+size_t Pickler::putRawU4(u4 u) {
+    flushZeros();
+    auto offset = data.size();
+    data.resize(data.size() + sizeof(u4));
+    memcpy(data.data() + offset, &u, sizeof(u4));
+    return offset;
+}
+
+void Pickler::patchRawU4(size_t offset, u4 u) {
+    ENFORCE(offset + sizeof(u4) <= data.size());
+    memcpy(data.data() + offset, &u, sizeof(u4));
+}
+
+size_t Pickler::tell() {
+    flushZeros();
+    return data.size();
+}
+
+u4 UnPickler::getRawU4() {
+    ENFORCE(zeroCounter == 0);
+    u4 res;
+    memcpy(&res, data->data() + pos, sizeof(u4));
+    pos += sizeof(u4);
     return res;
 }
 
@@ -145,10 +173,7 @@ void Pickler::putU4(u4 u) {
             zeroCounter = 1;
         }
     } else {
-        if (zeroCounter != 0) {
-            data.emplace_back(zeroCounter);
-            zeroCounter = 0;
-        }
+        flushZeros();
         while (u > 127) {
             data.emplace_back(128 | (u & 127));
             u = u >> 7;
@@ -162,9 +187,9 @@ u4 UnPickler::getU4() {
         zeroCounter--;
         return 0;
     }
-    u1 r = data[pos++];
+    u1 r = (*data)[pos++];
     if (r == 0) {
-        zeroCounter = data[pos++];
+        zeroCounter = (*data)[pos++];
         zeroCounter--;
         return r;
     } else {
@@ -174,25 +199,25 @@ u4 UnPickler::getU4() {
             goto done;
         }
 
-        vle = data[pos++];
+        vle = (*data)[pos++];
         res |= (vle & 127) << 7;
         if ((vle & 128) == 0) {
             goto done;
         }
 
-        vle = data[pos++];
+        vle = (*data)[pos++];
         res |= (vle & 127) << 14;
         if ((vle & 128) == 0) {
             goto done;
         }
 
-        vle = data[pos++];
+        vle = (*data)[pos++];
         res |= (vle & 127) << 21;
         if ((vle & 128) == 0) {
             goto done;
         }
 
-        vle = data[pos++];
+        vle = (*data)[pos++];
         res |= (vle & 127) << 28;
         if ((vle & 128) == 0) {
             goto done;
@@ -205,19 +230,23 @@ u4 UnPickler::getU4() {
 
 void Pickler::putS8(const int64_t i) {
     auto u = absl::bit_cast<u8>(i);
+    // Emit the varint bytes directly; going through putU1 re-checks the zero-run state once per
+    // byte, which shows up on negative values (10 bytes each).
+    flushZeros();
     while (u > 127) {
-        putU1((u & 127) | 128);
+        data.emplace_back((u & 127) | 128);
         u = u >> 7;
     }
-    putU1(u & 127);
+    data.emplace_back(u & 127);
 }
 
 int64_t UnPickler::getS8() {
+    ENFORCE(zeroCounter == 0);
     u8 res = 0;
     u8 vle = 128;
     int i = 0;
     while (vle & 128) {
-        vle = getU1();
+        vle = (*data)[pos++];
         res |= (vle & 127) << (i * 7);
         i++;
     }
@@ -261,7 +290,9 @@ Name SerializerImpl::unpickleName(UnPickler &p, GlobalState &gs) {
     switch (result.kind) {
         case NameKind::UTF8:
             result.kind = NameKind::UTF8;
-            result.raw.utf8 = gs.enterString(p.getStr());
+            // Zero-copy: the view points into the UnPickler's decompressed buffer, which
+            // unpickleGS retains in the GlobalState rather than copying every name out of it.
+            result.raw.utf8 = p.getStr();
             break;
         case NameKind::UNIQUE:
             result.unique.uniqueNameKind = (UniqueNameKind)p.getU1();
@@ -355,17 +386,17 @@ TypePtr SerializerImpl::unpickleType(UnPickler &p, GlobalState *gs) {
             auto value = p.getS8();
             switch (kind) {
                 case LiteralType::LiteralTypeKind::Integer:
-                    return make_type<LiteralType>(value);
+                    return LiteralType::make_shared(value);
                 case LiteralType::LiteralTypeKind::Float:
-                    return make_type<LiteralType>(absl::bit_cast<double>(value));
+                    return LiteralType::make_shared(absl::bit_cast<double>(value));
                 case LiteralType::LiteralTypeKind::String:
-                    return make_type<LiteralType>(Symbols::String(), core::NameRef(NameRef::WellKnown{}, value));
+                    return LiteralType::make_shared(Symbols::String(), core::NameRef(NameRef::WellKnown{}, value));
                 case LiteralType::LiteralTypeKind::Symbol:
-                    return make_type<LiteralType>(Symbols::Symbol(), core::NameRef(NameRef::WellKnown{}, value));
+                    return LiteralType::make_shared(Symbols::Symbol(), core::NameRef(NameRef::WellKnown{}, value));
                 case LiteralType::LiteralTypeKind::True:
-                    return make_type<LiteralType>(true);
+                    return LiteralType::make_shared(true);
                 case LiteralType::LiteralTypeKind::False:
-                    return make_type<LiteralType>(false);
+                    return LiteralType::make_shared(false);
             }
             Exception::notImplemented();
         }
@@ -374,7 +405,7 @@ TypePtr SerializerImpl::unpickleType(UnPickler &p, GlobalState *gs) {
         case 5: {
             auto underlying = unpickleType(p, gs);
             int sz = p.getU4();
-            vector<TypePtr> elems(sz);
+            TypeElems elems(sz);
             for (auto &elem : elems) {
                 elem = unpickleType(p, gs);
             }
@@ -384,8 +415,8 @@ TypePtr SerializerImpl::unpickleType(UnPickler &p, GlobalState *gs) {
         case 6: {
             auto underlying = unpickleType(p, gs);
             int sz = p.getU4();
-            vector<TypePtr> keys(sz);
-            vector<TypePtr> values(sz);
+            TypeElems keys(sz);
+            TypeElems values(sz);
             for (auto &key : keys) {
                 key = unpickleType(p, gs);
             }
@@ -450,7 +481,7 @@ ArgInfo SerializerImpl::unpickleArgInfo(UnPickler &p, GlobalState *gs) {
     return result;
 }
 
-void SerializerImpl::pickle(Pickler &p, const Symbol &what) {
+void SerializerImpl::pickle(Pickler &p, const GlobalState &gs, const Symbol &what) {
     p.putU4(what.owner._id);
     p.putU4(what.name._id);
     p.putU4(what.superClassOrRebind._id);
@@ -486,8 +517,9 @@ void SerializerImpl::pickle(Pickler &p, const Symbol &what) {
     }
 
     pickle(p, what.resultType.get());
-    p.putU4(what.locs().size());
-    for (auto &loc : what.locs()) {
+    auto locs = what.locs(gs);
+    p.putU4(locs.size());
+    for (auto &loc : locs) {
         pickle(p, loc);
     }
 }
@@ -532,12 +564,22 @@ Symbol SerializerImpl::unpickleSymbol(UnPickler &p, GlobalState *gs) {
     }
     result.resultType = unpickleType(p, gs);
     auto locCount = p.getU4();
+    // Slices are rebuilt tightly packed: symbols are unpickled in table order, so each one's Locs
+    // land contiguously at the end of the pool, with no capacity slack and none of the garbage
+    // that addLoc's slice relocation may have left in the writer's pool.
+    auto &locPool = *gs->symbolLocs_;
+    result.locsBegin_ = locPool.size();
+    result.locsCount_ = locCount;
+    result.locsCapacity_ = locCount;
     for (int i = 0; i < locCount; i++) {
         core::Loc loc;
         auto low = p.getU4();
         auto high = p.getU4();
         loc.setFrom2u4(low, high);
-        result.locs_.emplace_back(loc);
+        locPool.emplace_back(loc);
+        if (i == 0) {
+            result.defLoc_ = loc;
+        }
     }
     return result;
 }
@@ -547,6 +589,13 @@ Pickler SerializerImpl::pickle(const GlobalState &gs, bool payloadOnly) {
     Pickler result;
     result.putU4(Serializer::VERSION);
 
+    // Fixed-width header of section byte offsets, patched once each section has been written.
+    // unpickleGS uses it to hand each section to its own reader and decode them concurrently.
+    auto filesOffsetSlot = result.putRawU4(0);
+    auto namesOffsetSlot = result.putRawU4(0);
+    auto symbolsOffsetSlot = result.putRawU4(0);
+    auto nameTableOffsetSlot = result.putRawU4(0);
+
     absl::Span<const shared_ptr<File>> wantFiles;
     if (payloadOnly) {
         auto lastPayload =
@@ -557,6 +606,7 @@ Pickler SerializerImpl::pickle(const GlobalState &gs, bool payloadOnly) {
         wantFiles = absl::Span<const shared_ptr<File>>(gs.files.data(), gs.files.size());
     }
 
+    result.patchRawU4(filesOffsetSlot, result.tell());
     result.putU4(wantFiles.size());
     int i = -1;
     for (auto &f : wantFiles) {
@@ -566,22 +616,25 @@ Pickler SerializerImpl::pickle(const GlobalState &gs, bool payloadOnly) {
         }
     }
 
-    result.putU4(gs.names.size());
+    result.patchRawU4(namesOffsetSlot, result.tell());
+    result.putU4(gs.nameTable().names.size());
     i = -1;
-    for (const Name &n : gs.names) {
+    for (const Name &n : gs.nameTable().names) {
         ++i;
         if (i != 0) {
             pickle(result, n);
         }
     }
 
-    result.putU4(gs.symbols.size());
-    for (const Symbol &s : gs.symbols) {
-        pickle(result, s);
+    result.patchRawU4(symbolsOffsetSlot, result.tell());
+    result.putU4(gs.symbols().size());
+    for (const Symbol &s : gs.symbols()) {
+        pickle(result, gs, s);
     }
 
-    result.putU4(gs.namesByHash.size());
-    for (const auto &s : gs.namesByHash) {
+    result.patchRawU4(nameTableOffsetSlot, result.tell());
+    result.putU4(gs.nameTable().namesByHash.size());
+    for (const auto &s : gs.nameTable().namesByHash) {
         result.putU4(s.first);
         result.putU4(s.second);
     }
@@ -605,63 +658,89 @@ void SerializerImpl::unpickleGS(UnPickler &p, GlobalState &result) {
 
     vector<shared_ptr<File>> files(std::move(result.files));
     files.clear();
-    vector<Name> names(std::move(result.names));
+    if (result.nameTable_.use_count() > 1) {
+        // The name table is shared with another GlobalState (see GlobalState::deepCopy). It is
+        // about to be overwritten wholesale, so detach with a fresh table rather than copying.
+        result.nameTable_ = make_shared<GlobalState::NameTable>();
+    }
+    vector<Name> names(std::move(result.nameTable_->names));
     names.clear();
-    vector<Symbol> symbols(std::move(result.symbols));
+    if (result.symbols_.use_count() > 1) {
+        // Same for the symbol table.
+        result.symbols_ = make_shared<vector<Symbol>>();
+    }
+    vector<Symbol> symbols(std::move(*result.symbols_));
     symbols.clear();
-    vector<pair<unsigned int, unsigned int>> namesByHash(std::move(result.namesByHash));
+    vector<pair<unsigned int, unsigned int>> namesByHash(std::move(result.nameTable_->namesByHash));
     namesByHash.clear();
-    {
-        Timer timeit(result.tracer(), "readFiles");
-
-        int filesSize = p.getU4();
-        files.reserve(filesSize);
-        for (int i = 0; i < filesSize; i++) {
-            if (i == 0) {
-                files.emplace_back();
-            } else {
-                files.emplace_back(unpickleFile(p));
-            }
-        }
-    }
 
-    {
-        Timer timeit(result.tracer(), "readNames");
-
-        int namesSize = p.getU4();
-        ENFORCE(namesSize > 0);
-        names.reserve(nearestPowerOf2(namesSize));
-        for (int i = 0; i < namesSize; i++) {
-            if (i == 0) {
-                auto &inserted = names.emplace_back();
-                inserted.kind = NameKind::UTF8;
-                inserted.raw.utf8 = string_view();
-            } else {
-                names.emplace_back(unpickleName(p, result));
-            }
-        }
-    }
-
-    {
-        Timer timeit(result.tracer(), "readSymbols");
-
-        int symbolSize = p.getU4();
-        ENFORCE(symbolSize > 0);
-        symbols.reserve(symbolSize);
-        for (int i = 0; i < symbolSize; i++) {
-            symbols.emplace_back(unpickleSymbol(p, &result));
-        }
-    }
+    auto filesReader = p.atOffset(p.getRawU4());
+    auto namesReader = p.atOffset(p.getRawU4());
+    auto symbolsReader = p.atOffset(p.getRawU4());
+    auto nameTableReader = p.atOffset(p.getRawU4());
 
     {
-        Timer timeit(result.tracer(), "readNameTable");
-        int namesByHashSize = p.getU4();
-        names.reserve(namesByHashSize / 2);
-        namesByHash.reserve(names.capacity() * 2);
-        for (int i = 0; i < namesByHashSize; i++) {
-            auto hash = p.getU4();
-            auto value = p.getU4();
-            namesByHash.emplace_back(make_pair(hash, value));
+        // The sections only read immutable metadata from `result` (globalStateId, deepCloneHistory)
+        // while building refs, so they can be decoded concurrently. Symbols are the largest section;
+        // decode them here while helper threads take the rest. The Joinables join on scope exit.
+        auto filesThread = runInAThread("unpickleFiles", [&filesReader, &files, &result]() {
+            Timer timeit(result.tracer(), "readFiles");
+
+            int filesSize = filesReader.getU4();
+            files.reserve(filesSize);
+            for (int i = 0; i < filesSize; i++) {
+                if (i == 0) {
+                    files.emplace_back();
+                } else {
+                    files.emplace_back(unpickleFile(filesReader));
+                }
+            }
+        });
+
+        auto namesThread =
+            runInAThread("unpickleNames", [&namesReader, &nameTableReader, &names, &namesByHash, &result]() {
+                {
+                    Timer timeit(result.tracer(), "readNames");
+
+                    int namesSize = namesReader.getU4();
+                    ENFORCE(namesSize > 0);
+                    names.reserve(nearestPowerOf2(namesSize));
+                    for (int i = 0; i < namesSize; i++) {
+                        if (i == 0) {
+                            auto &inserted = names.emplace_back();
+                            inserted.kind = NameKind::UTF8;
+                            inserted.raw.utf8 = string_view();
+                        } else {
+                            names.emplace_back(unpickleName(namesReader, result));
+                        }
+                    }
+                }
+
+                {
+                    Timer timeit(result.tracer(), "readNameTable");
+                    int namesByHashSize = nameTableReader.getU4();
+                    names.reserve(namesByHashSize / 2);
+                    namesByHash.reserve(names.capacity() * 2);
+                    for (int i = 0; i < namesByHashSize; i++) {
+                        auto hash = nameTableReader.getU4();
+                        auto value = nameTableReader.getU4();
+                        namesByHash.emplace_back(make_pair(hash, value));
+                    }
+                }
+            });
+
+        {
+            Timer timeit(result.tracer(), "readSymbols");
+
+            int symbolSize = symbolsReader.getU4();
+            ENFORCE(symbolSize > 0);
+            symbols.reserve(symbolSize);
+            // The unpickled symbols replace result's table wholesale below, so any Loc slices its
+            // current symbols hold are dead weight; drop them before appending the new ones.
+            result.symbolLocs_->clear();
+            for (int i = 0; i < symbolSize; i++) {
+                symbols.emplace_back(unpickleSymbol(symbolsReader, &result));
+            }
         }
     }
 
@@ -678,9 +757,14 @@ void SerializerImpl::unpickleGS(UnPickler &p, GlobalState &result) {
         Timer timeit(result.tracer(), "moving");
         result.fileRefByPath = std::move(fileRefByPath);
         result.files = std::move(files);
-        result.names = std::move(names);
-        result.symbols = std::move(symbols);
-        result.namesByHash = std::move(namesByHash);
+        result.nameTable_->names = std::move(names);
+        *result.symbols_ = std::move(symbols);
+        result.nameTable_->namesByHash = std::move(namesByHash);
+        // The pickled table stores raw slots; the control bytes that guide probing are derived
+        // state, recomputed from the slots' hashes.
+        result.rebuildNamesByHashTags();
+        // UTF8 name contents are views into the decompressed buffer; keep it alive.
+        result.retainedPayloads.emplace_back(p.releaseData());
     }
     result.sanityCheck();
 }
@@ -691,6 +775,32 @@ void SerializerImpl::pickle(Pickler &p, Loc loc) {
     p.putU4(high);
 }
 
+// Expression-tree Locs dominate cached-tree blob size when stored as absolute offsets. Since tree
+// traversal order is roughly source order, each Loc is stored as a zigzagged delta of its beginPos
+// against the previous tree Loc plus its length; both are usually tiny varints, and runs of
+// identical Locs (synthesized nodes) collapse into the zero-run encoding. The file id is not
+// stored at all: unpickling always stamps the tree's file onto every Loc, exactly as the absolute
+// encoding did.
+void SerializerImpl::pickleTreeLoc(Pickler &p, Loc loc) {
+    auto begin = loc.beginPos();
+    auto deltaBegin = static_cast<int32_t>(begin - p.lastTreeLocBegin);
+    auto deltaEnd = static_cast<int32_t>(loc.endPos() - begin);
+    p.putU4((static_cast<u4>(deltaBegin) << 1) ^ static_cast<u4>(deltaBegin >> 31));
+    p.putU4((static_cast<u4>(deltaEnd) << 1) ^ static_cast<u4>(deltaEnd >> 31));
+    p.lastTreeLocBegin = begin;
+}
+
+Loc SerializerImpl::unpickleTreeLoc(UnPickler &p, FileRef file) {
+    auto zigzagBegin = p.getU4();
+    auto zigzagEnd = p.getU4();
+    auto deltaBegin = static_cast<int32_t>((zigzagBegin >> 1) ^ (~(zigzagBegin & 1) + 1));
+    auto deltaEnd = static_cast<int32_t>((zigzagEnd >> 1) ^ (~(zigzagEnd & 1) + 1));
+    auto begin = p.lastTreeLocBegin + deltaBegin;
+    p.lastTreeLocBegin = begin;
+    Loc loc(file, begin, begin + deltaEnd);
+    return loc;
+}
+
 Loc SerializerImpl::unpickleLoc(UnPickler &p, FileRef file) {
     Loc loc;
     auto low = p.getU4();
@@ -711,11 +821,39 @@ vector<u1> Serializer::storePayloadAndNameTable(GlobalState &gs) {
     return p.result(GLOBAL_STATE_COMPRESSION_DEGREE);
 }
 
+void Serializer::pickleType(Pickler &p, const TypePtr &what) {
+    SerializerImpl::pickle(p, what.get());
+}
+
+TypePtr Serializer::unpickleType(UnPickler &p, const GlobalState &gs) {
+    // SerializerImpl::unpickleType only ever reads from gs (it constructs refs by id); its
+    // non-const signature is shared with the unpickleGS family, which does mutate.
+    return SerializerImpl::unpickleType(p, const_cast<GlobalState *>(&gs));
+}
+
+void Serializer::pickleLoc(Pickler &p, Loc loc) {
+    SerializerImpl::pickle(p, loc);
+}
+
+Loc Serializer::unpickleLoc(UnPickler &p, FileRef file) {
+    return SerializerImpl::unpickleLoc(p, file);
+}
+
 void Serializer::loadGlobalState(GlobalState &gs, const u1 *const data) {
-    ENFORCE(gs.files.empty() && gs.names.empty() && gs.symbols.empty(), "Can't load into a non-empty state");
+    ENFORCE(gs.files.empty() && gs.nameTable().names.empty() && gs.symbols().empty(),
+            "Can't load into a non-empty state");
+    UnPickler p(data, gs.tracer());
+    SerializerImpl::unpickleGS(p, gs);
+    gs.installIntrinsics();
+}
+
+void Serializer::overwriteGlobalState(GlobalState &gs, const u1 *const data) {
+    // unpickleGS replaces the tables wholesale, so the only difference from loadGlobalState is that
+    // we permit the state to be non-empty.
     UnPickler p(data, gs.tracer());
     SerializerImpl::unpickleGS(p, gs);
     gs.installIntrinsics();
+    gs.bumpSymbolTableGeneration();
 }
 
 template <class T> void SerializerImpl::pickleTree(Pickler &p, FileRef file, unique_ptr<T> &t) {
@@ -728,7 +866,7 @@ template <class T> void SerializerImpl::pickleTree(Pickler &p, FileRef file, uni
 
 void SerializerImpl::pickleAstHeader(Pickler &p, u1 tag, ast::Expression *tree) {
     p.putU1(tag);
-    pickle(p, tree->loc);
+    pickleTreeLoc(p, tree->loc);
 }
 
 void SerializerImpl::pickle(Pickler &p, FileRef file, const unique_ptr<ast::Expression> &what) {
@@ -850,7 +988,7 @@ void SerializerImpl::pickle(Pickler &p, FileRef file, const unique_ptr<ast::Expr
         [&](ast::EmptyTree *n) { pickleAstHeader(p, 20, n); },
         [&](ast::ClassDef *c) {
             pickleAstHeader(p, 21, c);
-            pickle(p, c->declLoc);
+            pickleTreeLoc(p, c->declLoc);
             p.putU1(c->kind);
             p.putU4(c->symbol._id);
             p.putU4(c->ancestors.size());
@@ -869,7 +1007,7 @@ void SerializerImpl::pickle(Pickler &p, FileRef file, const unique_ptr<ast::Expr
         },
         [&](ast::MethodDef *c) {
             pickleAstHeader(p, 22, c);
-            pickle(p, c->declLoc);
+            pickleTreeLoc(p, c->declLoc);
             p.putU4(c->flags);
             p.putU4(c->name._id);
             p.putU4(c->symbol._id);
@@ -939,7 +1077,7 @@ unique_ptr<ast::Expression> SerializerImpl::unpickleExpr(serialize::UnPickler &p
     if (kind == 1) {
         return nullptr;
     }
-    Loc loc = unpickleLoc(p, file);
+    Loc loc = unpickleTreeLoc(p, file);
 
     switch (kind) {
         case 2: {
@@ -1056,7 +1194,7 @@ unique_ptr<ast::Expression> SerializerImpl::unpickleExpr(serialize::UnPickler &p
             return ast::MK::EmptyTree();
         }
         case 21: {
-            auto declLoc = unpickleLoc(p, file);
+            auto declLoc = unpickleTreeLoc(p, file);
             auto kind = p.getU1();
             SymbolRef symbol(gs, p.getU4());
             auto ancestorsSize = p.getU4();
@@ -1082,7 +1220,7 @@ unique_ptr<ast::Expression> SerializerImpl::unpickleExpr(serialize::UnPickler &p
             return ret;
         }
         case 22: {
-            auto declLoc = unpickleLoc(p, file);
+            auto declLoc = unpickleTreeLoc(p, file);
             auto flags = p.getU4();
             NameRef name = unpickleNameRef(p, gs);
             SymbolRef symbol(gs, p.getU4());
@@ -1175,7 +1313,7 @@ vector<u1> Serializer::storeExpression(GlobalState &gs, unique_ptr<ast::Expressi
     serialize::Pickler pickler;
     pickler.putU4(e->loc.file().id());
     SerializerImpl::pickle(pickler, e->loc.file(), e);
-    return pickler.result(FILE_COMPRESSION_DEGREE);
+    return pickler.result(CACHED_TREE_COMPRESSION_DEGREE);
 }
 
 NameRef SerializerImpl::unpickleNameRef(UnPickler &p, GlobalState &gs) {
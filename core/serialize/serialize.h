@@ -2,15 +2,22 @@
 #define SORBET_SERIALIZE_H
 #include "ast/ast.h"
 #include "core/core.h"
+#include "core/serialize/pickler.h"
 
 namespace sorbet::core::serialize {
 class Serializer {
 public:
-    static const u4 VERSION = 4;
+    // Version 7: name hash table slots are placed by group probing, so older pickled tables would
+    // probe incorrectly if loaded.
+    static const u4 VERSION = 7;
     static const u1 GLOBAL_STATE_COMPRESSION_DEGREE =
         10; // >20 introduce decompression slowdown, >10 introduces compression slowdown
     static const u1 FILE_COMPRESSION_DEGREE =
         10; // >20 introduce decompression slowdown, >10 introduces compression slowdown
+    static const u1 CACHED_TREE_COMPRESSION_DEGREE =
+        20; // cache entries are written once per changed file but read on every warm run, so spend
+            // more effort compressing them; 20 is the strongest setting that does not slow
+            // decompression
 
     // Serialize a global state
     static std::vector<u1> store(GlobalState &gs);
@@ -26,6 +33,18 @@ public:
     // the saved file ID to the caller-specified ID.
     static std::unique_ptr<ast::Expression> loadExpression(GlobalState &gs, const u1 *const p, u4 forceId = 0);
     static void loadGlobalState(GlobalState &gs, const u1 *const data);
+
+    // Building blocks for other modules that embed types and locs inside their own pickle formats
+    // (currently the CFG cache in cfg/serialize). Locs are stored without their file; the caller
+    // supplies it when unpickling.
+    static void pickleType(Pickler &p, const TypePtr &what);
+    static TypePtr unpickleType(UnPickler &p, const GlobalState &gs);
+    static void pickleLoc(Pickler &p, Loc loc);
+    static Loc unpickleLoc(UnPickler &p, FileRef file);
+
+    // Like loadGlobalState, but replaces the file/name/symbol tables of a non-empty GlobalState,
+    // preserving its configuration fields. Used by the post-namer cache tier in the pipeline.
+    static void overwriteGlobalState(GlobalState &gs, const u1 *const data);
 };
 }; // namespace sorbet::core::serialize
 
@@ -358,14 +358,14 @@ TypePtr unwrapType(Context ctx, Loc loc, const TypePtr &tp) {
     }
 
     if (auto *shapeType = cast_type<ShapeType>(tp.get())) {
-        vector<TypePtr> unwrappedValues;
+        TypeElems unwrappedValues;
         unwrappedValues.reserve(shapeType->values.size());
         for (auto value : shapeType->values) {
             unwrappedValues.emplace_back(unwrapType(ctx, loc, value));
         }
         return make_type<ShapeType>(Types::hashOfUntyped(), shapeType->keys, unwrappedValues);
     } else if (auto *tupleType = cast_type<TupleType>(tp.get())) {
-        vector<TypePtr> unwrappedElems;
+        TypeElems unwrappedElems;
         unwrappedElems.reserve(tupleType->elems.size());
         for (auto elem : tupleType->elems) {
             unwrappedElems.emplace_back(unwrapType(ctx, loc, elem));
@@ -427,7 +427,7 @@ optional<core::AutocorrectSuggestion> maybeSuggestExtendTHelpers(core::Context c
     }
 
     auto inFileOfMethod = [&](const auto &loc) { return loc.file() == call.file(); };
-    auto classLocs = enclosingClass.data(ctx)->locs();
+    auto classLocs = enclosingClass.data(ctx)->locs(ctx);
     auto classLoc = absl::c_find_if(classLocs, inFileOfMethod);
 
     if (classLoc == classLocs.end()) {
@@ -456,6 +456,45 @@ optional<core::AutocorrectSuggestion> maybeSuggestExtendTHelpers(core::Context c
         {core::AutocorrectSuggestion::Edit{nextLineLoc.value(), fmt::format("{}extend T::Helpers\n", prefix)}}};
 }
 
+namespace {
+
+// Memoizes Symbol::findMemberTransitive for method dispatch. The ancestor walk re-runs for every
+// send, yet most sends in a codebase dispatch the same handful of (receiver class, method name)
+// pairs, so repeated dispatch collapses onto a single hash probe. Results depend only on the symbol
+// table, so the memo is invalidated whenever the GlobalState's symbolTableGeneration moves on; it is
+// consulted only here, during inference, when ancestors no longer mutate. Per-thread, bounded,
+// dropped wholesale when full. Negative results are cached too: probing a method that does not
+// exist walks the entire ancestor chain, making misses the most expensive lookups of all.
+struct DispatchMemberMemo {
+    static constexpr size_t MAX_ENTRIES = 32768;
+    unsigned int generation = 0;
+    UnorderedMap<std::pair<u4, int>, SymbolRef> entries;
+};
+thread_local DispatchMemberMemo dispatchMemberMemo;
+
+SymbolRef findMethodTransitiveCached(Context ctx, SymbolRef klass, NameRef name) {
+    auto &memo = dispatchMemberMemo;
+    if (memo.generation != ctx.state.symbolTableGeneration) {
+        memo.entries.clear();
+        memo.generation = ctx.state.symbolTableGeneration;
+    }
+    auto key = std::make_pair(klass._id, name.id());
+    auto it = memo.entries.find(key);
+    if (it != memo.entries.end()) {
+        categoryCounterInc("types.dispatch_member_memo", "hit");
+        return it->second;
+    }
+    categoryCounterInc("types.dispatch_member_memo", "miss");
+    auto result = klass.data(ctx)->findMemberTransitive(ctx, name);
+    if (memo.entries.size() >= DispatchMemberMemo::MAX_ENTRIES) {
+        memo.entries.clear();
+    }
+    memo.entries[key] = result;
+    return result;
+}
+
+} // namespace
+
 // This implements Ruby's argument matching logic (assigning values passed to a
 // method call to formal parameters of the method).
 //
@@ -477,7 +516,7 @@ DispatchResult dispatchCallSymbol(Context ctx, DispatchArgs args,
         return DispatchResult(Types::untypedUntracked(), std::move(args.selfType), Symbols::noSymbol());
     }
 
-    SymbolRef mayBeOverloaded = symbol.data(ctx)->findMemberTransitive(ctx, args.name);
+    SymbolRef mayBeOverloaded = findMethodTransitiveCached(ctx, symbol, args.name);
 
     if (!mayBeOverloaded.exists()) {
         if (args.name == Names::initialize()) {
@@ -519,7 +558,7 @@ DispatchResult dispatchCallSymbol(Context ctx, DispatchArgs args,
                 e.replaceWith("Wrap in `T.must`", args.locs.receiver, "T.must({})", args.locs.receiver.source(ctx));
             } else {
                 if (symbol.data(ctx)->isClassOrModuleModule()) {
-                    auto objMeth = core::Symbols::Object().data(ctx)->findMemberTransitive(ctx, args.name);
+                    auto objMeth = findMethodTransitiveCached(ctx, core::Symbols::Object(), args.name);
                     if (objMeth.exists() && objMeth.data(ctx)->owner.data(ctx)->isClassOrModuleModule()) {
                         e.addErrorSection(
                             ErrorSection(ErrorColors::format("Did you mean to `include {}` in this module?",
@@ -730,12 +769,9 @@ DispatchResult dispatchCallSymbol(Context ctx, DispatchArgs args,
                 }
                 ++kwit;
 
-                auto arg = absl::c_find_if(hash->keys, [&](const TypePtr &litType) {
-                    auto lit = cast_type<LiteralType>(litType.get());
-                    return cast_type<ClassType>(lit->underlying().get())->symbol == Symbols::Symbol() &&
-                           lit->value == spec.name._id;
-                });
-                if (arg == hash->keys.end()) {
+                LiteralType specKey(Symbols::Symbol(), spec.name);
+                auto argIdx = hash->indexForKey(specKey);
+                if (argIdx == -1) {
                     if (!spec.flags.isDefault) {
                         if (auto e = missingArg(ctx, args.locs.call, args.locs.receiver, method, spec)) {
                             result.main.errors.emplace_back(std::move(e));
@@ -746,8 +782,7 @@ DispatchResult dispatchCallSymbol(Context ctx, DispatchArgs args,
                 consumed.insert(spec.name);
                 TypeAndOrigins tpe;
                 tpe.origins = args.args.back()->origins;
-                auto offset = arg - hash->keys.begin();
-                tpe.type = hash->values[offset];
+                tpe.type = hash->values[argIdx];
                 if (auto e = matchArgType(ctx, *constr, args.locs.call, args.locs.receiver, symbol, method, tpe, spec,
                                           args.selfType, targs, Loc::none())) {
                     result.main.errors.emplace_back(std::move(e));
@@ -914,14 +949,14 @@ DispatchResult AppliedType::dispatchCall(Context ctx, DispatchArgs args) {
 }
 
 TypePtr getMethodArguments(Context ctx, SymbolRef klass, NameRef name, const vector<TypePtr> &targs) {
-    SymbolRef method = klass.data(ctx)->findMemberTransitive(ctx, name);
+    SymbolRef method = findMethodTransitiveCached(ctx, klass, name);
 
     if (!method.exists()) {
         return nullptr;
     }
     const SymbolData data = method.data(ctx);
 
-    vector<TypePtr> args;
+    TypeElems args;
     args.reserve(data->arguments().size());
     for (const auto &arg : data->arguments()) {
         if (arg.flags.isRepeated) {
@@ -1226,8 +1261,8 @@ public:
 
                 ++it;
             } else if (attachedClass == Symbols::Hash() && i == 2) {
-                auto tupleArgs = targs;
-                targs.emplace_back(TupleType::build(ctx, tupleArgs));
+                TypeElems tupleArgs(targs.begin(), targs.end());
+                targs.emplace_back(TupleType::build(ctx, move(tupleArgs)));
             } else {
                 targs.emplace_back(Types::untypedUntracked());
             }
@@ -1242,8 +1277,8 @@ public:
     void apply(Context ctx, DispatchArgs args, const Type *thisType, DispatchResult &res) const override {
         ENFORCE(args.args.size() % 2 == 0);
 
-        vector<TypePtr> keys;
-        vector<TypePtr> values;
+        TypeElems keys;
+        TypeElems values;
         keys.reserve(args.args.size() / 2);
         values.reserve(args.args.size() / 2);
         for (int i = 0; i < args.args.size(); i += 2) {
@@ -1267,7 +1302,7 @@ public:
             res.returnType = Types::arrayOfUntyped();
             return;
         }
-        vector<TypePtr> elems;
+        TypeElems elems;
         elems.reserve(args.args.size());
         bool isType = absl::c_any_of(args.args, [ctx](auto ty) { return isa_type<MetaType>(ty->type.get()); });
         int i = -1;
@@ -1301,7 +1336,7 @@ class Magic_expandSplat : public IntrinsicMethod {
             // can't say anything about the elements.
             return type;
         }
-        vector<TypePtr> types;
+        TypeElems types;
         if (tuple) {
             types.insert(types.end(), tuple->elems.begin(), tuple->elems.end());
         } else {
@@ -1824,7 +1859,7 @@ public:
 class Tuple_concat : public IntrinsicMethod {
 public:
     void apply(Context ctx, DispatchArgs args, const Type *thisType, DispatchResult &res) const override {
-        vector<TypePtr> elems;
+        TypeElems elems;
         auto *tuple = cast_type<TupleType>(thisType);
         ENFORCE(tuple);
         elems = tuple->elems;
@@ -1956,7 +1991,7 @@ public:
 class Array_product : public IntrinsicMethod {
 public:
     void apply(Context ctx, DispatchArgs args, const Type *thisType, DispatchResult &res) const override {
-        vector<TypePtr> unwrappedElems;
+        TypeElems unwrappedElems;
         unwrappedElems.reserve(args.args.size() + 1);
 
         if (auto *ap = cast_type<AppliedType>(thisType)) {
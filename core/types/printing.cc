@@ -19,6 +19,48 @@ string buildTabs(int count) {
     return res;
 }
 
+// Memoizes `show` output for composite types. LSP hover stringifies the same types on every query
+// and error rendering does it thousands of times per run; with OrType/AndType interned (see
+// types.cc), repeated queries arrive at identical pointers. Entries pin their key type alive, so a
+// key can neither dangle nor be reused while cached. Output depends on symbol names, so the memo
+// is invalidated whenever the GlobalState's symbolTableGeneration moves on. Per-thread, bounded,
+// dropped wholesale when full.
+struct ShowMemo {
+    static constexpr size_t MAX_ENTRIES = 8192;
+    struct Entry {
+        TypePtr type;
+        string printed;
+    };
+    unsigned int generation = 0;
+    UnorderedMap<const Type *, Entry> entries;
+
+    const string *fetch(const GlobalState &gs, const Type *type) {
+        if (generation != gs.symbolTableGeneration) {
+            entries.clear();
+            generation = gs.symbolTableGeneration;
+            return nullptr;
+        }
+        auto it = entries.find(type);
+        if (it == entries.end()) {
+            categoryCounterInc("types.show_memo", "miss");
+            return nullptr;
+        }
+        categoryCounterInc("types.show_memo", "hit");
+        return &it->second.printed;
+    }
+
+    const string &store(const Type *type, string printed) {
+        if (entries.size() >= MAX_ENTRIES) {
+            entries.clear();
+        }
+        auto &entry = entries[type];
+        entry.type = TypePtr(const_cast<Type *>(type));
+        entry.printed = move(printed);
+        return entry.printed;
+    }
+};
+thread_local ShowMemo showMemo;
+
 } // namespace
 
 string ClassType::toStringWithTabs(const GlobalState &gs, int tabs) const {
@@ -90,8 +132,12 @@ string TupleType::toStringWithTabs(const GlobalState &gs, int tabs) const {
 }
 
 string TupleType::show(const GlobalState &gs) const {
-    return fmt::format("[{}]",
-                       fmt::map_join(this->elems, ", ", [&](const auto &el) -> string { return el->show(gs); }));
+    if (const auto *cached = showMemo.fetch(gs, this)) {
+        return *cached;
+    }
+    return showMemo.store(
+        this, fmt::format("[{}]",
+                          fmt::map_join(this->elems, ", ", [&](const auto &el) -> string { return el->show(gs); })));
 }
 
 string TupleType::showWithMoreInfo(const GlobalState &gs) const {
@@ -114,6 +160,9 @@ string ShapeType::toStringWithTabs(const GlobalState &gs, int tabs) const {
 }
 
 string ShapeType::show(const GlobalState &gs) const {
+    if (const auto *cached = showMemo.fetch(gs, this)) {
+        return *cached;
+    }
     fmt::memory_buffer buf;
     fmt::format_to(buf, "{{");
     auto valueIterator = this->values.begin();
@@ -134,7 +183,7 @@ string ShapeType::show(const GlobalState &gs) const {
         ++valueIterator;
     }
     fmt::format_to(buf, "}}");
-    return to_string(buf);
+    return showMemo.store(this, to_string(buf));
 }
 
 string AliasType::toStringWithTabs(const GlobalState &gs, int tabs) const {
@@ -155,7 +204,10 @@ string AndType::toStringWithTabs(const GlobalState &gs, int tabs) const {
 }
 
 string AndType::show(const GlobalState &gs) const {
-    return fmt::format("T.all({}, {})", this->left->show(gs), this->right->show(gs));
+    if (const auto *cached = showMemo.fetch(gs, this)) {
+        return *cached;
+    }
+    return showMemo.store(this, fmt::format("T.all({}, {})", this->left->show(gs), this->right->show(gs)));
 }
 
 string OrType::toStringWithTabs(const GlobalState &gs, int tabs) const {
@@ -268,12 +320,15 @@ pair<OrInfo, optional<string>> showOrs(const GlobalState &gs, TypePtr left, Type
 }
 
 string OrType::show(const GlobalState &gs) const {
+    if (const auto *cached = showMemo.fetch(gs, this)) {
+        return *cached;
+    }
     auto [info, str] = showOrs(gs, this->left, this->right);
 
     // If str is empty at this point, all of the types present in the flattened
     // OrType are NilClass.
     if (!str.has_value()) {
-        return Symbols::NilClass().show(gs);
+        return showMemo.store(this, Symbols::NilClass().show(gs));
     }
 
     string res;
@@ -286,9 +341,9 @@ string OrType::show(const GlobalState &gs) const {
     }
 
     if (info.containsNil) {
-        return fmt::format("T.nilable({})", res);
+        return showMemo.store(this, fmt::format("T.nilable({})", res));
     } else {
-        return res;
+        return showMemo.store(this, move(res));
     }
 }
 
@@ -326,6 +381,9 @@ string AppliedType::toStringWithTabs(const GlobalState &gs, int tabs) const {
 }
 
 string AppliedType::show(const GlobalState &gs) const {
+    if (const auto *cached = showMemo.fetch(gs, this)) {
+        return *cached;
+    }
     fmt::memory_buffer buf;
     if (this->klass == Symbols::Array()) {
         fmt::format_to(buf, "T::Array");
@@ -366,7 +424,7 @@ string AppliedType::show(const GlobalState &gs) const {
             }
 
             fmt::format_to(buf, ".returns({})", return_type->show(gs));
-            return to_string(buf);
+            return showMemo.store(this, to_string(buf));
         } else {
             fmt::format_to(buf, "{}", this->klass.data(gs)->show(gs));
         }
@@ -392,7 +450,7 @@ string AppliedType::show(const GlobalState &gs) const {
     if (!targs.empty()) {
         fmt::format_to(buf, "[{}]", fmt::map_join(targs, ", ", [&](auto targ) { return targ->show(gs); }));
     }
-    return to_string(buf);
+    return showMemo.store(this, to_string(buf));
 }
 
 string LambdaParam::toStringWithTabs(const GlobalState &gs, int tabs) const {
@@ -12,8 +12,68 @@ using namespace std;
 
 TypePtr lubGround(Context ctx, const TypePtr &t1, const TypePtr &t2);
 
+namespace {
+
+// Counts the leaves of an OrType tree, giving up as soon as the count exceeds `limit` so that
+// checking a capped union stays O(limit) no matter how the tree is shaped.
+int orArmCount(const TypePtr &t, int limit) {
+    auto *o = cast_type<OrType>(t.get());
+    if (o == nullptr) {
+        return 1;
+    }
+    int n = orArmCount(o->left, limit);
+    if (n > limit) {
+        return n;
+    }
+    return n + orArmCount(o->right, limit - n);
+}
+
+// Picks a class whose ancestor chain widenHugeUnion walks looking for an upper bound of the whole
+// union. Any arm works; we take the leftmost one that names a class.
+SymbolRef widenGuardRepresentative(Context ctx, const TypePtr &t) {
+    if (auto *o = cast_type<OrType>(t.get())) {
+        return widenGuardRepresentative(ctx, o->left);
+    }
+    if (auto *p = cast_type<ProxyType>(t.get())) {
+        return widenGuardRepresentative(ctx, p->underlying());
+    }
+    if (auto *c = cast_type<ClassType>(t.get())) {
+        return c->symbol;
+    }
+    if (auto *a = cast_type<AppliedType>(t.get())) {
+        return a->klass;
+    }
+    return Symbols::noSymbol();
+}
+
+// Guard against pathological union growth: case-heavy code can accumulate unions with hundreds of
+// arms, and every later subtyping walk over such a union is quadratic. Once a union exceeds
+// lubUnionWidenThreshold arms we give up on precision and collapse it to the nearest class that is
+// a supertype of every arm, falling back to `top` when no such class exists (e.g. when an arm is
+// not a class type at all).
+TypePtr widenHugeUnion(Context ctx, const TypePtr &t) {
+    counterInc("lub.union_widen_guard.fired");
+    auto candidate = widenGuardRepresentative(ctx, t);
+    while (candidate.exists()) {
+        auto candidateType = candidate.data(ctx)->externalType(ctx);
+        if (Types::isSubType(ctx, t, candidateType)) {
+            categoryCounterInc("lub.union_widen_guard.outcome", "class");
+            return candidateType;
+        }
+        candidate = candidate.data(ctx)->superClass();
+    }
+    categoryCounterInc("lub.union_widen_guard.outcome", "top");
+    return Types::top();
+}
+
+} // namespace
+
 TypePtr Types::any(Context ctx, const TypePtr &t1, const TypePtr &t2) {
     auto ret = lub(ctx, t1, t2);
+    int threshold = ctx.state.lubUnionWidenThreshold;
+    if (threshold > 0 && isa_type<OrType>(ret.get()) && orArmCount(ret, threshold) > threshold) {
+        ret = widenHugeUnion(ctx, ret);
+    }
     ENFORCE(Types::isSubType(ctx, t1, ret), "\n{}\nis not a super type of\n{}\nwas lubbing with {}", ret->toString(ctx),
             t1->toString(ctx), t2->toString(ctx));
     ENFORCE(Types::isSubType(ctx, t2, ret), "\n{}\nis not a super type of\n{}\nwas lubbing with {}", ret->toString(ctx),
@@ -264,7 +324,7 @@ TypePtr Types::lub(Context ctx, const TypePtr &t1, const TypePtr &t2) {
                 [&](TupleType *a1) { // Warning: this implements COVARIANT arrays
                     if (auto *a2 = cast_type<TupleType>(p2)) {
                         if (a1->elems.size() == a2->elems.size()) { // lub arrays only if they have same element count
-                            vector<TypePtr> elemLubs;
+                            TypeElems elemLubs;
                             int i = -1;
                             bool differ1 = false;
                             bool differ2 = false;
@@ -293,24 +353,17 @@ TypePtr Types::lub(Context ctx, const TypePtr &t1, const TypePtr &t2) {
                         if (h2->keys.size() == h1->keys.size()) {
                             // have enough keys.
                             int i = -1;
-                            vector<TypePtr> valueLubs;
+                            TypeElems valueLubs;
                             valueLubs.reserve(h2->keys.size());
                             bool differ1 = false;
                             bool differ2 = false;
                             for (auto &el2 : h2->keys) {
                                 ++i;
                                 auto el2l = cast_type<LiteralType>(el2.get());
-                                auto *u2 = cast_type<ClassType>(el2l->underlying().get());
-                                ENFORCE(u2 != nullptr);
-                                auto fnd = absl::c_find_if(h1->keys, [&](auto &candidate) -> bool {
-                                    auto el1l = cast_type<LiteralType>(candidate.get());
-                                    ClassType *u1 = cast_type<ClassType>(el1l->underlying().get());
-                                    return el1l->value == el2l->value && u1->symbol == u2->symbol; // from lambda
-                                });
-                                if (fnd != h1->keys.end()) {
-                                    auto &inserted = valueLubs.emplace_back(
-                                        lub(ctx, h1->values[fnd - h1->keys.begin()], h2->values[i]));
-                                    differ1 = differ1 || inserted != h1->values[fnd - h1->keys.begin()];
+                                auto fnd = h1->indexForKey(*el2l);
+                                if (fnd != -1) {
+                                    auto &inserted = valueLubs.emplace_back(lub(ctx, h1->values[fnd], h2->values[i]));
+                                    differ1 = differ1 || inserted != h1->values[fnd];
                                     differ2 = differ2 || inserted != h2->values[i];
                                 } else {
                                     result = Types::hashOfUntyped();
@@ -616,7 +669,7 @@ TypePtr Types::glb(Context ctx, const TypePtr &t1, const TypePtr &t2) {
                     auto *a2 = cast_type<TupleType>(p2);
                     ENFORCE(a2 != nullptr);
                     if (a1->elems.size() == a2->elems.size()) { // lub arrays only if they have same element count
-                        vector<TypePtr> elemGlbs;
+                        TypeElems elemGlbs;
                         elemGlbs.reserve(a2->elems.size());
 
                         int i = -1;
@@ -647,22 +700,16 @@ TypePtr Types::glb(Context ctx, const TypePtr &t1, const TypePtr &t2) {
                     if (h2->keys.size() == h1->keys.size()) {
                         // have enough keys.
                         int i = -1;
-                        vector<TypePtr> valueLubs;
+                        TypeElems valueLubs;
                         valueLubs.reserve(h2->keys.size());
                         bool canReuseT1 = true;
                         bool canReuseT2 = true;
                         for (auto &el2 : h2->keys) {
                             ++i;
                             auto el2l = cast_type<LiteralType>(el2.get());
-                            auto *u2 = cast_type<ClassType>(el2l->underlying().get());
-                            ENFORCE(u2 != nullptr);
-                            auto fnd = absl::c_find_if(h1->keys, [&](auto &candidate) -> bool {
-                                auto el1l = cast_type<LiteralType>(candidate.get());
-                                ClassType *u1 = cast_type<ClassType>(el1l->underlying().get());
-                                return el1l->value == el2l->value && u1->symbol == u2->symbol; // from lambda
-                            });
-                            if (fnd != h1->keys.end()) {
-                                auto left = h1->values[fnd - h1->keys.begin()];
+                            auto fnd = h1->indexForKey(*el2l);
+                            if (fnd != -1) {
+                                auto left = h1->values[fnd];
                                 auto right = h2->values[i];
                                 auto glbe = glb(ctx, left, right);
                                 if (glbe->isBottom()) {
@@ -1138,16 +1185,9 @@ bool isSubTypeUnderConstraintSingle(Context ctx, TypeConstraint &constr, Untyped
                     for (auto &el2 : h2->keys) {
                         ++i;
                         auto el2l = cast_type<LiteralType>(el2.get());
-                        auto *u2 = cast_type<ClassType>(el2l->underlying().get());
-                        ENFORCE(u2 != nullptr);
-                        auto fnd = absl::c_find_if(h1->keys, [&](auto &candidate) -> bool {
-                            auto el1l = cast_type<LiteralType>(candidate.get());
-                            ClassType *u1 = cast_type<ClassType>(el1l->underlying().get());
-                            return el1l->value == el2l->value && u1->symbol == u2->symbol; // from lambda
-                        });
-                        result = fnd != h1->keys.end() &&
-                                 Types::isSubTypeUnderConstraint(ctx, constr, h1->values[fnd - h1->keys.begin()],
-                                                                 h2->values[i], mode);
+                        auto fnd = h1->indexForKey(*el2l);
+                        result = fnd != -1 &&
+                                 Types::isSubTypeUnderConstraint(ctx, constr, h1->values[fnd], h2->values[i], mode);
                         if (!result) {
                             return;
                         }
@@ -1195,12 +1235,64 @@ bool isSubTypeUnderConstraintSingle(Context ctx, TypeConstraint &constr, Untyped
     }
 }
 
+namespace {
+
+// Memoizes constraint-free subtyping queries. Infer asks the same (left, right) questions endlessly,
+// especially in generic-heavy code; with OrType/AndType interned (see types.cc), identical queries
+// collapse onto identical pointer pairs. Entries pin their key types alive, so keys can neither
+// dangle nor be reused while cached. Results depend on the symbol table, so the memo is invalidated
+// whenever the GlobalState's symbolTableGeneration moves on. Per-thread, bounded, dropped wholesale
+// when full.
+struct SubtypeMemo {
+    static constexpr size_t MAX_ENTRIES = 32768;
+    struct Entry {
+        TypePtr t1;
+        TypePtr t2;
+        bool result;
+    };
+    unsigned int generation = 0;
+    UnorderedMap<std::tuple<Type *, Type *, u1>, Entry> entries;
+};
+thread_local SubtypeMemo subtypeMemo;
+
+bool isSubTypeUnderConstraintUncached(Context ctx, TypeConstraint &constr, const TypePtr &t1, const TypePtr &t2,
+                                      UntypedMode mode);
+
+} // namespace
+
 bool Types::isSubTypeUnderConstraint(Context ctx, TypeConstraint &constr, const TypePtr &t1, const TypePtr &t2,
                                      UntypedMode mode) {
     if (t1.get() == t2.get()) {
         return true;
     }
+    if (!constr.isEmpty()) {
+        // Under a non-trivial constraint the answer depends on (and may record into) the
+        // constraint's state, so it must not be memoized.
+        return isSubTypeUnderConstraintUncached(ctx, constr, t1, t2, mode);
+    }
+    auto &memo = subtypeMemo;
+    if (memo.generation != ctx.state.symbolTableGeneration) {
+        memo.entries.clear();
+        memo.generation = ctx.state.symbolTableGeneration;
+    }
+    auto key = std::make_tuple(t1.get(), t2.get(), static_cast<u1>(mode));
+    auto it = memo.entries.find(key);
+    if (it != memo.entries.end()) {
+        categoryCounterInc("types.subtype_memo", "hit");
+        return it->second.result;
+    }
+    categoryCounterInc("types.subtype_memo", "miss");
+    auto result = isSubTypeUnderConstraintUncached(ctx, constr, t1, t2, mode);
+    if (memo.entries.size() >= SubtypeMemo::MAX_ENTRIES) {
+        memo.entries.clear();
+    }
+    memo.entries[key] = SubtypeMemo::Entry{t1, t2, result};
+    return result;
+}
 
+namespace {
+bool isSubTypeUnderConstraintUncached(Context ctx, TypeConstraint &constr, const TypePtr &t1, const TypePtr &t2,
+                                      UntypedMode mode) {
     // pairs to cover: 1  (_, _)
     //                 2  (_, And)
     //                 3  (_, Or)
@@ -1269,6 +1361,7 @@ bool Types::isSubTypeUnderConstraint(Context ctx, TypeConstraint &constr, const
 
     return isSubTypeUnderConstraintSingle(ctx, constr, mode, t1, t2); // 1
 }
+} // namespace
 
 bool Types::equiv(Context ctx, const TypePtr &t1, const TypePtr &t2) {
     return isSubType(ctx, t1, t2) && isSubType(ctx, t2, t1);
@@ -9,14 +9,87 @@
 using namespace std;
 namespace sorbet::core {
 
+namespace {
+
+// Memoizes generic instantiation. Collection-heavy code dispatches the same dozen generic
+// signatures millions of times — every `T::Array[String]` call site re-substitutes the same member
+// types with the same type arguments — and with composite types interned (see types.cc), repeat
+// instantiations collapse onto identical (type, params, targs) keys. Keys are reduced to one hash;
+// entries keep the full key for collision checks and pin their key and result types alive.
+// Substituted results mention symbols, so the memo is invalidated whenever the GlobalState's
+// symbolTableGeneration moves on. Per-thread, bounded, dropped wholesale when full.
+struct InstantiateMemo {
+    static constexpr size_t MAX_ENTRIES = 16384;
+    struct Entry {
+        TypePtr what;
+        InlinedVector<SymbolRef, 4> params;
+        vector<TypePtr> targs;
+        TypePtr result;
+    };
+    unsigned int generation = 0;
+    UnorderedMap<u8, Entry> entries;
+
+    static u8 key(const TypePtr &what, const InlinedVector<SymbolRef, 4> &params, const vector<TypePtr> &targs) {
+        u8 res = reinterpret_cast<uintptr_t>(what.get());
+        for (auto param : params) {
+            res = res * HASH_MULT + param._id;
+        }
+        for (auto &targ : targs) {
+            res = res * HASH_MULT + reinterpret_cast<uintptr_t>(targ.get());
+        }
+        return res;
+    }
+
+    static bool matches(const Entry &entry, const TypePtr &what, const InlinedVector<SymbolRef, 4> &params,
+                        const vector<TypePtr> &targs) {
+        if (entry.what.get() != what.get() || entry.params.size() != params.size() ||
+            entry.targs.size() != targs.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < params.size(); i++) {
+            if (entry.params[i] != params[i]) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < targs.size(); i++) {
+            if (entry.targs[i].get() != targs[i].get()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+thread_local InstantiateMemo instantiateMemo;
+
+} // namespace
+
 TypePtr Types::instantiate(Context ctx, const TypePtr &what, const InlinedVector<SymbolRef, 4> &params,
                            const vector<TypePtr> &targs) {
     ENFORCE(what.get());
+    // Leaf types that can never mention a type member bail out of _instantiate immediately; caching
+    // them would only churn the memo.
+    if (isa_type<ClassType>(what.get()) || isa_type<LiteralType>(what.get())) {
+        return what;
+    }
+    auto &memo = instantiateMemo;
+    if (memo.generation != ctx.state.symbolTableGeneration) {
+        memo.entries.clear();
+        memo.generation = ctx.state.symbolTableGeneration;
+    }
+    auto key = InstantiateMemo::key(what, params, targs);
+    auto it = memo.entries.find(key);
+    if (it != memo.entries.end() && InstantiateMemo::matches(it->second, what, params, targs)) {
+        categoryCounterInc("types.instantiate_memo", "hit");
+        return it->second.result;
+    }
+    categoryCounterInc("types.instantiate_memo", "miss");
     auto t = what->_instantiate(ctx, params, targs);
-    if (t) {
-        return t;
+    auto ret = t != nullptr ? t : what;
+    if (memo.entries.size() >= InstantiateMemo::MAX_ENTRIES) {
+        memo.entries.clear();
     }
-    return what;
+    memo.entries[key] = InstantiateMemo::Entry{what, params, targs, ret};
+    return ret;
 }
 
 TypePtr Types::instantiate(Context ctx, const TypePtr &what, const TypeConstraint &tc) {
@@ -72,7 +145,7 @@ TypePtr LiteralType::_instantiate(Context ctx, const InlinedVector<SymbolRef, 4>
 
 TypePtr TupleType::_instantiate(Context ctx, const InlinedVector<SymbolRef, 4> &params, const vector<TypePtr> &targs) {
     bool changed = false;
-    vector<TypePtr> newElems;
+    TypeElems newElems;
     newElems.reserve(this->elems.size());
     for (auto &a : this->elems) {
         auto t = a->_instantiate(ctx, params, targs);
@@ -99,7 +172,7 @@ TypePtr TupleType::_instantiate(Context ctx, const InlinedVector<SymbolRef, 4> &
 
 TypePtr TupleType::_instantiate(Context ctx, const TypeConstraint &tc) {
     bool changed = false;
-    vector<TypePtr> newElems;
+    TypeElems newElems;
     newElems.reserve(this->elems.size());
     for (auto &a : this->elems) {
         auto t = a->_instantiate(ctx, tc);
@@ -126,7 +199,7 @@ TypePtr TupleType::_instantiate(Context ctx, const TypeConstraint &tc) {
 
 TypePtr TupleType::_approximate(Context ctx, const TypeConstraint &tc) {
     bool changed = false;
-    vector<TypePtr> newElems;
+    TypeElems newElems;
     newElems.reserve(this->elems.size());
     for (auto &a : this->elems) {
         auto t = a->_approximate(ctx, tc);
@@ -153,7 +226,7 @@ TypePtr TupleType::_approximate(Context ctx, const TypeConstraint &tc) {
 
 TypePtr ShapeType::_instantiate(Context ctx, const InlinedVector<SymbolRef, 4> &params, const vector<TypePtr> &targs) {
     bool changed = false;
-    vector<TypePtr> newValues;
+    TypeElems newValues;
     newValues.reserve(this->values.size());
     for (auto &a : this->values) {
         auto t = a->_instantiate(ctx, params, targs);
@@ -180,7 +253,7 @@ TypePtr ShapeType::_instantiate(Context ctx, const InlinedVector<SymbolRef, 4> &
 
 TypePtr ShapeType::_instantiate(Context ctx, const TypeConstraint &tc) {
     bool changed = false;
-    vector<TypePtr> newValues;
+    TypeElems newValues;
     newValues.reserve(this->values.size());
     for (auto &a : this->values) {
         auto t = a->_instantiate(ctx, tc);
@@ -207,7 +280,7 @@ TypePtr ShapeType::_instantiate(Context ctx, const TypeConstraint &tc) {
 
 TypePtr ShapeType::_approximate(Context ctx, const TypeConstraint &tc) {
     bool changed = false;
-    vector<TypePtr> newValues;
+    TypeElems newValues;
     newValues.reserve(this->values.size());
     for (auto &a : this->values) {
         auto t = a->_approximate(ctx, tc);
@@ -1,6 +1,7 @@
 #include "core/Types.h"
 #include "absl/base/casts.h"
 #include "common/common.h"
+#include "common/sort.h"
 #include "common/typecase.h"
 #include "core/Context.h"
 #include "core/GlobalState.h"
@@ -12,7 +13,6 @@
 #include "core/Types.h"
 
 // improve debugging.
-template class std::shared_ptr<sorbet::core::Type>;
 template class std::shared_ptr<sorbet::core::TypeConstraint>;
 template class std::shared_ptr<sorbet::core::SendAndBlockLink>;
 template class std::vector<sorbet::core::Loc>;
@@ -33,25 +33,69 @@ TypePtr Types::dispatchCallWithoutBlock(Context ctx, const TypePtr &recv, Dispat
     return move(dispatched.returnType);
 }
 
-TypePtr::TypePtr(shared_ptr<Type> &&store) : store(move(store)){};
+void TypePtr::incRef(Type *ptr) noexcept {
+    auto &counter = ptr->refcount;
+    if (counter.load(std::memory_order_relaxed) == Type::IMMORTAL_REFCOUNT) {
+        return;
+    }
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TypePtr::decRef(Type *ptr) noexcept {
+    auto &counter = ptr->refcount;
+    if (counter.load(std::memory_order_relaxed) == Type::IMMORTAL_REFCOUNT) {
+        return;
+    }
+    if (counter.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete ptr;
+    }
+}
+
+void TypePtr::markImmortal() const {
+    ENFORCE(store != nullptr);
+    store->refcount.store(Type::IMMORTAL_REFCOUNT, std::memory_order_relaxed);
+}
+
+void TypePtr::atomicInitializeFromNull(TypePtr desired) {
+    // `store` is a plain pointer, but competing initializers may race here; resolve the race with an atomic
+    // compare-exchange directly on the slot. This mirrors what `atomic_compare_exchange_weak` on a
+    // `shared_ptr` member did before TypePtr became intrusive.
+    static_assert(sizeof(std::atomic<Type *>) == sizeof(Type *), "atomic pointers must not add storage");
+    static_assert(std::atomic<Type *>::is_always_lock_free, "atomic pointers must be lock-free");
+    Type *expected = nullptr;
+    auto *slot = reinterpret_cast<std::atomic<Type *> *>(&store);
+    if (slot->compare_exchange_strong(expected, desired.store)) {
+        // The reference held by `desired` has been transferred into `this`.
+        desired.store = nullptr;
+    }
+}
+
+namespace {
+// The singletons below live for the whole process and are copied constantly from every thread; marking them
+// immortal makes those copies free of atomic traffic.
+TypePtr immortal(TypePtr type) {
+    type.markImmortal();
+    return type;
+}
+} // namespace
 
 TypePtr Types::top() {
-    static auto res = make_type<ClassType>(Symbols::top());
+    static auto res = immortal(make_type<ClassType>(Symbols::top()));
     return res;
 }
 
 TypePtr Types::bottom() {
-    static auto res = make_type<ClassType>(Symbols::bottom());
+    static auto res = immortal(make_type<ClassType>(Symbols::bottom()));
     return res;
 }
 
 TypePtr Types::nilClass() {
-    static auto res = make_type<ClassType>(Symbols::NilClass());
+    static auto res = immortal(make_type<ClassType>(Symbols::NilClass()));
     return res;
 }
 
 TypePtr Types::untypedUntracked() {
-    static auto res = make_type<ClassType>(Symbols::untyped());
+    static auto res = immortal(make_type<ClassType>(Symbols::untyped()));
     return res;
 }
 
@@ -64,79 +108,79 @@ TypePtr Types::untyped(const sorbet::core::GlobalState &gs, sorbet::core::Symbol
 }
 
 TypePtr Types::void_() {
-    static auto res = make_type<ClassType>(Symbols::void_());
+    static auto res = immortal(make_type<ClassType>(Symbols::void_()));
     return res;
 }
 
 TypePtr Types::trueClass() {
-    static auto res = make_type<ClassType>(Symbols::TrueClass());
+    static auto res = immortal(make_type<ClassType>(Symbols::TrueClass()));
     return res;
 }
 
 TypePtr Types::falseClass() {
-    static auto res = make_type<ClassType>(Symbols::FalseClass());
+    static auto res = immortal(make_type<ClassType>(Symbols::FalseClass()));
     return res;
 }
 
 TypePtr Types::Boolean() {
-    static auto res = OrType::make_shared(trueClass(), falseClass());
+    static auto res = immortal(OrType::make_shared(trueClass(), falseClass()));
     return res;
 }
 
 TypePtr Types::Integer() {
-    static auto res = make_type<ClassType>(Symbols::Integer());
+    static auto res = immortal(make_type<ClassType>(Symbols::Integer()));
     return res;
 }
 
 TypePtr Types::Float() {
-    static auto res = make_type<ClassType>(Symbols::Float());
+    static auto res = immortal(make_type<ClassType>(Symbols::Float()));
     return res;
 }
 
 TypePtr Types::arrayOfUntyped() {
     static vector<TypePtr> targs{Types::untypedUntracked()};
-    static auto res = make_type<AppliedType>(Symbols::Array(), targs);
+    static auto res = immortal(make_type<AppliedType>(Symbols::Array(), targs));
     return res;
 }
 
 TypePtr Types::hashOfUntyped() {
     static vector<TypePtr> targs{Types::untypedUntracked(), Types::untypedUntracked(), Types::untypedUntracked()};
-    static auto res = make_type<AppliedType>(Symbols::Hash(), targs);
+    static auto res = immortal(make_type<AppliedType>(Symbols::Hash(), targs));
     return res;
 }
 
 TypePtr Types::procClass() {
-    static auto res = make_type<ClassType>(Symbols::Proc());
+    static auto res = immortal(make_type<ClassType>(Symbols::Proc()));
     return res;
 }
 
 TypePtr Types::classClass() {
-    static auto res = make_type<ClassType>(Symbols::Class());
+    static auto res = immortal(make_type<ClassType>(Symbols::Class()));
     return res;
 }
 
 TypePtr Types::declBuilderForProcsSingletonClass() {
-    static auto res = make_type<ClassType>(Symbols::DeclBuilderForProcsSingleton());
+    static auto res = immortal(make_type<ClassType>(Symbols::DeclBuilderForProcsSingleton()));
     return res;
 }
 
 TypePtr Types::String() {
-    static auto res = make_type<ClassType>(Symbols::String());
+    static auto res = immortal(make_type<ClassType>(Symbols::String()));
     return res;
 }
 
 TypePtr Types::Symbol() {
-    static auto res = make_type<ClassType>(Symbols::Symbol());
+    static auto res = immortal(make_type<ClassType>(Symbols::Symbol()));
     return res;
 }
 
 TypePtr Types::Object() {
-    static auto res = make_type<ClassType>(Symbols::Object());
+    static auto res = immortal(make_type<ClassType>(Symbols::Object()));
     return res;
 }
 
 TypePtr Types::falsyTypes() {
-    static auto res = OrType::make_shared(Types::nilClass(), Types::falseClass());
+    static auto res = immortal(OrType::make_shared(Types::nilClass(), Types::falseClass()));
     return res;
 }
 
@@ -261,7 +305,7 @@ TypePtr Types::dropLiteral(const TypePtr &tp) {
     return tp;
 }
 
-TypePtr Types::lubAll(Context ctx, vector<TypePtr> &elements) {
+TypePtr Types::lubAll(Context ctx, const TypeElems &elements) {
     TypePtr acc = Types::bottom();
     for (auto &el : elements) {
         acc = Types::lub(ctx, acc, el);
@@ -275,7 +319,7 @@ TypePtr Types::arrayOf(Context ctx, const TypePtr &elem) {
 }
 
 TypePtr Types::hashOf(Context ctx, const TypePtr &elem) {
-    vector<TypePtr> tupleArgs{Types::Symbol(), elem};
+    TypeElems tupleArgs{Types::Symbol(), elem};
     vector<TypePtr> targs{Types::Symbol(), elem, TupleType::build(ctx, tupleArgs)};
     return make_type<AppliedType>(Symbols::Hash(), targs);
 }
@@ -356,12 +400,12 @@ TypePtr LiteralType::underlying() const {
     Exception::raise("should never be reached");
 }
 
-TupleType::TupleType(TypePtr underlying, vector<TypePtr> elements)
+TupleType::TupleType(TypePtr underlying, TypeElems elements)
     : elems(move(elements)), underlying_(std::move(underlying)) {
     categoryCounterInc("types.allocated", "tupletype");
 }
 
-TypePtr TupleType::build(Context ctx, vector<TypePtr> elements) {
+TypePtr TupleType::build(Context ctx, TypeElems elements) {
     TypePtr underlying = Types::arrayOf(ctx, Types::dropLiteral(Types::lubAll(ctx, elements)));
     return make_type<TupleType>(move(underlying), move(elements));
 }
@@ -397,10 +441,74 @@ ShapeType::ShapeType() : underlying_(Types::hashOfUntyped()) {
     categoryCounterInc("types.allocated", "shapetype");
 }
 
-ShapeType::ShapeType(TypePtr underlying, vector<TypePtr> keys, vector<TypePtr> values)
+namespace {
+
+// Below this many keys a linear scan beats a binary search, and the side table is not built.
+constexpr size_t SORTED_KEY_LOOKUP_THRESHOLD = 8;
+
+// Three-way comparison on literal identity: underlying class first, then value bits. The order is
+// arbitrary but total; it only exists so that equal keys land in one spot of the side table.
+int literalKeyCmp(const LiteralType &lhs, const LiteralType &rhs) {
+    auto lklass = cast_type<ClassType>(lhs.underlying().get())->symbol;
+    auto rklass = cast_type<ClassType>(rhs.underlying().get())->symbol;
+    if (lklass != rklass) {
+        return lklass._id < rklass._id ? -1 : 1;
+    }
+    if (lhs.value != rhs.value) {
+        return lhs.value < rhs.value ? -1 : 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+ShapeType::ShapeType(TypePtr underlying, TypeElems keys, TypeElems values)
     : keys(move(keys)), values(move(values)), underlying_(std::move(underlying)) {
     DEBUG_ONLY(for (auto &k : this->keys) { ENFORCE(cast_type<LiteralType>(k.get()) != nullptr); };);
     categoryCounterInc("types.allocated", "shapetype");
+    if (this->keys.size() >= SORTED_KEY_LOOKUP_THRESHOLD) {
+        InlinedVector<u4, 32> order;
+        order.reserve(this->keys.size());
+        for (u4 i = 0; i < this->keys.size(); i++) {
+            order.emplace_back(i);
+        }
+        fast_sort(order, [&](u4 l, u4 r) -> bool {
+            return literalKeyCmp(*cast_type<LiteralType>(this->keys[l].get()),
+                                 *cast_type<LiteralType>(this->keys[r].get())) < 0;
+        });
+        auto table = make_unique<u4[]>(order.size());
+        absl::c_copy(order, table.get());
+        this->sortedKeyOrder_ = move(table);
+    }
+}
+
+int ShapeType::indexForKey(const LiteralType &lit) const {
+    if (this->sortedKeyOrder_ == nullptr) {
+        int i = -1;
+        for (auto &key : this->keys) {
+            i++;
+            if (cast_type<LiteralType>(key.get())->equals(lit)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    const u4 *order = this->sortedKeyOrder_.get();
+    size_t lo = 0;
+    size_t hi = this->keys.size();
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        auto cmp = literalKeyCmp(*cast_type<LiteralType>(this->keys[order[mid]].get()), lit);
+        if (cmp == 0) {
+            return order[mid];
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
 }
 
 TypePtr ShapeType::underlying() const {
@@ -742,9 +850,80 @@ bool OrType::hasUntyped() {
     return left->hasUntyped() || right->hasUntyped();
 }
 
+namespace {
+
+// Hash-consing for binary composite types. The same unions and intersections (T.nilable(String)
+// being the canonical offender) are built millions of times per run; interning them makes
+// structurally identical composites share one object, so repeated subtyping walks hit the same
+// pointers and resident memory shrinks. Keys are the children's addresses: an entry keeps its
+// children alive through the composite it stores, so a key can never dangle or be reused while the
+// entry exists. The cache is per-thread to stay lock-free, and is dropped wholesale when full.
+class ComposedTypeCache final {
+    static constexpr size_t MAX_ENTRIES = 16384;
+    UnorderedMap<std::pair<Type *, Type *>, TypePtr> entries;
+
+public:
+    // `makeType` constructs the composed type on a miss; it is a callback because OrType's and AndType's
+    // constructors are private to their own `make_shared`.
+    template <class Factory>
+    TypePtr fetchOrMake(const TypePtr &left, const TypePtr &right, ConstExprStr category, Factory makeType) {
+        auto key = std::make_pair(left.get(), right.get());
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            categoryCounterInc(category, "hit");
+            return it->second;
+        }
+        categoryCounterInc(category, "miss");
+        if (entries.size() >= MAX_ENTRIES) {
+            entries.clear();
+        }
+        TypePtr res = makeType();
+        entries[key] = res;
+        return res;
+    }
+};
+
+thread_local ComposedTypeCache orTypeCache;
+thread_local ComposedTypeCache andTypeCache;
+
+// Hash-consing for symbol and string literal types, keyed by (class, name). The same literals
+// (symbol keys like `:id` flowing out of prop defaults and hash literals) are stamped out millions
+// of times per run; like composites above, interned literals share one object per distinct value.
+// Entries hold no references into any GlobalState — a LiteralType stores only raw ids — so the
+// cache never dangles across GlobalState copies. Per-thread to stay lock-free, dropped when full.
+class NamedLiteralCache final {
+    static constexpr size_t MAX_ENTRIES = 16384;
+    UnorderedMap<std::pair<u4, int>, TypePtr> entries;
+
+public:
+    TypePtr fetchOrMake(SymbolRef klass, NameRef name) {
+        auto key = std::make_pair(klass._id, name.id());
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            categoryCounterInc("types.intern.literal", "hit");
+            return it->second;
+        }
+        categoryCounterInc("types.intern.literal", "miss");
+        if (entries.size() >= MAX_ENTRIES) {
+            entries.clear();
+        }
+        TypePtr res = make_type<LiteralType>(klass, name);
+        entries[key] = res;
+        return res;
+    }
+};
+
+thread_local NamedLiteralCache namedLiteralCache;
+
+// Small non-negative integer literals get a fixed immortal pool instead: the values are dense
+// (array indices, prop defaults, tuple arities), so a direct lookup beats hashing.
+constexpr int64_t SMALL_INT_POOL_SIZE = 256;
+
+} // namespace
+
 TypePtr OrType::make_shared(const TypePtr &left, const TypePtr &right) {
-    TypePtr res(new OrType(left, right));
-    return res;
+    return orTypeCache.fetchOrMake(left, right, "types.intern.or",
+                                   [&]() { return TypePtr(new OrType(left, right)); });
 }
 
 bool AndType::hasUntyped() {
@@ -752,8 +931,39 @@ bool AndType::hasUntyped() {
 }
 
 TypePtr AndType::make_shared(const TypePtr &left, const TypePtr &right) {
-    TypePtr res(new AndType(left, right));
-    return res;
+    return andTypeCache.fetchOrMake(left, right, "types.intern.and",
+                                    [&]() { return TypePtr(new AndType(left, right)); });
+}
+
+TypePtr LiteralType::make_shared(int64_t val) {
+    if (val >= 0 && val < SMALL_INT_POOL_SIZE) {
+        static const auto pool = [] {
+            vector<TypePtr> p;
+            p.reserve(SMALL_INT_POOL_SIZE);
+            for (int64_t i = 0; i < SMALL_INT_POOL_SIZE; i++) {
+                p.emplace_back(immortal(make_type<LiteralType>(i)));
+            }
+            return p;
+        }();
+        return pool[val];
+    }
+    return make_type<LiteralType>(val);
+}
+
+TypePtr LiteralType::make_shared(double val) {
+    // Float literals are rare and not profitably pooled; the factory exists so call sites can
+    // build every literal kind the same way.
+    return make_type<LiteralType>(val);
+}
+
+TypePtr LiteralType::make_shared(SymbolRef klass, NameRef val) {
+    return namedLiteralCache.fetchOrMake(klass, val);
+}
+
+TypePtr LiteralType::make_shared(bool val) {
+    static auto trueLit = immortal(make_type<LiteralType>(true));
+    static auto falseLit = immortal(make_type<LiteralType>(false));
+    return val ? trueLit : falseLit;
 }
 
 bool AppliedType::hasUntyped() {
@@ -6,6 +6,7 @@
 
 #include "absl/algorithm/container.h"
 
+#include "definition_validator/validator.h"
 #include "definition_validator/variance.h"
 
 using namespace std;
@@ -311,7 +312,7 @@ void validateOverriding(const core::Context ctx, core::SymbolRef method) {
                 e.addErrorLine(overridenMethod.data(ctx)->loc(), "original method defined here");
             }
         }
-        auto isRBI = absl::c_any_of(method.data(ctx)->locs(), [&](auto &loc) { return loc.file().data(ctx).isRBI(); });
+        auto isRBI = absl::c_any_of(method.data(ctx)->locs(ctx), [&](auto &loc) { return loc.file().data(ctx).isRBI(); });
         if (!method.data(ctx)->isOverride() && method.data(ctx)->hasSig() &&
             overridenMethod.data(ctx)->isOverridable() && !anyIsInterface && overridenMethod.data(ctx)->hasSig() &&
             !method.data(ctx)->isRewriterSynthesized() && !isRBI) {
@@ -460,10 +461,11 @@ void validateSealed(const core::GlobalState &gs, const core::SymbolRef klass,
 
 class ValidateWalk {
 private:
-    UnorderedMap<core::SymbolRef, vector<core::SymbolRef>> abstractCache;
+    ValidatorCache &cache;
 
     const vector<core::SymbolRef> &getAbstractMethods(const core::GlobalState &gs, core::SymbolRef klass) {
         vector<core::SymbolRef> abstract;
+        auto &abstractCache = cache.abstractMethods;
         auto ent = abstractCache.find(klass);
         if (ent != abstractCache.end()) {
             return ent->second;
@@ -546,6 +548,8 @@ private:
     }
 
 public:
+    ValidateWalk(ValidatorCache &cache) : cache(cache) {}
+
     unique_ptr<ast::ClassDef> preTransformClassDef(core::Context ctx, unique_ptr<ast::ClassDef> classDef) {
         auto sym = classDef->symbol;
         auto singleton = sym.data(ctx)->lookupSingletonClass(ctx);
@@ -575,10 +579,10 @@ public:
     }
 };
 
-ast::ParsedFile runOne(core::Context ctx, ast::ParsedFile tree) {
+ast::ParsedFile runOne(core::Context ctx, ast::ParsedFile tree, ValidatorCache &cache) {
     Timer timeit(ctx.state.tracer(), "validateSymbols");
 
-    ValidateWalk validate;
+    ValidateWalk validate(cache);
     tree.tree = ast::TreeMap::apply(ctx, validate, std::move(tree.tree));
     return tree;
 }
@@ -8,7 +8,16 @@
 
 namespace sorbet::definition_validator {
 
-ast::ParsedFile runOne(core::Context ctx, ast::ParsedFile tree);
+// Caches the ancestor abstract-method lists computed while validating. Validation runs per file,
+// but deep hierarchies share ancestors across many files, so callers that validate several files
+// (the typechecking workers) pass one cache for all of them. Entries stay valid for a whole
+// typecheck run because the symbol table is frozen during it; the cache must not outlive the run.
+// Not thread-safe: each worker owns its own.
+struct ValidatorCache {
+    UnorderedMap<core::SymbolRef, std::vector<core::SymbolRef>> abstractMethods;
+};
+
+ast::ParsedFile runOne(core::Context ctx, ast::ParsedFile tree, ValidatorCache &cache);
 
 } // namespace sorbet::definition_validator
 
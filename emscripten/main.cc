@@ -1,5 +1,6 @@
 #include "main/lsp/wrapper.h"
 #include "main/realmain.h"
+#include "payload/payload.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -11,6 +12,14 @@
 using namespace std;
 
 extern "C" {
+// Registers the serialized stdlib payload fetched by the embedding page. The wasm module does not
+// embed the payload (see BUILD), which keeps it small enough that streaming compilation finishes
+// while the payload downloads in parallel; the page must call this before the first `typecheck`
+// or `lsp` call. The buffer is owned by the JavaScript side and must stay allocated.
+void EMSCRIPTEN_KEEPALIVE loadPayload(const unsigned char *data) {
+    sorbet::payload::setExternalNameTablePayload(data);
+}
+
 void EMSCRIPTEN_KEEPALIVE typecheck(const char *rubySrc) {
     const char *argv[] = {"sorbet", "--color=always", "--silence-dev-message", "-e", rubySrc};
     sorbet::realmain::realmain(size(argv), const_cast<char **>(argv));
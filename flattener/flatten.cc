@@ -54,11 +54,45 @@ unique_ptr<ast::Expression> extractClassInit(core::Context ctx, unique_ptr<ast::
     return ast::MK::InsSeq(klass->declLoc, std::move(inits), ast::MK::EmptyTree());
 }
 
+// Counts how many definitions the flattening walk below will hoist into each scope, so that
+// FlattenWalk can reserve its collection vectors up front. On DSL-heavy files with thousands of
+// generated defs per class, growing those vectors def-by-def makes reallocation (and the element
+// moves it implies) a disproportionate share of flattening time.
+class CountingWalk {
+public:
+    u4 totalClasses = 0;
+    // Number of methods hoisted into each class's scope, keyed by the ClassDef. Methods nested
+    // inside other methods count towards the innermost enclosing class. The nullptr key covers
+    // methods outside any class, which desugared trees never produce.
+    UnorderedMap<const ast::ClassDef *, u4> methodCounts;
+
+    unique_ptr<ast::ClassDef> preTransformClassDef(core::Context ctx, unique_ptr<ast::ClassDef> classDef) {
+        totalClasses++;
+        classStack.emplace_back(classDef.get());
+        return classDef;
+    }
+
+    unique_ptr<ast::ClassDef> postTransformClassDef(core::Context ctx, unique_ptr<ast::ClassDef> classDef) {
+        classStack.pop_back();
+        return classDef;
+    }
+
+    unique_ptr<ast::MethodDef> preTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> methodDef) {
+        methodCounts[classStack.empty() ? nullptr : classStack.back()]++;
+        return methodDef;
+    }
+
+private:
+    vector<const ast::ClassDef *> classStack;
+};
+
 class FlattenWalk {
 private:
 public:
-    FlattenWalk() {
+    FlattenWalk(const CountingWalk &counts) : counts(counts) {
         newMethodSet();
+        curMethodSet().methods.reserve(hoistedMethodCount(nullptr));
+        classes.reserve(counts.totalClasses);
     }
     ~FlattenWalk() {
         ENFORCE(methodScopes.empty());
@@ -73,6 +107,11 @@ public:
 
         auto inits = extractClassInit(ctx, classDef);
 
+        // +1 for the <static-init> synthesized below, which is hoisted like any other method.
+        auto hoisted = hoistedMethodCount(classDef.get()) + 1;
+        curMethodSet().methods.reserve(hoisted);
+        classDef->rhs.reserve(classDef->rhs.size() + hoisted + 1);
+
         core::SymbolRef sym;
         auto loc = classDef->declLoc;
         if (classDef->symbol == core::Symbols::root()) {
@@ -153,7 +192,9 @@ public:
             return ast::MK::InsSeq(tree->loc, std::move(stats), std::move(tree));
         }
 
-        for (auto &clas : sortedClasses()) {
+        auto sorted = sortedClasses();
+        insSeq->stats.reserve(insSeq->stats.size() + sorted.size());
+        for (auto &clas : sorted) {
             ENFORCE(!!clas);
             insSeq->stats.emplace_back(std::move(clas));
         }
@@ -179,7 +220,9 @@ public:
             return addMethods(ctx, std::move(tree));
         }
 
-        for (auto &method : popCurMethodDefs()) {
+        auto defs = popCurMethodDefs();
+        insSeq->stats.reserve(insSeq->stats.size() + defs.size());
+        for (auto &method : defs) {
             ENFORCE(!!method);
             insSeq->stats.emplace_back(std::move(method));
         }
@@ -187,6 +230,11 @@ public:
     }
 
 private:
+    u4 hoistedMethodCount(const ast::ClassDef *classDef) const {
+        auto it = counts.methodCounts.find(classDef);
+        return it == counts.methodCounts.end() ? 0 : it->second;
+    }
+
     vector<unique_ptr<ast::ClassDef>> sortedClasses() {
         ENFORCE(classStack.empty());
         auto ret = std::move(classes);
@@ -244,13 +292,16 @@ private:
     // `methodScopes.stack`, which we push onto in the `preTransform* hook, and
     // pop from in the `postTransform` hook.
 
+    const CountingWalk &counts;
     vector<Methods> methodScopes;
     vector<unique_ptr<ast::ClassDef>> classes;
     vector<int> classStack;
 };
 
 ast::ParsedFile runOne(core::Context ctx, ast::ParsedFile tree) {
-    FlattenWalk flatten;
+    CountingWalk counts;
+    tree.tree = ast::TreeMap::apply(ctx, counts, std::move(tree.tree));
+    FlattenWalk flatten(counts);
     tree.tree = ast::TreeMap::apply(ctx, flatten, std::move(tree.tree));
     tree.tree = flatten.addClasses(ctx, std::move(tree.tree));
     tree.tree = flatten.addMethods(ctx, std::move(tree.tree));
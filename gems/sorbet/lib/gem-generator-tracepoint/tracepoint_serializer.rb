@@ -5,6 +5,7 @@ require_relative '../serialize'
 require_relative '../real_stdlib'
 
 require 'set'
+require 'etc'
 require 'fileutils'
 require 'delegate'
 
@@ -26,6 +27,10 @@ module Sorbet::Private
 
       HEADER = Sorbet::Private::Serialize.header('true', 'gems')
 
+      # Each worker numbers the anonymous classes it encounters from a disjoint range so that files
+      # written by different workers can never both define Anonymous_Foo_1.
+      ANONYMOUS_ID_STRIDE = 1_000_000
+
       T::Sig::WithoutRuntime.sig {params(files: T::Hash, delegate_classes: T::Hash).void}
       def initialize(files:, delegate_classes:)
         @files = files
@@ -41,6 +46,44 @@ module Sorbet::Private
 
         FileUtils.mkdir_p(output_dir) unless gem_class_defs.empty?
 
+        batches = partition(gem_class_defs, worker_count(gem_class_defs.size))
+        if batches.size <= 1
+          batches.each {|batch| serialize_batch(output_dir, batch)}
+          return
+        end
+
+        # Every worker inherits the preprocessed class definitions through fork, so the traced
+        # symbol universe is built exactly once; the workers only generate and write their slice of
+        # the per-gem files.
+        pids = batches.each_with_index.map do |batch, i|
+          Process.fork do
+            @prev_anonymous_id = i * ANONYMOUS_ID_STRIDE
+            serialize_batch(output_dir, batch)
+          end
+        end
+        statuses = pids.map {|pid| Process.wait2(pid)[1]}
+        failed = statuses.reject(&:success?)
+        raise "#{failed.size} RBI generation worker(s) failed" unless failed.empty?
+      end
+
+      private
+
+      def worker_count(gem_count)
+        return 1 unless Process.respond_to?(:fork)
+        workers = ENV['SRB_GEM_RBI_WORKERS'].to_i
+        workers = Etc.nprocessors if workers <= 0
+        [workers, gem_count].min
+      end
+
+      def partition(gem_class_defs, workers)
+        batches = Array.new([workers, 1].max) {{}}
+        gem_class_defs.each_with_index do |(gem, klass_ids), i|
+          batches[i % batches.size][gem] = klass_ids
+        end
+        batches.reject(&:empty?)
+      end
+
+      def serialize_batch(output_dir, gem_class_defs)
         gem_class_defs.each do |gem, klass_ids|
           File.open("#{File.join(output_dir, gem[:gem])}.rbi", 'w') do |f|
             f.write(HEADER)
@@ -87,8 +130,6 @@ module Sorbet::Private
         end
       end
 
-      private
-
       def preprocess(files)
         gem_class_defs = files_to_gem_class_defs(files)
         filter_unused(gem_class_defs)
@@ -49,7 +49,7 @@ optional<core::AutocorrectSuggestion::Edit> maybeSuggestExtendTSig(core::Context
     }
 
     auto inFileOfMethod = [&](const auto &loc) { return loc.file() == method->loc().file(); };
-    auto classLocs = enclosingClass.data(ctx)->locs();
+    auto classLocs = enclosingClass.data(ctx)->locs(ctx);
     auto classLoc = absl::c_find_if(classLocs, inFileOfMethod);
 
     if (classLoc == classLocs.end()) {
@@ -311,6 +311,23 @@ bool childNeedsOverride(core::Context ctx, core::SymbolRef childSymbol, core::Sy
 
 } // namespace
 
+bool SigSuggestionBudget::admit(core::Context ctx, core::SymbolRef method) {
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+    bool admitted;
+    if (elapsed >= budget) {
+        admitted = false;
+    } else if (elapsed * 2 >= budget) {
+        admitted = method.data(ctx)->isPublic();
+    } else {
+        admitted = true;
+    }
+    if (!admitted) {
+        deferredCount++;
+        prodCounterInc("types.sig_suggestion.deferred");
+    }
+    return admitted;
+}
+
 bool SigSuggestion::maybeSuggestSig(core::Context ctx, core::ErrorBuilder &e, unique_ptr<cfg::CFG> &cfg,
                                     const core::TypePtr &methodReturnType, core::TypeConstraint &constr) {
     core::SymbolRef methodSymbol = cfg->symbol;
@@ -2,8 +2,35 @@
 #define SORBET_SIG_SUGGESTION_H
 
 #include "cfg/CFG.h"
+#include <chrono>
 
 namespace sorbet::infer {
+
+// Caps the wall-clock time a single file may spend computing suggested sigs. Whole-file suggestion
+// runs multiply a file's typecheck cost several-fold during sig-adoption pushes; under a budget the
+// suggestions are computed best-effort instead, with public methods given priority (their sigs
+// constrain other files, so they are the ones worth spending scarce time on). A method declined for
+// lack of budget still reports its missing-sig error — only the suggestion attached to it is
+// skipped — and the deferral is recorded so callers can retry the file later (the LSP reruns
+// deferred files while idle).
+class SigSuggestionBudget final {
+    const std::chrono::steady_clock::time_point start;
+    const std::chrono::milliseconds budget;
+    int deferredCount = 0;
+
+public:
+    explicit SigSuggestionBudget(int budgetMs) : start(std::chrono::steady_clock::now()), budget(budgetMs) {}
+
+    // Returns true when a suggestion for `method` may be computed now; records a deferral otherwise.
+    // Non-public methods stop being admitted once half the budget is spent.
+    bool admit(core::Context ctx, core::SymbolRef method);
+
+    // True when at least one suggestion was skipped because the budget ran out.
+    bool anyDeferred() const {
+        return deferredCount > 0;
+    }
+};
+
 class SigSuggestion final {
 public:
     static bool maybeSuggestSig(core::Context ctx, core::ErrorBuilder &e, std::unique_ptr<cfg::CFG> &cfg,
@@ -5,7 +5,7 @@
 #include "core/TypeConstraint.h"
 #include <algorithm> // find, remove_if
 
-template struct std::pair<sorbet::core::LocalVariable, std::shared_ptr<sorbet::core::Type>>;
+template struct std::pair<sorbet::core::LocalVariable, sorbet::core::TypePtr>;
 
 using namespace std;
 
@@ -86,8 +86,9 @@ KnowledgeRef KnowledgeFact::under(core::Context ctx, const KnowledgeRef &what, c
         if (enteringLoop && bb->outerLoops <= inWhat.maxLoopWrite[local]) {
             continue;
         }
-        auto fnd = absl::c_find_if(copy->yesTypeTests, [&](auto const &e) -> bool { return e.first == local; });
-        if (fnd == copy->yesTypeTests.end()) {
+        auto fnd = absl::c_lower_bound(copy->yesTypeTests, local,
+                                       [](auto const &e, core::LocalVariable l) -> bool { return e.first < l; });
+        if (fnd == copy->yesTypeTests.end() || fnd->first != local) {
             // add info from env to knowledge
             ENFORCE(state.typeAndOrigins.type.get() != nullptr);
             // This handles code snippets such as
@@ -114,7 +115,7 @@ KnowledgeRef KnowledgeFact::under(core::Context ctx, const KnowledgeRef &what, c
 
             auto type = state.typeAndOrigins.type;
             if (isNeeded && !type->isUntyped() && !core::isa_type<core::MetaType>(type.get())) {
-                copy.mutate().yesTypeTests.emplace_back(local, type);
+                copy.mutate().addYesTypeTest(local, type);
             }
         } else {
             auto &second = fnd->second;
@@ -129,33 +130,63 @@ KnowledgeRef KnowledgeFact::under(core::Context ctx, const KnowledgeRef &what, c
     return copy;
 }
 
+void KnowledgeFact::addYesTypeTest(core::LocalVariable of, core::TypePtr type) {
+    auto it = absl::c_lower_bound(yesTypeTests, of,
+                                  [](auto const &e, core::LocalVariable l) -> bool { return e.first < l; });
+    yesTypeTests.emplace(it, of, move(type));
+}
+
+void KnowledgeFact::addNoTypeTest(core::LocalVariable of, core::TypePtr type) {
+    auto it = absl::c_lower_bound(noTypeTests, of,
+                                  [](auto const &e, core::LocalVariable l) -> bool { return e.first < l; });
+    noTypeTests.emplace(it, of, move(type));
+}
+
 void KnowledgeFact::min(core::Context ctx, const KnowledgeFact &other) {
-    for (auto it = yesTypeTests.begin(); it != yesTypeTests.end(); /* nothing */) {
-        auto &entry = *it;
-        core::LocalVariable local = entry.first;
-        auto fnd = absl::c_find_if(other.yesTypeTests, [&](auto const &elem) -> bool { return elem.first == local; });
-        if (fnd == other.yesTypeTests.end()) {
-            it = yesTypeTests.erase(it);
-        } else {
-            entry.second = core::Types::any(ctx, fnd->second, entry.second);
-            it++;
+    // Both runs are sorted by variable, so the intersection is a single two-pointer pass per run
+    // instead of a search per entry; it ends as soon as either side runs out.
+    {
+        auto out = yesTypeTests.begin();
+        auto it = yesTypeTests.begin();
+        auto otherIt = other.yesTypeTests.begin();
+        while (it != yesTypeTests.end() && otherIt != other.yesTypeTests.end()) {
+            if (it->first < otherIt->first) {
+                ++it;
+            } else if (otherIt->first < it->first) {
+                ++otherIt;
+            } else {
+                out->first = it->first;
+                out->second = core::Types::any(ctx, otherIt->second, it->second);
+                ++out;
+                ++it;
+                ++otherIt;
+            }
         }
+        yesTypeTests.erase(out, yesTypeTests.end());
     }
-    for (auto it = noTypeTests.begin(); it != noTypeTests.end(); /* nothing */) {
-        auto &entry = *it;
-        core::LocalVariable local = entry.first;
-        auto fnd = absl::c_find_if(other.noTypeTests, [&](auto const &elem) -> bool { return elem.first == local; });
-        if (fnd == other.noTypeTests.end()) {
-            it = noTypeTests.erase(it);
-        } else {
-            entry.second = core::Types::all(ctx, fnd->second, entry.second);
-            it++;
+    {
+        auto out = noTypeTests.begin();
+        auto it = noTypeTests.begin();
+        auto otherIt = other.noTypeTests.begin();
+        while (it != noTypeTests.end() && otherIt != other.noTypeTests.end()) {
+            if (it->first < otherIt->first) {
+                ++it;
+            } else if (otherIt->first < it->first) {
+                ++otherIt;
+            } else {
+                out->first = it->first;
+                out->second = core::Types::all(ctx, otherIt->second, it->second);
+                ++out;
+                ++it;
+                ++otherIt;
+            }
         }
+        noTypeTests.erase(out, noTypeTests.end());
     }
 }
 
 void KnowledgeFact::sanityCheck() const {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return;
     }
     for (auto &a : yesTypeTests) {
@@ -166,6 +197,8 @@ void KnowledgeFact::sanityCheck() const {
         ENFORCE(a.second.get() != nullptr);
         ENFORCE(!a.second->isUntyped());
     }
+    ENFORCE(absl::c_is_sorted(yesTypeTests, [](auto const &l, auto const &r) -> bool { return l.first < r.first; }));
+    ENFORCE(absl::c_is_sorted(noTypeTests, [](auto const &l, auto const &r) -> bool { return l.first < r.first; }));
 }
 
 string KnowledgeFact::toString(core::Context ctx) const {
@@ -184,6 +217,11 @@ string KnowledgeFact::toString(core::Context ctx) const {
     return fmt::format("{}{}", fmt::join(buf1, ""), fmt::join(buf2, ""));
 }
 
+const std::shared_ptr<KnowledgeFact> &KnowledgeRef::emptyFact() {
+    static const auto empty = make_shared<KnowledgeFact>();
+    return empty;
+}
+
 const KnowledgeFact &KnowledgeRef::operator*() const {
     return *knowledge.get();
 }
@@ -212,7 +250,7 @@ string TestedKnowledge::toString(core::Context ctx) const {
 }
 
 void TestedKnowledge::sanityCheck() const {
-    if (!debug_mode) {
+    if (!slow_debug_mode) {
         return;
     }
     truthy->sanityCheck();
@@ -284,6 +322,10 @@ bool Environment::getKnownTruthy(core::LocalVariable var) const {
 void Environment::propagateKnowledge(core::Context ctx, core::LocalVariable to, core::LocalVariable from,
                                      KnowledgeFilter &knowledgeFilter) {
     if (knowledgeFilter.isNeeded(to) && knowledgeFilter.isNeeded(from)) {
+        // Materialize both slots before taking references: inserting the second could grow the
+        // map's backing store out from under a reference into it.
+        vars[from];
+        vars[to];
         auto &fromState = vars[from];
         auto &toState = vars[to];
         toState.knownTruthy = fromState.knownTruthy;
@@ -297,33 +339,40 @@ void Environment::propagateKnowledge(core::Context ctx, core::LocalVariable to,
         }
 
         toKnowledge = fromKnowledge;
-        toKnowledge.truthy.mutate().noTypeTests.emplace_back(from, core::Types::falsyTypes());
-        toKnowledge.falsy.mutate().yesTypeTests.emplace_back(from, core::Types::falsyTypes());
-        fromKnowledge.truthy.mutate().noTypeTests.emplace_back(to, core::Types::falsyTypes());
-        fromKnowledge.falsy.mutate().yesTypeTests.emplace_back(to, core::Types::falsyTypes());
+        toKnowledge.truthy.mutate().addNoTypeTest(from, core::Types::falsyTypes());
+        toKnowledge.falsy.mutate().addYesTypeTest(from, core::Types::falsyTypes());
+        fromKnowledge.truthy.mutate().addNoTypeTest(to, core::Types::falsyTypes());
+        fromKnowledge.falsy.mutate().addYesTypeTest(to, core::Types::falsyTypes());
         fromKnowledge.sanityCheck();
         toKnowledge.sanityCheck();
     }
 }
 
 void Environment::clearKnowledge(core::Context ctx, core::LocalVariable reassigned, KnowledgeFilter &knowledgeFilter) {
+    // This runs for every assignment, and for the overwhelming majority of them no fact mentions
+    // the reassigned variable; peek through the refs first so that case stays read-only instead of
+    // materializing (copying) every fact in the environment.
+    auto mentions = [&reassigned](const KnowledgeFact &fact) -> bool {
+        return absl::c_any_of(fact.yesTypeTests, [&](auto const &c) -> bool { return c.first == reassigned; }) ||
+               absl::c_any_of(fact.noTypeTests, [&](auto const &c) -> bool { return c.first == reassigned; });
+    };
+    auto clearOne = [&](KnowledgeRef &ref) {
+        if (!mentions(*ref)) {
+            return;
+        }
+        auto &fact = ref.mutate();
+        fact.yesTypeTests.erase(remove_if(fact.yesTypeTests.begin(), fact.yesTypeTests.end(),
+                                          [&](auto const &c) -> bool { return c.first == reassigned; }),
+                                fact.yesTypeTests.end());
+        fact.noTypeTests.erase(remove_if(fact.noTypeTests.begin(), fact.noTypeTests.end(),
+                                         [&](auto const &c) -> bool { return c.first == reassigned; }),
+                               fact.noTypeTests.end());
+    };
     for (auto &el : vars) {
         auto &k = el.second.knowledge;
         if (knowledgeFilter.isNeeded(el.first)) {
-            auto &truthy = k.truthy.mutate();
-            auto &falsy = k.falsy.mutate();
-            truthy.yesTypeTests.erase(remove_if(truthy.yesTypeTests.begin(), truthy.yesTypeTests.end(),
-                                                [&](auto const &c) -> bool { return c.first == reassigned; }),
-                                      truthy.yesTypeTests.end());
-            falsy.yesTypeTests.erase(remove_if(falsy.yesTypeTests.begin(), falsy.yesTypeTests.end(),
-                                               [&](auto const &c) -> bool { return c.first == reassigned; }),
-                                     falsy.yesTypeTests.end());
-            truthy.noTypeTests.erase(remove_if(truthy.noTypeTests.begin(), truthy.noTypeTests.end(),
-                                               [&](auto const &c) -> bool { return c.first == reassigned; }),
-                                     truthy.noTypeTests.end());
-            falsy.noTypeTests.erase(remove_if(falsy.noTypeTests.begin(), falsy.noTypeTests.end(),
-                                              [&](auto const &c) -> bool { return c.first == reassigned; }),
-                                    falsy.noTypeTests.end());
+            clearOne(k.truthy);
+            clearOne(k.falsy);
             k.sanityCheck();
         }
     }
@@ -349,11 +398,11 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
         if (fnd != vars.end()) {
             whoKnows.truthy = fnd->second.knowledge.falsy;
             whoKnows.falsy = fnd->second.knowledge.truthy;
-            fnd->second.knowledge.truthy.mutate().yesTypeTests.emplace_back(local, core::Types::falsyTypes());
-            fnd->second.knowledge.falsy.mutate().noTypeTests.emplace_back(local, core::Types::falsyTypes());
+            fnd->second.knowledge.truthy.mutate().addYesTypeTest(local, core::Types::falsyTypes());
+            fnd->second.knowledge.falsy.mutate().addNoTypeTest(local, core::Types::falsyTypes());
         }
-        whoKnows.truthy.mutate().yesTypeTests.emplace_back(send->recv.variable, core::Types::falsyTypes());
-        whoKnows.falsy.mutate().noTypeTests.emplace_back(send->recv.variable, core::Types::falsyTypes());
+        whoKnows.truthy.mutate().addYesTypeTest(send->recv.variable, core::Types::falsyTypes());
+        whoKnows.falsy.mutate().addNoTypeTest(send->recv.variable, core::Types::falsyTypes());
 
         whoKnows.sanityCheck();
     } else if (send->fun == core::Names::nil_p()) {
@@ -361,8 +410,8 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
             return;
         }
         auto &whoKnows = getKnowledge(local);
-        whoKnows.truthy.mutate().yesTypeTests.emplace_back(send->recv.variable, core::Types::nilClass());
-        whoKnows.falsy.mutate().noTypeTests.emplace_back(send->recv.variable, core::Types::nilClass());
+        whoKnows.truthy.mutate().addYesTypeTest(send->recv.variable, core::Types::nilClass());
+        whoKnows.falsy.mutate().addNoTypeTest(send->recv.variable, core::Types::nilClass());
         whoKnows.sanityCheck();
     } else if (send->fun == core::Names::blank_p()) {
         if (!knowledgeFilter.isNeeded(local)) {
@@ -375,7 +424,7 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
 
         if (!core::Types::equiv(ctx, knowledgeTypeWithoutFalsy, originalType)) {
             auto &whoKnows = getKnowledge(local);
-            whoKnows.falsy.mutate().yesTypeTests.emplace_back(send->recv.variable, knowledgeTypeWithoutFalsy);
+            whoKnows.falsy.mutate().addYesTypeTest(send->recv.variable, knowledgeTypeWithoutFalsy);
             whoKnows.sanityCheck();
         }
     } else if (send->fun == core::Names::present_p()) {
@@ -389,7 +438,7 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
 
         if (!core::Types::equiv(ctx, knowledgeTypeWithoutFalsy, originalType)) {
             auto &whoKnows = getKnowledge(local);
-            whoKnows.truthy.mutate().yesTypeTests.emplace_back(send->recv.variable, knowledgeTypeWithoutFalsy);
+            whoKnows.truthy.mutate().addYesTypeTest(send->recv.variable, knowledgeTypeWithoutFalsy);
             whoKnows.sanityCheck();
         }
     }
@@ -407,8 +456,8 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
         if (klass.exists()) {
             auto ty = klass.data(ctx)->externalType(ctx);
             if (!ty->isUntyped()) {
-                whoKnows.truthy.mutate().yesTypeTests.emplace_back(send->recv.variable, ty);
-                whoKnows.falsy.mutate().noTypeTests.emplace_back(send->recv.variable, ty);
+                whoKnows.truthy.mutate().addYesTypeTest(send->recv.variable, ty);
+                whoKnows.falsy.mutate().addNoTypeTest(send->recv.variable, ty);
             }
             whoKnows.sanityCheck();
         }
@@ -426,23 +475,23 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
         ENFORCE(argType.get() != nullptr);
         ENFORCE(recvType.get() != nullptr);
         if (!argType->isUntyped()) {
-            truthy.mutate().yesTypeTests.emplace_back(send->recv.variable, argType);
+            truthy.mutate().addYesTypeTest(send->recv.variable, argType);
         }
         if (!recvType->isUntyped()) {
-            truthy.mutate().yesTypeTests.emplace_back(send->args[0].variable, recvType);
+            truthy.mutate().addYesTypeTest(send->args[0].variable, recvType);
         }
         if (auto s = core::cast_type<core::ClassType>(argType.get())) {
             // check if s is a singleton. in this case we can learn that
             // a failed comparison means that type test would also fail
             if (isSingleton(ctx, s->symbol)) {
-                falsy.mutate().noTypeTests.emplace_back(send->recv.variable, argType);
+                falsy.mutate().addNoTypeTest(send->recv.variable, argType);
             }
         }
         if (auto s = core::cast_type<core::ClassType>(recvType.get())) {
             // check if s is a singleton. in this case we can learn that
             // a failed comparison means that type test would also fail
             if (isSingleton(ctx, s->symbol)) {
-                falsy.mutate().noTypeTests.emplace_back(send->args[0].variable, recvType);
+                falsy.mutate().addNoTypeTest(send->args[0].variable, recvType);
             }
         }
         whoKnows.sanityCheck();
@@ -458,8 +507,8 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
         if (representedClass.exists()) {
             auto representedType = representedClass.data(ctx)->externalType(ctx);
             if (!representedType->isUntyped()) {
-                whoKnows.truthy.mutate().yesTypeTests.emplace_back(send->args[0].variable, representedType);
-                whoKnows.falsy.mutate().noTypeTests.emplace_back(send->args[0].variable, representedType);
+                whoKnows.truthy.mutate().addYesTypeTest(send->args[0].variable, representedType);
+                whoKnows.falsy.mutate().addNoTypeTest(send->args[0].variable, representedType);
             }
         }
 
@@ -468,8 +517,8 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
             // check if s is a singleton. in this case we can learn that
             // a failed comparison means that type test would also fail
             if (isSingleton(ctx, s->symbol)) {
-                whoKnows.truthy.mutate().yesTypeTests.emplace_back(send->args[0].variable, recvType);
-                whoKnows.falsy.mutate().noTypeTests.emplace_back(send->args[0].variable, recvType);
+                whoKnows.truthy.mutate().addYesTypeTest(send->args[0].variable, recvType);
+                whoKnows.falsy.mutate().addNoTypeTest(send->args[0].variable, recvType);
             }
         }
         whoKnows.sanityCheck();
@@ -493,8 +542,8 @@ void Environment::updateKnowledge(core::Context ctx, core::LocalVariable local,
         }
 
         auto &whoKnows = getKnowledge(local);
-        whoKnows.truthy.mutate().yesTypeTests.emplace_back(send->recv.variable, argType);
-        whoKnows.falsy.mutate().noTypeTests.emplace_back(send->recv.variable, argType);
+        whoKnows.truthy.mutate().addYesTypeTest(send->recv.variable, argType);
+        whoKnows.falsy.mutate().addNoTypeTest(send->recv.variable, argType);
         whoKnows.sanityCheck();
     }
 }
@@ -505,17 +554,17 @@ void Environment::setTypeAndOrigin(core::LocalVariable symbol, const core::TypeA
 }
 
 const Environment &Environment::withCond(core::Context ctx, const Environment &env, Environment &copy, bool isTrue,
-                                         const UnorderedMap<core::LocalVariable, VariableState> &filter) {
+                                         const VariableStateMap &filter) {
     if (!env.bb->bexit.cond.variable.exists() || env.bb->bexit.cond.variable == core::LocalVariable::blockCall()) {
         return env;
     }
-    copy.cloneFrom(env);
+    copy.cloneFrom(env, env.bb->bexit.cond.variable, filter);
     copy.assumeKnowledge(ctx, isTrue, env.bb->bexit.cond.variable, env.bb->bexit.loc, filter);
     return copy;
 }
 
 void Environment::assumeKnowledge(core::Context ctx, bool isTrue, core::LocalVariable cond, core::Loc loc,
-                                  const UnorderedMap<core::LocalVariable, VariableState> &filter) {
+                                  const VariableStateMap &filter) {
     auto &thisKnowledge = getKnowledge(cond, false);
     thisKnowledge.sanityCheck();
     if (!isTrue) {
@@ -595,9 +644,19 @@ void Environment::assumeKnowledge(core::Context ctx, bool isTrue, core::LocalVar
 void Environment::mergeWith(core::Context ctx, const Environment &other, core::Loc loc, cfg::CFG &inWhat,
                             cfg::BasicBlock *bb, KnowledgeFilter &knowledgeFilter) {
     this->isDead |= other.isDead;
+    auto otherEnd = other.vars.end();
     for (auto &pair : vars) {
         auto var = pair.first;
-        const auto &otherTO = other.getTypeAndOrigin(ctx, var);
+        // One hash probe into `other` per variable: the getTypeAndOrigin/getKnownTruthy/
+        // getKnowledge accessors each repeat the same lookup, and this loop is the hottest spot in
+        // infer profiles.
+        auto otherIt = other.vars.find(var);
+        const VariableState *otherState = otherIt == otherEnd ? nullptr : &otherIt->second;
+        ENFORCE(otherState == nullptr || otherState->typeAndOrigins.type.get() != nullptr);
+        const core::TypeAndOrigins &otherTO = otherState != nullptr ? otherState->typeAndOrigins : uninitialized;
+        bool otherKnownTruthy = otherState != nullptr && otherState->knownTruthy;
+        const TestedKnowledge &otherKnowledge = otherState != nullptr ? otherState->knowledge : TestedKnowledge::empty;
+        otherKnowledge.sanityCheck();
         auto &thisTO = pair.second.typeAndOrigins;
         if (thisTO.type.get() != nullptr) {
             thisTO.type = core::Types::any(ctx, thisTO.type, otherTO.type);
@@ -607,27 +666,29 @@ void Environment::mergeWith(core::Context ctx, const Environment &other, core::L
                     thisTO.origins.emplace_back(origin);
                 }
             }
-            pair.second.knownTruthy = pair.second.knownTruthy && other.getKnownTruthy(var);
+            pair.second.knownTruthy = pair.second.knownTruthy && otherKnownTruthy;
         } else {
             thisTO = otherTO;
-            pair.second.knownTruthy = other.getKnownTruthy(var);
+            pair.second.knownTruthy = otherKnownTruthy;
         }
 
         if (((bb->flags & cfg::CFG::LOOP_HEADER) != 0) && bb->outerLoops <= inWhat.maxLoopWrite[var]) {
             continue;
         }
-        bool canBeFalsy = core::Types::canBeFalsy(ctx, otherTO.type) && !other.getKnownTruthy(var);
+        bool canBeFalsy = core::Types::canBeFalsy(ctx, otherTO.type) && !otherKnownTruthy;
         bool canBeTruthy = core::Types::canBeTruthy(ctx, otherTO.type);
 
         if (canBeTruthy) {
             auto &thisKnowledge = getKnowledge(var);
-            auto otherTruthy = KnowledgeFact::under(ctx, other.getKnowledge(var, false).truthy, other, loc, inWhat, bb,
-                                                    knowledgeFilter.isNeeded(var));
+            auto otherTruthy =
+                KnowledgeFact::under(ctx, otherKnowledge.truthy, other, loc, inWhat, bb, knowledgeFilter.isNeeded(var));
             if (!otherTruthy->isDead) {
                 if (!thisKnowledge.seenTruthyOption) {
                     thisKnowledge.seenTruthyOption = true;
                     thisKnowledge.truthy = otherTruthy;
-                } else {
+                } else if (!thisKnowledge.truthy.sharesBackingWith(otherTruthy)) {
+                    // Predecessors that agree share one backing fact through copy-on-write, and
+                    // merging a fact with itself changes nothing.
                     thisKnowledge.truthy.mutate().min(ctx, *otherTruthy);
                 }
             }
@@ -635,13 +696,13 @@ void Environment::mergeWith(core::Context ctx, const Environment &other, core::L
 
         if (canBeFalsy) {
             auto &thisKnowledge = getKnowledge(var);
-            auto otherFalsy = KnowledgeFact::under(ctx, other.getKnowledge(var, false).falsy, other, loc, inWhat, bb,
-                                                   knowledgeFilter.isNeeded(var));
+            auto otherFalsy =
+                KnowledgeFact::under(ctx, otherKnowledge.falsy, other, loc, inWhat, bb, knowledgeFilter.isNeeded(var));
             if (!otherFalsy->isDead) {
                 if (!thisKnowledge.seenFalsyOption) {
                     thisKnowledge.seenFalsyOption = true;
                     thisKnowledge.falsy = otherFalsy;
-                } else {
+                } else if (!thisKnowledge.falsy.sharesBackingWith(otherFalsy)) {
                     thisKnowledge.falsy.mutate().min(ctx, *otherFalsy);
                 }
             }
@@ -690,11 +751,19 @@ void Environment::computePins(core::Context ctx, const vector<Environment> &envs
 
 void Environment::populateFrom(core::Context ctx, const Environment &other) {
     this->isDead = other.isDead;
+    auto otherEnd = other.vars.end();
     for (auto &pair : vars) {
         auto var = pair.first;
-        pair.second.typeAndOrigins = other.getTypeAndOrigin(ctx, var);
-        pair.second.knowledge = other.getKnowledge(var, false);
-        pair.second.knownTruthy = other.getKnownTruthy(var);
+        auto otherIt = other.vars.find(var);
+        if (otherIt != otherEnd) {
+            ENFORCE(otherIt->second.typeAndOrigins.type.get() != nullptr);
+            otherIt->second.knowledge.sanityCheck();
+            pair.second = otherIt->second;
+        } else {
+            pair.second.typeAndOrigins = uninitialized;
+            pair.second.knowledge = TestedKnowledge::empty;
+            pair.second.knownTruthy = false;
+        }
     }
 
     this->pinnedTypes = other.pinnedTypes;
@@ -1210,11 +1279,43 @@ core::TypePtr Environment::processBinding(core::Context ctx, cfg::Binding &bind,
     }
 }
 
-void Environment::cloneFrom(const Environment &rhs) {
+void Environment::cloneFrom(const Environment &rhs, core::LocalVariable cond,
+                            const VariableStateMap &filter) {
     this->isDead = rhs.isDead;
-    this->vars = rhs.vars;
     this->bb = rhs.bb;
     this->pinnedTypes = rhs.pinnedTypes;
+    this->vars.reserve(filter.size() + 1);
+
+    auto keep = [&](core::LocalVariable var) {
+        auto fnd = rhs.vars.find(var);
+        if (fnd != rhs.vars.end()) {
+            this->vars.insert(*fnd);
+        }
+    };
+    for (auto &pair : filter) {
+        keep(pair.first);
+    }
+    keep(cond);
+
+    // Knowledge carried on the variables we kept can reference other variables through type tests;
+    // their types have to stay visible for the contradiction checks in KnowledgeFact::under. One
+    // level suffices: only the kept variables' knowledge is ever consulted downstream.
+    InlinedVector<core::LocalVariable, 4> referenced;
+    for (auto &pair : this->vars) {
+        auto &knowledge = pair.second.knowledge;
+        for (auto *fact : {&knowledge.truthy, &knowledge.falsy}) {
+            for (auto &test : (*fact)->yesTypeTests) {
+                referenced.emplace_back(test.first);
+            }
+            for (auto &test : (*fact)->noTypeTests) {
+                referenced.emplace_back(test.first);
+            }
+        }
+    }
+    for (auto var : referenced) {
+        keep(var);
+    }
+    histogramInc("infer.environment.cloned.size", this->vars.size());
 }
 
 const TestedKnowledge &Environment::getKnowledge(core::LocalVariable symbol, bool shouldFail) const {
@@ -40,11 +40,17 @@ class KnowledgeRef;
  */
 struct KnowledgeFact {
     bool isDead = false;
-    /* the following type tests are known to be true */
+    /* the following type tests are known to be true. Kept sorted by variable (see addYesTypeTest)
+     * so that min() is a linear two-pointer pass and under() can binary-search. */
     InlinedVector<std::pair<core::LocalVariable, core::TypePtr>, 1> yesTypeTests;
-    /* the following type tests are known to be false */
+    /* the following type tests are known to be false. Sorted like yesTypeTests. */
     InlinedVector<std::pair<core::LocalVariable, core::TypePtr>, 1> noTypeTests;
 
+    /* insert a type test at its sorted position. All writes go through these so the sorted
+     * invariant holds. */
+    void addYesTypeTest(core::LocalVariable of, core::TypePtr type);
+    void addNoTypeTest(core::LocalVariable of, core::TypePtr type);
+
     /* this is a "merge" of two knowledges - computes a "lub" of knowledges */
     void min(core::Context ctx, const KnowledgeFact &other);
 
@@ -61,7 +67,7 @@ struct KnowledgeFact {
 // KnowledgeRef wraps a `KnowledgeFact` with copy-on-write semantics
 class KnowledgeRef {
 public:
-    KnowledgeRef() : knowledge(std::make_shared<KnowledgeFact>()) {}
+    KnowledgeRef() : knowledge(emptyFact()) {}
     KnowledgeRef(const KnowledgeRef &) = default;
     KnowledgeRef &operator=(const KnowledgeRef &) = default;
     KnowledgeRef(KnowledgeRef &&) = default;
@@ -72,7 +78,21 @@ public:
 
     KnowledgeFact &mutate();
 
+    /** True when both refs share one backing fact, which is common when predecessors carried the
+     * same knowledge here through copy-on-write. Merging a fact with itself is a no-op, so callers
+     * use this to skip both the merge and the copy that mutate() would force. */
+    bool sharesBackingWith(const KnowledgeRef &other) const {
+        return knowledge == other.knowledge;
+    }
+
 private:
+    // Every default-constructed ref shares one immortal empty fact; the backing storage only
+    // materializes when mutate() first writes through a ref. Environments create a TestedKnowledge
+    // (two refs) per tracked variable, and most of them are never written — straight-line code
+    // records no facts — so eagerly allocating per ref was almost entirely waste. The extra
+    // reference held by the shared empty fact means mutate()'s use_count check always copies before
+    // the first write, so the shared fact itself is never mutated.
+    static const std::shared_ptr<KnowledgeFact> &emptyFact();
     std::shared_ptr<KnowledgeFact> knowledge;
 };
 
@@ -92,6 +112,118 @@ public:
     void sanityCheck() const;
 };
 
+struct VariableState {
+    core::TypeAndOrigins typeAndOrigins;
+    TestedKnowledge knowledge;
+    bool knownTruthy;
+};
+
+/**
+ * The variable-to-state map behind `Environment::vars`. By method count most CFGs are trivial —
+ * attr readers, delegators, prop accessors — with one or two live blocks and a handful of locals,
+ * and for them the per-block hash tables cost more than the inference they support. Entries live
+ * in an InlinedVector with room for SMALL_THRESHOLD variables, so small environments stay entirely
+ * inside the Environment itself (on the stack, for the temporaries withCond populates) and look up
+ * with a linear scan, which beats hashing at these sizes. Environments that outgrow the inline
+ * buffer build a hash index from variable to slot; from then on lookups are a single probe, which
+ * keeps the per-variable find in Environment::mergeWith O(1) for large methods.
+ *
+ * Exposes the subset of the map API infer uses; iteration walks the vector in both regimes. Like
+ * the hash map this replaces, growth can move entries, so references and iterators do not survive
+ * an insert.
+ */
+class VariableStateMap final {
+public:
+    using value_type = std::pair<core::LocalVariable, VariableState>;
+
+    static constexpr size_t SMALL_THRESHOLD = 8;
+
+private:
+    InlinedVector<value_type, SMALL_THRESHOLD> entries_;
+    std::unique_ptr<UnorderedMap<core::LocalVariable, u4>> index_;
+
+public:
+    using iterator = decltype(entries_)::iterator;
+    using const_iterator = decltype(entries_)::const_iterator;
+
+private:
+    void buildIndex() {
+        index_ = std::make_unique<UnorderedMap<core::LocalVariable, u4>>();
+        index_->reserve(entries_.size());
+        u4 slot = 0;
+        for (auto &entry : entries_) {
+            (*index_)[entry.first] = slot++;
+        }
+    }
+
+public:
+    size_t size() const {
+        return entries_.size();
+    }
+
+    bool empty() const {
+        return entries_.empty();
+    }
+
+    void reserve(size_t n) {
+        entries_.reserve(n);
+    }
+
+    iterator begin() {
+        return entries_.begin();
+    }
+    iterator end() {
+        return entries_.end();
+    }
+    const_iterator begin() const {
+        return entries_.begin();
+    }
+    const_iterator end() const {
+        return entries_.end();
+    }
+
+    iterator find(core::LocalVariable var) {
+        if (index_ != nullptr) {
+            auto it = index_->find(var);
+            return it != index_->end() ? entries_.begin() + it->second : entries_.end();
+        }
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->first == var) {
+                return it;
+            }
+        }
+        return entries_.end();
+    }
+
+    const_iterator find(core::LocalVariable var) const {
+        return const_cast<VariableStateMap *>(this)->find(var);
+    }
+
+    VariableState &operator[](core::LocalVariable var) {
+        if (index_ == nullptr) {
+            for (auto &entry : entries_) {
+                if (entry.first == var) {
+                    return entry.second;
+                }
+            }
+            if (entries_.size() < SMALL_THRESHOLD) {
+                entries_.emplace_back(var, VariableState{});
+                return entries_.back().second;
+            }
+            buildIndex();
+        }
+        auto [it, inserted] = index_->try_emplace(var, entries_.size());
+        if (inserted) {
+            entries_.emplace_back(var, VariableState{});
+        }
+        return entries_[it->second].second;
+    }
+
+    void insert(const value_type &entry) {
+        (*this)[entry.first] = entry.second;
+    }
+};
+
 class Environment {
     const core::TypeAndOrigins uninitialized;
 
@@ -104,9 +236,8 @@ public:
     cfg::BasicBlock *bb;
 
     /*
-     * These four vectors represent the core state store of the environment,
-     * modeling a map from local variables to (type, knowledge, known-truthy)
-     * tuples.
+     * This map is the core state store of the environment, taking local
+     * variables to (type, knowledge, known-truthy) tuples.
      *
      * As we learn flow-dependent information through the CFG, we normally
      * represent that information in the type of a variable; For instance, "v is
@@ -122,12 +253,7 @@ public:
      * simple subtyping check suffices to represent that one.
      */
 
-    struct VariableState {
-        core::TypeAndOrigins typeAndOrigins;
-        TestedKnowledge knowledge;
-        bool knownTruthy;
-    };
-    UnorderedMap<core::LocalVariable, VariableState> vars;
+    VariableStateMap vars;
 
     UnorderedMap<core::LocalVariable, core::TypeAndOrigins> pinnedTypes;
 
@@ -169,10 +295,10 @@ public:
      * then discard it, so the mixed lifetimes are not a problem in practice.
      */
     static const Environment &withCond(core::Context ctx, const Environment &env, Environment &copy, bool isTrue,
-                                       const UnorderedMap<core::LocalVariable, VariableState> &filter);
+                                       const VariableStateMap &filter);
 
     void assumeKnowledge(core::Context ctx, bool isTrue, core::LocalVariable cond, core::Loc loc,
-                         const UnorderedMap<core::LocalVariable, VariableState> &filter);
+                         const VariableStateMap &filter);
 
     void mergeWith(core::Context ctx, const Environment &other, core::Loc loc, cfg::CFG &inWhat, cfg::BasicBlock *bb,
                    KnowledgeFilter &knowledgeFilter);
@@ -193,7 +319,15 @@ public:
     void ensureGoodCondition(core::Context ctx, core::LocalVariable cond) {}
     void ensureGoodAssignTarget(core::Context ctx, core::LocalVariable target) {}
 
-    void cloneFrom(const Environment &rhs);
+    /*
+     * Clone the parts of `rhs` that a block guarded by `cond` can still observe:
+     * variables in `filter` (the target block's live-in set, i.e. its
+     * arguments), the condition itself, and variables referenced by type tests
+     * in their knowledge. In large methods the parent environment tracks many
+     * locals that are dead on entry to any given successor; copying them per
+     * incoming edge dominated merge time.
+     */
+    void cloneFrom(const Environment &rhs, core::LocalVariable cond, const VariableStateMap &filter);
 };
 
 } // namespace sorbet::infer
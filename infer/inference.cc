@@ -10,7 +10,8 @@
 using namespace std;
 namespace sorbet::infer {
 
-unique_ptr<cfg::CFG> Inference::run(core::Context ctx, unique_ptr<cfg::CFG> cfg) {
+unique_ptr<cfg::CFG> Inference::run(core::Context ctx, unique_ptr<cfg::CFG> cfg,
+                                    SigSuggestionBudget *suggestionBudget) {
     Timer timeit(ctx.state.tracer(), "Inference::run",
                  {{"func", (string)cfg->symbol.data(ctx)->toStringFullName(ctx)}});
     ENFORCE(cfg->symbol == ctx.owner);
@@ -87,6 +88,12 @@ unique_ptr<cfg::CFG> Inference::run(core::Context ctx, unique_ptr<cfg::CFG> cfg)
     }
     for (auto it = cfg->forwardsTopoSort.rbegin(); it != cfg->forwardsTopoSort.rend(); ++it) {
         cfg::BasicBlock *bb = *it;
+        if (ctx.state.lspQuery.isCanceled()) {
+            // The interactive request this query serves was superseded; nothing will read the
+            // types we would compute, so stop at the block boundary. Only the query path aborts
+            // here — regular typechecking runs with an empty query and never takes this exit.
+            return cfg;
+        }
         if (bb == cfg->deadBlock()) {
             continue;
         }
@@ -219,7 +226,10 @@ unique_ptr<cfg::CFG> Inference::run(core::Context ctx, unique_ptr<cfg::CFG> cfg)
     if ((missingReturnType || cfg->symbol.data(ctx)->hasGeneratedSig()) && guessTypes) {
         if (auto e = ctx.state.beginError(cfg->symbol.data(ctx)->loc(), core::errors::Infer::UntypedMethod)) {
             e.setHeader("This function does not have a `{}`", "sig");
-            SigSuggestion::maybeSuggestSig(ctx, e, cfg, methodReturnType, *constr);
+            // A budget deferral only skips the suggestion; the error above still reports.
+            if (suggestionBudget == nullptr || suggestionBudget->admit(ctx, cfg->symbol)) {
+                SigSuggestion::maybeSuggestSig(ctx, e, cfg, methodReturnType, *constr);
+            }
         }
     }
 
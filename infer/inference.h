@@ -6,9 +6,15 @@
 #include <string>
 
 namespace sorbet::infer {
+class SigSuggestionBudget;
+
 class Inference final {
 public:
-    static std::unique_ptr<cfg::CFG> run(core::Context ctx, std::unique_ptr<cfg::CFG> cfg);
+    // `suggestionBudget`, when non-null, bounds the time spent computing suggested sigs for
+    // methods missing one; see SigSuggestionBudget. The caller owns it for the whole file so the
+    // budget spans every method in the file.
+    static std::unique_ptr<cfg::CFG> run(core::Context ctx, std::unique_ptr<cfg::CFG> cfg,
+                                         SigSuggestionBudget *suggestionBudget = nullptr);
 };
 } // namespace sorbet::infer
 
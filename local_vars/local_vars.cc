@@ -5,6 +5,7 @@
 #include "common/typecase.h"
 #include "core/core.h"
 #include "core/errors/namer.h"
+#include "rewriter/flatten.h"
 
 using namespace std;
 
@@ -12,6 +13,7 @@ namespace sorbet::local_vars {
 
 class LocalNameInserter {
     friend class LocalVars;
+    friend class FlattenAndLocalNameWalk;
 
     struct NamedArg {
         core::NameRef name;
@@ -89,11 +91,39 @@ class LocalNameInserter {
         u4 localId = 0;
         bool insideBlock = false;
         bool insideMethod = false;
+        // Block frames resolve names they don't define by walking down the live scope stack
+        // instead of copying the whole parent table on entry; see findLocal.
+        bool inheritsParentLocals = false;
     };
 
-    LocalFrame &pushBlockFrame(core::Loc loc, bool insideMethod) {
+    LocalFrame &currentFrame() {
+        return scopeStack[scopeDepth - 1];
+    }
+
+    // Frames are pooled: exiting a scope only rewinds scopeDepth, and entering the next sibling
+    // scope reuses the slot — and its tables' capacity — left behind. Machine-generated files with
+    // tens of thousands of sibling scopes otherwise reallocate a fresh table per scope.
+    LocalFrame &pushFrame(core::Loc loc) {
+        if (scopeDepth < scopeStack.size()) {
+            auto &frame = scopeStack[scopeDepth++];
+            frame.locals.clear();
+            frame.args.clear();
+            frame.loc = loc;
+            frame.oldBlockCounter = nullopt;
+            frame.localId = 0;
+            frame.insideBlock = false;
+            frame.insideMethod = false;
+            frame.inheritsParentLocals = false;
+            return frame;
+        }
+        scopeDepth++;
         auto &frame = scopeStack.emplace_back();
         frame.loc = loc;
+        return frame;
+    }
+
+    LocalFrame &pushBlockFrame(core::Loc loc, bool insideMethod) {
+        auto &frame = pushFrame(loc);
         frame.localId = blockCounter;
         frame.insideBlock = true;
         frame.insideMethod = insideMethod;
@@ -104,12 +134,13 @@ class LocalNameInserter {
     LocalFrame &enterBlock(core::Loc loc) {
         // NOTE: the base-case for this being a valid initialization is setup by
         // the `create()` static method.
-        return pushBlockFrame(loc, scopeStack.back().insideMethod);
+        auto &frame = pushBlockFrame(loc, currentFrame().insideMethod);
+        frame.inheritsParentLocals = true;
+        return frame;
     }
 
     LocalFrame &enterMethod(core::Loc loc) {
-        auto &frame = scopeStack.emplace_back();
-        frame.loc = loc;
+        auto &frame = pushFrame(loc);
         frame.oldBlockCounter = blockCounter;
         frame.insideMethod = true;
         blockCounter = 1;
@@ -117,22 +148,41 @@ class LocalNameInserter {
     }
 
     LocalFrame &enterClass(core::Loc loc) {
-        auto &frame = scopeStack.emplace_back();
+        auto &frame = pushFrame(loc);
         frame.oldBlockCounter = blockCounter;
-        frame.loc = loc;
         blockCounter = 1;
         return frame;
     }
 
     void exitScope() {
-        auto &oldScopeCounter = scopeStack.back().oldBlockCounter;
+        auto &oldScopeCounter = currentFrame().oldBlockCounter;
         if (oldScopeCounter) {
             blockCounter = *oldScopeCounter;
         }
-        scopeStack.pop_back();
+        scopeDepth--;
+    }
+
+    // Resolves a name against the current scope chain: the innermost frame that binds it wins,
+    // and the walk stops at the first frame that doesn't inherit (method/class boundaries never
+    // see enclosing locals). Equivalent to the old copy-on-block-entry scheme — a copied binding
+    // is just the parent's binding — without the O(parent locals) copy per block, which dominated
+    // this pass on large generated files.
+    core::LocalVariable findLocal(core::NameRef name) {
+        for (auto i = scopeDepth - 1;; i--) {
+            auto &frame = scopeStack[i];
+            auto fnd = frame.locals.find(name);
+            if (fnd != frame.locals.end()) {
+                return fnd->second;
+            }
+            if (!frame.inheritsParentLocals) {
+                return core::LocalVariable();
+            }
+        }
     }
 
     vector<LocalFrame> scopeStack;
+    // Frames at index >= scopeDepth are exited scopes kept for reuse by pushFrame.
+    size_t scopeDepth = 0;
     // The purpose of this counter is to ensure that every block within a method/class has a unique scope id.
     // For example, a possible assignment of ids is the following:
     //
@@ -150,7 +200,7 @@ class LocalNameInserter {
     u4 blockCounter{0};
 
     core::LocalVariable enterLocal(core::NameRef name) {
-        auto &frame = scopeStack.back();
+        auto &frame = currentFrame();
         if (!frame.insideBlock) {
             return core::LocalVariable(name, 0);
         }
@@ -162,11 +212,11 @@ class LocalNameInserter {
     ast::MethodDef::ARGS_store fillInArgs(vector<NamedArg> namedArgs) {
         ast::MethodDef::ARGS_store args;
 
+        auto &frame = currentFrame();
         for (auto &named : namedArgs) {
             args.emplace_back(move(named.expr));
-            auto frame = scopeStack.back();
-            scopeStack.back().locals[named.name] = named.local;
-            scopeStack.back().args.emplace_back(named.local);
+            frame.locals[named.name] = named.local;
+            frame.args.emplace_back(named.local);
         }
 
         return args;
@@ -187,7 +237,7 @@ public:
         return klass;
     }
 
-    unique_ptr<ast::Expression> postTransformClassDef(core::MutableContext ctx, unique_ptr<ast::ClassDef> klass) {
+    unique_ptr<ast::ClassDef> postTransformClassDef(core::MutableContext ctx, unique_ptr<ast::ClassDef> klass) {
         exitScope();
         return klass;
     }
@@ -204,11 +254,11 @@ public:
         return method;
     }
 
-    unique_ptr<ast::Expression> postTransformSend(core::MutableContext ctx, unique_ptr<ast::Send> original) {
+    unique_ptr<ast::Send> postTransformSend(core::MutableContext ctx, unique_ptr<ast::Send> original) {
         if (original->args.size() == 1 && ast::isa_tree<ast::ZSuperArgs>(original->args[0].get())) {
             original->args.clear();
-            if (scopeStack.back().insideMethod) {
-                for (auto arg : scopeStack.back().args) {
+            if (currentFrame().insideMethod) {
+                for (auto arg : currentFrame().args) {
                     original->args.emplace_back(make_unique<ast::Local>(original->loc, arg));
                 }
             } else {
@@ -222,18 +272,12 @@ public:
     }
 
     unique_ptr<ast::Block> preTransformBlock(core::MutableContext ctx, unique_ptr<ast::Block> blk) {
-        auto outerArgs = scopeStack.back().args;
+        auto outerArgs = currentFrame().args;
         auto &frame = enterBlock(blk->loc);
         frame.args = std::move(outerArgs);
-        auto &parent = *(scopeStack.end() - 2);
-
-        // We inherit our parent's locals
-        for (auto &binding : parent.locals) {
-            frame.locals.insert(binding);
-        }
 
-        // If any of our arguments shadow our parent, fillInArgs will overwrite
-        // them in `frame.locals`
+        // Our parent's locals stay visible through findLocal's chain walk; any of our arguments
+        // that shadow the parent land in `frame.locals` via fillInArgs and win the walk.
         blk->args = fillInArgs(nameArgs(ctx, blk->args));
 
         return blk;
@@ -247,11 +291,10 @@ public:
     unique_ptr<ast::Expression> postTransformUnresolvedIdent(core::MutableContext ctx,
                                                              unique_ptr<ast::UnresolvedIdent> nm) {
         if (nm->kind == ast::UnresolvedIdent::Local) {
-            auto &frame = scopeStack.back();
-            core::LocalVariable &cur = frame.locals[nm->name];
+            auto cur = findLocal(nm->name);
             if (!cur.exists()) {
                 cur = enterLocal(nm->name);
-                frame.locals[nm->name] = cur;
+                currentFrame().locals[nm->name] = cur;
             }
             return make_unique<ast::Local>(nm->loc, cur);
         } else {
@@ -267,10 +310,71 @@ private:
     }
 };
 
+// Drives the rewriter's flattening walk and the local-variable naming walk from one TreeMap
+// traversal. Both are structural passes — neither consults the symbol table — and they run back to
+// back on every indexed file, so fusing them saves a full tree walk per file. Hook order nests
+// flattening outside naming: pre hooks run flatten's visitor first, post hooks run it last. Naming
+// therefore sees every node in its original position before flattening relocates it, which yields
+// the same names: `def` opens a fresh scope in Ruby, so a method's locals do not depend on where
+// the method sits when it is visited.
+class FlattenAndLocalNameWalk final {
+    friend class LocalVars;
+
+    LocalNameInserter localNames;
+    rewriter::Flatten::Walk flatten;
+
+    FlattenAndLocalNameWalk() = default;
+
+public:
+    unique_ptr<ast::ClassDef> preTransformClassDef(core::MutableContext ctx, unique_ptr<ast::ClassDef> klass) {
+        return localNames.preTransformClassDef(ctx, flatten.preTransformClassDef(ctx, move(klass)));
+    }
+
+    unique_ptr<ast::Expression> postTransformClassDef(core::MutableContext ctx, unique_ptr<ast::ClassDef> klass) {
+        return flatten.postTransformClassDef(ctx, localNames.postTransformClassDef(ctx, move(klass)));
+    }
+
+    unique_ptr<ast::MethodDef> preTransformMethodDef(core::MutableContext ctx, unique_ptr<ast::MethodDef> method) {
+        return localNames.preTransformMethodDef(ctx, flatten.preTransformMethodDef(ctx, move(method)));
+    }
+
+    unique_ptr<ast::Expression> postTransformMethodDef(core::MutableContext ctx, unique_ptr<ast::MethodDef> method) {
+        return flatten.postTransformMethodDef(ctx, localNames.postTransformMethodDef(ctx, move(method)));
+    }
+
+    unique_ptr<ast::Send> preTransformSend(core::MutableContext ctx, unique_ptr<ast::Send> send) {
+        return flatten.preTransformSend(ctx, move(send));
+    }
+
+    unique_ptr<ast::Expression> postTransformSend(core::MutableContext ctx, unique_ptr<ast::Send> send) {
+        return flatten.postTransformSend(ctx, localNames.postTransformSend(ctx, move(send)));
+    }
+
+    unique_ptr<ast::Block> preTransformBlock(core::MutableContext ctx, unique_ptr<ast::Block> blk) {
+        return localNames.preTransformBlock(ctx, move(blk));
+    }
+
+    unique_ptr<ast::Block> postTransformBlock(core::MutableContext ctx, unique_ptr<ast::Block> blk) {
+        return localNames.postTransformBlock(ctx, move(blk));
+    }
+
+    unique_ptr<ast::Expression> postTransformUnresolvedIdent(core::MutableContext ctx,
+                                                             unique_ptr<ast::UnresolvedIdent> nm) {
+        return localNames.postTransformUnresolvedIdent(ctx, move(nm));
+    }
+};
+
 ast::ParsedFile LocalVars::run(core::MutableContext ctx, ast::ParsedFile tree) {
     LocalNameInserter localNameInserter;
     tree.tree = ast::TreeMap::apply(ctx, localNameInserter, move(tree.tree));
     return tree;
 }
 
+ast::ParsedFile LocalVars::runWithFlatten(core::MutableContext ctx, ast::ParsedFile tree) {
+    FlattenAndLocalNameWalk walk;
+    tree.tree = ast::TreeMap::apply(ctx, walk, move(tree.tree));
+    tree.tree = walk.flatten.finish(ctx, move(tree.tree));
+    return tree;
+}
+
 } // namespace sorbet::local_vars
@@ -9,6 +9,11 @@ class LocalVars final {
 public:
     static ast::ParsedFile run(core::MutableContext ctx, ast::ParsedFile tree);
 
+    // Runs the local-variable naming walk fused with the rewriter's flattening walk in a single
+    // traversal. Produces the same tree as rewriter::Flatten::run followed by run(), one full
+    // tree walk cheaper.
+    static ast::ParsedFile runWithFlatten(core::MutableContext ctx, ast::ParsedFile tree);
+
     LocalVars() = delete;
 };
 
@@ -0,0 +1,73 @@
+#include "main/lsp/CompletionIndex.h"
+#include "common/Timer.h"
+
+using namespace std;
+
+namespace sorbet::realmain::lsp {
+
+namespace {
+// Basically the same as Module#ancestors from Ruby--but don't depend on it being exactly equal.
+// For us, it's just something that's vaguely ordered from "most specific" to "least specific" ancestor.
+void ancestorsImpl(const core::GlobalState &gs, core::SymbolRef sym, vector<core::SymbolRef> &acc) {
+    // The implementation here is similar to Symbols::derivesFrom.
+    ENFORCE(sym.data(gs)->isClassOrModuleLinearizationComputed());
+    acc.emplace_back(sym);
+
+    for (auto mixin : sym.data(gs)->mixins()) {
+        acc.emplace_back(mixin);
+    }
+
+    if (sym.data(gs)->superClass().exists()) {
+        ancestorsImpl(gs, sym.data(gs)->superClass(), acc);
+    }
+}
+} // namespace
+
+unique_ptr<CompletionIndex::ClassTable> CompletionIndex::build(const core::GlobalState &gs, core::SymbolRef receiver) {
+    Timer timeit(gs.tracer(), "CompletionIndex::build");
+    auto table = make_unique<ClassTable>();
+
+    vector<core::SymbolRef> ancestors;
+    ancestorsImpl(gs, receiver, ancestors);
+
+    int depth = -1;
+    for (auto ancestor : ancestors) {
+        depth++;
+        for (auto [memberName, memberSymbol] : ancestor.data(gs)->members()) {
+            if (!memberSymbol.data(gs)->isMethod()) {
+                continue;
+            }
+
+            if (memberName.data(gs)->kind == core::NameKind::UNIQUE &&
+                memberName.data(gs)->unique.uniqueNameKind == core::UniqueNameKind::MangleRename) {
+                // Mangle-renamed methods never show up in completion results. Note that we *don't*
+                // want to exclude all unique names, because we want each overload to show up but
+                // those use unique names.
+                continue;
+            }
+
+            table->methods.emplace_back(
+                Method{memberName, memberSymbol, depth, memberSymbol.data(gs)->isPrivate()});
+        }
+    }
+
+    return table;
+}
+
+const CompletionIndex::ClassTable &CompletionIndex::forClass(const core::GlobalState &gs, core::SymbolRef receiver) {
+    if (builtForGeneration != gs.symbolTableGeneration) {
+        tables.clear();
+        builtForGeneration = gs.symbolTableGeneration;
+    }
+
+    auto &slot = tables[receiver];
+    if (slot == nullptr) {
+        slot = build(gs, receiver);
+        categoryCounterInc("lsp.completion_index", "build");
+    } else {
+        categoryCounterInc("lsp.completion_index", "reuse");
+    }
+    return *slot;
+}
+
+} // namespace sorbet::realmain::lsp
@@ -0,0 +1,52 @@
+#ifndef RUBY_TYPER_LSP_COMPLETIONINDEX_H
+#define RUBY_TYPER_LSP_COMPLETIONINDEX_H
+
+#include "core/core.h"
+
+namespace sorbet::realmain::lsp {
+
+/**
+ * Per-class flattened method tables for dot-completion. The first level flattens a receiver's whole
+ * ancestor chain once — every method reachable through it, with the depth it was found at and its
+ * visibility pre-resolved — and caches the table by class; the second level is the per-keystroke
+ * prefix filter over that table (see completion.cc). Like SymbolNameIndex, tables rebuild lazily
+ * whenever the symbol table generation changes, so they survive fast path edits (which only touch
+ * method bodies) and are dropped wholesale after a slow path.
+ */
+class CompletionIndex final {
+public:
+    struct Method {
+        core::NameRef name;
+        core::SymbolRef symbol;
+        /** Index in the receiver's ancestor chain of the ancestor defining this method; methods
+         * found at a smaller depth shadow same-named methods found at a larger one. */
+        int depth;
+        bool isPrivate;
+    };
+
+    struct ClassTable {
+        std::vector<Method> methods;
+    };
+
+private:
+    /** Generation of the symbol table the cached tables were built against; 0 means never built. */
+    unsigned int builtForGeneration = 0;
+    UnorderedMap<core::SymbolRef, std::unique_ptr<ClassTable>> tables;
+
+    static std::unique_ptr<ClassTable> build(const core::GlobalState &gs, core::SymbolRef receiver);
+
+public:
+    CompletionIndex() = default;
+    CompletionIndex(const CompletionIndex &) = delete;
+    CompletionIndex &operator=(const CompletionIndex &) = delete;
+
+    /**
+     * The flattened table for `receiver`, built on first use. Tables are heap-allocated, so the
+     * reference stays valid across later calls until the symbol table generation moves.
+     */
+    const ClassTable &forClass(const core::GlobalState &gs, core::SymbolRef receiver);
+};
+
+} // namespace sorbet::realmain::lsp
+
+#endif
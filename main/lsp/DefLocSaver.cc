@@ -18,7 +18,9 @@ unique_ptr<ast::MethodDef> DefLocSaver::postTransformMethodDef(core::Context ctx
         core::TypeAndOrigins tp;
 
         // Check if it matches against a specific argument. If it does, send that instead;
-        // it's more specific.
+        // it's more specific. File-wide queries emit responses for every argument *and* the
+        // definition below: a later per-position lookup into those responses needs both, and picks
+        // the argument first because it comes first.
         const int numArgs = methodDef->args.size();
 
         ENFORCE(numArgs == argTypes.size());
@@ -28,11 +30,14 @@ unique_ptr<ast::MethodDef> DefLocSaver::postTransformMethodDef(core::Context ctx
             auto *localExp = ast::MK::arg2Local(arg.get());
             // localExp should never be null, but guard against the possibility.
             if (localExp && lspQuery.matchesLoc(localExp->loc)) {
-                tp.type = argType.type;
-                tp.origins.emplace_back(localExp->loc);
+                core::TypeAndOrigins argTp;
+                argTp.type = argType.type;
+                argTp.origins.emplace_back(localExp->loc);
                 core::lsp::QueryResponse::pushQueryResponse(
-                    ctx, core::lsp::IdentResponse(methodDef->symbol, localExp->loc, localExp->localVariable, tp));
-                return methodDef;
+                    ctx, core::lsp::IdentResponse(methodDef->symbol, localExp->loc, localExp->localVariable, argTp));
+                if (lspQuery.kind != core::lsp::Query::Kind::FILE) {
+                    return methodDef;
+                }
             }
         }
 
@@ -0,0 +1,54 @@
+#include "main/lsp/DocumentOutlineIndex.h"
+#include "common/Timer.h"
+#include "main/lsp/lsp.h"
+
+using namespace std;
+
+namespace sorbet::realmain::lsp {
+
+void DocumentOutlineIndex::rebuild(const core::GlobalState &gs) {
+    Timer timeit(gs.tracer(), "DocumentOutlineIndex::rebuild");
+    roots.clear();
+    for (u4 idx = 1; idx < gs.symbolsUsed(); idx++) {
+        core::SymbolRef ref(gs, idx);
+        if (hideSymbol(gs, ref)) {
+            continue;
+        }
+        auto owner = ref.data(gs)->owner;
+        for (auto definitionLocation : ref.data(gs)->locs(gs)) {
+            auto file = definitionLocation.file();
+            if (!file.exists()) {
+                continue;
+            }
+            // a bit counter-intuitive, but this actually should be `!= file`, as it prevents duplicates:
+            // symbols whose owner is defined in the same file show up as that owner's children instead.
+            if (owner.data(gs)->loc().file() == file && owner != core::Symbols::root()) {
+                continue;
+            }
+            auto &fileRoots = roots[file];
+            // A symbol with several locs in one file still roots that file's outline only once.
+            if (fileRoots.empty() || fileRoots.back() != ref) {
+                fileRoots.emplace_back(ref);
+            }
+        }
+    }
+    builtForGeneration = gs.symbolTableGeneration;
+    categoryCounterInc("lsp.document_outline_index", "rebuild");
+}
+
+const vector<core::SymbolRef> &DocumentOutlineIndex::rootsForFile(const core::GlobalState &gs, core::FileRef fref) {
+    if (builtForGeneration != gs.symbolTableGeneration) {
+        rebuild(gs);
+    } else {
+        categoryCounterInc("lsp.document_outline_index", "reuse");
+    }
+
+    auto it = roots.find(fref);
+    if (it == roots.end()) {
+        static const vector<core::SymbolRef> empty;
+        return empty;
+    }
+    return it->second;
+}
+
+} // namespace sorbet::realmain::lsp
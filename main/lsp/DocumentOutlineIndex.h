@@ -0,0 +1,38 @@
+#ifndef RUBY_TYPER_LSP_DOCUMENTOUTLINEINDEX_H
+#define RUBY_TYPER_LSP_DOCUMENTOUTLINEINDEX_H
+
+#include "core/core.h"
+
+namespace sorbet::realmain::lsp {
+
+/**
+ * Per-file outlines for textDocument/documentSymbol: for every file, the symbols that root the
+ * file's outline tree (the recursion into members still happens per request, but the scan over the
+ * whole symbol table does not). Editors poll documentSymbol on every focus change, so the scan was
+ * paid constantly on large workspaces. Like SymbolNameIndex, the index rebuilds lazily whenever the
+ * symbol table generation changes, so it survives fast path edits and is replaced wholesale after a
+ * slow path.
+ */
+class DocumentOutlineIndex final {
+    /** Generation of the symbol table the index was built against; 0 means never built. */
+    unsigned int builtForGeneration = 0;
+    /** For each file, the outline's root symbols in symbol table order. */
+    UnorderedMap<core::FileRef, std::vector<core::SymbolRef>> roots;
+
+    void rebuild(const core::GlobalState &gs);
+
+public:
+    DocumentOutlineIndex() = default;
+    DocumentOutlineIndex(const DocumentOutlineIndex &) = delete;
+    DocumentOutlineIndex &operator=(const DocumentOutlineIndex &) = delete;
+
+    /**
+     * The root symbols of `fref`'s outline, rebuilding the index first if `gs`'s symbol table
+     * changed since the last query. The reference is valid until the next rebuild.
+     */
+    const std::vector<core::SymbolRef> &rootsForFile(const core::GlobalState &gs, core::FileRef fref);
+};
+
+} // namespace sorbet::realmain::lsp
+
+#endif
@@ -33,7 +33,8 @@ LSPConfiguration::LSPConfiguration(const options::Options &opts, const shared_pt
                                    WorkerPool &workers, const shared_ptr<spdlog::logger> &logger, bool skipConfigatron,
                                    bool disableFastPath)
     : initialized(atomic<bool>(false)), opts(opts), output(output), workers(workers), logger(logger),
-      skipConfigatron(skipConfigatron), disableFastPath(disableFastPath), rootPath(getRootPath(opts, logger)) {}
+      skipConfigatron(skipConfigatron), disableFastPath(disableFastPath), rootPath(getRootPath(opts, logger)),
+      ignorePatternMatcher(opts.absoluteIgnorePatterns, opts.relativeIgnorePatterns) {}
 
 void LSPConfiguration::assertHasClientConfig() const {
     if (!clientConfig) {
@@ -213,7 +214,7 @@ unique_ptr<Location> LSPConfiguration::loc2Location(const core::GlobalState &gs,
 }
 
 bool LSPConfiguration::isFileIgnored(string_view filePath) const {
-    return FileOps::isFileIgnored(rootPath, filePath, opts.absoluteIgnorePatterns, opts.relativeIgnorePatterns);
+    return FileOps::isFileIgnored(rootPath, filePath, ignorePatternMatcher);
 }
 
 bool LSPConfiguration::isUriInWorkspace(string_view uri) const {
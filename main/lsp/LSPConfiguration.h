@@ -1,6 +1,7 @@
 #ifndef RUBY_TYPER_LSPCONFIGURATION_H
 #define RUBY_TYPER_LSPCONFIGURATION_H
 
+#include "common/FileOps.h"
 #include "common/concurrency/WorkerPool.h"
 #include "main/lsp/LSPOutput.h"
 #include "main/lsp/json_types.h"
@@ -78,6 +79,9 @@ public:
     const bool disableFastPath;
     /** File system root of LSP client workspace. May be empty if it is the current working directory. */
     const std::string rootPath;
+    /** The --ignore pattern lists compiled once; consulted for every path the server hears about
+     * (edits, watcher updates, queries). */
+    const PathPatternMatcher ignorePatternMatcher;
 
     // The following properties are configured during initialization.
 
@@ -55,10 +55,24 @@ unique_ptr<LSPMessage> makeSorbetError(LSPErrorCodes code, string_view message,
     }
 }
 
+namespace {
+// Copies `json` into a reused thread-local scratch buffer for in-situ parsing: string values in
+// the resulting DOM point into the buffer (unescaped in place) instead of being copied one by one
+// into the document's allocator. The generated fromJSONValue converters copy whatever they keep
+// into the typed message, so the buffer only needs to stay untouched until the next message is
+// parsed on this thread.
+char *copyToScratch(const string &json) {
+    static thread_local vector<char> scratch;
+    scratch.assign(json.begin(), json.end());
+    scratch.push_back('\0');
+    return scratch.data();
+}
+} // namespace
+
 unique_ptr<LSPMessage> LSPMessage::fromClient(const string &json) {
     rapidjson::MemoryPoolAllocator<> alloc;
     rapidjson::Document d(&alloc);
-    if (d.Parse(json.c_str()).HasParseError()) {
+    if (d.ParseInsitu(copyToScratch(json)).HasParseError()) {
         return makeSorbetError(LSPErrorCodes::ParseError,
                                fmt::format("Last LSP request: `{}` is not a valid json object", json));
     }
@@ -103,7 +117,7 @@ LSPMessage::RawLSPMessage fromJSONValue(rapidjson::Document &d) {
 LSPMessage::RawLSPMessage fromJSON(const std::string &json) {
     rapidjson::MemoryPoolAllocator<> alloc;
     rapidjson::Document d(&alloc);
-    d.Parse(json.c_str());
+    d.ParseInsitu(copyToScratch(json));
     return fromJSONValue(d);
 }
 
@@ -154,6 +168,9 @@ bool LSPMessage::isDelayable() const {
         case LSPMethod::SorbetWatchmanFileChange:
         // A file read. Should not be reordered with respect to file updates.
         case LSPMethod::SorbetReadFile:
+        // Trace dumps capture an incident that just happened; delaying them behind file updates
+        // would age the window they are trying to capture.
+        case LSPMethod::SorbetDumpTrace:
             return false;
         // VS Code requests document symbols automatically and in the background. It's OK to delay these requests.
         case LSPMethod::TextDocumentDocumentSymbol:
@@ -255,4 +272,16 @@ string LSPMessage::toJSON(bool prettyPrint) const {
         Exception::raise("LSPMessage is not a request, notification, or a response.");
     }
 }
+
+void LSPMessage::writeJSON(rapidjson::StringBuffer &buffer) const {
+    if (isRequest()) {
+        asRequest().writeJSON(buffer);
+    } else if (isNotification()) {
+        asNotification().writeJSON(buffer);
+    } else if (isResponse()) {
+        asResponse().writeJSON(buffer);
+    } else {
+        Exception::raise("LSPMessage is not a request, notification, or a response.");
+    }
+}
 } // namespace sorbet::realmain::lsp
@@ -62,6 +62,11 @@ public:
      * oldest timer.*/
     std::unique_ptr<Timer> timer;
 
+    /** When this message was appended to the processing queue. The processing loop reports the
+     * message's queue residency (pop time minus this) so dashboards can separate scheduling
+     * latency from compute latency. Unset for messages that never reach the processing queue. */
+    std::optional<std::chrono::time_point<std::chrono::steady_clock>> enqueueTime;
+
     /** If `true`, then this LSPMessage contains a canceled LSP request. */
     bool canceled = false;
 
@@ -136,6 +141,12 @@ public:
      * Returns the message in JSON form.
      */
     std::string toJSON(bool prettyPrint = false) const;
+
+    /**
+     * Serializes the message in JSON form directly into `buffer`, avoiding toJSON's intermediate
+     * std::string. Use this on the output path.
+     */
+    void writeJSON(rapidjson::StringBuffer &buffer) const;
 };
 } // namespace sorbet::realmain::lsp
 
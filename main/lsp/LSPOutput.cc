@@ -50,10 +50,19 @@ void LSPOutput::write(unique_ptr<NotificationMessage> msg) {
 LSPStdout::LSPStdout(shared_ptr<spdlog::logger> &logger) : logger(logger) {}
 
 void LSPStdout::rawWrite(unique_ptr<LSPMessage> msg) {
-    auto json = msg->toJSON();
-    string outResult = fmt::format("Content-Length: {}\r\n\r\n{}", json.length(), json);
+    // Shows up in the trace only when the write actually stalls (>1ms), which is what makes output
+    // backpressure distinguishable from typechecking time when a client reads slowly.
+    Timer timeit(logger, "lsp.output_write",
+                 {{"method", msg->isResponse() ? "response"
+                                               : internDynamicName(convertLSPMethodToString(msg->method()))}});
+    // Serialize once into a rapidjson buffer and stream the framing header and payload separately.
+    // Going through toJSON + fmt::format would copy the full payload twice more, which matters when
+    // a publishDiagnostics burst reaches tens of megabytes.
+    rapidjson::StringBuffer buffer;
+    msg->writeJSON(buffer);
+    string_view json(buffer.GetString(), buffer.GetSize());
     logger->debug("Write: {}\n", json);
-    cout << outResult << flush;
+    cout << "Content-Length: " << json.size() << "\r\n\r\n" << json << flush;
 }
 
 void LSPOutputToVector::rawWrite(unique_ptr<LSPMessage> msg) {
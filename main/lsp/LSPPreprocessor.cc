@@ -36,6 +36,24 @@ void cancelTimer(unique_ptr<Timer> &timer) {
     }
 }
 
+// Translates a 0-indexed LSP line/character position into a byte offset into `contents`.
+// Out-of-range positions clamp to the nearest valid offset; editors occasionally send positions
+// one past the end of the final line.
+size_t position2Offset(string_view contents, int line, int character) {
+    size_t offset = 0;
+    for (int i = 0; i < line; i++) {
+        auto lineEnd = contents.find('\n', offset);
+        if (lineEnd == string_view::npos) {
+            return contents.size();
+        }
+        offset = lineEnd + 1;
+    }
+    auto lineEnd = contents.find('\n', offset);
+    auto lineLength = (lineEnd == string_view::npos ? contents.size() : lineEnd) - offset;
+    auto column = static_cast<size_t>(character > 0 ? character : 0);
+    return offset + (column < lineLength ? column : lineLength);
+}
+
 } // namespace
 
 LSPPreprocessor::LSPPreprocessor(unique_ptr<core::GlobalState> initialGS, const shared_ptr<LSPConfiguration> &config,
@@ -133,8 +151,8 @@ void LSPPreprocessor::mergeFileChanges(absl::Mutex &mtx, QueueState &state) {
     ttgs.pruneBefore(earliestActiveEditVersion);
 }
 
-void cancelRequest(std::deque<std::unique_ptr<LSPMessage>> &pendingRequests, const CancelParams &cancelParams) {
-    for (auto &current : pendingRequests) {
+void cancelRequest(QueueState &state, const CancelParams &cancelParams) {
+    for (auto &current : state.pendingRequests) {
         if (current->isRequest()) {
             auto &request = current->asRequest();
             if (request.id == cancelParams.id) {
@@ -146,8 +164,13 @@ void cancelRequest(std::deque<std::unique_ptr<LSPMessage>> &pendingRequests, con
             }
         }
     }
-    // Else... it's too late; we have either already processed it, or are currently processing it. Swallow cancellation
-    // and ignore.
+    // Not in the queue: it may be the request the processing thread is working on right now. Flip
+    // its flag; a query it runs aborts at the next basic-block boundary in inference.
+    if (state.processingRequestId != nullptr && *state.processingRequestId == cancelParams.id) {
+        state.processingRequestCanceled->store(true);
+        return;
+    }
+    // Else... it's too late; we have already processed it. Swallow cancellation and ignore.
 }
 
 unique_ptr<core::GlobalState> LSPPreprocessor::getTypecheckingGS() const {
@@ -205,7 +228,7 @@ void LSPPreprocessor::preprocessAndEnqueue(QueueState &state, unique_ptr<LSPMess
     switch (method) {
         case LSPMethod::$CancelRequest: {
             absl::MutexLock lock(&stateMtx);
-            cancelRequest(state.pendingRequests, *get<unique_ptr<CancelParams>>(msg->asNotification().params));
+            cancelRequest(state, *get<unique_ptr<CancelParams>>(msg->asNotification().params));
             // A canceled request can be moved around, so we may be able to merge more file changes.
             mergeFileChanges(stateMtx, state);
             break;
@@ -306,7 +329,11 @@ void LSPPreprocessor::preprocessAndEnqueue(QueueState &state, unique_ptr<LSPMess
     if (shouldEnqueue || shouldMerge) {
         absl::MutexLock lock(&stateMtx);
         if (shouldEnqueue) {
+            // When later edits are merged into this message while it waits, the original enqueue
+            // time survives, so the reported residency covers the oldest merged edit.
+            msg->enqueueTime = std::chrono::steady_clock::now();
             state.pendingRequests.push_back(move(msg));
+            prodHistogramInc("lsp.queues.processing_depth", state.pendingRequests.size());
         }
         if (shouldMerge) {
             mergeFileChanges(stateMtx, state);
@@ -353,25 +380,27 @@ void LSPPreprocessor::canonicalizeEdits(u4 v, unique_ptr<DidChangeTextDocumentPa
         if (config->isFileIgnored(localPath)) {
             return;
         }
+        // Per the LSP spec, each content change applies to the document as left by the previous
+        // one, so all ranged edits for this notification splice into a single working buffer.
+        // Offsets are computed directly on that buffer rather than through a throwaway core::File,
+        // whose constructor would copy the contents and build a full line table per change.
         string fileContents;
+        bool haveContents = false;
         for (auto &change : changeParams->contentChanges) {
             if (change->range) {
-                fileContents = string(getFileContents(updates, ttgs.getGlobalState(), localPath));
+                if (!haveContents) {
+                    fileContents = string(getFileContents(updates, ttgs.getGlobalState(), localPath));
+                    haveContents = true;
+                }
                 auto &range = *change->range;
                 // incremental update
-                core::Loc::Detail start, end;
-                start.line = range->start->line + 1;
-                start.column = range->start->character + 1;
-                end.line = range->end->line + 1;
-                end.column = range->end->character + 1;
-                core::File old(string(localPath), string(fileContents), core::File::Type::Normal);
-                // These offsets are non-nullopt assuming the input range is a valid range.
-                auto startOffset = core::Loc::pos2Offset(old, start).value();
-                auto endOffset = core::Loc::pos2Offset(old, end).value();
-                fileContents = fileContents.replace(startOffset, endOffset - startOffset, change->text);
+                auto startOffset = position2Offset(fileContents, range->start->line, range->start->character);
+                auto endOffset = position2Offset(fileContents, range->end->line, range->end->character);
+                fileContents.replace(startOffset, endOffset - startOffset, change->text);
             } else {
                 // replace
                 fileContents = move(change->text);
+                haveContents = true;
             }
         }
         updates.updatedFiles.push_back(
@@ -387,6 +416,7 @@ void LSPPreprocessor::canonicalizeEdits(u4 v, unique_ptr<DidOpenTextDocumentPara
     if (config->isUriInWorkspace(uri)) {
         string localPath = config->remoteName2Local(uri);
         if (!config->isFileIgnored(localPath)) {
+            updates.openedFilePaths.push_back(localPath);
             updates.updatedFiles.push_back(make_shared<core::File>(
                 move(localPath), move(openParams->textDocument->text), core::File::Type::Normal));
         }
@@ -447,6 +477,8 @@ void LSPPreprocessor::mergeEdits(LSPFileUpdates &to, LSPFileUpdates &from) {
     to.updatedFiles = move(from.updatedFiles);
     to.updatedFileIndexes = move(from.updatedFileIndexes);
     to.updatedFileHashes = move(from.updatedFileHashes);
+    to.openedFilePaths.insert(to.openedFilePaths.end(), make_move_iterator(from.openedFilePaths.begin()),
+                              make_move_iterator(from.openedFilePaths.end()));
     to.hasNewFiles = to.hasNewFiles || from.hasNewFiles;
     to.canTakeFastPath = ttgs.canTakeFastPath(to.versionStart - 1, to);
     // `to` now includes the contents of `from`.
@@ -10,6 +10,7 @@
 #include "main/lsp/LSPConfiguration.h"
 #include "main/lsp/LSPMessage.h"
 #include "main/lsp/TimeTravelingGlobalState.h"
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <optional>
@@ -24,6 +25,12 @@ struct QueueState {
     int errorCode = 0;
     // Counters collected from worker threads.
     CounterState counters;
+    // The id and cancellation flag of the request the processing thread is currently handling.
+    // $/cancelRequest scans pendingRequests; these let it also reach a request that has already
+    // been popped, whose query then aborts at the next basic-block boundary in inference. Guarded
+    // by the same mutex as pendingRequests; null while no request is in flight.
+    std::unique_ptr<MessageId> processingRequestId;
+    std::shared_ptr<std::atomic<bool>> processingRequestCanceled;
 };
 
 /**
@@ -1,15 +1,23 @@
 #include "main/lsp/LSPTypechecker.h"
+#include "absl/strings/escaping.h" // BytesToHexString
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
+#include "ast/Helpers.h"
 #include "ast/treemap/treemap.h"
+#include "common/crypto_hashing/crypto_hashing.h"
 #include "common/sort.h"
 #include "common/typecase.h"
+#include "core/Hashing.h"
 #include "core/Unfreeze.h"
+#include "core/serialize/serialize.h"
 #include "main/lsp/DefLocSaver.h"
 #include "main/lsp/LSPMessage.h"
 #include "main/lsp/LocalVarSaver.h"
 #include "main/lsp/ShowOperation.h"
 #include "main/pipeline/pipeline.h"
+#include "version/version.h"
 
 namespace sorbet::realmain::lsp {
 using namespace std;
@@ -17,22 +25,171 @@ using namespace std;
 LSPTypechecker::LSPTypechecker(const std::shared_ptr<const LSPConfiguration> &config)
     : typecheckerThreadId(this_thread::get_id()), config(config) {}
 
+namespace {
+// Prunes method definitions that an edit cannot have affected: the method's own body hash is
+// unchanged (its name is not among the changed method hashes) and its body invokes none of the
+// changed names. CFG construction and inference then run only for the methods the edit touched;
+// diagnostics for pruned methods are re-emitted from the previous run.
+class FastPathMethodPruner {
+    const UnorderedSet<core::NameHash> &changedHashes;
+    struct Frame {
+        bool usesChangedName = false;
+    };
+    vector<Frame> frames;
+
+public:
+    vector<core::Loc> prunedMethods;
+
+    FastPathMethodPruner(const UnorderedSet<core::NameHash> &changedHashes) : changedHashes(changedHashes) {}
+
+    unique_ptr<ast::MethodDef> preTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> original) {
+        frames.emplace_back();
+        return original;
+    }
+
+    unique_ptr<ast::Expression> postTransformSend(core::Context ctx, unique_ptr<ast::Send> original) {
+        if (!frames.empty() && !frames.back().usesChangedName &&
+            changedHashes.contains(core::NameHash(ctx.state, original->fun.data(ctx)))) {
+            frames.back().usesChangedName = true;
+        }
+        return original;
+    }
+
+    unique_ptr<ast::Expression> postTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> original) {
+        auto frame = frames.back();
+        frames.pop_back();
+        if (!frames.empty()) {
+            // A lexically nested def shares its enclosing method's fate.
+            frames.back().usesChangedName = frames.back().usesChangedName || frame.usesChangedName;
+        }
+        if (frame.usesChangedName ||
+            changedHashes.contains(core::NameHash(ctx.state, original->name.data(ctx)))) {
+            return original;
+        }
+        prunedMethods.emplace_back(original->loc);
+        return ast::MK::EmptyTree();
+    }
+};
+
+// Collects the spans of the methods whose query responses an edit may have invalidated: those
+// whose own body hash changed and those whose body mentions a changed name — the complement of
+// what FastPathMethodPruner keeps. retargetQueryResponseIndex drops responses in these spans and
+// preserves the rest of the file's query-index entry.
+class InvalidatedMethodSpanCollector {
+    const UnorderedSet<core::NameHash> &changedHashes;
+    struct Frame {
+        bool usesChangedName = false;
+    };
+    vector<Frame> frames;
+
+public:
+    vector<core::Loc> invalidatedSpans;
+    // True when code outside any method definition (class bodies, top-level statements) mentions a
+    // changed name. Responses there cannot be attributed to a method span, so the caller drops the
+    // whole entry instead.
+    bool looseCodeUsesChangedName = false;
+
+    InvalidatedMethodSpanCollector(const UnorderedSet<core::NameHash> &changedHashes)
+        : changedHashes(changedHashes) {}
+
+    unique_ptr<ast::MethodDef> preTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> original) {
+        frames.emplace_back();
+        return original;
+    }
+
+    unique_ptr<ast::Expression> postTransformSend(core::Context ctx, unique_ptr<ast::Send> original) {
+        if (changedHashes.contains(core::NameHash(ctx.state, original->fun.data(ctx)))) {
+            if (frames.empty()) {
+                looseCodeUsesChangedName = true;
+            } else {
+                frames.back().usesChangedName = true;
+            }
+        }
+        return original;
+    }
+
+    unique_ptr<ast::Expression> postTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> original) {
+        auto frame = frames.back();
+        frames.pop_back();
+        if (!frames.empty()) {
+            // A lexically nested def shares its enclosing method's fate.
+            frames.back().usesChangedName = frames.back().usesChangedName || frame.usesChangedName;
+        }
+        if (frame.usesChangedName || changedHashes.contains(core::NameHash(ctx.state, original->name.data(ctx)))) {
+            invalidatedSpans.emplace_back(original->loc);
+        }
+        return original;
+    }
+};
+
+// Key identifying a snapshot of the fully typechecked GlobalState for this workspace: the file
+// table size plus every workspace file's path and content hash, in file id order. The name, symbol
+// and file ids embedded in the snapshot are only meaningful against an identically laid out file
+// table and identically indexed inputs, so the key pins both down, the same way the pipeline's
+// post-namer cache key does (the kvstore is already segregated by sorbet version and payload via
+// its version key, which also keeps id assignment deterministic).
+string workspaceSnapshotKey(const core::GlobalState &gs) {
+    string manifest = to_string(gs.filesUsed());
+    for (u4 i = 1; i < gs.filesUsed(); i++) {
+        const auto &file = core::FileRef(i).dataAllowingUnsafe(gs);
+        if (file.sourceType != core::File::Type::Normal) {
+            continue;
+        }
+        auto contentHash = sorbet::crypto_hashing::hash64(file.source());
+        absl::StrAppend(&manifest, "\n", file.path(), "//",
+                        absl::BytesToHexString(string_view{(char *)contentHash.data(), size(contentHash)}));
+    }
+    auto manifestHash = sorbet::crypto_hashing::hash64(manifest);
+    return absl::StrCat("LSPWorkspaceSnapshot//",
+                        absl::BytesToHexString(string_view{(char *)manifestHash.data(), size(manifestHash)}));
+}
+} // namespace
+
 void LSPTypechecker::initialize(LSPFileUpdates updates) {
+    if (!config->opts.cacheDir.empty()) {
+        // Opened here rather than handed down from realmain: KeyValueStore only accepts writes from
+        // the thread that created it, and workspace snapshots are written from this (the
+        // typechecker's) thread.
+        // Flavor selection must match realmain's: flags that change the shape of cached trees get
+        // their own flavor.
+        string cacheFlavor = config->opts.skipRewriterPasses ? "nodsl" : "default";
+        if (config->opts.stripUntypedMethodBodies) {
+            cacheFlavor += "-outline";
+        }
+        kvstore = make_unique<KeyValueStore>(Version::full_version_string, config->opts.cacheDir, move(cacheFlavor),
+                                             config->opts.cacheRemoteDir);
+    }
     globalStateHashes = move(updates.updatedFileHashes);
     indexed = move(updates.updatedFileIndexes);
+    nameUsageIndex.clear();
+    {
+        int i = -1;
+        for (auto &hash : globalStateHashes) {
+            i++;
+            addFileToNameUsageIndex(core::FileRef(i), hash);
+        }
+    }
     // Initialization typecheck is not cancelable.
     auto run = runSlowPath(move(updates), /* cancelable */ false);
     ENFORCE(!run.canceled);
     ENFORCE(run.newGS.has_value());
     gs = move(run.newGS.value());
     pushDiagnostics(move(run));
+    evictIndexedTrees();
 }
 
 bool LSPTypechecker::typecheck(LSPFileUpdates updates) {
     bool committed = true;
+    auto openedFilePaths = move(updates.openedFilePaths);
     auto run = runTypechecking(move(updates));
     committed = !run.canceled;
     commitTypecheckRun(move(run));
+    if (committed && !openedFilePaths.empty()) {
+        // The edit that opened these files is committed; prefetch before the first interactive
+        // query in them arrives. A canceled run never committed, so prefetching against it would
+        // warm stale state — the prefetch is best-effort and is simply dropped in that case.
+        prefetchOpenedFiles(openedFilePaths);
+    }
     return committed;
 }
 
@@ -44,12 +201,16 @@ TypecheckRun LSPTypechecker::runTypechecking(LSPFileUpdates updates) const {
             "Tried to run fast path with a GlobalState object that never had inferencer and resolver runs.");
 
     if (!updates.canTakeFastPath) {
+        if (canTakeOverlayPath(updates)) {
+            return runOverlayPath(move(updates));
+        }
         return runSlowPath(move(updates), true);
     }
 
     Timer timeit(config->logger, "fast_path");
     vector<core::FileRef> subset;
     vector<core::NameHash> changedHashes;
+    UnorderedMap<int, QueryIndexRemap> queryIndexRemaps;
     {
         const auto &hashes = updates.updatedFileHashes;
         ENFORCE(updates.updatedFiles.size() == hashes.size());
@@ -71,6 +232,28 @@ TypecheckRun LSPTypechecker::runTypechecking(LSPFileUpdates updates) const {
                         changedHashes.emplace_back(p.first);
                     }
                 }
+                if (queryResponseIndex.contains(fref.id())) {
+                    // Record where the edit changed the file's text while the pre-edit text is
+                    // still available; commitTypecheckRun uses this to retarget the file's
+                    // query-index entry onto the new text instead of dropping it.
+                    auto oldSrc = fref.data(*gs).source();
+                    auto newSrc = f->source();
+                    size_t prefixLen = 0;
+                    auto maxCommon = min(oldSrc.size(), newSrc.size());
+                    while (prefixLen < maxCommon && oldSrc[prefixLen] == newSrc[prefixLen]) {
+                        prefixLen++;
+                    }
+                    size_t suffixLen = 0;
+                    auto maxSuffix = maxCommon - prefixLen;
+                    while (suffixLen < maxSuffix &&
+                           oldSrc[oldSrc.size() - 1 - suffixLen] == newSrc[newSrc.size() - 1 - suffixLen]) {
+                        suffixLen++;
+                    }
+                    auto &remap = queryIndexRemaps[fref.id()];
+                    remap.prefixLen = prefixLen;
+                    remap.oldSuffixStart = oldSrc.size() - suffixLen;
+                    remap.newSuffixStart = newSrc.size() - suffixLen;
+                }
                 gs = core::GlobalState::replaceFile(move(gs), fref, f);
                 // If file doesn't have a typed: sigil, then we need to ensure it's typechecked using typed: false.
                 fref.data(*gs).strictLevel = pipeline::decideStrictLevel(*gs, fref, config->opts);
@@ -102,20 +285,172 @@ TypecheckRun LSPTypechecker::runTypechecking(LSPFileUpdates updates) const {
     ENFORCE(gs->errorQueue->isEmpty());
     vector<ast::ParsedFile> updatedIndexed;
     for (auto &f : subset) {
-        unique_ptr<KeyValueStore> kvstore; // nullptr
-        // TODO: Thread through kvstore.
-        ENFORCE(this->kvstore == nullptr);
-        auto t = pipeline::indexOne(config->opts, *gs, f, kvstore);
+        // The tree cache is deliberately not consulted here: `this->kvstore` holds workspace
+        // snapshots, and edited buffer contents rarely match on-disk cache entries anyway.
+        unique_ptr<KeyValueStore> treeCache; // nullptr
+        auto t = pipeline::indexOne(config->opts, *gs, f, treeCache);
         updatedIndexed.emplace_back(ast::ParsedFile{t.tree->deepCopy(), t.file});
         updates.updatedFinalGSFileIndexes.push_back(move(t));
     }
 
     ENFORCE(gs->lspQuery.isEmpty());
-    auto resolved = pipeline::incrementalResolve(*gs, move(updatedIndexed), config->opts);
-    pipeline::typecheck(gs, move(resolved), config->opts, config->workers);
+    auto resolved = pipeline::incrementalResolve(*gs, move(updatedIndexed), config->opts, config->workers);
+
+    // Drop method bodies that the edit could not have affected so that CFG construction and inference only run
+    // for changed methods. Diagnostics for the dropped methods are replayed from the previous run below.
+    vector<pair<core::FileRef, core::Loc>> prunedMethods;
+    if (!changedHashes.empty()) {
+        Timer timeit(config->logger, "fast_path.prune_methods");
+        UnorderedSet<core::NameHash> changedSet(changedHashes.begin(), changedHashes.end());
+        for (auto &tree : resolved) {
+            FastPathMethodPruner pruner(changedSet);
+            core::Context ctx(*gs, core::Symbols::root());
+            tree.tree = ast::TreeMap::apply(ctx, pruner, move(tree.tree));
+            for (auto loc : pruner.prunedMethods) {
+                prunedMethods.emplace_back(tree.file, loc);
+            }
+        }
+        prodCounterAdd("lsp.fastpath.methods_pruned", prunedMethods.size());
+    }
+
+    vector<core::FileRef> sigSuggestionsDeferred;
+    pipeline::typecheck(gs, move(resolved), config->opts, config->workers, nullptr, &sigSuggestionsDeferred);
     auto out = gs->errorQueue->drainWithQueryResponses();
+    for (auto &[fref, loc] : prunedMethods) {
+        auto it = errorsFromLastRun.find(fref);
+        if (it == errorsFromLastRun.end()) {
+            continue;
+        }
+        for (auto &e : it->second) {
+            if (loc.contains(e->loc)) {
+                out.first.emplace_back(make_unique<core::Error>(*e));
+            }
+        }
+    }
     gs->lspTypecheckCount++;
-    return TypecheckRun(move(out.first), move(subset), move(updates), true);
+    auto run = TypecheckRun(move(out.first), move(subset), move(updates), true);
+    run.queryIndexRemaps = move(queryIndexRemaps);
+    run.sigSuggestionsDeferred = move(sigSuggestionsDeferred);
+    return run;
+}
+
+namespace {
+/** Names defined by every single-file hash: the symbols GlobalState::initEmpty synthesizes appear
+ * in each file's definition hashes and must be subtracted out when deciding whether an added file
+ * introduces strictly new definitions. Computed once; the set is process-constant. */
+const UnorderedSet<core::NameHash> &builtinDefinitionNames(spdlog::logger &logger) {
+    static const UnorderedSet<core::NameHash> baseline = [&logger]() {
+        auto lgs = make_unique<core::GlobalState>(make_shared<core::ErrorQueue>(logger, logger));
+        lgs->initEmpty();
+        auto hash = lgs->hash();
+        UnorderedSet<core::NameHash> res;
+        for (auto &e : hash->methodHashes) {
+            res.insert(e.first);
+        }
+        for (auto &e : hash->constantHashes) {
+            res.insert(e.first);
+        }
+        return res;
+    }();
+    return baseline;
+}
+} // namespace
+
+bool LSPTypechecker::canTakeOverlayPath(const LSPFileUpdates &updates) const {
+    if (config->disableFastPath || updates.updatedFiles.empty()) {
+        return false;
+    }
+
+    auto &baseline = builtinDefinitionNames(*config->logger);
+    UnorderedSet<core::NameHash> newDefs;
+    int i = -1;
+    for (auto &f : updates.updatedFiles) {
+        ++i;
+        if (!absl::EndsWith(f->path(), ".rbi")) {
+            return false;
+        }
+        if (gs->findFileByPath(f->path()).exists()) {
+            // Edits to existing RBIs can change or delete definitions; only additions qualify.
+            return false;
+        }
+        auto &hash = updates.updatedFileHashes[i];
+        if (hash.definitions.hierarchyHash == core::GlobalStateHash::HASH_STATE_INVALID) {
+            return false;
+        }
+        for (auto &def : hash.definitions.methodHashes) {
+            if (!baseline.contains(def.first)) {
+                newDefs.insert(def.first);
+            }
+        }
+        for (auto &def : hash.definitions.constantHashes) {
+            if (!baseline.contains(def.first)) {
+                newDefs.insert(def.first);
+            }
+        }
+    }
+
+    for (auto &def : newDefs) {
+        if (nameUsageIndex.find(def) != nameUsageIndex.end()) {
+            config->logger->debug("Overlay path unavailable: an existing file references a new definition");
+            return false;
+        }
+    }
+    // A name can be defined without ever being referenced, and a second definition of the same name
+    // would merge into (and thereby change) the existing symbol, so collisions with existing
+    // definitions also disqualify the update. This scan probes a small set once per definition in
+    // the workspace; it only runs when files were added, not on the per-keystroke path.
+    for (auto &oldHash : globalStateHashes) {
+        for (auto &def : oldHash.definitions.methodHashes) {
+            if (newDefs.contains(def.first)) {
+                config->logger->debug("Overlay path unavailable: an existing file defines a new definition's name");
+                return false;
+            }
+        }
+        for (auto &def : oldHash.definitions.constantHashes) {
+            if (newDefs.contains(def.first)) {
+                config->logger->debug("Overlay path unavailable: an existing file defines a new definition's name");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TypecheckRun LSPTypechecker::runOverlayPath(LSPFileUpdates updates) const {
+    Timer timeit(config->logger, "overlay_path");
+    prodCategoryCounterInc("lsp.updates", "overlaypath");
+    config->logger->debug("Taking overlay path: {} added file(s) with strictly new definitions",
+                          updates.updatedFiles.size());
+    ENFORCE(gs->errorQueue->isEmpty());
+
+    vector<core::FileRef> subset;
+    vector<ast::ParsedFile> updatedIndexed;
+    for (auto &f : updates.updatedFiles) {
+        auto fref = gs->enterFile(f);
+        fref.data(*gs).strictLevel = pipeline::decideStrictLevel(*gs, fref, config->opts);
+        unique_ptr<KeyValueStore> treeCache; // nullptr
+        auto t = pipeline::indexOne(config->opts, *gs, fref, treeCache);
+        updatedIndexed.emplace_back(ast::ParsedFile{t.tree->deepCopy(), t.file});
+        updates.updatedFinalGSFileIndexes.push_back(move(t));
+        subset.emplace_back(fref);
+    }
+    // commitTypecheckRun stores updatedFileIndexes by the file ids the preprocessor assigned; the
+    // live gs must have handed out the same ids, or the two file tables have diverged.
+    ENFORCE(updates.updatedFileIndexes.size() == subset.size());
+    for (size_t j = 0; j < subset.size(); j++) {
+        ENFORCE(updates.updatedFileIndexes[j].file.id() == subset[j].id());
+    }
+
+    ENFORCE(gs->lspQuery.isEmpty());
+    auto resolved = pipeline::incrementalResolve(*gs, move(updatedIndexed), config->opts, config->workers,
+                                                 /* containsNewDefinitions */ true);
+    vector<core::FileRef> sigSuggestionsDeferred;
+    pipeline::typecheck(gs, move(resolved), config->opts, config->workers, nullptr, &sigSuggestionsDeferred);
+    auto out = gs->errorQueue->drainWithQueryResponses();
+    gs->lspTypecheckCount++;
+    auto run = TypecheckRun(move(out.first), move(subset), move(updates), true);
+    run.sigSuggestionsDeferred = move(sigSuggestionsDeferred);
+    return run;
 }
 
 namespace {
@@ -150,13 +485,40 @@ TypecheckRun LSPTypechecker::runSlowPath(LSPFileUpdates updates, bool isCancelab
     UnorderedSet<int> updatedFiles;
     vector<ast::ParsedFile> indexedCopies;
     vector<core::FileRef> affectedFiles;
+    vector<core::FileRef> sigSuggestionsDeferred;
+    bool restoredFromSnapshot = false;
     auto finalGS = move(updates.updatedGS.value());
     // Replace error queue with one that is owned by this thread.
     finalGS->errorQueue = make_shared<core::ErrorQueue>(finalGS->errorQueue->logger, finalGS->errorQueue->tracer);
     finalGS->errorQueue->ignoreFlushes = true;
+    if (isCancelable && preemptionWaiting != nullptr) {
+        // Let pipeline::typecheck run queued interactive work at file boundaries while this run is in progress.
+        // That work reads `this->gs`, which stays at the last committed state until commitTypecheckRun.
+        finalGS->lspPreemptionWaiting = preemptionWaiting;
+        finalGS->lspRunPreemptionTasks = runPreemptionTasks;
+    }
     // Note: Commits can only be canceled if this edit is cancelable, LSP is running across multiple threads, and the
     // cancelation feature is enabled.
     const bool committed = finalGS->tryCommitEpoch(updates.versionEnd, isCancelable, [&]() -> void {
+        if (this->gs == nullptr && kvstore != nullptr) {
+            // Initial typecheck of the session: a snapshot of the fully typechecked GlobalState
+            // from a previous clean run against identical file contents lets a restarted server
+            // skip resolution and typechecking entirely. The preprocessor has already entered
+            // every workspace file into `finalGS`, so the key reflects current editor state.
+            // Snapshots are only written for runs that reported no errors (see pushDiagnostics),
+            // so there are no diagnostics to replay.
+            auto snapshot = kvstore->read(workspaceSnapshotKey(*finalGS));
+            if (snapshot != nullptr) {
+                Timer timeit(logger, "lsp.workspace_snapshot.restore");
+                auto filesBefore = finalGS->filesUsed();
+                core::serialize::Serializer::overwriteGlobalState(*finalGS, snapshot);
+                ENFORCE(finalGS->filesUsed() == filesBefore);
+                restoredFromSnapshot = true;
+                prodCounterInc("lsp.workspace_snapshot.hit");
+                return;
+            }
+            prodCounterInc("lsp.workspace_snapshot.miss");
+        }
         // Index the updated files using finalGS.
         {
             core::UnfreezeFileTable fileTableAccess(*finalGS);
@@ -174,9 +536,17 @@ TypecheckRun LSPTypechecker::runSlowPath(LSPFileUpdates updates, bool isCancelab
 
         // Copy the indexes of unchanged files.
         for (const auto &tree : indexed) {
-            // Note: indexed entries for payload files don't have any contents.
-            if (tree.tree && !updatedFiles.contains(tree.file.id())) {
+            if (updatedFiles.contains(tree.file.id())) {
+                continue;
+            }
+            if (tree.tree) {
                 indexedCopies.emplace_back(ast::ParsedFile{tree.tree->deepCopy(), tree.file});
+            } else if (evictedIndexed.contains(tree.file.id())) {
+                // Evicted under --lsp-tree-cache-size. Rebuild against finalGS for this run only,
+                // without repopulating `indexed`: this lambda may be running an epoch that gets
+                // canceled. Remaining empty slots are payload files, which have no contents.
+                indexedCopies.emplace_back(pipeline::indexOne(config->opts, *finalGS, tree.file, kvstore));
+                prodCounterInc("lsp.tree_cache.reloaded");
             }
         }
         if (finalGS->wasTypecheckingCanceled()) {
@@ -193,7 +563,12 @@ TypecheckRun LSPTypechecker::runSlowPath(LSPFileUpdates updates, bool isCancelab
             return;
         }
 
-        auto &resolved = maybeResolved.result();
+        auto resolved = move(maybeResolved.result());
+        // Resolution above ran globally, so the symbol table is consistent; inference is what gets
+        // scoped. The initial typecheck (gs not yet committed) always checks everything.
+        if (config->opts.lspScopedTypecheckEnabled && this->gs != nullptr) {
+            resolved = scopeToDependencyClosure(move(resolved), updates, updatedFiles);
+        }
         for (auto &tree : resolved) {
             ENFORCE(tree.file.exists());
             affectedFiles.push_back(tree.file);
@@ -201,16 +576,25 @@ TypecheckRun LSPTypechecker::runSlowPath(LSPFileUpdates updates, bool isCancelab
         if (finalGS->sleepInSlowPath) {
             Timer::timedSleep(3000ms, *logger, "slow_path.typecheck.sleep");
         }
-        pipeline::typecheck(finalGS, move(resolved), config->opts, config->workers);
+        pipeline::typecheck(finalGS, move(resolved), config->opts, config->workers, nullptr,
+                            &sigSuggestionsDeferred);
     });
 
+    // The hooks are scoped to this run; `finalGS` becomes the committed GlobalState on success and must not
+    // carry them into fast paths and queries.
+    finalGS->lspPreemptionWaiting = nullptr;
+    finalGS->lspRunPreemptionTasks = nullptr;
+
     auto out = finalGS->errorQueue->drainWithQueryResponses();
     finalGS->lspTypecheckCount++;
     finalGS->lspQuery = core::lsp::Query::noQuery();
 
     if (committed) {
         prodCategoryCounterInc("lsp.updates", "slowpath");
-        return TypecheckRun(move(out.first), move(affectedFiles), move(updates), false, move(finalGS));
+        auto run = TypecheckRun(move(out.first), move(affectedFiles), move(updates), false, move(finalGS));
+        run.restoredFromSnapshot = restoredFromSnapshot;
+        run.sigSuggestionsDeferred = move(sigSuggestionsDeferred);
+        return run;
     } else {
         prodCategoryCounterInc("lsp.updates", "slowpath_canceled");
         // Drain any enqueued errors from aborted typechecking run.
@@ -221,6 +605,12 @@ TypecheckRun LSPTypechecker::runSlowPath(LSPFileUpdates updates, bool isCancelab
 
 void LSPTypechecker::pushDiagnostics(TypecheckRun run) {
     ENFORCE(!run.canceled);
+    // A retypecheck of a file supersedes any earlier deferral; re-add the files this run itself
+    // left unfinished so idleResumeSigSuggestions can pick them up.
+    for (auto fref : run.filesTypechecked) {
+        sigSuggestionDeferredFiles.erase(fref);
+    }
+    sigSuggestionDeferredFiles.insert(run.sigSuggestionsDeferred.begin(), run.sigSuggestionsDeferred.end());
     const auto &filesTypechecked = run.filesTypechecked;
     vector<core::FileRef> errorFilesInNewRun;
     UnorderedMap<core::FileRef, vector<std::unique_ptr<core::Error>>> errorsAccumulated;
@@ -329,14 +719,186 @@ void LSPTypechecker::pushDiagnostics(TypecheckRun run) {
                 }
             }
 
+            // Hash what the client would actually see. Editors diff each publication against the
+            // previous one, so republishing an identical set — the common case when a migration
+            // leaves hundreds of diagnostics untouched across fast path runs — only burns
+            // serialization time and editor churn. A 32-bit collision suppresses a real update,
+            // but the inputs include every range, message, and code, so ranges shift on any edit
+            // to the file and collisions require two distinct diagnostic sets to collide exactly.
+            u4 diagnosticHash = static_cast<u4>(diagnostics.size());
+            auto hashRange = [&diagnosticHash](const unique_ptr<Range> &range) {
+                diagnosticHash = core::mix(diagnosticHash, range->start->line);
+                diagnosticHash = core::mix(diagnosticHash, range->start->character);
+                diagnosticHash = core::mix(diagnosticHash, range->end->line);
+                diagnosticHash = core::mix(diagnosticHash, range->end->character);
+            };
+            for (auto &diagnostic : diagnostics) {
+                hashRange(diagnostic->range);
+                diagnosticHash = core::mix(diagnosticHash, core::_hash(diagnostic->message));
+                if (diagnostic->code.has_value()) {
+                    if (auto *code = get_if<int>(&diagnostic->code.value())) {
+                        diagnosticHash = core::mix(diagnosticHash, *code);
+                    }
+                }
+                if (diagnostic->relatedInformation.has_value()) {
+                    for (auto &related : diagnostic->relatedInformation.value()) {
+                        diagnosticHash = core::mix(diagnosticHash, core::_hash(related->location->uri));
+                        hashRange(related->location->range);
+                        diagnosticHash = core::mix(diagnosticHash, core::_hash(related->message));
+                    }
+                }
+            }
+            auto lastPublished = publishedDiagnosticHashes.find(file);
+            if (lastPublished != publishedDiagnosticHashes.end() && lastPublished->second == diagnosticHash) {
+                prodCategoryCounterInc("lsp.diagnostics", "unchanged_skipped");
+                continue;
+            }
+            publishedDiagnosticHashes[file] = diagnosticHash;
+            prodCategoryCounterInc("lsp.diagnostics", "published");
+
             config->output->write(make_unique<LSPMessage>(
                 make_unique<NotificationMessage>("2.0", LSPMethod::TextDocumentPublishDiagnostics,
                                                  make_unique<PublishDiagnosticsParams>(uri, move(diagnostics)))));
         }
     }
+
+    // Remember the errors reported for each typechecked file so that the fast path can replay diagnostics for
+    // methods it prunes.
+    for (auto file : filesTypecheckedAsSet) {
+        errorsFromLastRun.erase(file);
+    }
+    for (auto &accumulated : errorsAccumulated) {
+        errorsFromLastRun[accumulated.first] = move(accumulated.second);
+    }
+
+    // Seed the restart snapshot once a slow path leaves the workspace clean. Errors are not
+    // serialized, so a run that left diagnostics in any file (including files it did not
+    // retypecheck) must not seed it: a restored server would silently drop them. Flushed
+    // explicitly because the server never closes the store cleanly at exit.
+    if (!run.tookFastPath && !run.restoredFromSnapshot && kvstore != nullptr && !gs->hadCriticalError() &&
+        filesThatHaveErrors.empty()) {
+        Timer timeit(config->logger, "lsp.workspace_snapshot.store");
+        kvstore->write(workspaceSnapshotKey(*gs), core::serialize::Serializer::store(*gs));
+        kvstore->flush();
+        prodCounterInc("lsp.workspace_snapshot.stored");
+    }
     return;
 }
 
+bool LSPTypechecker::retargetQueryResponseIndex(FileQueryResponses &entry, core::FileRef fref, ast::ParsedFile &tree,
+                                                const core::FileHash &oldHash, const core::FileHash &newHash,
+                                                const QueryIndexRemap &remap) {
+    Timer timeit(config->logger, "lsp.retarget_query_index");
+    // Diff the per-method body hashes. The fast path guarantees the key sets match; if they do
+    // not, the edit reshaped the file's definitions and the entry cannot be preserved.
+    if (oldHash.definitions.methodHashes.size() != newHash.definitions.methodHashes.size()) {
+        return false;
+    }
+    UnorderedSet<core::NameHash> changedSet;
+    for (const auto &p : newHash.definitions.methodHashes) {
+        auto fnd = oldHash.definitions.methodHashes.find(p.first);
+        if (fnd == oldHash.definitions.methodHashes.end()) {
+            return false;
+        }
+        if (fnd->second != p.second) {
+            changedSet.insert(p.first);
+        }
+    }
+
+    // Find the spans (in post-edit coordinates) of the methods whose responses the edit may have
+    // invalidated.
+    InvalidatedMethodSpanCollector collector(changedSet);
+    core::Context ctx(*gs, core::Symbols::root());
+    tree.tree = ast::TreeMap::apply(ctx, collector, move(tree.tree));
+    if (collector.looseCodeUsesChangedName) {
+        return false;
+    }
+
+    const int64_t delta = static_cast<int64_t>(remap.newSuffixStart) - static_cast<int64_t>(remap.oldSuffixStart);
+    // Maps a pre-edit loc in this file to its post-edit position: locs before the edited text
+    // region are unchanged, locs after it shift by the edit's size delta, and locs intersecting it
+    // have no post-edit equivalent.
+    auto shiftLoc = [&](core::Loc loc) -> optional<core::Loc> {
+        if (!loc.exists() || loc.file() != fref) {
+            return loc;
+        }
+        if (loc.endPos() <= remap.prefixLen) {
+            return loc;
+        }
+        if (loc.beginPos() >= remap.oldSuffixStart) {
+            return core::Loc(fref, static_cast<u4>(loc.beginPos() + delta), static_cast<u4>(loc.endPos() + delta));
+        }
+        return nullopt;
+    };
+    auto shiftOrigins = [&](const core::TypeAndOrigins &tp) {
+        core::TypeAndOrigins res;
+        res.type = tp.type;
+        for (auto origin : tp.origins) {
+            auto shifted = shiftLoc(origin);
+            // Origins are informational; one that lands in the edited region keeps its pre-edit
+            // position rather than invalidating the whole response.
+            res.origins.emplace_back(shifted.value_or(origin));
+        }
+        return res;
+    };
+    auto rebuild = [&](const core::lsp::QueryResponse &r, core::Loc loc) -> unique_ptr<core::lsp::QueryResponse> {
+        if (auto send = r.isSend()) {
+            return make_unique<core::lsp::QueryResponse>(
+                core::lsp::SendResponse(loc, send->dispatchResult, send->callerSideName, send->isPrivateOk));
+        } else if (auto ident = r.isIdent()) {
+            return make_unique<core::lsp::QueryResponse>(
+                core::lsp::IdentResponse(ident->owner, loc, ident->variable, shiftOrigins(ident->retType)));
+        } else if (auto lit = r.isLiteral()) {
+            return make_unique<core::lsp::QueryResponse>(
+                core::lsp::LiteralResponse(lit->owner, loc, shiftOrigins(lit->retType)));
+        } else if (auto constant = r.isConstant()) {
+            auto tp = shiftOrigins(constant->retType);
+            return make_unique<core::lsp::QueryResponse>(
+                core::lsp::ConstantResponse(constant->owner, constant->symbol, loc, constant->name, tp, tp));
+        }
+        auto def = r.isDefinition();
+        ENFORCE(def != nullptr);
+        return make_unique<core::lsp::QueryResponse>(
+            core::lsp::DefinitionResponse(def->symbol, loc, def->name, shiftOrigins(def->retType)));
+    };
+
+    FileQueryResponses retargeted;
+    for (auto &resp : entry.responses) {
+        auto loc = resp->getLoc();
+        auto shifted = shiftLoc(loc);
+        if (!shifted.has_value()) {
+            continue;
+        }
+        bool invalidated = false;
+        for (auto span : collector.invalidatedSpans) {
+            if (span.beginPos() < shifted->endPos() && shifted->beginPos() < span.endPos()) {
+                invalidated = true;
+                break;
+            }
+        }
+        if (invalidated) {
+            continue;
+        }
+        if (*shifted == loc && delta == 0) {
+            // Nothing in this response can have moved; reuse it as-is.
+            retargeted.responses.emplace_back(move(resp));
+        } else {
+            retargeted.responses.emplace_back(rebuild(*resp, *shifted));
+        }
+    }
+    for (u4 i = 0; i < retargeted.responses.size(); i++) {
+        auto loc = retargeted.responses[i]->getLoc();
+        // Mirror buildQueryResponseIndex: zero-length locs never match a position.
+        if (loc.exists() && loc.endPos() > loc.beginPos()) {
+            retargeted.locIndex.insert(loc, i);
+        }
+    }
+    retargeted.locIndex.build();
+    prodCounterAdd("lsp.fastpath.query_responses_retained", retargeted.responses.size());
+    entry = move(retargeted);
+    return true;
+}
+
 void LSPTypechecker::commitTypecheckRun(TypecheckRun run) {
     auto &logger = config->logger;
     if (run.canceled) {
@@ -351,6 +913,8 @@ void LSPTypechecker::commitTypecheckRun(TypecheckRun run) {
     // Clear out state associated with old finalGS.
     if (!run.tookFastPath) {
         indexedFinalGS.clear();
+        // Cached query responses hold SymbolRefs and types from the replaced GlobalState.
+        queryResponseIndex.clear();
     }
 
     int i = -1;
@@ -366,7 +930,27 @@ void LSPTypechecker::commitTypecheckRun(TypecheckRun run) {
             globalStateHashes.resize(id + 1);
         }
         indexed[id] = move(ast);
+        evictedIndexed.erase(id);
+        touchIndexed(id);
+        // Fast-path edits only change behavior within the edited files (signature changes force the
+        // slow path), so the rest of the query index stays valid. The edited file's own entry is
+        // retargeted onto the new text where possible — dropping only the responses in methods the
+        // edit could have affected — and dropped wholesale otherwise.
+        auto queryEntry = queryResponseIndex.find(id);
+        if (queryEntry != queryResponseIndex.end()) {
+            auto remap = run.queryIndexRemaps.find(id);
+            if (remap == run.queryIndexRemaps.end() ||
+                !retargetQueryResponseIndex(queryEntry->second, core::FileRef(id), indexed[id],
+                                            globalStateHashes[id], updates.updatedFileHashes[i], remap->second)) {
+                queryResponseIndex.erase(id);
+                prodCategoryCounterInc("lsp.updates", "query_index_dropped");
+            } else {
+                prodCategoryCounterInc("lsp.updates", "query_index_retargeted");
+            }
+        }
+        removeFileFromNameUsageIndex(core::FileRef(id), globalStateHashes[id]);
         globalStateHashes[id] = move(updates.updatedFileHashes[i]);
+        addFileToNameUsageIndex(core::FileRef(id), globalStateHashes[id]);
     }
 
     for (auto &ast : updates.updatedFinalGSFileIndexes) {
@@ -377,6 +961,8 @@ void LSPTypechecker::commitTypecheckRun(TypecheckRun run) {
         gs = move(run.newGS.value());
     }
 
+    evictIndexedTrees();
+
     return pushDiagnostics(move(run));
 }
 
@@ -397,7 +983,8 @@ void tryApplyLocalVarSaver(const core::GlobalState &gs, vector<ast::ParsedFile>
 }
 
 void tryApplyDefLocSaver(const core::GlobalState &gs, vector<ast::ParsedFile> &indexedCopies) {
-    if (gs.lspQuery.kind != core::lsp::Query::Kind::LOC && gs.lspQuery.kind != core::lsp::Query::Kind::SYMBOL) {
+    if (gs.lspQuery.kind != core::lsp::Query::Kind::LOC && gs.lspQuery.kind != core::lsp::Query::Kind::FILE &&
+        gs.lspQuery.kind != core::lsp::Query::Kind::SYMBOL) {
         return;
     }
     for (auto &t : indexedCopies) {
@@ -408,7 +995,8 @@ void tryApplyDefLocSaver(const core::GlobalState &gs, vector<ast::ParsedFile> &i
 }
 } // namespace
 
-LSPQueryResult LSPTypechecker::query(const core::lsp::Query &q, const std::vector<core::FileRef> &filesForQuery) const {
+vector<unique_ptr<core::lsp::QueryResponse>>
+LSPTypechecker::runQuery(const core::lsp::Query &q, const std::vector<core::FileRef> &filesForQuery) const {
     // We assume gs is a copy of initialGS, which has had the inferencer & resolver run.
     ENFORCE(gs->lspTypecheckCount > 0,
             "Tried to run a query with a GlobalState object that never had inferencer and resolver runs.");
@@ -418,9 +1006,7 @@ LSPQueryResult LSPTypechecker::query(const core::lsp::Query &q, const std::vecto
     ENFORCE(gs->errorQueue->isEmpty());
     vector<ast::ParsedFile> updatedIndexed;
     for (auto &f : filesForQuery) {
-        const int id = f.id();
-        const auto it = indexedFinalGS.find(id);
-        const auto &parsedFile = it == indexedFinalGS.end() ? indexed[id] : it->second;
+        const auto &parsedFile = getIndex(f);
         if (parsedFile.tree) {
             updatedIndexed.emplace_back(ast::ParsedFile{parsedFile.tree->deepCopy(), parsedFile.file});
         }
@@ -428,14 +1014,146 @@ LSPQueryResult LSPTypechecker::query(const core::lsp::Query &q, const std::vecto
 
     ENFORCE(gs->lspQuery.isEmpty());
     gs->lspQuery = q;
-    auto resolved = pipeline::incrementalResolve(*gs, move(updatedIndexed), config->opts);
+    auto resolved = pipeline::incrementalResolve(*gs, move(updatedIndexed), config->opts, config->workers);
     tryApplyDefLocSaver(*gs, resolved);
     tryApplyLocalVarSaver(*gs, resolved);
     pipeline::typecheck(gs, move(resolved), config->opts, config->workers);
     auto out = gs->errorQueue->drainWithQueryResponses();
     gs->lspTypecheckCount++;
     gs->lspQuery = core::lsp::Query::noQuery();
-    return LSPQueryResult{move(out.second)};
+    return move(out.second);
+}
+
+namespace {
+// Bounds the memory held by queryResponseIndex; hitting the cap wholesale-clears the index, which
+// only costs a rebuild on the next query per file.
+constexpr size_t MAX_QUERY_RESPONSE_INDEX_FILES = 16;
+// Bounds how many evicted trees a single didOpen prefetches back in. Reloading more than this is
+// unlikely to help the opened file's queries and would churn the tree cache's LRU order.
+constexpr size_t MAX_PREFETCHED_TREES = 64;
+} // namespace
+
+LSPQueryResult LSPTypechecker::query(const core::lsp::Query &q, const std::vector<core::FileRef> &filesForQuery) const {
+    if (q.kind != core::lsp::Query::Kind::LOC || filesForQuery.size() != 1) {
+        // SYMBOL and VAR queries span files and are not position-keyed; run them directly.
+        auto responses = runQuery(q, filesForQuery);
+        if (q.isCanceled()) {
+            // Inference aborted mid-file; the responses are incomplete and the client no longer
+            // wants them.
+            prodCategoryCounterInc("lsp.updates", "query_canceled");
+            responses.clear();
+        }
+        return LSPQueryResult{move(responses)};
+    }
+
+    // Location queries (hover, go-to-definition, ...) against an unchanged file are served from a
+    // per-file index built by running the whole-file query once; each subsequent query is a filter
+    // over the stored responses instead of a re-resolve + re-infer of the file.
+    const auto fref = filesForQuery[0];
+    const FileQueryResponses *entry;
+    auto it = queryResponseIndex.find(fref.id());
+    if (it == queryResponseIndex.end()) {
+        entry = buildQueryResponseIndex(fref, q.canceled);
+        if (entry == nullptr) {
+            return LSPQueryResult{{}};
+        }
+    } else {
+        prodCategoryCounterInc("lsp.updates", "query_index_hit");
+        entry = &it->second;
+    }
+
+    LSPQueryResult result;
+    for (auto respIdx : entry->locIndex.containing(q.loc)) {
+        result.responses.emplace_back(make_unique<core::lsp::QueryResponse>(*entry->responses[respIdx]));
+    }
+    return result;
+}
+
+const LSPTypechecker::FileQueryResponses *
+LSPTypechecker::buildQueryResponseIndex(core::FileRef fref,
+                                        std::shared_ptr<const std::atomic<bool>> canceled) const {
+    auto fileQuery = core::lsp::Query::createFileQuery(fref);
+    fileQuery.canceled = move(canceled);
+    FileQueryResponses entry;
+    entry.responses = runQuery(fileQuery, {fref});
+    if (fileQuery.isCanceled()) {
+        // Inference aborted mid-file, so the responses cover only part of it; caching them
+        // would serve wrong answers to later queries.
+        prodCategoryCounterInc("lsp.updates", "query_canceled");
+        return nullptr;
+    }
+    for (u4 i = 0; i < entry.responses.size(); i++) {
+        auto loc = entry.responses[i]->getLoc();
+        // Mirror Query::matchesLoc: zero-length locs never match a position, so don't index them.
+        if (loc.exists() && loc.endPos() > loc.beginPos()) {
+            entry.locIndex.insert(loc, i);
+        }
+    }
+    entry.locIndex.build();
+    if (queryResponseIndex.size() >= MAX_QUERY_RESPONSE_INDEX_FILES) {
+        queryResponseIndex.clear();
+    }
+    return &queryResponseIndex.emplace(fref.id(), move(entry)).first->second;
+}
+
+void LSPTypechecker::prefetchOpenedFiles(const vector<string> &paths) const {
+    Timer timeit(config->logger, "lsp.prefetch_opened_files");
+    auto reloadBudget = min(MAX_PREFETCHED_TREES, static_cast<size_t>(config->opts.lspTreeCacheSize));
+    for (auto &path : paths) {
+        auto fref = gs->findFileByPath(path);
+        if (!fref.exists() || static_cast<size_t>(fref.id()) >= globalStateHashes.size()) {
+            continue;
+        }
+        prodCategoryCounterInc("lsp.prefetch", "opened_file");
+        // Warm the opened file's own tree; under --lsp-tree-cache-size this re-indexes it if it was
+        // evicted and marks it recently used either way.
+        getIndex(fref);
+        // Warm the trees of the files defining the methods and constants the opened file uses —
+        // the files whose information hovers and go-to-definitions here will pull in. Only evicted
+        // trees cost anything to reload, and trees are only ever evicted when --lsp-tree-cache-size
+        // is set, so a zero budget skips the scan entirely.
+        if (reloadBudget > 0 && !evictedIndexed.empty()) {
+            const auto &usages = globalStateHashes[fref.id()].usages;
+            UnorderedSet<core::NameHash> usedNames(usages.sends.begin(), usages.sends.end());
+            usedNames.insert(usages.constants.begin(), usages.constants.end());
+            int i = -1;
+            for (const auto &hash : globalStateHashes) {
+                i++;
+                if (reloadBudget == 0) {
+                    break;
+                }
+                if (!evictedIndexed.contains(i)) {
+                    continue;
+                }
+                bool definesUsedName = false;
+                for (const auto &p : hash.definitions.methodHashes) {
+                    if (usedNames.contains(p.first)) {
+                        definesUsedName = true;
+                        break;
+                    }
+                }
+                if (!definesUsedName) {
+                    for (const auto &p : hash.definitions.constantHashes) {
+                        if (usedNames.contains(p.first)) {
+                            definesUsedName = true;
+                            break;
+                        }
+                    }
+                }
+                if (definesUsedName) {
+                    reloadIndexed(core::FileRef(i));
+                    reloadBudget--;
+                    prodCategoryCounterInc("lsp.prefetch", "warmed_tree");
+                }
+            }
+        }
+        // Pre-build the opened file's position index so the first location query is an index hit
+        // instead of a whole-file re-resolve and re-infer.
+        if (!queryResponseIndex.contains(fref.id())) {
+            buildQueryResponseIndex(fref, nullptr);
+            prodCategoryCounterInc("lsp.prefetch", "position_index_built");
+        }
+    }
 }
 
 TypecheckRun LSPTypechecker::retypecheck(LSPFileUpdates updates) const {
@@ -463,6 +1181,65 @@ const ast::ParsedFile &LSPTypechecker::getIndex(core::FileRef fref) const {
         return treeFinalGS->second;
     }
     ENFORCE(id < indexed.size());
+    if (evictedIndexed.contains(id)) {
+        return reloadIndexed(fref);
+    }
+    touchIndexed(id);
+    return indexed[id];
+}
+
+void LSPTypechecker::touchIndexed(int id) const {
+    if (config->opts.lspTreeCacheSize == 0) {
+        return;
+    }
+    if (indexedLastUse.size() < indexed.size()) {
+        indexedLastUse.resize(indexed.size());
+    }
+    if (id >= 0 && static_cast<size_t>(id) < indexedLastUse.size()) {
+        indexedLastUse[id] = ++indexedUseTick;
+    }
+}
+
+void LSPTypechecker::evictIndexedTrees() {
+    const auto budget = static_cast<size_t>(config->opts.lspTreeCacheSize);
+    if (budget == 0) {
+        return;
+    }
+    if (indexedLastUse.size() < indexed.size()) {
+        indexedLastUse.resize(indexed.size());
+    }
+    vector<pair<u4, int>> resident;
+    for (size_t id = 0; id < indexed.size(); id++) {
+        if (indexed[id].tree != nullptr) {
+            resident.emplace_back(indexedLastUse[id], id);
+        }
+    }
+    if (resident.size() <= budget) {
+        return;
+    }
+    Timer timeit(config->logger, "lsp.tree_cache.evict");
+    auto toEvict = resident.size() - budget;
+    fast_sort(resident, [](const auto &l, const auto &r) -> bool { return l.first < r.first; });
+    for (size_t i = 0; i < toEvict; i++) {
+        auto id = resident[i].second;
+        // The tree can always be rebuilt from the file's contents; destroy it (and the arena
+        // backing its nodes) now and remember that the empty slot is an eviction, not a payload
+        // file.
+        indexed[id].tree.reset();
+        indexed[id].arena.reset();
+        evictedIndexed.insert(id);
+    }
+    prodCounterAdd("lsp.tree_cache.evicted", toEvict);
+    config->logger->debug("Evicted {} indexed trees (budget {})", toEvict, budget);
+}
+
+const ast::ParsedFile &LSPTypechecker::reloadIndexed(core::FileRef fref) const {
+    Timer timeit(config->logger, "lsp.tree_cache.reload");
+    prodCounterInc("lsp.tree_cache.reloaded");
+    const int id = fref.id();
+    indexed[id] = pipeline::indexOne(config->opts, *gs, fref, kvstore);
+    evictedIndexed.erase(id);
+    touchIndexed(id);
     return indexed[id];
 }
 
@@ -470,10 +1247,195 @@ const std::vector<core::FileHash> &LSPTypechecker::getFileHashes() const {
     return globalStateHashes;
 }
 
+const std::vector<std::unique_ptr<core::Error>> *LSPTypechecker::errorsForFile(core::FileRef file) const {
+    auto it = errorsFromLastRun.find(file);
+    if (it == errorsFromLastRun.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
 const core::GlobalState &LSPTypechecker::state() const {
     return *gs;
 }
 
+SymbolNameIndex &LSPTypechecker::getSymbolNameIndex() {
+    return symbolNameIndex;
+}
+
+CompletionIndex &LSPTypechecker::getCompletionIndex() {
+    return completionIndex;
+}
+
+DocumentOutlineIndex &LSPTypechecker::getDocumentOutlineIndex() {
+    return documentOutlineIndex;
+}
+
+vector<ast::ParsedFile> LSPTypechecker::scopeToDependencyClosure(vector<ast::ParsedFile> resolved,
+                                                                 const LSPFileUpdates &updates,
+                                                                 const UnorderedSet<int> &updatedFiles) const {
+    Timer timeit(config->logger, "slow_path.dependency_closure");
+    // Names whose definitions actually changed across the edit: added, deleted, or carrying a
+    // different per-symbol content hash. Seeding the closure from this diff — rather than from
+    // everything the edited files define — keeps dependents of untouched definitions out of the
+    // recheck when only one definition in a large file moved.
+    UnorderedSet<core::NameHash> changedDefs;
+    auto diffDefs = [&changedDefs](const UnorderedMap<core::NameHash, u4> &before,
+                                   const UnorderedMap<core::NameHash, u4> &after) {
+        for (auto &def : after) {
+            auto fnd = before.find(def.first);
+            if (fnd == before.end() || fnd->second != def.second) {
+                changedDefs.insert(def.first);
+            }
+        }
+        for (auto &def : before) {
+            if (!after.contains(def.first)) {
+                changedDefs.insert(def.first);
+            }
+        }
+    };
+    const UnorderedMap<core::NameHash, u4> emptyDefs;
+    int i = -1;
+    for (auto &file : updates.updatedFiles) {
+        i++;
+        auto &newHash = updates.updatedFileHashes[i];
+        auto fref = gs->findFileByPath(file->path());
+        const core::GlobalStateHash *oldDefs = nullptr;
+        if (fref.exists() && fref.id() < globalStateHashes.size()) {
+            oldDefs = &globalStateHashes[fref.id()].definitions;
+        }
+        diffDefs(oldDefs != nullptr ? oldDefs->methodHashes : emptyDefs, newHash.definitions.methodHashes);
+        diffDefs(oldDefs != nullptr ? oldDefs->constantHashes : emptyDefs, newHash.definitions.constantHashes);
+    }
+
+    UnorderedSet<int> closure(updatedFiles.begin(), updatedFiles.end());
+    for (auto &def : changedDefs) {
+        auto it = nameUsageIndex.find(def);
+        if (it == nameUsageIndex.end()) {
+            continue;
+        }
+        for (auto fref : it->second) {
+            closure.insert(fref.id());
+        }
+    }
+
+    vector<ast::ParsedFile> scoped;
+    scoped.reserve(closure.size());
+    for (auto &tree : resolved) {
+        if (closure.contains(tree.file.id())) {
+            scoped.emplace_back(move(tree));
+        }
+    }
+    prodCounterAdd("lsp.scoped_slow_path.files_checked", scoped.size());
+    prodCounterAdd("lsp.scoped_slow_path.files_skipped", resolved.size() - scoped.size());
+    config->logger->debug("Scoped slow path: typechecking {} of {} files", scoped.size(), resolved.size());
+    return scoped;
+}
+
+void LSPTypechecker::addFileToNameUsageIndex(core::FileRef fref, const core::FileHash &hash) {
+    // usages.sends and usages.constants are each sorted and deduped; the back() check below catches names that
+    // appear in both.
+    for (auto nameHash : hash.usages.sends) {
+        auto &posting = nameUsageIndex[nameHash];
+        if (posting.empty() || posting.back() != fref) {
+            posting.emplace_back(fref);
+        }
+    }
+    for (auto nameHash : hash.usages.constants) {
+        auto &posting = nameUsageIndex[nameHash];
+        if (posting.empty() || posting.back() != fref) {
+            posting.emplace_back(fref);
+        }
+    }
+}
+
+void LSPTypechecker::removeFileFromNameUsageIndex(core::FileRef fref, const core::FileHash &hash) {
+    auto removeOne = [&](core::NameHash nameHash) {
+        auto it = nameUsageIndex.find(nameHash);
+        if (it == nameUsageIndex.end()) {
+            return;
+        }
+        auto &posting = it->second;
+        posting.erase(remove(posting.begin(), posting.end(), fref), posting.end());
+        if (posting.empty()) {
+            nameUsageIndex.erase(it);
+        }
+    };
+    for (auto nameHash : hash.usages.sends) {
+        removeOne(nameHash);
+    }
+    for (auto nameHash : hash.usages.constants) {
+        removeOne(nameHash);
+    }
+}
+
+vector<core::FileRef> LSPTypechecker::getFilesThatUseName(core::NameHash nameHash) const {
+    auto it = nameUsageIndex.find(nameHash);
+    if (it == nameUsageIndex.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+namespace {
+// How many sessions a cache entry may go unreferenced before the idle sweep evicts it. Long enough
+// that a branch left alone for a week of restarts keeps its entries; short enough that deleted
+// files' stale trees do not accumulate forever.
+constexpr u8 CACHE_SWEEP_MAX_AGE_SESSIONS = 10;
+// Entries examined per idle slice; bounds how long a slice can delay an edit that arrives behind
+// it in the typechecker's queue.
+constexpr size_t CACHE_SWEEP_BUDGET_ENTRIES = 512;
+} // namespace
+
+void LSPTypechecker::idleSweepCache() {
+    ENFORCE(this_thread::get_id() == typecheckerThreadId,
+            "idleSweepCache can only be called from the typechecker thread.");
+    if (kvstore == nullptr || kvstore->sweepComplete()) {
+        return;
+    }
+    Timer timeit(config->logger, "lsp.idle_cache_sweep");
+    kvstore->sweepStale(CACHE_SWEEP_MAX_AGE_SESSIONS, CACHE_SWEEP_BUDGET_ENTRIES);
+}
+
+void LSPTypechecker::idleResumeSigSuggestions() {
+    ENFORCE(this_thread::get_id() == typecheckerThreadId,
+            "idleResumeSigSuggestions can only be called from the typechecker thread.");
+    if (sigSuggestionDeferredFiles.empty()) {
+        return;
+    }
+    Timer timeit(config->logger, "lsp.idle_sig_suggestions");
+    auto fref = *sigSuggestionDeferredFiles.begin();
+    sigSuggestionDeferredFiles.erase(fref);
+    if (!fref.exists() || fref.id() >= globalStateHashes.size()) {
+        return;
+    }
+    // Rerun the file as a no-op fast-path edit: the contents and hashes match the committed state,
+    // so only this file is retypechecked and no method bodies are pruned, which recomputes every
+    // suggestion the budget skipped. The budget is lifted for the rerun — nothing is waiting on
+    // the result, so unbounded suggestion work is fine here.
+    LSPFileUpdates updates;
+    updates.canTakeFastPath = true;
+    updates.updatedFiles.emplace_back(gs->getFiles()[fref.id()]);
+    updates.updatedFileHashes.emplace_back(globalStateHashes[fref.id()]);
+    // Deliberately not getIndex(): commitTypecheckRun stores this entry into `indexed`, which
+    // holds initialGS-indexed trees, and getIndex may return the file's finalGS-indexed tree.
+    if (evictedIndexed.contains(fref.id())) {
+        reloadIndexed(fref);
+    }
+    updates.updatedFileIndexes.emplace_back(ast::ParsedFile{indexed[fref.id()].tree->deepCopy(), fref});
+    auto savedBudget = gs->sigSuggestionBudgetMs;
+    gs->sigSuggestionBudgetMs = 0;
+    auto run = runTypechecking(move(updates));
+    gs->sigSuggestionBudgetMs = savedBudget;
+    commitTypecheckRun(move(run));
+    prodCounterInc("lsp.sig_suggestions_resumed");
+}
+
+void LSPTypechecker::setSlowPathPreemption(std::function<bool()> waiting, std::function<void()> runTasks) {
+    preemptionWaiting = move(waiting);
+    runPreemptionTasks = move(runTasks);
+}
+
 void LSPTypechecker::changeThread() {
     auto newId = this_thread::get_id();
     ENFORCE(newId != typecheckerThreadId);
@@ -9,6 +9,10 @@
 #include "core/core.h"
 #include "main/lsp/LSPConfiguration.h"
 #include "main/lsp/LSPOutput.h"
+#include "main/lsp/CompletionIndex.h"
+#include "main/lsp/DocumentOutlineIndex.h"
+#include "main/lsp/LocIntervalTree.h"
+#include "main/lsp/SymbolNameIndex.h"
 
 namespace sorbet::realmain::lsp {
 
@@ -18,6 +22,16 @@ struct LSPQueryResult {
     std::unique_ptr<ResponseError> error = nullptr;
 };
 
+/** Describes where a fast-path edit changed a file's text: everything before `prefixLen` and at or
+ * after `oldSuffixStart` (old text) / `newSuffixStart` (new text) is byte-identical across the
+ * edit. Recorded while the pre-edit text is still available so commitTypecheckRun can retarget the
+ * file's query-index entry onto the new text instead of discarding it. */
+struct QueryIndexRemap {
+    u4 prefixLen = 0;
+    u4 oldSuffixStart = 0;
+    u4 newSuffixStart = 0;
+};
+
 class TypecheckRun final {
 public:
     // Errors encountered during typechecking.
@@ -30,8 +44,16 @@ public:
     bool tookFastPath;
     // Specifies if the typecheck run was canceled.
     bool canceled = false;
+    // True when the run restored a cached workspace snapshot instead of resolving and typechecking.
+    bool restoredFromSnapshot = false;
     // If update took the slow path, contains a new global state that should be used moving forward.
     std::optional<std::unique_ptr<core::GlobalState>> newGS;
+    // Text-diff info for each updated file that had a query-index entry when the fast path ran,
+    // keyed by file id. See QueryIndexRemap.
+    UnorderedMap<int, QueryIndexRemap> queryIndexRemaps;
+    // Files whose sig-suggestion budget (--sig-suggestion-budget-ms) ran out before every
+    // suggestion was computed. idleResumeSigSuggestions finishes them when the server is idle.
+    std::vector<core::FileRef> sigSuggestionsDeferred;
 
     TypecheckRun(std::vector<std::unique_ptr<core::Error>> errors = {},
                  std::vector<core::FileRef> filesTypechecked = {}, LSPFileUpdates updates = {},
@@ -50,24 +72,140 @@ class LSPTypechecker final {
     /** GlobalState used for typechecking. Mutable because typechecking routines, even when not changing the GlobalState
      * instance, actively consume and replace GlobalState. */
     mutable std::unique_ptr<core::GlobalState> gs;
-    /** Trees that have been indexed (with initialGS) and can be reused between different runs */
-    std::vector<ast::ParsedFile> indexed;
+    /** Trees that have been indexed (with initialGS) and can be reused between different runs.
+     * Mutable because evicted trees (--lsp-tree-cache-size) are transparently re-indexed from
+     * logically-const accessors. */
+    mutable std::vector<ast::ParsedFile> indexed;
+    /** File ids whose `indexed` entry was evicted under --lsp-tree-cache-size. Distinguishes
+     * "evicted, re-index on access" from payload entries that never had contents. */
+    mutable UnorderedSet<int> evictedIndexed;
+    /** Monotonic use counter and per-file last-use ticks backing the LRU eviction policy. Only
+     * maintained when --lsp-tree-cache-size is set. */
+    mutable u4 indexedUseTick = 0;
+    mutable std::vector<u4> indexedLastUse;
     /** Trees that have been indexed (with finalGS) and can be reused between different runs */
     UnorderedMap<int, ast::ParsedFile> indexedFinalGS;
     /** Hashes of global states obtained by resolving every file in isolation. Used for fastpath. */
     std::vector<core::FileHash> globalStateHashes;
     /** List of files that have had errors in last run*/
     std::vector<core::FileRef> filesThatHaveErrors;
-    std::unique_ptr<KeyValueStore> kvstore; // always null for now.
+    /** Errors each file reported the last time it was typechecked. The fast path uses these to
+     * re-emit diagnostics for methods it skipped because their body hash was unchanged. */
+    UnorderedMap<core::FileRef, std::vector<std::unique_ptr<core::Error>>> errorsFromLastRun;
+    /** Files whose sig-suggestion budget ran out during their last typecheck, so their recorded
+     * errors are missing some suggestions. idleResumeSigSuggestions reruns them unbudgeted while
+     * the server is idle; a file drops out as soon as any run retypechecks it. */
+    UnorderedSet<core::FileRef> sigSuggestionDeferredFiles;
+    /** Hash of the diagnostic list most recently published for each file. pushDiagnostics skips
+     * republishing a file whose diagnostic content has not changed since the last publication,
+     * which during migrations spares serializing (and the editor re-diffing) hundreds of
+     * identical diagnostics on every fast path run. */
+    UnorderedMap<core::FileRef, u4> publishedDiagnosticHashes;
+    /** Trigram index over symbol short names; rebuilt lazily when the symbol table changes. */
+    SymbolNameIndex symbolNameIndex;
+    /** Per-class flattened method tables for completion; rebuilt lazily when the symbol table changes. */
+    CompletionIndex completionIndex;
+    /** Per-file outline roots for documentSymbol; rebuilt lazily when the symbol table changes. */
+    DocumentOutlineIndex documentOutlineIndex;
+    /** Maps a name hash to the files whose usage hashes (sends or constants) mention it. Mirrors
+     * `globalStateHashes` and is updated alongside it, so references queries can look up candidate files instead
+     * of scanning every file hash. */
+    UnorderedMap<core::NameHash, std::vector<core::FileRef>> nameUsageIndex;
+    /** Per-file index of query responses, built lazily by running a whole-file query the first time
+     * a location query lands in a file, then served for every later location query in that file
+     * until an edit touches it. Responses are stored in inference emission order; the interval tree
+     * maps a queried position to the indices of the responses whose locs contain it, so a lookup
+     * descends only into the matching subtree instead of scanning every response in the file, and
+     * returning the indices in ascending order preserves the same first-response-wins behavior as a
+     * targeted query. Mutable for the same reason `gs` is: queries are logically const. */
+    struct FileQueryResponses {
+        std::vector<std::unique_ptr<core::lsp::QueryResponse>> responses;
+        /** Interval tree over the responses' locs, valued by index into `responses`. */
+        LocIntervalTree locIndex;
+    };
+    mutable UnorderedMap<int, FileQueryResponses> queryResponseIndex;
+    /** On-disk cache shared with command-line runs (--cache-dir); null when no cache directory is
+     * configured. Opened on the typechecker thread during initialize() because KeyValueStore
+     * restricts writes to its creating thread. Holds the workspace snapshot that lets a restarted
+     * server with unchanged files skip resolution and typechecking. */
+    /** Mutable for the same reason `gs` is: re-indexing an evicted tree from a const accessor
+     * consults (and may refresh) the tree cache. */
+    mutable std::unique_ptr<KeyValueStore> kvstore;
 
     std::shared_ptr<const LSPConfiguration> config;
 
+    /** Hooks installed by LSPTypecheckerCoordinator via setSlowPathPreemption. Cancelable slow paths place them on the
+     * GlobalState they typecheck (see GlobalState::lspPreemptionWaiting) so that queued interactive work can run
+     * against `gs`, which stays at the last committed state until commitTypecheckRun. */
+    std::function<bool()> preemptionWaiting;
+    std::function<void()> runPreemptionTasks;
+
     /** Conservatively reruns entire pipeline without caching any trees. If canceled, returns a TypecheckRun containing
      * the previous global state. */
     TypecheckRun runSlowPath(LSPFileUpdates updates, bool cancelable) const;
     /** Runs typechecking on the provided updates. */
     TypecheckRun runTypechecking(LSPFileUpdates updates) const;
 
+    /** True when the update only adds RBI files whose definitions are strictly new: no existing
+     * file defines or references any name they define. Such updates (e.g. regenerating a gem's
+     * interface) cannot change typechecking results for existing files, so they can be applied as
+     * an incremental symbol-table extension instead of a slow path. */
+    bool canTakeOverlayPath(const LSPFileUpdates &updates) const;
+    /** Applies an update that passed canTakeOverlayPath: enters the new files into the live `gs`,
+     * runs namer and scoped resolver finalization on just those files, and typechecks only them. */
+    TypecheckRun runOverlayPath(LSPFileUpdates updates) const;
+
+    /** Runs `q` over `filesForQuery` by re-resolving and re-typechecking them with the query installed on `gs`. */
+    std::vector<std::unique_ptr<core::lsp::QueryResponse>>
+    runQuery(const core::lsp::Query &q, const std::vector<core::FileRef> &filesForQuery) const;
+
+    /** Builds (and stores) `fref`'s `queryResponseIndex` entry by running a whole-file query.
+     * Returns nullptr — caching nothing — if the run was canceled partway, since partial responses
+     * would serve wrong answers to later queries. */
+    const FileQueryResponses *buildQueryResponseIndex(core::FileRef fref,
+                                                      std::shared_ptr<const std::atomic<bool>> canceled) const;
+
+    /** Retargets `entry` — `fref`'s query-index entry, built against the file's pre-edit text —
+     * onto the committed post-edit state: responses in methods the edit could have affected
+     * (changed body hash, or a body mentioning a changed name — the same criteria the fast path
+     * uses to decide which method bodies to re-infer) are dropped, and the survivors have their
+     * locs shifted across the edited text region described by `remap`. `tree` is the file's
+     * post-edit indexed tree; `oldHash`/`newHash` are its hashes from before and after the edit.
+     * Returns false when the entry cannot be preserved and should be dropped wholesale. */
+    bool retargetQueryResponseIndex(FileQueryResponses &entry, core::FileRef fref, ast::ParsedFile &tree,
+                                    const core::FileHash &oldHash, const core::FileHash &newHash,
+                                    const QueryIndexRemap &remap);
+
+    /** Warms the state that the first interactive query in each newly opened file would otherwise
+     * fault in on demand: the file's own indexed tree, the trees of the files defining the methods
+     * and constants it uses (when --lsp-tree-cache-size may have evicted them), and the file's
+     * `queryResponseIndex` entry. Runs on the typechecker thread right after the didOpen edit
+     * commits, so the first hover or go-to-definition in a freshly opened file is an index hit. */
+    void prefetchOpenedFiles(const std::vector<std::string> &paths) const;
+
+    /** Returns the subset of `resolved` in the dependency closure of the update: the edited files
+     * plus every file whose recorded usage hashes mention a method or constant the edited files
+     * define (or defined before the edit). Used by the scoped slow path
+     * (--enable-experimental-lsp-scoped-typecheck). */
+    std::vector<ast::ParsedFile> scopeToDependencyClosure(std::vector<ast::ParsedFile> resolved,
+                                                          const LSPFileUpdates &updates,
+                                                          const UnorderedSet<int> &updatedFiles) const;
+
+    /** Records a use of `indexed[id]` for the LRU eviction policy. No-op unless
+     * --lsp-tree-cache-size is set. */
+    void touchIndexed(int id) const;
+    /** Enforces --lsp-tree-cache-size by destroying the least-recently-used indexed trees (and the
+     * arenas backing them). Evicted trees are re-indexed on next access. */
+    void evictIndexedTrees();
+    /** Re-indexes an evicted tree from its file's current contents (hitting the on-disk tree cache
+     * when they are unchanged) and stores it back into `indexed`. */
+    const ast::ParsedFile &reloadIndexed(core::FileRef fref) const;
+
+    /** Adds `fref`'s usage hashes to `nameUsageIndex`. */
+    void addFileToNameUsageIndex(core::FileRef fref, const core::FileHash &hash);
+    /** Removes `fref`'s usage hashes from `nameUsageIndex`. Must be passed the same hash it was added with. */
+    void removeFileFromNameUsageIndex(core::FileRef fref, const core::FileHash &hash);
+
     /**
      * Sends diagnostics from a typecheck run to the client.
      */
@@ -114,16 +252,64 @@ public:
      */
     const std::vector<core::FileHash> &getFileHashes() const;
 
+    /**
+     * Returns the errors recorded for `file` by its last typecheck, or nullptr if it reported none.
+     * The recorded errors match the committed file contents, so code actions can answer from them
+     * without retypechecking.
+     */
+    const std::vector<std::unique_ptr<core::Error>> *errorsForFile(core::FileRef file) const;
+
     /**
      * Returns the currently active GlobalState.
      */
     const core::GlobalState &state() const;
 
+    /**
+     * Returns the index over symbol short names used by workspaceSymbols.
+     */
+    SymbolNameIndex &getSymbolNameIndex();
+
+    /**
+     * Returns the per-class completion tables used by textDocument/completion.
+     */
+    CompletionIndex &getCompletionIndex();
+
+    /**
+     * Returns the per-file outline index used by textDocument/documentSymbol.
+     */
+    DocumentOutlineIndex &getDocumentOutlineIndex();
+
+    /**
+     * Returns the files whose recorded usages (sends or constants) mention the given name hash. An
+     * overapproximation of the files that reference a symbol with that name.
+     */
+    std::vector<core::FileRef> getFilesThatUseName(core::NameHash nameHash) const;
+
+    /**
+     * Runs one budgeted slice of stale-entry eviction over the on-disk cache (see
+     * KeyValueStore::sweepStale). Scheduled from the message loop when the request queue drains; a
+     * no-op when no cache directory is configured or once this session's sweep has completed.
+     */
+    void idleSweepCache();
+
+    /**
+     * Retypechecks one file whose sig-suggestion budget ran out, with the budget lifted, so its
+     * diagnostics gain the suggestions the budgeted run skipped. Scheduled from the message loop
+     * when the request queue drains; a no-op when no file has a deferral outstanding.
+     */
+    void idleResumeSigSuggestions();
+
     /**
      * Called by LSPTypecheckerCoordinator to indicate that typechecking will occur on the current thread.
      */
     void changeThread();
 
+    /**
+     * Called by LSPTypecheckerCoordinator to install the hooks that let interactive work preempt a cancelable slow
+     * path at file boundaries.
+     */
+    void setSlowPathPreemption(std::function<bool()> waiting, std::function<void()> runTasks);
+
     /**
      * Returns the typechecker's internal global state, which effectively destroys the typechecker for further use.
      */
@@ -6,7 +6,11 @@ namespace sorbet::realmain::lsp {
 using namespace std;
 
 LSPTypecheckerCoordinator::LSPTypecheckerCoordinator(const shared_ptr<const LSPConfiguration> &config)
-    : shouldTerminate(false), typechecker(config), config(config), hasDedicatedThread(false) {}
+    : preemptTasksWaiting(false), shouldTerminate(false), typechecker(config), config(config),
+      hasDedicatedThread(false) {
+    typechecker.setSlowPathPreemption([this]() -> bool { return preemptTasksWaiting.load(); },
+                                      [this]() -> void { runPreemptTasks(); });
+}
 
 void LSPTypecheckerCoordinator::asyncRunInternal(function<void()> &&lambda) {
     if (hasDedicatedThread) {
@@ -16,25 +20,50 @@ void LSPTypecheckerCoordinator::asyncRunInternal(function<void()> &&lambda) {
     }
 }
 
+void LSPTypecheckerCoordinator::runPreemptTasks() {
+    vector<function<void()>> tasks;
+    {
+        absl::MutexLock lck(&preemptTasksMtx);
+        swap(tasks, preemptTasks);
+        preemptTasksWaiting.store(false);
+    }
+    for (auto &task : tasks) {
+        task();
+    }
+}
+
 void LSPTypecheckerCoordinator::asyncRun(function<void(LSPTypechecker &)> &&lambda) {
     asyncRunInternal([&typechecker = this->typechecker, lambda]() -> void { lambda(typechecker); });
 }
 
-void LSPTypecheckerCoordinator::syncRun(function<void(LSPTypechecker &)> &&lambda) {
+void LSPTypecheckerCoordinator::syncRun(function<void(LSPTypechecker &)> &&lambda, bool canPreemptSlowPath) {
     absl::Notification notification;
     CounterState typecheckerCounters;
     // If typechecker is running on a dedicated thread, then we need to merge its metrics w/ coordinator thread's so we
     // report them.
     // Note: Capturing notification by reference is safe here, we we wait for the notification to happen prior to
     // returning.
-    asyncRunInternal([&typechecker = this->typechecker, lambda, &notification, &typecheckerCounters,
-                      hasDedicatedThread = this->hasDedicatedThread]() -> void {
+    auto wrapped = [&typechecker = this->typechecker, lambda, &notification, &typecheckerCounters,
+                    hasDedicatedThread = this->hasDedicatedThread]() -> void {
         lambda(typechecker);
         if (hasDedicatedThread) {
             typecheckerCounters = getAndClearThreadCounters();
         }
         notification.Notify();
-    });
+    };
+    if (canPreemptSlowPath && hasDedicatedThread) {
+        // The lambda can run against the previously committed GlobalState, so don't make it wait behind a slow path:
+        // queue it where a running slow path will find it at its next file boundary, and enqueue a drain on the
+        // normal queue in case no slow path is running. Whichever runs first claims the task; the other is a no-op.
+        {
+            absl::MutexLock lck(&preemptTasksMtx);
+            preemptTasks.emplace_back(move(wrapped));
+            preemptTasksWaiting.store(true);
+        }
+        lambdas.push([this]() -> void { runPreemptTasks(); }, 1);
+    } else {
+        asyncRunInternal(move(wrapped));
+    }
     notification.WaitForNotification();
     if (hasDedicatedThread) {
         counterConsume(move(typecheckerCounters));
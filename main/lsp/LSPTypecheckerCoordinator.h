@@ -1,6 +1,7 @@
 #ifndef RUBY_TYPER_LSP_LSPTYPECHECKERCOORDINATOR_H
 #define RUBY_TYPER_LSP_LSPTYPECHECKERCOORDINATOR_H
 
+#include "absl/synchronization/mutex.h"
 #include "main/lsp/LSPTypechecker.h"
 
 namespace sorbet::realmain::lsp {
@@ -12,6 +13,14 @@ namespace sorbet::realmain::lsp {
 class LSPTypecheckerCoordinator final {
     /** Contains a queue of functions to run on the typechecking thread. */
     BlockingUnBoundedQueue<std::function<void()>> lambdas;
+    /** Protects preemptTasks. */
+    absl::Mutex preemptTasksMtx;
+    /** Functions that may preempt a running slow path at a file boundary and run against the previously committed
+     * GlobalState (see GlobalState::lspPreemptionWaiting). */
+    std::vector<std::function<void()>> preemptTasks;
+    /** Mirrors `!preemptTasks.empty()`. Lets typechecking workers poll for waiting tasks without contending on the
+     * mutex. */
+    std::atomic<bool> preemptTasksWaiting;
     /** If 'true', the coordinator should terminate immediately. */
     bool shouldTerminate;
     /** LSPTypecheckerCoordinator delegates typechecking operations to LSPTypechecker. */
@@ -25,6 +34,10 @@ class LSPTypecheckerCoordinator final {
      */
     void asyncRunInternal(std::function<void()> &&lambda);
 
+    /** Runs all queued preemption tasks. Runs on the typechecker thread, either from a slow path at a file boundary
+     * or from the lambda queue. */
+    void runPreemptTasks();
+
 public:
     LSPTypecheckerCoordinator(const std::shared_ptr<const LSPConfiguration> &config);
 
@@ -34,9 +47,11 @@ public:
     void asyncRun(std::function<void(LSPTypechecker &)> &&lambda);
 
     /**
-     * Like asyncRun, but blocks until `lambda` completes.
+     * Like asyncRun, but blocks until `lambda` completes. Pass `canPreemptSlowPath` when `lambda` only reads the
+     * committed GlobalState: a running slow path then runs it at its next file boundary (against the previously
+     * committed state) rather than making it wait for the whole typecheck.
      */
-    void syncRun(std::function<void(LSPTypechecker &)> &&lambda);
+    void syncRun(std::function<void(LSPTypechecker &)> &&lambda, bool canPreemptSlowPath = false);
 
     /**
      * Safely shuts down the typechecker and returns the final GlobalState object. Blocks until typechecker completes
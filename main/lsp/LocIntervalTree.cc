@@ -0,0 +1,59 @@
+#include "main/lsp/LocIntervalTree.h"
+
+using namespace std;
+
+namespace sorbet::realmain::lsp {
+
+void LocIntervalTree::insert(core::Loc loc, u4 value) {
+    ENFORCE(!built);
+    nodes.emplace_back(Node{loc.beginPos(), loc.endPos(), loc.endPos(), value});
+}
+
+void LocIntervalTree::build() {
+    ENFORCE(!built);
+    fast_sort(nodes, [](const Node &a, const Node &b) {
+        return a.beginPos != b.beginPos ? a.beginPos < b.beginPos : a.value < b.value;
+    });
+    buildMaxEnds(0, nodes.size());
+    built = true;
+}
+
+u4 LocIntervalTree::buildMaxEnds(size_t lo, size_t hi) {
+    if (lo >= hi) {
+        return 0;
+    }
+    auto mid = lo + (hi - lo) / 2;
+    auto maxEnd = max(nodes[mid].endPos, max(buildMaxEnds(lo, mid), buildMaxEnds(mid + 1, hi)));
+    nodes[mid].maxEndPos = maxEnd;
+    return maxEnd;
+}
+
+void LocIntervalTree::collectContaining(size_t lo, size_t hi, u4 beginPos, u4 endPos, vector<u4> &out) const {
+    if (lo >= hi) {
+        return;
+    }
+    auto mid = lo + (hi - lo) / 2;
+    if (nodes[mid].maxEndPos < endPos) {
+        // Nothing in this subtree extends far enough to contain the queried range.
+        return;
+    }
+    collectContaining(lo, mid, beginPos, endPos, out);
+    if (nodes[mid].beginPos <= beginPos) {
+        if (nodes[mid].endPos >= endPos) {
+            out.emplace_back(nodes[mid].value);
+        }
+        // The right subtree begins at or after this node, so it is only worth visiting when this
+        // node's begin did not already rule the position out.
+        collectContaining(mid + 1, hi, beginPos, endPos, out);
+    }
+}
+
+vector<u4> LocIntervalTree::containing(core::Loc loc) const {
+    ENFORCE(built);
+    vector<u4> out;
+    collectContaining(0, nodes.size(), loc.beginPos(), loc.endPos(), out);
+    fast_sort(out);
+    return out;
+}
+
+} // namespace sorbet::realmain::lsp
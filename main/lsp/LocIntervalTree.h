@@ -0,0 +1,44 @@
+#ifndef RUBY_TYPER_LSP_LOCINTERVALTREE_H
+#define RUBY_TYPER_LSP_LOCINTERVALTREE_H
+
+#include "core/core.h"
+
+namespace sorbet::realmain::lsp {
+
+/**
+ * A static interval tree over the Locs of one file, valued by a caller-chosen u4 (typically an
+ * index into a parallel vector). Built once via insert() + build(), then queried by position:
+ * containing() descends only into subtrees whose intervals can reach the queried range, so a lookup
+ * is O(log n + matches) instead of a scan over every interval in the file.
+ */
+class LocIntervalTree final {
+    struct Node {
+        u4 beginPos;
+        u4 endPos;
+        /** Largest endPos in the implicit subtree this node is the midpoint of; lets queries prune
+         * whole subtrees that end before the queried range. */
+        u4 maxEndPos;
+        u4 value;
+    };
+    /** Nodes sorted by beginPos; queries treat the array as an implicit balanced BST rooted at each
+     * range's midpoint. */
+    std::vector<Node> nodes;
+    bool built = false;
+
+    u4 buildMaxEnds(size_t lo, size_t hi);
+    void collectContaining(size_t lo, size_t hi, u4 beginPos, u4 endPos, std::vector<u4> &out) const;
+
+public:
+    /** Adds an interval. Must not be called after build(). */
+    void insert(core::Loc loc, u4 value);
+
+    /** Sorts the intervals and computes the subtree augmentations. Call once, after all inserts. */
+    void build();
+
+    /** Returns the values of all intervals that contain `loc`, sorted ascending. */
+    std::vector<u4> containing(core::Loc loc) const;
+};
+
+} // namespace sorbet::realmain::lsp
+
+#endif // RUBY_TYPER_LSP_LOCINTERVALTREE_H
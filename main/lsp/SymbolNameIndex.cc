@@ -0,0 +1,99 @@
+#include "main/lsp/SymbolNameIndex.h"
+#include "common/Timer.h"
+
+using namespace std;
+
+namespace sorbet::realmain::lsp {
+
+namespace {
+u4 packTrigram(string_view name, size_t pos) {
+    return (static_cast<u4>(static_cast<u1>(name[pos])) << 16) |
+           (static_cast<u4>(static_cast<u1>(name[pos + 1])) << 8) | static_cast<u4>(static_cast<u1>(name[pos + 2]));
+}
+} // namespace
+
+void SymbolNameIndex::rebuild(const core::GlobalState &gs) {
+    Timer timeit(gs.tracer(), "SymbolNameIndex::rebuild");
+    entries.clear();
+    trigrams.clear();
+    entries.reserve(gs.symbolsUsed());
+    for (u4 idx = 1; idx < gs.symbolsUsed(); idx++) {
+        core::SymbolRef ref(gs, idx);
+        auto name = ref.data(gs)->name.data(gs)->shortName(gs);
+        auto entryId = static_cast<u4>(entries.size());
+        entries.emplace_back(name, ref);
+        if (name.size() < 3) {
+            continue;
+        }
+        // Record each distinct trigram of the name once.
+        for (size_t pos = 0; pos + 3 <= name.size(); pos++) {
+            auto &posting = trigrams[packTrigram(name, pos)];
+            if (posting.empty() || posting.back() != entryId) {
+                posting.emplace_back(entryId);
+            }
+        }
+    }
+    builtForGeneration = gs.symbolTableGeneration;
+    lastPattern.clear();
+    lastMatches.clear();
+    categoryCounterInc("lsp.symbol_name_index", "rebuild");
+}
+
+vector<core::SymbolRef> SymbolNameIndex::findSimilar(const core::GlobalState &gs, string_view pattern) {
+    if (builtForGeneration != gs.symbolTableGeneration) {
+        rebuild(gs);
+    } else {
+        categoryCounterInc("lsp.symbol_name_index", "reuse");
+    }
+
+    vector<u4> matches;
+    if (!lastPattern.empty() && pattern.find(lastPattern) != string_view::npos) {
+        // The new pattern contains the previous one, so every match is among the previous query's
+        // matches; verify only those.
+        for (auto entryId : lastMatches) {
+            if (entries[entryId].first.find(pattern) != string_view::npos) {
+                matches.emplace_back(entryId);
+            }
+        }
+        categoryCounterInc("lsp.symbol_name_index", "refine");
+    } else if (pattern.size() < 3) {
+        // Too short for a trigram lookup; scan the stored names.
+        for (u4 entryId = 0; entryId < entries.size(); entryId++) {
+            if (entries[entryId].first.find(pattern) != string_view::npos) {
+                matches.emplace_back(entryId);
+            }
+        }
+    } else {
+        // Every match must contain all of the pattern's trigrams; the rarest one gives the fewest
+        // candidates.
+        const vector<u4> *candidates = nullptr;
+        for (size_t pos = 0; pos + 3 <= pattern.size(); pos++) {
+            auto it = trigrams.find(packTrigram(pattern, pos));
+            if (it == trigrams.end()) {
+                candidates = nullptr;
+                break;
+            }
+            if (candidates == nullptr || it->second.size() < candidates->size()) {
+                candidates = &it->second;
+            }
+        }
+        if (candidates != nullptr) {
+            for (auto entryId : *candidates) {
+                if (entries[entryId].first.find(pattern) != string_view::npos) {
+                    matches.emplace_back(entryId);
+                }
+            }
+        }
+    }
+
+    vector<core::SymbolRef> result;
+    result.reserve(matches.size());
+    for (auto entryId : matches) {
+        result.emplace_back(entries[entryId].second);
+    }
+    lastPattern = string(pattern);
+    lastMatches = move(matches);
+    return result;
+}
+
+} // namespace sorbet::realmain::lsp
@@ -0,0 +1,47 @@
+#ifndef RUBY_TYPER_LSP_SYMBOLNAMEINDEX_H
+#define RUBY_TYPER_LSP_SYMBOLNAMEINDEX_H
+
+#include "core/core.h"
+
+namespace sorbet::realmain::lsp {
+
+/**
+ * A trigram index over the short names of all symbols in a GlobalState. Substring queries (the matching used by
+ * workspaceSymbols) become a posting-list lookup plus verification of a handful of candidates instead of a scan
+ * over the whole symbol table. The index rebuilds itself lazily whenever the symbol table generation changes, so
+ * it stays valid across fast path edits and is replaced wholesale after a slow path.
+ */
+class SymbolNameIndex final {
+    /** Generation of the symbol table this index was built against; 0 means never built. */
+    unsigned int builtForGeneration = 0;
+    /** Short name and symbol for every indexed symbol, in symbol table order. */
+    std::vector<std::pair<std::string_view, core::SymbolRef>> entries;
+    /** Maps a packed 3-byte gram to the entries whose short name contains it. */
+    UnorderedMap<u4, std::vector<u4>> trigrams;
+    /**
+     * The previous query's pattern and the entry ids it matched. Typing in the symbol picker sends
+     * a new query per keystroke, and each keystroke usually extends the previous pattern; such a
+     * refinement can verify just the previous matches instead of a fresh posting-list lookup.
+     * Cleared on rebuild.
+     */
+    std::string lastPattern;
+    std::vector<u4> lastMatches;
+
+    void rebuild(const core::GlobalState &gs);
+
+public:
+    SymbolNameIndex() = default;
+    SymbolNameIndex(const SymbolNameIndex &) = delete;
+    SymbolNameIndex &operator=(const SymbolNameIndex &) = delete;
+
+    /**
+     * Returns all symbols whose short name contains `pattern`, in symbol table order. Rebuilds the index first if
+     * `gs`'s symbol table changed since the last query. Patterns shorter than a trigram fall back to a scan over
+     * the stored names, which is still far cheaper than dereferencing every symbol.
+     */
+    std::vector<core::SymbolRef> findSimilar(const core::GlobalState &gs, std::string_view pattern);
+};
+
+} // namespace sorbet::realmain::lsp
+
+#endif
@@ -1,4 +1,5 @@
 #include "main/lsp/TimeTravelingGlobalState.h"
+#include "common/Counters.h"
 #include "core/Unfreeze.h"
 #include "main/lsp/LSPPreprocessor.h"
 #include "main/pipeline/pipeline.h"
@@ -121,9 +122,34 @@ vector<ast::ParsedFile> TimeTravelingGlobalState::indexFromFileSystem() {
     return indexed;
 }
 
-vector<core::FileHash> TimeTravelingGlobalState::computeStateHashes(const vector<shared_ptr<core::File>> &files) const {
+namespace {
+// Below this many files, fanning hashing out over the worker pool costs more in queue setup and
+// worker wakeups than it saves; typical didChange edits touch one or two files.
+constexpr size_t INLINE_HASH_THRESHOLD = 4;
+
+// Above this much combined source, deep-copying the freshly indexed trees into the redo log is
+// skipped on the edit path: for big files that copy is the dominant post-parse cost of a
+// keystroke, paid on every edit for a log entry that only matters if a slow path later combines
+// over it. getCombinedUpdates re-derives missing indexes from file contents on demand — the same
+// mechanism the history memory budget's evictions rely on.
+constexpr size_t EAGER_REDO_INDEX_MAX_SOURCE_BYTES = 128 * 1024;
+} // namespace
+
+vector<core::FileHash>
+TimeTravelingGlobalState::computeStateHashes(const vector<shared_ptr<core::File>> &files,
+                                             const vector<const core::FileHash *> &previousHashes) const {
     Timer timeit(config->logger, "computeStateHashes");
+    ENFORCE(previousHashes.empty() || previousHashes.size() == files.size());
     vector<core::FileHash> res(files.size());
+    if (files.size() <= INLINE_HASH_THRESHOLD) {
+        for (int i = 0; i < files.size(); i++) {
+            if (files[i]) {
+                auto previous = previousHashes.empty() ? nullptr : previousHashes[i];
+                res[i] = pipeline::computeFileHash(files[i], *config->logger, previous);
+            }
+        }
+        return res;
+    }
     shared_ptr<ConcurrentBoundedQueue<int>> fileq = make_shared<ConcurrentBoundedQueue<int>>(files.size());
     for (int i = 0; i < files.size(); i++) {
         auto copy = i;
@@ -137,7 +163,7 @@ vector<core::FileHash> TimeTravelingGlobalState::computeStateHashes(const vector
 
     shared_ptr<BlockingBoundedQueue<vector<pair<int, core::FileHash>>>> resultq =
         make_shared<BlockingBoundedQueue<vector<pair<int, core::FileHash>>>>(files.size());
-    config->workers.multiplexJob("lspStateHash", [fileq, resultq, files, &logger]() {
+    config->workers.multiplexJob("lspStateHash", [fileq, resultq, files, previousHashes, &logger]() {
         vector<pair<int, core::FileHash>> threadResult;
         int processedByThread = 0;
         int job;
@@ -150,7 +176,8 @@ vector<core::FileHash> TimeTravelingGlobalState::computeStateHashes(const vector
                         threadResult.emplace_back(job, core::FileHash{});
                         continue;
                     }
-                    auto hash = pipeline::computeFileHash(files[job], logger);
+                    auto previous = previousHashes.empty() ? nullptr : previousHashes[job];
+                    auto hash = pipeline::computeFileHash(files[job], logger, previous);
                     threadResult.emplace_back(job, move(hash));
                 }
             }
@@ -175,11 +202,43 @@ vector<core::FileHash> TimeTravelingGlobalState::computeStateHashes(const vector
     return res;
 }
 
+size_t TimeTravelingGlobalState::indexCostEstimate(const GlobalStateUpdate &update) {
+    if (update.updatedFileIndexes.empty()) {
+        return 0;
+    }
+    size_t cost = 0;
+    for (auto &file : update.fileUpdates) {
+        cost += file->source().size();
+    }
+    return cost;
+}
+
+void TimeTravelingGlobalState::enforceHistoryBudget() {
+    const size_t budgetBytes = static_cast<size_t>(config->opts.lspHistoryMemoryKiB) * 1024;
+    if (budgetBytes == 0) {
+        return;
+    }
+    for (auto &entry : log) {
+        if (retainedIndexBytes <= budgetBytes) {
+            break;
+        }
+        auto cost = indexCostEstimate(entry.update);
+        if (cost == 0) {
+            continue;
+        }
+        retainedIndexBytes -= cost;
+        entry.update.updatedFileIndexes.clear();
+        entry.update.updatedFileIndexes.shrink_to_fit();
+        prodCounterInc("lsp.ttgs.evicted_index_entries");
+    }
+}
+
 void TimeTravelingGlobalState::pruneBefore(u4 version) {
     // Time-travel to the present before we forget how to.
     travel(latestVersion);
     for (auto it = log.begin(); it != log.end();) {
         if (comesBefore(it->version, version)) {
+            retainedIndexBytes -= indexCostEstimate(it->update);
             it = log.erase(it);
         } else {
             it++;
@@ -189,8 +248,29 @@ void TimeTravelingGlobalState::pruneBefore(u4 version) {
 
 void TimeTravelingGlobalState::commitEdits(LSPFileUpdates &update) {
     Timer timeit(config->logger, "ttgs_commit_edits");
-    // Hash changes.
-    update.updatedFileHashes = computeStateHashes(update.updatedFiles);
+    // Hash changes. Reuse the stored hash for any file whose contents are unchanged (didOpen/didSave
+    // frequently deliver files verbatim), so hashing costs proportional to what actually changed.
+    update.updatedFileHashes.resize(update.updatedFiles.size());
+    vector<shared_ptr<core::File>> filesToHash;
+    vector<int> filesToHashPos;
+    vector<const core::FileHash *> previousHashes;
+    for (int i = 0; i < update.updatedFiles.size(); i++) {
+        auto &file = update.updatedFiles[i];
+        auto fref = gs->findFileByPath(file->path());
+        bool hasOldHash = fref.exists() && fref.id() < globalStateHashes.size();
+        if (hasOldHash && gs->getFiles()[fref.id()]->source() == file->source()) {
+            counterInc("lsp.state_hashes.reused");
+            update.updatedFileHashes[i] = globalStateHashes[fref.id()];
+        } else {
+            filesToHash.push_back(file);
+            filesToHashPos.push_back(i);
+            previousHashes.push_back(hasOldHash ? &globalStateHashes[fref.id()] : nullptr);
+        }
+    }
+    auto computedHashes = computeStateHashes(filesToHash, previousHashes);
+    for (int i = 0; i < computedHashes.size(); i++) {
+        update.updatedFileHashes[filesToHashPos[i]] = move(computedHashes[i]);
+    }
     update.canTakeFastPath = canTakeFastPath(latestVersion, update);
 
     TimeTravelUpdate newUpdate{update.versionEnd, update.hasNewFiles};
@@ -229,14 +309,29 @@ void TimeTravelingGlobalState::commitEdits(LSPFileUpdates &update) {
 
     auto trees = pipeline::index(gs, frefs, config->opts, config->workers, kvstore);
     update.updatedFileIndexes.resize(trees.size());
-    newUpdate.update.updatedFileIndexes.resize(trees.size());
+    size_t updateSourceBytes = 0;
+    for (auto &file : newUpdate.update.fileUpdates) {
+        updateSourceBytes += file->source().size();
+    }
+    const bool materializeRedoIndexes = updateSourceBytes <= EAGER_REDO_INDEX_MAX_SOURCE_BYTES;
+    if (materializeRedoIndexes) {
+        newUpdate.update.updatedFileIndexes.resize(trees.size());
+    } else {
+        prodCounterInc("lsp.ttgs.redo_index_deferred");
+    }
     for (auto &ast : trees) {
         const int i = fileToPos[ast.file.id()];
-        newUpdate.update.updatedFileIndexes[i] = ast::ParsedFile{ast.tree->deepCopy(), ast.file};
+        if (materializeRedoIndexes) {
+            newUpdate.update.updatedFileIndexes[i] = ast::ParsedFile{ast.tree->deepCopy(), ast.file};
+        }
         update.updatedFileIndexes[i] = move(ast);
     }
 
+    retainedIndexBytes += indexCostEstimate(newUpdate.update);
     log.push_back(move(newUpdate));
+    enforceHistoryBudget();
+    histogramInc("lsp.ttgs.log_entries", log.size());
+    histogramInc("lsp.ttgs.retained_index_kb", retainedIndexBytes / 1024);
 
     // Clear error queue.
     // (Note: Flushing is disabled in LSP mode, so we have to drain.)
@@ -305,14 +400,26 @@ LSPFileUpdates TimeTravelingGlobalState::getCombinedUpdates(u4 fromId, u4 toId)
         const auto &update = ttu->update;
         int i = -1;
         merged.hasNewFiles = merged.hasNewFiles || ttu->hasNewFiles;
+        const bool indexesEvicted = update.updatedFileIndexes.empty() && !update.fileUpdates.empty();
         for (const auto &file : update.fileUpdates) {
             i++;
             if (!encountered.contains(file->path())) {
                 encountered.insert(string(file->path()));
                 merged.updatedFiles.push_back(file);
                 merged.updatedFileHashes.push_back(update.hashUpdates[i]);
-                auto &ast = update.updatedFileIndexes[i];
-                merged.updatedFileIndexes.push_back(ast::ParsedFile{ast.tree->deepCopy(), ast.file});
+                if (indexesEvicted) {
+                    // This entry's indexes were evicted to enforce the history memory budget;
+                    // re-derive the tree from the file contents at the entry's version.
+                    travel(ttu->version);
+                    auto fref = gs->findFileByPath(file->path());
+                    ENFORCE(fref.exists());
+                    fref.data(*gs).strictLevel = pipeline::decideStrictLevel(*gs, fref, config->opts);
+                    merged.updatedFileIndexes.push_back(pipeline::indexOne(config->opts, *gs, fref, kvstore));
+                    prodCounterInc("lsp.ttgs.reindexed_after_eviction");
+                } else {
+                    auto &ast = update.updatedFileIndexes[i];
+                    merged.updatedFileIndexes.push_back(ast::ParsedFile{ast.tree->deepCopy(), ast.file});
+                }
             }
         }
     }
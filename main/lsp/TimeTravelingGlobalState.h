@@ -24,7 +24,9 @@ private:
     struct GlobalStateUpdate {
         std::vector<std::shared_ptr<core::File>> fileUpdates;
         std::vector<core::FileHash> hashUpdates;
-        // Note: Undo updates do not contain indexes.
+        // Note: Undo updates do not contain indexes. May also be empty for updates whose indexes
+        // were evicted to enforce the history memory budget; getCombinedUpdates re-derives them
+        // from fileUpdates on demand.
         std::vector<ast::ParsedFile> updatedFileIndexes;
     };
 
@@ -59,10 +61,27 @@ private:
     // Contains file hashes for the current version of global state.
     std::vector<core::FileHash> globalStateHashes;
 
+    // Estimated bytes held by the cached index results in `log` (source size is used as a proxy for
+    // tree size). Kept in sync by commitEdits, pruneBefore, and enforceHistoryBudget.
+    size_t retainedIndexBytes = 0;
+
+    // Estimates the memory held by an entry's cached index results.
+    static size_t indexCostEstimate(const GlobalStateUpdate &update);
+
+    // Evicts the oldest cached index results until `retainedIndexBytes` fits the configured budget
+    // (opts.lspHistoryMemoryKiB). Evicted entries keep their file contents and hashes, so travel
+    // stays O(delta); only getCombinedUpdates pays to re-index the affected files.
+    void enforceHistoryBudget();
+
     // Internal function: Applies given update (or undoes it) and appropriately updates `activeVersion`.
     std::vector<core::FileRef> applyUpdate(TimeTravelUpdate &update, bool undo);
 
-    std::vector<core::FileHash> computeStateHashes(const std::vector<std::shared_ptr<core::File>> &files) const;
+    // `previousHashes`, when non-empty, is parallel to `files` and holds each file's pre-edit hash
+    // (or nullptr); it lets computeFileHash skip the expensive definitions hash for body-only
+    // edits.
+    std::vector<core::FileHash>
+    computeStateHashes(const std::vector<std::shared_ptr<core::File>> &files,
+                       const std::vector<const core::FileHash *> &previousHashes = {}) const;
 
 public:
     TimeTravelingGlobalState(const std::shared_ptr<LSPConfiguration> &config, std::unique_ptr<core::GlobalState> gs,
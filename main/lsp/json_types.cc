@@ -80,10 +80,9 @@ InvalidTypeError::InvalidTypeError(string_view fieldName, string_view expectedTy
 
 const std::string JSONBaseType::defaultFieldName = "root";
 
-string JSONBaseType::toJSON(bool prettyPrint) const {
+void JSONBaseType::writeJSON(rapidjson::StringBuffer &buffer, bool prettyPrint) const {
     rapidjson::MemoryPoolAllocator<> alloc;
     auto v = toJSONValue(alloc);
-    rapidjson::StringBuffer buffer;
     if (!prettyPrint) {
         rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
         v->Accept(writer);
@@ -91,7 +90,12 @@ string JSONBaseType::toJSON(bool prettyPrint) const {
         rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
         v->Accept(writer);
     }
-    return buffer.GetString();
+}
+
+string JSONBaseType::toJSON(bool prettyPrint) const {
+    rapidjson::StringBuffer buffer;
+    writeJSON(buffer, prettyPrint);
+    return string(buffer.GetString(), buffer.GetSize());
 }
 
 // Object-specific helpers
@@ -6,6 +6,7 @@
 #include "core/NameHash.h"
 #include "core/core.h"
 #include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
 
 #include <optional>
 #include <variant>
@@ -30,6 +31,10 @@ struct LSPFileUpdates {
     std::vector<ast::ParsedFile> updatedFinalGSFileIndexes;
     // (Optional) Updated global state object to use to typecheck this update.
     std::optional<std::unique_ptr<core::GlobalState>> updatedGS;
+    // Paths of files the client newly opened in this update (textDocument/didOpen). After the
+    // update commits, the typechecker prefetches the state that the first interactive query in
+    // these files would otherwise fault in on demand.
+    std::vector<std::string> openedFilePaths;
 };
 
 class DeserializationError : public std::runtime_error {
@@ -120,6 +125,13 @@ public:
      */
     std::string toJSON(bool prettyPrint = false) const;
 
+    /**
+     * Serializes the C++ object directly into `buffer`, avoiding the intermediate std::string that
+     * toJSON materializes. Preferred on the output path, where large payloads (e.g.
+     * publishDiagnostics during a migration) make every extra full-payload copy costly.
+     */
+    void writeJSON(rapidjson::StringBuffer &buffer, bool prettyPrint = false) const;
+
     /**
      * Converts C++ object into a RapidJSON JSON value owned by the given rapidjson allocator.
      */
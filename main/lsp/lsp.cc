@@ -1,5 +1,6 @@
 #include "main/lsp/lsp.h"
 #include "common/Timer.h"
+#include "common/sort.h"
 #include "common/statsd/statsd.h"
 #include "common/typecase.h"
 #include "common/web_tracer_framework/tracing.h"
@@ -13,7 +14,11 @@ namespace sorbet::realmain::lsp {
 
 LSPLoop::LSPLoop(std::unique_ptr<core::GlobalState> initialGS, const std::shared_ptr<LSPConfiguration> &config)
     : config(config), preprocessor(move(initialGS), config), typecheckerCoord(config),
-      lastMetricUpdateTime(chrono::steady_clock::now()) {}
+      lastMetricUpdateTime(chrono::steady_clock::now()) {
+    // Keep a bounded history of completed timers around so that `sorbet/dumpTrace` can reconstruct
+    // recent activity after the fact.
+    enableTimingRingBuffer();
+}
 
 LSPQueryResult LSPLoop::queryByLoc(LSPTypechecker &typechecker, string_view uri, const Position &pos,
                                    const LSPMethod forMethod, bool errorIfFileIsUntyped) const {
@@ -34,7 +39,9 @@ LSPQueryResult LSPLoop::queryByLoc(LSPTypechecker &typechecker, string_view uri,
     }
 
     auto loc = config->lspPos2Loc(fref, pos, gs);
-    return typechecker.query(core::lsp::Query::createLocQuery(loc), {fref});
+    auto query = core::lsp::Query::createLocQuery(loc);
+    query.canceled = currentRequestCanceled;
+    return typechecker.query(query, {fref});
 }
 
 LSPQueryResult LSPLoop::queryBySymbol(LSPTypechecker &typechecker, core::SymbolRef sym) const {
@@ -43,27 +50,21 @@ LSPQueryResult LSPLoop::queryBySymbol(LSPTypechecker &typechecker, core::SymbolR
     vector<core::FileRef> frefs;
     const core::GlobalState &gs = typechecker.state();
     const core::NameHash symNameHash(gs, sym.data(gs)->name.data(gs));
-    // Locate files that contain the same Name as the symbol. Is an overapproximation, but a good first filter.
-    int i = -1;
-    for (auto &hash : typechecker.getFileHashes()) {
-        i++;
-        const auto &usedSends = hash.usages.sends;
-        const auto &usedConstants = hash.usages.constants;
-        auto ref = core::FileRef(i);
-
+    // The reverse index lists the files that contain the same Name as the symbol. Is an overapproximation, but a
+    // good first filter; the query below verifies each candidate file.
+    for (auto ref : typechecker.getFilesThatUseName(symNameHash)) {
         const bool fileIsValid = ref.exists() && ref.data(gs).sourceType == core::File::Type::Normal;
-        if (fileIsValid &&
-            (std::find(usedSends.begin(), usedSends.end(), symNameHash) != usedSends.end() ||
-             std::find(usedConstants.begin(), usedConstants.end(), symNameHash) != usedConstants.end())) {
+        if (fileIsValid) {
             frefs.emplace_back(ref);
         }
     }
+    fast_sort(frefs);
 
-    return typechecker.query(core::lsp::Query::createSymbolQuery(sym), frefs);
+    auto query = core::lsp::Query::createSymbolQuery(sym);
+    query.canceled = currentRequestCanceled;
+    return typechecker.query(query, frefs);
 }
 
-constexpr chrono::minutes STATSD_INTERVAL = chrono::minutes(5);
-
 bool LSPLoop::shouldSendCountersToStatsd(chrono::time_point<chrono::steady_clock> currentTime) const {
     return !config->opts.statsdHost.empty() && (currentTime - lastMetricUpdateTime) > STATSD_INTERVAL;
 }
@@ -81,7 +82,44 @@ void LSPLoop::sendCountersToStatsd(chrono::time_point<chrono::steady_clock> curr
         StatsD::submitCounters(counters, opts.statsdHost, opts.statsdPort, prefix);
     }
     if (!opts.webTraceFile.empty()) {
-        web_tracer_framework::Tracing::storeTraces(counters, opts.webTraceFile);
+        if (opts.webTraceBinary) {
+            web_tracer_framework::Tracing::storeTracesBinary(counters, opts.webTraceFile);
+        } else {
+            web_tracer_framework::Tracing::storeTraces(counters, opts.webTraceFile);
+        }
+    }
+}
+
+bool LSPLoop::isInteractiveRequest(const LSPMessage &msg) {
+    if (!msg.isRequest()) {
+        return false;
+    }
+    switch (msg.method()) {
+        case LSPMethod::TextDocumentHover:
+        case LSPMethod::TextDocumentCompletion:
+        case LSPMethod::TextDocumentDefinition:
+        case LSPMethod::TextDocumentTypeDefinition:
+        case LSPMethod::TextDocumentSignatureHelp:
+        case LSPMethod::TextDocumentDocumentSymbol:
+        case LSPMethod::TextDocumentCodeAction:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool LSPLoop::isHoistableBackgroundRequest(const LSPMessage &msg) {
+    if (!msg.isRequest()) {
+        // Notifications (edits, exit, ...) either mutate state or carry ordering significance, so
+        // nothing may be reordered across them.
+        return false;
+    }
+    switch (msg.method()) {
+        case LSPMethod::TextDocumentReferences:
+        case LSPMethod::WorkspaceSymbol:
+            return true;
+        default:
+            return false;
     }
 }
 
@@ -11,6 +11,7 @@
 #include "main/lsp/LSPOutput.h"
 #include "main/lsp/LSPPreprocessor.h"
 #include "main/lsp/LSPTypecheckerCoordinator.h"
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <optional>
@@ -41,6 +42,11 @@ enum class LSPErrorCodes {
     RequestCancelled = -32800,
 };
 
+// How often a long-lived server flushes accumulated counters to statsd. The message loop also uses
+// it to bound its idle wait so an idle server flushes on schedule rather than only when the next
+// message happens to arrive.
+constexpr std::chrono::minutes STATSD_INTERVAL = std::chrono::minutes(5);
+
 class LSPLoop {
     friend class LSPWrapper;
 
@@ -54,8 +60,19 @@ class LSPLoop {
      * The time that LSP last sent metrics to statsd -- if `opts.statsdHost` was specified.
      */
     std::chrono::time_point<std::chrono::steady_clock> lastMetricUpdateTime;
+    /**
+     * Duration of the most recent committed fast-path typecheck, in microseconds. Written on the
+     * typechecker thread, read by the message-processing loop to size the edit debounce window.
+     */
+    std::atomic<u4> lastFastPathDurationUs{0};
     /** ID of the main thread, which actually processes LSP requests and performs typechecking. */
     std::thread::id mainThreadId;
+    /**
+     * Cancellation flag of the request currently being processed, published to the queue in
+     * runLSP (see QueueState::processingRequestCanceled) and attached to any Query the request
+     * runs. Only touched by the processing thread.
+     */
+    std::shared_ptr<const std::atomic<bool>> currentRequestCanceled;
 
     void addLocIfExists(const core::GlobalState &gs, std::vector<std::unique_ptr<Location>> &locs, core::Loc loc) const;
     std::vector<std::unique_ptr<Location>>
@@ -98,13 +115,18 @@ class LSPLoop {
 
     void processRequestInternal(LSPMessage &msg);
 
+    /** Returns `true` for latency-sensitive editor queries (hover, completion, go-to-definition and
+     * friends) whose perceived latency an interactive user notices. */
+    static bool isInteractiveRequest(const LSPMessage &msg);
+    /** Returns `true` for read-only whole-workspace scans (references, workspaceSymbols) that an
+     * interactive request may safely jump ahead of in the message queue: they neither mutate state
+     * nor care which of the two runs against the shared GlobalState first. */
+    static bool isHoistableBackgroundRequest(const LSPMessage &msg);
+
     /** Returns `true` if 5 minutes have elapsed since LSP last sent counters to statsd. */
     bool shouldSendCountersToStatsd(std::chrono::time_point<std::chrono::steady_clock> currentTime) const;
     /** Sends counters to statsd. */
     void sendCountersToStatsd(std::chrono::time_point<std::chrono::steady_clock> currentTime);
-    /** Helper method: If message is an edit taking the slow path, and slow path cancelation is enabled, signal to
-     * GlobalState that we will be starting a commit of the edits. */
-    void maybeStartCommitSlowPathEdit(const LSPMessage &msg) const;
 
 public:
     LSPLoop(std::unique_ptr<core::GlobalState> initialGS, const std::shared_ptr<LSPConfiguration> &config);
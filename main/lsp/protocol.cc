@@ -5,6 +5,7 @@
 #include "common/web_tracer_framework/tracing.h"
 #include "lsp.h"
 #include "main/lsp/LSPPreprocessor.h"
+#include "main/lsp/watchman/NativeFileWatcher.h"
 #include "main/lsp/watchman/WatchmanProcess.h"
 #include "main/options/options.h" // For EarlyReturnWithCode.
 #include <iostream>
@@ -157,18 +158,6 @@ unique_ptr<Joinable> LSPPreprocessor::runPreprocessor(QueueState &incomingQueue,
     });
 }
 
-void LSPLoop::maybeStartCommitSlowPathEdit(const LSPMessage &msg) const {
-    if (msg.isNotification() && msg.method() == LSPMethod::SorbetWorkspaceEdit) {
-        // While we're holding the queue lock (and preventing new messages from entering), start a
-        // commit for an epoch if this message will trigger a cancelable slow path.
-        const auto &params = get<unique_ptr<SorbetWorkspaceEditParams>>(msg.asNotification().params);
-        if (!params->updates.canTakeFastPath && params->updates.updatedGS.has_value()) {
-            auto &gs = params->updates.updatedGS.value();
-            gs->startCommitEpoch(params->updates.versionStart - 1, params->updates.versionEnd);
-        }
-    }
-}
-
 optional<unique_ptr<core::GlobalState>> LSPLoop::runLSP(int inputFd) {
     // Naming convention: thread that executes this function is called typechecking thread
 
@@ -188,42 +177,52 @@ optional<unique_ptr<core::GlobalState>> LSPLoop::runLSP(int inputFd) {
     auto typecheckThread = typecheckerCoord.startTypecheckerThread();
 
     unique_ptr<watchman::WatchmanProcess> watchmanProcess;
+    unique_ptr<watchman::NativeFileWatcher> nativeFileWatcher;
     const auto &opts = config->opts;
     auto &logger = config->logger;
     if (!opts.disableWatchman) {
         if (opts.rawInputDirNames.size() != 1 || !opts.rawInputFileNames.empty()) {
-            logger->error("Watchman support currently only works when Sorbet is run with a single input directory. If "
-                          "Watchman is not needed, run Sorbet with `--disable-watchman`.");
+            logger->error("File watching support currently only works when Sorbet is run with a single input "
+                          "directory. If file watching is not needed, run Sorbet with `--disable-watchman`.");
             throw options::EarlyReturnWithCode(1);
         }
 
-        // The lambda below intentionally does not capture `this`.
-        watchmanProcess = make_unique<watchman::WatchmanProcess>(
-            logger, opts.watchmanPath, opts.rawInputDirNames.at(0), vector<string>({"rb", "rbi"}),
-            [&incomingQueue, &incomingMtx, logger = logger,
-             &initializedNotification](std::unique_ptr<WatchmanQueryResponse> response) {
-                auto notifMsg =
-                    make_unique<NotificationMessage>("2.0", LSPMethod::SorbetWatchmanFileChange, move(response));
-                auto msg = make_unique<LSPMessage>(move(notifMsg));
-                // Don't start enqueueing requests until LSP is initialized.
-                initializedNotification.WaitForNotification();
-                {
-                    absl::MutexLock lck(&incomingMtx);
-                    tagNewRequest(logger, *msg);
-                    incomingQueue.counters = mergeCounters(move(incomingQueue.counters));
-                    incomingQueue.pendingRequests.push_back(move(msg));
-                }
-            },
-            [&incomingQueue, &incomingMtx, logger = logger](int watchmanExitCode) {
-                {
-                    absl::MutexLock lck(&incomingMtx);
-                    if (!incomingQueue.terminate) {
-                        incomingQueue.terminate = true;
-                        incomingQueue.errorCode = watchmanExitCode;
-                    }
-                    logger->debug("Watchman terminating");
+        // The lambdas below intentionally do not capture `this`.
+        auto processUpdate = [&incomingQueue, &incomingMtx, logger = logger,
+                              &initializedNotification](std::unique_ptr<WatchmanQueryResponse> response) {
+            auto notifMsg =
+                make_unique<NotificationMessage>("2.0", LSPMethod::SorbetWatchmanFileChange, move(response));
+            auto msg = make_unique<LSPMessage>(move(notifMsg));
+            // Don't start enqueueing requests until LSP is initialized.
+            initializedNotification.WaitForNotification();
+            {
+                absl::MutexLock lck(&incomingMtx);
+                tagNewRequest(logger, *msg);
+                incomingQueue.counters = mergeCounters(move(incomingQueue.counters));
+                incomingQueue.pendingRequests.push_back(move(msg));
+                prodHistogramInc("lsp.queues.incoming_depth", incomingQueue.pendingRequests.size());
+            }
+        };
+        auto processExit = [&incomingQueue, &incomingMtx, logger = logger](int watcherExitCode) {
+            {
+                absl::MutexLock lck(&incomingMtx);
+                if (!incomingQueue.terminate) {
+                    incomingQueue.terminate = true;
+                    incomingQueue.errorCode = watcherExitCode;
                 }
-            });
+                logger->debug("File watcher terminating");
+            }
+        };
+        if (opts.nativeFileWatcher) {
+            nativeFileWatcher = make_unique<watchman::NativeFileWatcher>(
+                logger, opts.rawInputDirNames.at(0), vector<string>({"rb", "rbi"}), move(processUpdate),
+                move(processExit));
+        } else {
+            watchmanProcess =
+                make_unique<watchman::WatchmanProcess>(logger, opts.watchmanPath, opts.rawInputDirNames.at(0),
+                                                       vector<string>({"rb", "rbi"}), move(processUpdate),
+                                                       move(processExit));
+        }
     }
 
     auto readerThread = runInAThread("lspReader", [&incomingQueue, &incomingMtx, logger = logger, inputFd] {
@@ -241,6 +240,7 @@ optional<unique_ptr<core::GlobalState>> LSPLoop::runLSP(int inputFd) {
                         tagNewRequest(logger, *msg);
                         incomingQueue.counters = mergeCounters(move(incomingQueue.counters));
                         incomingQueue.pendingRequests.push_back(move(msg));
+                        prodHistogramInc("lsp.queues.incoming_depth", incomingQueue.pendingRequests.size());
                         // Reset span now that we've found a request.
                         timeit = make_unique<Timer>(logger, "getNewRequest");
                     }
@@ -269,38 +269,137 @@ optional<unique_ptr<core::GlobalState>> LSPLoop::runLSP(int inputFd) {
         bool exitProcessed = false;
         while (true) {
             unique_ptr<LSPMessage> msg;
-            bool hasMoreMessages;
+            bool hasMoreMessages = false;
             {
                 absl::MutexLock lck(&processingMtx);
                 Timer timeit(logger, "idle");
-                processingMtx.Await(absl::Condition(
+                auto ready = absl::Condition(
                     +[](QueueState *processingQueue) -> bool {
                         return processingQueue->terminate ||
                                (!processingQueue->paused && !processingQueue->pendingRequests.empty());
                     },
-                    &processingQueue));
-                ENFORCE(!processingQueue.paused);
-                if (processingQueue.terminate) {
-                    if (processingQueue.errorCode != 0) {
-                        // Abnormal termination.
-                        typecheckerCoord.shutdown();
-                        throw options::EarlyReturnWithCode(processingQueue.errorCode);
-                    } else if (exitProcessed || processingQueue.pendingRequests.empty()) {
-                        // Normal termination. Wait until all pending requests finish or we process an exit.
-                        break;
+                    &processingQueue);
+                bool idleWakeup = false;
+                if (config->opts.statsdHost.empty()) {
+                    processingMtx.Await(ready);
+                } else {
+                    // Bound the wait so an idle server still reaches the statsd flush below on
+                    // schedule; otherwise metrics only leave the process when the next message
+                    // happens to arrive.
+                    idleWakeup = !processingMtx.AwaitWithTimeout(ready, absl::FromChrono(STATSD_INTERVAL));
+                }
+                if (!idleWakeup && !processingQueue.terminate && processingQueue.pendingRequests.size() == 1) {
+                    // If the only pending message is a fast-path edit, hold it briefly before
+                    // popping: multi-cursor edits and find-and-replace arrive as a burst of
+                    // didChange notifications, and the preprocessor merges later edits into this
+                    // queued message in place (under this same mutex), turning the burst into one
+                    // retypecheck. The window scales with the measured fast-path cost — cheap
+                    // retypechecks are not worth delaying — and ends early if a non-edit message
+                    // arrives behind the edit.
+                    auto &front = *processingQueue.pendingRequests.front();
+                    if (front.isNotification() && front.method() == LSPMethod::SorbetWorkspaceEdit &&
+                        get<unique_ptr<SorbetWorkspaceEditParams>>(front.asNotification().params)
+                            ->updates.canTakeFastPath) {
+                        constexpr u4 maxDebounceUs = 50'000;
+                        const u4 debounceUs =
+                            min(lastFastPathDurationUs.load(memory_order_relaxed) / 2, maxDebounceUs);
+                        if (debounceUs > 0) {
+                            Timer timeit(logger, "lsp.editDebounce");
+                            processingMtx.AwaitWithTimeout(
+                                absl::Condition(
+                                    +[](QueueState *processingQueue) -> bool {
+                                        return processingQueue->terminate || processingQueue->paused ||
+                                               processingQueue->pendingRequests.size() > 1;
+                                    },
+                                    &processingQueue),
+                                absl::Microseconds(debounceUs));
+                            // Re-establish the pop invariants (e.g. the queue may have been paused
+                            // while we waited).
+                            processingMtx.Await(ready);
+                        }
+                    }
+                }
+                if (!idleWakeup) {
+                    ENFORCE(!processingQueue.paused);
+                    if (processingQueue.terminate) {
+                        if (processingQueue.errorCode != 0) {
+                            // Abnormal termination.
+                            typecheckerCoord.shutdown();
+                            throw options::EarlyReturnWithCode(processingQueue.errorCode);
+                        } else if (exitProcessed || processingQueue.pendingRequests.empty()) {
+                            // Normal termination. Wait until all pending requests finish or we process an exit.
+                            break;
+                        }
+                    }
+                    // Pop the first interactive request if only hoistable background scans precede
+                    // it: a hover should not wait out a whole-workspace references scan. The scan
+                    // stops at the first state-changing or otherwise order-sensitive message, so
+                    // requests never observe a different GlobalState than they would have FIFO.
+                    auto popIt = processingQueue.pendingRequests.begin();
+                    for (auto it = popIt; it != processingQueue.pendingRequests.end(); ++it) {
+                        if (isInteractiveRequest(**it)) {
+                            popIt = it;
+                            break;
+                        }
+                        if (!isHoistableBackgroundRequest(**it)) {
+                            break;
+                        }
+                    }
+                    if (popIt != processingQueue.pendingRequests.begin()) {
+                        prodCounterInc("lsp.messages.interactive_hoisted");
+                    }
+                    msg = move(*popIt);
+                    processingQueue.pendingRequests.erase(popIt);
+                    hasMoreMessages = !processingQueue.pendingRequests.empty();
+                    exitProcessed = msg->isNotification() && msg->method() == LSPMethod::Exit;
+                    if (msg->isRequest()) {
+                        // Publish the request as in flight so a $/cancelRequest that arrives while
+                        // we work on it can still reach it (see QueueState::processingRequestId).
+                        processingQueue.processingRequestId = make_unique<MessageId>(msg->asRequest().id);
+                        processingQueue.processingRequestCanceled = make_shared<atomic<bool>>(false);
+                        currentRequestCanceled = processingQueue.processingRequestCanceled;
                     }
                 }
-                msg = move(processingQueue.pendingRequests.front());
-                processingQueue.pendingRequests.pop_front();
-                hasMoreMessages = !processingQueue.pendingRequests.empty();
-                exitProcessed = msg->isNotification() && msg->method() == LSPMethod::Exit;
-                maybeStartCommitSlowPathEdit(*msg);
             }
-            prodCounterInc("lsp.messages.received");
-            processRequestInternal(*msg);
+            if (msg != nullptr) {
+                prodCounterInc("lsp.messages.received");
+                if (msg->enqueueTime.has_value()) {
+                    // Report how long the message sat in the processing queue, so dashboards can
+                    // tell scheduling latency apart from the compute latency the per-request
+                    // timers already record. Sub-millisecond waits stay out of the trace (matching
+                    // Timer's own reporting threshold) but still land in the histogram.
+                    auto popTime = chrono::steady_clock::now();
+                    auto waitUs = chrono::duration_cast<chrono::microseconds>(popTime - *msg->enqueueTime).count();
+                    prodHistogramInc("lsp.queues.wait_ms", waitUs / 1000);
+                    if (waitUs > 1000) {
+                        timingAdd("lsp.queue_wait", *msg->enqueueTime, popTime,
+                                  {{"method", internDynamicName(convertLSPMethodToString(msg->method()))}}, FlowId{0},
+                                  FlowId{0}, nullptr, waitUs);
+                    }
+                }
+                processRequestInternal(*msg);
+
+                if (currentRequestCanceled != nullptr) {
+                    currentRequestCanceled = nullptr;
+                    absl::MutexLock lck(&processingMtx);
+                    processingQueue.processingRequestId = nullptr;
+                    processingQueue.processingRequestCanceled = nullptr;
+                }
 
-            if (config->isInitialized() && !initializedNotification.HasBeenNotified()) {
-                initializedNotification.Notify();
+                if (config->isInitialized() && !initializedNotification.HasBeenNotified()) {
+                    initializedNotification.Notify();
+                }
+
+                if (!hasMoreMessages && config->isInitialized()) {
+                    // The queue drained: let the typechecker spend the lull on deferred work.
+                    // Each slice is bounded (one budgeted sweep pass, one file's suggestions), so
+                    // an edit arriving right behind it waits little, and both calls are no-ops
+                    // once their backlog is empty.
+                    typecheckerCoord.asyncRun([](LSPTypechecker &typechecker) {
+                        typechecker.idleResumeSigSuggestions();
+                        typechecker.idleSweepCache();
+                    });
+                }
             }
 
             auto currentTime = chrono::steady_clock::now();
@@ -1,4 +1,5 @@
 #include "common/Timer.h"
+#include "common/web_tracer_framework/tracing.h"
 #include "lsp.h"
 
 using namespace std;
@@ -25,7 +26,6 @@ void LSPLoop::processRequests(vector<unique_ptr<LSPMessage>> messages) {
     }
     ENFORCE(state.paused == false, "__PAUSE__ not supported in single-threaded mode.");
     for (auto &message : state.pendingRequests) {
-        maybeStartCommitSlowPathEdit(*message);
         processRequestInternal(*message);
     }
 }
@@ -38,7 +38,7 @@ void LSPLoop::processRequestInternal(LSPMessage &msg) {
     Timer timeit(logger, "process_request");
     const LSPMethod method = msg.method();
     if (msg.isNotification()) {
-        Timer timeit(logger, "notification", {{"method", convertLSPMethodToString(method)}});
+        Timer timeit(logger, "notification", {{"method", internDynamicName(convertLSPMethodToString(method))}});
         // The preprocessor should canonicalize these messages into SorbetWorkspaceEdits, so they should never appear
         // here.
         ENFORCE(method != LSPMethod::TextDocumentDidChange && method != LSPMethod::TextDocumentDidOpen &&
@@ -48,17 +48,33 @@ void LSPLoop::processRequestInternal(LSPMessage &msg) {
             // Note: We increment `lsp.messages.processed` when the original requests were merged into this one.
             shared_ptr<SorbetWorkspaceEditParams> editParams = move(get<unique_ptr<SorbetWorkspaceEditParams>>(params));
             // Since std::function is copyable, we have to promote captured unique_ptrs into shared_ptrs.
-            // TODO(jvilk): Switch to asyncRun once I sort out how this interplays with cancelable slow path.
-            typecheckerCoord.syncRun([editParams](LSPTypechecker &typechecker) -> void {
-                const u4 end = editParams->updates.versionEnd;
-                const u4 start = editParams->updates.versionStart;
+            // Run asynchronously so later messages (like hover and completion requests) can preempt a slow path at a
+            // file boundary instead of waiting behind the whole typecheck. The coordinator queue keeps edits ordered.
+            typecheckerCoord.asyncRun([this, editParams](LSPTypechecker &typechecker) -> void {
+                auto &updates = editParams->updates;
+                if (!updates.canTakeFastPath && updates.updatedGS.has_value()) {
+                    // Mark the slow path as running so the preprocessor can cancel it. This has to happen here, on
+                    // the typechecker thread: starting the epoch from the message processing thread could let a
+                    // previous, still-unwinding slow path observe the new epoch and commit under the wrong version.
+                    updates.updatedGS.value()->startCommitEpoch(updates.versionStart - 1, updates.versionEnd);
+                }
+                const u4 end = updates.versionEnd;
+                const u4 start = updates.versionStart;
                 // Versions are sequential and wrap around. Use them to figure out how many edits are contained
                 // within this update.
                 const u4 merged = min(end - start, 0xFFFFFFFF - start + end);
+                const bool tookFastPath = updates.canTakeFastPath;
+                auto typecheckStart = chrono::steady_clock::now();
                 // Only report stats if the edit was committed.
                 if (!typechecker.typecheck(move(editParams->updates))) {
                     prodCategoryCounterInc("lsp.messages.processed", "sorbet/workspaceEdit");
                     prodCategoryCounterAdd("lsp.messages.processed", "sorbet/mergedEdits", merged);
+                    if (tookFastPath) {
+                        auto durationUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() -
+                                                                                      typecheckStart)
+                                              .count();
+                        this->lastFastPathDurationUs.store(static_cast<u4>(durationUs), memory_order_relaxed);
+                    }
                 }
             });
         } else if (method == LSPMethod::Initialized) {
@@ -81,7 +97,7 @@ void LSPLoop::processRequestInternal(LSPMessage &msg) {
             }
         }
     } else if (msg.isRequest()) {
-        Timer timeit(logger, "request", {{"method", convertLSPMethodToString(method)}});
+        Timer timeit(logger, "request", {{"method", internDynamicName(convertLSPMethodToString(method))}});
         auto &requestMessage = msg.asRequest();
         // asRequest() should guarantee the presence of an ID.
         ENFORCE(msg.id());
@@ -100,7 +116,10 @@ void LSPLoop::processRequestInternal(LSPMessage &msg) {
             auto response = make_unique<ResponseMessage>("2.0", id, method);
             const auto &opts = config->opts;
             auto serverCap = make_unique<ServerCapabilities>();
-            serverCap->textDocumentSync = TextDocumentSyncKind::Full;
+            // Incremental sync: clients send ranged TextDocumentContentChangeEvents instead of
+            // re-transmitting the whole buffer on every keystroke. canonicalizeEdits applies them
+            // in-place; full replacements remain supported for clients that do not opt in.
+            serverCap->textDocumentSync = TextDocumentSyncKind::Incremental;
             serverCap->definitionProvider = true;
             serverCap->typeDefinitionProvider = true;
             serverCap->documentSymbolProvider = opts.lspDocumentSymbolEnabled;
@@ -130,41 +149,48 @@ void LSPLoop::processRequestInternal(LSPMessage &msg) {
             config->output->write(move(response));
         } else if (method == LSPMethod::TextDocumentDocumentSymbol) {
             auto &params = get<unique_ptr<DocumentSymbolParams>>(rawParams);
-            typecheckerCoord.syncRun([&](auto &typechecker) -> void {
-                config->output->write(handleTextDocumentDocumentSymbol(typechecker, id, *params));
-            });
+            typecheckerCoord.syncRun(
+                [&](auto &typechecker) -> void {
+                    config->output->write(handleTextDocumentDocumentSymbol(typechecker, id, *params));
+                },
+                /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::WorkspaceSymbol) {
             auto &params = get<unique_ptr<WorkspaceSymbolParams>>(rawParams);
-            typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleWorkspaceSymbols(tc, id, *params)); });
+            typecheckerCoord.syncRun([&](auto &tc) -> void { config->output->write(handleWorkspaceSymbols(tc, id, *params)); },
+                                     /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::TextDocumentDefinition) {
             auto &params = get<unique_ptr<TextDocumentPositionParams>>(rawParams);
             typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleTextDocumentDefinition(tc, id, *params)); });
+                [&](auto &tc) -> void { config->output->write(handleTextDocumentDefinition(tc, id, *params)); },
+                /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::TextDocumentTypeDefinition) {
             auto &params = get<unique_ptr<TextDocumentPositionParams>>(rawParams);
             typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleTextDocumentTypeDefinition(tc, id, *params)); });
+                [&](auto &tc) -> void { config->output->write(handleTextDocumentTypeDefinition(tc, id, *params)); },
+                /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::TextDocumentHover) {
             auto &params = get<unique_ptr<TextDocumentPositionParams>>(rawParams);
-            typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleTextDocumentHover(tc, id, *params)); });
+            typecheckerCoord.syncRun([&](auto &tc) -> void { config->output->write(handleTextDocumentHover(tc, id, *params)); },
+                                     /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::TextDocumentCompletion) {
             auto &params = get<unique_ptr<CompletionParams>>(rawParams);
             typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleTextDocumentCompletion(tc, id, *params)); });
+                [&](auto &tc) -> void { config->output->write(handleTextDocumentCompletion(tc, id, *params)); },
+                /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::TextDocumentCodeAction) {
             auto &params = get<unique_ptr<CodeActionParams>>(rawParams);
             typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleTextDocumentCodeAction(tc, id, *params)); });
+                [&](auto &tc) -> void { config->output->write(handleTextDocumentCodeAction(tc, id, *params)); },
+                /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::TextDocumentSignatureHelp) {
             auto &params = get<unique_ptr<TextDocumentPositionParams>>(rawParams);
-            typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleTextSignatureHelp(tc, id, *params)); });
+            typecheckerCoord.syncRun([&](auto &tc) -> void { config->output->write(handleTextSignatureHelp(tc, id, *params)); },
+                                     /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::TextDocumentReferences) {
             auto &params = get<unique_ptr<ReferenceParams>>(rawParams);
             typecheckerCoord.syncRun(
-                [&](auto &tc) -> void { config->output->write(handleTextDocumentReferences(tc, id, *params)); });
+                [&](auto &tc) -> void { config->output->write(handleTextDocumentReferences(tc, id, *params)); },
+                /* canPreemptSlowPath */ true);
         } else if (method == LSPMethod::SorbetReadFile) {
             auto &params = get<unique_ptr<TextDocumentIdentifier>>(rawParams);
             typecheckerCoord.syncRun([&](auto &tc) -> void {
@@ -180,6 +206,14 @@ void LSPLoop::processRequestInternal(LSPMessage &msg) {
                 }
                 config->output->write(move(response));
             });
+        } else if (method == LSPMethod::SorbetDumpTrace) {
+            auto &params = get<unique_ptr<SorbetDumpTraceParams>>(rawParams);
+            prodCategoryCounterInc("lsp.messages.processed", "sorbet.dumpTrace");
+            // The ring buffer is global, so we can respond directly without involving the typechecker.
+            auto response = make_unique<ResponseMessage>("2.0", id, method);
+            response->result =
+                web_tracer_framework::Tracing::dumpRecentTraces(params->lastSeconds.value_or(30.0));
+            config->output->write(move(response));
         } else if (method == LSPMethod::Shutdown) {
             prodCategoryCounterInc("lsp.messages.processed", "shutdown");
             auto response = make_unique<ResponseMessage>("2.0", id, method);
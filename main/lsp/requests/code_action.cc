@@ -21,17 +21,14 @@ unique_ptr<ResponseMessage> LSPLoop::handleTextDocumentCodeAction(LSPTypechecker
 
     const core::GlobalState &gs = typechecker.state();
     core::FileRef file = config->uri2FileRef(gs, params.textDocument->uri);
-    LSPFileUpdates updates;
-    updates.canTakeFastPath = true;
-    const auto &globalStateHashes = typechecker.getFileHashes();
-    ENFORCE(file.id() < globalStateHashes.size());
-    updates.updatedFileHashes = {globalStateHashes[file.id()]};
-    updates.updatedFiles.push_back(make_shared<core::File>(string(file.data(gs).path()), string(file.data(gs).source()),
-                                                           core::File::Type::Normal));
-    // Simply querying the file in question is insufficient since indexing errors would not be detected.
-    auto run = typechecker.retypecheck(move(updates));
     auto loc = params.range->toLoc(gs, file);
-    for (auto &error : run.errors) {
+    // Answer from the errors recorded by the file's last typecheck rather than retypechecking the
+    // file: the recorded errors match the committed contents (including indexing errors), and this
+    // request arrives on every cursor move, where the usual answer is "no actions". Edit payloads
+    // are materialized only for errors that enclose the requested range.
+    auto *errors = typechecker.errorsForFile(file);
+    const static std::vector<unique_ptr<core::Error>> noErrors;
+    for (auto &error : errors != nullptr ? *errors : noErrors) {
         if (!error->isSilenced && !error->autocorrects.empty()) {
             // We return code actions corresponding to any error that encloses the request's range. Matching request
             // ranges against error ranges exactly prevents VSCode's quick fix shortcut (Cmd+.) from matching any
@@ -4,6 +4,7 @@
 #include "common/sort.h"
 #include "common/typecase.h"
 #include "core/lsp/QueryResponse.h"
+#include "main/lsp/CompletionIndex.h"
 #include "main/lsp/lsp.h"
 
 using namespace std;
@@ -67,32 +68,11 @@ const RubyKeyword rubyKeywords[] = {
     {"yield", "Starts execution of the block sent to the current method."},
 };
 
-vector<core::SymbolRef> ancestorsImpl(const core::GlobalState &gs, core::SymbolRef sym, vector<core::SymbolRef> &&acc) {
-    // The implementation here is similar to Symbols::derivesFrom.
-    ENFORCE(sym.data(gs)->isClassOrModuleLinearizationComputed());
-    acc.emplace_back(sym);
-
-    for (auto mixin : sym.data(gs)->mixins()) {
-        acc.emplace_back(mixin);
-    }
-
-    if (sym.data(gs)->superClass().exists()) {
-        return ancestorsImpl(gs, sym.data(gs)->superClass(), move(acc));
-    } else {
-        return move(acc);
-    }
-}
-
-// Basically the same as Module#ancestors from Ruby--but don't depend on it being exactly equal.
-// For us, it's just something that's vaguely ordered from "most specific" to "least specific" ancestor.
-vector<core::SymbolRef> ancestors(const core::GlobalState &gs, core::SymbolRef receiver) {
-    return ancestorsImpl(gs, receiver, vector<core::SymbolRef>{});
-}
-
 struct SimilarMethod final {
     int depth;
     core::SymbolRef receiver;
     core::SymbolRef method;
+    bool isPrivate;
 
     // Populated later
     core::TypePtr receiverType = nullptr;
@@ -101,23 +81,16 @@ struct SimilarMethod final {
 
 using SimilarMethodsByName = UnorderedMap<core::NameRef, vector<SimilarMethod>>;
 
-// First of pair is "found at this depth in the ancestor hierarchy"
-// Second of pair is method symbol found at that depth, with name similar to prefix.
-SimilarMethodsByName similarMethodsForClass(const core::GlobalState &gs, core::SymbolRef receiver, string_view prefix) {
+// Filters the receiver's flattened method table (built once per class by CompletionIndex, reused
+// across keystrokes) down to the methods whose names are similar to prefix.
+SimilarMethodsByName similarMethodsForClass(const core::GlobalState &gs, CompletionIndex &index,
+                                            core::SymbolRef receiver, string_view prefix) {
     auto result = SimilarMethodsByName{};
 
-    int depth = -1;
-    for (auto ancestor : ancestors(gs, receiver)) {
-        depth++;
-        for (auto [memberName, memberSymbol] : ancestor.data(gs)->members()) {
-            if (!memberSymbol.data(gs)->isMethod()) {
-                continue;
-            }
-
-            if (hasSimilarName(gs, memberName, prefix)) {
-                // Creates the the list if it does not exist
-                result[memberName].emplace_back(SimilarMethod{depth, receiver, memberSymbol});
-            }
+    for (auto &method : index.forClass(gs, receiver).methods) {
+        if (hasSimilarName(gs, method.name, prefix)) {
+            // Creates the the list if it does not exist
+            result[method.name].emplace_back(SimilarMethod{method.depth, receiver, method.symbol, method.isPrivate});
         }
     }
 
@@ -142,27 +115,28 @@ SimilarMethodsByName mergeSimilarMethods(SimilarMethodsByName left, SimilarMetho
     return result;
 }
 
-SimilarMethodsByName similarMethodsForReceiver(const core::GlobalState &gs, const core::TypePtr receiver,
-                                               string_view prefix) {
+SimilarMethodsByName similarMethodsForReceiver(const core::GlobalState &gs, CompletionIndex &index,
+                                               const core::TypePtr receiver, string_view prefix) {
     auto result = SimilarMethodsByName{};
 
     typecase(
-        receiver.get(), [&](core::ClassType *type) { result = similarMethodsForClass(gs, type->symbol, prefix); },
-        [&](core::AppliedType *type) { result = similarMethodsForClass(gs, type->klass, prefix); },
+        receiver.get(),
+        [&](core::ClassType *type) { result = similarMethodsForClass(gs, index, type->symbol, prefix); },
+        [&](core::AppliedType *type) { result = similarMethodsForClass(gs, index, type->klass, prefix); },
         [&](core::AndType *type) {
-            result = mergeSimilarMethods(similarMethodsForReceiver(gs, type->left, prefix),
-                                         similarMethodsForReceiver(gs, type->right, prefix));
+            result = mergeSimilarMethods(similarMethodsForReceiver(gs, index, type->left, prefix),
+                                         similarMethodsForReceiver(gs, index, type->right, prefix));
         },
-        [&](core::ProxyType *type) { result = similarMethodsForReceiver(gs, type->underlying(), prefix); },
+        [&](core::ProxyType *type) { result = similarMethodsForReceiver(gs, index, type->underlying(), prefix); },
         [&](core::Type *type) { return; });
 
     return result;
 }
 
 // Walk a core::DispatchResult to find methods similar to `prefix` on any of its DispatchComponents' receivers.
-SimilarMethodsByName allSimilarMethods(const core::GlobalState &gs, core::DispatchResult &dispatchResult,
-                                       string_view prefix) {
-    auto result = similarMethodsForReceiver(gs, dispatchResult.main.receiver, prefix);
+SimilarMethodsByName allSimilarMethods(const core::GlobalState &gs, CompletionIndex &index,
+                                       core::DispatchResult &dispatchResult, string_view prefix) {
+    auto result = similarMethodsForReceiver(gs, index, dispatchResult.main.receiver, prefix);
 
     // Convert to shared_ptr and take ownership
     shared_ptr<core::TypeConstraint> constr = move(dispatchResult.main.constr);
@@ -180,7 +154,7 @@ SimilarMethodsByName allSimilarMethods(const core::GlobalState &gs, core::Dispat
     if (dispatchResult.secondary != nullptr) {
         // Right now we completely ignore the secondaryKind (either AND or OR), and always intersect.
         // (See comment above mergeSimilarMethods)
-        result = mergeSimilarMethods(result, allSimilarMethods(gs, *dispatchResult.secondary, prefix));
+        result = mergeSimilarMethods(result, allSimilarMethods(gs, index, *dispatchResult.secondary, prefix));
     }
 
     return result;
@@ -394,7 +368,8 @@ unique_ptr<ResponseMessage> LSPLoop::handleTextDocumentCompletion(LSPTypechecker
             // isPrivateOk means that there is no syntactic receiver. This check prevents completing `x.de` to `x.def`
             auto similarKeywords = sendResp->isPrivateOk ? allSimilarKeywords(prefix) : vector<RubyKeyword>{};
 
-            auto similarMethodsByName = allSimilarMethods(gs, *sendResp->dispatchResult, prefix);
+            auto similarMethodsByName =
+                allSimilarMethods(gs, typechecker.getCompletionIndex(), *sendResp->dispatchResult, prefix);
             for (auto &[methodName, similarMethods] : similarMethodsByName) {
                 fast_sort(similarMethods, [&](const auto &left, const auto &right) -> bool {
                     if (left.depth != right.depth) {
@@ -407,17 +382,12 @@ unique_ptr<ResponseMessage> LSPLoop::handleTextDocumentCompletion(LSPTypechecker
 
             auto deduped = vector<SimilarMethod>{};
             for (auto &[methodName, similarMethods] : similarMethodsByName) {
-                if (methodName.data(gs)->kind == core::NameKind::UNIQUE &&
-                    methodName.data(gs)->unique.uniqueNameKind == core::UniqueNameKind::MangleRename) {
-                    // It's possible we want to ignore more things here. But note that we *don't* want to ignore all
-                    // unique names, because we want each overload to show up but those use unique names.
-                    continue;
-                }
+                // Mangle-renamed names were already dropped when the CompletionIndex table was built.
 
                 // Since each list is sorted by depth, taking the first elem dedups by depth within each name.
                 auto similarMethod = similarMethods[0];
 
-                if (similarMethod.method.data(gs)->isPrivate() && !sendResp->isPrivateOk) {
+                if (similarMethod.isPrivate && !sendResp->isPrivateOk) {
                     continue;
                 }
 
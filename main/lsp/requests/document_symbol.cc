@@ -1,4 +1,5 @@
 #include "core/lsp/QueryResponse.h"
+#include "main/lsp/DocumentOutlineIndex.h"
 #include "main/lsp/lsp.h"
 
 using namespace std;
@@ -12,7 +13,7 @@ void symbolRef2DocumentSymbolWalkMembers(const core::GlobalState &gs, core::Symb
     for (auto mem : sym.data(gs)->membersStableOrderSlow(gs)) {
         if (mem.first != core::Names::attached() && mem.first != core::Names::singleton()) {
             bool foundThisFile = false;
-            for (auto loc : mem.second.data(gs)->locs()) {
+            for (auto loc : mem.second.data(gs)->locs(gs)) {
                 foundThisFile = foundThisFile || loc.file() == filter;
             }
             if (!foundThisFile) {
@@ -83,19 +84,13 @@ unique_ptr<ResponseMessage> LSPLoop::handleTextDocumentDocumentSymbol(LSPTypeche
     vector<unique_ptr<DocumentSymbol>> result;
     string_view uri = params.textDocument->uri;
     auto fref = config->uri2FileRef(gs, uri);
-    for (u4 idx = 1; idx < gs.symbolsUsed(); idx++) {
-        core::SymbolRef ref(gs, idx);
-        if (!hideSymbol(gs, ref) &&
-            // a bit counter-intuitive, but this actually should be `!= fref`, as it prevents duplicates.
-            (ref.data(gs)->owner.data(gs)->loc().file() != fref || ref.data(gs)->owner == core::Symbols::root())) {
-            for (auto definitionLocation : ref.data(gs)->locs()) {
-                if (definitionLocation.file() == fref) {
-                    auto data = symbolRef2DocumentSymbol(gs, ref, fref);
-                    if (data) {
-                        result.push_back(move(data));
-                        break;
-                    }
-                }
+    if (fref.exists()) {
+        // The file's root symbols come precomputed from the outline index; only the recursion into
+        // their members (symbolRef2DocumentSymbol) runs per request.
+        for (auto ref : typechecker.getDocumentOutlineIndex().rootsForFile(gs, fref)) {
+            auto data = symbolRef2DocumentSymbol(gs, ref, fref);
+            if (data) {
+                result.push_back(move(data));
             }
         }
     }
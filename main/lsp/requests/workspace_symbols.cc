@@ -44,13 +44,10 @@ unique_ptr<ResponseMessage> LSPLoop::handleWorkspaceSymbols(LSPTypechecker &type
     ShowOperation op(*config, "WorkspaceSymbols", fmt::format("Searching for symbol `{}`...", searchString));
 
     const core::GlobalState &gs = typechecker.state();
-    for (u4 idx = 1; idx < gs.symbolsUsed(); idx++) {
-        core::SymbolRef ref(gs, idx);
-        if (hasSimilarName(gs, ref.data(gs)->name, searchString)) {
-            auto data = symbolRef2SymbolInformation(*config, gs, ref);
-            if (data) {
-                result.push_back(move(data));
-            }
+    for (auto ref : typechecker.getSymbolNameIndex().findSimilar(gs, searchString)) {
+        auto data = symbolRef2SymbolInformation(*config, gs, ref);
+        if (data) {
+            result.push_back(move(data));
         }
     }
     response->result = move(result);
@@ -1261,6 +1261,11 @@ void makeLSPTypes(vector<shared_ptr<JSONClassType>> &enumTypes, vector<shared_pt
                                             makeField("message", JSONString),
                                         },
                                         classTypes);
+    auto SorbetDumpTraceParams = makeObject("SorbetDumpTraceParams",
+                                            {
+                                                makeField("lastSeconds", makeOptional(JSONDouble)),
+                                            },
+                                            classTypes);
 
     /* Watchman JSON response objects */
     auto WatchmanQueryResponse = makeObject("WatchmanQueryResponse",
@@ -1298,6 +1303,7 @@ void makeLSPTypes(vector<shared_ptr<JSONClassType>> &enumTypes, vector<shared_pt
                                      "initialize",
                                      "initialized",
                                      "shutdown",
+                                     "sorbet/dumpTrace",
                                      "sorbet/error",
                                      "sorbet/readFile",
                                      "sorbet/showOperation",
@@ -1335,6 +1341,7 @@ void makeLSPTypes(vector<shared_ptr<JSONClassType>> &enumTypes, vector<shared_pt
                                                 {"textDocument/signatureHelp", TextDocumentPositionParams},
                                                 {"textDocument/codeAction", CodeActionParams},
                                                 {"workspace/symbol", WorkspaceSymbolParams},
+                                                {"sorbet/dumpTrace", SorbetDumpTraceParams},
                                                 {"sorbet/error", SorbetErrorParams},
                                                 {"sorbet/readFile", TextDocumentIdentifier},
                                             });
@@ -1370,6 +1377,8 @@ void makeLSPTypes(vector<shared_ptr<JSONClassType>> &enumTypes, vector<shared_pt
             // {"textDocument/codeAction", makeVariant({JSONNull, makeArray(makeVariant({CodeAction, Command}))})},
             // {"textDocument/codeAction", makeVariant({JSONNull, makeArray(CodeAction), makeArray(Command)})},
             {"workspace/symbol", makeVariant({JSONNull, makeArray(SymbolInformation)})},
+            // The Chrome trace JSON document, as a string.
+            {"sorbet/dumpTrace", JSONString},
             {"sorbet/error", SorbetErrorParams},
             {"sorbet/readFile", TextDocumentItem},
         });
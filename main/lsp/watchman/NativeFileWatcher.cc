@@ -0,0 +1,211 @@
+#include "NativeFileWatcher.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "common/FileOps.h"
+#include "common/sort.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace sorbet::realmain::lsp::watchman {
+
+namespace {
+// A batch is delivered once no new events have arrived for this long...
+constexpr int QUIET_WINDOW_MS = 100;
+// ...or once it has been accumulating this long, so event streams that outlast the quiet window
+// (a git checkout touching thousands of files) still flush in bounded time.
+constexpr int MAX_BATCH_AGE_MS = 1000;
+// How long to sleep per poll while idle; bounds how quickly the thread notices it was stopped.
+constexpr int IDLE_POLL_MS = 1000;
+} // namespace
+
+NativeFileWatcher::NativeFileWatcher(
+    shared_ptr<spdlog::logger> logger, string_view workSpace, vector<string> extensions,
+    function<void(unique_ptr<sorbet::realmain::lsp::WatchmanQueryResponse>)> processUpdate,
+    std::function<void(int)> processExit)
+    : logger(std::move(logger)), workSpace(string(workSpace)), extensions(std::move(extensions)),
+      processUpdate(std::move(processUpdate)), processExit(std::move(processExit)),
+      thread(runInAThread("nativeFileWatcher", std::bind(&NativeFileWatcher::start, this))) {}
+
+NativeFileWatcher::~NativeFileWatcher() {
+    exitWithCode(0);
+    // Destructor of Joinable ensures the watcher thread exits before this destructor finishes.
+};
+
+#ifdef __linux__
+
+void NativeFileWatcher::start() {
+    try {
+        logger->debug("Starting native (inotify) monitoring of path {} for files with extensions {}", workSpace,
+                      fmt::join(extensions, ","));
+
+        vector<string> suffixes;
+        for (auto &ext : extensions) {
+            suffixes.emplace_back(absl::StrCat(".", ext));
+        }
+        auto matchesSuffix = [&suffixes](string_view name) -> bool {
+            for (auto &suffix : suffixes) {
+                if (absl::EndsWith(name, suffix)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0) {
+            throw SorbetException("inotify_init1 failed");
+        }
+
+        // Watch descriptor -> directory path relative to the workspace root ("" for the root).
+        UnorderedMap<int, string> watchedDirs;
+        constexpr u4 dirMask = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF |
+                               IN_EXCL_UNLINK | IN_ONLYDIR;
+
+        // Recursively watches `relative` (and its subdirectories), appending files that match the
+        // watched suffixes to `discovered`: a directory moved or created during a batch may already
+        // contain files whose events predate our watch.
+        auto addWatches = [&](const string &relative, UnorderedSet<string> *discovered,
+                              auto &addWatchesRef) -> void {
+            auto absolute = relative.empty() ? workSpace : absl::StrCat(workSpace, "/", relative);
+            int wd = inotify_add_watch(inotifyFd, absolute.c_str(), dirMask);
+            if (wd < 0) {
+                // The directory may already be gone, or we ran out of watches; either way there is
+                // nothing to subscribe to.
+                logger->debug("inotify_add_watch failed for {}", absolute);
+                return;
+            }
+            watchedDirs[wd] = relative;
+            DIR *dir = opendir(absolute.c_str());
+            if (dir == nullptr) {
+                return;
+            }
+            while (auto *entry = readdir(dir)) {
+                string_view name(entry->d_name);
+                if (name == "." || name == ".." || absl::StartsWith(name, ".")) {
+                    // Skipping dot-directories keeps us out of .git's object churn; files matching
+                    // the watched suffixes never legitimately live under them.
+                    continue;
+                }
+                auto childRel = relative.empty() ? string(name) : absl::StrCat(relative, "/", name);
+                if (entry->d_type == DT_DIR) {
+                    addWatchesRef(childRel, discovered, addWatchesRef);
+                } else if (discovered != nullptr && matchesSuffix(name)) {
+                    discovered->insert(childRel);
+                }
+            }
+            closedir(dir);
+        };
+        addWatches("", nullptr, addWatches);
+
+        UnorderedSet<string> changed;
+        chrono::steady_clock::time_point batchStart;
+        alignas(struct inotify_event) char buf[64 * 1024];
+
+        while (!isStopped()) {
+            struct pollfd pfd = {inotifyFd, POLLIN, 0};
+            int timeoutMs = changed.empty() ? IDLE_POLL_MS : QUIET_WINDOW_MS;
+            int ready = poll(&pfd, 1, timeoutMs);
+            auto now = chrono::steady_clock::now();
+
+            if (ready > 0) {
+                ssize_t len;
+                while ((len = read(inotifyFd, buf, sizeof(buf))) > 0) {
+                    for (char *ptr = buf; ptr < buf + len;) {
+                        auto *event = reinterpret_cast<const struct inotify_event *>(ptr);
+                        ptr += sizeof(struct inotify_event) + event->len;
+
+                        if (event->mask & IN_Q_OVERFLOW) {
+                            // The kernel dropped events. Treat every watched file as potentially
+                            // changed; unchanged ones are cheap for the preprocessor to reject by
+                            // content hash.
+                            logger->warn("inotify event queue overflowed; rescanning workspace");
+                            if (changed.empty()) {
+                                batchStart = now;
+                            }
+                            addWatches("", &changed, addWatches);
+                            continue;
+                        }
+                        auto dirEntry = watchedDirs.find(event->wd);
+                        if (dirEntry == watchedDirs.end()) {
+                            continue;
+                        }
+                        if (event->mask & (IN_IGNORED | IN_DELETE_SELF)) {
+                            watchedDirs.erase(dirEntry);
+                            continue;
+                        }
+                        if (event->len == 0) {
+                            continue;
+                        }
+                        string_view name(event->name);
+                        auto relative = dirEntry->second.empty() ? string(name)
+                                                                 : absl::StrCat(dirEntry->second, "/", name);
+                        if (event->mask & IN_ISDIR) {
+                            if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && !absl::StartsWith(name, ".")) {
+                                addWatches(relative, &changed, addWatches);
+                            }
+                            continue;
+                        }
+                        if (matchesSuffix(name)) {
+                            // IN_MOVED_TO is the landing half of an editor's atomic save; the
+                            // temporary file's own events fail the suffix match, so a save
+                            // coalesces into this one path.
+                            if (changed.empty()) {
+                                batchStart = now;
+                            }
+                            changed.insert(move(relative));
+                        }
+                    }
+                }
+            }
+
+            bool quietWindowElapsed = ready == 0;
+            bool batchTooOld =
+                !changed.empty() &&
+                chrono::duration_cast<chrono::milliseconds>(now - batchStart).count() >= MAX_BATCH_AGE_MS;
+            if (!changed.empty() && (quietWindowElapsed || batchTooOld)) {
+                vector<string> files(make_move_iterator(changed.begin()), make_move_iterator(changed.end()));
+                changed.clear();
+                fast_sort(files);
+                logger->debug("Native watcher delivering batch of {} changed files", files.size());
+                processUpdate(make_unique<WatchmanQueryResponse>("", "", false, move(files)));
+            }
+        }
+
+        close(inotifyFd);
+    } catch (exception &e) {
+        logger->info("Error running the native file watcher.\nFile watching is required for Sorbet to detect changes "
+                     "to files made outside of your code editor.");
+        exitWithCode(1);
+    }
+}
+
+#else
+
+void NativeFileWatcher::start() {
+    logger->error("The native file watcher is only supported on Linux; use Watchman on other platforms.");
+    exitWithCode(1);
+}
+
+#endif
+
+bool NativeFileWatcher::isStopped() {
+    absl::MutexLock lck(&mutex);
+    return stopped;
+}
+
+void NativeFileWatcher::exitWithCode(int code) {
+    absl::MutexLock lck(&mutex);
+    if (!stopped) {
+        stopped = true;
+        processExit(code);
+    }
+}
+
+} // namespace sorbet::realmain::lsp::watchman
@@ -0,0 +1,63 @@
+#ifndef RUBY_TYPER_LSP_WATCHMAN_NATIVEFILEWATCHER_H
+#define RUBY_TYPER_LSP_WATCHMAN_NATIVEFILEWATCHER_H
+
+#include "absl/synchronization/mutex.h"
+#include "common/common.h"
+#include "core/core.h"
+#include "main/lsp/json_types.h"
+#include "spdlog/spdlog.h"
+
+namespace sorbet::realmain::lsp::watchman {
+/**
+ * Watches the workspace for file changes with the kernel's own facility (inotify; Linux only)
+ * instead of an external watchman daemon, for fleets where running watchman is not an option.
+ * Deliberately presents the same interface and produces the same WatchmanQueryResponse updates as
+ * WatchmanProcess, so the rest of the LSP server cannot tell the two apart.
+ *
+ * Events are coalesced before delivery: a batch is emitted once the filesystem has been quiet for a
+ * short window (or a batch has been accumulating too long), with duplicate paths deduplicated.
+ * Editors' atomic saves (write temp file, rename over the original) and bulk git operations
+ * therefore arrive as one update rather than one per event.
+ */
+class NativeFileWatcher {
+private:
+    std::shared_ptr<spdlog::logger> logger;
+    const std::string workSpace;
+    const std::vector<std::string> extensions;
+    const std::function<void(std::unique_ptr<sorbet::realmain::lsp::WatchmanQueryResponse>)> processUpdate;
+    const std::function<void(int)> processExit;
+    const std::unique_ptr<Joinable> thread;
+    // Mutex that must be held before reading or writing stopped.
+    absl::Mutex mutex;
+    // If true, the watcher has been stopped.
+    bool stopped = false;
+
+    /**
+     * Establishes watches on the workspace and begins processing file changes. Runs in a dedicated
+     * thread.
+     */
+    void start();
+
+    void exitWithCode(int code);
+
+    bool isStopped();
+
+public:
+    /**
+     * Immediately starts watching the provided workspace folder in a background thread. Passes
+     * batched file updates to the `processUpdate` function.
+     */
+    NativeFileWatcher(std::shared_ptr<spdlog::logger> logger, std::string_view workSpace,
+                      std::vector<std::string> extensions,
+                      std::function<void(std::unique_ptr<sorbet::realmain::lsp::WatchmanQueryResponse>)> processUpdate,
+                      std::function<void(int)> processExit);
+
+    ~NativeFileWatcher();
+
+    NativeFileWatcher(const NativeFileWatcher &&) = delete;
+    NativeFileWatcher(NativeFileWatcher &) = delete;
+    void operator=(const NativeFileWatcher &) = delete;
+};
+} // namespace sorbet::realmain::lsp::watchman
+
+#endif // RUBY_TYPER_LSP_WATCHMAN_NATIVEFILEWATCHER_H
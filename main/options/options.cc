@@ -3,6 +3,7 @@
 #include "yaml-cpp/yaml.h"
 #include <cxxopts.hpp>
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
 #include "common/FileOps.h"
 #include "common/Timer.h"
@@ -53,6 +54,7 @@ const vector<PrintOptions> print_options({
     {"symbol-table", &Printers::SymbolTable, true},
     {"symbol-table-raw", &Printers::SymbolTableRaw, true},
     {"symbol-table-json", &Printers::SymbolTableJson, true},
+    {"symbol-table-proto", &Printers::SymbolTableProto, true, false},
     {"symbol-table-full", &Printers::SymbolTableFull, true},
     {"symbol-table-full-raw", &Printers::SymbolTableFullRaw, true},
     {"symbol-table-full-json", &Printers::SymbolTableFullJson, true},
@@ -78,11 +80,39 @@ void PrinterConfig::print(const string_view &contents) const {
     }
 };
 
+void PrinterConfig::printForFile(u4 fileId, string_view contents) const {
+    absl::MutexLock lck(&state->mutex);
+    fmt::format_to(state->perFile[fileId], "{}", contents);
+};
+
 void PrinterConfig::flush() {
-    if (!enabled || !supportsFlush || outputPath.empty()) {
+    if (!enabled || !supportsFlush) {
         return;
     }
     absl::MutexLock lck(&state->mutex);
+    if (!state->perFile.empty()) {
+        // Emit per-file output in FileRef order, after whatever went through plain print().
+        vector<u4> fileIds;
+        fileIds.reserve(state->perFile.size());
+        for (auto &[fileId, _contents] : state->perFile) {
+            fileIds.emplace_back(fileId);
+        }
+        fast_sort(fileIds);
+        for (auto fileId : fileIds) {
+            auto &contents = state->perFile[fileId];
+            fmt::format_to(state->buf, "{}", string_view(contents.data(), contents.size()));
+        }
+        state->perFile.clear();
+    }
+    if (outputPath.empty()) {
+        // print() writes straight to stdout when no output path is set; only the buffered
+        // per-file output is left to emit.
+        if (state->buf.size() > 0) {
+            fmt::print("{}", to_string(state->buf));
+            state->buf.clear();
+        }
+        return;
+    }
     FileOps::write(outputPath, to_string(state->buf));
 };
 
@@ -112,6 +142,7 @@ vector<reference_wrapper<PrinterConfig>> Printers::printers() {
         SymbolTable,
         SymbolTableRaw,
         SymbolTableJson,
+        SymbolTableProto,
         SymbolTableFull,
         SymbolTableFullRaw,
         FileTableJson,
@@ -315,11 +346,26 @@ buildOptions(const vector<pipeline::semantic_extension::SemanticExtensionProvide
                                     cxxopts::value<vector<string>>(), "path");
     options.add_options("advanced")("web-trace-file", "Web trace file. For use with chrome about://tracing",
                                     cxxopts::value<string>()->default_value(empty.webTraceFile), "file");
+    options.add_options("advanced")("web-trace-format",
+                                    "Format for --web-trace-file: {json, binary}. binary appends fixed-size records "
+                                    "via mmap (cheap enough to leave on in CI); convert with --web-trace-convert",
+                                    cxxopts::value<string>()->default_value("json"), "format");
+    options.add_options("advanced")("web-trace-convert",
+                                    "Convert a binary trace file (see --web-trace-format) to Chrome trace JSON on "
+                                    "stdout and exit",
+                                    cxxopts::value<string>()->default_value(empty.webTraceConvert), "file");
     options.add_options("advanced")("debug-log-file", "Path to debug log file",
                                     cxxopts::value<string>()->default_value(empty.debugLogFile), "file");
     options.add_options("advanced")("reserve-mem-kb",
                                     "Preallocate the specified amount of memory for symbol+name tables",
                                     cxxopts::value<u8>()->default_value(fmt::format("{}", empty.reserveMemKiB)));
+    options.add_options("advanced")("prefault-tables",
+                                    "Prefault the preallocated symbol+name tables at startup instead of taking page "
+                                    "faults on them during typechecking (Linux only)");
+    options.add_options("advanced")("widen-unions-above",
+                                    "Widen union types that grow beyond this many arms to a coarser upper bound, "
+                                    "trading marginal precision for bounded inference time. 0 disables widening",
+                                    cxxopts::value<int>()->default_value("0"), "N");
     options.add_options("advanced")("stdout-hup-hack", "Monitor STDERR for HUP and exit on hangup");
     options.add_options("advanced")("remove-path-prefix",
                                     "Remove the provided path prefix from all printed paths. Defaults to the input "
@@ -335,11 +381,19 @@ buildOptions(const vector<pipeline::semantic_extension::SemanticExtensionProvide
                                     "{always,never,[auto]}");
     options.add_options("advanced")("lsp", "Start in language-server-protocol mode");
     options.add_options("advanced")("no-config", "Do not load the content of the `sorbet/config` file");
+    options.add_options("advanced")("lsp-history-memory-kb",
+                                    "In language-server-protocol mode, estimated memory budget for the edit "
+                                    "history's retained index results; oldest results are dropped and re-derived "
+                                    "on demand once the budget is exceeded. 0 disables the budget",
+                                    cxxopts::value<u8>()->default_value(fmt::format("{}", empty.lspHistoryMemoryKiB)));
     options.add_options("advanced")("disable-watchman",
                                     "When in language-server-protocol mode, disable file watching via Watchman");
     options.add_options("advanced")("watchman-path",
                                     "Path to watchman executable. Defaults to using `watchman` on your PATH.",
                                     cxxopts::value<string>()->default_value(empty.watchmanPath));
+    options.add_options("advanced")("native-file-watcher",
+                                    "In language-server-protocol mode, watch for file changes with a built-in "
+                                    "inotify watcher instead of an external watchman daemon (Linux only)");
     options.add_options("advanced")("enable-experimental-lsp-autocomplete",
                                     "Enable experimental LSP feature: Autocomplete");
     options.add_options("advanced")("enable-experimental-lsp-autocomplete-methods",
@@ -351,6 +405,9 @@ buildOptions(const vector<pipeline::semantic_extension::SemanticExtensionProvide
     options.add_options("advanced")("enable-experimental-lsp-signature-help",
                                     "Enable experimental LSP feature: Signature Help");
     options.add_options("advanced")("enable-experimental-lsp-quick-fix", "Enable experimental LSP feature: Quick Fix");
+    options.add_options("advanced")(
+        "enable-experimental-lsp-scoped-typecheck",
+        "Enable experimental LSP feature: scope slow-path typechecking to the dependency closure of edited files");
     options.add_options("advanced")("enable-all-experimental-lsp-features", "Enable every experimental LSP feature.");
     options.add_options("advanced")(
         "ignore",
@@ -365,8 +422,44 @@ buildOptions(const vector<pipeline::semantic_extension::SemanticExtensionProvide
         "as sorbet: URIs to clients that understand them.",
         cxxopts::value<vector<string>>(), "string");
     options.add_options("advanced")("no-error-count", "Do not print the error count summary line");
+    options.add_options("advanced")("dedup-errors",
+                                    "Print each distinct error once, with an occurrence count and sample locations, "
+                                    "instead of formatting every occurrence");
+    options.add_options("advanced")("prune-dead-cfg-branches",
+                                    "Statically resolve conditional jumps on literal conditions and skip inference "
+                                    "for the untaken regions. Suppresses unreachable-code diagnostics inside pruned "
+                                    "regions");
+    options.add_options("advanced")("drop-typechecked-trees",
+                                    "Free each file's AST as soon as it has been typechecked instead of keeping every "
+                                    "tree alive until the end of the run; lowers peak memory");
+    options.add_options("advanced")("lsp-tree-cache-size",
+                                    "Maximum number of indexed file ASTs the language server keeps in memory. Trees "
+                                    "over the budget are evicted least-recently-used and re-indexed on next access "
+                                    "(from the --cache-dir tree cache when contents are unchanged). 0 keeps every "
+                                    "tree.",
+                                    cxxopts::value<int>()->default_value("0"), "int");
+    options.add_options("advanced")("sig-suggestion-budget-ms",
+                                    "Maximum wall-clock milliseconds a single file may spend computing suggested "
+                                    "signatures for methods missing a sig. Suggestions over the budget are skipped "
+                                    "(public methods are computed first); the missing-sig errors themselves are "
+                                    "unaffected. 0 computes every suggestion.",
+                                    cxxopts::value<int>()->default_value("0"), "int");
+    options.add_options("advanced")("error-output-format",
+                                    "Format for reported errors: 'text' (human-readable, the default) or 'binary' "
+                                    "(length-delimited records on stdout; see core/ErrorRecord.h)",
+                                    cxxopts::value<string>()->default_value("text"), "{text,binary}");
     options.add_options("advanced")("autogen-version", "Autogen version to output", cxxopts::value<int>());
+    options.add_options("advanced")("autogen-msgpack-sharded",
+                                    "Write autogen msgpack output as one shard file per worker, plus a manifest of "
+                                    "shard paths",
+                                    cxxopts::value<bool>());
     options.add_options("advanced")("stripe-mode", "Enable Stripe specific error enforcement", cxxopts::value<bool>());
+    options.add_options("advanced")("daemon", "Run a persistent typechecking daemon on the given unix socket",
+                                    cxxopts::value<string>(), "path");
+    options.add_options("advanced")("daemon-client",
+                                    "Connect to a running typechecking daemon on the given unix socket and send the "
+                                    "input file arguments as the changed-file list",
+                                    cxxopts::value<string>(), "path");
 
     options.add_options("advanced")(
         "autogen-autoloader-exclude-require",
@@ -407,6 +500,9 @@ buildOptions(const vector<pipeline::semantic_extension::SemanticExtensionProvide
                                cxxopts::value<string>()->default_value("inferencer"), "phase");
     options.add_options("dev")("no-stdlib", "Do not load included rbi files for stdlib");
     options.add_options("dev")("skip-rewriter-passes", "Do not run Rewriter passess");
+    options.add_options("dev")("strip-untyped-method-bodies",
+                               "Drop method bodies in files below `typed: true` during indexing. "
+                               "Faster, but silences constant resolution errors inside those bodies");
     options.add_options("dev")("wait-for-dbg", "Wait for debugger on start");
     options.add_options("dev")("stress-incremental-resolver",
                                "Force incremental updates to discover resolver & namer bugs");
@@ -431,11 +527,39 @@ buildOptions(const vector<pipeline::semantic_extension::SemanticExtensionProvide
                                cxxopts::value<string>()->default_value(""), "filepath.yaml");
     options.add_options("dev")("store-state", "Store state into file",
                                cxxopts::value<string>()->default_value(empty.storeState), "file");
+    options.add_options("dev")("store-resolved-state",
+                               "Serialize the post-resolve GlobalState (symbol, name and file tables) into file. "
+                               "Worker machines pass it to --load-resolved-state to typecheck shards of the same "
+                               "run without repeating index and resolve",
+                               cxxopts::value<string>()->default_value(empty.storeResolvedState), "file");
+    options.add_options("dev")("load-resolved-state",
+                               "Load a GlobalState written by --store-resolved-state instead of indexing and "
+                               "resolving; the state's file table supplies the inputs",
+                               cxxopts::value<string>()->default_value(empty.loadResolvedState), "file");
+    options.add_options("dev")("typecheck-shard",
+                               "Only typecheck the INDEX-th of COUNT deterministic file shards. Index and resolve "
+                               "still cover every file, so combine with --load-resolved-state to avoid repeating "
+                               "them on every machine",
+                               cxxopts::value<string>()->default_value(""), "INDEX/COUNT");
+    options.add_options("dev")("store-dependency-graph",
+                               "Persist a per-file constant dependency graph (file path -> referenced symbols) into "
+                               "the cache after constant resolution. Requires --cache-dir");
     options.add_options("dev")("cache-dir", "Use the specified folder to cache data",
                                cxxopts::value<string>()->default_value(empty.cacheDir), "dir");
+    options.add_options("dev")("cache-dir-remote",
+                               "Shared folder (e.g. an NFS mount) used as a second cache tier behind --cache-dir",
+                               cxxopts::value<string>()->default_value(empty.cacheRemoteDir), "dir");
+    options.add_options("dev")("cache-import",
+                               "Overlay entries from another cache database into --cache-dir at startup, e.g. an "
+                               "artifact published by a warm-up run at the workspace's merge-base commit",
+                               cxxopts::value<string>()->default_value(empty.cacheImportDir), "dir");
     options.add_options("dev")("suppress-non-critical", "Exit 0 unless there was a critical error");
     options.add_options("dev")("dsl-plugins", "YAML config that configures external DSL plugins",
                                cxxopts::value<string>()->default_value(""), "filepath.yaml");
+    options.add_options("dev")("dsl-plugins-persistent",
+                               "Run DSL plugin commands as long-lived worker processes fed requests over pipes "
+                               "instead of one subprocess per invocation. Requires plugins that support the "
+                               "persistent worker protocol");
 
     int defaultThreads = thread::hardware_concurrency();
     if (defaultThreads == 0) {
@@ -466,6 +590,14 @@ buildOptions(const vector<pipeline::semantic_extension::SemanticExtensionProvide
                                cxxopts::value<string>()->default_value(empty.metricsSha), "sha1");
     options.add_options("dev")("metrics-repo", "Repo to report in metrics export",
                                cxxopts::value<string>()->default_value(empty.metricsRepo), "repo");
+    options.add_options("dev")("profile-flamegraph",
+                               "Sample stacks with SIGPROF and write collapsed-stack output to this "
+                               "file on exit (render with flamegraph.pl or speedscope)",
+                               cxxopts::value<string>()->default_value(empty.profileFlamegraphFile), "file");
+    options.add_options("dev")("timing-report",
+                               "Print the top N slowest files per phase after the run, with deltas "
+                               "versus the previous run when --cache-dir is set",
+                               cxxopts::value<int>()->default_value("0"), "N");
 
     for (auto &provider : semanticExtensionProviders) {
         provider->injectOptions(options);
@@ -672,6 +804,9 @@ void readOptions(Options &opts,
         opts.lspAutocompleteMethodsEnabled = enableAllLSPFeatures || opts.lspAutocompleteEnabled ||
                                              raw["enable-experimental-lsp-autocomplete-methods"].as<bool>();
         opts.lspQuickFixEnabled = enableAllLSPFeatures || raw["enable-experimental-lsp-quick-fix"].as<bool>();
+        // Deliberately not covered by enable-all: it changes which files get rechecked, not just
+        // which requests are answered.
+        opts.lspScopedTypecheckEnabled = raw["enable-experimental-lsp-scoped-typecheck"].as<bool>();
         opts.lspWorkspaceSymbolsEnabled =
             enableAllLSPFeatures || raw["enable-experimental-lsp-workspace-symbols"].as<bool>();
         opts.lspDocumentSymbolEnabled =
@@ -691,6 +826,16 @@ void readOptions(Options &opts,
         }
 
         opts.cacheDir = raw["cache-dir"].as<string>();
+        opts.cacheRemoteDir = raw["cache-dir-remote"].as<string>();
+        if (!opts.cacheRemoteDir.empty() && opts.cacheDir.empty()) {
+            logger->error("--cache-dir-remote requires --cache-dir.");
+            throw EarlyReturnWithCode(1);
+        }
+        opts.cacheImportDir = raw["cache-import"].as<string>();
+        if (!opts.cacheImportDir.empty() && opts.cacheDir.empty()) {
+            logger->error("--cache-import requires --cache-dir.");
+            throw EarlyReturnWithCode(1);
+        }
         if (!extractPrinters(raw, opts, logger)) {
             throw EarlyReturnWithCode(1);
         }
@@ -709,12 +854,9 @@ void readOptions(Options &opts,
         }
 
         opts.runLSP = raw["lsp"].as<bool>();
-        if (opts.runLSP && !opts.cacheDir.empty()) {
-            logger->error("lsp mode does not yet support caching.");
-            throw EarlyReturnWithCode(1);
-        }
         opts.disableWatchman = raw["disable-watchman"].as<bool>();
         opts.watchmanPath = raw["watchman-path"].as<string>();
+        opts.nativeFileWatcher = raw["native-file-watcher"].as<bool>();
         // Certain features only need certain passes
         if (opts.print.isAutogen() && (opts.stopAfterPhase != Phase::NAMER)) {
             logger->error(
@@ -745,6 +887,30 @@ void readOptions(Options &opts,
         }
 
         opts.noErrorCount = raw["no-error-count"].as<bool>();
+        opts.dedupErrors = raw["dedup-errors"].as<bool>();
+        opts.pruneDeadCfgBranches = raw["prune-dead-cfg-branches"].as<bool>();
+        opts.dropTypecheckedTrees = raw["drop-typechecked-trees"].as<bool>();
+        opts.lspTreeCacheSize = raw["lsp-tree-cache-size"].as<int>();
+        if (opts.lspTreeCacheSize < 0) {
+            logger->error("--lsp-tree-cache-size must be non-negative");
+            throw EarlyReturnWithCode(1);
+        }
+        opts.sigSuggestionBudgetMs = raw["sig-suggestion-budget-ms"].as<int>();
+        if (opts.sigSuggestionBudgetMs < 0) {
+            logger->error("--sig-suggestion-budget-ms must be non-negative");
+            throw EarlyReturnWithCode(1);
+        }
+        auto errorOutputFormat = raw["error-output-format"].as<string>();
+        if (errorOutputFormat == "binary") {
+            opts.binaryErrorFormat = true;
+            if (opts.dedupErrors) {
+                logger->error("--dedup-errors has no effect with --error-output-format=binary");
+                throw EarlyReturnWithCode(1);
+            }
+        } else if (errorOutputFormat != "text") {
+            logger->error("Unknown --error-output-format option: {}\nValid values: text, binary", errorOutputFormat);
+            throw EarlyReturnWithCode(1);
+        }
         opts.noStdlib = raw["no-stdlib"].as<bool>();
         opts.stdoutHUPHack = raw["stdout-hup-hack"].as<bool>();
 
@@ -784,7 +950,32 @@ void readOptions(Options &opts,
             opts.configatronFiles = raw["configatron-file"].as<vector<string>>();
         }
         opts.skipRewriterPasses = raw["skip-rewriter-passes"].as<bool>();
+        opts.stripUntypedMethodBodies = raw["strip-untyped-method-bodies"].as<bool>();
         opts.storeState = raw["store-state"].as<string>();
+        opts.storeResolvedState = raw["store-resolved-state"].as<string>();
+        opts.loadResolvedState = raw["load-resolved-state"].as<string>();
+        if (!opts.storeResolvedState.empty() && !opts.loadResolvedState.empty()) {
+            logger->error("--store-resolved-state and --load-resolved-state are mutually exclusive");
+            throw EarlyReturnWithCode(1);
+        }
+        auto typecheckShard = raw["typecheck-shard"].as<string>();
+        if (!typecheckShard.empty()) {
+            auto slash = typecheckShard.find('/');
+            u4 index = 0;
+            u4 count = 0;
+            if (slash == string::npos || !absl::SimpleAtoi(typecheckShard.substr(0, slash), &index) ||
+                !absl::SimpleAtoi(typecheckShard.substr(slash + 1), &count) || count == 0 || index >= count) {
+                logger->error("--typecheck-shard must look like INDEX/COUNT with INDEX < COUNT");
+                throw EarlyReturnWithCode(1);
+            }
+            opts.typecheckShardIndex = index;
+            opts.typecheckShardCount = count;
+        }
+        opts.storeDependencyGraph = raw["store-dependency-graph"].as<bool>();
+        if (opts.storeDependencyGraph && opts.cacheDir.empty()) {
+            logger->error("--store-dependency-graph requires --cache-dir");
+            throw EarlyReturnWithCode(1);
+        }
         opts.suggestTyped = raw["suggest-typed"].as<bool>();
         opts.waitForDebugger = raw["wait-for-dbg"].as<bool>();
         opts.stressIncrementalResolver = raw["stress-incremental-resolver"].as<bool>();
@@ -803,7 +994,26 @@ void readOptions(Options &opts,
         opts.metricsPrefix = raw["metrics-prefix"].as<string>();
         opts.debugLogFile = raw["debug-log-file"].as<string>();
         opts.webTraceFile = raw["web-trace-file"].as<string>();
+        {
+            auto webTraceFormat = raw["web-trace-format"].as<string>();
+            if (webTraceFormat == "binary") {
+                opts.webTraceBinary = true;
+            } else if (webTraceFormat != "json") {
+                logger->error("Unknown web-trace-format: {}. Valid values: json, binary", webTraceFormat);
+                throw EarlyReturnWithCode(1);
+            }
+        }
+        opts.webTraceConvert = raw["web-trace-convert"].as<string>();
+        opts.profileFlamegraphFile = raw["profile-flamegraph"].as<string>();
+        opts.timingReport = raw["timing-report"].as<int>();
         opts.reserveMemKiB = raw["reserve-mem-kb"].as<u8>();
+        opts.prefaultTables = raw["prefault-tables"].as<bool>();
+        opts.widenUnionsAbove = raw["widen-unions-above"].as<int>();
+        opts.lspHistoryMemoryKiB = raw["lsp-history-memory-kb"].as<u8>();
+        if (opts.widenUnionsAbove < 0) {
+            logger->error("--widen-unions-above must be non-negative");
+            throw EarlyReturnWithCode(1);
+        }
         if (raw.count("autogen-version") > 0) {
             if (!opts.print.AutogenMsgPack.enabled) {
                 logger->error("`{}` must also include `{}`", "--autogen-version", "-p autogen-msgpack");
@@ -811,7 +1021,21 @@ void readOptions(Options &opts,
             }
             opts.autogenVersion = raw["autogen-version"].as<int>();
         }
+        if (raw["autogen-msgpack-sharded"].as<bool>()) {
+            if (!opts.print.AutogenMsgPack.enabled || opts.print.AutogenMsgPack.outputPath.empty()) {
+                logger->error("`{}` requires `{}` with an output file", "--autogen-msgpack-sharded",
+                              "-p autogen-msgpack:<path>");
+                throw EarlyReturnWithCode(1);
+            }
+            opts.autogenMsgpackSharded = true;
+        }
         opts.stripeMode = raw["stripe-mode"].as<bool>();
+        if (raw.count("daemon") > 0) {
+            opts.daemonSocketPath = raw["daemon"].as<string>();
+        }
+        if (raw.count("daemon-client") > 0) {
+            opts.daemonClientSocketPath = raw["daemon-client"].as<string>();
+        }
         extractAutoloaderConfig(raw, opts, logger);
         opts.errorUrlBase = raw["error-url-base"].as<string>();
         if (raw.count("error-white-list") > 0) {
@@ -830,7 +1054,8 @@ void readOptions(Options &opts,
             opts.suggestSig = raw["suggest-sig"].as<bool>();
         }
 
-        if (raw.count("e") == 0 && opts.inputFileNames.empty() && !opts.runLSP && opts.storeState.empty()) {
+        if (raw.count("e") == 0 && opts.inputFileNames.empty() && !opts.runLSP && opts.storeState.empty() &&
+            opts.loadResolvedState.empty()) {
             logger->error("You must pass either `{}` or at least one folder or ruby file.\n\n{}", "-e",
                           options.help({""}));
             throw EarlyReturnWithCode(1);
@@ -878,6 +1103,11 @@ void readOptions(Options &opts,
             opts.dslPluginTriggers = std::move(dslConfig.triggers);
             opts.dslRubyExtraArgs = std::move(dslConfig.rubyExtraArgs);
         }
+        opts.dslPluginsPersistent = raw["dsl-plugins-persistent"].as<bool>();
+        if (opts.dslPluginsPersistent && opts.dslPluginTriggers.empty()) {
+            logger->error("`{}` requires `{}`", "--dsl-plugins-persistent", "--dsl-plugins");
+            throw EarlyReturnWithCode(1);
+        }
 
         for (auto &provider : semanticExtensionProviders) {
             auto maybeExtension = provider->readOptions(raw);
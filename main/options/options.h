@@ -26,6 +26,13 @@ public:
     template <typename... Args> void fmt(const ConstExprStr msg, const Args &... args) const {
         print(fmt::format(msg.str, args...));
     }
+    // For per-file output produced on worker threads (CFGs, per-file trees): appends to a buffer
+    // keyed by FileRef id, and flush() emits the buffers in file order. That keeps whole-program
+    // dumps deterministic — diffable across builds — no matter which worker finished first.
+    void printForFile(u4 fileId, std::string_view contents) const;
+    template <typename... Args> void fmtForFile(u4 fileId, const ConstExprStr msg, const Args &... args) const {
+        printForFile(fileId, fmt::format(msg.str, args...));
+    }
     void flush();
 
     PrinterConfig();
@@ -37,6 +44,9 @@ public:
 private:
     struct GuardedState {
         fmt::memory_buffer buf;
+        // See printForFile: worker threads append here in completion order, and flush() drains
+        // the buffers sorted by file id.
+        UnorderedMap<u4, fmt::memory_buffer> perFile;
         absl::Mutex mutex;
     };
     std::shared_ptr<GuardedState> state;
@@ -72,6 +82,9 @@ struct Printers {
     PrinterConfig SymbolTable;
     PrinterConfig SymbolTableRaw;
     PrinterConfig SymbolTableJson;
+    // symbol-table-proto streams the table as concatenated single-symbol MultiSymbol records; see
+    // Symbol.proto. Unlike symbol-table-json it never materializes the whole table in memory.
+    PrinterConfig SymbolTableProto;
     PrinterConfig SymbolTableFull;
     PrinterConfig SymbolTableFullRaw;
     PrinterConfig SymbolTableFullJson;
@@ -135,27 +148,81 @@ struct Options {
     bool supressNonCriticalErrors = false;
     bool runLSP = false;
     bool disableWatchman = false;
+    // Watch for file changes with the built-in inotify watcher instead of an external watchman
+    // daemon. Linux only.
+    bool nativeFileWatcher = false;
     std::string watchmanPath = "watchman";
     bool stressIncrementalResolver = false;
     bool sleepInSlowPath = false;
     bool noErrorCount = false;
+    bool dedupErrors = false;
+    // --error-output-format=binary: emit length-delimited binary diagnostic records on stdout
+    // instead of formatted text (see core/ErrorRecord.h).
+    bool binaryErrorFormat = false;
     bool autocorrect = false;
     bool waitForDebugger = false;
     bool skipRewriterPasses = false;
+    // Index files below `typed: true` as outlines: drop method bodies after the rewriter. Their
+    // bodies are never type-checked, but this also silences constant resolution errors inside
+    // them, so it is opt-in (--strip-untyped-method-bodies).
+    bool stripUntypedMethodBodies = false;
+    // Statically resolve conditional jumps on literal conditions in the CFG builder and drop the
+    // untaken regions before inference. Suppresses unreachable-code diagnostics inside pruned
+    // regions, so it is opt-in (--prune-dead-cfg-branches).
+    bool pruneDeadCfgBranches = false;
+    // Free each file's AST (and the arena backing it) as soon as it finishes typechecking instead
+    // of keeping every tree alive until the end of the run. Nothing in the CLI pipeline revisits
+    // tree contents after inference, so this only lowers peak RSS.
+    bool dropTypecheckedTrees = false;
+    // Maximum number of indexed trees the language server keeps resident; 0 means unlimited.
+    // Trees over the budget are evicted least-recently-used and re-indexed on next access.
+    int lspTreeCacheSize = 0;
+    // Per-file wall-clock budget for computing suggested sigs (--sig-suggestion-budget-ms);
+    // 0 means unlimited.
+    int sigSuggestionBudgetMs = 0;
     bool suggestRuntimeProfiledType = false;
     bool censorForSnapshotTests = false;
     int threads = 0;
     int logLevel = 0; // number of time -v was passed
     int autogenVersion = 0;
+    bool autogenMsgpackSharded = false;
+    // When nonzero, print the N slowest files per phase after the run (--timing-report).
+    int timingReport = 0;
+    // Daemon mode: path of the unix socket to serve on (--daemon) or connect to (--daemon-client).
+    std::string daemonSocketPath;
+    std::string daemonClientSocketPath;
     bool stripeMode = false;
     std::string typedSource = "";
     std::string cacheDir = "";
+    // Shared directory (typically a LAN mount) used as a second cache tier behind cacheDir
+    // (--cache-dir-remote).
+    std::string cacheRemoteDir = "";
+    // One-shot overlay: entries from this cache database (typically an artifact published by a
+    // warm-up run at the workspace's merge-base commit) are imported into cacheDir at startup
+    // (--cache-import).
+    std::string cacheImportDir = "";
     std::vector<std::string> configatronDirs;
     std::vector<std::string> configatronFiles;
     UnorderedMap<std::string, core::StrictLevel> strictnessOverrides;
     UnorderedMap<std::string, std::string> dslPluginTriggers;
     std::vector<std::string> dslRubyExtraArgs;
+    // Run DSL plugin commands as long-lived worker processes (--dsl-plugins-persistent).
+    bool dslPluginsPersistent = false;
     std::string storeState = "";
+    // Distributed typechecking: serialize the post-resolve GlobalState to this file so other
+    // machines can pick up typechecking without repeating index and resolve
+    // (--store-resolved-state).
+    std::string storeResolvedState = "";
+    // Load a GlobalState written by --store-resolved-state instead of indexing and resolving; its
+    // file table supplies the inputs, so no input paths are needed (--load-resolved-state).
+    std::string loadResolvedState = "";
+    // Only typecheck files whose id modulo typecheckShardCount equals typecheckShardIndex
+    // (--typecheck-shard INDEX/COUNT). Zero count disables sharding.
+    u4 typecheckShardIndex = 0;
+    u4 typecheckShardCount = 0;
+    // Persist a per-file constant dependency graph (file path -> referenced symbols) into the
+    // cache after constant resolution (--store-dependency-graph). Requires --cache-dir.
+    bool storeDependencyGraph = false;
     bool enableCounters = false;
     std::vector<std::string> someCounters;
     std::string errorUrlBase = "https://srb.help/";
@@ -165,6 +232,12 @@ struct Options {
     std::string pathPrefix;
 
     u4 reserveMemKiB = 0;
+    // Prefault the preallocated symbol and name tables at startup so namer and resolver do not take
+    // page faults on them (--prefault-tables). Large-page advice is applied regardless.
+    bool prefaultTables = false;
+    // When nonzero, widen unions that grow beyond this many arms to a coarser upper bound
+    // (--widen-unions-above).
+    int widenUnionsAbove = 0;
 
     std::string statsdHost;
     std::string statsdPrefix = "ruby_typer.unknown";
@@ -195,6 +268,9 @@ struct Options {
     // List of directories not available editor-side. References to files in these directories should be sent via
     // sorbet: URIs to clients that support them.
     std::vector<std::string> lspDirsMissingFromClient;
+    // Estimated memory budget for the LSP edit history's retained index results
+    // (--lsp-history-memory-kb). 0 disables the budget.
+    u4 lspHistoryMemoryKiB = 65536;
     // Booleans enabling various experimental LSP features. Each will be removed once corresponding feature stabilizes.
     bool lspAutocompleteEnabled = false;
     bool lspAutocompleteMethodsEnabled = false;
@@ -203,10 +279,22 @@ struct Options {
     bool lspDocumentSymbolEnabled = false;
     bool lspSignatureHelpEnabled = false;
     bool lspHoverEnabled = false;
+    // Scope slow-path typechecking to the dependency closure of the edited files instead of the
+    // whole workspace. Not part of enable-all-experimental-lsp-features: files outside the closure
+    // keep their previous diagnostics rather than being rechecked.
+    bool lspScopedTypecheckEnabled = false;
 
     std::string inlineInput; // passed via -e
     std::string debugLogFile;
     std::string webTraceFile;
+    // When set, --web-trace-file is written as fixed-size binary records via mmap instead of JSON
+    // (see Tracing::storeTracesBinary); convert offline with --web-trace-convert.
+    bool webTraceBinary = false;
+    // Path to a binary trace file to convert to Chrome trace JSON on stdout, then exit.
+    std::string webTraceConvert;
+    // When set, the SIGPROF sampling profiler runs for the whole invocation and writes
+    // collapsed-stack output here on exit.
+    std::string profileFlamegraphFile;
 
     std::shared_ptr<FileSystem> fs = std::make_shared<OSFileSystem>();
 
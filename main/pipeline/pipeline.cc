@@ -12,25 +12,34 @@
 #include "ProgressIndicator.h"
 #include "absl/strings/escaping.h" // BytesToHexString
 #include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "ast/Arena.h"
 #include "ast/Helpers.h"
 #include "ast/desugar/Desugar.h"
 #include "ast/substitute/substitute.h"
 #include "ast/treemap/treemap.h"
 #include "cfg/CFG.h"
 #include "cfg/builder/builder.h"
+#include "cfg/serialize/serialize.h"
 #include "common/FileOps.h"
+#include "common/Profiler.h"
 #include "common/Timer.h"
 #include "common/concurrency/ConcurrentQueue.h"
 #include "common/crypto_hashing/crypto_hashing.h"
 #include "common/formatting.h"
+#include "common/os/os.h"
 #include "common/sort.h"
 #include "core/ErrorQueue.h"
 #include "core/GlobalSubstitution.h"
+#include "core/Hashing.h"
 #include "core/Unfreeze.h"
 #include "core/errors/parser.h"
 #include "core/serialize/serialize.h"
 #include "definition_validator/validator.h"
 #include "flattener/flatten.h"
+#include "infer/SigSuggestion.h"
 #include "infer/infer.h"
 #include "local_vars/local_vars.h"
 #include "main/pipeline/semantic_extension/SemanticExtension.h"
@@ -40,48 +49,127 @@
 #include "resolver/resolver.h"
 #include "rewriter/rewriter.h"
 
+#include <optional>
+
 using namespace std;
 
 namespace sorbet::realmain::pipeline {
 
+// Per-worker batches for semantic extensions, aligned by index with GlobalState::semanticExtensions
+// (entries are null for extensions that opted out of batching). See SemanticExtension.h.
+using ExtensionBatches = std::vector<std::unique_ptr<sorbet::pipeline::semantic_extension::TypecheckBatch>>;
+
 class CFGCollectorAndTyper {
     const options::Options &opts;
+    cfg::CFGScratch &cfgScratch;
+    ExtensionBatches *extensionBatches;
+    // Reader over this file's cached pre-inference CFGs; disengaged when there is no usable cache
+    // entry. Entries are read strictly in method order — the walk visits methods in the same order
+    // the entry was recorded in, because both runs walk the identical tree.
+    std::optional<core::serialize::UnPickler> cachedCfgs;
+    u4 cachedRemaining = 0;
+    // Bounds the time this file may spend computing suggested sigs; disengaged when no budget is
+    // configured (--sig-suggestion-budget-ms). One instance per file so the budget spans all of
+    // the file's methods.
+    std::optional<infer::SigSuggestionBudget> suggestionBudget;
+    // Accumulates this file's freshly built CFGs when recording a new cache entry.
+    core::serialize::Pickler cfgOut;
+    size_t cfgOutCountOffset = 0;
+    u4 recorded = 0;
+    bool record = false;
 
 public:
-    CFGCollectorAndTyper(const options::Options &opts) : opts(opts){};
+    // Bump whenever the cfg/serialize format or this container's layout changes shape.
+    static constexpr u4 CFG_CACHE_VERSION = 1;
+
+    CFGCollectorAndTyper(const options::Options &opts, cfg::CFGScratch &cfgScratch, const core::GlobalState &gs,
+                         const u1 *cachedBlob, bool record, ExtensionBatches *extensionBatches)
+        : opts(opts), cfgScratch(cfgScratch), extensionBatches(extensionBatches), record(record) {
+        if (cachedBlob != nullptr) {
+            core::serialize::UnPickler reader(cachedBlob, gs.tracer());
+            if (reader.getU4() == CFG_CACHE_VERSION) {
+                cachedRemaining = reader.getRawU4();
+                cachedCfgs.emplace(move(reader));
+            }
+        }
+        if (record) {
+            cfgOut.putU4(CFG_CACHE_VERSION);
+            cfgOutCountOffset = cfgOut.putRawU4(0);
+        }
+        if (gs.sigSuggestionBudgetMs > 0) {
+            suggestionBudget.emplace(gs.sigSuggestionBudgetMs);
+        }
+    }
+
+    // True when at least one suggested sig was skipped because this file's budget ran out.
+    bool sigSuggestionsDeferred() const {
+        return suggestionBudget.has_value() && suggestionBudget->anyDeferred();
+    }
+
+    // The finished cache entry for this file. Only meaningful when recording was requested.
+    vector<u1> releaseCacheEntry() {
+        ENFORCE(record);
+        cfgOut.patchRawU4(cfgOutCountOffset, recorded);
+        return cfgOut.result(core::serialize::Serializer::CACHED_TREE_COMPRESSION_DEGREE);
+    }
 
     unique_ptr<ast::MethodDef> preTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> m) {
         if (m->loc.file().data(ctx).strictLevel < core::StrictLevel::True || m->symbol.data(ctx)->isOverloaded()) {
             return m;
         }
         auto &print = opts.print;
-        auto cfg = cfg::CFGBuilder::buildFor(ctx.withOwner(m->symbol), *m);
+        unique_ptr<cfg::CFG> cfg;
+        if (cachedRemaining > 0) {
+            cachedRemaining--;
+            if (cachedCfgs->getU4() == m->symbol._id) {
+                cfg = cfg::CFGSerializer::unpickle(*cachedCfgs, ctx.state, m->loc.file());
+                prodCounterInc("types.input.cfgs.kvstore.hit");
+            } else {
+                // The entry was recorded under different options (e.g. a --typed override changed
+                // which methods get CFGs). The reader is now mid-entry, so stop trusting it and
+                // build the rest of the file from scratch.
+                cachedRemaining = 0;
+                prodCounterInc("types.input.cfgs.kvstore.mismatch");
+            }
+        }
+        if (cfg == nullptr) {
+            cfg = cfg::CFGBuilder::buildFor(ctx.withOwner(m->symbol), *m, cfgScratch);
+            if (record) {
+                // Must happen before inference: the pickle format only represents pre-inference
+                // CFGs (no types, no dispatch results).
+                cfgOut.putU4(m->symbol._id);
+                cfg::CFGSerializer::pickle(cfgOut, ctx.state, *cfg);
+                recorded++;
+            }
+        }
 
         if (opts.stopAfterPhase == options::Phase::CFG) {
             return m;
         }
-        cfg = infer::Inference::run(ctx.withOwner(cfg->symbol), move(cfg));
+        cfg = infer::Inference::run(ctx.withOwner(cfg->symbol), move(cfg),
+                                    suggestionBudget.has_value() ? &*suggestionBudget : nullptr);
         if (cfg) {
-            for (auto &extension : ctx.state.semanticExtensions) {
-                extension->typecheck(ctx.state, *cfg, m);
+            for (size_t i = 0; i < ctx.state.semanticExtensions.size(); i++) {
+                auto *batch = extensionBatches != nullptr ? (*extensionBatches)[i].get() : nullptr;
+                ctx.state.semanticExtensions[i]->typecheck(ctx.state, *cfg, m, batch);
             }
         }
         if (print.CFG.enabled) {
-            print.CFG.fmt("{}\n\n", cfg->toString(ctx));
+            print.CFG.fmtForFile(m->loc.file().id(), "{}\n\n", cfg->toString(ctx));
         }
         if (print.CFGRaw.enabled) {
-            print.CFGRaw.fmt("{}\n\n", cfg->showRaw(ctx));
+            print.CFGRaw.fmtForFile(m->loc.file().id(), "{}\n\n", cfg->showRaw(ctx));
         }
 #ifndef SORBET_REALMAIN_MIN
         if ((print.CFGJson.enabled || print.CFGProto.enabled) && cfg->shouldExport(ctx.state)) {
             auto proto = cfg::Proto::toProto(ctx.state, *cfg);
             if (print.CFGJson.enabled) {
                 string buf = core::Proto::toJSON(proto);
-                print.CFGJson.print(buf);
+                print.CFGJson.printForFile(m->loc.file().id(), buf);
             } else {
                 // The proto wire format allows simply concatenating repeated message fields
                 string buf = cfg::Proto::toMulti(proto).SerializeAsString();
-                print.CFGProto.print(buf);
+                print.CFGProto.printForFile(m->loc.file().id(), buf);
             }
         }
 #endif
@@ -89,19 +177,35 @@ public:
     }
 };
 
-string fileKey(core::GlobalState &gs, core::FileRef file) {
-    auto path = file.data(gs).path();
+string fileKey(string_view path, string_view source) {
     string key(path.begin(), path.end());
     key += "//";
-    auto hashBytes = sorbet::crypto_hashing::hash64(file.data(gs).source());
+    auto hashBytes = sorbet::crypto_hashing::hash64(source);
     key += absl::BytesToHexString(string_view{(char *)hashBytes.data(), size(hashBytes)});
     return key;
 }
 
+string fileKey(const core::GlobalState &gs, core::FileRef file) {
+    return fileKey(file.data(gs).path(), file.data(gs).source());
+}
+
+// Cached trees are keyed by content alone, with no path component: the pickled tree is rebound to
+// the loading file by Serializer::loadExpression, and the name ids inside a blob resolve against
+// the name table persisted alongside the cache (payload::retainGlobalState), which the path never
+// influences. Byte-identical files — common in RBI payloads, where the same gem RBI recurs across
+// gem versions — therefore share a single cache entry regardless of where they live.
+string treeKey(string_view source) {
+    auto hashBytes = sorbet::crypto_hashing::hash64(source);
+    return absl::StrCat("Tree//", absl::BytesToHexString(string_view{(char *)hashBytes.data(), size(hashBytes)}));
+}
+
 unique_ptr<ast::Expression> fetchTreeFromCache(core::GlobalState &gs, core::FileRef file,
                                                const unique_ptr<KeyValueStore> &kvstore) {
-    if (kvstore && file.id() < gs.filesUsed()) {
-        string fileHashKey = fileKey(gs, file);
+    // Ignore-level files index to an empty tree no matter their contents. Since the strictness
+    // override that forces a file to Ignore is keyed by path, it must not share cache entries with
+    // byte-identical files elsewhere; skipping the cache entirely keeps both directions honest.
+    if (kvstore && file.id() < gs.filesUsed() && file.data(gs).strictLevel != core::StrictLevel::Ignore) {
+        string fileHashKey = treeKey(file.data(gs).source());
         auto maybeCached = kvstore->read(fileHashKey);
         if (maybeCached) {
             prodCounterInc("types.input.files.kvstore.hit");
@@ -120,37 +224,46 @@ void cacheTrees(core::GlobalState &gs, unique_ptr<KeyValueStore> &kvstore, vecto
     if (!kvstore) {
         return;
     }
+    // Content-addressed keys make duplicate contents collapse to one entry; skip re-pickling a
+    // blob another tree in this batch has already produced.
+    UnorderedSet<string> written;
     for (auto &tree : trees) {
-        if (tree.file.data(gs).cachedParseTree || tree.file.data(gs).hasParseErrors) {
+        auto &fileData = tree.file.data(gs);
+        if (fileData.cachedParseTree || fileData.hasParseErrors ||
+            fileData.strictLevel == core::StrictLevel::Ignore) {
+            continue;
+        }
+        string fileHashKey = treeKey(fileData.source());
+        if (!written.insert(fileHashKey).second) {
+            prodCounterInc("types.input.files.kvstore.deduped_write");
             continue;
         }
-        string fileHashKey = fileKey(gs, tree.file);
         kvstore->write(fileHashKey, core::serialize::Serializer::storeExpression(gs, tree.tree));
     }
 }
 
 unique_ptr<parser::Node> runParser(core::GlobalState &gs, core::FileRef file, const options::Printers &print) {
-    Timer timeit(gs.tracer(), "runParser", {{"file", (string)file.data(gs).path()}});
+    Timer timeit(gs.tracer(), "runParser", {{"file", internDynamicName(file.data(gs).path())}});
     unique_ptr<parser::Node> nodes;
     {
         core::UnfreezeNameTable nameTableAccess(gs); // enters strings from source code as names
         nodes = parser::Parser::run(gs, file);
     }
     if (print.ParseTree.enabled) {
-        print.ParseTree.fmt("{}\n", nodes->toStringWithTabs(gs, 0));
+        print.ParseTree.fmtForFile(file.id(), "{}\n", nodes->toStringWithTabs(gs, 0));
     }
     if (print.ParseTreeJson.enabled) {
-        print.ParseTreeJson.fmt("{}\n", nodes->toJSON(gs, 0));
+        print.ParseTreeJson.fmtForFile(file.id(), "{}\n", nodes->toJSON(gs, 0));
     }
     if (print.ParseTreeWhitequark.enabled) {
-        print.ParseTreeWhitequark.fmt("{}\n", nodes->toWhitequark(gs, 0));
+        print.ParseTreeWhitequark.fmtForFile(file.id(), "{}\n", nodes->toWhitequark(gs, 0));
     }
     return nodes;
 }
 
 unique_ptr<ast::Expression> runDesugar(core::GlobalState &gs, core::FileRef file, unique_ptr<parser::Node> parseTree,
                                        const options::Printers &print) {
-    Timer timeit(gs.tracer(), "runDesugar", {{"file", (string)file.data(gs).path()}});
+    Timer timeit(gs.tracer(), "runDesugar", {{"file", internDynamicName(file.data(gs).path())}});
     unique_ptr<ast::Expression> ast;
     core::MutableContext ctx(gs, core::Symbols::root());
     {
@@ -159,25 +272,53 @@ unique_ptr<ast::Expression> runDesugar(core::GlobalState &gs, core::FileRef file
         ast = ast::desugar::node2Tree(ctx, move(parseTree));
     }
     if (print.DesugarTree.enabled) {
-        print.DesugarTree.fmt("{}\n", ast->toStringWithTabs(gs, 0));
+        print.DesugarTree.fmtForFile(file.id(), "{}\n", ast->toStringWithTabs(gs, 0));
     }
     if (print.DesugarTreeRaw.enabled) {
-        print.DesugarTreeRaw.fmt("{}\n", ast->showRaw(gs));
+        print.DesugarTreeRaw.fmtForFile(file.id(), "{}\n", ast->showRaw(gs));
     }
     return ast;
 }
 
-unique_ptr<ast::Expression> runRewriter(core::GlobalState &gs, core::FileRef file, unique_ptr<ast::Expression> ast) {
+unique_ptr<ast::Expression> runRewriter(core::GlobalState &gs, core::FileRef file, unique_ptr<ast::Expression> ast,
+                                        bool runFlatten = true) {
     core::MutableContext ctx(gs, core::Symbols::root());
-    Timer timeit(gs.tracer(), "runRewriter", {{"file", (string)file.data(gs).path()}});
+    Timer timeit(gs.tracer(), "runRewriter", {{"file", internDynamicName(file.data(gs).path())}});
     core::UnfreezeNameTable nameTableAccess(gs); // creates temporaries during desugaring
     core::ErrorRegion errs(gs, file);
-    return rewriter::Rewriter::run(ctx, move(ast));
+    return rewriter::Rewriter::run(ctx, move(ast), runFlatten);
+}
+
+// Outline indexing for files below `typed: true` (--strip-untyped-method-bodies): their method
+// bodies are never type-checked, and the rewriter's flatten step has already hoisted any nested
+// definitions to class scope, so dropping the bodies here spares local_vars, namer and resolver
+// the walk. Constant resolution errors inside the dropped bodies are silenced too, which
+// `# typed: false` otherwise reports; hence the flag.
+class MethodBodyDropper {
+public:
+    unique_ptr<ast::MethodDef> postTransformMethodDef(core::MutableContext ctx, unique_ptr<ast::MethodDef> original) {
+        if (!ast::isa_tree<ast::EmptyTree>(original->rhs.get())) {
+            original->rhs = ast::MK::EmptyTree();
+            prodCounterInc("types.input.method_bodies.stripped");
+        }
+        return original;
+    }
+};
+
+unique_ptr<ast::Expression> stripMethodBodies(core::GlobalState &gs, core::FileRef file,
+                                              unique_ptr<ast::Expression> tree) {
+    Timer timeit(gs.tracer(), "stripMethodBodies", {{"file", internDynamicName(file.data(gs).path())}});
+    MethodBodyDropper dropper;
+    core::MutableContext ctx(gs, core::Symbols::root());
+    return ast::TreeMap::apply(ctx, dropper, move(tree));
 }
 
-ast::ParsedFile runLocalVars(core::GlobalState &gs, ast::ParsedFile tree) {
-    Timer timeit(gs.tracer(), "runLocalVars", {{"file", (string)tree.file.data(gs).path()}});
+ast::ParsedFile runLocalVars(core::GlobalState &gs, ast::ParsedFile tree, bool withFlatten = false) {
+    Timer timeit(gs.tracer(), "runLocalVars", {{"file", internDynamicName(tree.file.data(gs).path())}});
     core::MutableContext ctx(gs, core::Symbols::root());
+    if (withFlatten) {
+        return sorbet::local_vars::LocalVars::runWithFlatten(ctx, move(tree));
+    }
     return sorbet::local_vars::LocalVars::run(ctx, move(tree));
 }
 
@@ -185,6 +326,54 @@ ast::ParsedFile emptyParsedFile(core::FileRef file) {
     return {ast::MK::EmptyTree(), file};
 }
 
+// For use under an Arena::Guard: the EmptyTree node is allocated in the caller's arena, so the
+// returned file has to keep that arena alive.
+ast::ParsedFile emptyParsedFile(shared_ptr<ast::Arena> arena, core::FileRef file) {
+    return {move(arena), ast::MK::EmptyTree(), file};
+}
+
+namespace {
+// Per-FileRef wall times recorded when --timing-report is enabled. Workers append under the mutex;
+// printTimingReport drains it on the main thread once the run is complete.
+struct FileTimingLedger {
+    absl::Mutex mtx;
+    // phase name -> file id -> accumulated microseconds
+    UnorderedMap<std::string, UnorderedMap<u4, int64_t>> timings;
+};
+
+FileTimingLedger &fileTimingLedger() {
+    static FileTimingLedger ledger;
+    return ledger;
+}
+
+// Records the wall time one phase spends on one file into the ledger. A no-op unless
+// --timing-report was passed.
+class FileTimingRecorder {
+    const options::Options &opts;
+    const char *phase;
+    core::FileRef file;
+    const std::chrono::time_point<std::chrono::steady_clock> start;
+
+public:
+    FileTimingRecorder(const options::Options &opts, const char *phase, core::FileRef file)
+        : opts(opts), phase(phase), file(file), start(std::chrono::steady_clock::now()) {}
+
+    ~FileTimingRecorder() {
+        if (opts.timingReport == 0) {
+            return;
+        }
+        auto usec =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        auto &ledger = fileTimingLedger();
+        absl::MutexLock lock(&ledger.mtx);
+        ledger.timings[phase][file.id()] += usec;
+    }
+
+    FileTimingRecorder(const FileTimingRecorder &) = delete;
+    FileTimingRecorder(FileTimingRecorder &&) = delete;
+};
+} // namespace
+
 ast::ParsedFile indexOne(const options::Options &opts, core::GlobalState &lgs, core::FileRef file,
                          unique_ptr<KeyValueStore> &kvstore) {
     auto &print = opts.print;
@@ -192,38 +381,62 @@ ast::ParsedFile indexOne(const options::Options &opts, core::GlobalState &lgs, c
     ENFORCE(file.data(lgs).strictLevel == decideStrictLevel(lgs, file, opts));
 
     Timer timeit(lgs.tracer(), "indexOne");
+    ProfilerTag profilerTag("index", file.id());
+    FileTimingRecorder fileTiming(opts, "index", file);
+    // All nodes built for this file (parse-from-source and cache-unpickle alike) go into one arena
+    // that travels with the ParsedFile and is freed in one shot when the tree is dropped.
+    auto arena = make_shared<ast::Arena>();
+    ast::Arena::Guard arenaGuard(arena.get());
+    rewriten.arena = arena;
     try {
         unique_ptr<ast::Expression> tree = fetchTreeFromCache(lgs, file, kvstore);
 
         if (!tree) {
             // tree isn't cached. Need to start from parser
             if (file.data(lgs).strictLevel == core::StrictLevel::Ignore) {
-                return emptyParsedFile(file);
+                return emptyParsedFile(arena, file);
+            }
+            // Parse nodes go into their own arena, dropped wholesale once desugar has consumed the
+            // parse tree. The guard is scoped to the parse so that desugar's Expression nodes keep
+            // landing in the ParsedFile's arena.
+            parser::NodeArena parseArena;
+            unique_ptr<parser::Node> parseTree;
+            {
+                parser::NodeArena::Guard parseGuard(&parseArena);
+                parseTree = runParser(lgs, file, print);
             }
-            auto parseTree = runParser(lgs, file, print);
             if (opts.stopAfterPhase == options::Phase::PARSER) {
-                return emptyParsedFile(file);
+                return emptyParsedFile(arena, file);
             }
             tree = runDesugar(lgs, file, move(parseTree), print);
             if (opts.stopAfterPhase == options::Phase::DESUGARER) {
-                return emptyParsedFile(file);
+                return emptyParsedFile(arena, file);
             }
+            const bool stripBodies =
+                opts.stripUntypedMethodBodies && file.data(lgs).strictLevel < core::StrictLevel::True;
+            // Stripping relies on the flattening walk having hoisted nested definitions out of the
+            // bodies it drops, so the outline path keeps the split passes; everything else fuses
+            // flattening into the local_vars walk and saves a full traversal per file.
+            const bool fuseFlatten = !opts.skipRewriterPasses && !stripBodies;
             if (!opts.skipRewriterPasses) {
-                tree = runRewriter(lgs, file, move(tree));
+                tree = runRewriter(lgs, file, move(tree), /* runFlatten */ !fuseFlatten);
             }
-            tree = runLocalVars(lgs, ast::ParsedFile{move(tree), file}).tree;
+            if (stripBodies) {
+                tree = stripMethodBodies(lgs, file, move(tree));
+            }
+            tree = runLocalVars(lgs, ast::ParsedFile{move(tree), file}, fuseFlatten).tree;
             if (opts.stopAfterPhase == options::Phase::LOCAL_VARS) {
-                return emptyParsedFile(file);
+                return emptyParsedFile(arena, file);
             }
         }
         if (print.RewriterTree.enabled) {
-            print.RewriterTree.fmt("{}\n", tree->toStringWithTabs(lgs, 0));
+            print.RewriterTree.fmtForFile(file.id(), "{}\n", tree->toStringWithTabs(lgs, 0));
         }
         if (print.RewriterTreeRaw.enabled) {
-            print.RewriterTreeRaw.fmt("{}\n", tree->showRaw(lgs));
+            print.RewriterTreeRaw.fmtForFile(file.id(), "{}\n", tree->showRaw(lgs));
         }
         if (opts.stopAfterPhase == options::Phase::REWRITER) {
-            return emptyParsedFile(file);
+            return emptyParsedFile(arena, file);
         }
 
         rewriten.tree = move(tree);
@@ -233,7 +446,7 @@ ast::ParsedFile indexOne(const options::Options &opts, core::GlobalState &lgs, c
         if (auto e = lgs.beginError(sorbet::core::Loc::none(file), core::errors::Internal::InternalError)) {
             e.setHeader("Exception parsing file: `{}` (backtrace is above)", file.data(lgs).path());
         }
-        return emptyParsedFile(file);
+        return emptyParsedFile(arena, file);
     }
 }
 
@@ -241,6 +454,11 @@ pair<ast::ParsedFile, vector<shared_ptr<core::File>>> emptyPluginFile(core::File
     return {emptyParsedFile(file), vector<shared_ptr<core::File>>()};
 }
 
+pair<ast::ParsedFile, vector<shared_ptr<core::File>>> emptyPluginFile(shared_ptr<ast::Arena> arena,
+                                                                      core::FileRef file) {
+    return {emptyParsedFile(move(arena), file), vector<shared_ptr<core::File>>()};
+}
+
 pair<ast::ParsedFile, vector<shared_ptr<core::File>>> indexOneWithPlugins(const options::Options &opts,
                                                                           core::GlobalState &gs, core::FileRef file,
                                                                           unique_ptr<KeyValueStore> &kvstore) {
@@ -248,22 +466,30 @@ pair<ast::ParsedFile, vector<shared_ptr<core::File>>> indexOneWithPlugins(const
     ast::ParsedFile rewriten{nullptr, file};
     vector<shared_ptr<core::File>> resultPluginFiles;
 
-    Timer timeit(gs.tracer(), "indexOneWithPlugins", {{"file", (string)file.data(gs).path()}});
+    Timer timeit(gs.tracer(), "indexOneWithPlugins", {{"file", internDynamicName(file.data(gs).path())}});
+    auto arena = make_shared<ast::Arena>();
+    ast::Arena::Guard arenaGuard(arena.get());
+    rewriten.arena = arena;
     try {
         unique_ptr<ast::Expression> tree = fetchTreeFromCache(gs, file, kvstore);
 
         if (!tree) {
             // tree isn't cached. Need to start from parser
             if (file.data(gs).strictLevel == core::StrictLevel::Ignore) {
-                return emptyPluginFile(file);
+                return emptyPluginFile(arena, file);
+            }
+            parser::NodeArena parseArena;
+            unique_ptr<parser::Node> parseTree;
+            {
+                parser::NodeArena::Guard parseGuard(&parseArena);
+                parseTree = runParser(gs, file, print);
             }
-            auto parseTree = runParser(gs, file, print);
             if (opts.stopAfterPhase == options::Phase::PARSER) {
-                return emptyPluginFile(file);
+                return emptyPluginFile(arena, file);
             }
             tree = runDesugar(gs, file, move(parseTree), print);
             if (opts.stopAfterPhase == options::Phase::DESUGARER) {
-                return emptyPluginFile(file);
+                return emptyPluginFile(arena, file);
             }
 
 #ifndef SORBET_REALMAIN_MIN
@@ -277,29 +503,34 @@ pair<ast::ParsedFile, vector<shared_ptr<core::File>>> indexOneWithPlugins(const
                 resultPluginFiles = move(pluginFiles);
             }
 #endif
+            // The rewriter-phase prints here show the tree before local_vars, so fusing the
+            // flattening walk into local_vars would change their output; keep the split passes
+            // when they are enabled.
+            const bool fuseFlatten =
+                !opts.skipRewriterPasses && !print.RewriterTree.enabled && !print.RewriterTreeRaw.enabled;
             if (!opts.skipRewriterPasses) {
-                tree = runRewriter(gs, file, move(tree));
+                tree = runRewriter(gs, file, move(tree), /* runFlatten */ !fuseFlatten);
             }
             if (print.RewriterTree.enabled) {
-                print.RewriterTree.fmt("{}\n", tree->toStringWithTabs(gs, 0));
+                print.RewriterTree.fmtForFile(file.id(), "{}\n", tree->toStringWithTabs(gs, 0));
             }
             if (print.RewriterTreeRaw.enabled) {
-                print.RewriterTreeRaw.fmt("{}\n", tree->showRaw(gs));
+                print.RewriterTreeRaw.fmtForFile(file.id(), "{}\n", tree->showRaw(gs));
             }
 
-            tree = runLocalVars(gs, ast::ParsedFile{move(tree), file}).tree;
+            tree = runLocalVars(gs, ast::ParsedFile{move(tree), file}, fuseFlatten).tree;
             if (opts.stopAfterPhase == options::Phase::LOCAL_VARS) {
-                return emptyPluginFile(file);
+                return emptyPluginFile(arena, file);
             }
         }
         if (print.IndexTree.enabled) {
-            print.IndexTree.fmt("{}\n", tree->toStringWithTabs(gs, 0));
+            print.IndexTree.fmtForFile(file.id(), "{}\n", tree->toStringWithTabs(gs, 0));
         }
         if (print.IndexTreeRaw.enabled) {
-            print.IndexTreeRaw.fmt("{}\n", tree->showRaw(gs));
+            print.IndexTreeRaw.fmtForFile(file.id(), "{}\n", tree->showRaw(gs));
         }
         if (opts.stopAfterPhase == options::Phase::REWRITER) {
-            return emptyPluginFile(file);
+            return emptyPluginFile(arena, file);
         }
 
         rewriten.tree = move(tree);
@@ -309,14 +540,16 @@ pair<ast::ParsedFile, vector<shared_ptr<core::File>>> indexOneWithPlugins(const
         if (auto e = gs.beginError(sorbet::core::Loc::none(file), core::errors::Internal::InternalError)) {
             e.setHeader("Exception parsing file: `{}` (backtrace is above)", file.data(gs).path());
         }
-        return emptyPluginFile(file);
+        return emptyPluginFile(arena, file);
     }
 }
 
 vector<ast::ParsedFile> incrementalResolve(core::GlobalState &gs, vector<ast::ParsedFile> what,
-                                           const options::Options &opts) {
+                                           const options::Options &opts, WorkerPool &workers,
+                                           bool containsNewDefinitions) {
     try {
         core::MutableContext ctx(gs, core::Symbols::root());
+        auto firstNewSymbol = gs.symbolsUsed();
         {
             Timer timeit(gs.tracer(), "incremental_naming");
             core::UnfreezeSymbolTable symbolTable(gs);
@@ -332,7 +565,12 @@ vector<ast::ParsedFile> incrementalResolve(core::GlobalState &gs, vector<ast::Pa
             core::UnfreezeSymbolTable symbolTable(gs);
             core::UnfreezeNameTable nameTable(gs);
 
-            what = sorbet::resolver::Resolver::runTreePasses(ctx, move(what));
+            if (containsNewDefinitions) {
+                what = sorbet::resolver::Resolver::runTreePassesWithNewDefinitions(ctx, move(what), workers,
+                                                                                   firstNewSymbol);
+            } else {
+                what = sorbet::resolver::Resolver::runTreePasses(ctx, move(what), workers);
+            }
         }
     } catch (SorbetException &) {
         if (auto e = gs.beginError(sorbet::core::Loc::none(), sorbet::core::errors::Internal::InternalError)) {
@@ -439,7 +677,7 @@ void readFileWithStrictnessOverrides(unique_ptr<core::GlobalState> &gs, core::Fi
         return;
     }
     auto fileName = file.dataAllowingUnsafe(*gs).path();
-    Timer timeit(gs->tracer(), "readFileWithStrictnessOverrides", {{"file", (string)fileName}});
+    Timer timeit(gs->tracer(), "readFileWithStrictnessOverrides", {{"file", internDynamicName(fileName)}});
     string src;
     bool fileFound = true;
     try {
@@ -453,6 +691,15 @@ void readFileWithStrictnessOverrides(unique_ptr<core::GlobalState> &gs, core::Fi
     prodCounterAdd("types.input.bytes", src.size());
     prodCounterInc("types.input.files");
 
+    auto evictedHash = file.dataAllowingUnsafe(*gs).evictedSourceHash;
+    if (fileFound && evictedHash != 0 && core::_hash(src) != evictedHash) {
+        // The file changed on disk while its source text was evicted. The fresh contents flow
+        // through indexing as usual (the tree cache keys on path + source, so nothing stale is
+        // reused); this just makes the surprise observable.
+        prodCounterInc("types.input.evicted_reload_mismatch");
+        gs->tracer().debug("Evicted source for {} changed on disk before reload", fileName);
+    }
+
     {
         core::UnfreezeFileTable unfreezeFiles(*gs);
         auto entered = gs->enterNewFileAt(
@@ -490,13 +737,92 @@ struct IndexThreadResultPack {
     IndexResult res;
 };
 
+// Below this many trees, the queue setup and worker wakeups cost more than the substitution walks
+// themselves; small merges (LSP edits, plugin passes) run inline.
+constexpr size_t INLINE_SUBSTITUTE_THRESHOLD = 16;
+
+// The substitution walks are pointer-chasing and memory-bound, and --timing-report ledgers show
+// the phase's scaling flattening well before typecheck's does. Fanning out wider than this just
+// adds memory-bus contention, so the rest of the pool stays parked.
+constexpr int SUBSTITUTE_CONCURRENCY_KNEE = 16;
+
+// Applies already-built substitution tables to the trees, fanning the per-file walks out over the
+// worker pool. Building a GlobalSubstitution mutates the target GlobalState's name table and must
+// stay on one thread; applying one only reads the table and the name table, so the walks are
+// embarrassingly parallel per file. `substPerTree` supplies each tree's table, or nullptr for
+// trees that need no substitution (e.g. trees unpickled from the cache, whose names are already
+// canonical). Workers mutate disjoint vector slots in place.
+void substituteTrees(core::GlobalState &gs, const vector<const core::GlobalSubstitution *> &substPerTree,
+                     vector<ast::ParsedFile> &trees, WorkerPool &workers) {
+    Timer timeit(gs.tracer(), "substituteTrees");
+    ENFORCE(substPerTree.size() == trees.size());
+    core::MutableContext ctx(gs, core::Symbols::root());
+    auto substituteOne = [&](int i) {
+        auto *substitution = substPerTree[i];
+        if (substitution == nullptr) {
+            return;
+        }
+        auto &tree = trees[i];
+        core::ErrorRegion errs(gs, tree.file);
+        // Replacement nodes built during the walk live in the tree's own arena.
+        ast::Arena::Guard arenaGuard(tree.arena.get());
+        tree.tree = ast::Substitute::run(ctx, *substitution, move(tree.tree));
+    };
+
+    if (trees.size() <= INLINE_SUBSTITUTE_THRESHOLD) {
+        for (int i = 0; i < trees.size(); i++) {
+            substituteOne(i);
+        }
+        return;
+    }
+
+    auto treeq = make_shared<ConcurrentBoundedQueue<int>>(trees.size());
+    for (int i = 0; i < trees.size(); i++) {
+        auto copy = i;
+        treeq->push(move(copy), 1);
+    }
+    auto doneq = make_shared<BlockingBoundedQueue<int>>(trees.size());
+    // One worker per INLINE_SUBSTITUTE_THRESHOLD trees keeps every runner busy below the knee.
+    auto concurrency = static_cast<int>(
+        min(trees.size() / INLINE_SUBSTITUTE_THRESHOLD, static_cast<size_t>(SUBSTITUTE_CONCURRENCY_KNEE)));
+    workers.multiplexJobBounded("substituteTrees", concurrency, [&substituteOne, treeq, doneq]() {
+        int processed = 0;
+        int job;
+        for (auto result = treeq->try_pop(job); !result.done(); result = treeq->try_pop(job)) {
+            if (result.gotItem()) {
+                processed++;
+                substituteOne(job);
+            }
+        }
+        if (processed > 0) {
+            doneq->push(move(processed), processed);
+        }
+    });
+
+    int processed;
+    int workersUsed = 0;
+    for (auto result = doneq->wait_pop_timed(processed, WorkerPool::BLOCK_INTERVAL(), gs.tracer()); !result.done();
+         result = doneq->wait_pop_timed(processed, WorkerPool::BLOCK_INTERVAL(), gs.tracer())) {
+        if (result.gotItem()) {
+            workersUsed++;
+        }
+    }
+    histogramInc("concurrency.substitute_trees.workers_offered", concurrency);
+    histogramInc("concurrency.substitute_trees.workers_used", workersUsed);
+}
+
 IndexResult mergeIndexResults(const shared_ptr<core::GlobalState> cgs, const options::Options &opts,
                               shared_ptr<BlockingBoundedQueue<IndexThreadResultPack>> input,
-                              unique_ptr<KeyValueStore> &kvstore) {
+                              unique_ptr<KeyValueStore> &kvstore, WorkerPool &workers) {
     ProgressIndicator progress(opts.showProgress, "Indexing", input->bound);
     Timer timeit(cgs->tracer(), "mergeIndexResults");
     IndexThreadResultPack threadResult;
     IndexResult ret;
+    // Substitution is deferred: merging a pack only builds its table (which mutates the merged
+    // GlobalState's name table and must stay on this thread) and records which trees it covers.
+    // Once every pack has arrived the read-only tables are applied over the worker pool.
+    vector<unique_ptr<core::GlobalSubstitution>> substitutions;
+    vector<const core::GlobalSubstitution *> substPerTree;
     for (auto result = input->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), cgs->tracer()); !result.done();
          result = input->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), cgs->tracer())) {
         if (result.gotItem()) {
@@ -506,21 +832,18 @@ IndexResult mergeIndexResults(const shared_ptr<core::GlobalState> cgs, const opt
                 ENFORCE(ret.trees.empty());
                 ret.trees = move(threadResult.res.trees);
                 ret.pluginGeneratedFiles = move(threadResult.res.pluginGeneratedFiles);
-                cacheTrees(*ret.gs, kvstore, ret.trees);
+                // The first pack's trees already speak the merged GlobalState's names.
+                substPerTree.resize(ret.trees.size(), nullptr);
             } else {
-                core::GlobalSubstitution substitution(*threadResult.res.gs, *ret.gs, cgs.get());
-                core::MutableContext ctx(*ret.gs, core::Symbols::root());
                 {
-                    Timer timeit(cgs->tracer(), "substituteTrees");
-                    for (auto &tree : threadResult.res.trees) {
-                        auto file = tree.file;
-                        core::ErrorRegion errs(*ret.gs, file);
-                        if (!file.data(*ret.gs).cachedParseTree) {
-                            tree.tree = ast::Substitute::run(ctx, substitution, move(tree.tree));
-                        }
-                    }
+                    Timer timeit(cgs->tracer(), "buildSubstitution");
+                    substitutions.emplace_back(
+                        make_unique<core::GlobalSubstitution>(*threadResult.res.gs, *ret.gs, cgs.get()));
+                }
+                auto *substitution = substitutions.back().get();
+                for (auto &tree : threadResult.res.trees) {
+                    substPerTree.emplace_back(tree.file.data(*ret.gs).cachedParseTree ? nullptr : substitution);
                 }
-                cacheTrees(*ret.gs, kvstore, threadResult.res.trees);
                 ret.trees.insert(ret.trees.end(), make_move_iterator(threadResult.res.trees.begin()),
                                  make_move_iterator(threadResult.res.trees.end()));
 
@@ -532,16 +855,83 @@ IndexResult mergeIndexResults(const shared_ptr<core::GlobalState> cgs, const opt
             ret.gs->errorQueue->flushErrors();
         }
     }
+    if (ret.gs != nullptr) {
+        substituteTrees(*ret.gs, substPerTree, ret.trees, workers);
+        cacheTrees(*ret.gs, kvstore, ret.trees);
+    }
     return ret;
 }
 
+// How many trees an indexing worker accumulates before streaming them to the merge thread. Each window is
+// pushed with its own GlobalState copy, so the merge thread can fold its names into the canonical GlobalState
+// while the worker keeps parsing, and only a bounded number of unmerged trees stay resident per worker. The
+// window is sized so that the extra deepCopies of the (mostly payload) base GlobalState stay in the noise.
+constexpr size_t INDEX_RESULT_WINDOW = 1000;
+
 IndexResult indexSuppliedFiles(const shared_ptr<core::GlobalState> &baseGs, vector<core::FileRef> &files,
                                const options::Options &opts, WorkerPool &workers, unique_ptr<KeyValueStore> &kvstore) {
     Timer timeit(baseGs->tracer(), "indexSuppliedFiles");
+
+    // Longest-processing-time-first scheduling: hand out the biggest files first so a giant
+    // generated model file (whose rewriter passes alone can run for seconds) starts at the front
+    // of the run instead of pinning one worker long after every other file has drained. Sizes are
+    // only known for sources already in memory — the LSP slow path and cached runs, where the
+    // stragglers hurt most; freshly reserved files all compare equal and keep their position.
+    auto sourceSize = [&baseGs](core::FileRef file) -> size_t {
+        if (file.id() >= baseGs->filesUsed()) {
+            return 0;
+        }
+        auto &data = file.dataAllowingUnsafe(*baseGs);
+        return data.sourceType == core::File::NotYetRead ? 0 : data.source().size();
+    };
+    fast_sort(files, [&sourceSize](core::FileRef a, core::FileRef b) { return sourceSize(a) > sourceSize(b); });
+
     auto resultq = make_shared<BlockingBoundedQueue<IndexThreadResultPack>>(files.size());
     auto fileq = make_shared<ConcurrentBoundedQueue<core::FileRef>>(files.size());
-    for (auto &file : files) {
-        fileq->push(move(file), 1);
+    fileq->push_bulk(files, files.size());
+
+    // On warm runs, fault the data the compute workers are about to need into the page cache ahead
+    // of them: each file's source bytes from disk and its cached tree blob from the kvstore (LMDB
+    // reads are mmap-backed, so touching the blob is enough). Workers still perform their own reads
+    // and decode in whatever order they claim files, so results are unchanged; they just stop
+    // stalling on disk and database page faults between trees. The thread joins when it falls out
+    // of scope, after all workers have finished.
+    unique_ptr<Joinable> cachePrefetcher;
+    if (kvstore) {
+        vector<core::FileRef> prefetchFiles(files.begin(), files.end());
+        cachePrefetcher =
+            runInAThread("indexCachePrefetch", [baseGs, &opts, &kvstore, prefetchFiles{move(prefetchFiles)}]() {
+                for (auto file : prefetchFiles) {
+                    if (file.id() >= baseGs->filesUsed()) {
+                        continue;
+                    }
+                    auto &fileData = file.dataAllowingUnsafe(*baseGs);
+                    string src;
+                    string_view source;
+                    if (fileData.sourceType == core::File::NotYetRead) {
+                        try {
+                            src = opts.fs->readFile(fileData.path());
+                        } catch (FileNotFoundException e) {
+                            continue;
+                        }
+                        source = src;
+                    } else {
+                        source = fileData.source();
+                    }
+                    auto blob = kvstore->read(treeKey(source));
+                    if (blob == nullptr) {
+                        continue;
+                    }
+                    // The first word of a pickled blob is its compressed size; walk the blob one
+                    // page at a time so every page gets faulted in.
+                    int compressedSize;
+                    memcpy(&compressedSize, blob, sizeof(int));
+                    volatile u1 sink = 0;
+                    for (int pos = 0; pos < compressedSize; pos += 4096) {
+                        sink += blob[pos];
+                    }
+                }
+            });
     }
 
     workers.multiplexJob("indexSuppliedFiles", [baseGs, &opts, fileq, resultq, &kvstore]() {
@@ -550,16 +940,34 @@ IndexResult indexSuppliedFiles(const shared_ptr<core::GlobalState> &baseGs, vect
         IndexThreadResultPack threadResult;
 
         {
-            core::FileRef job;
-            for (auto result = fileq->try_pop(job); !result.done(); result = fileq->try_pop(job)) {
+            // Claim files in adaptively sized batches: with tens of thousands of tiny RBI files,
+            // per-file dequeue synchronization rivals the parse itself.
+            vector<core::FileRef> jobs;
+            AdaptiveChunkSize chunkSize;
+            for (auto result = fileq->try_pop_bulk(jobs, chunkSize.next()); !result.done();
+                 result = fileq->try_pop_bulk(jobs, chunkSize.next())) {
                 if (result.gotItem()) {
-                    core::FileRef file = job;
-                    readFileWithStrictnessOverrides(localGs, file, opts);
-                    auto [parsedFile, pluginFiles] = indexOneWithPlugins(opts, *localGs, file, kvstore);
-                    threadResult.res.pluginGeneratedFiles.insert(threadResult.res.pluginGeneratedFiles.end(),
-                                                                 make_move_iterator(pluginFiles.begin()),
-                                                                 make_move_iterator(pluginFiles.end()));
-                    threadResult.res.trees.emplace_back(move(parsedFile));
+                    auto batchStart = chrono::steady_clock::now();
+                    for (auto file : jobs) {
+                        readFileWithStrictnessOverrides(localGs, file, opts);
+                        auto [parsedFile, pluginFiles] = indexOneWithPlugins(opts, *localGs, file, kvstore);
+                        threadResult.res.pluginGeneratedFiles.insert(threadResult.res.pluginGeneratedFiles.end(),
+                                                                     make_move_iterator(pluginFiles.begin()),
+                                                                     make_move_iterator(pluginFiles.end()));
+                        threadResult.res.trees.emplace_back(move(parsedFile));
+                        if (threadResult.res.trees.size() >= INDEX_RESULT_WINDOW) {
+                            threadResult.counters = getAndClearThreadCounters();
+                            threadResult.res.gs = move(localGs);
+                            auto computedTreesCount = threadResult.res.trees.size();
+                            resultq->push(move(threadResult), computedTreesCount);
+                            localGs = baseGs->deepCopy();
+                            threadResult = IndexThreadResultPack();
+                        }
+                    }
+                    auto batchUs =
+                        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - batchStart).count();
+                    chunkSize.recordBatch(batchUs, jobs.size());
+                    jobs.clear();
                 }
             }
         }
@@ -572,7 +980,7 @@ IndexResult indexSuppliedFiles(const shared_ptr<core::GlobalState> &baseGs, vect
         }
     });
 
-    return mergeIndexResults(baseGs, opts, resultq, kvstore);
+    return mergeIndexResults(baseGs, opts, resultq, kvstore, workers);
 }
 
 IndexResult indexPluginFiles(IndexResult firstPass, const options::Options &opts, WorkerPool &workers,
@@ -612,7 +1020,7 @@ IndexResult indexPluginFiles(IndexResult firstPass, const options::Options &opts
             resultq->push(move(threadResult), sizeIncrement);
         }
     });
-    auto indexedPluginFiles = mergeIndexResults(protoGs, opts, resultq, kvstore);
+    auto indexedPluginFiles = mergeIndexResults(protoGs, opts, resultq, kvstore, workers);
     IndexResult suppliedFilesAndPluginFiles;
     if (indexedPluginFiles.trees.empty()) {
         return firstPass;
@@ -620,14 +1028,9 @@ IndexResult indexPluginFiles(IndexResult firstPass, const options::Options &opts
     suppliedFilesAndPluginFiles.gs = move(indexedPluginFiles.gs);
 
     {
-        Timer timeit(suppliedFilesAndPluginFiles.gs->tracer(), "incremental_resolve");
         core::GlobalSubstitution substitution(*protoGs, *suppliedFilesAndPluginFiles.gs, protoGs.get());
-        core::MutableContext ctx(*suppliedFilesAndPluginFiles.gs, core::Symbols::root());
-        for (auto &tree : firstPass.trees) {
-            auto file = tree.file;
-            core::ErrorRegion errs(*suppliedFilesAndPluginFiles.gs, file);
-            tree.tree = ast::Substitute::run(ctx, substitution, move(tree.tree));
-        }
+        vector<const core::GlobalSubstitution *> substPerTree(firstPass.trees.size(), &substitution);
+        substituteTrees(*suppliedFilesAndPluginFiles.gs, substPerTree, firstPass.trees, workers);
     }
     suppliedFilesAndPluginFiles.trees = move(firstPass.trees);
     suppliedFilesAndPluginFiles.trees.insert(suppliedFilesAndPluginFiles.trees.end(),
@@ -675,23 +1078,26 @@ vector<ast::ParsedFile> index(unique_ptr<core::GlobalState> &gs, vector<core::Fi
         ret = move(pluginPass.trees);
     }
 
-    fast_sort(ret, [](ast::ParsedFile const &a, ast::ParsedFile const &b) { return a.file < b.file; });
+    fast_sort_u4_keys(ret, [](ast::ParsedFile const &a) { return a.file.id(); });
     return ret;
 }
 
-ast::ParsedFile typecheckOne(core::Context ctx, ast::ParsedFile resolved, const options::Options &opts) {
+ast::ParsedFile typecheckOne(core::Context ctx, ast::ParsedFile resolved, const options::Options &opts,
+                             definition_validator::ValidatorCache &validatorCache, cfg::CFGScratch &cfgScratch,
+                             const u1 *cachedCfgs, std::vector<u1> *cfgCacheOut, ExtensionBatches *extensionBatches,
+                             bool *sigSuggestionsDeferred) {
     ast::ParsedFile result{ast::MK::EmptyTree(), resolved.file};
     core::FileRef f = resolved.file;
 
-    resolved = definition_validator::runOne(ctx, std::move(resolved));
+    resolved = definition_validator::runOne(ctx, std::move(resolved), validatorCache);
 
     resolved = flatten::runOne(ctx, move(resolved));
 
     if (opts.print.FlattenTree.enabled || opts.print.AST.enabled) {
-        opts.print.FlattenTree.fmt("{}\n", resolved.tree->toString(ctx));
+        opts.print.FlattenTree.fmtForFile(f.id(), "{}\n", resolved.tree->toString(ctx));
     }
     if (opts.print.FlattenTreeRaw.enabled || opts.print.ASTRaw.enabled) {
-        opts.print.FlattenTreeRaw.fmt("{}\n", resolved.tree->showRaw(ctx));
+        opts.print.FlattenTreeRaw.fmtForFile(f.id(), "{}\n", resolved.tree->showRaw(ctx));
     }
 
     if (opts.stopAfterPhase == options::Phase::NAMER || opts.stopAfterPhase == options::Phase::RESOLVER) {
@@ -701,30 +1107,46 @@ ast::ParsedFile typecheckOne(core::Context ctx, ast::ParsedFile resolved, const
         return result;
     }
 
-    Timer timeit(ctx.state.tracer(), "typecheckOne", {{"file", (string)f.data(ctx).path()}});
+    Timer timeit(ctx.state.tracer(), "typecheckOne", {{"file", internDynamicName(f.data(ctx).path())}});
+    ProfilerTag profilerTag("typecheck", f.id());
+    FileTimingRecorder fileTiming(opts, "typecheck", f);
     try {
         if (opts.print.CFG.enabled) {
-            opts.print.CFG.fmt("digraph \"{}\" {{\n", FileOps::getFileName(f.data(ctx).path()));
+            opts.print.CFG.fmtForFile(f.id(), "digraph \"{}\" {{\n", FileOps::getFileName(f.data(ctx).path()));
         }
         if (opts.print.CFGRaw.enabled) {
-            opts.print.CFGRaw.fmt("digraph \"{}\" {{\n", FileOps::getFileName(f.data(ctx).path()));
-            opts.print.CFGRaw.fmt("  graph [fontname = \"Courier\"];\n");
-            opts.print.CFGRaw.fmt("  node [fontname = \"Courier\"];\n");
-            opts.print.CFGRaw.fmt("  edge [fontname = \"Courier\"];\n");
+            opts.print.CFGRaw.fmtForFile(f.id(), "digraph \"{}\" {{\n", FileOps::getFileName(f.data(ctx).path()));
+            opts.print.CFGRaw.fmtForFile(f.id(), "  graph [fontname = \"Courier\"];\n");
+            opts.print.CFGRaw.fmtForFile(f.id(), "  node [fontname = \"Courier\"];\n");
+            opts.print.CFGRaw.fmtForFile(f.id(), "  edge [fontname = \"Courier\"];\n");
         }
-        CFGCollectorAndTyper collector(opts);
+        CFGCollectorAndTyper collector(opts, cfgScratch, ctx.state, cachedCfgs, cfgCacheOut != nullptr,
+                                       extensionBatches);
         {
             core::ErrorRegion errs(ctx, f);
-            result.tree = ast::TreeMap::apply(ctx, collector, move(resolved.tree));
-            for (auto &extension : ctx.state.semanticExtensions) {
-                extension->finishTypecheckFile(ctx.state, f);
+            // The tree has been through flatten, so every MethodDef sits directly in a class body;
+            // a shallow walk finds them all without touching the bodies (CFG construction consumes
+            // those, not the tree walk).
+            result.tree = ast::ShallowMap::apply(ctx, collector, move(resolved.tree));
+            for (size_t i = 0; i < ctx.state.semanticExtensions.size(); i++) {
+                auto *batch = extensionBatches != nullptr ? (*extensionBatches)[i].get() : nullptr;
+                ctx.state.semanticExtensions[i]->finishTypecheckFile(ctx.state, f, batch);
+            }
+        }
+        if (cfgCacheOut != nullptr) {
+            *cfgCacheOut = collector.releaseCacheEntry();
+        }
+        if (collector.sigSuggestionsDeferred()) {
+            prodCounterInc("types.sig_suggestion.files_over_budget");
+            if (sigSuggestionsDeferred != nullptr) {
+                *sigSuggestionsDeferred = true;
             }
         }
         if (opts.print.CFG.enabled) {
-            opts.print.CFG.fmt("}}\n\n");
+            opts.print.CFG.fmtForFile(f.id(), "}}\n\n");
         }
         if (opts.print.CFGRaw.enabled) {
-            opts.print.CFGRaw.fmt("}}\n\n");
+            opts.print.CFGRaw.fmtForFile(f.id(), "}}\n\n");
         }
     } catch (SorbetException &) {
         Exception::failInFuzzer();
@@ -738,8 +1160,183 @@ ast::ParsedFile typecheckOne(core::Context ctx, ast::ParsedFile resolved, const
 struct typecheck_thread_result {
     vector<ast::ParsedFile> trees;
     CounterState counters;
+    // Measured wall time per file, fed back into the kvstore as the cost model for the next run's
+    // schedule.
+    vector<pair<core::FileRef, u4>> durationsUs;
+    // Freshly recorded CFG cache entries. Written back by the coordinating thread, which owns the
+    // kvstore.
+    vector<pair<core::FileRef, vector<u1>>> cfgCacheEntries;
+    // This worker's finished semantic-extension batches, paired with the extension's index in
+    // GlobalState::semanticExtensions. Folded back via consumeTypecheckBatch on the driver thread.
+    vector<pair<u4, unique_ptr<sorbet::pipeline::semantic_extension::TypecheckBatch>>> extensionBatches;
+    // Files whose sig-suggestion budget ran out before every suggestion was computed.
+    vector<core::FileRef> sigSuggestionsDeferred;
 };
 
+// Cost entries are keyed by path alone (unlike cached trees, which also key on a content hash): an
+// edited file keeps its recorded duration, which stays a far better estimate than byte size.
+string fileCostKey(const core::GlobalState &gs, core::FileRef file) {
+    return absl::StrCat("filecost//", file.data(gs).path());
+}
+
+// CFG cache entries embed name and symbol ids, so they are keyed by the input manifest (see
+// inputManifestHash) plus the file they belong to.
+string cfgCacheKey(const string &manifestHash, core::FileRef file) {
+    return absl::StrCat("CFGs//", manifestHash, "//", file.id());
+}
+
+u4 computeOutlineHash(const core::GlobalState &gs, const unique_ptr<ast::Expression> &tree);
+
+// The errors a file's typecheck produces depend on its own tree plus the global symbol table, and
+// the symbol table is determined by every file's definitions, never by method bodies. The
+// diagnostics-cache epoch is therefore a hash over every file's path and outline hash (see
+// computeOutlineHash): a rebase that only touches method bodies keeps the epoch stable, so the
+// untouched files may replay their cached diagnostics while only the diff retypechecks. Outline
+// hashes are themselves memoized in the kvstore under the file's content hash, so computing the
+// epoch on a warm run costs one tree print per changed file, not per file.
+string diagnosticsEpoch(const core::GlobalState &gs, const vector<ast::ParsedFile> &what, KeyValueStore &kvstore) {
+    string manifest;
+    for (auto &resolved : what) {
+        auto key = absl::StrCat("OutlineHash//", fileKey(gs, resolved.file));
+        u4 outlineHash;
+        auto data = kvstore.read(key);
+        if (data != nullptr) {
+            memcpy(&outlineHash, data, sizeof(outlineHash));
+        } else {
+            outlineHash = computeOutlineHash(gs, resolved.tree);
+            vector<u1> value(sizeof(outlineHash));
+            memcpy(value.data(), &outlineHash, sizeof(outlineHash));
+            kvstore.write(key, value);
+        }
+        absl::StrAppend(&manifest, resolved.file.data(gs).path(), "//", outlineHash, "\n");
+    }
+    auto hashBytes = sorbet::crypto_hashing::hash64(manifest);
+    return absl::BytesToHexString(string_view{(char *)hashBytes.data(), size(hashBytes)});
+}
+
+string diagnosticsCacheKey(const core::GlobalState &gs, const string &epoch, core::FileRef file) {
+    return absl::StrCat("Diagnostics//", epoch, "//", fileKey(gs, file));
+}
+
+void diagnosticsAppendU4(vector<u1> &out, u4 value) {
+    auto offset = out.size();
+    out.resize(offset + sizeof(value));
+    memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+void diagnosticsAppendString(vector<u1> &out, string_view value) {
+    diagnosticsAppendU4(out, value.size());
+    out.insert(out.end(), (const u1 *)value.data(), (const u1 *)value.data() + value.size());
+}
+
+// Locs are persisted as path + offsets: file ids are not stable across runs, paths are.
+void diagnosticsAppendLoc(vector<u1> &out, const core::GlobalState &gs, core::Loc loc) {
+    if (!loc.exists()) {
+        diagnosticsAppendString(out, "");
+        diagnosticsAppendU4(out, 0);
+        diagnosticsAppendU4(out, 0);
+        return;
+    }
+    diagnosticsAppendString(out, loc.file().data(gs).path());
+    diagnosticsAppendU4(out, loc.beginPos());
+    diagnosticsAppendU4(out, loc.endPos());
+}
+
+u4 diagnosticsReadU4(const u1 *&data) {
+    u4 value;
+    memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return value;
+}
+
+string diagnosticsReadString(const u1 *&data) {
+    auto size = diagnosticsReadU4(data);
+    string value((const char *)data, size);
+    data += size;
+    return value;
+}
+
+bool diagnosticsReadLoc(const u1 *&data, const core::GlobalState &gs, core::Loc &out) {
+    auto path = diagnosticsReadString(data);
+    auto beginPos = diagnosticsReadU4(data);
+    auto endPos = diagnosticsReadU4(data);
+    if (path.empty()) {
+        out = core::Loc::none();
+        return true;
+    }
+    auto file = gs.findFileByPath(path);
+    if (!file.exists()) {
+        return false;
+    }
+    out = core::Loc(file, beginPos, endPos);
+    return true;
+}
+
+// Flattens one file's reported errors into a kvstore blob. Returns nullopt when the errors cannot
+// be replayed faithfully from a cache: autocorrects carry edits we do not persist, and a critical
+// error means the run itself went wrong.
+optional<vector<u1>> serializeDiagnostics(const core::GlobalState &gs, const vector<unique_ptr<core::Error>> *errors) {
+    vector<u1> out;
+    if (errors == nullptr) {
+        diagnosticsAppendU4(out, 0);
+        return out;
+    }
+    diagnosticsAppendU4(out, errors->size());
+    for (auto &error : *errors) {
+        if (!error->autocorrects.empty() || error->isCritical()) {
+            return nullopt;
+        }
+        diagnosticsAppendU4(out, error->what.code);
+        diagnosticsAppendU4(out, static_cast<u4>(error->what.minLevel));
+        diagnosticsAppendLoc(out, gs, error->loc);
+        diagnosticsAppendString(out, error->header);
+        diagnosticsAppendU4(out, error->sections.size());
+        for (auto &section : error->sections) {
+            diagnosticsAppendString(out, section.header);
+            diagnosticsAppendU4(out, section.messages.size());
+            for (auto &line : section.messages) {
+                diagnosticsAppendLoc(out, gs, line.loc);
+                diagnosticsAppendString(out, line.formattedMessage);
+            }
+        }
+    }
+    return out;
+}
+
+// Rebuilds the errors recorded by serializeDiagnostics. Returns nullopt when a referenced file no
+// longer exists in this run's file table; callers treat that as a cache miss.
+optional<vector<unique_ptr<core::Error>>> deserializeDiagnostics(const core::GlobalState &gs, const u1 *data) {
+    vector<unique_ptr<core::Error>> out;
+    auto errorCount = diagnosticsReadU4(data);
+    out.reserve(errorCount);
+    for (u4 i = 0; i < errorCount; i++) {
+        auto code = diagnosticsReadU4(data);
+        auto minLevel = static_cast<core::StrictLevel>(diagnosticsReadU4(data));
+        core::Loc loc;
+        if (!diagnosticsReadLoc(data, gs, loc)) {
+            return nullopt;
+        }
+        auto header = diagnosticsReadString(data);
+        vector<core::ErrorSection> sections;
+        auto sectionCount = diagnosticsReadU4(data);
+        for (u4 j = 0; j < sectionCount; j++) {
+            core::ErrorSection section(diagnosticsReadString(data));
+            auto lineCount = diagnosticsReadU4(data);
+            for (u4 k = 0; k < lineCount; k++) {
+                core::Loc lineLoc;
+                if (!diagnosticsReadLoc(data, gs, lineLoc)) {
+                    return nullopt;
+                }
+                section.messages.emplace_back(lineLoc, diagnosticsReadString(data));
+            }
+            sections.emplace_back(move(section));
+        }
+        out.emplace_back(make_unique<core::Error>(loc, core::ErrorClass(code, minLevel), move(header), move(sections),
+                                                  vector<core::AutocorrectSuggestion>{}, false));
+    }
+    return out;
+}
+
 vector<ast::ParsedFile> name(core::GlobalState &gs, vector<ast::ParsedFile> what, const options::Options &opts,
                              bool skipConfigatron) {
     Timer timeit(gs.tracer(), "name");
@@ -790,6 +1387,60 @@ vector<ast::ParsedFile> printMissingConstants(core::GlobalState &gs, const optio
     return what;
 }
 
+class GatherConstantDependenciesWalk {
+public:
+    // Ids of the symbols the current file's constants resolved to, in visit order with duplicates.
+    vector<u4> symbols;
+    unique_ptr<ast::Expression> postTransformConstantLit(core::Context ctx, unique_ptr<ast::ConstantLit> original) {
+        auto sym = original->symbol;
+        // Unresolved constants are stubbed to StubModule/untyped; they name nothing this run can
+        // depend on, so leave them out rather than have every file depend on the stub.
+        if (sym.exists() && sym != core::Symbols::StubModule() && sym != core::Symbols::untyped()) {
+            symbols.emplace_back(sym._id);
+        }
+        return original;
+    }
+};
+
+constexpr u4 DEPENDENCY_GRAPH_VERSION = 1;
+constexpr string_view DEPENDENCY_GRAPH_KEY = "DependencyGraph"sv;
+
+// Persists which symbols each file's constants resolved to (--store-dependency-graph), so that
+// consumers (scoped typechecking, build sharding) do not need a separate autogen pass to recover
+// the graph. Format, after zstd decompression (see Pickler::result): a version u4, the file
+// count, then per file its path, its referenced-symbol count, and the sorted symbol ids
+// delta-encoded as varints. Symbol ids are only meaningful within a single artifact; consumers
+// joining across runs should join on file paths.
+vector<ast::ParsedFile> storeDependencyGraph(core::GlobalState &gs, vector<ast::ParsedFile> what,
+                                             KeyValueStore &kvstore) {
+    Timer timeit(gs.tracer(), "storeDependencyGraph");
+    core::Context ctx(gs, core::Symbols::root());
+    core::serialize::Pickler p;
+    p.putU4(DEPENDENCY_GRAPH_VERSION);
+    p.putU4(what.size());
+    for (auto &resolved : what) {
+        GatherConstantDependenciesWalk walk;
+        resolved.tree = ast::TreeMap::apply(ctx, walk, move(resolved.tree));
+        fast_sort(walk.symbols);
+        u4 uniqueCount = 0;
+        for (auto id : walk.symbols) {
+            if (uniqueCount == 0 || walk.symbols[uniqueCount - 1] != id) {
+                walk.symbols[uniqueCount++] = id;
+            }
+        }
+        walk.symbols.resize(uniqueCount);
+        p.putStr(resolved.file.data(gs).path());
+        p.putU4(walk.symbols.size());
+        u4 prev = 0;
+        for (auto id : walk.symbols) {
+            p.putU4(id - prev);
+            prev = id;
+        }
+    }
+    kvstore.write(DEPENDENCY_GRAPH_KEY, p.result(core::serialize::Serializer::GLOBAL_STATE_COMPRESSION_DEGREE));
+    return what;
+}
+
 class DefinitionLinesBlacklistEnforcer {
 private:
     const core::FileRef file;
@@ -839,10 +1490,87 @@ ast::ParsedFile checkNoDefinitionsInsideProhibitedLines(core::GlobalState &gs, a
     return what;
 }
 
+// Hex hash pinning down a full input set: every file's path and content hash, in order. Cache
+// entries whose contents embed name or symbol ids (the post-namer state, cached CFGs) are only
+// meaningful against the identical input set, because namer assigns ids deterministically from the
+// indexed trees; this manifest is that identity (the kvstore is already segregated by sorbet
+// version and payload via its own version key).
+string inputManifestHash(const core::GlobalState &gs, const vector<ast::ParsedFile> &what) {
+    string manifest;
+    for (auto &f : what) {
+        absl::StrAppend(&manifest, fileKey(gs, f.file), "\n");
+    }
+    auto hashBytes = sorbet::crypto_hashing::hash64(manifest);
+    return absl::BytesToHexString(string_view{(char *)hashBytes.data(), size(hashBytes)});
+}
+
+// Key identifying the post-namer state for a given input set.
+string nameStateKey(core::GlobalState &gs, const vector<ast::ParsedFile> &what) {
+    return absl::StrCat("NamerState//", inputManifestHash(gs, what));
+}
+
+bool restoreNameStateFromCache(core::GlobalState &gs, vector<ast::ParsedFile> &what, KeyValueStore &kvstore,
+                               const string &cacheKey) {
+    auto gsBytes = kvstore.read(cacheKey);
+    if (!gsBytes) {
+        prodCounterInc("types.input.namer_cache.miss");
+        return false;
+    }
+    Timer timeit(gs.tracer(), "restoreNameStateFromCache");
+    // Collect every tree blob up front so that a partially-written cache leaves gs untouched.
+    vector<const u1 *> blobs;
+    blobs.reserve(what.size());
+    for (auto &f : what) {
+        auto blob = kvstore.read(absl::StrCat(cacheKey, "//", f.file.id()));
+        if (!blob) {
+            prodCounterInc("types.input.namer_cache.miss");
+            return false;
+        }
+        blobs.emplace_back(blob);
+    }
+    auto filesBefore = gs.filesUsed();
+    core::serialize::Serializer::overwriteGlobalState(gs, gsBytes);
+    ENFORCE(gs.filesUsed() == filesBefore);
+    for (size_t i = 0; i < what.size(); i++) {
+        auto arena = make_shared<ast::Arena>();
+        ast::Arena::Guard arenaGuard(arena.get());
+        what[i].tree = core::serialize::Serializer::loadExpression(gs, blobs[i], what[i].file.id());
+        what[i].arena = move(arena);
+    }
+    prodCounterInc("types.input.namer_cache.hit");
+    return true;
+}
+
+void cacheNameState(core::GlobalState &gs, vector<ast::ParsedFile> &what, KeyValueStore &kvstore,
+                    const string &cacheKey) {
+    Timer timeit(gs.tracer(), "cacheNameState");
+    kvstore.write(cacheKey, core::serialize::Serializer::store(gs));
+    for (auto &f : what) {
+        kvstore.write(absl::StrCat(cacheKey, "//", f.file.id()),
+                      core::serialize::Serializer::storeExpression(gs, f.tree));
+    }
+}
+
 ast::ParsedFilesOrCancelled resolve(unique_ptr<core::GlobalState> &gs, vector<ast::ParsedFile> what,
-                                    const options::Options &opts, WorkerPool &workers, bool skipConfigatron) {
+                                    const options::Options &opts, WorkerPool &workers, bool skipConfigatron,
+                                    KeyValueStore *kvstore) {
     try {
-        what = name(*gs, move(what), opts, skipConfigatron);
+        bool namedFromCache = false;
+        string cacheKey;
+        if (kvstore != nullptr) {
+            cacheKey = nameStateKey(*gs, what);
+            namedFromCache = restoreNameStateFromCache(*gs, what, *kvstore, cacheKey);
+        }
+        if (!namedFromCache) {
+            auto errorsBefore = gs->errorQueue->nonSilencedErrorCount.load();
+            what = name(*gs, move(what), opts, skipConfigatron);
+            if (kvstore != nullptr && !gs->wasTypecheckingCanceled() && !gs->hadCriticalError() &&
+                gs->errorQueue->nonSilencedErrorCount.load() == errorsBefore) {
+                // Errors are not serialized, so a run whose namer phase reported errors must not
+                // seed the cache: a warm rerun would silently drop them.
+                cacheNameState(*gs, what, *kvstore, cacheKey);
+            }
+        }
         if (gs->wasTypecheckingCanceled()) {
             return ast::ParsedFilesOrCancelled();
         }
@@ -864,6 +1592,7 @@ ast::ParsedFilesOrCancelled resolve(unique_ptr<core::GlobalState> &gs, vector<as
         ProgressIndicator namingProgress(opts.showProgress, "Resolving", 1);
         {
             Timer timeit(gs->tracer(), "resolving");
+            ProfilerTag profilerTag("resolve");
             vector<core::ErrorRegion> errs;
             for (auto &tree : what) {
                 auto file = tree.file;
@@ -892,7 +1621,7 @@ ast::ParsedFilesOrCancelled resolve(unique_ptr<core::GlobalState> &gs, vector<as
                 auto reIndexed = indexOne(opts, *gs, f.file, kvstore);
                 vector<ast::ParsedFile> toBeReResolved;
                 toBeReResolved.emplace_back(move(reIndexed));
-                auto reresolved = pipeline::incrementalResolve(*gs, move(toBeReResolved), opts);
+                auto reresolved = pipeline::incrementalResolve(*gs, move(toBeReResolved), opts, workers);
                 ENFORCE(reresolved.size() == 1);
                 f = checkNoDefinitionsInsideProhibitedLines(*gs, move(reresolved[0]), 0, prohibitedLines);
             }
@@ -920,79 +1649,326 @@ ast::ParsedFilesOrCancelled resolve(unique_ptr<core::GlobalState> &gs, vector<as
     if (opts.print.MissingConstants.enabled) {
         what = printMissingConstants(*gs, opts, move(what));
     }
+    if (opts.storeDependencyGraph && kvstore != nullptr) {
+        what = storeDependencyGraph(*gs, move(what), *kvstore);
+    }
 
     return ast::ParsedFilesOrCancelled(move(what));
 }
 
 ast::ParsedFilesOrCancelled typecheck(unique_ptr<core::GlobalState> &gs, vector<ast::ParsedFile> what,
-                                      const options::Options &opts, WorkerPool &workers) {
+                                      const options::Options &opts, WorkerPool &workers, KeyValueStore *kvstore,
+                                      vector<core::FileRef> *sigSuggestionsDeferred) {
     vector<ast::ParsedFile> typecheck_result;
 
     {
         Timer timeit(gs->tracer(), "typecheck");
 
-        shared_ptr<ConcurrentBoundedQueue<ast::ParsedFile>> fileq;
-        shared_ptr<BlockingBoundedQueue<typecheck_thread_result>> resultq;
+        core::Context ctx(*gs, core::Symbols::root());
 
-        {
-            fileq = make_shared<ConcurrentBoundedQueue<ast::ParsedFile>>(what.size());
-            resultq = make_shared<BlockingBoundedQueue<typecheck_thread_result>>(what.size());
+        // Warm-run CFG cache: pre-inference CFGs pickled by a previous run over the identical
+        // input set (the key embeds the input manifest; see cfgCacheKey) are deserialized instead
+        // of rebuilt from the trees. Workers read entries directly; freshly recorded entries come
+        // back through the result queue because only this thread may write the kvstore. Computed
+        // before the cost-model sort below so the manifest is order-stable across runs.
+        string cfgManifestHash;
+        if (kvstore != nullptr) {
+            cfgManifestHash = inputManifestHash(*gs, what);
         }
 
-        core::Context ctx(*gs, core::Symbols::root());
+        // Warm-run diagnostics cache: when no definition anywhere in the input set changed (see
+        // diagnosticsEpoch), a file whose own content is also unchanged must reproduce the errors
+        // of the previous run exactly, so its diagnostics are replayed from the kvstore and the
+        // file is never queued for typechecking. Rebase CI reruns then pay for the diff, not the
+        // whole codebase. Disabled whenever skipping typecheckOne would change observable output
+        // beyond diagnostics (prints of CFGs or flattened trees, autocorrect edits, suggest-typed
+        // decisions that read silenced errors, semantic extensions).
+        string diagnosticsCacheEpoch;
+        UnorderedSet<int> diagnosticsReplayedFiles;
+        const bool diagnosticsCacheEnabled =
+            kvstore != nullptr && !opts.suggestTyped && !opts.autocorrect && gs->semanticExtensions.empty() &&
+            opts.stopAfterPhase == options::Phase::INFERENCER && !opts.print.CFG.enabled && !opts.print.CFGRaw.enabled &&
+            !opts.print.FlattenTree.enabled && !opts.print.FlattenTreeRaw.enabled && !opts.print.AST.enabled &&
+            !opts.print.ASTRaw.enabled;
+        if (diagnosticsCacheEnabled) {
+            Timer timeitProbe(gs->tracer(), "typecheck.diagnostics_cache_probe");
+            diagnosticsCacheEpoch = diagnosticsEpoch(*gs, what, *kvstore);
+            // Drain whatever earlier phases left buffered so that the retained flushes below
+            // contain typecheck-phase errors only.
+            gs->errorQueue->flushErrors(true);
+            for (auto &resolved : what) {
+                auto data = kvstore->read(diagnosticsCacheKey(*gs, diagnosticsCacheEpoch, resolved.file));
+                if (data == nullptr) {
+                    prodCounterInc("types.input.diagnostics_cache.miss");
+                    continue;
+                }
+                auto errors = deserializeDiagnostics(*gs, data);
+                if (!errors.has_value()) {
+                    prodCounterInc("types.input.diagnostics_cache.miss");
+                    continue;
+                }
+                for (auto &error : *errors) {
+                    gs->errorQueue->pushError(*gs, move(error));
+                }
+                gs->errorQueue->markFileForFlushing(resolved.file);
+                diagnosticsReplayedFiles.insert(resolved.file.id());
+                prodCounterInc("types.input.diagnostics_cache.hit");
+            }
+            // Print the replayed diagnostics before retention starts, so only errors produced by
+            // this run's typecheckOne calls end up in the retained set written back below.
+            gs->errorQueue->flushErrors();
+            gs->errorQueue->retainFlushedErrors = true;
+        }
 
-        // We want to start typeckecking big files first because it helps with better work distribution
+        auto queuedFileCount = what.size() - diagnosticsReplayedFiles.size();
+        auto fileq = make_shared<ConcurrentBoundedQueue<ast::ParsedFile>>(queuedFileCount);
+        auto resultq = make_shared<BlockingBoundedQueue<typecheck_thread_result>>(queuedFileCount);
+
+        // We want to start typechecking the most expensive files first because it helps with better
+        // work distribution: a straggler that starts last finishes long after everything else. The
+        // best cost estimate is the file's measured duration from a previous run, persisted in the
+        // kvstore; files without a recording fall back to byte size, scaled into the same units by
+        // the average throughput of the files we do have recordings for.
+        UnorderedMap<int, u4> recordedCostUs;
+        double usPerByte = -1.0;
+        if (kvstore != nullptr) {
+            size_t totalRecordedUs = 0;
+            size_t totalRecordedBytes = 0;
+            for (auto &resolved : what) {
+                auto data = kvstore->read(fileCostKey(*gs, resolved.file));
+                if (data != nullptr) {
+                    u4 durationUs;
+                    memcpy(&durationUs, data, sizeof(durationUs));
+                    recordedCostUs[resolved.file.id()] = durationUs;
+                    totalRecordedUs += durationUs;
+                    totalRecordedBytes += resolved.file.data(*gs).source().size();
+                }
+            }
+            if (totalRecordedBytes > 0) {
+                usPerByte = static_cast<double>(totalRecordedUs) / totalRecordedBytes;
+            }
+        }
+        auto estimatedCost = [&](const ast::ParsedFile &resolved) -> double {
+            auto it = recordedCostUs.find(resolved.file.id());
+            if (it != recordedCostUs.end()) {
+                return it->second;
+            }
+            auto bytes = static_cast<double>(resolved.file.data(*gs).source().size());
+            return usPerByte > 0 ? bytes * usPerByte : bytes;
+        };
         fast_sort(what, [&](const auto &lhs, const auto &rhs) -> bool {
-            return lhs.file.data(*gs).source().size() > rhs.file.data(*gs).source().size();
+            return estimatedCost(lhs) > estimatedCost(rhs);
         });
+        double totalEstimatedUs = 0;
         for (auto &resolved : what) {
+            if (diagnosticsReplayedFiles.contains(resolved.file.id())) {
+                // Same shape typecheckOne itself returns for files it declines (RBIs, --stop-after):
+                // callers only consume the FileRefs of typechecked results.
+                ast::ParsedFile replayed{ast::MK::EmptyTree(), resolved.file};
+                typecheck_result.emplace_back(move(replayed));
+                continue;
+            }
+            totalEstimatedUs += estimatedCost(resolved);
             fileq->push(move(resolved), 1);
         }
 
+        // Phase-aware fan-out. Typecheck stops scaling around this many workers on our biggest
+        // codebases (--timing-report ledgers show the shared symbol and name tables' cache misses
+        // flattening the curve past it), and small runs should not wake the whole pool for a few
+        // milliseconds of work, so the job is offered to one worker per ~20ms of estimated work.
+        // Without recorded costs the estimate is in bytes, which only errs toward offering more
+        // workers; the knee still bounds it. Workers past the cap never see the job and stay
+        // parked in their queue waits instead of contending for files.
+        constexpr int TYPECHECK_CONCURRENCY_KNEE = 48;
+        constexpr double MIN_ESTIMATED_US_PER_WORKER = 20000.0;
+        auto typecheckConcurrency = static_cast<int>(clamp(
+            totalEstimatedUs / MIN_ESTIMATED_US_PER_WORKER, 1.0, static_cast<double>(TYPECHECK_CONCURRENCY_KNEE)));
+
+        vector<pair<core::FileRef, u4>> fileDurationsUs;
+        vector<pair<core::FileRef, vector<u1>>> cfgCacheEntries;
         {
-            ProgressIndicator cfgInferProgress(opts.showProgress, "CFG+Inference", what.size());
-            workers.multiplexJob("typecheck", [ctx, &opts, fileq, resultq]() {
+            ProgressIndicator cfgInferProgress(opts.showProgress, "CFG+Inference", queuedFileCount);
+            for (auto &extension : gs->semanticExtensions) {
+                extension->typecheckBegin(*gs);
+            }
+            auto typecheckJob = [ctx, &opts, fileq, resultq, kvstore, &cfgManifestHash]() {
                 typecheck_thread_result threadResult;
-                ast::ParsedFile job;
                 int processedByThread = 0;
+                // One private batch per extension; the per-method and per-file hooks write into
+                // them without synchronization for this job's whole lifetime.
+                ExtensionBatches extensionBatches;
+                for (auto &extension : ctx.state.semanticExtensions) {
+                    extensionBatches.emplace_back(extension->newTypecheckBatch(ctx.state));
+                }
+                // Shared across all files this thread typechecks; deep hierarchies repeat the same
+                // ancestors in file after file.
+                definition_validator::ValidatorCache validatorCache;
+                // Also thread-lifetime: CFG construction's working sets, sized by the largest
+                // method this thread has seen.
+                cfg::CFGScratch cfgScratch;
 
                 {
-                    for (auto result = fileq->try_pop(job); !result.done() && !ctx.state.wasTypecheckingCanceled();
-                         result = fileq->try_pop(job)) {
+                    // Cheap files (RBIs) arrive in large claimed batches; expensive ones claim
+                    // one at a time, so dequeue synchronization stays off the profile either way.
+                    vector<ast::ParsedFile> jobs;
+                    AdaptiveChunkSize chunkSize;
+                    for (auto result = fileq->try_pop_bulk(jobs, chunkSize.next());
+                         !result.done() && !ctx.state.wasTypecheckingCanceled();
+                         result = fileq->try_pop_bulk(jobs, chunkSize.next())) {
                         if (result.gotItem()) {
-                            processedByThread++;
-                            core::FileRef file = job.file;
-                            try {
-                                threadResult.trees.emplace_back(typecheckOne(ctx, move(job), opts));
-                            } catch (SorbetException &) {
-                                Exception::failInFuzzer();
-                                ctx.state.tracer().error("Exception typing file: {} (backtrace is above)",
-                                                         file.data(ctx).path());
+                            auto batchStart = chrono::steady_clock::now();
+                            for (auto &job : jobs) {
+                                processedByThread++;
+                                core::FileRef file = job.file;
+                                try {
+                                    const u1 *cachedCfgs = kvstore != nullptr
+                                                               ? kvstore->read(cfgCacheKey(cfgManifestHash, file))
+                                                               : nullptr;
+                                    vector<u1> cfgCacheEntry;
+                                    auto *cfgCacheOut =
+                                        kvstore != nullptr && cachedCfgs == nullptr ? &cfgCacheEntry : nullptr;
+                                    auto start = chrono::steady_clock::now();
+                                    bool suggestionsDeferred = false;
+                                    auto checked = typecheckOne(ctx, move(job), opts, validatorCache, cfgScratch,
+                                                                cachedCfgs, cfgCacheOut, &extensionBatches,
+                                                                &suggestionsDeferred);
+                                    if (suggestionsDeferred) {
+                                        threadResult.sigSuggestionsDeferred.emplace_back(file);
+                                    }
+                                    if (opts.dropTypecheckedTrees) {
+                                        // Callers only look at the returned trees' FileRefs
+                                        // (e.g. --suggest-typed), so the tree and the arena backing
+                                        // its nodes can go now instead of at end of run.
+                                        checked.tree.reset();
+                                        checked.arena.reset();
+                                        prodCounterInc("types.memory.typechecked_trees_dropped");
+                                    }
+                                    threadResult.trees.emplace_back(move(checked));
+                                    if (!cfgCacheEntry.empty()) {
+                                        threadResult.cfgCacheEntries.emplace_back(file, move(cfgCacheEntry));
+                                    }
+                                    auto durationUs = chrono::duration_cast<chrono::microseconds>(
+                                                          chrono::steady_clock::now() - start)
+                                                          .count();
+                                    threadResult.durationsUs.emplace_back(
+                                        file, static_cast<u4>(min<long long>(durationUs, UINT32_MAX)));
+                                } catch (SorbetException &) {
+                                    Exception::failInFuzzer();
+                                    ctx.state.tracer().error("Exception typing file: {} (backtrace is above)",
+                                                             file.data(ctx).path());
+                                }
                             }
+                            auto batchUs =
+                                chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - batchStart)
+                                    .count();
+                            chunkSize.recordBatch(batchUs, jobs.size());
+                            jobs.clear();
+                        }
+                        // Interactive work wants to preempt this slow path. Park (after the current batch, so
+                        // nothing popped from the queue is abandoned; batches are sized to roughly a
+                        // millisecond of work, so this adds little latency); the preempting thread
+                        // re-dispatches this job once the work has run.
+                        if (ctx.state.lspPreemptionWaiting != nullptr && ctx.state.lspPreemptionWaiting()) {
+                            break;
                         }
                     }
                 }
                 if (processedByThread > 0) {
+                    for (u4 i = 0; i < extensionBatches.size(); i++) {
+                        if (extensionBatches[i] != nullptr) {
+                            threadResult.extensionBatches.emplace_back(i, move(extensionBatches[i]));
+                        }
+                    }
                     threadResult.counters = getAndClearThreadCounters();
                     resultq->push(move(threadResult), processedByThread);
                 }
-            });
+            };
+            workers.multiplexJobBounded("typecheck", typecheckConcurrency, typecheckJob);
 
             typecheck_thread_result threadResult;
+            // Each worker that processed at least one file pushes one result (plus one per
+            // re-dispatch after a preemption), so this approximates how many of the offered
+            // workers found work — the observable for tuning the knee above.
+            int workersUsed = 0;
             {
+                fileDurationsUs.reserve(what.size());
                 for (auto result = resultq->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), gs->tracer());
                      !result.done();
                      result = resultq->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), gs->tracer())) {
                     if (result.gotItem()) {
+                        workersUsed++;
                         counterConsume(move(threadResult.counters));
+                        // The reduce step: one batch at a time, on this thread, so extensions
+                        // need no locking of their own (mirrors counterConsume above).
+                        for (auto &[extensionIdx, batch] : threadResult.extensionBatches) {
+                            gs->semanticExtensions[extensionIdx]->consumeTypecheckBatch(*gs, move(batch));
+                        }
                         typecheck_result.insert(typecheck_result.end(), make_move_iterator(threadResult.trees.begin()),
                                                 make_move_iterator(threadResult.trees.end()));
+                        fileDurationsUs.insert(fileDurationsUs.end(), threadResult.durationsUs.begin(),
+                                               threadResult.durationsUs.end());
+                        cfgCacheEntries.insert(cfgCacheEntries.end(),
+                                               make_move_iterator(threadResult.cfgCacheEntries.begin()),
+                                               make_move_iterator(threadResult.cfgCacheEntries.end()));
+                        if (sigSuggestionsDeferred != nullptr) {
+                            sigSuggestionsDeferred->insert(sigSuggestionsDeferred->end(),
+                                                           threadResult.sigSuggestionsDeferred.begin(),
+                                                           threadResult.sigSuggestionsDeferred.end());
+                        }
                     }
                     cfgInferProgress.reportProgress(fileq->doneEstimate());
                     gs->errorQueue->flushErrors();
                     if (ctx.state.wasTypecheckingCanceled()) {
                         return ast::ParsedFilesOrCancelled();
                     }
+                    if (gs->lspPreemptionWaiting != nullptr && gs->lspPreemptionWaiting()) {
+                        // Workers park at their next file boundary when they see this signal. Run the queued
+                        // interactive work here (it reads the previously committed GlobalState, not `gs`), then
+                        // re-dispatch the job so the parked workers pick the remaining files back up.
+                        gs->lspRunPreemptionTasks();
+                        workers.multiplexJobBounded("typecheck", typecheckConcurrency, typecheckJob);
+                    }
+                }
+            }
+            histogramInc("concurrency.typecheck.workers_offered", typecheckConcurrency);
+            histogramInc("concurrency.typecheck.workers_used", workersUsed);
+            for (auto &extension : gs->semanticExtensions) {
+                extension->typecheckEnd(*gs);
+            }
+        }
+
+        if (kvstore != nullptr) {
+            // Feed measured durations back into the cost model. Must happen on this thread: the
+            // kvstore only accepts writes from the thread that created it.
+            for (auto &[file, durationUs] : fileDurationsUs) {
+                vector<u1> value(sizeof(durationUs));
+                memcpy(value.data(), &durationUs, sizeof(durationUs));
+                kvstore->write(fileCostKey(*gs, file), value);
+            }
+            for (auto &[file, entry] : cfgCacheEntries) {
+                kvstore->write(cfgCacheKey(cfgManifestHash, file), entry);
+            }
+        }
+
+        if (diagnosticsCacheEnabled) {
+            // Flush the final batch so the retained set is complete, then persist one entry per
+            // typechecked file — including an empty list for clean files, which is what lets the
+            // next run tell "no errors" apart from "never checked". Nothing is written after a
+            // critical error: the run's diagnostics are not trustworthy.
+            gs->errorQueue->flushErrors(true);
+            auto retained = gs->errorQueue->stealRetainedErrors();
+            gs->errorQueue->retainFlushedErrors = false;
+            if (!gs->hadCriticalError()) {
+                for (auto &checked : typecheck_result) {
+                    if (diagnosticsReplayedFiles.contains(checked.file.id())) {
+                        continue;
+                    }
+                    auto it = retained.find(checked.file);
+                    auto blob = serializeDiagnostics(*gs, it == retained.end() ? nullptr : &it->second);
+                    if (blob.has_value()) {
+                        kvstore->write(diagnosticsCacheKey(*gs, diagnosticsCacheEpoch, checked.file), *blob);
+                        prodCounterInc("types.input.diagnostics_cache.write");
+                    }
                 }
             }
         }
@@ -1025,6 +2001,16 @@ ast::ParsedFilesOrCancelled typecheck(unique_ptr<core::GlobalState> &gs, vector<
                 opts.print.SymbolTableJson.print(buf.str());
             }
         }
+        if (opts.print.SymbolTableProto.enabled) {
+            // Streams records straight to the destination; buffering through PrinterConfig would
+            // reintroduce the whole-table allocation this format exists to avoid.
+            if (opts.print.SymbolTableProto.outputPath.empty()) {
+                core::Proto::streamSymbolTableProto(*gs, false, cout);
+            } else {
+                ofstream out(opts.print.SymbolTableProto.outputPath, ios::binary | ios::trunc);
+                core::Proto::streamSymbolTableProto(*gs, false, out);
+            }
+        }
 #endif
         if (opts.print.SymbolTableFull.enabled) {
             opts.print.SymbolTableFull.fmt("{}\n", gs->toStringFull());
@@ -1102,6 +2088,60 @@ public:
     }
 };
 
+// Strips method bodies out of a tree copy so that only the file's outline — definition shells,
+// sigs, and anything else at class-body level — remains. A body survives only when something
+// inside it can introduce a definition (a nested def or class, or an assignment to a constant,
+// field, or global), so a stripped tree is a faithful witness for the file's definitions: equal
+// outlines imply equal definition hashes.
+class MethodBodyStripper {
+    // Number of definition-introducing nodes seen so far; preTransformMethodDef snapshots it and
+    // postTransformMethodDef strips the body when it did not move.
+    int definitionsSeen = 0;
+    vector<int> definitionsSeenAtMethodEntry;
+
+public:
+    unique_ptr<ast::MethodDef> preTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> original) {
+        definitionsSeenAtMethodEntry.push_back(definitionsSeen);
+        return original;
+    }
+
+    unique_ptr<ast::MethodDef> postTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> original) {
+        ENFORCE(!definitionsSeenAtMethodEntry.empty());
+        auto atEntry = definitionsSeenAtMethodEntry.back();
+        definitionsSeenAtMethodEntry.pop_back();
+        if (definitionsSeen == atEntry) {
+            original->rhs = make_unique<ast::EmptyTree>(original->rhs->loc);
+        }
+        definitionsSeen++;
+        return original;
+    }
+
+    unique_ptr<ast::ClassDef> postTransformClassDef(core::Context ctx, unique_ptr<ast::ClassDef> original) {
+        definitionsSeen++;
+        return original;
+    }
+
+    unique_ptr<ast::Assign> postTransformAssign(core::Context ctx, unique_ptr<ast::Assign> original) {
+        if (ast::isa_tree<ast::UnresolvedConstantLit>(original->lhs.get())) {
+            definitionsSeen++;
+        } else if (auto *ident = ast::cast_tree<ast::UnresolvedIdent>(original->lhs.get())) {
+            if (ident->kind != ast::UnresolvedIdent::Local) {
+                definitionsSeen++;
+            }
+        }
+        return original;
+    }
+};
+
+u4 computeOutlineHash(const core::GlobalState &gs, const unique_ptr<ast::Expression> &tree) {
+    MethodBodyStripper stripper;
+    auto stripped = ast::TreeMap::apply(core::Context(gs, core::Symbols::root()), stripper, tree->deepCopy());
+    // The printed form carries names, structure, and literals but no locations, so edits that only
+    // move definitions around on the page still compare equal.
+    auto hash = core::_hash(stripped->toStringWithTabs(gs, 0));
+    return hash == 0 ? 1 : hash;
+}
+
 core::UsageHash getAllNames(const core::GlobalState &gs, unique_ptr<ast::Expression> &tree) {
     AllNamesCollector collector;
     tree = ast::TreeMap::apply(core::Context(gs, core::Symbols::root()), collector, move(tree));
@@ -1110,7 +2150,8 @@ core::UsageHash getAllNames(const core::GlobalState &gs, unique_ptr<ast::Express
     return move(collector.acc);
 };
 
-core::FileHash computeFileHash(shared_ptr<core::File> forWhat, spdlog::logger &logger) {
+core::FileHash computeFileHash(shared_ptr<core::File> forWhat, spdlog::logger &logger,
+                               const core::FileHash *previous) {
     Timer timeit(logger, "computeFileHash");
     const static options::Options emptyOpts{};
     unique_ptr<core::GlobalState> lgs = make_unique<core::GlobalState>((make_shared<core::ErrorQueue>(logger, logger)));
@@ -1128,11 +2169,63 @@ core::FileHash computeFileHash(shared_ptr<core::File> forWhat, spdlog::logger &l
 
     single.emplace_back(pipeline::indexOne(emptyOpts, *lgs, fref, kvstore));
     auto errs = lgs->errorQueue->drainAllErrors();
+    auto outlineHash = computeOutlineHash(*lgs, single[0].tree);
     auto allNames = getAllNames(*lgs, single[0].tree);
+
+    if (previous != nullptr && previous->outlineHash != 0 && previous->outlineHash == outlineHash) {
+        // The edit stayed within method bodies, so the definitions hash cannot have changed; carry
+        // it over instead of paying for a resolver run and a symbol-table walk.
+        prodCounterInc("lsp.file_hash.outline_reused");
+        core::FileHash res;
+        res.outlineHash = outlineHash;
+        res.definitions = previous->definitions;
+        res.usages = move(allNames);
+        return res;
+    }
+
     auto workers = WorkerPool::create(0, lgs->tracer());
     pipeline::resolve(lgs, move(single), emptyOpts, *workers, true);
 
-    return {move(*lgs->hash()), move(allNames)};
+    return {outlineHash, move(*lgs->hash()), move(allNames)};
+}
+
+void printTimingReport(const core::GlobalState &gs, KeyValueStore *kvstore, spdlog::logger &logger, int limit) {
+    auto &ledger = fileTimingLedger();
+    absl::MutexLock lock(&ledger.mtx);
+    fmt::memory_buffer buf;
+    fmt::format_to(buf, "Slowest files per phase:\n");
+    for (auto &[phase, perFile] : ledger.timings) {
+        vector<pair<u4, int64_t>> sorted(perFile.begin(), perFile.end());
+        fast_sort(sorted, [](const auto &lhs, const auto &rhs) -> bool { return lhs.second > rhs.second; });
+        if (sorted.size() > static_cast<size_t>(limit)) {
+            sorted.resize(limit);
+        }
+        fmt::format_to(buf, " {}\n", phase);
+        for (auto &[fileId, usec] : sorted) {
+            auto path = core::FileRef(fileId).data(gs).path();
+            string delta;
+            if (kvstore != nullptr) {
+                auto previous = kvstore->readString(fmt::format("FileTimings//{}//{}", phase, path));
+                int64_t previousUsec;
+                if (!previous.empty() && absl::SimpleAtoi(previous, &previousUsec)) {
+                    delta = fmt::format(" ({:+.1f}ms vs last run)", (usec - previousUsec) / 1000.0);
+                }
+            }
+            fmt::format_to(buf, "  {:>10.1f}ms{} {}\n", usec / 1000.0, delta, path);
+        }
+    }
+    logger.warn("{}", to_string(buf));
+
+    if (kvstore != nullptr) {
+        // Persist every file's timing, not just the printed ones, so next run's deltas cover
+        // whatever happens to be slowest then.
+        for (auto &[phase, perFile] : ledger.timings) {
+            for (auto &[fileId, usec] : perFile) {
+                auto path = core::FileRef(fileId).data(gs).path();
+                kvstore->writeString(fmt::format("FileTimings//{}//{}", phase, path), to_string(usec));
+            }
+        }
+    }
 }
 
 } // namespace sorbet::realmain::pipeline
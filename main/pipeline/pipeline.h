@@ -8,6 +8,14 @@
 #include "core/NameHash.h"
 #include "main/options/options.h"
 
+namespace sorbet::definition_validator {
+struct ValidatorCache;
+}
+
+namespace sorbet::cfg {
+struct CFGScratch;
+}
+
 namespace sorbet::realmain::pipeline {
 ast::ParsedFile indexOne(const options::Options &opts, core::GlobalState &lgs, core::FileRef file,
                          std::unique_ptr<KeyValueStore> &kvstore);
@@ -22,21 +30,55 @@ std::vector<ast::ParsedFile> index(std::unique_ptr<core::GlobalState> &gs, std::
                                    const options::Options &opts, WorkerPool &workers,
                                    std::unique_ptr<KeyValueStore> &kvstore);
 
+// When a kvstore is passed, resolve maintains a second cache tier holding the post-namer symbol
+// table and trees, keyed by a manifest of every input file's path and content hash: a rerun over an
+// unchanged input set skips the namer walk entirely and is dominated by cache reads.
 ast::ParsedFilesOrCancelled resolve(std::unique_ptr<core::GlobalState> &gs, std::vector<ast::ParsedFile> what,
-                                    const options::Options &opts, WorkerPool &workers, bool skipConfigatron = false);
+                                    const options::Options &opts, WorkerPool &workers, bool skipConfigatron = false,
+                                    KeyValueStore *kvstore = nullptr);
 
+// When `containsNewDefinitions` is set, `what` is allowed to introduce definitions that no previous
+// resolver run has seen (e.g. a freshly added RBI file); the global finalization passes then run
+// over the newly created symbols. The default assumes the definitions existed before.
 std::vector<ast::ParsedFile> incrementalResolve(core::GlobalState &gs, std::vector<ast::ParsedFile> what,
-                                                const options::Options &opts);
+                                                const options::Options &opts, WorkerPool &workers,
+                                                bool containsNewDefinitions = false);
 
 std::vector<ast::ParsedFile> name(core::GlobalState &gs, std::vector<ast::ParsedFile> what,
                                   const options::Options &opts, bool skipConfigatron = false);
 
+// When `sigSuggestionsDeferred` is non-null, it collects the files whose sig-suggestion budget
+// (--sig-suggestion-budget-ms) ran out before every suggestion was computed, so the caller can
+// retry them later (the LSP reruns them while idle).
 ast::ParsedFilesOrCancelled typecheck(std::unique_ptr<core::GlobalState> &gs, std::vector<ast::ParsedFile> what,
-                                      const options::Options &opts, WorkerPool &workers);
+                                      const options::Options &opts, WorkerPool &workers,
+                                      KeyValueStore *kvstore = nullptr,
+                                      std::vector<core::FileRef> *sigSuggestionsDeferred = nullptr);
+
+// `validatorCache` amortizes definition validation work (ancestor abstract-method lists) across the
+// files a single thread typechecks; see definition_validator::ValidatorCache for its lifetime rules.
+// `cfgScratch` likewise lives for the thread's whole batch and lets CFG construction reuse its
+// working sets from method to method instead of reallocating them.
+// `cachedCfgs`, when non-null, is this file's CFG cache entry from a previous run over the identical
+// input set; pre-inference CFGs are deserialized from it instead of rebuilt. When `cfgCacheOut` is
+// non-null, the freshly built CFGs are recorded into it as a new cache entry instead.
+ast::ParsedFile typecheckOne(core::Context ctx, ast::ParsedFile resolved, const options::Options &opts,
+                             definition_validator::ValidatorCache &validatorCache, cfg::CFGScratch &cfgScratch,
+                             const u1 *cachedCfgs = nullptr, std::vector<u1> *cfgCacheOut = nullptr);
+
+// When `previous` is this file's hash before the edit, the expensive definitions hash is reused
+// whenever the cheap outline hash shows that no definition can have changed.
+core::FileHash computeFileHash(std::shared_ptr<core::File> forWhat, spdlog::logger &logger,
+                               const core::FileHash *previous = nullptr);
 
-ast::ParsedFile typecheckOne(core::Context ctx, ast::ParsedFile resolved, const options::Options &opts);
+// Cache key component identifying a file by path and content hash. Entries keyed by it stay valid
+// for as long as the file's contents do.
+std::string fileKey(const core::GlobalState &gs, core::FileRef file);
 
-core::FileHash computeFileHash(std::shared_ptr<core::File> forWhat, spdlog::logger &logger);
+// Prints the `limit` slowest files per phase as recorded during this run (--timing-report), with
+// deltas versus the timings persisted in `kvstore` by the previous run, then persists the current
+// timings for the next one. Must run on the thread that created `kvstore`.
+void printTimingReport(const core::GlobalState &gs, KeyValueStore *kvstore, spdlog::logger &logger, int limit);
 
 core::StrictLevel decideStrictLevel(const core::GlobalState &gs, const core::FileRef file,
                                     const options::Options &opts);
@@ -25,8 +25,47 @@ class CFG;
 }
 
 namespace pipeline::semantic_extension {
+
+/**
+ * Opaque per-worker accumulator for batched collection during typecheck. Extensions subclass this
+ * to hold whatever their hooks gather; the pipeline never looks inside, it only moves batches from
+ * worker threads back to the driver thread. A batch handed to a worker that ends up processing no
+ * files is destroyed without ever reaching consumeTypecheckBatch.
+ */
+class TypecheckBatch {
+public:
+    virtual ~TypecheckBatch() = default;
+};
+
 class SemanticExtension {
 public:
+    // Phase callbacks, both invoked on the driver thread: typecheckBegin before any file is queued
+    // for CFG+inference, typecheckEnd after every worker batch has been consumed.
+    virtual void typecheckBegin(const core::GlobalState &) const {}
+    virtual void typecheckEnd(const core::GlobalState &) const {}
+
+    // Batched collection. Each typecheck worker requests one private batch up front, the per-method
+    // and per-file hooks below write into it without synchronization, and finished batches are
+    // folded back on the driver thread one at a time — the same shape Counters uses to aggregate
+    // per-thread counter state. Extensions that buffer through a batch hold no mutex in any hook
+    // and scale with the worker pool by construction. Returning nullptr (the default) opts out;
+    // the hooks then see a null batch.
+    virtual std::unique_ptr<TypecheckBatch> newTypecheckBatch(const core::GlobalState &) const {
+        return nullptr;
+    }
+    virtual void consumeTypecheckBatch(const core::GlobalState &, std::unique_ptr<TypecheckBatch>) const {}
+
+    // Batch-aware hooks, called by the pipeline. They default to the legacy batchless hooks so
+    // existing extensions keep working unchanged; extensions adopting batched collection override
+    // these instead.
+    virtual void typecheck(const core::GlobalState &gs, cfg::CFG &cfg, std::unique_ptr<ast::MethodDef> &m,
+                           TypecheckBatch *) const {
+        typecheck(gs, cfg, m);
+    }
+    virtual void finishTypecheckFile(const core::GlobalState &gs, const core::FileRef &file, TypecheckBatch *) const {
+        finishTypecheckFile(gs, file);
+    }
+
     virtual void finishTypecheckFile(const core::GlobalState &, const core::FileRef &) const = 0;
     virtual void typecheck(const core::GlobalState &, cfg::CFG &, std::unique_ptr<ast::MethodDef> &) const = 0;
     virtual void run(core::MutableContext &, ast::ClassDef *) const = 0;
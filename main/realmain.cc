@@ -11,10 +11,17 @@
 #include "main/autogen/autoloader.h"
 #include "main/autogen/subclasses.h"
 #include "main/lsp/lsp.h"
+#include "main/lsp/wrapper.h"
 #endif
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "common/FileOps.h"
+#include "common/Profiler.h"
 #include "common/Timer.h"
 #include "common/sort.h"
 #include "core/Error.h"
@@ -32,8 +39,15 @@
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "version/version.h"
 
+#include <atomic>
+#include <cerrno>
 #include <csignal>
+#include <cstring>
+#include <map>
 #include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 namespace spd = spdlog;
 
@@ -180,14 +194,53 @@ struct AutogenResult {
         string msgpack;
         vector<string> classlist;
         optional<autogen::Subclasses::Map> subclasses;
+        // True when the above came from the KeyValueStore rather than a fresh Autogen::generate.
+        bool cached = false;
     };
     CounterState counters;
     vector<pair<int, Serialized>> prints;
     unique_ptr<autogen::DefTree> defTree = make_unique<autogen::DefTree>();
+    // With --autogen-msgpack-sharded: the shard this worker streamed its msgpack output to, or -1
+    // if it produced none.
+    int msgpackShardId = -1;
+    string msgpackShardPath;
 };
 
+// Cached autogen outputs are stored with a one-byte marker so that an empty output remains
+// distinguishable from a cache miss.
+bool readCachedAutogenEntry(KeyValueStore &kvstore, const string &key, string &out) {
+    auto val = kvstore.readString(key);
+    if (val.empty()) {
+        return false;
+    }
+    out = string(val.substr(1));
+    return true;
+}
+
+// Populates `serialized` for every enabled print kind from the cache. Returns false (leaving
+// `serialized` in an unspecified state) if any of them is missing.
+bool readAutogenCache(core::Context ctx, KeyValueStore &kvstore, const string &cachePrefix, core::FileRef file,
+                      const options::Options &opts, AutogenResult::Serialized &serialized) {
+    auto base = absl::StrCat(cachePrefix, pipeline::fileKey(ctx.state, file));
+    if (opts.print.Autogen.enabled && !readCachedAutogenEntry(kvstore, absl::StrCat(base, "//str"), serialized.strval)) {
+        return false;
+    }
+    if (opts.print.AutogenMsgPack.enabled &&
+        !readCachedAutogenEntry(kvstore, absl::StrCat(base, "//msgpack"), serialized.msgpack)) {
+        return false;
+    }
+    if (opts.print.AutogenClasslist.enabled) {
+        string classlist;
+        if (!readCachedAutogenEntry(kvstore, absl::StrCat(base, "//classlist"), classlist)) {
+            return false;
+        }
+        serialized.classlist = absl::StrSplit(classlist, '\n', absl::SkipEmpty());
+    }
+    return true;
+}
+
 void runAutogen(core::Context ctx, options::Options &opts, const autogen::AutoloaderConfig &autoloaderCfg,
-                WorkerPool &workers, vector<ast::ParsedFile> &indexed) {
+                WorkerPool &workers, vector<ast::ParsedFile> &indexed, const unique_ptr<KeyValueStore> &kvstore) {
     Timer timeit(logger, "autogen");
 
     auto resultq = make_shared<BlockingBoundedQueue<AutogenResult>>(indexed.size());
@@ -196,7 +249,23 @@ void runAutogen(core::Context ctx, options::Options &opts, const autogen::Autolo
         fileq->push(move(i), 1);
     }
 
-    workers.multiplexJob("runAutogen", [&ctx, &opts, &indexed, &autoloaderCfg, fileq, resultq]() {
+    const bool shardedMsgpack = opts.print.AutogenMsgPack.enabled && opts.autogenMsgpackSharded;
+    auto shardCounter = make_shared<atomic<int>>(0);
+
+    // The autoloader and subclasses outputs consume the generated ParsedFile itself, so per-file
+    // caching only applies when neither is requested.
+    KeyValueStore *kvstorePtr = kvstore.get();
+    const bool cacheUsable =
+        kvstorePtr != nullptr && !opts.print.AutogenAutoloader.enabled && !opts.print.AutogenSubclasses.enabled;
+    string cachePrefix;
+    if (cacheUsable) {
+        // Autogen's references resolve against the whole symbol table, so entries are keyed on the
+        // hierarchy hash alongside each file's content hash (via pipeline::fileKey).
+        cachePrefix = absl::StrCat("AutogenOutput//", opts.autogenVersion, "//", ctx.state.hash()->hierarchyHash, "//");
+    }
+
+    workers.multiplexJob("runAutogen", [&ctx, &opts, &indexed, &autoloaderCfg, fileq, resultq, shardedMsgpack,
+                                        shardCounter, kvstorePtr, cacheUsable, cachePrefix]() {
         AutogenResult out;
         int n = 0;
         {
@@ -209,31 +278,57 @@ void runAutogen(core::Context ctx, options::Options &opts, const autogen::Autolo
                 if (tree.file.data(ctx).isRBI()) {
                     continue;
                 }
-                auto pf = autogen::Autogen::generate(ctx, move(tree));
-                tree = move(pf.tree);
-
                 AutogenResult::Serialized serialized;
-                if (opts.print.Autogen.enabled) {
-                    Timer timeit(logger, "autogenToString");
-                    serialized.strval = pf.toString(ctx);
+                if (cacheUsable && readAutogenCache(ctx, *kvstorePtr, cachePrefix, tree.file, opts, serialized)) {
+                    prodCounterInc("autogen.cache.hit");
+                    serialized.cached = true;
+                } else {
+                    if (cacheUsable) {
+                        prodCounterInc("autogen.cache.miss");
+                    }
+                    auto pf = autogen::Autogen::generate(ctx, move(tree));
+                    tree = move(pf.tree);
+
+                    if (opts.print.Autogen.enabled) {
+                        Timer timeit(logger, "autogenToString");
+                        serialized.strval = pf.toString(ctx);
+                    }
+                    if (opts.print.AutogenMsgPack.enabled) {
+                        Timer timeit(logger, "autogenToMsgpack");
+                        serialized.msgpack = pf.toMsgpack(ctx, opts.autogenVersion);
+                    }
+                    if (opts.print.AutogenClasslist.enabled) {
+                        Timer timeit(logger, "autogenClasslist");
+                        serialized.classlist = pf.listAllClasses(ctx);
+                    }
+                    if (opts.print.AutogenSubclasses.enabled) {
+                        Timer timeit(logger, "autogenSubclasses");
+                        serialized.subclasses = autogen::Subclasses::listAllSubclasses(
+                            ctx, pf, opts.autogenSubclassesAbsoluteIgnorePatterns,
+                            opts.autogenSubclassesRelativeIgnorePatterns);
+                    }
+                    if (opts.print.AutogenAutoloader.enabled) {
+                        Timer timeit(logger, "autogenNamedDefs");
+                        autogen::DefTreeBuilder::addParsedFileDefinitions(ctx, autoloaderCfg, out.defTree, pf);
+                    }
                 }
-                if (opts.print.AutogenMsgPack.enabled) {
-                    Timer timeit(logger, "autogenToMsgpack");
-                    serialized.msgpack = pf.toMsgpack(ctx, opts.autogenVersion);
-                }
-                if (opts.print.AutogenClasslist.enabled) {
-                    Timer timeit(logger, "autogenClasslist");
-                    serialized.classlist = pf.listAllClasses(ctx);
-                }
-                if (opts.print.AutogenSubclasses.enabled) {
-                    Timer timeit(logger, "autogenSubclasses");
-                    serialized.subclasses =
-                        autogen::Subclasses::listAllSubclasses(ctx, pf, opts.autogenSubclassesAbsoluteIgnorePatterns,
-                                                               opts.autogenSubclassesRelativeIgnorePatterns);
-                }
-                if (opts.print.AutogenAutoloader.enabled) {
-                    Timer timeit(logger, "autogenNamedDefs");
-                    autogen::DefTreeBuilder::addParsedFileDefinitions(ctx, autoloaderCfg, out.defTree, pf);
+
+                if (opts.print.AutogenMsgPack.enabled && shardedMsgpack) {
+                    // Claim a shard on first output and stream straight to it, rather than
+                    // funneling every worker's output through the single serial print below.
+                    // Pops from fileq are monotonic, so each shard is ordered by file id.
+                    if (out.msgpackShardId == -1) {
+                        out.msgpackShardId = shardCounter->fetch_add(1);
+                        out.msgpackShardPath =
+                            fmt::format("{}.shard.{}", opts.print.AutogenMsgPack.outputPath, out.msgpackShardId);
+                        FileOps::write(out.msgpackShardPath, serialized.msgpack);
+                    } else {
+                        FileOps::append(out.msgpackShardPath, serialized.msgpack);
+                    }
+                    if (!cacheUsable || serialized.cached) {
+                        // Only fresh output still needs the blob, for the main thread's cache write.
+                        serialized.msgpack.clear();
+                    }
                 }
 
                 out.prints.emplace_back(make_pair(idx, serialized));
@@ -247,6 +342,7 @@ void runAutogen(core::Context ctx, options::Options &opts, const autogen::Autolo
     autogen::DefTree root;
     AutogenResult out;
     vector<pair<int, AutogenResult::Serialized>> merged;
+    vector<pair<int, string>> msgpackShards;
     for (auto res = resultq->wait_pop_timed(out, chrono::seconds{1}, *logger); !res.done();
          res = resultq->wait_pop_timed(out, chrono::seconds{1}, *logger)) {
         if (!res.gotItem()) {
@@ -254,6 +350,9 @@ void runAutogen(core::Context ctx, options::Options &opts, const autogen::Autolo
         }
         counterConsume(move(out.counters));
         merged.insert(merged.end(), make_move_iterator(out.prints.begin()), make_move_iterator(out.prints.end()));
+        if (out.msgpackShardId != -1) {
+            msgpackShards.emplace_back(make_pair(out.msgpackShardId, move(out.msgpackShardPath)));
+        }
         if (opts.print.AutogenAutoloader.enabled) {
             Timer timeit(logger, "autogenAutoloaderDefTreeMerge");
             root = autogen::DefTreeBuilder::merge(ctx, move(root), move(*out.defTree));
@@ -261,14 +360,46 @@ void runAutogen(core::Context ctx, options::Options &opts, const autogen::Autolo
     }
     fast_sort(merged, [](const auto &lhs, const auto &rhs) -> bool { return lhs.first < rhs.first; });
 
+    if (cacheUsable) {
+        // Writes may only happen on the thread that created the KeyValueStore, so fresh outputs are
+        // committed here rather than by the workers that produced them.
+        Timer timeit(logger, "autogenCacheCommit");
+        for (auto &elem : merged) {
+            auto &serialized = elem.second;
+            if (serialized.cached) {
+                continue;
+            }
+            auto base = absl::StrCat(cachePrefix, pipeline::fileKey(ctx.state, indexed[elem.first].file));
+            if (opts.print.Autogen.enabled) {
+                kvstorePtr->writeString(absl::StrCat(base, "//str"), absl::StrCat("1", serialized.strval));
+            }
+            if (opts.print.AutogenMsgPack.enabled) {
+                kvstorePtr->writeString(absl::StrCat(base, "//msgpack"), absl::StrCat("1", serialized.msgpack));
+            }
+            if (opts.print.AutogenClasslist.enabled) {
+                kvstorePtr->writeString(absl::StrCat(base, "//classlist"),
+                                        absl::StrCat("1", absl::StrJoin(serialized.classlist, "\n")));
+            }
+        }
+    }
+
     for (auto &elem : merged) {
         if (opts.print.Autogen.enabled) {
             opts.print.Autogen.print(elem.second.strval);
         }
-        if (opts.print.AutogenMsgPack.enabled) {
+        if (opts.print.AutogenMsgPack.enabled && !shardedMsgpack) {
             opts.print.AutogenMsgPack.print(elem.second.msgpack);
         }
     }
+    if (shardedMsgpack) {
+        // The configured output path receives a manifest of the shard files written above.
+        fast_sort(msgpackShards, [](const auto &lhs, const auto &rhs) -> bool { return lhs.first < rhs.first; });
+        string manifest;
+        for (auto &shard : msgpackShards) {
+            absl::StrAppend(&manifest, shard.second, "\n");
+        }
+        opts.print.AutogenMsgPack.print(manifest);
+    }
     if (opts.print.AutogenAutoloader.enabled) {
         {
             Timer timeit(logger, "autogenAutoloaderPrune");
@@ -316,6 +447,235 @@ void runAutogen(core::Context ctx, options::Options &opts, const autogen::Autolo
             "{}\n", fmt::join(serializedDescendantsMap.begin(), serializedDescendantsMap.end(), "\n"));
     }
 }
+
+// Daemon mode: a long-lived server (--daemon) holds the fully-loaded GlobalState and indexed trees
+// and reuses the LSP fast/slow path machinery (via LSPWrapper) to typecheck edits, so warm runs pay
+// only for the files that changed. Thin clients (--daemon-client) speak a line-based protocol over
+// a unix socket: they send one changed path per line (relative to the daemon's input directory),
+// and receive one `path:line:column: message` line per error followed by a final `errors: N` line.
+// A request line of `shutdown` terminates the daemon after the reply.
+
+bool writeAllToSocket(int fd, string_view data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        auto result = write(fd, data.data() + written, data.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+string readAllFromSocket(int fd) {
+    string data;
+    char buf[4096];
+    while (true) {
+        auto result = read(fd, buf, sizeof(buf));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return data;
+        }
+        data.append(buf, result);
+    }
+}
+
+int openDaemonServerSocket(const string &path) {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        logger->error("Daemon socket path is too long: {}", path);
+        throw options::EarlyReturnWithCode(1);
+    }
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        logger->error("Unable to create daemon socket: {}", strerror(errno));
+        throw options::EarlyReturnWithCode(1);
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    // Clean up a stale socket file left behind by a previous daemon.
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        logger->error("Unable to listen on daemon socket {}: {}", path, strerror(errno));
+        close(fd);
+        throw options::EarlyReturnWithCode(1);
+    }
+    return fd;
+}
+
+// Folds any textDocument/publishDiagnostics notifications in `responses` into `errorsByUri`.
+// Diagnostics are published per file with full replacement semantics, so an empty list clears the
+// file's entry.
+void updateDaemonErrors(map<string, vector<string>> &errorsByUri, string_view rootUri,
+                        vector<unique_ptr<lsp::LSPMessage>> &responses) {
+    for (auto &msg : responses) {
+        if (!msg->isNotification() || msg->method() != lsp::LSPMethod::TextDocumentPublishDiagnostics) {
+            continue;
+        }
+        auto paramsPtr = get_if<unique_ptr<lsp::PublishDiagnosticsParams>>(&msg->asNotification().params);
+        if (paramsPtr == nullptr || *paramsPtr == nullptr) {
+            continue;
+        }
+        auto &params = **paramsPtr;
+        if (params.diagnostics.empty()) {
+            errorsByUri.erase(params.uri);
+            continue;
+        }
+        string path = params.uri;
+        if (absl::StartsWith(path, rootUri)) {
+            path = path.substr(rootUri.size());
+            if (!path.empty() && path.front() == '/') {
+                path = path.substr(1);
+            }
+        }
+        auto &errors = errorsByUri[params.uri];
+        errors.clear();
+        for (auto &diagnostic : params.diagnostics) {
+            errors.emplace_back(fmt::format("{}:{}:{}: {}", path, diagnostic->range->start->line + 1,
+                                            diagnostic->range->start->character + 1, diagnostic->message));
+        }
+    }
+}
+
+int runDaemon(unique_ptr<core::GlobalState> gs, options::Options opts) {
+    if (opts.rawInputDirNames.size() != 1) {
+        logger->error("`{}` requires a single input directory", "--daemon");
+        return 1;
+    }
+    auto socketPath = opts.daemonSocketPath;
+    auto rootPath = opts.rawInputDirNames.front();
+    auto rootUri = fmt::format("file://{}", rootPath);
+
+    auto serverFd = openDaemonServerSocket(socketPath);
+    gs->errorQueue->ignoreFlushes = true;
+    lsp::LSPWrapper wrapper(move(gs), move(opts), logger, false);
+
+    // Handshake: the equivalent of an editor connecting. The Initialized notification triggers the
+    // initial slow path over the whole project, which is the warmup cost clients no longer pay.
+    map<string, vector<string>> errorsByUri;
+    {
+        Timer timeit(logger, "daemon.initial_typecheck");
+        auto initializeParams =
+            make_unique<lsp::InitializeParams>(rootPath, rootUri, make_unique<lsp::ClientCapabilities>());
+        wrapper.getLSPResponsesFor(make_unique<lsp::LSPMessage>(
+            make_unique<lsp::RequestMessage>("2.0", 0, lsp::LSPMethod::Initialize, move(initializeParams))));
+        auto responses = wrapper.getLSPResponsesFor(make_unique<lsp::LSPMessage>(
+            make_unique<lsp::NotificationMessage>("2.0", lsp::LSPMethod::Initialized, make_unique<lsp::InitializedParams>())));
+        updateDaemonErrors(errorsByUri, rootUri, responses);
+    }
+    logger->info("Sorbet daemon listening on {}", socketPath);
+
+    bool shutdownRequested = false;
+    while (!shutdownRequested) {
+        auto clientFd = accept(serverFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logger->error("Unable to accept connection on daemon socket {}: {}", socketPath, strerror(errno));
+            break;
+        }
+        Timer timeit(logger, "daemon.request");
+        auto request = readAllFromSocket(clientFd);
+        vector<string> changedFiles;
+        for (string_view line : absl::StrSplit(request, '\n', absl::SkipEmpty())) {
+            if (line == "shutdown") {
+                shutdownRequested = true;
+            } else {
+                // The preprocessor treats these like Watchman updates and prepends the root path;
+                // accept paths given relative either to the input directory or to the working
+                // directory.
+                if (absl::StartsWith(line, rootPath) && line.size() > rootPath.size() &&
+                    line[rootPath.size()] == '/') {
+                    line = line.substr(rootPath.size() + 1);
+                }
+                changedFiles.emplace_back(line);
+            }
+        }
+        if (!changedFiles.empty()) {
+            auto watchmanResponse = make_unique<lsp::WatchmanQueryResponse>("", "", false, move(changedFiles));
+            auto responses =
+                wrapper.getLSPResponsesFor(make_unique<lsp::LSPMessage>(make_unique<lsp::NotificationMessage>(
+                    "2.0", lsp::LSPMethod::SorbetWatchmanFileChange, move(watchmanResponse))));
+            updateDaemonErrors(errorsByUri, rootUri, responses);
+        }
+        string reply;
+        int errorCount = 0;
+        for (auto &[uri, errors] : errorsByUri) {
+            for (auto &error : errors) {
+                absl::StrAppend(&reply, error, "\n");
+                errorCount++;
+            }
+        }
+        absl::StrAppend(&reply, "errors: ", errorCount, "\n");
+        if (!writeAllToSocket(clientFd, reply)) {
+            logger->error("Unable to write reply to daemon client: {}", strerror(errno));
+        }
+        close(clientFd);
+    }
+    close(serverFd);
+    unlink(socketPath.c_str());
+    return 0;
+}
+
+int runDaemonClient(const options::Options &opts) {
+    struct sockaddr_un addr;
+    const auto &path = opts.daemonClientSocketPath;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        logger->error("Daemon socket path is too long: {}", path);
+        return 1;
+    }
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        logger->error("Unable to create daemon socket: {}", strerror(errno));
+        return 1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+        logger->error("Unable to connect to daemon on {}: {}. Is one running (`sorbet --daemon {}`)?", path,
+                      strerror(errno), path);
+        close(fd);
+        return 1;
+    }
+    string request;
+    for (auto &file : opts.rawInputFileNames) {
+        absl::StrAppend(&request, file, "\n");
+    }
+    bool sent = writeAllToSocket(fd, request);
+    // Half-close signals the end of the request; the daemon replies until EOF.
+    shutdown(fd, SHUT_WR);
+    if (!sent) {
+        logger->error("Unable to send changed-file list to daemon: {}", strerror(errno));
+        close(fd);
+        return 1;
+    }
+    auto reply = readAllFromSocket(fd);
+    close(fd);
+
+    // The last line of the reply is `errors: N`; everything before it is the error list.
+    constexpr string_view statusPrefix = "errors: ";
+    auto statusPos = reply.rfind(statusPrefix);
+    int errorCount = 0;
+    if (statusPos == string::npos || (statusPos != 0 && reply[statusPos - 1] != '\n') ||
+        !absl::SimpleAtoi(absl::StripAsciiWhitespace(string_view(reply).substr(statusPos + statusPrefix.size())),
+                          &errorCount)) {
+        logger->error("Malformed reply from daemon:\n{}", reply);
+        return 1;
+    }
+    fmt::print("{}", reply.substr(0, statusPos));
+    if (errorCount > 0 && !opts.noErrorCount) {
+        logger->error("Errors: {}", errorCount);
+    }
+    return errorCount == 0 ? 0 : 1;
+}
 #endif
 
 int realmain(int argc, char *argv[]) {
@@ -338,6 +698,11 @@ int realmain(int argc, char *argv[]) {
     while (opts.waitForDebugger && !stopInDebugger()) {
         // spin
     }
+    if (!opts.webTraceConvert.empty()) {
+        auto data = FileOps::read(opts.webTraceConvert);
+        fmt::print("{}", web_tracer_framework::Tracing::binaryTracesToJson(data));
+        return 0;
+    }
     if (opts.stdoutHUPHack) {
         startHUPMonitor();
     }
@@ -399,6 +764,18 @@ int realmain(int argc, char *argv[]) {
                          "or set SORBET_SILENCE_DEV_MESSAGE=1 in your shell environment.\n");
         }
     }
+#ifndef SORBET_REALMAIN_MIN
+    if (!opts.daemonClientSocketPath.empty()) {
+        // Ship the changed-file list to a warm daemon instead of typechecking here.
+        return runDaemonClient(opts);
+    }
+#endif
+
+    if (!opts.profileFlamegraphFile.empty()) {
+        // Start before payload load so startup cost shows up in the profile too.
+        Profiler::start(1000);
+    }
+
     unique_ptr<WorkerPool> workers = WorkerPool::create(opts.threads, *logger);
 
     unique_ptr<core::GlobalState> gs =
@@ -411,19 +788,52 @@ int realmain(int argc, char *argv[]) {
     logger->trace("building initial global state");
     unique_ptr<KeyValueStore> kvstore;
     if (!opts.cacheDir.empty()) {
-        kvstore = make_unique<KeyValueStore>(Version::full_version_string, opts.cacheDir,
-                                             opts.skipRewriterPasses ? "nodsl" : "default");
+        // Flags that change the shape of cached trees get their own flavor so differently-shaped
+        // entries never mix.
+        string cacheFlavor = opts.skipRewriterPasses ? "nodsl" : "default";
+        if (opts.stripUntypedMethodBodies) {
+            cacheFlavor += "-outline";
+        }
+        kvstore = make_unique<KeyValueStore>(Version::full_version_string, opts.cacheDir, move(cacheFlavor),
+                                             opts.cacheRemoteDir);
+        if (!opts.cacheImportDir.empty()) {
+            // Warm start: overlay a cache published for an upstream commit (the wrapper picks the
+            // artifact, typically by merge-base). Entries are content-addressed, so everything
+            // unchanged since that commit hits as if this machine had typechecked it.
+            Timer timeit(logger, "cache_import");
+            auto imported = kvstore->importDatabase(opts.cacheImportDir);
+            logger->debug("Imported {} cache entries from {}", imported, opts.cacheImportDir);
+        }
+    }
+    if (!opts.loadResolvedState.empty()) {
+        // Worker machine in a distributed run: the state written by a coordinator's
+        // --store-resolved-state already contains the payload plus every workspace file, name and
+        // symbol post-resolve.
+        Timer timeit(logger, "load_resolved_state");
+        auto data = FileOps::read(opts.loadResolvedState);
+        core::serialize::Serializer::loadGlobalState(*gs, reinterpret_cast<const u1 *>(data.data()));
+    } else {
+        payload::createInitialGlobalState(gs, opts, kvstore);
     }
-    payload::createInitialGlobalState(gs, opts, kvstore);
     if (opts.silenceErrors) {
         gs->silenceErrors = true;
     }
+    if (opts.dedupErrors) {
+        gs->errorQueue->dedupErrors = true;
+    }
+    if (opts.binaryErrorFormat) {
+        gs->errorQueue->binaryErrors = true;
+    }
     if (opts.autocorrect) {
         gs->autocorrect = true;
     }
+    if (opts.pruneDeadCfgBranches) {
+        gs->pruneDeadCfgBranches = true;
+    }
     if (opts.suggestRuntimeProfiledType) {
         gs->suggestRuntimeProfiledType = true;
     }
+    gs->sigSuggestionBudgetMs = opts.sigSuggestionBudgetMs;
     if (opts.print.isAutogen()) {
         gs->runningUnderAutogen = true;
     }
@@ -433,6 +843,9 @@ int realmain(int argc, char *argv[]) {
     if (opts.sleepInSlowPath) {
         gs->sleepInSlowPath = true;
     }
+    if (opts.widenUnionsAbove > 0) {
+        gs->lubUnionWidenThreshold = opts.widenUnionsAbove;
+    }
     if (opts.reserveMemKiB > 0) {
         gs->reserveMemory(opts.reserveMemKiB);
     }
@@ -447,6 +860,7 @@ int realmain(int argc, char *argv[]) {
         gs->addDslPlugin(plugin.first, plugin.second);
     }
     gs->dslRubyExtraArgs = opts.dslRubyExtraArgs;
+    gs->dslPluginsPersistent = opts.dslPluginsPersistent;
     if (!opts.stripeMode) {
         // Definitions in multiple locations interact poorly with autoloader this error is enforced in Stripe code.
         if (opts.errorCodeWhiteList.empty()) {
@@ -465,16 +879,55 @@ int realmain(int argc, char *argv[]) {
                       "If you're developing an LSP extension to some editor, make sure to run sorbet with `-v` flag,"
                       "it will enable outputing the LSP session to stderr(`Write: ` and `Read: ` log lines)",
                       Version::full_version_string);
+        // Release the cache before the loop starts: an LMDB environment may only be opened once per
+        // process, and the typechecker reopens the store on its own thread so it can write
+        // workspace snapshots (writes are restricted to the creating thread). Nothing has been
+        // written through this handle in LSP mode, so plain destruction is safe.
+        kvstore = nullptr;
         auto output = make_shared<lsp::LSPStdout>(logger);
         lsp::LSPLoop loop(move(gs), make_shared<lsp::LSPConfiguration>(opts, output, *workers, logger));
         gs = loop.runLSP(STDIN_FILENO).value_or(nullptr);
+#endif
+    } else if (!opts.daemonSocketPath.empty()) {
+#ifndef SORBET_REALMAIN_MIN
+        return runDaemon(move(gs), move(opts));
 #endif
     } else {
         Timer timeall(logger, "wall_time");
         vector<core::FileRef> inputFiles;
         logger->trace("Files: ");
 
-        { inputFiles = pipeline::reserveFiles(gs, opts.inputFileNames); }
+        const bool resolvedStateLoaded = !opts.loadResolvedState.empty();
+        if (resolvedStateLoaded) {
+            // The loaded file table supplies the inputs; pick this machine's shard of it.
+            for (u4 i = 1; i < gs->filesUsed(); i++) {
+                core::FileRef fref(i);
+                if (fref.data(*gs).sourceType != core::File::Type::Normal) {
+                    continue;
+                }
+                if (opts.typecheckShardCount > 0 && i % opts.typecheckShardCount != opts.typecheckShardIndex) {
+                    continue;
+                }
+                inputFiles.emplace_back(fref);
+            }
+        } else {
+            inputFiles = pipeline::reserveFiles(gs, opts.inputFileNames);
+        }
+
+        if (opts.reserveMemKiB == 0 && !resolvedStateLoaded) {
+            // Prefer the previous run's exact final table counts from the cache; fall back to
+            // pre-sizing from the file count so that big cold runs do not pay a cascade of
+            // doubling rehashes while indexing (~16KiB of names and symbols per input file is a
+            // comfortable overestimate for typical Ruby sources). An explicit --reserve-mem-kib
+            // overrides both.
+            if (!payload::preallocateTables(*gs, kvstore) && inputFiles.size() > 1000) {
+                gs->reserveMemory(inputFiles.size() * 16);
+            }
+        }
+
+        // Capacity is settled now, whichever path above sized the tables, so advise the kernel to
+        // back them with 2MiB pages before namer starts hammering them with random accesses.
+        gs->adviseLargePages(opts.prefaultTables);
 
         {
             core::UnfreezeFileTable fileTableAccess(*gs);
@@ -494,7 +947,11 @@ int realmain(int argc, char *argv[]) {
 
         { indexed = pipeline::index(gs, inputFiles, opts, *workers, kvstore); }
 
-        payload::retainGlobalState(gs, opts, kvstore);
+        if (!resolvedStateLoaded) {
+            // Don't overwrite the warm-run name table with a fully resolved state; the next
+            // ordinary run expects the post-index shape.
+            payload::retainGlobalState(gs, opts, kvstore);
+        }
 
         if (gs->runningUnderAutogen) {
 #ifndef SORBET_REALMAIN_MIN
@@ -520,11 +977,39 @@ int realmain(int argc, char *argv[]) {
                 autoloaderCfg = autogen::AutoloaderConfig::enterConfig(*gs, opts.autoloaderConfig);
             }
 
-            runAutogen(ctx, opts, autoloaderCfg, *workers, indexed);
+            runAutogen(ctx, opts, autoloaderCfg, *workers, indexed, kvstore);
 #endif
         } else {
-            indexed = move(pipeline::resolve(gs, move(indexed), opts, *workers).result());
-            indexed = move(pipeline::typecheck(gs, move(indexed), opts, *workers).result());
+            if (resolvedStateLoaded) {
+                // Symbols already exist in the loaded state; the incremental passes re-bind this
+                // shard's trees to them, exactly as the LSP fast path does for edited files.
+                indexed = pipeline::incrementalResolve(*gs, move(indexed), opts, *workers);
+            } else {
+                indexed = move(pipeline::resolve(gs, move(indexed), opts, *workers, false, kvstore.get()).result());
+                if (!opts.storeResolvedState.empty()) {
+                    Timer timeit(logger, "store_resolved_state");
+                    FileOps::write(opts.storeResolvedState.c_str(), core::serialize::Serializer::store(*gs));
+                }
+                if (opts.typecheckShardCount > 0) {
+                    // Index and resolve diagnostics covered every file above; only typecheck is
+                    // sharded. Worker machines that loaded a resolved state filtered their inputs
+                    // instead.
+                    vector<ast::ParsedFile> shard;
+                    for (auto &tree : indexed) {
+                        if (tree.file.id() % opts.typecheckShardCount == opts.typecheckShardIndex) {
+                            shard.emplace_back(move(tree));
+                        }
+                    }
+                    indexed = move(shard);
+                }
+            }
+            indexed = move(pipeline::typecheck(gs, move(indexed), opts, *workers, kvstore.get()).result());
+        }
+        if (opts.timingReport > 0) {
+            pipeline::printTimingReport(*gs, kvstore.get(), *logger, opts.timingReport);
+        }
+        if (kvstore) {
+            KeyValueStore::commit(move(kvstore));
         }
 
         if (opts.suggestTyped) {
@@ -586,6 +1071,16 @@ int realmain(int argc, char *argv[]) {
 #ifndef SORBET_REALMAIN_MIN
     addStandardMetrics();
 
+    if (Profiler::isRunning()) {
+        Profiler::stop();
+        prodCounterAdd("profiler.samples", Profiler::sampleCount());
+        try {
+            opts.fs->writeFile(opts.profileFlamegraphFile, Profiler::collapsed());
+        } catch (FileNotFoundException e) {
+            logger->error("Cannot write flamegraph file at `{}`", opts.profileFlamegraphFile);
+        }
+    }
+
     if (!opts.someCounters.empty()) {
         if (opts.enableCounters) {
             logger->error("Don't pass both --counters and --counter");
@@ -600,6 +1095,10 @@ int realmain(int argc, char *argv[]) {
         logger->debug("" + getCounterStatistics(Counters::ALL_COUNTERS));
     }
 
+    if (enforce_hit_counters) {
+        enforce_counters::dumpAll(*logger);
+    }
+
     auto counters = getAndClearThreadCounters();
 
     if (!opts.statsdHost.empty()) {
@@ -610,7 +1109,11 @@ int realmain(int argc, char *argv[]) {
         StatsD::submitCounters(counters, opts.statsdHost, opts.statsdPort, prefix + ".counters");
     }
     if (!opts.webTraceFile.empty()) {
-        web_tracer_framework::Tracing::storeTraces(counters, opts.webTraceFile);
+        if (opts.webTraceBinary) {
+            web_tracer_framework::Tracing::storeTracesBinary(counters, opts.webTraceFile);
+        } else {
+            web_tracer_framework::Tracing::storeTraces(counters, opts.webTraceFile);
+        }
     }
 
     if (!opts.metricsFile.empty()) {
@@ -959,13 +959,17 @@ private:
 };
 
 std::vector<ast::ParsedFile> Namer::run(core::MutableContext ctx, std::vector<ast::ParsedFile> trees) {
+    // This loop must stay single-threaded: NameInserter enters symbols into the shared symbol
+    // table, and symbol ids are handed out in discovery order, so the file order here is part of
+    // what keeps ids deterministic. Running the walks in parallel would take per-thread creation
+    // logs replayed in canonical order, plus SymbolRef substitution machinery akin to what
+    // GlobalSubstitution provides for names — neither of which exists today.
     NameInserter nameInserter;
     for (auto &tree : trees) {
         auto file = tree.file;
         try {
-            ast::ParsedFile ast;
             {
-                Timer timeit(ctx.state.tracer(), "naming", {{"file", (string)file.data(ctx).path()}});
+                Timer timeit(ctx.state.tracer(), "naming", {{"file", internDynamicName(file.data(ctx).path())}});
                 core::ErrorRegion errs(ctx.state, file);
                 tree.tree = ast::TreeMap::apply(ctx, nameInserter, std::move(tree.tree));
             }
@@ -27,28 +27,32 @@ using std::vector;
 namespace sorbet::parser {
 
 string Dedenter::dedent(string_view str) {
-    string out;
-    for (auto ch : str) {
-        if (spacesToRemove > 0) {
-            switch (ch) {
-                case ' ':
-                    spacesToRemove--;
-                    break;
-                case '\n':
-                    spacesToRemove = dedentLevel;
-                    break;
-                case '\t': {
-                    int indent = dedentLevel - spacesToRemove;
-                    spacesToRemove -= (8 - indent % 8);
-                    break;
-                }
-                default:
-                    Exception::raise("unexpected whitespace: '{}'", std::to_string(ch));
+    // Consume the indentation run. Only the leading whitespace of the piece (plus any blank lines
+    // inside it) can be removed — once the budget for the line is spent, nothing later in the
+    // piece is touched — so this loop examines at most the indent itself and the rest of the piece
+    // transfers as a single bulk copy below. Heredoc-dense generated files hand megabytes through
+    // here, which the old character-by-character append dominated.
+    size_t start = 0;
+    while (spacesToRemove > 0 && start < str.size()) {
+        char ch = str[start];
+        switch (ch) {
+            case ' ':
+                spacesToRemove--;
+                break;
+            case '\n':
+                spacesToRemove = dedentLevel;
+                break;
+            case '\t': {
+                int indent = dedentLevel - spacesToRemove;
+                spacesToRemove -= (8 - indent % 8);
+                break;
             }
-        } else {
-            out.push_back(ch);
+            default:
+                Exception::raise("unexpected whitespace: '{}'", std::to_string(ch));
         }
+        start++;
     }
+    string out(str.substr(start));
     if (!out.empty() && out.back() == '\n') {
         spacesToRemove = dedentLevel;
     }
@@ -9,6 +9,38 @@ using namespace std;
 
 namespace sorbet::parser {
 
+namespace {
+// Every node carries a one-word header recording whether it came from an arena, padded to keep the
+// node itself maximally aligned.
+constexpr size_t allocHeaderSize = alignof(std::max_align_t);
+} // namespace
+
+void *Node::operator new(std::size_t size) {
+    auto *arena = NodeArena::current();
+    char *mem;
+    if (arena != nullptr) {
+        mem = static_cast<char *>(arena->allocate(size + allocHeaderSize));
+    } else {
+        mem = static_cast<char *>(std::malloc(size + allocHeaderSize));
+        if (mem == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    *reinterpret_cast<uintptr_t *>(mem) = arena != nullptr ? 1 : 0;
+    return mem + allocHeaderSize;
+}
+
+void Node::operator delete(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto *mem = static_cast<char *>(ptr) - allocHeaderSize;
+    if (*reinterpret_cast<uintptr_t *>(mem) == 0) {
+        std::free(mem);
+    }
+    // Arena-backed nodes are reclaimed when the owning arena dies.
+}
+
 void Node::printTabs(fmt::memory_buffer &to, int count) const {
     int i = 0;
     while (i < count) {
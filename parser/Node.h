@@ -1,3 +1,4 @@
+#include "common/Arena.h"
 #include "common/common.h"
 #include "core/core.h"
 #include <memory>
@@ -5,12 +6,24 @@
 
 namespace sorbet::parser {
 
+class Node;
+
+// The bump allocator for parser::Node; see common/Arena.h for the mechanics. The pipeline installs
+// one per parse and drops it wholesale once desugar has consumed the parse tree.
+using NodeArena = sorbet::Arena<Node>;
+
 class Node {
 public:
     Node(core::Loc loc) : loc(loc) {
         ENFORCE(loc.exists(), "Location of parser node is none");
     }
     virtual ~Node() = default;
+
+    // Nodes bump-allocate out of the thread's current NodeArena when one is installed; otherwise
+    // they fall back to the heap. Arena-backed nodes are reclaimed wholesale when the owning arena
+    // dies, so operator delete is a no-op for them.
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
     virtual std::string toStringWithTabs(const core::GlobalState &gs, int tabs = 0) const = 0;
     std::string toString(const core::GlobalState &gs) const {
         return toStringWithTabs(gs);
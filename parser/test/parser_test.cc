@@ -41,6 +41,8 @@ TEST(ParserTest, TestDedent) { // NOLINT
         {2, "    hi"sv, "  hi"sv},
         {10, "  \t    hi"sv, "  hi"sv},
         {2, "  a\n   b\n  c\n"sv, "a\n   b\n  c\n"sv},
+        {2, " \n  blank line resets\n"sv, "blank line resets\n"sv},
+        {4, "  hi"sv, "hi"sv},
     };
     for (auto &tc : cases) {
         sorbet::parser::Dedenter dedent(tc.level);
@@ -48,3 +50,13 @@ TEST(ParserTest, TestDedent) { // NOLINT
         EXPECT_EQ(got, tc.out);
     }
 }
+
+TEST(ParserTest, TestDedentCarriesAcrossPieces) { // NOLINT
+    // Interpolated heredocs feed each string segment through the same Dedenter; a piece ending in
+    // a newline re-arms the indent removal for the next one.
+    sorbet::parser::Dedenter dedent(2);
+    EXPECT_EQ(dedent.dedent("  a\n"sv), "a\n");
+    EXPECT_EQ(dedent.dedent("  b"sv), "b");
+    EXPECT_EQ(dedent.dedent(" after interpolation\n"sv), " after interpolation\n");
+    EXPECT_EQ(dedent.dedent("  c\n"sv), "c\n");
+}
@@ -615,6 +615,15 @@ string fieldType(FieldType arg) {
     }
 }
 
+// Constructor parameter type for a field. Strings are taken by value (not const) and moved into the
+// const member, so a caller holding a temporary hands its buffer straight to the node.
+string ctorArgType(FieldType arg) {
+    if (arg == String) {
+        return "std::string";
+    }
+    return fieldType(arg);
+}
+
 void emitNodeHeader(ostream &out, NodeDef &node) {
     out << "class " << node.name << " final : public Node {" << '\n';
     out << "public:" << '\n';
@@ -622,17 +631,17 @@ void emitNodeHeader(ostream &out, NodeDef &node) {
     // generate constructor
     out << "    " << node.name << "(core::Loc loc";
     for (auto &arg : node.fields) {
-        out << ", " << fieldType(arg.type) << " " << arg.name;
+        out << ", " << ctorArgType(arg.type) << " " << arg.name;
     }
     out << ")" << '\n';
     out << "        : Node(loc)";
     for (auto &arg : node.fields) {
         out << ", " << arg.name << "(";
-        if (arg.type == Node || arg.type == NodeVec) {
+        if (arg.type == Node || arg.type == NodeVec || arg.type == String) {
             out << "std::move(";
         }
         out << arg.name;
-        if (arg.type == Node || arg.type == NodeVec) {
+        if (arg.type == Node || arg.type == NodeVec || arg.type == String) {
             out << ")";
         }
         out << ")";
@@ -1,4 +1,8 @@
 #include "payload/payload.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "common/Counters.h"
 #include "common/Timer.h"
 #include "core/serialize/serialize.h"
 #include "payload/binary/binary.h"
@@ -9,6 +13,22 @@ using namespace std;
 namespace sorbet::payload {
 
 constexpr string_view GLOBAL_STATE_KEY = "GlobalState"sv;
+constexpr string_view TABLE_STATS_KEY = "TableStats"sv;
+
+namespace {
+// The stats entry is `<symbolsUsed>:<namesUsed>` from the end of the previous run.
+bool parseTableStats(string_view stats, u4 &symbolCount, u4 &nameCount) {
+    vector<string_view> parts = absl::StrSplit(stats, ':');
+    return parts.size() == 2 && absl::SimpleAtoi(parts[0], &symbolCount) && absl::SimpleAtoi(parts[1], &nameCount);
+}
+
+// See setExternalNameTablePayload.
+const u1 *externalNameTablePayload = nullptr;
+} // namespace
+
+void setExternalNameTablePayload(const u1 *data) {
+    externalNameTablePayload = data;
+}
 
 void createInitialGlobalState(unique_ptr<core::GlobalState> &gs, const realmain::options::Options &options,
                               unique_ptr<KeyValueStore> &kvstore) {
@@ -31,7 +51,10 @@ void createInitialGlobalState(unique_ptr<core::GlobalState> &gs, const realmain:
         return;
     }
 
-    const u1 *const nameTablePayload = getNameTablePayload;
+    const u1 *nameTablePayload = externalNameTablePayload;
+    if (nameTablePayload == nullptr) {
+        nameTablePayload = getNameTablePayload;
+    }
     if (nameTablePayload == nullptr) {
         Timer timeit(gs->tracer(), "read_global_state.source");
         sorbet::rbi::polulateRBIsInto(gs);
@@ -41,12 +64,46 @@ void createInitialGlobalState(unique_ptr<core::GlobalState> &gs, const realmain:
     }
 }
 
+bool preallocateTables(core::GlobalState &gs, unique_ptr<KeyValueStore> &kvstore) {
+    if (!kvstore) {
+        return false;
+    }
+    auto stats = kvstore->readString(TABLE_STATS_KEY);
+    u4 symbolCount = 0;
+    u4 nameCount = 0;
+    if (stats.empty() || !parseTableStats(stats, symbolCount, nameCount)) {
+        prodCounterInc("types.memory.table_stats.miss");
+        return false;
+    }
+    prodCounterInc("types.memory.table_stats.hit");
+    gs.preallocateTables(symbolCount, nameCount);
+    return true;
+}
+
 void retainGlobalState(unique_ptr<core::GlobalState> &gs, const realmain::options::Options &options,
                        unique_ptr<KeyValueStore> &kvstore) {
+    if (kvstore && !gs->hadCriticalError()) {
+        // Record the final table sizes so the next run can preallocate them in one shot. If this
+        // run outgrew the previous run's counts, some rehashing happened despite the reservation;
+        // count that so it shows up when the workload drifts.
+        u4 prevSymbolCount = 0;
+        u4 prevNameCount = 0;
+        auto prevStats = kvstore->readString(TABLE_STATS_KEY);
+        if (!prevStats.empty() && parseTableStats(prevStats, prevSymbolCount, prevNameCount)) {
+            if (gs->symbolsUsed() > prevSymbolCount) {
+                prodCounterInc("types.memory.table_stats.symbols_exceeded");
+            }
+            if (gs->namesUsed() > prevNameCount) {
+                prodCounterInc("types.memory.table_stats.names_exceeded");
+            }
+        }
+        kvstore->writeString(TABLE_STATS_KEY, absl::StrCat(gs->symbolsUsed(), ":", gs->namesUsed()));
+    }
     if (kvstore && gs->wasModified() && !gs->hadCriticalError()) {
         Timer timeit(gs->tracer(), "write_global_state.kvstore");
         kvstore->write(GLOBAL_STATE_KEY, core::serialize::Serializer::storePayloadAndNameTable(*gs));
-        KeyValueStore::commit(move(kvstore));
+        // The caller commits the kvstore once all cache tiers (including the pipeline's post-namer
+        // tier, which is written during resolve) have been populated.
     }
 }
 } // namespace sorbet::payload
@@ -9,6 +9,16 @@ namespace sorbet::payload {
 
 void createInitialGlobalState(std::unique_ptr<core::GlobalState> &gs, const realmain::options::Options &options,
                               std::unique_ptr<KeyValueStore> &kvstore);
+// Registers a serialized payload delivered at runtime instead of compiled into the binary, taking
+// precedence over the compiled-in one in createInitialGlobalState. The WASM build links the empty
+// payload variant so the module stays small enough to stream-compile quickly; the embedding page
+// fetches the payload in parallel and hands it in through this hook (exported as `loadPayload`;
+// see emscripten/main.cc) before the first typecheck. The bytes must outlive the process.
+void setExternalNameTablePayload(const u1 *data);
+// Pre-sizes the symbol and name tables from the previous run's final counts (persisted by
+// retainGlobalState), so that namer on a warm cache does not pay for incremental rehashes.
+// Returns false when no statistics were cached.
+bool preallocateTables(core::GlobalState &gs, std::unique_ptr<KeyValueStore> &kvstore);
 void retainGlobalState(std::unique_ptr<core::GlobalState> &gs, const realmain::options::Options &options,
                        std::unique_ptr<KeyValueStore> &kvstore);
 
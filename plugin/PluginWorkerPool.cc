@@ -0,0 +1,176 @@
+#include "plugin/PluginWorkerPool.h"
+#include "common/Counters.h"
+#include "core/GlobalState.h"
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace sorbet::plugin {
+
+namespace {
+
+// Frame length that marks a plugin-side failure for a single request; the worker itself stays up.
+constexpr u4 ERROR_FRAME = 0xffffffffu;
+
+// Upper bound on a response frame. Anything larger is treated as a framing bug rather than a
+// legitimate answer, and kills the worker.
+constexpr u4 MAX_RESPONSE_BYTES = 64 * 1024 * 1024;
+
+bool writeAll(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool readAll(int fd, char *data, size_t size) {
+    while (size > 0) {
+        const ssize_t bytesRead = ::read(fd, data, size);
+        if (bytesRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (bytesRead == 0) {
+            return false;
+        }
+        data += bytesRead;
+        size -= bytesRead;
+    }
+    return true;
+}
+
+bool writeFrame(int fd, string_view payload) {
+    u4 size = payload.size();
+    return writeAll(fd, reinterpret_cast<const char *>(&size), sizeof(size)) &&
+           writeAll(fd, payload.data(), payload.size());
+}
+
+} // namespace
+
+optional<PluginWorkerPool::Worker> PluginWorkerPool::spawnWorker(const core::GlobalState &gs, string_view command) {
+    if (emscripten_build) {
+        return nullopt;
+    }
+    int requestPipe[2];  // worker's stdin
+    int responsePipe[2]; // worker's stdout
+    if (pipe(requestPipe)) {
+        return nullopt;
+    }
+    if (pipe(responsePipe)) {
+        close(requestPipe[0]);
+        close(requestPipe[1]);
+        return nullopt;
+    }
+
+    posix_spawn_file_actions_t fileActions;
+    optional<Worker> result;
+    if (posix_spawn_file_actions_init(&fileActions) == 0) {
+        if (posix_spawn_file_actions_adddup2(&fileActions, requestPipe[0], 0) == 0 &&
+            posix_spawn_file_actions_adddup2(&fileActions, responsePipe[1], 1) == 0 &&
+            posix_spawn_file_actions_addclose(&fileActions, requestPipe[1]) == 0 &&
+            posix_spawn_file_actions_addclose(&fileActions, responsePipe[0]) == 0) {
+            string executable = "ruby";
+            vector<string> arguments(gs.dslRubyExtraArgs);
+            arguments.emplace_back(command);
+            arguments.emplace_back("--persistent");
+
+            vector<char *> argv;
+            argv.reserve(arguments.size() + 2);
+            argv.push_back(executable.data());
+            for (auto &arg : arguments) {
+                argv.push_back(arg.data());
+            }
+            argv.push_back(nullptr);
+
+            pid_t childPid;
+            if (posix_spawnp(&childPid, executable.data(), &fileActions, nullptr, argv.data(), nullptr) == 0) {
+                result = Worker{childPid, requestPipe[1], responsePipe[0]};
+            }
+        }
+        posix_spawn_file_actions_destroy(&fileActions);
+    }
+
+    // The child's ends belong to the child; our unused ends only if the spawn failed.
+    close(requestPipe[0]);
+    close(responsePipe[1]);
+    if (!result) {
+        close(requestPipe[1]);
+        close(responsePipe[0]);
+    }
+    return result;
+}
+
+void PluginWorkerPool::destroyWorker(Worker &worker) {
+    close(worker.requestFd);
+    close(worker.responseFd);
+    // The worker may be wedged mid-frame, so don't count on EOF making it exit.
+    kill(worker.pid, SIGKILL);
+    waitpid(worker.pid, nullptr, 0);
+}
+
+PluginWorkerPool::~PluginWorkerPool() {
+    for (auto &[command, worker] : workers) {
+        destroyWorker(worker);
+    }
+}
+
+optional<string> PluginWorkerPool::run(const core::GlobalState &gs, string_view command, string_view className,
+                                       string_view methodName, string_view source) {
+    auto it = workers.find(string(command));
+    if (it == workers.end()) {
+        auto spawned = spawnWorker(gs, command);
+        if (!spawned) {
+            return nullopt;
+        }
+        it = workers.emplace(string(command), *spawned).first;
+        prodCounterInc("plugins.persistent_workers.spawned");
+    }
+    auto &worker = it->second;
+
+    bool ok = writeFrame(worker.requestFd, className) && writeFrame(worker.requestFd, methodName) &&
+              writeFrame(worker.requestFd, source);
+    u4 responseSize = 0;
+    if (ok) {
+        ok = readAll(worker.responseFd, reinterpret_cast<char *>(&responseSize), sizeof(responseSize));
+    }
+    if (ok && responseSize == ERROR_FRAME) {
+        // The plugin reported a failure for this request but is still framing correctly; keep it.
+        prodCounterInc("plugins.persistent_workers.request_errors");
+        return nullopt;
+    }
+    ok = ok && responseSize <= MAX_RESPONSE_BYTES;
+    string output;
+    if (ok) {
+        output.resize(responseSize);
+        ok = readAll(worker.responseFd, output.data(), output.size());
+    }
+    if (!ok) {
+        // The worker is in an unknown state; kill it and let the next request respawn it.
+        destroyWorker(worker);
+        workers.erase(it);
+        prodCounterInc("plugins.persistent_workers.transport_errors");
+        return nullopt;
+    }
+    prodCounterInc("plugins.persistent_workers.requests");
+    return output;
+}
+
+PluginWorkerPool &PluginWorkerPool::forCurrentThread() {
+    thread_local PluginWorkerPool pool;
+    return pool;
+}
+
+} // namespace sorbet::plugin
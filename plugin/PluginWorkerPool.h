@@ -0,0 +1,58 @@
+#ifndef SORBET_PLUGIN_WORKER_POOL_H
+#define SORBET_PLUGIN_WORKER_POOL_H
+#include "common/common.h"
+#include <optional>
+#include <string>
+#include <sys/types.h>
+
+namespace sorbet::core {
+class GlobalState;
+}
+
+namespace sorbet::plugin {
+
+/**
+ * Keeps one long-lived process per (thread, plugin command), so interpreter startup is paid once per
+ * worker thread instead of once per plugin invocation. A worker is launched with `--persistent`
+ * appended to the configured command and then fed one request after another over its stdin,
+ * answering on its stdout; requests and responses use length-prefixed framing (see run). Each
+ * indexing thread owns its own pool (forCurrentThread), so requests need no locking and the number
+ * of live plugin processes scales with the WorkerPool's size.
+ */
+class PluginWorkerPool final {
+    struct Worker {
+        pid_t pid = -1;
+        // Our write end of the worker's stdin.
+        int requestFd = -1;
+        // Our read end of the worker's stdout.
+        int responseFd = -1;
+    };
+    UnorderedMap<std::string, Worker> workers;
+
+    std::optional<Worker> spawnWorker(const core::GlobalState &gs, std::string_view command);
+    static void destroyWorker(Worker &worker);
+
+public:
+    PluginWorkerPool() = default;
+    PluginWorkerPool(const PluginWorkerPool &) = delete;
+    PluginWorkerPool &operator=(const PluginWorkerPool &) = delete;
+    ~PluginWorkerPool();
+
+    /**
+     * Sends one request — the same class/method/source triple the one-shot protocol passes as argv —
+     * to the persistent worker for `command`, spawning it first if needed. Each of the three fields
+     * is written as a u4 native-endian length followed by the payload; the response is one such
+     * frame holding the generated source, with length 0xffffffff signalling a plugin-side failure
+     * for this request. Returns nullopt on failure. Transport failures (EOF, short reads,
+     * implausible frame sizes) kill the worker; the next request respawns it.
+     */
+    std::optional<std::string> run(const core::GlobalState &gs, std::string_view command, std::string_view className,
+                                   std::string_view methodName, std::string_view source);
+
+    /** The calling thread's pool. Workers die with the thread that spawned them. */
+    static PluginWorkerPool &forCurrentThread();
+};
+
+} // namespace sorbet::plugin
+
+#endif // SORBET_PLUGIN_WORKER_POOL_H
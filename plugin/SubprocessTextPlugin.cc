@@ -3,6 +3,7 @@
 #include "ast/treemap/treemap.h"
 #include "common/Subprocess.h"
 #include "core/errors/plugin.h"
+#include "plugin/PluginWorkerPool.h"
 
 using namespace std;
 
@@ -68,16 +69,23 @@ struct SpawningWalker {
                 string_view shortName = send->fun.data(ctx)->shortName(ctx);
                 string sendSource = send->loc.source(ctx);
 
-                vector<string> args(ctx.state.dslRubyExtraArgs);
-                args.emplace_back(*command);
-                args.emplace_back("--class");
-                args.emplace_back(move(className));
-                args.emplace_back("--method");
-                args.emplace_back(shortName);
-                args.emplace_back("--source");
-                args.emplace_back(move(sendSource));
-
-                output = Subprocess::spawn("ruby", move(args));
+                if (ctx.state.dslPluginsPersistent) {
+                    // This thread's long-lived worker for the command; interpreter startup is paid
+                    // once per thread instead of once per send.
+                    output =
+                        PluginWorkerPool::forCurrentThread().run(ctx.state, *command, className, shortName, sendSource);
+                } else {
+                    vector<string> args(ctx.state.dslRubyExtraArgs);
+                    args.emplace_back(*command);
+                    args.emplace_back("--class");
+                    args.emplace_back(move(className));
+                    args.emplace_back("--method");
+                    args.emplace_back(shortName);
+                    args.emplace_back("--source");
+                    args.emplace_back(move(sendSource));
+
+                    output = Subprocess::spawn("ruby", move(args));
+                }
             }
 
             if (output) {
@@ -174,31 +174,54 @@ void resolveTypeMembers(core::GlobalState &gs, core::SymbolRef sym,
     }
 }
 
+// Classes that live outside the files being typechecked (i.e. that came in with the payload) were
+// already finalized when the payload was built. As long as nothing re-opened them in this run,
+// their linearization flag is still set and their ancestor information is intact, so finalization
+// can skip them; re-opening a class adds a mixin, which clears the flag. On codebases that touch
+// only a sliver of the stdlib this avoids re-finalizing tens of thousands of symbols per run.
+bool isFinalizedPayloadClass(const core::GlobalState &gs, core::SymbolRef klass) {
+    if (!klass.data(gs)->isClassOrModuleLinearizationComputed()) {
+        return false;
+    }
+    auto loc = klass.data(gs)->loc();
+    return !loc.file().exists() || loc.file().data(gs).sourceType != core::File::Type::Normal;
+}
+
 }; // namespace
 
-void Resolver::finalizeAncestors(core::GlobalState &gs) {
+void Resolver::finalizeAncestors(core::GlobalState &gs, u4 firstSymbol) {
     Timer timer(gs.tracer(), "resolver.finalize_ancestors");
     int methodCount = 0;
     int classCount = 0;
-    for (int i = 1; i < gs.symbolsUsed(); ++i) {
+    for (int i = firstSymbol; i < gs.symbolsUsed(); ++i) {
         auto ref = core::SymbolRef(&gs, i);
-        auto loc = ref.data(gs)->loc();
-        if (loc.file().exists() && loc.file().data(gs).sourceType == core::File::Type::Normal) {
-            if (ref.data(gs)->isMethod()) {
-                methodCount++;
-            } else if (ref.data(gs)->isClassOrModule()) {
+        // Fetch the row once and filter on the hot scalars (flags, superClass) before touching the
+        // cold loc storage at the tail of the struct; most rows are method arguments and fields
+        // that this scan discards on flags alone.
+        auto data = ref.data(gs);
+        if (!data->isClassOrModule()) {
+            if (data->isMethod()) {
+                auto loc = data->loc();
+                if (loc.file().exists() && loc.file().data(gs).sourceType == core::File::Type::Normal) {
+                    methodCount++;
+                }
+            }
+            continue;
+        }
+        {
+            auto loc = data->loc();
+            if (loc.file().exists() && loc.file().data(gs).sourceType == core::File::Type::Normal) {
                 classCount++;
             }
         }
-        if (!ref.data(gs)->isClassOrModule()) {
+        if (isFinalizedPayloadClass(gs, ref)) {
             continue;
         }
-        classCount++;
-        if (!ref.data(gs)->isClassModuleSet()) {
+        if (!data->isClassModuleSet()) {
             // we did not see a declaration for this type not did we see it used. Default to module.
-            ref.data(gs)->setIsModule(true);
+            data->setIsModule(true);
         }
-        if (ref.data(gs)->superClass().exists() && ref.data(gs)->superClass() != core::Symbols::todo()) {
+        if (data->superClass().exists() && data->superClass() != core::Symbols::todo()) {
             continue;
         }
         if (ref == core::Symbols::Sorbet_Private_Static_ImplicitModuleSuperClass()) {
@@ -313,10 +336,10 @@ ParentLinearizationInformation computeClassLinearization(core::GlobalState &gs,
         }
         data->mixins() = std::move(newMixins);
         data->setClassLinearizationComputed();
-        if (debug_mode) {
+        if (slow_debug_mode) {
             for (auto oldMixin : currentMixins) {
-                ENFORCE(ofClass.data(gs)->derivesFrom(gs, oldMixin), "{} no longer derives from {}",
-                        ofClass.data(gs)->showFullName(gs), oldMixin.data(gs)->showFullName(gs));
+                SLOW_ENFORCE(ofClass.data(gs)->derivesFrom(gs, oldMixin), "{} no longer derives from {}",
+                             ofClass.data(gs)->showFullName(gs), oldMixin.data(gs)->showFullName(gs));
             }
         }
     }
@@ -363,18 +386,24 @@ void Resolver::computeLinearization(core::GlobalState &gs) {
     }
 }
 
-void Resolver::finalizeSymbols(core::GlobalState &gs) {
+void Resolver::finalizeSymbols(core::GlobalState &gs, u4 firstSymbol) {
     Timer timer(gs.tracer(), "resolver.finalize_resolution");
     // TODO(nelhage): Properly this first loop should go in finalizeAncestors,
     // but we currently compute mixes_in_class_methods during the same AST walk
     // that resolves types and we don't want to introduce additional passes if
     // we don't have to. It would be a tractable refactor to merge it
     // `ResolveConstantsWalk` if it becomes necessary to process earlier.
-    for (int i = 1; i < gs.symbolsUsed(); ++i) {
+    for (int i = firstSymbol; i < gs.symbolsUsed(); ++i) {
         auto sym = core::SymbolRef(&gs, i);
         if (!sym.data(gs)->isClassOrModule()) {
             continue;
         }
+        // Untouched payload classes had ClassMethods mixed into their singletons when the payload
+        // was finalized; re-adding them here would also clear their linearization flags and force
+        // computeLinearization below to redo the whole stdlib.
+        if (isFinalizedPayloadClass(gs, sym)) {
+            continue;
+        }
 
         core::SymbolRef singleton;
         for (auto ancst : sym.data(gs)->mixins()) {
@@ -395,12 +424,16 @@ void Resolver::finalizeSymbols(core::GlobalState &gs) {
     typeAliases.resize(gs.symbolsUsed());
     vector<bool> resolved;
     resolved.resize(gs.symbolsUsed());
-    for (int i = 1; i < gs.symbolsUsed(); ++i) {
+    for (int i = firstSymbol; i < gs.symbolsUsed(); ++i) {
         auto sym = core::SymbolRef(&gs, i);
         if (sym.data(gs)->isClassOrModule()) {
             resolveTypeMembers(gs, sym, typeAliases, resolved);
         }
     }
+
+    // Every class is linearized and no later pass touches ancestry, so snapshot it now; infer's
+    // derivesFrom calls answer from the table instead of walking superclass chains.
+    gs.computeAncestryTable();
 }
 
 } // namespace sorbet::resolver
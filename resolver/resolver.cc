@@ -156,16 +156,53 @@ private:
     vector<ClassAliasResolutionItem> todoClassAliases_;
     vector<TypeAliasResolutionItem> todoTypeAliases_;
 
-    static core::SymbolRef resolveLhs(core::Context ctx, shared_ptr<Nesting> nesting, core::NameRef name) {
+    // Memo of resolveLhs results. Keyed by the exact Nesting node so the whole lexical chain
+    // participates in the key; a file's constants concentrate in a handful of nestings and repeat
+    // the same names, so after the first lookup per (nesting, name) the rest collapse into map
+    // hits. Holding the shared_ptr pins the node, so a recycled allocation can never impersonate a
+    // key. A memo is only sound while the symbol table is not mutated: the first-pass walk keeps
+    // one alive for its whole run, and the fixed-point loop keeps one per constants step (per
+    // worker, when sharded), discarded before the alias and ancestor steps mutate the table.
+    struct NestingMemo {
+        shared_ptr<Nesting> nesting;
+        UnorderedMap<u4, core::SymbolRef> byName;
+    };
+    using ResolveLhsMemo = UnorderedMap<const Nesting *, NestingMemo>;
+    ResolveLhsMemo resolveLhsMemo_;
+
+    static core::SymbolRef resolveLhs(core::Context ctx, shared_ptr<Nesting> nesting, core::NameRef name,
+                                      ResolveLhsMemo *memo) {
+        UnorderedMap<u4, core::SymbolRef> *byName = nullptr;
+        if (memo != nullptr) {
+            auto &entry = (*memo)[nesting.get()];
+            if (entry.nesting == nullptr) {
+                entry.nesting = nesting;
+            }
+            byName = &entry.byName;
+            auto it = byName->find(name.id());
+            if (it != byName->end()) {
+                categoryCounterInc("resolve.constants.lhs_memo", "hit");
+                return it->second;
+            }
+            categoryCounterInc("resolve.constants.lhs_memo", "miss");
+        }
+        core::SymbolRef result;
         Nesting *scope = nesting.get();
         while (scope != nullptr) {
             auto lookup = scope->scope.data(ctx)->findMember(ctx, name);
             if (lookup.exists()) {
-                return lookup;
+                result = lookup;
+                break;
             }
             scope = scope->parent.get();
         }
-        return nesting->scope.data(ctx)->findMemberTransitive(ctx, name);
+        if (!result.exists()) {
+            result = nesting->scope.data(ctx)->findMemberTransitive(ctx, name);
+        }
+        if (byName != nullptr) {
+            (*byName)[name.id()] = result;
+        }
+        return result;
     }
 
     static bool isAlreadyResolved(core::Context ctx, const ast::ConstantLit &original) {
@@ -202,9 +239,10 @@ private:
     }
 
     static core::SymbolRef resolveConstant(core::Context ctx, shared_ptr<Nesting> nesting,
-                                           const unique_ptr<ast::UnresolvedConstantLit> &c, bool &resolutionFailed) {
+                                           const unique_ptr<ast::UnresolvedConstantLit> &c, bool &resolutionFailed,
+                                           ResolveLhsMemo *memo = nullptr) {
         if (ast::isa_tree<ast::EmptyTree>(c->scope.get())) {
-            core::SymbolRef result = resolveLhs(ctx, nesting, c->cnst);
+            core::SymbolRef result = resolveLhs(ctx, nesting, c->cnst, memo);
             return result;
         }
         ast::Expression *resolvedScope = c->scope.get();
@@ -307,12 +345,12 @@ private:
         job.out->resolutionScope = scope;
     }
 
-    static bool resolveJob(core::Context ctx, ResolutionItem &job) {
+    static bool resolveJob(core::Context ctx, ResolutionItem &job, ResolveLhsMemo *memo = nullptr) {
         if (isAlreadyResolved(ctx, *job.out)) {
             return true;
         }
-        auto resolved =
-            resolveConstant(ctx.withOwner(job.scope->scope), job.scope, job.out->original, job.resolutionFailed);
+        auto resolved = resolveConstant(ctx.withOwner(job.scope->scope), job.scope, job.out->original,
+                                        job.resolutionFailed, memo);
         if (!resolved.exists()) {
             return false;
         }
@@ -535,7 +573,7 @@ public:
         auto loc = c->loc;
         auto out = make_unique<ast::ConstantLit>(loc, core::Symbols::noSymbol(), std::move(c));
         ResolutionItem job{nesting_, out.get()};
-        if (resolveJob(ctx, job)) {
+        if (resolveJob(ctx, job, &resolveLhsMemo_)) {
             categoryCounterInc("resolve.constants.nonancestor", "firstpass");
         } else {
             todo_.emplace_back(std::move(job));
@@ -664,6 +702,72 @@ public:
         return lhs.endPos() < rhs.endPos();
     }
 
+    // Below this size, sharding a batch of constant jobs across the worker pool costs more than it saves.
+    static constexpr size_t PARALLEL_CONSTANT_BATCH_MIN = 4096;
+    static constexpr size_t PARALLEL_CONSTANT_CHUNK_SIZE = 1024;
+
+    // Runs resolveJob over `todo` on the worker pool and erases the jobs that resolved.
+    //
+    // resolveJob only reads the symbol table and writes to tree nodes owned by exactly one job, so sharding a
+    // batch is safe as long as nothing mutates the symbol table concurrently. The fixed-point loop guarantees
+    // that: ancestor, class-alias and type-alias publication all happen serially between batches, so every
+    // worker observes the fully-entered symbol table of the previous epoch and never a half-entered symbol.
+    // The same immutability makes a per-worker resolveLhs memo sound for the duration of one batch.
+    static void resolveConstantJobsParallel(core::Context ctx, vector<ResolutionItem> &todo, WorkerPool &workers) {
+        auto numChunks = (todo.size() + PARALLEL_CONSTANT_CHUNK_SIZE - 1) / PARALLEL_CONSTANT_CHUNK_SIZE;
+        auto chunkq = make_shared<ConcurrentBoundedQueue<pair<size_t, size_t>>>(numChunks);
+        auto resultq = make_shared<BlockingBoundedQueue<vector<size_t>>>(numChunks);
+        for (size_t begin = 0; begin < todo.size(); begin += PARALLEL_CONSTANT_CHUNK_SIZE) {
+            chunkq->push(make_pair(begin, min(begin + PARALLEL_CONSTANT_CHUNK_SIZE, todo.size())), 1);
+        }
+
+        ResolutionItem *jobs = todo.data();
+        workers.multiplexJob("resolveConstantsFixedPoint", [ctx, jobs, chunkq, resultq]() {
+            vector<size_t> resolved;
+            ResolveLhsMemo memo;
+            int chunksProcessed = 0;
+            pair<size_t, size_t> chunk;
+            for (auto result = chunkq->try_pop(chunk); !result.done(); result = chunkq->try_pop(chunk)) {
+                if (result.gotItem()) {
+                    chunksProcessed++;
+                    for (auto i = chunk.first; i < chunk.second; i++) {
+                        if (resolveJob(ctx, jobs[i], &memo)) {
+                            resolved.emplace_back(i);
+                        }
+                    }
+                }
+            }
+            if (chunksProcessed > 0) {
+                resultq->push(move(resolved), chunksProcessed);
+            }
+        });
+
+        vector<bool> isResolved(todo.size(), false);
+        {
+            vector<size_t> threadResult;
+            for (auto result = resultq->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), ctx.state.tracer());
+                 !result.done();
+                 result = resultq->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), ctx.state.tracer())) {
+                if (result.gotItem()) {
+                    for (auto i : threadResult) {
+                        isResolved[i] = true;
+                    }
+                }
+            }
+        }
+
+        auto out = todo.begin();
+        for (size_t i = 0; i < todo.size(); i++) {
+            if (!isResolved[i]) {
+                if (out != todo.begin() + i) {
+                    *out = move(todo[i]);
+                }
+                ++out;
+            }
+        }
+        todo.erase(out, todo.end());
+    }
+
     static vector<ast::ParsedFile> resolveConstants(core::MutableContext ctx, vector<ast::ParsedFile> trees,
                                                     WorkerPool &workers) {
         Timer timeit(ctx.state.tracer(), "resolver.resolve_constants");
@@ -762,9 +866,18 @@ public:
             {
                 Timer timeit(ctx.state.tracer(), "resolver.resolve_constants.fixed_point.constants");
                 int origSize = todo.size();
-                auto it = remove_if(todo.begin(), todo.end(),
-                                    [ctx](ResolutionItem &job) -> bool { return resolveJob(ctx, job); });
-                todo.erase(it, todo.end());
+                if (todo.size() >= PARALLEL_CONSTANT_BATCH_MIN) {
+                    resolveConstantJobsParallel(ctx, todo, workers);
+                } else {
+                    // The symbol table is immutable for the duration of this step, so resolveLhs
+                    // results can be shared across jobs; the memo must not outlive the round, as
+                    // the alias and ancestor steps enter new symbols.
+                    ResolveLhsMemo memo;
+                    auto it = remove_if(todo.begin(), todo.end(), [ctx, &memo](ResolutionItem &job) -> bool {
+                        return resolveJob(ctx, job, &memo);
+                    });
+                    todo.erase(it, todo.end());
+                }
                 progress = progress || (origSize != todo.size());
                 categoryCounterAdd("resolve.constants.nonancestor", "retry", origSize - todo.size());
             }
@@ -1270,11 +1383,31 @@ public:
 };
 
 class ResolveSignaturesWalk {
+public:
+    // The deferred sig work for a single method definition. The tree walk only collects these
+    // (doing up front whatever must mutate the symbol table, like overload mangling and forcing
+    // the owner's singleton class); interpreting the sigs happens later in processSignatureJob,
+    // possibly on a worker thread.
+    struct SignatureJob {
+        core::SymbolRef sigOwner;
+        ast::MethodDef *mdef = nullptr;
+        InlinedVector<ast::Send *, 1> sigs;
+        bool isOverloaded = false;
+        core::NameRef originalName;
+    };
+
+    // Populated in traversal order as the walk visits method definitions. The caller moves this
+    // out after each file so that a file's jobs can be replayed as a unit.
+    std::vector<SignatureJob> signatureJobs;
+
+    // Below this many deferred sigs, sharding across the worker pool costs more than it saves.
+    static constexpr size_t PARALLEL_SIG_BATCH_MIN = 1024;
+
 private:
     std::vector<int> nestedBlockCounts;
 
-    ast::Local *getArgLocal(core::Context ctx, const core::ArgInfo &argSym, const ast::MethodDef &mdef, int pos,
-                            bool isOverloaded) {
+    static ast::Local *getArgLocal(core::Context ctx, const core::ArgInfo &argSym, const ast::MethodDef &mdef, int pos,
+                                   bool isOverloaded) {
         if (!isOverloaded) {
             return ast::MK::arg2Local(mdef.args[pos].get());
         } else {
@@ -1289,8 +1422,8 @@ private:
         }
     }
 
-    void fillInInfoFromSig(core::MutableContext ctx, core::SymbolRef method, core::Loc exprLoc, ParsedSig sig,
-                           bool isOverloaded, const ast::MethodDef &mdef) {
+    static void fillInInfoFromSig(core::MutableContext ctx, core::SymbolRef method, core::Loc exprLoc, ParsedSig sig,
+                                  bool isOverloaded, const ast::MethodDef &mdef) {
         ENFORCE(isOverloaded || mdef.symbol == method);
         ENFORCE(isOverloaded || method.data(ctx)->arguments().size() == mdef.args.size());
 
@@ -1547,6 +1680,8 @@ private:
                     }
                 }
 
+                auto &job = this->signatureJobs.emplace_back();
+                job.mdef = mdef;
                 if (!lastSigs.empty()) {
                     prodCounterInc("types.sig.count");
 
@@ -1560,85 +1695,29 @@ private:
                         }
                     }
 
-                    bool isOverloaded = lastSigs.size() > 1 && ctx.permitOverloadDefinitions(loc.file());
-                    auto originalName = mdef->symbol.data(ctx)->name;
-                    if (isOverloaded) {
-                        ctx.state.mangleRenameSymbol(mdef->symbol, originalName);
+                    job.isOverloaded = lastSigs.size() > 1 && ctx.permitOverloadDefinitions(loc.file());
+                    job.originalName = mdef->symbol.data(ctx)->name;
+                    if (job.isOverloaded) {
+                        ctx.state.mangleRenameSymbol(mdef->symbol, job.originalName);
                     }
-                    int i = 0;
 
                     // process signatures in the context of either the current
                     // class, or the current singleton class, depending on if
-                    // the current method is a self method.
-                    core::SymbolRef sigOwner;
+                    // the current method is a self method. Computed here, while
+                    // we're still serial, because singletonClass may have to
+                    // create the singleton.
                     if (mdef->isSelf()) {
-                        sigOwner = ctx.owner.data(ctx)->singletonClass(ctx);
+                        job.sigOwner = ctx.owner.data(ctx)->singletonClass(ctx);
                     } else {
-                        sigOwner = ctx.owner;
-                    }
-
-                    while (i < lastSigs.size()) {
-                        auto allowSelfType = true;
-                        auto allowRebind = false;
-                        auto allowTypeMember = true;
-                        auto sig = TypeSyntax::parseSig(
-                            ctx.withOwner(sigOwner), ast::cast_tree<ast::Send>(lastSigs[i]), nullptr,
-                            TypeSyntaxArgs{allowSelfType, allowRebind, allowTypeMember, mdef->symbol});
-                        core::SymbolRef overloadSym;
-                        if (isOverloaded) {
-                            vector<int> argsToKeep;
-                            int argId = -1;
-                            for (auto &argTree : mdef->args) {
-                                argId++;
-                                const auto local = ast::MK::arg2Local(argTree.get());
-                                auto treeArgName = local->localVariable._name;
-                                ENFORCE(local != nullptr);
-                                auto spec =
-                                    absl::c_find_if(sig.argTypes, [&](auto &spec) { return spec.name == treeArgName; });
-                                if (spec != sig.argTypes.end()) {
-                                    argsToKeep.emplace_back(argId);
-                                }
-                            }
-                            overloadSym = ctx.state.enterNewMethodOverload(lastSigs[i]->loc, mdef->symbol, originalName,
-                                                                           i, argsToKeep);
-                            if (i != lastSigs.size() - 1) {
-                                overloadSym.data(ctx)->setOverloaded();
-                            }
-                        } else {
-                            overloadSym = mdef->symbol;
-                        }
-                        fillInInfoFromSig(ctx, overloadSym, lastSigs[i]->loc, move(sig), isOverloaded, *mdef);
-                        i++;
+                        job.sigOwner = ctx.owner;
                     }
 
+                    job.sigs = std::move(lastSigs);
                     // OVERLOAD
                     lastSigs.clear();
                 }
 
                 deleteOptionlArg(ctx, mdef);
-
-                if (mdef->symbol.data(ctx)->isAbstract()) {
-                    if (!ast::isa_tree<ast::EmptyTree>(mdef->rhs.get())) {
-                        if (auto e =
-                                ctx.state.beginError(mdef->rhs->loc, core::errors::Resolver::AbstractMethodWithBody)) {
-                            e.setHeader("Abstract methods must not contain any code in their body");
-                            e.replaceWith("Delete the body", mdef->rhs->loc, "");
-                        }
-
-                        mdef->rhs = ast::MK::EmptyTree();
-                    }
-                    if (!mdef->symbol.data(ctx)->enclosingClass(ctx).data(ctx)->isClassOrModuleAbstract()) {
-                        if (auto e = ctx.state.beginError(mdef->loc,
-                                                          core::errors::Resolver::AbstractMethodOutsideAbstract)) {
-                            e.setHeader("Before declaring an abstract method, you must mark your class/module "
-                                        "as abstract using `abstract!` or `interface!`");
-                        }
-                    }
-                } else if (mdef->symbol.data(ctx)->enclosingClass(ctx).data(ctx)->isClassOrModuleInterface()) {
-                    if (auto e = ctx.state.beginError(mdef->loc, core::errors::Resolver::ConcreteMethodInInterface)) {
-                        e.setHeader("All methods in an interface must be declared abstract");
-                    }
-                }
             },
             [&](ast::ClassDef *cdef) {
                 // Leave in place
@@ -1781,6 +1860,118 @@ public:
         nestedBlockCounts.emplace_back(0);
     }
 
+    // Whether interpreting this piece of a sig is guaranteed not to enter new symbols.
+    //
+    // Most sigs only read the symbol table, but a few shapes create symbols lazily while being
+    // parsed: `T.class_of(Foo)` and generic applications like `Foo[...]` may force `Foo`'s
+    // singleton class into existence, and `type_parameters` sigs enter fresh type-argument
+    // symbols in fillInInfoFromSig. Jobs containing those must run serially. Any node shape we
+    // don't recognize is conservatively treated as unsafe.
+    static bool sigTreeEntersNoSymbols(ast::Expression *expr) {
+        if (expr == nullptr) {
+            return true;
+        }
+        if (ast::isa_tree<ast::ConstantLit>(expr) || ast::isa_tree<ast::Literal>(expr) ||
+            ast::isa_tree<ast::EmptyTree>(expr) || ast::isa_tree<ast::Local>(expr)) {
+            return true;
+        }
+        if (auto *arr = ast::cast_tree<ast::Array>(expr)) {
+            return absl::c_all_of(arr->elems, [](auto &elem) { return sigTreeEntersNoSymbols(elem.get()); });
+        }
+        if (auto *hash = ast::cast_tree<ast::Hash>(expr)) {
+            return absl::c_all_of(hash->keys, [](auto &key) { return sigTreeEntersNoSymbols(key.get()); }) &&
+                   absl::c_all_of(hash->values, [](auto &value) { return sigTreeEntersNoSymbols(value.get()); });
+        }
+        if (auto *send = ast::cast_tree<ast::Send>(expr)) {
+            if (send->fun == core::Names::typeParameters() || send->fun == core::Names::classOf() ||
+                send->fun == core::Names::squareBrackets()) {
+                return false;
+            }
+            if (!sigTreeEntersNoSymbols(send->recv.get())) {
+                return false;
+            }
+            for (auto &arg : send->args) {
+                if (!sigTreeEntersNoSymbols(arg.get())) {
+                    return false;
+                }
+            }
+            if (send->block != nullptr && !sigTreeEntersNoSymbols(send->block->body.get())) {
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    static bool jobIsParallelSafe(const SignatureJob &job) {
+        // Overloads enter a new method symbol per sig, so they always stay serial.
+        return !job.isOverloaded &&
+               absl::c_all_of(job.sigs, [](ast::Send *sig) { return sigTreeEntersNoSymbols(sig); });
+    }
+
+    // Interprets the sigs collected for one method definition and fills in its method symbol,
+    // then runs the abstract-method checks (which depend on flags fillInInfoFromSig sets).
+    //
+    // Only writes to the job's own method symbol and tree nodes, except for the lazy symbol
+    // creation described on sigTreeEntersNoSymbols; jobs that jobIsParallelSafe rejects must run
+    // on the main thread.
+    static void processSignatureJob(core::MutableContext ctx, SignatureJob &job) {
+        auto *mdef = job.mdef;
+        int i = 0;
+        while (i < job.sigs.size()) {
+            auto allowSelfType = true;
+            auto allowRebind = false;
+            auto allowTypeMember = true;
+            auto sig = TypeSyntax::parseSig(ctx.withOwner(job.sigOwner), job.sigs[i], nullptr,
+                                            TypeSyntaxArgs{allowSelfType, allowRebind, allowTypeMember, mdef->symbol});
+            core::SymbolRef overloadSym;
+            if (job.isOverloaded) {
+                vector<int> argsToKeep;
+                int argId = -1;
+                for (auto &argTree : mdef->args) {
+                    argId++;
+                    const auto local = ast::MK::arg2Local(argTree.get());
+                    auto treeArgName = local->localVariable._name;
+                    ENFORCE(local != nullptr);
+                    auto spec = absl::c_find_if(sig.argTypes, [&](auto &spec) { return spec.name == treeArgName; });
+                    if (spec != sig.argTypes.end()) {
+                        argsToKeep.emplace_back(argId);
+                    }
+                }
+                overloadSym =
+                    ctx.state.enterNewMethodOverload(job.sigs[i]->loc, mdef->symbol, job.originalName, i, argsToKeep);
+                if (i != job.sigs.size() - 1) {
+                    overloadSym.data(ctx)->setOverloaded();
+                }
+            } else {
+                overloadSym = mdef->symbol;
+            }
+            fillInInfoFromSig(ctx, overloadSym, job.sigs[i]->loc, move(sig), job.isOverloaded, *mdef);
+            i++;
+        }
+
+        if (mdef->symbol.data(ctx)->isAbstract()) {
+            if (!ast::isa_tree<ast::EmptyTree>(mdef->rhs.get())) {
+                if (auto e = ctx.state.beginError(mdef->rhs->loc, core::errors::Resolver::AbstractMethodWithBody)) {
+                    e.setHeader("Abstract methods must not contain any code in their body");
+                    e.replaceWith("Delete the body", mdef->rhs->loc, "");
+                }
+
+                mdef->rhs = ast::MK::EmptyTree();
+            }
+            if (!mdef->symbol.data(ctx)->enclosingClass(ctx).data(ctx)->isClassOrModuleAbstract()) {
+                if (auto e = ctx.state.beginError(mdef->loc, core::errors::Resolver::AbstractMethodOutsideAbstract)) {
+                    e.setHeader("Before declaring an abstract method, you must mark your class/module "
+                                "as abstract using `abstract!` or `interface!`");
+                }
+            }
+        } else if (mdef->symbol.data(ctx)->enclosingClass(ctx).data(ctx)->isClassOrModuleInterface()) {
+            if (auto e = ctx.state.beginError(mdef->loc, core::errors::Resolver::ConcreteMethodInInterface)) {
+                e.setHeader("All methods in an interface must be declared abstract");
+            }
+        }
+    }
+
     unique_ptr<ast::Assign> postTransformAssign(core::MutableContext ctx, unique_ptr<ast::Assign> asgn) {
         if (handleDeclaration(ctx, asgn)) {
             return asgn;
@@ -2092,7 +2283,7 @@ ast::ParsedFilesOrCancelled Resolver::run(core::MutableContext ctx, vector<ast::
     if (ctx.state.wasTypecheckingCanceled()) {
         return ast::ParsedFilesOrCancelled();
     }
-    trees = resolveSigs(ctx, std::move(trees));
+    trees = resolveSigs(ctx, std::move(trees), workers);
     if (ctx.state.wasTypecheckingCanceled()) {
         return ast::ParsedFilesOrCancelled();
     }
@@ -2101,11 +2292,79 @@ ast::ParsedFilesOrCancelled Resolver::run(core::MutableContext ctx, vector<ast::
     return ast::ParsedFilesOrCancelled(move(trees));
 }
 
-vector<ast::ParsedFile> Resolver::resolveSigs(core::MutableContext ctx, vector<ast::ParsedFile> trees) {
+vector<ast::ParsedFile> Resolver::resolveSigs(core::MutableContext ctx, vector<ast::ParsedFile> trees,
+                                              WorkerPool &workers) {
     ResolveSignaturesWalk sigs;
     Timer timeit(ctx.state.tracer(), "resolver.sigs_vars_and_flatten");
-    for (auto &tree : trees) {
-        tree.tree = ast::TreeMap::apply(ctx, sigs, std::move(tree.tree));
+
+    // The walk itself stays serial: it rewrites trees and mutates the symbol table (overload
+    // mangling, forcing singleton classes, field declarations). Per-method sig interpretation is
+    // deferred into signatureJobs, collected per file below.
+    vector<vector<ResolveSignaturesWalk::SignatureJob>> jobsByFile(trees.size());
+    size_t deferredSigs = 0;
+    for (size_t i = 0; i < trees.size(); i++) {
+        trees[i].tree = ast::TreeMap::apply(ctx, sigs, std::move(trees[i].tree));
+        jobsByFile[i] = std::move(sigs.signatureJobs);
+        sigs.signatureJobs.clear();
+        for (auto &job : jobsByFile[i]) {
+            deferredSigs += job.sigs.size();
+        }
+    }
+
+    // Shard a file's jobs only if every one of them is parallel-safe, and keep each file on a
+    // single worker so that errors within a file are reported in the same order as a serial run.
+    vector<size_t> parallelFiles;
+    vector<size_t> serialFiles;
+    for (size_t i = 0; i < trees.size(); i++) {
+        if (deferredSigs >= ResolveSignaturesWalk::PARALLEL_SIG_BATCH_MIN &&
+            absl::c_all_of(jobsByFile[i], ResolveSignaturesWalk::jobIsParallelSafe)) {
+            parallelFiles.emplace_back(i);
+        } else {
+            serialFiles.emplace_back(i);
+        }
+    }
+    counterAdd("resolver.sigs.parallel_files", parallelFiles.size());
+    counterAdd("resolver.sigs.serial_files", serialFiles.size());
+
+    if (!parallelFiles.empty()) {
+        auto fileq = make_shared<ConcurrentBoundedQueue<size_t>>(parallelFiles.size());
+        auto resultq = make_shared<BlockingBoundedQueue<size_t>>(parallelFiles.size());
+        for (auto i : parallelFiles) {
+            fileq->push(move(i), 1);
+        }
+
+        auto *jobs = jobsByFile.data();
+        workers.multiplexJob("resolveSignatures", [ctx, jobs, fileq, resultq]() {
+            size_t filesProcessed = 0;
+            size_t idx;
+            for (auto result = fileq->try_pop(idx); !result.done(); result = fileq->try_pop(idx)) {
+                if (result.gotItem()) {
+                    filesProcessed++;
+                    for (auto &job : jobs[idx]) {
+                        ResolveSignaturesWalk::processSignatureJob(ctx, job);
+                    }
+                }
+            }
+            if (filesProcessed > 0) {
+                resultq->push(move(filesProcessed), filesProcessed);
+            }
+        });
+
+        {
+            size_t threadResult;
+            for (auto result = resultq->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), ctx.state.tracer());
+                 !result.done();
+                 result = resultq->wait_pop_timed(threadResult, WorkerPool::BLOCK_INTERVAL(), ctx.state.tracer())) {
+            }
+        }
+    }
+
+    // Serial jobs can enter symbols, so they must not overlap with the workers above; run them
+    // only once the parallel batch has fully drained.
+    for (auto i : serialFiles) {
+        for (auto &job : jobsByFile[i]) {
+            ResolveSignaturesWalk::processSignatureJob(ctx, job);
+        }
     }
 
     return trees;
@@ -2121,7 +2380,7 @@ vector<ast::ParsedFile> Resolver::resolveMixesInClassMethods(core::MutableContex
 }
 
 void Resolver::sanityCheck(core::MutableContext ctx, vector<ast::ParsedFile> &trees) {
-    if (debug_mode) {
+    if (slow_debug_mode) {
         Timer timeit(ctx.state.tracer(), "resolver.sanity_check");
         ResolveSanityCheckWalk sanity;
         for (auto &tree : trees) {
@@ -2130,13 +2389,13 @@ void Resolver::sanityCheck(core::MutableContext ctx, vector<ast::ParsedFile> &tr
     }
 }
 
-vector<ast::ParsedFile> Resolver::runTreePasses(core::MutableContext ctx, vector<ast::ParsedFile> trees) {
-    auto workers = WorkerPool::create(0, ctx.state.tracer());
-    trees = ResolveConstantsWalk::resolveConstants(ctx, std::move(trees), *workers);
+vector<ast::ParsedFile> Resolver::runTreePasses(core::MutableContext ctx, vector<ast::ParsedFile> trees,
+                                                WorkerPool &workers) {
+    trees = ResolveConstantsWalk::resolveConstants(ctx, std::move(trees), workers);
     trees = resolveMixesInClassMethods(ctx, std::move(trees));
     computeLinearization(ctx.state);
     trees = ResolveTypeParamsWalk::run(ctx, std::move(trees));
-    trees = resolveSigs(ctx, std::move(trees));
+    trees = resolveSigs(ctx, std::move(trees), workers);
     sanityCheck(ctx, trees);
     // This check is FAR too slow to run on large codebases, especially with sanitizers on.
     // But it can be super useful to uncomment when debugging certain issues.
@@ -2145,6 +2404,25 @@ vector<ast::ParsedFile> Resolver::runTreePasses(core::MutableContext ctx, vector
     return trees;
 }
 
+vector<ast::ParsedFile> Resolver::runTreePassesWithNewDefinitions(core::MutableContext ctx,
+                                                                  vector<ast::ParsedFile> trees, WorkerPool &workers,
+                                                                  u4 firstNewSymbol) {
+    // Same phase order as `run`, with the global passes scoped to the symbols namer just created.
+    // Symbols below `firstNewSymbol` were finalized by a previous `run` and, since these trees only
+    // introduce strictly new definitions, cannot have been modified in a way that needs
+    // re-finalization; `computeLinearization` inside `finalizeSymbols` is still global, so classes
+    // whose linearization was invalidated by new mixins get recomputed.
+    trees = ResolveConstantsWalk::resolveConstants(ctx, std::move(trees), workers);
+    finalizeAncestors(ctx.state, firstNewSymbol);
+    trees = resolveMixesInClassMethods(ctx, std::move(trees));
+    finalizeSymbols(ctx.state, firstNewSymbol);
+    trees = ResolveTypeParamsWalk::run(ctx, std::move(trees));
+    trees = resolveSigs(ctx, std::move(trees), workers);
+    sanityCheck(ctx, trees);
+
+    return trees;
+}
+
 vector<ast::ParsedFile> Resolver::runConstantResolution(core::MutableContext ctx, vector<ast::ParsedFile> trees,
                                                         WorkerPool &workers) {
     trees = ResolveConstantsWalk::resolveConstants(ctx, std::move(trees), workers);
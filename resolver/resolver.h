@@ -16,17 +16,27 @@ public:
     /** Only runs tree passes, used for incremental changes that do not affect global state. Assumes that `run` was
      * called on a tree that contains same definitions before (LSP uses heuristics that should only have false negatives
      * to find this) */
-    static std::vector<ast::ParsedFile> runTreePasses(core::MutableContext ctx, std::vector<ast::ParsedFile> trees);
+    static std::vector<ast::ParsedFile> runTreePasses(core::MutableContext ctx, std::vector<ast::ParsedFile> trees,
+                                                      WorkerPool &workers);
+
+    /** Like runTreePasses, but for trees that introduce strictly new definitions (e.g. a freshly
+     * added RBI file): additionally runs the global finalization passes, scoped to symbols with ids
+     * at or above `firstNewSymbol` so that already-finalized symbols are not finalized twice (which
+     * would, among other things, duplicate `ClassMethods` mixins on their singletons). */
+    static std::vector<ast::ParsedFile> runTreePassesWithNewDefinitions(core::MutableContext ctx,
+                                                                        std::vector<ast::ParsedFile> trees,
+                                                                        WorkerPool &workers, u4 firstNewSymbol);
 
     // used by autogen only
     static std::vector<ast::ParsedFile> runConstantResolution(core::MutableContext ctx,
                                                               std::vector<ast::ParsedFile> trees, WorkerPool &workers);
 
 private:
-    static void finalizeAncestors(core::GlobalState &gs);
-    static void finalizeSymbols(core::GlobalState &gs);
+    static void finalizeAncestors(core::GlobalState &gs, u4 firstSymbol = 1);
+    static void finalizeSymbols(core::GlobalState &gs, u4 firstSymbol = 1);
     static void computeLinearization(core::GlobalState &gs);
-    static std::vector<ast::ParsedFile> resolveSigs(core::MutableContext ctx, std::vector<ast::ParsedFile> trees);
+    static std::vector<ast::ParsedFile> resolveSigs(core::MutableContext ctx, std::vector<ast::ParsedFile> trees,
+                                                    WorkerPool &workers);
     static std::vector<ast::ParsedFile> resolveMixesInClassMethods(core::MutableContext ctx,
                                                                    std::vector<ast::ParsedFile> trees);
     static void sanityCheck(core::MutableContext ctx, std::vector<ast::ParsedFile> &trees);
@@ -1,6 +1,7 @@
 #include "resolver/type_syntax.h"
 #include "absl/strings/str_join.h"
 #include "common/typecase.h"
+#include "core/ErrorQueue.h"
 #include "core/Names.h"
 #include "core/Symbols.h"
 #include "core/core.h"
@@ -547,25 +548,141 @@ core::TypePtr TypeSyntax::getResultType(core::MutableContext ctx, ast::Expressio
     return getResultTypeAndBind(ctx, expr, sigBeingParsed, args.withoutRebind()).type;
 }
 
+namespace {
+
+// Memoizes TypeSyntax::getResultTypeAndBind across structurally identical type expressions resolved
+// in the same owner. Large codebases repeat the same handful of sig shapes (T.nilable(String),
+// T::Array[Integer], ...) thousands of times; after constant resolution those expressions hash to
+// the same key and can share one resolution. The key covers the expression's structure (node kinds,
+// resolved symbols, names, literal values), the owner, and the TypeSyntaxArgs flags. Results depend
+// on the symbol table, so the memo is invalidated whenever the GlobalState's symbolTableGeneration
+// moves on. Per-thread, bounded, dropped wholesale when full.
+struct SigTypeMemo {
+    static constexpr size_t MAX_ENTRIES = 8192;
+    struct Entry {
+        core::TypePtr type;
+        core::SymbolRef rebind;
+    };
+    unsigned int generation = 0;
+    UnorderedMap<u8, Entry> entries;
+};
+thread_local SigTypeMemo sigTypeMemo;
+
+void hashMix(u8 &acc, u8 val) {
+    acc = (acc ^ val) * 1099511628211ULL; // FNV-1a step
+}
+
+// Folds a structural hash of a type-syntax expression into `acc`. Returns false when the expression
+// must not be memoized: T.type_parameter resolves against the sig being parsed, and T.proc parses a
+// nested sig that can reference the enclosing one's type parameters. Unrecognized syntax is also
+// rejected; it reports an error carrying the occurrence's loc, which must happen at every site.
+bool hashTypeExpr(const ast::Expression *expr, u8 &acc) {
+    if (auto *cnst = ast::cast_tree_const<ast::ConstantLit>(expr)) {
+        hashMix(acc, 1);
+        hashMix(acc, cnst->symbol._id);
+        return true;
+    }
+    if (auto *arr = ast::cast_tree_const<ast::Array>(expr)) {
+        hashMix(acc, 2);
+        hashMix(acc, arr->elems.size());
+        for (auto &el : arr->elems) {
+            if (!hashTypeExpr(el.get(), acc)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (auto *hash = ast::cast_tree_const<ast::Hash>(expr)) {
+        hashMix(acc, 3);
+        hashMix(acc, hash->keys.size());
+        for (auto &key : hash->keys) {
+            if (!hashTypeExpr(key.get(), acc)) {
+                return false;
+            }
+        }
+        for (auto &value : hash->values) {
+            if (!hashTypeExpr(value.get(), acc)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (auto *lit = ast::cast_tree_const<ast::Literal>(expr)) {
+        auto *litType = core::cast_type<core::LiteralType>(lit->value.get());
+        if (litType == nullptr) {
+            return false;
+        }
+        hashMix(acc, 4);
+        hashMix(acc, static_cast<u8>(litType->literalKind));
+        hashMix(acc, static_cast<u8>(litType->value));
+        return true;
+    }
+    if (auto *send = ast::cast_tree_const<ast::Send>(expr)) {
+        if (send->fun == core::Names::typeParameter() || send->fun == core::Names::proc() ||
+            send->block != nullptr) {
+            return false;
+        }
+        hashMix(acc, 5);
+        hashMix(acc, send->fun._id);
+        hashMix(acc, send->args.size());
+        if (!hashTypeExpr(send->recv.get(), acc)) {
+            return false;
+        }
+        for (auto &arg : send->args) {
+            if (!hashTypeExpr(arg.get(), acc)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (auto *local = ast::cast_tree_const<ast::Local>(expr)) {
+        // `self` resolves through ctx.owner, which is part of the memo key.
+        return local->isSelfReference();
+    }
+    return false;
+}
+
+} // namespace
+
 TypeSyntax::ResultType TypeSyntax::getResultTypeAndBind(core::MutableContext ctx, ast::Expression &expr,
                                                         const ParsedSig &sigBeingParsed, TypeSyntaxArgs args) {
     // Ensure that we only check types from a class context
     auto ctxOwnerData = ctx.owner.data(ctx);
     ENFORCE(ctxOwnerData->isClassOrModule(), "getResultTypeAndBind wasn't called with a class owner");
 
+    u8 key = 14695981039346656037ULL; // FNV-1a offset basis
+    SigTypeMemo *memo = nullptr;
+    if (hashTypeExpr(&expr, key)) {
+        hashMix(key, ctx.owner._id);
+        hashMix(key, args.untypedBlame._id);
+        hashMix(key, (args.allowSelfType ? 1 : 0) | (args.allowRebind ? 2 : 0) | (args.allowTypeMember ? 4 : 0));
+        memo = &sigTypeMemo;
+        if (memo->generation != ctx.state.symbolTableGeneration) {
+            memo->entries.clear();
+            memo->generation = ctx.state.symbolTableGeneration;
+        }
+        auto it = memo->entries.find(key);
+        if (it != memo->entries.end()) {
+            categoryCounterInc("types.sig_type_memo", "hit");
+            return ResultType{it->second.type, it->second.rebind};
+        }
+        categoryCounterInc("types.sig_type_memo", "miss");
+    }
+    int errorsBefore = memo != nullptr ? ctx.state.errorQueue->nonSilencedErrorCount.load() : 0;
+
     ResultType result;
     typecase(
         &expr,
         [&](ast::Array *arr) {
-            vector<core::TypePtr> elems;
+            core::TypeElems elems;
             for (auto &el : arr->elems) {
                 elems.emplace_back(getResultType(ctx, *el, sigBeingParsed, args.withoutSelfType()));
             }
             result.type = core::TupleType::build(ctx, elems);
         },
         [&](ast::Hash *hash) {
-            vector<core::TypePtr> keys;
-            vector<core::TypePtr> values;
+            core::TypeElems keys;
+            core::TypeElems values;
 
             for (auto &ktree : hash->keys) {
                 auto &vtree = hash->values[&ktree - &hash->keys.front()];
@@ -914,6 +1031,15 @@ TypeSyntax::ResultType TypeSyntax::getResultTypeAndBind(core::MutableContext ctx
         });
     ENFORCE(result.type.get() != nullptr);
     result.type->sanityCheck(ctx);
+    // Resolutions that reported an error (or produced untyped, which silenced error paths do) stay
+    // uncached so that every occurrence of a malformed type re-reports at its own loc.
+    if (memo != nullptr && !result.type->isUntyped() &&
+        ctx.state.errorQueue->nonSilencedErrorCount.load() == errorsBefore) {
+        if (memo->entries.size() >= SigTypeMemo::MAX_ENTRIES) {
+            memo->entries.clear();
+        }
+        memo->entries[key] = SigTypeMemo::Entry{result.type, result.rebind};
+    }
     return result;
 } // namespace sorbet::resolver
 
@@ -17,18 +17,20 @@ unique_ptr<ast::Expression> addSigVoid(unique_ptr<ast::Expression> expr) {
 }
 } // namespace
 
-unique_ptr<ast::Expression> recurse(core::MutableContext ctx, unique_ptr<ast::Expression> body);
+unique_ptr<ast::Expression> recurse(core::MutableContext ctx, unique_ptr<ast::Expression> body,
+                                    Minitest::ExpansionStats &stats);
 
-unique_ptr<ast::Expression> prepareBody(core::MutableContext ctx, unique_ptr<ast::Expression> body) {
-    body = recurse(ctx, std::move(body));
+unique_ptr<ast::Expression> prepareBody(core::MutableContext ctx, unique_ptr<ast::Expression> body,
+                                        Minitest::ExpansionStats &stats) {
+    body = recurse(ctx, std::move(body), stats);
 
     auto bodySeq = ast::cast_tree<ast::InsSeq>(body.get());
     if (bodySeq) {
         for (auto &exp : bodySeq->stats) {
-            exp = recurse(ctx, std::move(exp));
+            exp = recurse(ctx, std::move(exp), stats);
         }
 
-        bodySeq->expr = recurse(ctx, std::move(bodySeq->expr));
+        bodySeq->expr = recurse(ctx, std::move(bodySeq->expr), stats);
     }
     return body;
 }
@@ -50,7 +52,7 @@ string to_s(core::Context ctx, unique_ptr<ast::Expression> &arg) {
     return arg->toString(ctx);
 }
 
-unique_ptr<ast::Expression> runSingle(core::MutableContext ctx, ast::Send *send) {
+unique_ptr<ast::Expression> runSingle(core::MutableContext ctx, ast::Send *send, Minitest::ExpansionStats &stats) {
     if (send->block == nullptr) {
         return nullptr;
     }
@@ -60,8 +62,10 @@ unique_ptr<ast::Expression> runSingle(core::MutableContext ctx, ast::Send *send)
     }
 
     if (send->args.empty() && (send->fun == core::Names::before() || send->fun == core::Names::after())) {
+        stats.helpers++;
         auto name = send->fun == core::Names::after() ? core::Names::afterAngles() : core::Names::initialize();
-        return addSigVoid(ast::MK::Method0(send->loc, send->loc, name, prepareBody(ctx, std::move(send->block->body)),
+        return addSigVoid(ast::MK::Method0(send->loc, send->loc, name,
+                                           prepareBody(ctx, std::move(send->block->body), stats),
                                            ast::MethodDef::RewriterSynthesized));
     }
 
@@ -72,28 +76,31 @@ unique_ptr<ast::Expression> runSingle(core::MutableContext ctx, ast::Send *send)
     auto argString = to_s(ctx, arg);
 
     if (send->fun == core::Names::describe()) {
+        stats.describes++;
         ast::ClassDef::ANCESTORS_store ancestors;
         ancestors.emplace_back(ast::MK::Self(arg->loc));
         ast::ClassDef::RHS_store rhs;
-        rhs.emplace_back(prepareBody(ctx, std::move(send->block->body)));
+        rhs.emplace_back(prepareBody(ctx, std::move(send->block->body), stats));
         auto name = ast::MK::UnresolvedConstant(arg->loc, ast::MK::EmptyTree(),
                                                 ctx.state.enterNameConstant("<class_" + argString + ">"));
         return ast::MK::Class(send->loc, send->loc, std::move(name), std::move(ancestors), std::move(rhs),
                               ast::ClassDefKind::Class);
     } else if (send->fun == core::Names::it()) {
+        stats.examples++;
         auto name = ctx.state.enterNameUTF8("<test_" + argString + ">");
         return addSigVoid(ast::MK::Method0(send->loc, send->loc, std::move(name),
-                                           prepareBody(ctx, std::move(send->block->body)),
+                                           prepareBody(ctx, std::move(send->block->body), stats),
                                            ast::MethodDef::RewriterSynthesized));
     }
 
     return nullptr;
 }
 
-unique_ptr<ast::Expression> recurse(core::MutableContext ctx, unique_ptr<ast::Expression> body) {
+unique_ptr<ast::Expression> recurse(core::MutableContext ctx, unique_ptr<ast::Expression> body,
+                                    Minitest::ExpansionStats &stats) {
     auto bodySend = ast::cast_tree<ast::Send>(body.get());
     if (bodySend) {
-        auto change = runSingle(ctx, bodySend);
+        auto change = runSingle(ctx, bodySend, stats);
         if (change) {
             return change;
         }
@@ -101,17 +108,17 @@ unique_ptr<ast::Expression> recurse(core::MutableContext ctx, unique_ptr<ast::Ex
     return body;
 }
 
-vector<unique_ptr<ast::Expression>> Minitest::run(core::MutableContext ctx, ast::Send *send) {
-    vector<unique_ptr<ast::Expression>> stats;
+vector<unique_ptr<ast::Expression>> Minitest::run(core::MutableContext ctx, ast::Send *send, ExpansionStats &stats) {
+    vector<unique_ptr<ast::Expression>> exprs;
     if (ctx.state.runningUnderAutogen) {
-        return stats;
+        return exprs;
     }
 
-    auto exp = runSingle(ctx, send);
+    auto exp = runSingle(ctx, send, stats);
     if (exp != nullptr) {
-        stats.emplace_back(std::move(exp));
+        exprs.emplace_back(std::move(exp));
     }
-    return stats;
+    return exprs;
 }
 
 }; // namespace sorbet::rewriter
@@ -32,7 +32,17 @@ namespace sorbet::rewriter {
  */
 class Minitest final {
 public:
-    static std::vector<std::unique_ptr<ast::Expression>> run(core::MutableContext ctx, ast::Send *send);
+    // How much synthesized structure one file's expansions produced. Large spec files turn into
+    // one method per example, so these counts (not byte size) predict how much the file costs in
+    // namer and typecheck; the driver aggregates them per file and reports them as counters.
+    struct ExpansionStats {
+        u4 examples = 0;
+        u4 describes = 0;
+        u4 helpers = 0; // before/after blocks
+    };
+
+    static std::vector<std::unique_ptr<ast::Expression>> run(core::MutableContext ctx, ast::Send *send,
+                                                             ExpansionStats &stats);
 
     Minitest() = delete;
 };
@@ -349,4 +349,40 @@ unique_ptr<ast::Expression> Flatten::run(core::Context ctx, unique_ptr<ast::Expr
     return tree;
 }
 
+class Flatten::Walk::Impl final : public FlattenWalk {};
+
+Flatten::Walk::Walk() : impl(make_unique<Impl>()) {}
+Flatten::Walk::~Walk() = default;
+
+unique_ptr<ast::ClassDef> Flatten::Walk::preTransformClassDef(core::Context ctx, unique_ptr<ast::ClassDef> classDef) {
+    return impl->preTransformClassDef(ctx, std::move(classDef));
+}
+
+unique_ptr<ast::Expression> Flatten::Walk::postTransformClassDef(core::Context ctx,
+                                                                 unique_ptr<ast::ClassDef> classDef) {
+    return impl->postTransformClassDef(ctx, std::move(classDef));
+}
+
+unique_ptr<ast::Send> Flatten::Walk::preTransformSend(core::Context ctx, unique_ptr<ast::Send> send) {
+    return impl->preTransformSend(ctx, std::move(send));
+}
+
+unique_ptr<ast::Expression> Flatten::Walk::postTransformSend(core::Context ctx, unique_ptr<ast::Send> send) {
+    return impl->postTransformSend(ctx, std::move(send));
+}
+
+unique_ptr<ast::MethodDef> Flatten::Walk::preTransformMethodDef(core::Context ctx,
+                                                                unique_ptr<ast::MethodDef> methodDef) {
+    return impl->preTransformMethodDef(ctx, std::move(methodDef));
+}
+
+unique_ptr<ast::Expression> Flatten::Walk::postTransformMethodDef(core::Context ctx,
+                                                                  unique_ptr<ast::MethodDef> methodDef) {
+    return impl->postTransformMethodDef(ctx, std::move(methodDef));
+}
+
+unique_ptr<ast::Expression> Flatten::Walk::finish(core::Context ctx, unique_ptr<ast::Expression> tree) {
+    return impl->addTopLevelMethods(ctx, std::move(tree));
+}
+
 } // namespace sorbet::rewriter
@@ -8,6 +8,32 @@ class Flatten final {
 public:
     static std::unique_ptr<ast::Expression> run(core::Context ctx, std::unique_ptr<ast::Expression> tree);
 
+    // Streaming interface onto the flattening walk, for fusing it into another structural pass's
+    // traversal (local_vars does this; see LocalVars::runWithFlatten). The host visitor forwards
+    // these hooks from its own TreeMap traversal and calls finish() on the mapped tree to
+    // re-attach hoisted top-level methods. Equivalent to run(), minus the dedicated traversal.
+    class Walk final {
+    public:
+        Walk();
+        ~Walk();
+
+        std::unique_ptr<ast::ClassDef> preTransformClassDef(core::Context ctx,
+                                                            std::unique_ptr<ast::ClassDef> classDef);
+        std::unique_ptr<ast::Expression> postTransformClassDef(core::Context ctx,
+                                                               std::unique_ptr<ast::ClassDef> classDef);
+        std::unique_ptr<ast::Send> preTransformSend(core::Context ctx, std::unique_ptr<ast::Send> send);
+        std::unique_ptr<ast::Expression> postTransformSend(core::Context ctx, std::unique_ptr<ast::Send> send);
+        std::unique_ptr<ast::MethodDef> preTransformMethodDef(core::Context ctx,
+                                                              std::unique_ptr<ast::MethodDef> methodDef);
+        std::unique_ptr<ast::Expression> postTransformMethodDef(core::Context ctx,
+                                                                std::unique_ptr<ast::MethodDef> methodDef);
+        std::unique_ptr<ast::Expression> finish(core::Context ctx, std::unique_ptr<ast::Expression> tree);
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> impl;
+    };
+
     Flatten() = delete;
 };
 
@@ -1,6 +1,7 @@
 #include "rewriter/rewriter.h"
 #include "ast/treemap/treemap.h"
 #include "ast/verifier/verifier.h"
+#include "common/Counters.h"
 #include "common/typecase.h"
 #include "main/pipeline/semantic_extension/SemanticExtension.h"
 #include "rewriter/ClassNew.h"
@@ -24,20 +25,159 @@
 #include "rewriter/flatten.h"
 #include "rewriter/module_function.h"
 
+#include "absl/strings/str_cat.h"
+
 using namespace std;
 
 namespace sorbet::rewriter {
 
+namespace {
+
+// Each per-Send pass triggers on a small fixed set of method names and returns nothing for every
+// other send, so running all of them on every statement multiplies a per-send cost by the number of
+// passes. Classify the send's name once against a shared table and invoke only candidate passes.
+// The trigger sets below mirror the gates at the top of each pass's `run`, which remain the source
+// of truth; a send name missing here means the pass is silently never invoked, so keep them in
+// sync when adding names to a pass.
+enum SendPass : u4 {
+    PASS_NONE = 0,
+    PASS_MIXIN_ENCRYPTED_PROP = 1 << 0,
+    PASS_MINITEST = 1 << 1,
+    PASS_DSL_BUILDER = 1 << 2,
+    PASS_PRIVATE = 1 << 3,
+    PASS_DELEGATE = 1 << 4,
+    PASS_ATTR_READER = 1 << 5,
+    PASS_MATTR = 1 << 6,
+};
+
+u4 sendPassesFor(core::NameRef fun) {
+    static const UnorderedMap<int, u4> table = [] {
+        UnorderedMap<int, u4> t;
+        auto add = [&t](core::NameRef name, u4 pass) { t[name.id()] |= pass; };
+        add(core::Names::encrypted_prop(), PASS_MIXIN_ENCRYPTED_PROP);
+        add(core::Names::before(), PASS_MINITEST);
+        add(core::Names::after(), PASS_MINITEST);
+        add(core::Names::describe(), PASS_MINITEST);
+        add(core::Names::it(), PASS_MINITEST);
+        add(core::Names::dslOptional(), PASS_DSL_BUILDER);
+        add(core::Names::dslRequired(), PASS_DSL_BUILDER);
+        add(core::Names::private_(), PASS_PRIVATE);
+        add(core::Names::privateClassMethod(), PASS_PRIVATE);
+        add(core::Names::delegate(), PASS_DELEGATE);
+        add(core::Names::attr(), PASS_ATTR_READER);
+        add(core::Names::attrReader(), PASS_ATTR_READER);
+        add(core::Names::attrWriter(), PASS_ATTR_READER);
+        add(core::Names::attrAccessor(), PASS_ATTR_READER);
+        add(core::Names::mattrReader(), PASS_MATTR);
+        add(core::Names::mattrWriter(), PASS_MATTR);
+        add(core::Names::mattrAccessor(), PASS_MATTR);
+        add(core::Names::cattrReader(), PASS_MATTR);
+        add(core::Names::cattrWriter(), PASS_MATTR);
+        add(core::Names::cattrAccessor(), PASS_MATTR);
+        add(core::Names::classAttribute(), PASS_MATTR);
+        return t;
+    }();
+    auto it = table.find(fun.id());
+    return it == table.end() ? PASS_NONE : it->second;
+}
+
+// The class-level and assign-level passes can't be classified per send, but each of them still
+// triggers on a fixed vocabulary: a method name or a constant that must appear literally in the
+// file's text for the pass to ever fire. A single scan over the source classifies the whole file
+// before the tree walk, so files without any DSL vocabulary (most of them) skip these passes
+// outright. False positives — the word in a comment or a string — only cost running a pass that
+// then does nothing, so the scan can stay purely lexical. DefaultArgs is deliberately absent: it
+// triggers on method structure (a default argument value), not on any name.
+enum FilePass : u4 {
+    FILE_PASS_COMMAND = 1 << 0,
+    FILE_PASS_RAILS = 1 << 1,
+    FILE_PASS_OPUS_ENUM = 1 << 2,
+    FILE_PASS_PROP = 1 << 3,
+    FILE_PASS_TYPE_MEMBERS = 1 << 4,
+    FILE_PASS_STRUCT = 1 << 5,
+    FILE_PASS_CLASS_NEW = 1 << 6,
+    FILE_PASS_PROTOBUF_DESCRIPTOR_POOL = 1 << 7,
+    FILE_PASS_REGEXP = 1 << 8,
+    FILE_PASS_MODULE_FUNCTION = 1 << 9,
+    FILE_PASS_INTERFACE_WRAPPER = 1 << 10,
+};
+constexpr u4 FILE_PASS_ALL = (1 << 11) - 1;
+
+bool isIdentifierChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+u4 filePassesFor(const core::GlobalState &gs, core::FileRef file) {
+    // As with sendPassesFor, the gates inside each pass remain the source of truth; a trigger
+    // missing here silently disables its pass, so keep the table in sync.
+    static const UnorderedMap<std::string_view, u4> triggers = {
+        {"Command", FILE_PASS_COMMAND},
+        {"Migration", FILE_PASS_RAILS},
+        {"Enum", FILE_PASS_OPUS_ENUM},
+        {"prop", FILE_PASS_PROP},
+        {"const", FILE_PASS_PROP},
+        {"token_prop", FILE_PASS_PROP},
+        {"timestamped_token_prop", FILE_PASS_PROP},
+        {"created_prop", FILE_PASS_PROP},
+        {"merchant_prop", FILE_PASS_PROP},
+        {"type_member", FILE_PASS_TYPE_MEMBERS},
+        {"Struct", FILE_PASS_STRUCT},
+        {"Class", FILE_PASS_CLASS_NEW},
+        {"DescriptorPool", FILE_PASS_PROTOBUF_DESCRIPTOR_POOL},
+        {"Regexp", FILE_PASS_REGEXP},
+        {"module_function", FILE_PASS_MODULE_FUNCTION},
+        {"wrap_instance", FILE_PASS_INTERFACE_WRAPPER},
+    };
+    constexpr size_t SHORTEST_TRIGGER = 4;  // "prop"
+    constexpr size_t LONGEST_TRIGGER = 22;  // "timestamped_token_prop"
+
+    auto source = file.data(gs).source();
+    u4 passes = 0;
+    size_t i = 0;
+    while (i < source.size() && passes != FILE_PASS_ALL) {
+        if (!isIdentifierChar(source[i])) {
+            i++;
+            continue;
+        }
+        auto start = i;
+        while (i < source.size() && isIdentifierChar(source[i])) {
+            i++;
+        }
+        auto len = i - start;
+        if (len < SHORTEST_TRIGGER || len > LONGEST_TRIGGER) {
+            continue;
+        }
+        auto it = triggers.find(source.substr(start, len));
+        if (it != triggers.end()) {
+            passes |= it->second;
+        }
+    }
+    return passes;
+}
+
+} // namespace
+
 class Rewriterer {
     friend class Rewriter;
 
 public:
     unique_ptr<ast::ClassDef> postTransformClassDef(core::MutableContext ctx, unique_ptr<ast::ClassDef> classDef) {
-        Command::run(ctx, classDef.get());
-        Rails::run(ctx, classDef.get());
-        OpusEnum::run(ctx, classDef.get());
-        Prop::run(ctx, classDef.get());
-        TypeMembers::run(ctx, classDef.get());
+        if (filePasses & FILE_PASS_COMMAND) {
+            Command::run(ctx, classDef.get());
+        }
+        if (filePasses & FILE_PASS_RAILS) {
+            Rails::run(ctx, classDef.get());
+        }
+        if (filePasses & FILE_PASS_OPUS_ENUM) {
+            OpusEnum::run(ctx, classDef.get());
+        }
+        if (filePasses & FILE_PASS_PROP) {
+            Prop::run(ctx, classDef.get());
+        }
+        if (filePasses & FILE_PASS_TYPE_MEMBERS) {
+            TypeMembers::run(ctx, classDef.get());
+        }
+        // Not gated on the file pre-scan: triggered by default argument values, not names.
         DefaultArgs::run(ctx, classDef.get());
 
         for (auto &extension : ctx.state.semanticExtensions) {
@@ -52,76 +192,102 @@ public:
                 [&](ast::Assign *assign) {
                     vector<unique_ptr<ast::Expression>> nodes;
 
-                    nodes = Struct::run(ctx, assign);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (filePasses & FILE_PASS_STRUCT) {
+                        nodes = Struct::run(ctx, assign);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    nodes = ClassNew::run(ctx, assign);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (filePasses & FILE_PASS_CLASS_NEW) {
+                        nodes = ClassNew::run(ctx, assign);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    nodes = ProtobufDescriptorPool::run(ctx, assign);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (filePasses & FILE_PASS_PROTOBUF_DESCRIPTOR_POOL) {
+                        nodes = ProtobufDescriptorPool::run(ctx, assign);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    nodes = Regexp::run(ctx, assign);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (filePasses & FILE_PASS_REGEXP) {
+                        nodes = Regexp::run(ctx, assign);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
                 },
 
                 [&](ast::Send *send) {
+                    auto passes = sendPassesFor(send->fun);
+                    if (passes == PASS_NONE) {
+                        return;
+                    }
                     vector<unique_ptr<ast::Expression>> nodes;
 
-                    nodes = MixinEncryptedProp::run(ctx, send);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (passes & PASS_MIXIN_ENCRYPTED_PROP) {
+                        nodes = MixinEncryptedProp::run(ctx, send);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    nodes = Minitest::run(ctx, send);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = move(nodes);
-                        return;
+                    if (passes & PASS_MINITEST) {
+                        nodes = Minitest::run(ctx, send, minitestStats);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = move(nodes);
+                            return;
+                        }
                     }
 
-                    nodes = DSLBuilder::run(ctx, send);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (passes & PASS_DSL_BUILDER) {
+                        nodes = DSLBuilder::run(ctx, send);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    nodes = Private::run(ctx, send);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (passes & PASS_PRIVATE) {
+                        nodes = Private::run(ctx, send);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    nodes = Delegate::run(ctx, send);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (passes & PASS_DELEGATE) {
+                        nodes = Delegate::run(ctx, send);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    // This one is different: it gets an extra prevStat argument.
-                    nodes = AttrReader::run(ctx, send, prevStat);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (passes & PASS_ATTR_READER) {
+                        // This one is different: it gets an extra prevStat argument.
+                        nodes = AttrReader::run(ctx, send, prevStat);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
 
-                    // This one is also a little different: it gets the ClassDef kind
-                    nodes = Mattr::run(ctx, send, classDef->kind);
-                    if (!nodes.empty()) {
-                        replaceNodes[stat.get()] = std::move(nodes);
-                        return;
+                    if (passes & PASS_MATTR) {
+                        // This one is also a little different: it gets the ClassDef kind
+                        nodes = Mattr::run(ctx, send, classDef->kind);
+                        if (!nodes.empty()) {
+                            replaceNodes[stat.get()] = std::move(nodes);
+                            return;
+                        }
                     }
                 },
 
@@ -130,7 +296,9 @@ public:
             prevStat = stat.get();
         }
         if (replaceNodes.empty()) {
-            ModuleFunction::run(ctx, classDef.get());
+            if (filePasses & FILE_PASS_MODULE_FUNCTION) {
+                ModuleFunction::run(ctx, classDef.get());
+            }
             return classDef;
         }
 
@@ -147,29 +315,65 @@ public:
                 }
             }
         }
-        ModuleFunction::run(ctx, classDef.get());
+        if (filePasses & FILE_PASS_MODULE_FUNCTION) {
+            ModuleFunction::run(ctx, classDef.get());
+        }
 
         return classDef;
     }
 
     unique_ptr<ast::Expression> postTransformSend(core::MutableContext ctx, unique_ptr<ast::Send> send) {
+        if (!(filePasses & FILE_PASS_INTERFACE_WRAPPER)) {
+            return send;
+        }
         return InterfaceWrapper::run(ctx, std::move(send));
     }
 
+    // Which name-triggered passes can fire anywhere in this file; see filePassesFor.
+    u4 filePasses = FILE_PASS_ALL;
+
+    // Accumulated across the whole walk, so nested describes report into one per-file total.
+    Minitest::ExpansionStats minitestStats;
+
 private:
     Rewriterer() = default;
 };
 
-unique_ptr<ast::Expression> Rewriter::run(core::MutableContext ctx, unique_ptr<ast::Expression> tree) {
+unique_ptr<ast::Expression> Rewriter::run(core::MutableContext ctx, unique_ptr<ast::Expression> tree, bool runFlatten) {
     auto ast = std::move(tree);
 
     Rewriterer rewriter;
+    if (ast->loc.exists()) {
+        rewriter.filePasses = filePassesFor(ctx.state, ast->loc.file());
+    }
+    prodCounterInc("rewriter.prescan.files");
+    if (rewriter.filePasses == 0) {
+        // The walk still runs for DefaultArgs, but every name-triggered pass is a no-op.
+        prodCounterInc("rewriter.prescan.trigger_free_files");
+    }
     ast = ast::TreeMap::apply(ctx, rewriter, std::move(ast));
+
+    auto &minitest = rewriter.minitestStats;
+    if (minitest.examples > 0 || minitest.describes > 0 || minitest.helpers > 0) {
+        // Each example expands into a synthesized sig + method (and each describe into a class), so
+        // for big spec files these counts, not byte size, predict the file's namer/typecheck cost.
+        // The histogram gives the fleet-wide distribution; the trace line names each file so the
+        // worst offenders can be read out of a single traced run.
+        counterAdd("rewriter.minitest.examples", minitest.examples);
+        counterAdd("rewriter.minitest.describes", minitest.describes);
+        counterAdd("rewriter.minitest.helpers", minitest.helpers);
+        histogramInc("rewriter.minitest.examples_per_file", minitest.examples);
+        ctx.state.trace(absl::StrCat("minitest expansion: file=", ast->loc.file().data(ctx.state).path(),
+                                     " examples=", minitest.examples, " describes=", minitest.describes,
+                                     " helpers=", minitest.helpers));
+    }
     // This AST flattening pass requires that we mutate the AST in a way that our previous DSL passes were not designed
     // around, which is why it runs all at once and is not expressed as a `patch` method like the other DSL passes. This
     // is a rare case: in general, we should *not* add new DSL passes here.
-    auto flattened = Flatten::run(ctx, std::move(ast));
-    auto verifiedResult = ast::Verifier::run(ctx, std::move(flattened));
+    if (runFlatten) {
+        ast = Flatten::run(ctx, std::move(ast));
+    }
+    auto verifiedResult = ast::Verifier::run(ctx, std::move(ast));
     return verifiedResult;
 }
 
@@ -7,7 +7,12 @@ namespace sorbet::rewriter {
 
 class Rewriter final {
 public:
-    static std::unique_ptr<ast::Expression> run(core::MutableContext ctx, std::unique_ptr<ast::Expression> tree);
+    // Runs the DSL passes, then (by default) the flattening walk that hoists nested definitions to
+    // class scope. Callers that immediately run local_vars afterwards pass `runFlatten = false`
+    // and use LocalVars::runWithFlatten instead, which fuses the flattening walk into the naming
+    // walk and saves a full tree traversal per file.
+    static std::unique_ptr<ast::Expression> run(core::MutableContext ctx, std::unique_ptr<ast::Expression> tree,
+                                                bool runFlatten = true);
 
     Rewriter() = delete;
 };
@@ -0,0 +1,172 @@
+// Benchmark runner for the batch pipeline and the LSP edit path. Replays a captured workspace
+// snapshot (a directory of Ruby files) through pipeline::index/resolve/typecheck with per-phase
+// wall times, then optionally replays an edit sequence against the same workspace through
+// LSPWrapper, timing each didChange round trip. Results are tab-separated `metric<TAB>value`
+// lines on stdout, and the full counter state (including the types.memory.* allocation counters)
+// can be dumped as JSON for archival next to CI artifacts.
+//
+// Usage:
+//   pipeline_bench <workspace-dir> [--edit-file <path> --edit-count <n>] [--counters-file <path>]
+//
+// Run with -c opt; numbers from other configurations are not comparable.
+#include "common/FileOps.h"
+#include "common/concurrency/WorkerPool.h"
+#include "core/ErrorQueue.h"
+#include "core/Unfreeze.h"
+#include "core/core.h"
+#include "core/proto/proto.h"
+#include "main/lsp/LSPMessage.h"
+#include "main/lsp/lsp.h"
+#include "main/lsp/wrapper.h"
+#include "main/pipeline/pipeline.h"
+#include "payload/payload.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+#include "test/helpers/lsp.h"
+#include <chrono>
+#include <thread>
+
+namespace spd = spdlog;
+using namespace std;
+
+namespace sorbet::test {
+using namespace sorbet::realmain;
+
+namespace {
+
+double msSince(chrono::steady_clock::time_point start) {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count() / 1000.0;
+}
+
+void report(string_view metric, double ms) {
+    fmt::print("{}\t{:.1f}\n", metric, ms);
+}
+
+int runBench(string_view workspaceDir, string_view editFile, int editCount, string_view countersFile) {
+    auto logger = spd::stderr_color_mt("pipeline_bench");
+    logger->set_level(spd::level::err);
+
+    // Batch phases, timed separately so a regression lands with its phase attached.
+    {
+        options::Options opts;
+        // Mirror a typical CI invocation rather than the test default of zero workers.
+        opts.threads = max(1, static_cast<int>(thread::hardware_concurrency() / 2));
+        auto errorQueue = make_shared<core::ErrorQueue>(*logger, *logger);
+        auto gs = make_unique<core::GlobalState>(errorQueue);
+        // Diagnostics are not the workload; drop them so output formatting does not pollute the
+        // typecheck numbers.
+        gs->silenceErrors = true;
+        unique_ptr<KeyValueStore> kvstore;
+
+        auto startPayload = chrono::steady_clock::now();
+        payload::createInitialGlobalState(gs, opts, kvstore);
+        report("pipeline.payload_ms", msSince(startPayload));
+
+        auto files = FileOps::listFilesInDir(workspaceDir, {".rb", ".rbi"}, true, {}, {});
+        auto workers = WorkerPool::create(opts.threads, *logger);
+
+        vector<core::FileRef> inputFiles;
+        auto startIndex = chrono::steady_clock::now();
+        {
+            core::UnfreezeFileTable fileTableAccess(*gs);
+            inputFiles = pipeline::reserveFiles(gs, files);
+        }
+        auto indexed = pipeline::index(gs, move(inputFiles), opts, *workers, kvstore);
+        report("pipeline.index_ms", msSince(startIndex));
+
+        auto startResolve = chrono::steady_clock::now();
+        auto resolved = pipeline::resolve(gs, move(indexed), opts, *workers);
+        if (!resolved.hasResult()) {
+            logger->error("resolve was cancelled");
+            return 1;
+        }
+        report("pipeline.resolve_ms", msSince(startResolve));
+
+        auto startTypecheck = chrono::steady_clock::now();
+        auto typechecked = pipeline::typecheck(gs, move(resolved.result()), opts, *workers);
+        if (!typechecked.hasResult()) {
+            logger->error("typecheck was cancelled");
+            return 1;
+        }
+        report("pipeline.typecheck_ms", msSince(startTypecheck));
+        report("pipeline.files", files.size());
+    }
+
+    // Edit sequence through the LSP wrapper: didOpen once, then `editCount` didChange round
+    // trips. Each edit toggles a trailing comment, which keeps the file's structure (and thus the
+    // fast path) intact while still invalidating its content hash.
+    if (!editFile.empty() && editCount > 0) {
+        realmain::lsp::LSPWrapper lspWrapper(workspaceDir, false);
+        int nextId = 1;
+        auto rootUri = fmt::format("file://{}", workspaceDir);
+        initializeLSP(workspaceDir, rootUri, lspWrapper, nextId);
+
+        auto fileUri = fmt::format("{}/{}", rootUri, editFile);
+        auto source = FileOps::read(fmt::format("{}/{}", workspaceDir, editFile));
+        {
+            auto params = make_unique<realmain::lsp::DidOpenTextDocumentParams>(
+                make_unique<realmain::lsp::TextDocumentItem>(fileUri, "ruby", 1, source));
+            auto notif = make_unique<realmain::lsp::NotificationMessage>(
+                "2.0", realmain::lsp::LSPMethod::TextDocumentDidOpen, move(params));
+            lspWrapper.getLSPResponsesFor(make_unique<realmain::lsp::LSPMessage>(move(notif)));
+        }
+
+        double totalMs = 0;
+        double maxMs = 0;
+        for (int version = 2; version < editCount + 2; version++) {
+            auto edited = version % 2 == 0 ? source + "\n# bench edit\n" : source;
+            auto contentChange = make_unique<realmain::lsp::TextDocumentContentChangeEvent>(edited);
+            vector<unique_ptr<realmain::lsp::TextDocumentContentChangeEvent>> changes;
+            changes.emplace_back(move(contentChange));
+            auto params = make_unique<realmain::lsp::DidChangeTextDocumentParams>(
+                make_unique<realmain::lsp::VersionedTextDocumentIdentifier>(fileUri, version), move(changes));
+            auto notif = make_unique<realmain::lsp::NotificationMessage>(
+                "2.0", realmain::lsp::LSPMethod::TextDocumentDidChange, move(params));
+
+            auto startEdit = chrono::steady_clock::now();
+            lspWrapper.getLSPResponsesFor(make_unique<realmain::lsp::LSPMessage>(move(notif)));
+            auto editMs = msSince(startEdit);
+            totalMs += editMs;
+            maxMs = max(maxMs, editMs);
+        }
+        report("lsp.edits", editCount);
+        report("lsp.edit_mean_ms", totalMs / editCount);
+        report("lsp.edit_max_ms", maxMs);
+    }
+
+    if (!countersFile.empty()) {
+        auto counters = getAndClearThreadCounters();
+        auto metrics = core::Proto::toProto(counters, "bench");
+        FileOps::write(countersFile, core::Proto::toJSON(metrics));
+    }
+    return 0;
+}
+
+} // namespace
+} // namespace sorbet::test
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fmt::print(stderr,
+                   "Usage: pipeline_bench <workspace-dir> [--edit-file <path> --edit-count <n>] "
+                   "[--counters-file <path>]\n");
+        return 1;
+    }
+    std::string workspaceDir = argv[1];
+    std::string editFile;
+    std::string countersFile;
+    int editCount = 0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--edit-file") {
+            editFile = argv[i + 1];
+        } else if (flag == "--edit-count") {
+            editCount = atoi(argv[i + 1]);
+        } else if (flag == "--counters-file") {
+            countersFile = argv[i + 1];
+        } else {
+            fmt::print(stderr, "Unknown flag: {}\n", flag);
+            return 1;
+        }
+    }
+    return sorbet::test::runBench(workspaceDir, editFile, editCount, countersFile);
+}
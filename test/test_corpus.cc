@@ -103,11 +103,12 @@ public:
 class CFGCollectorAndTyper {
 public:
     vector<unique_ptr<cfg::CFG>> cfgs;
+    cfg::CFGScratch cfgScratch;
     unique_ptr<ast::MethodDef> preTransformMethodDef(core::Context ctx, unique_ptr<ast::MethodDef> m) {
         if (m->symbol.data(ctx)->isOverloaded()) {
             return m;
         }
-        auto cfg = cfg::CFGBuilder::buildFor(ctx.withOwner(m->symbol), *m);
+        auto cfg = cfg::CFGBuilder::buildFor(ctx.withOwner(m->symbol), *m, cfgScratch);
         cfg = infer::Inference::run(ctx.withOwner(cfg->symbol), move(cfg));
         cfgs.push_back(move(cfg));
         return m;
@@ -337,10 +338,11 @@ TEST_P(ExpectationTest, PerPhaseTest) { // NOLINT
         return lhs.file.data(ctx).source().size() > rhs.file.data(ctx).source().size();
     });
 
+    definition_validator::ValidatorCache validatorCache;
     for (auto &resolvedTree : trees) {
         auto file = resolvedTree.file;
 
-        resolvedTree = definition_validator::runOne(ctx, move(resolvedTree));
+        resolvedTree = definition_validator::runOne(ctx, move(resolvedTree), validatorCache);
         handler.drainErrors();
 
         resolvedTree = flatten::runOne(ctx, move(resolvedTree));